@@ -0,0 +1,359 @@
+//! Ingest throughput harness: one engine × thread count over one tree.
+//!
+//! ```text
+//! # Generate a synthetic tree (deterministic for a given seed)
+//! ingest_bench --setup -r TREE -n 20000 --size-median 4096 --size-sigma 1.5 \
+//!     --max-size 8388608 --dedup 30 --depth 3 --fanout 8 --seed 1
+//!
+//! # Ingest it once and print one JSON line
+//! ingest_bench -r TREE -c CAS -e rayon -t 4 --cache cold -l node_modules
+//! ```
+//!
+//! Engines: `rayon`, `uring` (Linux, `--features io_uring`), `gcd` (macOS)
+//! drive `IngestBackend::store_files_batch`; `tier1`, `tier2`, `phantom`
+//! drive `parallel_ingest_with_threads`; `pipeline` runs `IngestPipeline`;
+//! `walk` only lists the tree (baseline for syscall counts).
+//!
+//! `--cache cold` drops the page cache after listing the tree (root on
+//! Linux; `purge` on macOS), `warm` reads every file first, `none` leaves
+//! the cache alone. tier1 and phantom consume the tree: hand each run a
+//! fresh copy. Driven by tests/bench/run_ingest_bench.sh.
+
+use rayon::prelude::*;
+use std::fs::{self, File};
+use std::io::{self, Write};
+use std::path::{Path, PathBuf};
+use std::sync::Arc;
+use std::time::Instant;
+use vrift_cas::{parallel_ingest_with_threads, CasStore, IngestBackend, IngestMode};
+
+struct Shape {
+    files: usize,
+    size_median: f64,
+    size_sigma: f64,
+    max_size: u64,
+    dedup_pct: u32,
+    depth: u32,
+    fanout: u32,
+    seed: u64,
+}
+
+impl Shape {
+    fn log_normal_size(&self, rng: &mut Rng) -> u64 {
+        rng.log_normal(self.size_median, self.size_sigma).round() as u64
+    }
+}
+
+struct Run {
+    engine: String,
+    threads: usize,
+    cache: String,
+    label: String,
+}
+
+/// splitmix64: small, seedable, good enough for sizes and filler bytes
+struct Rng(u64);
+
+impl Rng {
+    fn next(&mut self) -> u64 {
+        self.0 = self.0.wrapping_add(0x9e37_79b9_7f4a_7c15);
+        let mut z = self.0;
+        z = (z ^ (z >> 30)).wrapping_mul(0xbf58_476d_1ce4_e5b9);
+        z = (z ^ (z >> 27)).wrapping_mul(0x94d0_49bb_1331_11eb);
+        z ^ (z >> 31)
+    }
+
+    /// Uniform in (0, 1]
+    fn unit(&mut self) -> f64 {
+        ((self.next() >> 11) + 1) as f64 / (1u64 << 53) as f64
+    }
+
+    /// Log-normal around `median`: most files small, a long tail of large ones
+    fn log_normal(&mut self, median: f64, sigma: f64) -> f64 {
+        let z = (-2.0 * self.unit().ln()).sqrt() * (2.0 * std::f64::consts::PI * self.unit()).cos();
+        median * (sigma * z).exp()
+    }
+}
+
+/// `TREE/d3/d1/d7/f000123.dat` for depth 3, fanout 8
+fn file_path(root: &Path, index: usize, shape: &Shape) -> PathBuf {
+    let mut path = root.to_path_buf();
+    let mut h = (index as u64).wrapping_mul(0x9e37_79b9_7f4a_7c15) ^ shape.seed;
+    for _ in 0..shape.depth {
+        path.push(format!("d{}", h % shape.fanout.max(1) as u64));
+        h /= shape.fanout.max(1) as u64;
+    }
+    path.push(format!("f{:06}.dat", index));
+    path
+}
+
+/// Content is a pure function of (content id, size): duplicates reuse both
+fn write_content(path: &Path, content_id: u64, size: u64, buf: &mut Vec<u8>) -> io::Result<()> {
+    buf.clear();
+    let mut rng = Rng(content_id ^ 0x5eed);
+    while (buf.len() as u64) < size {
+        buf.extend_from_slice(&rng.next().to_le_bytes());
+    }
+    buf.truncate(size as usize);
+    File::create(path)?.write_all(buf)
+}
+
+fn setup(root: &Path, shape: &Shape) -> io::Result<()> {
+    let mut rng = Rng(shape.seed);
+    let mut uniques: Vec<(u64, u64)> = Vec::new();
+    let mut buf = Vec::new();
+    let mut bytes = 0u64;
+    for i in 0..shape.files {
+        let (content_id, size) = if !uniques.is_empty() && rng.next() % 100 < shape.dedup_pct as u64
+        {
+            uniques[(rng.next() % uniques.len() as u64) as usize]
+        } else {
+            let size = shape.log_normal_size(&mut rng).min(shape.max_size);
+            uniques.push((shape.seed.wrapping_add(i as u64), size));
+            *uniques.last().unwrap()
+        };
+        let path = file_path(root, i, shape);
+        if let Some(parent) = path.parent() {
+            fs::create_dir_all(parent)?;
+        }
+        write_content(&path, content_id, size, &mut buf)?;
+        bytes += size;
+    }
+    eprintln!(
+        "created {} files ({} unique, {} bytes) under {}",
+        shape.files,
+        uniques.len(),
+        bytes,
+        root.display()
+    );
+    Ok(())
+}
+
+fn list_files(root: &Path) -> Vec<(PathBuf, u64)> {
+    walkdir::WalkDir::new(root)
+        .into_iter()
+        .filter_map(|e| e.ok())
+        .filter(|e| e.file_type().is_file())
+        .map(|e| {
+            let size = e.metadata().map(|m| m.len()).unwrap_or(0);
+            (e.into_path(), size)
+        })
+        .collect()
+}
+
+fn drop_caches() -> io::Result<()> {
+    #[cfg(target_os = "linux")]
+    {
+        unsafe { libc::sync() };
+        fs::write("/proc/sys/vm/drop_caches", "3")
+    }
+    #[cfg(target_os = "macos")]
+    {
+        let status = std::process::Command::new("purge").status()?;
+        if status.success() {
+            Ok(())
+        } else {
+            Err(io::Error::other("purge failed (needs root)"))
+        }
+    }
+    #[cfg(not(any(target_os = "linux", target_os = "macos")))]
+    {
+        Err(io::Error::other("no page cache control on this platform"))
+    }
+}
+
+fn preread(files: &[(PathBuf, u64)]) {
+    files.par_iter().for_each(|(path, _)| {
+        if let Ok(mut f) = File::open(path) {
+            let _ = io::copy(&mut f, &mut io::sink());
+        }
+    });
+}
+
+fn backend(engine: &str) -> Result<Box<dyn IngestBackend>, String> {
+    match engine {
+        "rayon" => Ok(Box::new(vrift_cas::rayon_backend())),
+        #[cfg(all(target_os = "linux", feature = "io_uring"))]
+        "uring" => {
+            let budget = vrift_cas::PipelineConfig::default().memory_budget;
+            let memory = Arc::new(vrift_cas::streaming_pipeline::MemorySemaphore::new(budget));
+            Ok(Box::new(vrift_cas::uring_backend(memory)))
+        }
+        // create_backend() is the GCD backend on macOS
+        #[cfg(target_os = "macos")]
+        "gcd" => Ok(vrift_cas::create_backend()),
+        _ => Err(format!(
+            "engine '{}' is not available in this build",
+            engine
+        )),
+    }
+}
+
+/// (ingested, errors) over `files`
+fn ingest(
+    run: &Run,
+    files: &[(PathBuf, u64)],
+    root: &Path,
+    cas: &Path,
+) -> Result<(u64, u64), String> {
+    let paths: Vec<PathBuf> = files.iter().map(|(p, _)| p.clone()).collect();
+    let total = paths.len() as u64;
+    let mode = match run.engine.as_str() {
+        "walk" => return Ok((0, 0)),
+        "tier1" => Some(IngestMode::SolidTier1),
+        "tier2" => Some(IngestMode::SolidTier2),
+        "phantom" => Some(IngestMode::Phantom),
+        _ => None,
+    };
+    if let Some(mode) = mode {
+        let results = parallel_ingest_with_threads(&paths, cas, mode, Some(run.threads));
+        let errors = results.iter().filter(|r| r.is_err()).count() as u64;
+        return Ok((total - errors, errors));
+    }
+    if run.engine == "pipeline" {
+        let config = vrift_cas::PipelineConfig {
+            worker_threads: run.threads,
+            ..Default::default()
+        };
+        let stats = vrift_cas::IngestPipeline::new(config)
+            .run(root, cas)
+            .map_err(|e| e.to_string())?;
+        return Ok((
+            stats.files_processed,
+            total.saturating_sub(stats.files_processed),
+        ));
+    }
+
+    let backend = backend(&run.engine)?;
+    let store = Arc::new(CasStore::new(cas).map_err(|e| e.to_string())?);
+    let pool = rayon::ThreadPoolBuilder::new()
+        .num_threads(run.threads)
+        .build()
+        .map_err(|e| e.to_string())?;
+    // store_files_batch stops at the first error
+    match pool.install(|| backend.store_files_batch(store, paths)) {
+        Ok(hashes) => Ok((hashes.len() as u64, 0)),
+        Err(e) => {
+            eprintln!("{}: {}", backend.name(), e);
+            Ok((0, total))
+        }
+    }
+}
+
+fn bench(root: &Path, cas: &Path, run: &Run) -> Result<(), String> {
+    fs::create_dir_all(cas).map_err(|e| e.to_string())?;
+    let files = list_files(root);
+    let bytes: u64 = files.iter().map(|(_, s)| s).sum();
+
+    match run.cache.as_str() {
+        "cold" => drop_caches().map_err(|e| format!("--cache cold: {}", e))?,
+        "warm" => preread(&files),
+        "none" => {}
+        other => return Err(format!("unknown --cache '{}'", other)),
+    }
+
+    let start = Instant::now();
+    let (ingested, errors) = ingest(run, &files, root, cas)?;
+    let secs = start.elapsed().as_secs_f64();
+
+    let blobs = CasStore::new(cas)
+        .and_then(|s| s.stats())
+        .map(|s| s.blob_count)
+        .unwrap_or(0);
+    let per_sec = |n: f64| {
+        if secs > 0.0 && ingested > 0 {
+            n / secs
+        } else {
+            0.0
+        }
+    };
+    println!(
+        "{{\"bench\":\"ingest\",\"label\":\"{}\",\"engine\":\"{}\",\"threads\":{},\
+         \"cache\":\"{}\",\"files\":{},\"bytes\":{},\"ingested\":{},\"errors\":{},\
+         \"blobs\":{},\"secs\":{:.6},\"files_per_sec\":{:.1},\"mb_per_sec\":{:.2}}}",
+        run.label,
+        run.engine,
+        run.threads,
+        run.cache,
+        files.len(),
+        bytes,
+        ingested,
+        errors,
+        blobs,
+        secs,
+        per_sec(ingested as f64),
+        per_sec(bytes as f64 / (1024.0 * 1024.0))
+    );
+    Ok(())
+}
+
+fn usage() -> ! {
+    eprintln!(
+        "usage: ingest_bench --setup -r TREE [-n FILES] [--size-median BYTES] [--size-sigma S]\n\
+         \x20                   [--max-size BYTES] [--dedup PCT] [--depth D] [--fanout F] [--seed N]\n\
+         \x20      ingest_bench -r TREE -c CAS -e ENGINE [-t THREADS] [--cache cold|warm|none] [-l LABEL]\n\
+         engines: rayon uring gcd tier1 tier2 phantom pipeline walk"
+    );
+    std::process::exit(2)
+}
+
+fn main() {
+    let mut shape = Shape {
+        files: 10_000,
+        size_median: 4096.0,
+        size_sigma: 1.5,
+        max_size: 8 * 1024 * 1024,
+        dedup_pct: 20,
+        depth: 3,
+        fanout: 8,
+        seed: 1,
+    };
+    let mut run = Run {
+        engine: "rayon".to_string(),
+        threads: vrift_cas::default_thread_count(),
+        cache: "none".to_string(),
+        label: "default".to_string(),
+    };
+    let mut root = None;
+    let mut cas = None;
+    let mut do_setup = false;
+
+    let mut args = std::env::args().skip(1);
+    while let Some(arg) = args.next() {
+        if arg == "--setup" {
+            do_setup = true;
+            continue;
+        }
+        let value = args.next().unwrap_or_else(|| usage());
+        let num = || value.parse::<u64>().unwrap_or_else(|_| usage());
+        match arg.as_str() {
+            "-r" => root = Some(PathBuf::from(&value)),
+            "-c" => cas = Some(PathBuf::from(&value)),
+            "-e" => run.engine = value.clone(),
+            "-t" => run.threads = num().max(1) as usize,
+            "-l" => run.label = value.clone(),
+            "--cache" => run.cache = value.clone(),
+            "-n" => shape.files = num() as usize,
+            "--size-median" => shape.size_median = num() as f64,
+            "--size-sigma" => shape.size_sigma = value.parse().unwrap_or_else(|_| usage()),
+            "--max-size" => shape.max_size = num(),
+            "--dedup" => shape.dedup_pct = num().min(100) as u32,
+            "--depth" => shape.depth = num() as u32,
+            "--fanout" => shape.fanout = num() as u32,
+            "--seed" => shape.seed = num(),
+            _ => usage(),
+        }
+    }
+
+    let root = root.unwrap_or_else(|| usage());
+    let result = if do_setup {
+        setup(&root, &shape).map_err(|e| e.to_string())
+    } else {
+        let cas = cas.unwrap_or_else(|| usage());
+        bench(&root, &cas, &run)
+    };
+    if let Err(e) = result {
+        eprintln!("ingest_bench: {}", e);
+        std::process::exit(1);
+    }
+}
@@ -0,0 +1,371 @@
+//! Content-defined chunking for large blobs.
+//!
+//! Large build artifacts (`.a`, `.pch`, linked binaries) are rewritten
+//! constantly but change only in places. Storing them as one blob means a
+//! one-byte edit costs a full new copy. With chunking enabled, files above
+//! a size threshold are split at FastCDC (gear-hash) boundaries; every chunk
+//! is an ordinary CAS blob and the file itself is a chunk list:
+//!
+//! ```text
+//! blake3/ab/cd/<file_hash>_<size>.chunks   # chunk list (this module)
+//! blake3/12/34/<chunk_hash>_<len>          # chunk, same as any blob
+//! ```
+//!
+//! Boundaries depend only on local content, so an edit moves at most the
+//! chunks around it and everything else dedups against the previous version.
+//! The file's identity stays the BLAKE3 of its full content, so manifests
+//! are unaffected by how a blob is stored.
+//!
+//! # References
+//! - Xia et al., "FastCDC: a Fast and Efficient Content-Defined Chunking
+//!   Approach for Data Deduplication" (USENIX ATC '16)
+
+use std::io::{self, Write};
+
+use crate::Blake3Hash;
+
+/// Extension of chunk list files in the blob layout
+pub const CHUNK_LIST_EXT: &str = "chunks";
+
+const CHUNK_LIST_MAGIC: &[u8; 8] = b"VRCHUNK1";
+const CHUNK_LIST_HEADER: usize = 24;
+const CHUNK_REF_SIZE: usize = 40;
+
+/// Chunking parameters
+#[derive(Debug, Clone, Copy, PartialEq, Eq)]
+pub struct ChunkingConfig {
+    /// Files smaller than this are stored as a single blob
+    pub threshold: u64,
+    /// No boundary is cut before this many bytes
+    pub min_size: usize,
+    /// Target average chunk size (power of two)
+    pub avg_size: usize,
+    /// A boundary is forced at this many bytes
+    pub max_size: usize,
+}
+
+impl Default for ChunkingConfig {
+    fn default() -> Self {
+        Self {
+            threshold: 4 * 1024 * 1024,
+            min_size: 64 * 1024,
+            avg_size: 256 * 1024,
+            max_size: 1024 * 1024,
+        }
+    }
+}
+
+impl ChunkingConfig {
+    /// Default chunk sizes with a custom file-size threshold
+    pub fn with_threshold(threshold: u64) -> Self {
+        Self {
+            threshold,
+            ..Default::default()
+        }
+    }
+
+    /// Whether a file of `size` bytes is stored chunked
+    #[inline]
+    pub fn applies_to(&self, size: u64) -> bool {
+        size >= self.threshold
+    }
+
+    /// Normalized-chunking masks: stricter before the average size, looser
+    /// after it, which tightens the chunk size distribution (FastCDC §3.3).
+    fn masks(&self) -> (u64, u64) {
+        let bits = self.avg_size.next_power_of_two().trailing_zeros().max(3);
+        let top = |n: u32| !0u64 << (64 - n);
+        (top(bits + 2), top(bits - 2))
+    }
+}
+
+/// Gear table: 256 pseudo-random words (splitmix64), fixed forever since
+/// chunk boundaries (and therefore dedup) depend on it.
+const GEAR: [u64; 256] = {
+    let mut table = [0u64; 256];
+    let mut state = 0x5652_4946_545f_4344u64; // "VRIFT_CD"
+    let mut i = 0;
+    while i < 256 {
+        state = state.wrapping_add(0x9e37_79b9_7f4a_7c15);
+        let mut z = state;
+        z = (z ^ (z >> 30)).wrapping_mul(0xbf58_476d_1ce4_e5b9);
+        z = (z ^ (z >> 27)).wrapping_mul(0x94d0_49bb_1331_11eb);
+        table[i] = z ^ (z >> 31);
+        i += 1;
+    }
+    table
+};
+
+/// Length of the first chunk of `data`
+fn cut_point(data: &[u8], config: &ChunkingConfig, masks: (u64, u64)) -> usize {
+    let len = data.len();
+    if len <= config.min_size {
+        return len;
+    }
+    let end = len.min(config.max_size);
+    let normal = end.min(config.avg_size);
+    let (mask_s, mask_l) = masks;
+
+    let mut hash = 0u64;
+    let mut i = config.min_size;
+    while i < normal {
+        hash = (hash << 1).wrapping_add(GEAR[data[i] as usize]);
+        if hash & mask_s == 0 {
+            return i + 1;
+        }
+        i += 1;
+    }
+    while i < end {
+        hash = (hash << 1).wrapping_add(GEAR[data[i] as usize]);
+        if hash & mask_l == 0 {
+            return i + 1;
+        }
+        i += 1;
+    }
+    end
+}
+
+/// Iterator over the content-defined chunks of a buffer
+pub struct FastCdc<'a> {
+    data: &'a [u8],
+    config: ChunkingConfig,
+    masks: (u64, u64),
+}
+
+impl<'a> FastCdc<'a> {
+    pub fn new(data: &'a [u8], config: &ChunkingConfig) -> Self {
+        Self {
+            data,
+            config: *config,
+            masks: config.masks(),
+        }
+    }
+}
+
+impl<'a> Iterator for FastCdc<'a> {
+    type Item = &'a [u8];
+
+    fn next(&mut self) -> Option<&'a [u8]> {
+        if self.data.is_empty() {
+            return None;
+        }
+        let n = cut_point(self.data, &self.config, self.masks);
+        let (chunk, rest) = self.data.split_at(n);
+        self.data = rest;
+        Some(chunk)
+    }
+}
+
+/// One chunk of a chunked blob
+#[derive(Debug, Clone, Copy, PartialEq, Eq)]
+pub struct ChunkRef {
+    pub hash: Blake3Hash,
+    pub len: u64,
+}
+
+/// Ordered chunk list of a chunked blob
+///
+/// On-disk format (little endian): magic `VRCHUNK1`, total size (u64),
+/// chunk count (u32), reserved (u32), then per chunk its hash (32 bytes)
+/// and length (u64).
+#[derive(Debug, Clone, Default, PartialEq, Eq)]
+pub struct ChunkList {
+    pub size: u64,
+    pub chunks: Vec<ChunkRef>,
+}
+
+impl ChunkList {
+    pub fn push(&mut self, hash: Blake3Hash, len: u64) {
+        self.size += len;
+        self.chunks.push(ChunkRef { hash, len });
+    }
+
+    pub fn encode(&self) -> Vec<u8> {
+        let mut out = Vec::with_capacity(CHUNK_LIST_HEADER + self.chunks.len() * CHUNK_REF_SIZE);
+        out.extend_from_slice(CHUNK_LIST_MAGIC);
+        out.extend_from_slice(&self.size.to_le_bytes());
+        out.extend_from_slice(&(self.chunks.len() as u32).to_le_bytes());
+        out.extend_from_slice(&0u32.to_le_bytes());
+        for chunk in &self.chunks {
+            out.extend_from_slice(&chunk.hash);
+            out.extend_from_slice(&chunk.len.to_le_bytes());
+        }
+        out
+    }
+
+    pub fn decode(bytes: &[u8]) -> io::Result<Self> {
+        let invalid = |msg: &str| io::Error::new(io::ErrorKind::InvalidData, msg.to_string());
+        if bytes.len() < CHUNK_LIST_HEADER || &bytes[..8] != CHUNK_LIST_MAGIC {
+            return Err(invalid("not a chunk list"));
+        }
+        let size = u64::from_le_bytes(bytes[8..16].try_into().unwrap());
+        let count = u32::from_le_bytes(bytes[16..20].try_into().unwrap()) as usize;
+        let body = &bytes[CHUNK_LIST_HEADER..];
+        if body.len() != count * CHUNK_REF_SIZE {
+            return Err(invalid("truncated chunk list"));
+        }
+
+        let chunks: Vec<ChunkRef> = body
+            .chunks_exact(CHUNK_REF_SIZE)
+            .map(|rec| ChunkRef {
+                hash: rec[..32].try_into().unwrap(),
+                len: u64::from_le_bytes(rec[32..].try_into().unwrap()),
+            })
+            .collect();
+        if chunks.iter().map(|c| c.len).sum::<u64>() != size {
+            return Err(invalid("chunk sizes do not add up"));
+        }
+        Ok(Self { size, chunks })
+    }
+}
+
+/// Read view of a chunked blob: every chunk mapped from its own blob
+pub struct ChunkedBlob {
+    size: u64,
+    chunks: Vec<memmap2::Mmap>,
+}
+
+impl ChunkedBlob {
+    pub(crate) fn new(size: u64, chunks: Vec<memmap2::Mmap>) -> Self {
+        Self { size, chunks }
+    }
+
+    pub fn len(&self) -> u64 {
+        self.size
+    }
+
+    pub fn is_empty(&self) -> bool {
+        self.size == 0
+    }
+
+    /// Chunk contents in file order
+    pub fn chunks(&self) -> impl Iterator<Item = &[u8]> {
+        self.chunks.iter().map(|m| &m[..])
+    }
+
+    /// Copy bytes starting at `offset` into `buf`; returns bytes copied.
+    pub fn read_at(&self, mut offset: u64, buf: &mut [u8]) -> usize {
+        let mut copied = 0;
+        for chunk in self.chunks() {
+            let len = chunk.len() as u64;
+            if offset >= len {
+                offset -= len;
+                continue;
+            }
+            let src = &chunk[offset as usize..];
+            let n = src.len().min(buf.len() - copied);
+            buf[copied..copied + n].copy_from_slice(&src[..n]);
+            copied += n;
+            offset = 0;
+            if copied == buf.len() {
+                break;
+            }
+        }
+        copied
+    }
+
+    pub fn write_to<W: Write>(&self, writer: &mut W) -> io::Result<()> {
+        for chunk in self.chunks() {
+            writer.write_all(chunk)?;
+        }
+        Ok(())
+    }
+
+    pub fn to_vec(&self) -> Vec<u8> {
+        let mut out = Vec::with_capacity(self.size as usize);
+        for chunk in self.chunks() {
+            out.extend_from_slice(chunk);
+        }
+        out
+    }
+
+    /// Reassemble into one contiguous read-only anonymous mapping
+    pub fn into_mmap(self) -> io::Result<memmap2::Mmap> {
+        let mut map = memmap2::MmapMut::map_anon(self.size as usize)?;
+        let mut offset = 0;
+        for chunk in self.chunks() {
+            map[offset..offset + chunk.len()].copy_from_slice(chunk);
+            offset += chunk.len();
+        }
+        map.make_read_only()
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    fn pseudo_random(len: usize, seed: u64) -> Vec<u8> {
+        let mut state = seed;
+        (0..len)
+            .map(|_| {
+                state ^= state << 13;
+                state ^= state >> 7;
+                state ^= state << 17;
+                state as u8
+            })
+            .collect()
+    }
+
+    fn small_config() -> ChunkingConfig {
+        ChunkingConfig {
+            threshold: 0,
+            min_size: 2 * 1024,
+            avg_size: 8 * 1024,
+            max_size: 32 * 1024,
+        }
+    }
+
+    #[test]
+    fn test_chunks_cover_input_within_bounds() {
+        let config = small_config();
+        let data = pseudo_random(1024 * 1024, 1);
+        let chunks: Vec<&[u8]> = FastCdc::new(&data, &config).collect();
+
+        assert_eq!(chunks.concat(), data);
+        let (last, rest) = chunks.split_last().unwrap();
+        assert!(rest
+            .iter()
+            .all(|c| c.len() > config.min_size && c.len() <= config.max_size));
+        assert!(last.len() <= config.max_size);
+        // Normalized chunking keeps the mean near the target
+        let mean = data.len() / chunks.len();
+        assert!(mean > config.avg_size / 2 && mean < config.avg_size * 2);
+    }
+
+    #[test]
+    fn test_local_edit_keeps_other_chunks() {
+        let config = small_config();
+        let original = pseudo_random(1024 * 1024, 2);
+        let mut edited = original.clone();
+        edited[500_000] ^= 0xff;
+        edited.splice(700_000..700_000, *b"inserted bytes");
+
+        let before: std::collections::HashSet<&[u8]> = FastCdc::new(&original, &config).collect();
+        let after: Vec<&[u8]> = FastCdc::new(&edited, &config).collect();
+        let changed = after.iter().filter(|c| !before.contains(*c)).count();
+
+        assert!(changed > 0);
+        assert!(
+            changed <= 6,
+            "{} of {} chunks changed",
+            changed,
+            after.len()
+        );
+    }
+
+    #[test]
+    fn test_chunk_list_roundtrip() {
+        let mut list = ChunkList::default();
+        list.push([1; 32], 100);
+        list.push([2; 32], 23);
+        let bytes = list.encode();
+        assert_eq!(ChunkList::decode(&bytes).unwrap(), list);
+
+        assert!(ChunkList::decode(&bytes[..bytes.len() - 1]).is_err());
+        let mut bad = bytes.clone();
+        bad[8] ^= 1; // Size no longer matches the chunks
+        assert!(ChunkList::decode(&bad).is_err());
+        assert!(ChunkList::decode(b"not a chunk list at all!").is_err());
+    }
+}
@@ -0,0 +1,630 @@
+//! Parallel CAS garbage collection against an on-disk live set (RFC-0041).
+//!
+//! The mark phase (the CLI, reading every registered LMDB manifest) writes
+//! the referenced hashes as a sorted array: a [`LiveSet`]. The sweep maps
+//! it and tests each blob with a binary search over raw 32-byte hashes, so
+//! nothing is hex-encoded or hashed, and nothing is deserialized.
+//!
+//! The sweep shards the 256 `blake3/xx` fan-out directories across threads.
+//! Each shard is listed with the shared [`TreeWalker`]; only blobs missing
+//! from the live set are stat'ed, and then deleted.
+//!
+//! Blobs are aged by ctime, which ingest always sets: writes, renames (the
+//! store-by-move path) and the final chmod all update it. A blob whose
+//! ctime is later than the mark minus a grace period belongs to the young
+//! generation. It may be referenced by a manifest the mark never saw, so it
+//! is skipped without a rescan. Ingest keeps running during a sweep.
+//!
+//! The materialized flat copy of a chunked blob (see `CasStore::materialize`)
+//! shares the blob's hash, so it is pinned exactly as long as the blob is
+//! live and swept with it. Its bytes are stored twice until then, chunks
+//! and copy; dropping it early would only make the next open rebuild it.
+//!
+//! A dedup hit on an old orphan does not refresh its age. Manifests that
+//! start referencing such a blob after the mark protect it only from the
+//! next sweep on. This is the same window the Bloom filter sweep has.
+
+use std::fs::{self, File};
+use std::io::{self, Write};
+use std::path::Path;
+use std::sync::atomic::{AtomicU64, AtomicUsize, Ordering};
+use std::sync::Mutex;
+use std::time::{Duration, Instant, SystemTime, UNIX_EPOCH};
+
+use crate::chunking::ChunkList;
+use crate::tree_walk::{default_walk_threads, TreeWalker};
+use crate::{is_chunk_list, Blake3Hash, BloomFilter, CasError, CasStore, Result};
+
+const LIVE_SET_MAGIC: &[u8; 8] = b"VRLIVE01";
+const LIVE_SET_HEADER: usize = 32;
+
+/// Hashes referenced by manifests at mark time, sorted, memory-mapped
+///
+/// On-disk format (little endian): magic `VRLIVE01`, hash count (u64),
+/// mark time in ns since the epoch (u64), reserved (u64), then the hashes
+/// in ascending order.
+pub struct LiveSet {
+    map: memmap2::Mmap,
+    count: usize,
+    marked_at: SystemTime,
+}
+
+impl LiveSet {
+    /// Write the live set of a mark taken at `marked_at` to `path`
+    /// (atomically). Returns the number of distinct hashes.
+    pub fn write<P, I>(path: P, hashes: I, marked_at: SystemTime) -> Result<usize>
+    where
+        P: AsRef<Path>,
+        I: IntoIterator<Item = Blake3Hash>,
+    {
+        let path = path.as_ref();
+        let mut hashes: Vec<Blake3Hash> = hashes.into_iter().collect();
+        hashes.sort_unstable();
+        hashes.dedup();
+
+        let mark_nanos = marked_at
+            .duration_since(UNIX_EPOCH)
+            .unwrap_or_default()
+            .as_nanos() as u64;
+        let temp_path = path.with_extension(format!("{}.tmp", std::process::id()));
+        let result = (|| {
+            let mut out = io::BufWriter::new(File::create(&temp_path)?);
+            out.write_all(LIVE_SET_MAGIC)?;
+            out.write_all(&(hashes.len() as u64).to_le_bytes())?;
+            out.write_all(&mark_nanos.to_le_bytes())?;
+            out.write_all(&0u64.to_le_bytes())?;
+            for hash in &hashes {
+                out.write_all(hash)?;
+            }
+            out.into_inner().map_err(|e| e.into_error())?.sync_all()?;
+            fs::rename(&temp_path, path)
+        })();
+        if let Err(e) = result {
+            let _ = fs::remove_file(&temp_path);
+            return Err(CasError::Io(e));
+        }
+        Ok(hashes.len())
+    }
+
+    pub fn open<P: AsRef<Path>>(path: P) -> Result<Self> {
+        let invalid = |msg: &str| CasError::Io(io::Error::new(io::ErrorKind::InvalidData, msg));
+        let map = CasStore::map_file(path.as_ref())?;
+        if map.len() < LIVE_SET_HEADER || &map[..8] != LIVE_SET_MAGIC {
+            return Err(invalid("not a live set"));
+        }
+        let count = u64::from_le_bytes(map[8..16].try_into().unwrap()) as usize;
+        let mark_nanos = u64::from_le_bytes(map[16..24].try_into().unwrap());
+        if count.checked_mul(32) != Some(map.len() - LIVE_SET_HEADER) {
+            return Err(invalid("truncated live set"));
+        }
+        Ok(Self {
+            map,
+            count,
+            marked_at: UNIX_EPOCH + Duration::from_nanos(mark_nanos),
+        })
+    }
+
+    pub fn len(&self) -> usize {
+        self.count
+    }
+
+    pub fn is_empty(&self) -> bool {
+        self.count == 0
+    }
+
+    /// When the manifests behind this set were read
+    pub fn marked_at(&self) -> SystemTime {
+        self.marked_at
+    }
+
+    #[inline]
+    fn hash_at(&self, i: usize) -> &[u8] {
+        let at = LIVE_SET_HEADER + i * 32;
+        &self.map[at..at + 32]
+    }
+
+    pub fn contains(&self, hash: &Blake3Hash) -> bool {
+        let (mut lo, mut hi) = (0, self.count);
+        while lo < hi {
+            let mid = lo + (hi - lo) / 2;
+            match self.hash_at(mid).cmp(&hash[..]) {
+                std::cmp::Ordering::Less => lo = mid + 1,
+                std::cmp::Ordering::Greater => hi = mid,
+                std::cmp::Ordering::Equal => return true,
+            }
+        }
+        false
+    }
+}
+
+/// Sweep tuning
+#[derive(Debug, Clone)]
+pub struct SweepOptions {
+    pub threads: usize,
+    /// Grace period before the mark: blobs changed after `mark - min_age`
+    /// are young and kept
+    pub min_age: Duration,
+    /// Cap on stat + unlink calls per second across all threads
+    pub io_ops_per_sec: Option<u32>,
+    /// Count orphans without deleting them
+    pub dry_run: bool,
+}
+
+impl Default for SweepOptions {
+    fn default() -> Self {
+        Self {
+            threads: default_walk_threads(),
+            min_age: Duration::from_secs(3600),
+            io_ops_per_sec: None,
+            dry_run: false,
+        }
+    }
+}
+
+/// Running totals of a sweep; the final value is its result
+#[derive(Debug, Default, Clone, Copy, PartialEq, Eq)]
+pub struct SweepProgress {
+    pub shards_done: usize,
+    pub shards_total: usize,
+    /// Blob files seen
+    pub scanned: u64,
+    /// Orphans deleted (or found, in a dry run)
+    pub deleted: u64,
+    pub reclaimed_bytes: u64,
+    /// Orphans kept because they are younger than the cutoff
+    pub skipped_young: u64,
+}
+
+#[derive(Default)]
+struct Counters {
+    shards_done: AtomicUsize,
+    scanned: AtomicU64,
+    deleted: AtomicU64,
+    reclaimed_bytes: AtomicU64,
+    skipped_young: AtomicU64,
+}
+
+impl Counters {
+    fn snapshot(&self, shards_total: usize) -> SweepProgress {
+        SweepProgress {
+            shards_done: self.shards_done.load(Ordering::Relaxed),
+            shards_total,
+            scanned: self.scanned.load(Ordering::Relaxed),
+            deleted: self.deleted.load(Ordering::Relaxed),
+            reclaimed_bytes: self.reclaimed_bytes.load(Ordering::Relaxed),
+            skipped_young: self.skipped_young.load(Ordering::Relaxed),
+        }
+    }
+}
+
+/// Per-thread pacing for `io_ops_per_sec`
+struct Throttle {
+    interval: Option<Duration>,
+    next: Instant,
+}
+
+impl Throttle {
+    fn new(ops_per_sec: Option<u32>, threads: usize) -> Self {
+        Self {
+            interval: ops_per_sec
+                .filter(|&ops| ops > 0)
+                .map(|ops| Duration::from_secs(threads as u64) / ops),
+            next: Instant::now(),
+        }
+    }
+
+    fn tick(&mut self) {
+        if let Some(interval) = self.interval {
+            let now = Instant::now();
+            if self.next > now {
+                std::thread::sleep(self.next - now);
+            }
+            self.next = self.next.max(now) + interval;
+        }
+    }
+}
+
+fn ctime(meta: &fs::Metadata) -> SystemTime {
+    use std::os::unix::fs::MetadataExt;
+    UNIX_EPOCH + Duration::new(meta.ctime().max(0) as u64, meta.ctime_nsec() as u32)
+}
+
+impl CasStore {
+    /// Delete blobs missing from `live`, honoring the mark's age cutoff.
+    /// `on_shard` is called (from sweep threads) after each fan-out
+    /// directory with the running totals and the hashes deleted there.
+    pub fn sweep_live<F>(
+        &self,
+        live: &LiveSet,
+        options: &SweepOptions,
+        on_shard: F,
+    ) -> Result<SweepProgress>
+    where
+        F: Fn(&SweepProgress, &[Blake3Hash]) + Sync,
+    {
+        let cutoff = live.marked_at().min(SystemTime::now()) - options.min_age;
+        self.sweep_with(&|hash| live.contains(hash), cutoff, options, on_shard)
+    }
+
+    /// Perform a Garbage Collection sweep using a Bloom Filter of active hashes.
+    ///
+    /// Blobs stored after the sweep starts are kept. Returns
+    /// (deleted_count, reclaimed_bytes).
+    pub fn sweep(&self, bloom_bits: &[u8]) -> Result<(u32, u64)> {
+        let bloom = BloomFilter {
+            bits: bloom_bits.to_vec(),
+        };
+        let options = SweepOptions {
+            min_age: Duration::ZERO,
+            ..Default::default()
+        };
+        let progress = self.sweep_with(
+            &|hash| bloom.contains(&Self::hash_to_hex(hash)),
+            SystemTime::now(),
+            &options,
+            |_, _| {},
+        )?;
+        Ok((progress.deleted as u32, progress.reclaimed_bytes))
+    }
+
+    /// Sweep every blob for which `is_live` is false and whose ctime is
+    /// before `cutoff`
+    pub fn sweep_with<F>(
+        &self,
+        is_live: &(dyn Fn(&Blake3Hash) -> bool + Sync),
+        cutoff: SystemTime,
+        options: &SweepOptions,
+        on_shard: F,
+    ) -> Result<SweepProgress>
+    where
+        F: Fn(&SweepProgress, &[Blake3Hash]) + Sync,
+    {
+        let blake3_dir = self.root.join("blake3");
+        let mut shards = Vec::new();
+        match fs::read_dir(&blake3_dir) {
+            Ok(entries) => {
+                for entry in entries {
+                    let entry = entry?;
+                    if entry.file_type()?.is_dir() {
+                        shards.push(entry.path());
+                    }
+                }
+            }
+            Err(e) if e.kind() == io::ErrorKind::NotFound => {}
+            Err(e) => return Err(CasError::Io(e)),
+        }
+
+        let live_chunks = self.live_chunks(is_live, cutoff, options.threads);
+        let is_live = |hash: &Blake3Hash| is_live(hash) || live_chunks.binary_search(hash).is_ok();
+
+        let counters = Counters::default();
+        let cursor = AtomicUsize::new(0);
+        let threads = options.threads.clamp(1, shards.len().max(1));
+        let errors = Mutex::new(Vec::new());
+
+        let worker = || {
+            // Locked only by this thread; `walk` takes a shared closure
+            let throttle = Mutex::new(Throttle::new(options.io_ops_per_sec, threads));
+            let deleted = Mutex::new(Vec::new());
+            loop {
+                let i = cursor.fetch_add(1, Ordering::Relaxed);
+                let Some(shard) = shards.get(i) else {
+                    return;
+                };
+                TreeWalker::new(shard).threads(1).walk(|entry| {
+                    if !entry.is_file() {
+                        return true;
+                    }
+                    let Some(name) = entry.path.file_name().and_then(|n| n.to_str()) else {
+                        return true;
+                    };
+                    if name.ends_with(".tmp") {
+                        return true;
+                    }
+                    let Some(hash) = Self::hex_to_hash(name.split('_').next().unwrap_or(name))
+                    else {
+                        return true;
+                    };
+                    counters.scanned.fetch_add(1, Ordering::Relaxed);
+                    if is_live(&hash) {
+                        return true;
+                    }
+
+                    let mut throttle = throttle.lock().unwrap();
+                    throttle.tick();
+                    let Ok(meta) = fs::symlink_metadata(&entry.path) else {
+                        return true; // Vanished
+                    };
+                    if ctime(&meta) >= cutoff {
+                        counters.skipped_young.fetch_add(1, Ordering::Relaxed);
+                        return true;
+                    }
+                    if !options.dry_run {
+                        throttle.tick();
+                        if let Err(e) = self.remove_blob_file(&entry.path, &hash) {
+                            errors.lock().unwrap().push(e);
+                            return true;
+                        }
+                    }
+                    counters
+                        .reclaimed_bytes
+                        .fetch_add(meta.len(), Ordering::Relaxed);
+                    counters.deleted.fetch_add(1, Ordering::Relaxed);
+                    deleted.lock().unwrap().push(hash);
+                    true
+                });
+                counters.shards_done.fetch_add(1, Ordering::Relaxed);
+                let mut deleted = deleted.lock().unwrap();
+                on_shard(&counters.snapshot(shards.len()), &deleted);
+                deleted.clear();
+            }
+        };
+        std::thread::scope(|s| {
+            for _ in 1..threads {
+                s.spawn(worker);
+            }
+            worker();
+        });
+
+        let errors = errors.into_inner().unwrap();
+        if let Some(e) = errors.into_iter().next() {
+            tracing::warn!(error = %e, "GC: some orphans could not be deleted");
+        }
+        Ok(counters.snapshot(shards.len()))
+    }
+
+    /// Unlink one blob file and its tree sidecar.
+    fn remove_blob_file(&self, path: &Path, hash: &Blake3Hash) -> io::Result<()> {
+        if remove_protected(path)? {
+            let _ = fs::remove_file(self.tree_path(hash));
+        }
+        Ok(())
+    }
+
+    /// Chunks referenced by the chunk lists the sweep keeps, sorted: lists
+    /// of live blobs, and young lists (ctime at or after `cutoff`) that the
+    /// mark may not have seen. Chunks are not in any manifest, so they live
+    /// exactly as long as a kept list uses them; an old chunk a young list
+    /// reuses through dedup is kept too.
+    fn live_chunks(
+        &self,
+        is_live: &(dyn Fn(&Blake3Hash) -> bool + Sync),
+        cutoff: SystemTime,
+        threads: usize,
+    ) -> Vec<Blake3Hash> {
+        let lists = Mutex::new(Vec::new());
+        TreeWalker::new(self.root.join("blake3"))
+            .threads(threads)
+            .walk(|entry| {
+                if entry.is_file() && is_chunk_list(&entry.path) {
+                    let name = entry
+                        .path
+                        .file_name()
+                        .and_then(|n| n.to_str())
+                        .unwrap_or("");
+                    let hex = name.split('_').next().unwrap_or(name);
+                    let kept = Self::hex_to_hash(hex).is_some_and(|hash| is_live(&hash))
+                        || fs::symlink_metadata(&entry.path)
+                            .is_ok_and(|meta| ctime(&meta) >= cutoff);
+                    if kept {
+                        lists.lock().unwrap().push(entry.path);
+                    }
+                }
+                true
+            });
+
+        let lists = lists.into_inner().unwrap();
+        let mut live = Vec::new();
+        for path in &lists {
+            match fs::read(&path).and_then(|bytes| ChunkList::decode(&bytes)) {
+                Ok(list) => live.extend(list.chunks.iter().map(|c| c.hash)),
+                Err(e) => {
+                    tracing::warn!(path = %path.display(), error = %e, "Unreadable chunk list")
+                }
+            }
+        }
+        live.sort_unstable();
+        live.dedup();
+        live
+    }
+}
+
+/// Unlink a blob file, clearing the immutable flag only if the first
+/// attempt is refused. Returns false if it was already gone.
+fn remove_protected(path: &Path) -> io::Result<bool> {
+    match fs::remove_file(path) {
+        Err(e) if e.kind() == io::ErrorKind::PermissionDenied => {
+            let _ = crate::protection::set_immutable(path, false);
+            fs::remove_file(path)?;
+        }
+        Err(e) if e.kind() == io::ErrorKind::NotFound => return Ok(false),
+        result => result?,
+    }
+    Ok(true)
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+    use crate::ChunkingConfig;
+    use tempfile::TempDir;
+
+    #[test]
+    fn test_live_set_roundtrip() {
+        let temp = TempDir::new().unwrap();
+        let path = temp.path().join("live.set");
+        let hashes: Vec<Blake3Hash> = (0..1000u32)
+            .map(|i| CasStore::compute_hash(&i.to_le_bytes()))
+            .collect();
+        let marked_at = UNIX_EPOCH + Duration::from_secs(1_700_000_000);
+
+        let written =
+            LiveSet::write(&path, hashes.iter().chain(&hashes).copied(), marked_at).unwrap();
+        assert_eq!(written, 1000);
+        let live = LiveSet::open(&path).unwrap();
+        assert_eq!(live.len(), 1000);
+        assert_eq!(live.marked_at(), marked_at);
+        assert!(hashes.iter().all(|h| live.contains(h)));
+        assert!(!live.contains(&[0xab; 32]));
+
+        let bytes = fs::read(&path).unwrap();
+        fs::write(&path, &bytes[..bytes.len() - 1]).unwrap();
+        assert!(LiveSet::open(&path).is_err());
+    }
+
+    #[test]
+    fn test_sweep_live_keeps_live_and_young_blobs() {
+        let temp = TempDir::new().unwrap();
+        let cas = CasStore::new(temp.path().join("cas")).unwrap();
+        let blobs: Vec<Blake3Hash> = (0..64u32)
+            .map(|i| cas.store(format!("blob {}", i).as_bytes()).unwrap())
+            .collect();
+        let (live, dead) = blobs.split_at(16);
+        let path = temp.path().join("live.set");
+
+        // Mark older than every blob: nothing may go
+        let early = SystemTime::now() - Duration::from_secs(600);
+        LiveSet::write(&path, live.iter().copied(), early).unwrap();
+        let options = SweepOptions {
+            threads: 4,
+            min_age: Duration::ZERO,
+            ..Default::default()
+        };
+        let progress = cas
+            .sweep_live(&LiveSet::open(&path).unwrap(), &options, |_, _| {})
+            .unwrap();
+        assert_eq!(progress.deleted, 0);
+        assert_eq!(progress.skipped_young, dead.len() as u64);
+
+        // Mark after the blobs: a dry run counts, a real run deletes
+        LiveSet::write(
+            &path,
+            live.iter().copied(),
+            SystemTime::now() + Duration::from_secs(1),
+        )
+        .unwrap();
+        let set = LiveSet::open(&path).unwrap();
+        let dry = cas
+            .sweep_live(
+                &set,
+                &SweepOptions {
+                    dry_run: true,
+                    ..options.clone()
+                },
+                |_, _| {},
+            )
+            .unwrap();
+        assert_eq!(dry.deleted, dead.len() as u64);
+        assert!(cas.exists(&dead[0]));
+
+        let reported = Mutex::new(Vec::new());
+        let progress = cas
+            .sweep_live(&set, &options, |_, deleted| {
+                reported.lock().unwrap().extend_from_slice(deleted)
+            })
+            .unwrap();
+        assert_eq!(progress.deleted, dead.len() as u64);
+        assert_eq!(progress.scanned, blobs.len() as u64);
+        assert_eq!(progress.shards_done, progress.shards_total);
+        assert!(live.iter().all(|h| cas.exists(h)));
+        assert!(dead.iter().all(|h| !cas.exists(h)));
+        let mut reported = reported.into_inner().unwrap();
+        reported.sort_unstable();
+        let mut expected = dead.to_vec();
+        expected.sort_unstable();
+        assert_eq!(reported, expected);
+    }
+
+    #[test]
+    fn test_sweep_keeps_materialized_copies_of_live_blobs() {
+        let temp = TempDir::new().unwrap();
+        let cas = CasStore::new(temp.path().join("cas"))
+            .unwrap()
+            .with_chunking(ChunkingConfig {
+                threshold: 64 * 1024,
+                min_size: 2 * 1024,
+                avg_size: 8 * 1024,
+                max_size: 32 * 1024,
+            });
+        let data: Vec<u8> = (0..256 * 1024u32)
+            .map(|i| (i * 7 + i / 251) as u8)
+            .collect();
+        let hash = cas.store(&data).unwrap();
+        let flat = cas.blob_path_for_hash(&hash).unwrap();
+        assert!(
+            flat.to_string_lossy().ends_with(".bin"),
+            "never a chunk list"
+        );
+        assert_eq!(fs::read(&flat).unwrap(), data);
+        assert_eq!(cas.blob_size(&hash), Some(data.len() as u64));
+
+        let path = temp.path().join("live.set");
+        LiveSet::write(&path, [hash], SystemTime::now() + Duration::from_secs(1)).unwrap();
+        let options = SweepOptions {
+            threads: 2,
+            min_age: Duration::ZERO,
+            ..Default::default()
+        };
+        let progress = cas
+            .sweep_live(&LiveSet::open(&path).unwrap(), &options, |_, _| {})
+            .unwrap();
+        assert_eq!(progress.deleted, 0);
+        assert!(flat.exists());
+        let lists = |dir: &Path| {
+            fs::read_dir(dir)
+                .unwrap()
+                .filter(|e| is_chunk_list(&e.as_ref().unwrap().path()))
+                .count()
+        };
+        assert_eq!(lists(flat.parent().unwrap()), 1, "chunks kept as well");
+        assert_eq!(cas.get(&hash).unwrap(), data);
+        assert_eq!(cas.blob_path_for_hash(&hash).unwrap(), flat);
+
+        // Dead: the copy goes with the chunk list and the chunks
+        LiveSet::write(&path, [], SystemTime::now() + Duration::from_secs(1)).unwrap();
+        cas.sweep_live(&LiveSet::open(&path).unwrap(), &options, |_, _| {})
+            .unwrap();
+        assert!(!flat.exists());
+        assert!(!cas.exists(&hash));
+    }
+
+    #[test]
+    fn test_sweep_keeps_old_chunks_of_young_lists() {
+        let temp = TempDir::new().unwrap();
+        let cas = CasStore::new(temp.path().join("cas"))
+            .unwrap()
+            .with_chunking(ChunkingConfig {
+                threshold: 64 * 1024,
+                min_size: 2 * 1024,
+                avg_size: 8 * 1024,
+                max_size: 32 * 1024,
+            });
+        let old: Vec<u8> = (0..256 * 1024u32)
+            .map(|i| (i * 7 + i / 251) as u8)
+            .collect();
+        let old_hash = cas.store(&old).unwrap();
+        std::thread::sleep(Duration::from_millis(50));
+        let marked_at = SystemTime::now();
+        std::thread::sleep(Duration::from_millis(50));
+
+        // Ingested after the mark: its list is young, most of its chunks
+        // are the old blob's, deduplicated
+        let mut young = old.clone();
+        young.extend_from_slice(b"appended after the mark");
+        let young_hash = cas.store(&young).unwrap();
+
+        let path = temp.path().join("live.set");
+        LiveSet::write(&path, [], marked_at).unwrap();
+        let options = SweepOptions {
+            threads: 2,
+            min_age: Duration::ZERO,
+            ..Default::default()
+        };
+        let progress = cas
+            .sweep_live(&LiveSet::open(&path).unwrap(), &options, |_, _| {})
+            .unwrap();
+        assert!(progress.deleted > 0, "the old list itself goes");
+        assert!(!cas.exists(&old_hash));
+        assert_eq!(cas.get(&young_hash).unwrap(), young);
+    }
+}
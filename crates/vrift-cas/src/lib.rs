@@ -15,6 +15,15 @@
 //!             └── abcd1234...efgh_12345.bin  # hash_size.ext
 //! ```
 //!
+//! With chunking enabled (`CasStore::with_chunking`), large files are stored
+//! as a `hash_size.chunks` chunk list over content-defined chunks, each of
+//! which is an ordinary blob (see [`chunking`]). Consumers that need a
+//! path get a flat `hash_size.bin` copy (`CasStore::materialize`); it costs
+//! the blob's size again on disk until a GC sweep drops it.
+//!
+//! With a remote tier (`CasStore::with_remote`), blobs missing locally are
+//! fetched by hash from a CAS shared between nodes (see [`remote`]).
+//!
 //! ## I/O Backend Abstraction
 //!
 //! The crate provides platform-specific I/O backends for optimal batch ingestion:
@@ -22,15 +31,24 @@
 //! - macOS: GCD-style dispatch
 //! - Fallback: Rayon thread pool
 
+pub mod chunking;
+pub mod gc;
 mod io_backend;
 pub mod link_strategy;
 pub mod parallel_ingest;
 pub mod protection;
 pub mod reflink;
+pub mod remote;
 pub mod streaming_ingest;
 pub mod streaming_pipeline;
+pub mod tree_hash;
+pub mod tree_walk;
 pub mod zero_copy_ingest;
 
+pub use chunking::{ChunkList, ChunkedBlob, ChunkingConfig};
+pub use gc::{LiveSet, SweepOptions, SweepProgress};
+#[cfg(all(target_os = "linux", feature = "io_uring"))]
+pub use io_backend::uring_backend;
 pub use io_backend::{create_backend, rayon_backend, IngestBackend};
 #[cfg(target_os = "macos")]
 pub use link_strategy::is_binary_sensitive;
@@ -43,10 +61,13 @@ pub use parallel_ingest::{
 pub use protection::{
     enforce_cas_invariant, is_immutable, set_immutable, CAS_FORBIDDEN_PERM_MASK, CAS_READ_ONLY_PERM,
 };
+pub use remote::{RemoteCas, RemoteStats, RemoteTier};
 pub use streaming_ingest::{
     streaming_ingest, streaming_ingest_cached, streaming_ingest_with_progress,
 };
 pub use streaming_pipeline::{IngestPipeline, IngestStats, PipelineConfig};
+pub use tree_hash::TreeHash;
+pub use tree_walk::{EntryKind, TreeWalker, WalkEntry};
 pub use zero_copy_ingest::{
     ingest_phantom, ingest_solid_tier1, ingest_solid_tier1_dedup, ingest_solid_tier2,
     ingest_solid_tier2_cached, ingest_solid_tier2_dedup, mtime_nsec_from_metadata, CacheHint,
@@ -57,9 +78,13 @@ use serde::{Deserialize, Serialize};
 use std::fs::{self, File};
 use std::io::{self, Read, Write};
 use std::path::{Path, PathBuf};
+use std::sync::Arc;
 
 use tracing::instrument;
 
+use chunking::{ChunkRef, FastCdc, CHUNK_LIST_EXT};
+use tree_hash::ByteRange;
+
 use thiserror::Error;
 
 /// BLAKE3 hash type (32 bytes)
@@ -86,6 +111,8 @@ pub type Result<T> = std::result::Result<T, CasError>;
 #[derive(Debug, Clone)]
 pub struct CasStore {
     root: PathBuf,
+    chunking: Option<ChunkingConfig>,
+    remote: Option<Arc<RemoteCas>>,
 }
 
 impl CasStore {
@@ -95,7 +122,37 @@ impl CasStore {
     pub fn new<P: AsRef<Path>>(root: P) -> Result<Self> {
         let root = root.as_ref().to_path_buf();
         fs::create_dir_all(&root)?;
-        Ok(Self { root })
+        Ok(Self {
+            root,
+            chunking: None,
+            remote: None,
+        })
+    }
+
+    /// Store files at or above `config.threshold` as content-defined chunks.
+    ///
+    /// Applies to `store` and `store_by_move`; readers handle both forms
+    /// regardless of this setting.
+    pub fn with_chunking(mut self, config: ChunkingConfig) -> Self {
+        self.chunking = Some(config);
+        self
+    }
+
+    /// Fetch blobs missing locally from `remote` (opened over this root).
+    ///
+    /// Applies to the readers (`get`, `get_mmap`, `materialize`, ...) and
+    /// `exists`; stores still deduplicate against the local tree only.
+    pub fn with_remote(mut self, remote: Arc<RemoteCas>) -> Self {
+        self.remote = Some(remote);
+        self
+    }
+
+    pub fn remote(&self) -> Option<&Arc<RemoteCas>> {
+        self.remote.as_ref()
+    }
+
+    fn chunking_for(&self, size: u64) -> Option<ChunkingConfig> {
+        self.chunking.filter(|c| c.applies_to(size))
     }
 
     /// Create a CAS store at the default location (`~/.vrift/the_source/`).
@@ -146,25 +203,111 @@ impl CasStore {
     ///
     /// Returns the path if found, None otherwise.
     /// Only supports new format: `hash_size.ext` (with size and optional extension)
+    /// A flat blob is preferred over a chunk list for the same hash.
     fn find_blob_path(&self, hash: &Blake3Hash) -> Option<PathBuf> {
         let dir = self.blob_dir(hash);
         if !dir.exists() {
             return None;
         }
 
-        let hex = Self::hash_to_hex(hash);
+        let prefix = format!("{}_", Self::hash_to_hex(hash));
+        let mut chunk_list = None;
         if let Ok(entries) = fs::read_dir(&dir) {
             for entry in entries.flatten() {
                 let filename = entry.file_name();
                 let filename_str = filename.to_string_lossy();
-                // Match pattern: <hash>_* (RFC-0039 format only)
-                if filename_str.starts_with(&format!("{}_", hex)) {
-                    return Some(entry.path());
+                // Match pattern: <hash>_* (RFC-0039 format only), skipping in-flight temp files
+                if !filename_str.starts_with(&prefix) || filename_str.ends_with(".tmp") {
+                    continue;
+                }
+                let path = entry.path();
+                if is_chunk_list(&path) {
+                    chunk_list = Some(path);
+                } else {
+                    return Some(path);
                 }
             }
         }
 
-        None
+        chunk_list
+    }
+
+    /// Local path of a blob, fetching it from the remote tier on a miss.
+    fn locate(&self, hash: &Blake3Hash) -> Result<PathBuf> {
+        if let Some(path) = self.find_blob_path(hash) {
+            if let Some(remote) = &self.remote {
+                remote.touch(hash);
+            }
+            return Ok(path);
+        }
+        let fetched = match &self.remote {
+            Some(remote) => remote.fetch_into(self, hash)?,
+            None => None,
+        };
+        fetched.ok_or_else(|| CasError::NotFound {
+            hash: Self::hash_to_hex(hash),
+        })
+    }
+
+    /// Fetch the blobs of `hashes` missing locally from the remote tier,
+    /// in parallel. Best effort; returns how many were fetched.
+    pub fn fetch_missing(&self, hashes: &[Blake3Hash]) -> usize {
+        use rayon::prelude::*;
+
+        let Some(remote) = &self.remote else {
+            return 0;
+        };
+        remote.install(|| {
+            hashes
+                .par_iter()
+                .filter(|hash| self.find_blob_path(hash).is_none())
+                .map(|hash| match remote.fetch_into(self, hash) {
+                    Ok(fetched) => fetched.is_some() as usize,
+                    Err(e) => {
+                        tracing::warn!(hash = %Self::hash_to_hex(hash), error = %e, "Remote fetch failed");
+                        0
+                    }
+                })
+                .sum()
+        })
+    }
+
+    /// Write local blobs of `hashes` the remote tier lacks back to it, in
+    /// parallel. Best effort; returns how many were pushed.
+    pub fn push(&self, hashes: &[Blake3Hash]) -> usize {
+        use rayon::prelude::*;
+
+        let Some(remote) = &self.remote else {
+            return 0;
+        };
+        let push_one = |hash: &Blake3Hash| -> Result<bool> {
+            if remote.tier().contains(hash)? {
+                return Ok(false);
+            }
+            let Some(path) = self.find_blob_path(hash) else {
+                return Ok(false);
+            };
+            let data = if is_chunk_list(&path) {
+                self.open_chunked(&path)?.to_vec()
+            } else {
+                fs::read(&path)?
+            };
+            remote.tier().put(hash, &data)?;
+            remote.count_push();
+            Ok(true)
+        };
+        remote.install(|| {
+            hashes
+                .par_iter()
+                .map(|hash| match push_one(hash) {
+                    Ok(pushed) => pushed as usize,
+                    Err(e) => {
+                        tracing::warn!(hash = %Self::hash_to_hex(hash), error = %e, "Remote push failed");
+                        0
+                    }
+                })
+                .sum()
+        })
     }
 
     /// Get the path for a self-describing blob (RFC-0039 format).
@@ -191,6 +334,14 @@ impl CasStore {
     /// Uses RFC-0039 format: `blake3/ab/cd/hash_size`
     #[instrument(skip(self, data), level = "debug")]
     pub fn store(&self, data: &[u8]) -> Result<Blake3Hash> {
+        match self.chunking_for(data.len() as u64) {
+            Some(config) => self.store_chunked(data, &config),
+            None => self.store_flat(data),
+        }
+    }
+
+    /// Store bytes as a single blob.
+    fn store_flat(&self, data: &[u8]) -> Result<Blake3Hash> {
         let hash = Self::compute_hash(data);
         let size = data.len() as u64;
 
@@ -201,13 +352,121 @@ impl CasStore {
 
         // RFC-0039 format: hash_size (no extension for raw bytes)
         let path = self.blob_path_with_metadata(&hash, size, "");
+        self.write_blob_file(&hash, &path, |file| file.write_all(data))?;
+        Ok(hash)
+    }
+
+    /// Store bytes as content-defined chunks plus a chunk list.
+    ///
+    /// Chunks already in the CAS (e.g. from a previous version of the same
+    /// artifact) are deduplicated, so only changed chunks are written.
+    fn store_chunked(&self, data: &[u8], config: &ChunkingConfig) -> Result<Blake3Hash> {
+        let hash = Self::compute_hash(data);
+        if self.find_blob_path(&hash).is_some() {
+            return Ok(hash);
+        }
+
+        let pieces = FastCdc::new(data, config).map(Piece::New).collect();
+        let list = self.store_pieces(pieces)?;
+        self.write_chunk_list(&hash, &list)?;
+        Ok(hash)
+    }
+
+    /// Store the new pieces of a chunked file (in parallel) and list them
+    /// together with the reused ones, in file order.
+    fn store_pieces(&self, pieces: Vec<Piece<'_>>) -> Result<ChunkList> {
+        use rayon::prelude::*;
+
+        let refs = pieces
+            .par_iter()
+            .map(|piece| match piece {
+                Piece::Reused(chunk) => Ok(*chunk),
+                Piece::New(data) => Ok(ChunkRef {
+                    hash: self.store_flat(data)?,
+                    len: data.len() as u64,
+                }),
+            })
+            .collect::<Result<Vec<_>>>()?;
+
+        let mut list = ChunkList::default();
+        for chunk in refs {
+            list.push(chunk.hash, chunk.len);
+        }
+        Ok(list)
+    }
+
+    fn write_chunk_list(&self, hash: &Blake3Hash, list: &ChunkList) -> Result<()> {
+        let path = self.blob_path_with_metadata(hash, list.size, CHUNK_LIST_EXT);
+        let encoded = list.encode();
+        self.write_blob_file(hash, &path, |file| file.write_all(&encoded))
+    }
+
+    /// Re-chunk `data`, a new version of the chunked blob `old` that differs
+    /// from it only inside `dirty`. Old chunks clean of `dirty` are reused
+    /// without touching their bytes; CDC restarts at the first dirty chunk
+    /// and runs until a cut lands on the start of a reusable old chunk.
+    fn rechunk<'a>(
+        data: &'a [u8],
+        config: &ChunkingConfig,
+        old: &ChunkList,
+        dirty: &[ByteRange],
+    ) -> Vec<Piece<'a>> {
+        let size = data.len() as u64;
+        let mut starts = Vec::with_capacity(old.chunks.len());
+        let mut offset = 0;
+        for chunk in &old.chunks {
+            starts.push(offset);
+            offset += chunk.len;
+        }
+        let reusable = |j: usize| {
+            let (start, end) = (starts[j], starts[j] + old.chunks[j].len);
+            end <= size && !tree_hash::overlaps(dirty, (start, end))
+        };
+
+        let mut pieces = Vec::new();
+        let (mut pos, mut j) = (0u64, 0usize);
+        while pos < size {
+            if j < starts.len() && starts[j] == pos && reusable(j) {
+                pieces.push(Piece::Reused(old.chunks[j]));
+                pos += old.chunks[j].len;
+                j += 1;
+                continue;
+            }
+            for chunk in FastCdc::new(&data[pos as usize..], config) {
+                pieces.push(Piece::New(chunk));
+                pos += chunk.len() as u64;
+                if let Ok(k) = starts.binary_search(&pos) {
+                    if reusable(k) {
+                        j = k;
+                        break;
+                    }
+                }
+            }
+        }
+        pieces
+    }
+
+    /// Write a blob file atomically: unique temp file, fsync, rename, then
+    /// mark it read-only. Losing a rename race to the same content is fine.
+    fn write_blob_file<F>(&self, hash: &Blake3Hash, path: &Path, write: F) -> Result<()>
+    where
+        F: FnOnce(&mut File) -> io::Result<()>,
+    {
+        let temp_path = Self::write_blob_temp(path, write)?;
+        self.publish_blob_file(hash, &temp_path, path)
+    }
 
+    /// First half of `write_blob_file`: write and fsync a unique temp file
+    /// next to `path`, returning the temp path
+    pub(crate) fn write_blob_temp<F>(path: &Path, write: F) -> Result<PathBuf>
+    where
+        F: FnOnce(&mut File) -> io::Result<()>,
+    {
         // Create prefix directory
         if let Some(parent) = path.parent() {
             fs::create_dir_all(parent)?;
         }
 
-        // Write atomically using temp file + rename
         // Use unique temp name to avoid race conditions in parallel mode
         let temp_name = format!(
             "{}.{}.{:?}.tmp",
@@ -217,16 +476,28 @@ impl CasStore {
         );
         let temp_path = path.with_file_name(&temp_name);
         let mut file = File::create(&temp_path)?;
-        file.write_all(data)?;
-        file.sync_all()?;
+        if let Err(e) = write(&mut file).and_then(|_| file.sync_all()) {
+            let _ = fs::remove_file(&temp_path);
+            return Err(CasError::Io(e));
+        }
+        Ok(temp_path)
+    }
 
+    /// Second half of `write_blob_file`: rename the synced temp file to
+    /// `path` and mark it read-only
+    pub(crate) fn publish_blob_file(
+        &self,
+        hash: &Blake3Hash,
+        temp_path: &Path,
+        path: &Path,
+    ) -> Result<()> {
         // Atomic rename - if another thread beat us, that's fine (same content)
-        if let Err(e) = fs::rename(&temp_path, &path) {
+        if let Err(e) = fs::rename(temp_path, path) {
             // Clean up orphaned temp file if rename failed
-            let _ = fs::remove_file(&temp_path);
+            let _ = fs::remove_file(temp_path);
             // If the target exists now (race), that's OK - dedup succeeded
-            if self.find_blob_path(&hash).is_some() {
-                return Ok(hash);
+            if self.find_blob_path(hash).is_some() {
+                return Ok(());
             }
             return Err(CasError::Io(e));
         }
@@ -235,10 +506,10 @@ impl CasStore {
         #[cfg(unix)]
         {
             use std::os::unix::fs::PermissionsExt;
-            let _ = fs::set_permissions(&path, fs::Permissions::from_mode(0o444));
+            let _ = fs::set_permissions(path, fs::Permissions::from_mode(0o444));
         }
 
-        Ok(hash)
+        Ok(())
     }
 
     /// Compute the BLAKE3 hash of the given reader.
@@ -266,6 +537,17 @@ impl CasStore {
         let src = src_path.as_ref();
         let file = File::open(src)?;
         let size = file.metadata()?.len();
+
+        // Chunked: only chunks that changed since the previous version are written
+        if let Some(config) = self.chunking_for(size) {
+            // Safety: the source is a private temp file being consumed by this call
+            let map = unsafe { memmap2::Mmap::map(&file) }.map_err(io::Error::other)?;
+            let hash = self.store_chunked(&map, &config)?;
+            drop(map);
+            let _ = fs::remove_file(src);
+            return Ok(hash);
+        }
+
         let hash = Self::compute_hash_reader(file)?;
 
         // Deduplication: if already exists, just remove the temp file
@@ -275,20 +557,66 @@ impl CasStore {
         }
 
         // RFC-0039 format: hash_size (no extension)
-        let path = self.blob_path_with_metadata(&hash, size, "");
+        self.move_blob(src, &self.blob_path_with_metadata(&hash, size, ""))?;
+        Ok(hash)
+    }
 
+    /// `store_by_move` for a file whose hash the caller already computed
+    /// (e.g. with `TreeHash::update`); the content is not rehashed.
+    ///
+    /// With chunking, `rechunk` names the previous version of the file and
+    /// the byte ranges changed since: its untouched chunks are reused
+    /// without reading them (see `rechunk`).
+    #[instrument(skip(self, src_path, rechunk), level = "info")]
+    pub fn store_by_move_hashed<P: AsRef<Path>>(
+        &self,
+        src_path: P,
+        hash: &Blake3Hash,
+        rechunk: Option<(&Blake3Hash, &[ByteRange])>,
+    ) -> Result<()> {
+        let src = src_path.as_ref();
+        if self.find_blob_path(hash).is_some() {
+            let _ = fs::remove_file(src);
+            return Ok(());
+        }
+        let file = File::open(src)?;
+        let size = file.metadata()?.len();
+
+        if let Some(config) = self.chunking_for(size) {
+            let base = match rechunk {
+                Some((base, dirty)) => self.chunk_list(base).ok().flatten().map(|l| (l, dirty)),
+                None => None,
+            };
+            // Safety: the source is a private temp file being consumed by this call
+            let map = unsafe { memmap2::Mmap::map(&file) }.map_err(io::Error::other)?;
+            let pieces = match &base {
+                Some((old, dirty)) => Self::rechunk(&map, &config, old, dirty),
+                None => FastCdc::new(&map, &config).map(Piece::New).collect(),
+            };
+            let list = self.store_pieces(pieces)?;
+            drop(map);
+            self.write_chunk_list(hash, &list)?;
+            let _ = fs::remove_file(src);
+            return Ok(());
+        }
+
+        self.move_blob(src, &self.blob_path_with_metadata(hash, size, ""))
+    }
+
+    /// Move a file into place as a blob (copying across filesystems).
+    fn move_blob(&self, src: &Path, path: &Path) -> Result<()> {
         // Create prefix directory
         if let Some(parent) = path.parent() {
             fs::create_dir_all(parent)?;
         }
 
         // Try atomic rename (move)
-        if let Err(e) = fs::rename(src, &path) {
+        if let Err(e) = fs::rename(src, path) {
             // Check for cross-device link error (EXDEV)
             if e.raw_os_error() == Some(libc::EXDEV) {
                 tracing::debug!("CAS: Cross-device move detected, falling back to copy");
                 let mut src_file = File::open(src)?;
-                let mut dst_file = File::create(&path)?;
+                let mut dst_file = File::create(path)?;
                 io::copy(&mut src_file, &mut dst_file)?;
                 let _ = fs::remove_file(src);
             } else {
@@ -300,10 +628,10 @@ impl CasStore {
         #[cfg(unix)]
         {
             use std::os::unix::fs::PermissionsExt;
-            let _ = fs::set_permissions(&path, fs::Permissions::from_mode(0o444));
+            let _ = fs::set_permissions(path, fs::Permissions::from_mode(0o444));
         }
 
-        Ok(hash)
+        Ok(())
     }
 
     /// Store a file in the CAS by reading from the filesystem.
@@ -318,18 +646,16 @@ impl CasStore {
     /// Retrieve bytes from the CAS by hash.
     #[instrument(skip(self), level = "debug")]
     pub fn get(&self, hash: &Blake3Hash) -> Result<Vec<u8>> {
-        let path = match self.find_blob_path(hash) {
-            Some(p) => p,
-            None => {
-                return Err(CasError::NotFound {
-                    hash: Self::hash_to_hex(hash),
-                })
-            }
-        };
+        let path = self.locate(hash)?;
 
-        let mut file = File::open(&path)?;
-        let mut data = Vec::new();
-        file.read_to_end(&mut data)?;
+        let data = if is_chunk_list(&path) {
+            self.open_chunked(&path)?.to_vec()
+        } else {
+            let mut file = File::open(&path)?;
+            let mut data = Vec::new();
+            file.read_to_end(&mut data)?;
+            data
+        };
 
         // Verify hash on read (integrity check)
         let actual_hash = Self::compute_hash(&data);
@@ -343,28 +669,74 @@ impl CasStore {
         Ok(data)
     }
 
-    /// Check if a blob exists in the CAS.
+    /// Check if a blob exists in the CAS (or, with one, the remote tier).
     pub fn exists(&self, hash: &Blake3Hash) -> bool {
         self.find_blob_path(hash).is_some()
+            || self
+                .remote
+                .as_ref()
+                .is_some_and(|remote| remote.tier().contains(hash).unwrap_or(false))
     }
 
     /// Delete a blob from the CAS.
     ///
     /// Handles both old format (hash) and new format (hash_size.ext).
+    /// A chunked blob loses its chunk list and any materialized copy; its
+    /// chunks are left for `sweep`, since other versions may share them.
     pub fn delete(&self, hash: &Blake3Hash) -> Result<()> {
-        match self.find_blob_path(hash) {
-            Some(path) => {
-                // RFC-0039: Best effort to unset immutable flag before deletion
-                // This allows GC to clean up protected blobs.
-                let _ = crate::protection::set_immutable(&path, false);
-
-                fs::remove_file(path)?;
-                Ok(())
-            }
-            None => Err(CasError::NotFound {
+        let mut deleted = false;
+        while let Some(path) = self.find_blob_path(hash) {
+            // RFC-0039: Best effort to unset immutable flag before deletion
+            // This allows GC to clean up protected blobs.
+            let _ = crate::protection::set_immutable(&path, false);
+
+            fs::remove_file(path)?;
+            deleted = true;
+        }
+        if !deleted {
+            return Err(CasError::NotFound {
                 hash: Self::hash_to_hex(hash),
-            }),
+            });
+        }
+        let _ = fs::remove_file(self.tree_path(hash));
+        Ok(())
+    }
+
+    /// Hash-tree outboards live beside, not inside, `blake3/`, so blob
+    /// scans never see them: `tree/ab/cd/<hash>.tree`
+    fn tree_path(&self, hash: &Blake3Hash) -> PathBuf {
+        let hex = Self::hash_to_hex(hash);
+        self.root
+            .join("tree")
+            .join(&hex[..2])
+            .join(&hex[2..4])
+            .join(format!("{}.tree", hex))
+    }
+
+    /// Keep the hash tree of a blob for incremental rehashing of its next
+    /// version (see [`tree_hash`]).
+    pub fn save_tree(&self, tree: &TreeHash) -> Result<()> {
+        let path = self.tree_path(&tree.root());
+        if let Some(parent) = path.parent() {
+            fs::create_dir_all(parent)?;
+        }
+        let temp_path = path.with_extension(format!(
+            "{}.{:?}.tmp",
+            std::process::id(),
+            std::thread::current().id()
+        ));
+        fs::write(&temp_path, tree.encode())?;
+        if let Err(e) = fs::rename(&temp_path, &path) {
+            let _ = fs::remove_file(&temp_path);
+            return Err(CasError::Io(e));
         }
+        Ok(())
+    }
+
+    /// Hash tree saved for `hash`, if any (an unreadable one counts as none).
+    pub fn load_tree(&self, hash: &Blake3Hash) -> Option<TreeHash> {
+        let bytes = fs::read(self.tree_path(hash)).ok()?;
+        TreeHash::decode(&bytes).ok().filter(|t| t.root() == *hash)
     }
 
     /// Get the root path of the CAS.
@@ -444,24 +816,99 @@ impl CasStore {
     /// This is more efficient than `get()` for large files as it avoids copying
     /// the data into memory. The file is mapped directly from the filesystem,
     /// leveraging the page cache for sharing across processes.
+    /// Chunked blobs are reassembled from their mapped chunks into an
+    /// anonymous mapping; use `get_chunked` to read them without the copy.
     #[instrument(skip(self), level = "debug")]
     pub fn get_mmap(&self, hash: &Blake3Hash) -> Result<memmap2::Mmap> {
-        let path = match self.find_blob_path(hash) {
-            Some(p) => p,
-            None => {
-                return Err(CasError::NotFound {
-                    hash: Self::hash_to_hex(hash),
-                })
-            }
-        };
+        let path = self.locate(hash)?;
 
-        let file = File::open(&path)?;
+        if is_chunk_list(&path) {
+            return Ok(self.open_chunked(&path)?.into_mmap()?);
+        }
+        Self::map_file(&path)
+    }
+
+    fn map_file(path: &Path) -> Result<memmap2::Mmap> {
+        let file = File::open(path)?;
         // Safety: The file is read-only and we're not modifying it
         let mmap = unsafe { memmap2::Mmap::map(&file) }.map_err(io::Error::other)?;
 
         Ok(mmap)
     }
 
+    /// Chunk list of a chunked blob (None if the blob is stored flat).
+    pub fn chunk_list(&self, hash: &Blake3Hash) -> Result<Option<ChunkList>> {
+        let path = self.locate(hash)?;
+        if !is_chunk_list(&path) {
+            return Ok(None);
+        }
+        Ok(Some(ChunkList::decode(&fs::read(path)?)?))
+    }
+
+    /// Zero-copy view of a chunked blob, every chunk mapped from its own
+    /// blob (None if the blob is stored flat; use `get_mmap` then).
+    pub fn get_chunked(&self, hash: &Blake3Hash) -> Result<Option<ChunkedBlob>> {
+        let path = self.locate(hash)?;
+        if !is_chunk_list(&path) {
+            return Ok(None);
+        }
+        Ok(Some(self.open_chunked(&path)?))
+    }
+
+    fn open_chunked(&self, list_path: &Path) -> Result<ChunkedBlob> {
+        let list = ChunkList::decode(&fs::read(list_path)?)?;
+        let mut maps = Vec::with_capacity(list.chunks.len());
+        for chunk in &list.chunks {
+            let path = self
+                .find_blob_path(&chunk.hash)
+                .filter(|p| !is_chunk_list(p))
+                .ok_or_else(|| CasError::NotFound {
+                    hash: Self::hash_to_hex(&chunk.hash),
+                })?;
+            let map = Self::map_file(&path)?;
+            if map.len() as u64 != chunk.len {
+                return Err(CasError::Io(io::Error::new(
+                    io::ErrorKind::InvalidData,
+                    format!("chunk {} has the wrong size", path.display()),
+                )));
+            }
+            maps.push(map);
+        }
+        Ok(ChunkedBlob::new(list.size, maps))
+    }
+
+    /// Ensure a blob exists as a single flat file and return its path.
+    ///
+    /// Consumers that open blobs by path (the inception layer, link farms)
+    /// need this for chunked blobs; for flat blobs it is just a lookup.
+    /// The copy is built once: lookups prefer it over the chunk list, and
+    /// GC pins it while the blob is live, so the chunks' bytes are stored
+    /// twice from the first open until the blob dies.
+    pub fn materialize(&self, hash: &Blake3Hash) -> Result<PathBuf> {
+        let path = self.locate(hash)?;
+        if !is_chunk_list(&path) {
+            return Ok(path);
+        }
+
+        let blob = self.open_chunked(&path)?;
+        let mut hasher = blake3::Hasher::new();
+        for chunk in blob.chunks() {
+            hasher.update(chunk);
+        }
+        let actual = *hasher.finalize().as_bytes();
+        if actual != *hash {
+            return Err(CasError::HashMismatch {
+                expected: Self::hash_to_hex(hash),
+                actual: Self::hash_to_hex(&actual),
+            });
+        }
+
+        // `.bin`: the name the inception layer's direct blob open expects
+        let flat = self.blob_path_with_metadata(hash, blob.len(), "bin");
+        self.write_blob_file(hash, &flat, |file| blob.write_to(file))?;
+        Ok(flat)
+    }
+
     /// Get an iterator over all blob hashes in the CAS.
     ///
     /// Traverses the 3-level structure: blake3/ab/cd/hash
@@ -484,43 +931,41 @@ impl CasStore {
         })
     }
 
-    /// Perform a Garbage Collection sweep using a Bloom Filter of active hashes.
-    ///
-    /// Returns (deleted_count, reclaimed_bytes).
-    pub fn sweep(&self, bloom_bits: &[u8]) -> Result<(u32, u64)> {
-        let bloom = BloomFilter {
-            bits: bloom_bits.to_vec(),
-        };
-
-        let mut deleted_count = 0;
-        let mut reclaimed_bytes = 0;
-
-        for hash_res in self.iter()? {
-            let hash = hash_res?;
-
-            // Convert Blake3Hash ([u8; 32]) to hex string for bloom lookup
-            let hex = Self::hash_to_hex(&hash);
-
-            if !bloom.contains(&hex) {
-                // Potential orphan (not in Bloom Filter)
-                if let Some(path) = self.find_blob_path(&hash) {
-                    if let Ok(meta) = fs::metadata(&path) {
-                        let size = meta.len();
-                        // Delete the blob (handles immutable flags internally)
-                        if self.delete(&hash).is_ok() {
-                            deleted_count += 1;
-                            reclaimed_bytes += size;
-                        }
-                    }
-                }
+    /// Path of a local blob as a single flat file, for consumers that open
+    /// or link blobs by path. A chunked blob is materialized first (see
+    /// `materialize`), so a chunk list is never returned. Does not fetch
+    /// from the remote tier.
+    pub fn blob_path_for_hash(&self, hash: &Blake3Hash) -> Option<PathBuf> {
+        let path = self.find_blob_path(hash)?;
+        if !is_chunk_list(&path) {
+            return Some(path);
+        }
+        match self.materialize(hash) {
+            Ok(flat) => Some(flat),
+            Err(e) => {
+                tracing::warn!(hash = %Self::hash_to_hex(hash), error = %e, "Failed to materialize chunked blob");
+                None
             }
         }
+    }
 
-        Ok((deleted_count, reclaimed_bytes))
+    /// Size of a local blob, read from its self-describing `hash_size.ext`
+    /// name: no stat, and no materialization for chunked blobs.
+    pub fn blob_size(&self, hash: &Blake3Hash) -> Option<u64> {
+        let path = self.find_blob_path(hash)?;
+        let name = path.file_name()?.to_str()?;
+        name.split('_').nth(1)?.split('.').next()?.parse().ok()
     }
 
-    pub fn blob_path_for_hash(&self, hash: &Blake3Hash) -> Option<PathBuf> {
-        self.find_blob_path(hash)
+    /// Metadata of a local blob's file: its chunk list if it is chunked
+    /// (take the content size from `blob_size`).
+    pub fn blob_metadata(&self, hash: &Blake3Hash) -> Result<fs::Metadata> {
+        let path = self
+            .find_blob_path(hash)
+            .ok_or_else(|| CasError::NotFound {
+                hash: Self::hash_to_hex(hash),
+            })?;
+        Ok(fs::metadata(path)?)
     }
 
     /// Pre-create CAS directory structure to avoid per-file mkdir overhead.
@@ -564,6 +1009,16 @@ impl CasStore {
     }
 }
 
+/// A chunk of a file being stored chunked: already in the CAS, or new bytes
+enum Piece<'a> {
+    Reused(ChunkRef),
+    New(&'a [u8]),
+}
+
+fn is_chunk_list(path: &Path) -> bool {
+    path.extension().is_some_and(|ext| ext == CHUNK_LIST_EXT)
+}
+
 // ============================================================================
 // Bloom Filter (RFC-0041 / RFC-0044)
 // ============================================================================
@@ -1183,4 +1638,151 @@ mod tests {
             "Iterator should find all stored hashes"
         );
     }
+
+    fn chunked_cas(root: &Path) -> CasStore {
+        CasStore::new(root).unwrap().with_chunking(ChunkingConfig {
+            threshold: 64 * 1024,
+            min_size: 2 * 1024,
+            avg_size: 8 * 1024,
+            max_size: 32 * 1024,
+        })
+    }
+
+    fn artifact(len: usize) -> Vec<u8> {
+        let mut state = 0x2545_f491_4f6c_dd1du64;
+        (0..len)
+            .map(|_| {
+                state ^= state << 13;
+                state ^= state >> 7;
+                state ^= state << 17;
+                state as u8
+            })
+            .collect()
+    }
+
+    #[test]
+    fn test_chunked_store_roundtrip() {
+        let temp = TempDir::new().unwrap();
+        let cas = chunked_cas(temp.path());
+
+        let data = artifact(512 * 1024);
+        let hash = cas.store(&data).unwrap();
+        assert_eq!(hash, CasStore::compute_hash(&data));
+
+        let list = cas.chunk_list(&hash).unwrap().expect("stored chunked");
+        assert!(list.chunks.len() > 1);
+        assert_eq!(list.size, data.len() as u64);
+        assert_eq!(cas.get(&hash).unwrap(), data);
+        assert_eq!(&cas.get_mmap(&hash).unwrap()[..], &data[..]);
+
+        let view = cas.get_chunked(&hash).unwrap().unwrap();
+        let mut buf = [0u8; 100];
+        assert_eq!(view.read_at(300_000, &mut buf), 100);
+        assert_eq!(&buf[..], &data[300_000..300_100]);
+
+        // Small blobs stay flat
+        let small = cas.store(b"small").unwrap();
+        assert!(cas.chunk_list(&small).unwrap().is_none());
+    }
+
+    #[test]
+    fn test_chunked_reingest_writes_only_changed_chunks() {
+        let temp = TempDir::new().unwrap();
+        let cas = chunked_cas(&temp.path().join("cas"));
+
+        let v1 = artifact(1024 * 1024);
+        let mut v2 = v1.clone();
+        v2[600_000..600_016].copy_from_slice(b"patched section!");
+
+        let h1 = cas.store(&v1).unwrap();
+        let blobs_v1 = cas.stats().unwrap().blob_count;
+
+        let staged = temp.path().join("staged.tmp");
+        fs::write(&staged, &v2).unwrap();
+        let h2 = cas.store_by_move(&staged).unwrap();
+        assert!(!staged.exists());
+
+        let new_blobs = cas.stats().unwrap().blob_count - blobs_v1;
+        let chunks = cas.chunk_list(&h2).unwrap().unwrap().chunks.len() as u64;
+        // One new chunk list plus the chunks around the edit
+        assert!(
+            new_blobs <= 4,
+            "{} new blobs for {} chunks",
+            new_blobs,
+            chunks
+        );
+        assert_eq!(cas.get(&h2).unwrap(), v2);
+
+        // GC: chunks shared with the live v2 survive v1's deletion
+        let mut bloom = BloomFilter::new(BLOOM_SIZE);
+        bloom.add(&CasStore::hash_to_hex(&h2));
+        cas.sweep(&bloom.bits).unwrap();
+        assert!(!cas.exists(&h1));
+        assert_eq!(cas.get(&h2).unwrap(), v2);
+    }
+
+    #[test]
+    fn test_materialize_chunked_blob() {
+        let temp = TempDir::new().unwrap();
+        let cas = chunked_cas(temp.path());
+
+        let data = artifact(256 * 1024);
+        let hash = cas.store(&data).unwrap();
+        let flat = cas.materialize(&hash).unwrap();
+
+        assert_eq!(fs::read(&flat).unwrap(), data);
+        assert!(
+            cas.chunk_list(&hash).unwrap().is_none(),
+            "flat copy preferred"
+        );
+        assert_eq!(cas.materialize(&hash).unwrap(), flat);
+
+        cas.delete(&hash).unwrap();
+        assert!(!cas.exists(&hash));
+    }
+
+    #[test]
+    fn test_delta_reingest_reuses_tree_and_chunks() {
+        let temp = TempDir::new().unwrap();
+        let cas = chunked_cas(&temp.path().join("cas"));
+
+        let v1 = artifact(2 * 1024 * 1024);
+        let h1 = cas.store(&v1).unwrap();
+        let staged = temp.path().join("v1.tmp");
+        fs::write(&staged, &v1).unwrap();
+        let t1 = TreeHash::compute(&File::open(&staged).unwrap(), v1.len() as u64).unwrap();
+        assert_eq!(t1.root(), h1);
+        cas.save_tree(&t1).unwrap();
+
+        // In-place patch plus an append, as tracked by the inception layer
+        let mut v2 = v1.clone();
+        v2[1_000_000..1_000_032].fill(0x5a);
+        v2.extend_from_slice(&artifact(10_000));
+        fs::write(&staged, &v2).unwrap();
+        let dirty = tree_hash::dirty_ranges(
+            &[(1_000_000, 1_000_032), (v1.len() as u64, v2.len() as u64)],
+            v1.len() as u64,
+            u64::MAX,
+            v2.len() as u64,
+        );
+
+        let base = cas.load_tree(&h1).expect("tree saved");
+        let t2 = base
+            .update(&File::open(&staged).unwrap(), v2.len() as u64, &dirty)
+            .unwrap();
+        let h2 = t2.root();
+        assert_eq!(h2, CasStore::compute_hash(&v2));
+
+        let blobs_v1 = cas.stats().unwrap().blob_count;
+        cas.store_by_move_hashed(&staged, &h2, Some((&h1, &dirty)))
+            .unwrap();
+        assert!(!staged.exists());
+        assert!(cas.stats().unwrap().blob_count - blobs_v1 <= 6);
+        assert_eq!(cas.get(&h2).unwrap(), v2);
+
+        cas.save_tree(&t2).unwrap();
+        assert_eq!(cas.load_tree(&h2), Some(t2));
+        cas.delete(&h2).unwrap();
+        assert!(cas.load_tree(&h2).is_none());
+    }
 }
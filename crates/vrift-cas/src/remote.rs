@@ -0,0 +1,952 @@
+//! Remote CAS tier
+//!
+//! Content hashes mean the same thing on every node, so one node's blobs
+//! can serve every other node that shares its manifests. A [`RemoteTier`]
+//! is a second CAS behind the local `blake3/` tree: `CasStore` readers
+//! (`get`, `get_mmap`, `materialize`, ...) fetch a missing blob from it,
+//! verify the hash and write it locally as `hash_size.bin`, so every later
+//! read is a local, zero-copy one. Newly ingested blobs can be pushed back.
+//!
+//! Remote objects hold whole blob content (chunked blobs are reassembled)
+//! under `blake3/ab/cd/<hex>`:
+//!
+//! - a directory: a shared mount (NFS, mountpoint-s3, ...), or another
+//!   node's export of it
+//! - `http://host[:port]/prefix`: GET / HEAD / PUT of that key, which plain
+//!   object stores and caching proxies serve. There is no TLS client; put
+//!   a local proxy in front of an `https` endpoint.
+//!
+//! Fetched blobs live in the local CAS as a bounded cache: past
+//! `cache_limit` bytes, the least recently used fetched ones are deleted
+//! (they can always be fetched again). Blobs ingested locally are never
+//! evicted, and neither is the blob just fetched, even alone over the
+//! limit. Reads through `CasStore`, access traces and prefetch hints mark
+//! fetched blobs used. Fetches and uses are recorded in `remote_fetched.log`
+//! under the CAS root, so the bound and the LRU order hold across restarts;
+//! the log is compacted once it holds twice as many records as the cache.
+
+use std::collections::{BTreeMap, HashMap};
+use std::fs::{self, File, OpenOptions};
+use std::io::{self, BufRead, BufReader, Read, Write};
+use std::net::{TcpStream, ToSocketAddrs};
+use std::path::{Path, PathBuf};
+use std::sync::atomic::{AtomicU64, Ordering};
+use std::sync::Mutex;
+use std::time::Duration;
+
+use crate::{Blake3Hash, CasError, CasStore, Result};
+
+/// Fetch journal under the CAS root
+const JOURNAL_NAME: &str = "remote_fetched.log";
+
+/// Journal record: hash then little-endian size
+const JOURNAL_RECORD: usize = 40;
+
+/// Journal records allowed beyond twice the cache before compacting
+const JOURNAL_SLACK: u64 = 1024;
+
+/// Connect, read and write timeout for HTTP remotes
+const HTTP_TIMEOUT: Duration = Duration::from_secs(30);
+
+/// Socket read buffer for HTTP responses
+const HTTP_READ_BUF: usize = 64 * 1024;
+
+/// Write buffer for a blob streamed in from the remote
+const FETCH_WRITE_BUF: usize = 256 * 1024;
+
+/// A second CAS shared between nodes, addressed by content hash
+pub trait RemoteTier: Send + Sync + std::fmt::Debug {
+    /// Stream the whole content of `hash` into `out`. False, with nothing
+    /// written, if the remote does not have it.
+    fn fetch_to(&self, hash: &Blake3Hash, out: &mut dyn Write) -> io::Result<bool>;
+
+    fn contains(&self, hash: &Blake3Hash) -> io::Result<bool>;
+
+    /// Store `data`, the content of `hash`
+    fn put(&self, hash: &Blake3Hash, data: &[u8]) -> io::Result<()>;
+}
+
+/// Remote object key of a blob: `blake3/ab/cd/<hex>`
+pub fn remote_key(hash: &Blake3Hash) -> String {
+    let hex = CasStore::hash_to_hex(hash);
+    format!("blake3/{}/{}/{}", &hex[..2], &hex[2..4], hex)
+}
+
+/// Open the tier at `url`: `http://...`, `file://...` or a directory path
+pub fn open_tier(url: &str) -> io::Result<Box<dyn RemoteTier>> {
+    if let Some(rest) = url.strip_prefix("http://") {
+        return Ok(Box::new(HttpTier::new(rest)?));
+    }
+    if url.starts_with("https://") {
+        return Err(io::Error::new(
+            io::ErrorKind::Unsupported,
+            "https remotes need a local TLS proxy; point the remote at it over http://",
+        ));
+    }
+    let path = url.strip_prefix("file://").unwrap_or(url);
+    Ok(Box::new(DirTier::new(path)))
+}
+
+/// Remote tier on a shared directory
+#[derive(Debug, Clone)]
+pub struct DirTier {
+    root: PathBuf,
+}
+
+impl DirTier {
+    pub fn new<P: AsRef<Path>>(root: P) -> Self {
+        Self {
+            root: root.as_ref().to_path_buf(),
+        }
+    }
+}
+
+impl RemoteTier for DirTier {
+    fn fetch_to(&self, hash: &Blake3Hash, out: &mut dyn Write) -> io::Result<bool> {
+        let mut file = match File::open(self.root.join(remote_key(hash))) {
+            Ok(file) => file,
+            Err(e) if e.kind() == io::ErrorKind::NotFound => return Ok(false),
+            Err(e) => return Err(e),
+        };
+        io::copy(&mut file, out)?;
+        Ok(true)
+    }
+
+    fn contains(&self, hash: &Blake3Hash) -> io::Result<bool> {
+        self.root.join(remote_key(hash)).try_exists()
+    }
+
+    fn put(&self, hash: &Blake3Hash, data: &[u8]) -> io::Result<()> {
+        let path = self.root.join(remote_key(hash));
+        if let Some(parent) = path.parent() {
+            fs::create_dir_all(parent)?;
+        }
+        // Other nodes read the same directory: publish by rename only
+        let temp = path.with_file_name(format!(
+            "{}.{}.{:?}.tmp",
+            CasStore::hash_to_hex(hash),
+            std::process::id(),
+            std::thread::current().id()
+        ));
+        let written = File::create(&temp).and_then(|mut file| {
+            file.write_all(data)?;
+            file.sync_all()
+        });
+        match written.and_then(|_| fs::rename(&temp, &path)) {
+            Ok(()) => Ok(()),
+            Err(e) => {
+                let _ = fs::remove_file(&temp);
+                Err(e)
+            }
+        }
+    }
+}
+
+/// Remote tier over plain HTTP/1.1, one connection per request
+#[derive(Debug, Clone)]
+pub struct HttpTier {
+    /// `host[:port]`, as sent in the Host header
+    host: String,
+    /// Path prefix without the trailing slash
+    prefix: String,
+}
+
+impl HttpTier {
+    /// `authority_and_path` is the URL after `http://`
+    pub fn new(authority_and_path: &str) -> io::Result<Self> {
+        let (host, prefix) = match authority_and_path.find('/') {
+            Some(i) => authority_and_path.split_at(i),
+            None => (authority_and_path, ""),
+        };
+        if host.is_empty() {
+            return Err(io::Error::new(
+                io::ErrorKind::InvalidInput,
+                "remote URL has no host",
+            ));
+        }
+        Ok(Self {
+            host: host.to_string(),
+            prefix: prefix.trim_end_matches('/').to_string(),
+        })
+    }
+
+    /// Send one request; the response body is read off the socket by the
+    /// caller, as it needs it
+    fn request(
+        &self,
+        method: &str,
+        hash: &Blake3Hash,
+        body: &[u8],
+    ) -> io::Result<(u16, HttpBody<BufReader<TcpStream>>)> {
+        let addr = if self.host.contains(':') {
+            self.host.clone()
+        } else {
+            format!("{}:80", self.host)
+        };
+        let addr = addr
+            .to_socket_addrs()?
+            .next()
+            .ok_or_else(|| io::Error::new(io::ErrorKind::NotFound, "remote host not found"))?;
+        let mut stream = TcpStream::connect_timeout(&addr, HTTP_TIMEOUT)?;
+        stream.set_read_timeout(Some(HTTP_TIMEOUT))?;
+        stream.set_write_timeout(Some(HTTP_TIMEOUT))?;
+        let _ = stream.set_nodelay(true);
+
+        let head = format!(
+            "{} {}/{} HTTP/1.1\r\nHost: {}\r\nConnection: close\r\nContent-Length: {}\r\n\r\n",
+            method,
+            self.prefix,
+            remote_key(hash),
+            self.host,
+            body.len()
+        );
+        stream.write_all(head.as_bytes())?;
+        stream.write_all(body)?;
+
+        read_response(
+            BufReader::with_capacity(HTTP_READ_BUF, stream),
+            method == "HEAD",
+        )
+    }
+
+    fn status_error(method: &str, hash: &Blake3Hash, status: u16) -> io::Error {
+        io::Error::other(format!("{} {}: HTTP {}", method, remote_key(hash), status))
+    }
+}
+
+impl RemoteTier for HttpTier {
+    fn fetch_to(&self, hash: &Blake3Hash, out: &mut dyn Write) -> io::Result<bool> {
+        match self.request("GET", hash, &[])? {
+            (200, mut body) => {
+                io::copy(&mut body, out)?;
+                Ok(true)
+            }
+            (404, _) => Ok(false),
+            (status, _) => Err(Self::status_error("GET", hash, status)),
+        }
+    }
+
+    fn contains(&self, hash: &Blake3Hash) -> io::Result<bool> {
+        match self.request("HEAD", hash, &[])?.0 {
+            200 => Ok(true),
+            404 => Ok(false),
+            status => Err(Self::status_error("HEAD", hash, status)),
+        }
+    }
+
+    fn put(&self, hash: &Blake3Hash, data: &[u8]) -> io::Result<()> {
+        match self.request("PUT", hash, data)?.0 {
+            200..=299 => Ok(()),
+            status => Err(Self::status_error("PUT", hash, status)),
+        }
+    }
+}
+
+fn invalid_response(msg: &str) -> io::Error {
+    io::Error::new(io::ErrorKind::InvalidData, msg.to_string())
+}
+
+/// One CRLF-terminated line, without the terminator
+fn read_http_line<R: BufRead>(reader: &mut R, line: &mut Vec<u8>) -> io::Result<()> {
+    line.clear();
+    if reader.read_until(b'\n', line)? == 0 || line.last() != Some(&b'\n') {
+        return Err(invalid_response("truncated HTTP response"));
+    }
+    line.pop();
+    if line.last() == Some(&b'\r') {
+        line.pop();
+    }
+    Ok(())
+}
+
+/// Read the status line and headers of an HTTP/1.1 response, leaving
+/// `reader` at the start of its body
+fn read_response<R: BufRead>(mut reader: R, head_only: bool) -> io::Result<(u16, HttpBody<R>)> {
+    let mut line = Vec::new();
+    read_http_line(&mut reader, &mut line)?;
+    let status = std::str::from_utf8(&line)
+        .ok()
+        .and_then(|l| l.split(' ').nth(1))
+        .and_then(|s| s.parse().ok())
+        .ok_or_else(|| invalid_response("bad HTTP status line"))?;
+
+    let mut length = None;
+    let mut chunked = false;
+    loop {
+        read_http_line(&mut reader, &mut line)?;
+        if line.is_empty() {
+            break;
+        }
+        let header = std::str::from_utf8(&line).map_err(|_| invalid_response("bad HTTP header"))?;
+        let Some((name, value)) = header.split_once(':') else {
+            continue;
+        };
+        let value = value.trim();
+        if name.eq_ignore_ascii_case("content-length") {
+            length = value.parse::<u64>().ok();
+        } else if name.eq_ignore_ascii_case("transfer-encoding") {
+            chunked = value.eq_ignore_ascii_case("chunked");
+        }
+    }
+
+    let framing = if head_only {
+        Framing::Done
+    } else if chunked {
+        Framing::Chunked {
+            left: 0,
+            started: false,
+        }
+    } else {
+        match length {
+            Some(n) => Framing::Length(n),
+            None => Framing::Eof,
+        }
+    };
+    Ok((status, HttpBody { reader, framing }))
+}
+
+/// How the end of an HTTP body is found
+#[derive(Debug)]
+enum Framing {
+    /// Content-Length: bytes still to read
+    Length(u64),
+    /// Transfer-Encoding: chunked; bytes left in the current chunk
+    Chunked {
+        left: u64,
+        started: bool,
+    },
+    /// Neither: the body runs to the end of the connection
+    Eof,
+    Done,
+}
+
+/// Body of an HTTP/1.1 response, de-framed as it is read
+struct HttpBody<R> {
+    reader: R,
+    framing: Framing,
+}
+
+impl<R: BufRead> Read for HttpBody<R> {
+    fn read(&mut self, buf: &mut [u8]) -> io::Result<usize> {
+        if buf.is_empty() {
+            return Ok(0);
+        }
+        loop {
+            let left = match self.framing {
+                Framing::Done => return Ok(0),
+                Framing::Eof => return self.reader.read(buf),
+                Framing::Length(0) => {
+                    self.framing = Framing::Done;
+                    return Ok(0);
+                }
+                Framing::Length(left) => left,
+                Framing::Chunked { left: 0, started } => {
+                    let mut line = Vec::new();
+                    if started {
+                        // CRLF closing the previous chunk's data
+                        read_http_line(&mut self.reader, &mut line)?;
+                        if !line.is_empty() {
+                            return Err(invalid_response("bad chunked body"));
+                        }
+                    }
+                    read_http_line(&mut self.reader, &mut line)?;
+                    let size = std::str::from_utf8(&line)
+                        .ok()
+                        .and_then(|field| field.split(';').next())
+                        .and_then(|hex| u64::from_str_radix(hex.trim(), 16).ok())
+                        .ok_or_else(|| invalid_response("bad chunked body"))?;
+                    self.framing = if size == 0 {
+                        Framing::Done
+                    } else {
+                        Framing::Chunked {
+                            left: size,
+                            started: true,
+                        }
+                    };
+                    continue;
+                }
+                Framing::Chunked { left, .. } => left,
+            };
+
+            let max = left.min(buf.len() as u64) as usize;
+            let n = self.reader.read(&mut buf[..max])?;
+            if n == 0 {
+                return Err(io::Error::new(
+                    io::ErrorKind::UnexpectedEof,
+                    "truncated HTTP body",
+                ));
+            }
+            match &mut self.framing {
+                Framing::Length(left) | Framing::Chunked { left, .. } => *left -= n as u64,
+                _ => unreachable!(),
+            }
+            return Ok(n);
+        }
+    }
+}
+
+/// Writer that hashes and counts what it writes
+struct HashingWriter<W: Write> {
+    inner: W,
+    hasher: blake3::Hasher,
+    len: u64,
+}
+
+impl<W: Write> HashingWriter<W> {
+    fn new(inner: W) -> Self {
+        Self {
+            inner,
+            hasher: blake3::Hasher::new(),
+            len: 0,
+        }
+    }
+
+    /// Flush, returning the hash and length of everything written
+    fn finish(mut self) -> io::Result<(Blake3Hash, u64)> {
+        self.inner.flush()?;
+        Ok((*self.hasher.finalize().as_bytes(), self.len))
+    }
+}
+
+impl<W: Write> Write for HashingWriter<W> {
+    fn write(&mut self, buf: &[u8]) -> io::Result<usize> {
+        let n = self.inner.write(buf)?;
+        self.hasher.update(&buf[..n]);
+        self.len += n as u64;
+        Ok(n)
+    }
+
+    fn flush(&mut self) -> io::Result<()> {
+        self.inner.flush()
+    }
+}
+
+/// Fetched blobs in the local CAS, least recently used first
+#[derive(Debug, Default)]
+struct FetchCache {
+    entries: HashMap<Blake3Hash, (u64, u64)>,
+    order: BTreeMap<u64, Blake3Hash>,
+    tick: u64,
+    bytes: u64,
+}
+
+impl FetchCache {
+    fn insert(&mut self, hash: Blake3Hash, size: u64) {
+        self.tick += 1;
+        if let Some((tick, old_size)) = self.entries.insert(hash, (self.tick, size)) {
+            self.order.remove(&tick);
+            self.bytes -= old_size;
+        }
+        self.order.insert(self.tick, hash);
+        self.bytes += size;
+    }
+
+    /// Make `hash` the most recently used entry. Returns its size if that
+    /// moved it (it was cached and not already the newest).
+    fn touch(&mut self, hash: &Blake3Hash) -> Option<u64> {
+        let (tick, size) = self.entries.get(hash).copied()?;
+        if tick == self.tick {
+            return None;
+        }
+        self.insert(*hash, size);
+        Some(size)
+    }
+
+    /// Drop least recently used entries until at most `limit` bytes remain,
+    /// never `keep`
+    fn evict(&mut self, limit: u64, keep: Option<&Blake3Hash>) -> Vec<(Blake3Hash, u64)> {
+        let mut evicted = Vec::new();
+        while self.bytes > limit {
+            let Some((&tick, hash)) = self.order.first_key_value() else {
+                break;
+            };
+            if Some(hash) == keep {
+                break;
+            }
+            let Some(hash) = self.order.remove(&tick) else {
+                break;
+            };
+            if let Some((_, size)) = self.entries.remove(&hash) {
+                self.bytes -= size;
+                evicted.push((hash, size));
+            }
+        }
+        evicted
+    }
+}
+
+/// Remote tier plus the bounded cache of blobs fetched from it into one
+/// local CAS. Shared (`Arc`) by every `CasStore` over that root.
+#[derive(Debug)]
+pub struct RemoteCas {
+    tier: Box<dyn RemoteTier>,
+    cas_root: PathBuf,
+    cache_limit: u64,
+    cache: Mutex<FetchCache>,
+    journal: Mutex<Option<File>>,
+    /// Records in the journal file
+    journaled: AtomicU64,
+    pool: rayon::ThreadPool,
+    fetched: AtomicU64,
+    fetched_bytes: AtomicU64,
+    pushed: AtomicU64,
+}
+
+impl RemoteCas {
+    /// `tier` in front of the CAS at `cas_root`, keeping at most
+    /// `cache_limit` bytes of fetched blobs and moving up to `parallelism`
+    /// blobs at once in batch fetches and pushes.
+    pub fn new<P: AsRef<Path>>(
+        tier: Box<dyn RemoteTier>,
+        cas_root: P,
+        cache_limit: u64,
+        parallelism: usize,
+    ) -> io::Result<Self> {
+        let cas_root = cas_root.as_ref().to_path_buf();
+        let pool = rayon::ThreadPoolBuilder::new()
+            .num_threads(parallelism.max(1))
+            .thread_name(|i| format!("vrift-remote-{}", i))
+            .build()
+            .map_err(io::Error::other)?;
+        let remote = Self {
+            tier,
+            cas_root,
+            cache_limit,
+            cache: Mutex::new(FetchCache::default()),
+            journal: Mutex::new(None),
+            journaled: AtomicU64::new(0),
+            pool,
+            fetched: AtomicU64::new(0),
+            fetched_bytes: AtomicU64::new(0),
+            pushed: AtomicU64::new(0),
+        };
+        remote.load_journal()?;
+        Ok(remote)
+    }
+
+    /// [`RemoteCas::new`] over the tier at `url` (see [`open_tier`])
+    pub fn open<P: AsRef<Path>>(
+        url: &str,
+        cas_root: P,
+        cache_limit: u64,
+        parallelism: usize,
+    ) -> io::Result<Self> {
+        Self::new(open_tier(url)?, cas_root, cache_limit, parallelism)
+    }
+
+    pub fn tier(&self) -> &dyn RemoteTier {
+        self.tier.as_ref()
+    }
+
+    fn blob_path(&self, hash: &Blake3Hash, size: u64) -> PathBuf {
+        let hex = CasStore::hash_to_hex(hash);
+        self.cas_root
+            .join("blake3")
+            .join(&hex[..2])
+            .join(&hex[2..4])
+            .join(format!("{}_{}.bin", hex, size))
+    }
+
+    /// Rebuild the cache from the journal (oldest use first), dropping
+    /// blobs no longer on disk, and rewrite it compacted.
+    fn load_journal(&self) -> io::Result<()> {
+        let path = self.cas_root.join(JOURNAL_NAME);
+        let data = match fs::read(&path) {
+            Ok(data) => data,
+            Err(e) if e.kind() == io::ErrorKind::NotFound => Vec::new(),
+            Err(e) => return Err(e),
+        };
+
+        let mut cache = FetchCache::default();
+        for record in data.chunks_exact(JOURNAL_RECORD) {
+            let hash: Blake3Hash = record[..32].try_into().unwrap();
+            let size = u64::from_le_bytes(record[32..].try_into().unwrap());
+            cache.insert(hash, size);
+        }
+        cache
+            .entries
+            .retain(|hash, (_, size)| self.blob_path(hash, *size).exists());
+        cache
+            .order
+            .retain(|_, hash| cache.entries.contains_key(hash));
+        cache.bytes = cache.entries.values().map(|(_, size)| size).sum();
+
+        *self.cache.lock().unwrap() = cache;
+        self.compact_journal()?;
+        self.evict(None);
+        Ok(())
+    }
+
+    /// Rewrite the journal as one record per cached blob, oldest use first
+    fn compact_journal(&self) -> io::Result<()> {
+        let compacted = {
+            let cache = self.cache.lock().unwrap();
+            let mut compacted = Vec::with_capacity(cache.order.len() * JOURNAL_RECORD);
+            for hash in cache.order.values() {
+                compacted.extend_from_slice(hash);
+                compacted.extend_from_slice(&cache.entries[hash].1.to_le_bytes());
+            }
+            compacted
+        };
+        let path = self.cas_root.join(JOURNAL_NAME);
+        let mut journal = self.journal.lock().unwrap();
+        fs::create_dir_all(&self.cas_root)?;
+        let temp = path.with_extension("log.tmp");
+        fs::write(&temp, &compacted)?;
+        fs::rename(&temp, &path)?;
+        *journal = Some(OpenOptions::new().append(true).open(&path)?);
+        self.journaled
+            .store((compacted.len() / JOURNAL_RECORD) as u64, Ordering::Relaxed);
+        Ok(())
+    }
+
+    /// Append a fetch or use of `hash` to the journal
+    fn journal(&self, hash: &Blake3Hash, size: u64) {
+        if let Some(journal) = self.journal.lock().unwrap().as_mut() {
+            let mut record = [0u8; JOURNAL_RECORD];
+            record[..32].copy_from_slice(hash);
+            record[32..].copy_from_slice(&size.to_le_bytes());
+            if let Err(e) = journal.write_all(&record) {
+                tracing::warn!(error = %e, "Failed to journal remote fetch");
+                return;
+            }
+        }
+        let records = self.journaled.fetch_add(1, Ordering::Relaxed) + 1;
+        let cached = self.cache.lock().unwrap().entries.len() as u64;
+        if records > 2 * cached + JOURNAL_SLACK {
+            if let Err(e) = self.compact_journal() {
+                tracing::warn!(error = %e, "Failed to compact remote fetch journal");
+            }
+        }
+    }
+
+    fn record(&self, hash: &Blake3Hash, size: u64) {
+        self.cache.lock().unwrap().insert(*hash, size);
+        self.journal(hash, size);
+        self.evict(Some(hash));
+    }
+
+    fn evict(&self, keep: Option<&Blake3Hash>) {
+        let evicted = self.cache.lock().unwrap().evict(self.cache_limit, keep);
+        for (hash, size) in evicted {
+            let _ = fs::remove_file(self.blob_path(&hash, size));
+        }
+    }
+
+    /// Mark a fetched blob as used (no-op for local blobs)
+    pub fn touch(&self, hash: &Blake3Hash) {
+        let moved = self.cache.lock().unwrap().touch(hash);
+        if let Some(size) = moved {
+            self.journal(hash, size);
+        }
+    }
+
+    /// Fetch `hash` into `store`, returning its new local path (None if the
+    /// remote does not have it). The content is streamed into a temp file
+    /// and hashed on the way, never held whole in memory; the size in the
+    /// blob name is only known once it is all in.
+    pub(crate) fn fetch_into(
+        &self,
+        store: &CasStore,
+        hash: &Blake3Hash,
+    ) -> Result<Option<PathBuf>> {
+        let mut fetched = None;
+        let temp = CasStore::write_blob_temp(&self.blob_path(hash, 0), |file| {
+            let mut out = HashingWriter::new(io::BufWriter::with_capacity(FETCH_WRITE_BUF, file));
+            if self.tier.fetch_to(hash, &mut out)? {
+                fetched = Some(out.finish()?);
+            }
+            Ok(())
+        })?;
+        let Some((actual, size)) = fetched else {
+            let _ = fs::remove_file(&temp);
+            return Ok(None);
+        };
+        if actual != *hash {
+            let _ = fs::remove_file(&temp);
+            return Err(CasError::HashMismatch {
+                expected: CasStore::hash_to_hex(hash),
+                actual: CasStore::hash_to_hex(&actual),
+            });
+        }
+
+        let path = self.blob_path(hash, size);
+        store.publish_blob_file(hash, &temp, &path)?;
+        self.fetched.fetch_add(1, Ordering::Relaxed);
+        self.fetched_bytes.fetch_add(size, Ordering::Relaxed);
+        self.record(hash, size);
+        Ok(Some(path))
+    }
+
+    pub(crate) fn count_push(&self) {
+        self.pushed.fetch_add(1, Ordering::Relaxed);
+    }
+
+    pub(crate) fn install<R: Send>(&self, op: impl FnOnce() -> R + Send) -> R {
+        self.pool.install(op)
+    }
+
+    pub fn stats(&self) -> RemoteStats {
+        let cache = self.cache.lock().unwrap();
+        RemoteStats {
+            fetched: self.fetched.load(Ordering::Relaxed),
+            fetched_bytes: self.fetched_bytes.load(Ordering::Relaxed),
+            pushed: self.pushed.load(Ordering::Relaxed),
+            cached_blobs: cache.entries.len() as u64,
+            cached_bytes: cache.bytes,
+        }
+    }
+}
+
+/// Remote tier counters since startup, and the current fetch cache size
+#[derive(Debug, Clone, Default)]
+pub struct RemoteStats {
+    pub fetched: u64,
+    pub fetched_bytes: u64,
+    pub pushed: u64,
+    pub cached_blobs: u64,
+    pub cached_bytes: u64,
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+    use std::sync::Arc;
+    use tempfile::TempDir;
+
+    /// Store at `dir/<name>` in front of the shared directory `dir/shared`
+    fn node(dir: &TempDir, name: &str, cache_limit: u64) -> CasStore {
+        let tier = Box::new(DirTier::new(dir.path().join("shared")));
+        let root = dir.path().join(name);
+        let remote = RemoteCas::new(tier, &root, cache_limit, 4).unwrap();
+        CasStore::new(&root).unwrap().with_remote(Arc::new(remote))
+    }
+
+    #[test]
+    fn test_fetch_on_miss_then_local() {
+        let dir = TempDir::new().unwrap();
+        let node = node(&dir, "node", u64::MAX);
+        let tier = DirTier::new(dir.path().join("shared"));
+        let data = b"shared toolchain blob";
+        let hash = CasStore::compute_hash(data);
+        tier.put(&hash, data).unwrap();
+
+        assert!(node.blob_path_for_hash(&hash).is_none());
+        assert_eq!(node.get(&hash).unwrap(), data);
+        let local = node.blob_path_for_hash(&hash).unwrap();
+        assert!(local.to_string_lossy().ends_with(".bin"));
+        assert_eq!(&node.get_mmap(&hash).unwrap()[..], data);
+        assert_eq!(node.remote().unwrap().stats().fetched, 1);
+
+        let missing = CasStore::compute_hash(b"nowhere");
+        assert!(matches!(node.get(&missing), Err(CasError::NotFound { .. })));
+    }
+
+    #[test]
+    fn test_corrupt_remote_blob_is_rejected() {
+        let dir = TempDir::new().unwrap();
+        let node = node(&dir, "node", u64::MAX);
+        let hash = CasStore::compute_hash(b"real content");
+        DirTier::new(dir.path().join("shared"))
+            .put(&hash, b"tampered")
+            .unwrap();
+
+        assert!(matches!(
+            node.materialize(&hash),
+            Err(CasError::HashMismatch { .. })
+        ));
+        assert!(node.blob_path_for_hash(&hash).is_none());
+    }
+
+    #[test]
+    fn test_push_then_batch_fetch_with_eviction() {
+        let dir = TempDir::new().unwrap();
+        let writer = node(&dir, "writer", 0);
+        let blobs: Vec<Vec<u8>> = (0..8u8).map(|i| vec![i; 100]).collect();
+        let hashes: Vec<_> = blobs.iter().map(|b| writer.store(b).unwrap()).collect();
+        assert_eq!(writer.push(&hashes), 8);
+        assert_eq!(writer.push(&hashes), 0, "already on the remote");
+        // Local blobs are never evicted, whatever the limit
+        assert!(hashes
+            .iter()
+            .all(|h| writer.blob_path_for_hash(h).is_some()));
+
+        let node = node(&dir, "node", 300);
+        assert_eq!(node.fetch_missing(&hashes), 8);
+        let local = hashes
+            .iter()
+            .filter(|h| node.blob_path_for_hash(h).is_some())
+            .count();
+        assert_eq!(local, 3, "cache holds 300 bytes");
+        assert!(hashes.iter().all(|h| node.exists(h)));
+        assert_eq!(node.get(&hashes[0]).unwrap(), blobs[0]);
+    }
+
+    #[test]
+    fn test_cache_bound_survives_restart() {
+        let dir = TempDir::new().unwrap();
+        let shared = DirTier::new(dir.path().join("shared"));
+        let hashes: Vec<_> = (0..4u8)
+            .map(|i| {
+                let data = vec![i; 100];
+                let hash = CasStore::compute_hash(&data);
+                shared.put(&hash, &data).unwrap();
+                hash
+            })
+            .collect();
+        {
+            // One at a time: a batch fetch finishes in any order
+            let node = node(&dir, "node", u64::MAX);
+            for hash in &hashes {
+                node.get(hash).unwrap();
+            }
+        }
+
+        let node = node(&dir, "node", 200);
+        let stats = node.remote().unwrap().stats();
+        assert_eq!((stats.cached_blobs, stats.cached_bytes), (2, 200));
+        assert!(
+            node.blob_path_for_hash(&hashes[0]).is_none(),
+            "oldest evicted"
+        );
+        assert!(node.blob_path_for_hash(&hashes[3]).is_some());
+    }
+
+    #[test]
+    fn test_fetched_blob_over_the_limit_is_kept_until_the_next() {
+        let dir = TempDir::new().unwrap();
+        let shared = DirTier::new(dir.path().join("shared"));
+        let blobs: Vec<Vec<u8>> = (0..2u8).map(|i| vec![i; 100]).collect();
+        let hashes: Vec<_> = blobs
+            .iter()
+            .map(|data| {
+                let hash = CasStore::compute_hash(data);
+                shared.put(&hash, data).unwrap();
+                hash
+            })
+            .collect();
+
+        let node = node(&dir, "node", 50);
+        assert_eq!(node.get(&hashes[0]).unwrap(), blobs[0]);
+        assert!(node.materialize(&hashes[0]).unwrap().exists());
+        assert_eq!(node.get(&hashes[1]).unwrap(), blobs[1]);
+        assert!(node.blob_path_for_hash(&hashes[0]).is_none());
+        assert_eq!(node.remote().unwrap().stats().cached_blobs, 1);
+    }
+
+    #[test]
+    fn test_touch_keeps_used_blobs_across_restart() {
+        let dir = TempDir::new().unwrap();
+        let shared = DirTier::new(dir.path().join("shared"));
+        let hashes: Vec<_> = (0..4u8)
+            .map(|i| {
+                let data = vec![i; 100];
+                let hash = CasStore::compute_hash(&data);
+                shared.put(&hash, &data).unwrap();
+                hash
+            })
+            .collect();
+        {
+            let node = node(&dir, "node", u64::MAX);
+            for hash in &hashes {
+                node.get(hash).unwrap();
+            }
+            // Used directly by path (access trace): no CasStore read
+            node.remote().unwrap().touch(&hashes[0]);
+        }
+
+        let node = node(&dir, "node", 200);
+        assert!(
+            node.blob_path_for_hash(&hashes[0]).is_some(),
+            "recently used"
+        );
+        assert!(node.blob_path_for_hash(&hashes[3]).is_some());
+        assert!(node.blob_path_for_hash(&hashes[1]).is_none());
+        assert!(node.blob_path_for_hash(&hashes[2]).is_none());
+    }
+
+    /// Status and whole body of a canned response
+    fn parse_response(response: &[u8], head_only: bool) -> io::Result<(u16, Vec<u8>)> {
+        let (status, mut body) = read_response(response, head_only)?;
+        let mut out = Vec::new();
+        body.read_to_end(&mut out)?;
+        Ok((status, out))
+    }
+
+    #[test]
+    fn test_parse_http_responses() {
+        let (status, body) =
+            parse_response(b"HTTP/1.1 200 OK\r\nContent-Length: 5\r\n\r\nhello", false).unwrap();
+        assert_eq!((status, body.as_slice()), (200, &b"hello"[..]));
+
+        let chunked = b"HTTP/1.1 200 OK\r\nTransfer-Encoding: chunked\r\n\r\n3\r\nabc\r\n2;x=y\r\nde\r\n0\r\n\r\n";
+        assert_eq!(parse_response(chunked, false).unwrap().1, b"abcde");
+
+        assert_eq!(
+            parse_response(b"HTTP/1.1 404 Not Found\r\n\r\n", true)
+                .unwrap()
+                .0,
+            404
+        );
+        assert!(
+            parse_response(b"HTTP/1.1 200 OK\r\nContent-Length: 9\r\n\r\nshort", false).is_err()
+        );
+        assert!(parse_response(
+            b"HTTP/1.1 200 OK\r\nTransfer-Encoding: chunked\r\n\r\n5\r\nab",
+            false
+        )
+        .is_err());
+    }
+
+    #[test]
+    fn test_http_fetch_streams_into_the_cas() {
+        use std::net::TcpListener;
+
+        // Several chunks, so the body crosses socket buffer refills
+        let data: Vec<u8> = (0..300_000u32).map(|i| (i % 251) as u8).collect();
+        let hash = CasStore::compute_hash(&data);
+        let listener = TcpListener::bind("127.0.0.1:0").unwrap();
+        let addr = listener.local_addr().unwrap();
+        let served = data.clone();
+        let server = std::thread::spawn(move || {
+            let (stream, _) = listener.accept().unwrap();
+            let mut reader = BufReader::new(stream.try_clone().unwrap());
+            let mut line = Vec::new();
+            read_http_line(&mut reader, &mut line).unwrap();
+            let request_line = String::from_utf8(line.clone()).unwrap();
+            while !line.is_empty() {
+                read_http_line(&mut reader, &mut line).unwrap();
+            }
+            let mut stream = stream;
+            stream
+                .write_all(b"HTTP/1.1 200 OK\r\nTransfer-Encoding: chunked\r\n\r\n")
+                .unwrap();
+            for chunk in served.chunks(70_000) {
+                write!(stream, "{:x}\r\n", chunk.len()).unwrap();
+                stream.write_all(chunk).unwrap();
+                stream.write_all(b"\r\n").unwrap();
+            }
+            stream.write_all(b"0\r\n\r\n").unwrap();
+            request_line
+        });
+
+        let dir = TempDir::new().unwrap();
+        let tier = Box::new(HttpTier::new(&format!("{}/cas/", addr)).unwrap());
+        let root = dir.path().join("node");
+        let remote = RemoteCas::new(tier, &root, u64::MAX, 1).unwrap();
+        let node = CasStore::new(&root).unwrap().with_remote(Arc::new(remote));
+
+        let path = node.materialize(&hash).unwrap();
+        assert_eq!(fs::read(&path).unwrap(), data);
+        assert!(path
+            .to_string_lossy()
+            .ends_with(&format!("_{}.bin", data.len())));
+        assert_eq!(
+            server.join().unwrap(),
+            format!("GET /cas/{} HTTP/1.1", remote_key(&hash))
+        );
+        // Only the published blob is left behind
+        let leftovers = fs::read_dir(path.parent().unwrap()).unwrap().count();
+        assert_eq!(leftovers, 1);
+    }
+}
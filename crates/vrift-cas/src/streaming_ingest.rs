@@ -4,19 +4,23 @@
 //! - Scanner thread sends paths via channel (auto backpressure)
 //! - Worker threads receive and process (efficient parking)
 //!
-//! Zero-copy: uses DirEntry::into_path() to transfer PathBuf ownership.
+//! Zero-copy: the tree walker hands each PathBuf to the channel by value.
 
 use std::path::{Path, PathBuf};
+use std::sync::atomic::{AtomicUsize, Ordering};
 use std::sync::Arc;
 
 use crossbeam::channel::{self, Receiver, Sender};
-use jwalk::WalkDir;
 
+use crate::tree_walk::TreeWalker;
 use crate::{CasError, IngestMode, IngestResult};
 
 /// Channel capacity (bounded ring buffer)
 const CHANNEL_CAP: usize = 1024;
 
+/// Directories never ingested
+const SKIP_DIRS: [&str; 2] = [".vrift", ".git"];
+
 /// Streaming ingest with producer-consumer pipeline
 pub fn streaming_ingest(
     source: &Path,
@@ -41,28 +45,24 @@ pub fn streaming_ingest(
     let source_path = source.to_path_buf();
     tracing::info!("[INGEST] Starting scanner thread for: {:?}", source_path);
     let scanner = std::thread::spawn(move || {
-        let mut file_count = 0;
-        for entry in WalkDir::new(&source_path)
-            .process_read_dir(|_depth, _path, _state, children| {
-                children.retain(|entry| {
-                    entry.as_ref().map_or(true, |e| {
-                        let name = e.file_name.to_str().unwrap_or("");
-                        name != ".vrift" && name != ".git"
-                    })
-                });
-            })
-            .into_iter()
-            .filter_map(|e| e.ok())
-            .filter(|e| e.file_type().is_file())
-        {
-            let path = entry.path();
-            file_count += 1;
-            if tx.send(path).is_err() {
-                tracing::warn!("[INGEST] Scanner: receivers dropped, stopping");
-                break;
-            }
-        }
-        tracing::info!("[INGEST] Scanner complete: {} files found", file_count);
+        let file_count = AtomicUsize::new(0);
+        TreeWalker::new(&source_path)
+            .skip_names(SKIP_DIRS)
+            .walk(|entry| {
+                if !entry.is_file() {
+                    return true;
+                }
+                file_count.fetch_add(1, Ordering::Relaxed);
+                if tx.send(entry.path).is_err() {
+                    tracing::warn!("[INGEST] Scanner: receivers dropped, stopping");
+                    return false;
+                }
+                true
+            });
+        tracing::info!(
+            "[INGEST] Scanner complete: {} files found",
+            file_count.into_inner()
+        );
     });
 
     // Phase4-#3: Per-worker local Vec (no Mutex contention)
@@ -168,36 +168,23 @@ where
     let source_path = source.to_path_buf();
     let scanner_source = source_path.clone();
     let scanner = std::thread::spawn(move || {
-        use std::os::unix::fs::MetadataExt;
-        let mut file_count = 0;
-        for entry in WalkDir::new(&scanner_source)
-            .process_read_dir(|_depth, _path, _state, children| {
-                children.retain(|entry| {
-                    entry.as_ref().map_or(true, |e| {
-                        let name = e.file_name.to_str().unwrap_or("");
-                        name != ".vrift" && name != ".git"
-                    })
-                });
-            })
-            .into_iter()
-            .filter_map(|e| e.ok())
-            .filter(|e| e.file_type().is_file())
-        {
-            let path = entry.path();
-            // Phase5-#2: stat once in scanner, avoid re-stat in worker
-            let (size, mtime, mode) = match std::fs::metadata(&path) {
-                Ok(m) => {
-                    let mtime = crate::zero_copy_ingest::mtime_nsec_from_metadata(&m);
-                    (m.len(), mtime, m.mode())
-                }
-                Err(_) => continue, // skip unreadable files
-            };
-            file_count += 1;
-            if tx.send((path, size, mtime, mode)).is_err() {
-                break;
-            }
-        }
-        tracing::info!("[INGEST] Scanner complete: {} files found", file_count);
+        let file_count = AtomicUsize::new(0);
+        // Phase5-#2: stat once in scanner (dirfd-relative), avoid re-stat in worker
+        TreeWalker::new(&scanner_source)
+            .skip_names(SKIP_DIRS)
+            .with_stat(true)
+            .walk(|entry| {
+                let Some(st) = entry.stat.filter(|_| entry.is_file()) else {
+                    return true; // Not a file, or vanished before stat
+                };
+                file_count.fetch_add(1, Ordering::Relaxed);
+                tx.send((entry.path, st.size, st.mtime_nsec, st.mode))
+                    .is_ok()
+            });
+        tracing::info!(
+            "[INGEST] Scanner complete: {} files found",
+            file_count.into_inner()
+        );
     });
 
     // Phase4-#3: Per-worker local Vec (no Mutex contention)
@@ -288,7 +275,6 @@ where
     F: Fn(&Result<IngestResult, CasError>, usize) + Send + Sync,
 {
     use crate::zero_copy_ingest::{ingest_phantom, ingest_solid_tier1, ingest_solid_tier2};
-    use std::sync::atomic::{AtomicUsize, Ordering};
 
     let (tx, rx): (Sender<PathBuf>, Receiver<PathBuf>) = channel::bounded(CHANNEL_CAP);
 
@@ -306,16 +292,7 @@ where
     // Scanner
     let source_path = source.to_path_buf();
     let scanner = std::thread::spawn(move || {
-        for entry in WalkDir::new(&source_path)
-            .into_iter()
-            .filter_map(|e| e.ok())
-            .filter(|e| e.file_type().is_file())
-        {
-            let path = entry.path();
-            if tx.send(path).is_err() {
-                break;
-            }
-        }
+        TreeWalker::new(&source_path).walk(|entry| !entry.is_file() || tx.send(entry.path).is_ok());
     });
 
     // Workers
@@ -16,6 +16,7 @@
 use std::fs::{self, File};
 use std::io::{BufReader, BufWriter, Read, Write};
 use std::path::{Path, PathBuf};
+use std::sync::atomic::{AtomicU64, Ordering};
 use std::sync::Arc;
 use std::thread::{self, JoinHandle};
 use std::time::{Duration, Instant, SystemTime};
@@ -24,6 +25,7 @@ use crossbeam_channel::{bounded, RecvTimeoutError, Sender};
 use dashmap::DashSet;
 use notify::{RecursiveMode, Watcher};
 
+use crate::tree_walk::TreeWalker;
 use crate::{Blake3Hash, CasError, CasStore, Result};
 
 // ============================================================================
@@ -105,6 +107,7 @@ pub struct IngestStats {
 
 /// Simple counting semaphore for memory budget control
 pub struct MemorySemaphore {
+    total: usize,
     available: std::sync::Mutex<usize>,
     condvar: std::sync::Condvar,
 }
@@ -112,11 +115,17 @@ pub struct MemorySemaphore {
 impl MemorySemaphore {
     pub fn new(budget: usize) -> Self {
         Self {
+            total: budget,
             available: std::sync::Mutex::new(budget),
             condvar: std::sync::Condvar::new(),
         }
     }
 
+    /// Total budget; `acquire` of more than this would block forever
+    pub fn total(&self) -> usize {
+        self.total
+    }
+
     /// Acquire memory permit, blocking if insufficient
     pub fn acquire(&self, amount: usize) -> MemoryPermit<'_> {
         let mut available = self.available.lock().unwrap();
@@ -178,20 +187,20 @@ impl WatchFirstScanner {
 
         tracing::info!("Watch started, beginning directory scan");
 
-        // Step 2: Walk directory tree
-        for entry in jwalk::WalkDir::new(&self.root)
-            .into_iter()
-            .filter_map(|e| e.ok())
-            .filter(|e| e.file_type().is_file())
-        {
-            if let Ok(meta) = entry.metadata() {
-                let size = meta.len();
-                if self.tx.send(ScanItem::Path(entry.path(), size)).is_err() {
-                    break; // Channel closed
-                }
-                count += 1;
+        // Step 2: Walk directory tree (parallel, sizes from dirfd-relative stat)
+        let sent = AtomicU64::new(0);
+        TreeWalker::new(&self.root).with_stat(true).walk(|entry| {
+            if !entry.is_file() {
+                return true;
             }
-        }
+            let size = entry.stat.map_or(0, |st| st.size);
+            if self.tx.send(ScanItem::Path(entry.path, size)).is_err() {
+                return false; // Channel closed
+            }
+            sent.fetch_add(1, Ordering::Relaxed);
+            true
+        });
+        count += sent.into_inner();
 
         tracing::info!("Directory scan complete, processing watch events");
 
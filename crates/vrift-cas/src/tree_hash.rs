@@ -0,0 +1,300 @@
+//! Incremental BLAKE3 via the hash tree.
+//!
+//! BLAKE3 is a Merkle tree over 1 KiB chunks. Keeping the chaining values of
+//! fixed 64 KiB leaves (an "outboard", 32 bytes per leaf) lets the root be
+//! recomputed after a write by rehashing only the leaves the write touched
+//! and merging O(log n) parent nodes. The root is exactly `blake3::hash` of
+//! the content, so blobs stay addressed by their plain BLAKE3 hash.
+//!
+//! Used by CoW reingest: a `TreeHash` is stored next to every large blob,
+//! and the next reingest of that file reads only its dirty ranges.
+
+use std::fs::File;
+use std::io;
+
+use blake3::hazmat::{
+    left_subtree_len, merge_subtrees_non_root, merge_subtrees_root, ChainingValue, HasherExt, Mode,
+};
+
+use crate::Blake3Hash;
+
+/// Leaf size; a power of two multiple of the 1 KiB BLAKE3 chunk
+pub const LEAF_SIZE: u64 = 64 * 1024;
+
+/// Files smaller than this are cheap to rehash and get no outboard
+pub const TREE_MIN_SIZE: u64 = 1024 * 1024;
+
+const TREE_MAGIC: &[u8; 8] = b"VRTREE01";
+const TREE_HEADER: usize = 16;
+
+/// Half-open byte range `[start, end)`
+pub type ByteRange = (u64, u64);
+
+/// Leaf chaining values of one blob
+#[derive(Debug, Clone, PartialEq, Eq)]
+pub struct TreeHash {
+    len: u64,
+    leaves: Vec<ChainingValue>,
+}
+
+fn leaf_count(len: u64) -> usize {
+    len.div_ceil(LEAF_SIZE) as usize
+}
+
+fn leaf_span(index: usize, len: u64) -> ByteRange {
+    let start = index as u64 * LEAF_SIZE;
+    (start, (start + LEAF_SIZE).min(len))
+}
+
+#[cfg(unix)]
+fn read_leaf(file: &File, start: u64, len: usize) -> io::Result<Vec<u8>> {
+    use std::os::unix::fs::FileExt;
+    let mut buf = vec![0u8; len];
+    file.read_exact_at(&mut buf, start)?;
+    Ok(buf)
+}
+
+fn leaf_cv(file: &File, (start, end): ByteRange) -> io::Result<ChainingValue> {
+    let data = read_leaf(file, start, (end - start) as usize)?;
+    let mut hasher = blake3::Hasher::new();
+    hasher.set_input_offset(start);
+    hasher.update(&data);
+    Ok(hasher.finalize_non_root())
+}
+
+impl TreeHash {
+    /// Whether a file of `len` bytes gets an outboard
+    #[inline]
+    pub fn applies_to(len: u64) -> bool {
+        len >= TREE_MIN_SIZE
+    }
+
+    /// Hash the first `len` bytes of `file`, leaves in parallel
+    pub fn compute(file: &File, len: u64) -> io::Result<Self> {
+        use rayon::prelude::*;
+
+        if len <= LEAF_SIZE {
+            return Err(io::Error::new(
+                io::ErrorKind::InvalidInput,
+                "tree hash needs more than one leaf",
+            ));
+        }
+        let leaves = (0..leaf_count(len))
+            .into_par_iter()
+            .map(|i| leaf_cv(file, leaf_span(i, len)))
+            .collect::<io::Result<Vec<_>>>()?;
+        Ok(Self { len, leaves })
+    }
+
+    /// Hash of `file` (now `new_len` bytes) that differs from the content
+    /// this tree describes only inside `dirty` (sorted, merged ranges; see
+    /// `dirty_ranges`). Only leaves overlapping `dirty` are read.
+    pub fn update(&self, file: &File, new_len: u64, dirty: &[ByteRange]) -> io::Result<Self> {
+        use rayon::prelude::*;
+
+        if new_len <= LEAF_SIZE {
+            return Err(io::Error::new(
+                io::ErrorKind::InvalidInput,
+                "tree hash needs more than one leaf",
+            ));
+        }
+        let leaves = (0..leaf_count(new_len))
+            .into_par_iter()
+            .map(|i| {
+                let span = leaf_span(i, new_len);
+                let reusable = i < self.leaves.len()
+                    && leaf_span(i, self.len) == span
+                    && !overlaps(dirty, span);
+                if reusable {
+                    Ok(self.leaves[i])
+                } else {
+                    leaf_cv(file, span)
+                }
+            })
+            .collect::<io::Result<Vec<_>>>()?;
+        Ok(Self {
+            len: new_len,
+            leaves,
+        })
+    }
+
+    pub fn len(&self) -> u64 {
+        self.len
+    }
+
+    pub fn is_empty(&self) -> bool {
+        self.len == 0
+    }
+
+    /// BLAKE3 hash of the content (equal to `blake3::hash`)
+    pub fn root(&self) -> Blake3Hash {
+        let left = left_subtree_len(self.len);
+        let l = self.subtree(0, left);
+        let r = self.subtree(left, self.len - left);
+        *merge_subtrees_root(&l, &r, Mode::Hash).as_bytes()
+    }
+
+    /// Chaining value of the subtree covering `[offset, offset + len)`.
+    /// Subtrees split at BLAKE3's left-subtree length, which above one
+    /// leaf is always a whole number of leaves.
+    fn subtree(&self, offset: u64, len: u64) -> ChainingValue {
+        if len <= LEAF_SIZE {
+            return self.leaves[(offset / LEAF_SIZE) as usize];
+        }
+        let left = left_subtree_len(len);
+        let l = self.subtree(offset, left);
+        let r = self.subtree(offset + left, len - left);
+        merge_subtrees_non_root(&l, &r, Mode::Hash)
+    }
+
+    /// On-disk format: magic `VRTREE01`, content length (u64 LE), then one
+    /// 32-byte chaining value per leaf.
+    pub fn encode(&self) -> Vec<u8> {
+        let mut out = Vec::with_capacity(TREE_HEADER + self.leaves.len() * 32);
+        out.extend_from_slice(TREE_MAGIC);
+        out.extend_from_slice(&self.len.to_le_bytes());
+        for leaf in &self.leaves {
+            out.extend_from_slice(leaf);
+        }
+        out
+    }
+
+    pub fn decode(bytes: &[u8]) -> io::Result<Self> {
+        if bytes.len() < TREE_HEADER || &bytes[..8] != TREE_MAGIC {
+            return Err(io::Error::new(
+                io::ErrorKind::InvalidData,
+                "not a tree hash",
+            ));
+        }
+        let len = u64::from_le_bytes(bytes[8..16].try_into().unwrap());
+        let body = &bytes[TREE_HEADER..];
+        if len <= LEAF_SIZE || body.len() != leaf_count(len) * 32 {
+            return Err(io::Error::new(
+                io::ErrorKind::InvalidData,
+                "truncated tree hash",
+            ));
+        }
+        let leaves = body
+            .chunks_exact(32)
+            .map(|cv| cv.try_into().unwrap())
+            .collect();
+        Ok(Self { len, leaves })
+    }
+}
+
+pub(crate) fn overlaps(dirty: &[ByteRange], (start, end): ByteRange) -> bool {
+    // First range ending after `start`; it overlaps iff it begins before `end`
+    let i = dirty.partition_point(|&(_, e)| e <= start);
+    dirty.get(i).is_some_and(|&(s, _)| s < end)
+}
+
+/// Everything that may differ between a base of `base_len` bytes and the
+/// same file after writes to `written`, truncation to (at lowest)
+/// `truncated_to`, and ending at `new_len` bytes. Sorted, merged, clipped.
+pub fn dirty_ranges(
+    written: &[ByteRange],
+    base_len: u64,
+    truncated_to: u64,
+    new_len: u64,
+) -> Vec<ByteRange> {
+    let mut ranges: Vec<ByteRange> = written
+        .iter()
+        .map(|&(s, e)| (s.min(new_len), e.min(new_len)))
+        .chain(std::iter::once((
+            truncated_to.min(base_len).min(new_len),
+            new_len,
+        )))
+        .filter(|&(s, e)| s < e)
+        .collect();
+    ranges.sort_unstable();
+
+    let mut merged: Vec<ByteRange> = Vec::with_capacity(ranges.len());
+    for (s, e) in ranges {
+        match merged.last_mut() {
+            Some(last) if s <= last.1 => last.1 = last.1.max(e),
+            _ => merged.push((s, e)),
+        }
+    }
+    merged
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+    use std::io::Write;
+    use tempfile::TempDir;
+
+    fn content(len: usize, seed: u8) -> Vec<u8> {
+        (0..len)
+            .map(|i| (i as u8).wrapping_mul(31).wrapping_add(seed) ^ (i >> 11) as u8)
+            .collect()
+    }
+
+    fn write_file(dir: &TempDir, name: &str, data: &[u8]) -> File {
+        let path = dir.path().join(name);
+        File::create(&path).unwrap().write_all(data).unwrap();
+        File::open(path).unwrap()
+    }
+
+    #[test]
+    fn test_root_matches_blake3() {
+        let dir = TempDir::new().unwrap();
+        for len in [LEAF_SIZE as usize + 1, 3 * 65536 + 777, 2 * 1024 * 1024] {
+            let data = content(len, 7);
+            let file = write_file(&dir, "f", &data);
+            let tree = TreeHash::compute(&file, len as u64).unwrap();
+            assert_eq!(tree.root(), *blake3::hash(&data).as_bytes(), "len {}", len);
+            assert_eq!(TreeHash::decode(&tree.encode()).unwrap(), tree);
+        }
+    }
+
+    #[test]
+    fn test_update_rehashes_only_dirty_leaves() {
+        let dir = TempDir::new().unwrap();
+        let base = content(1_500_000, 1);
+        let tree = TreeHash::compute(&write_file(&dir, "base", &base), base.len() as u64).unwrap();
+
+        // In-place patch, then append via a tail rewrite
+        let mut edited = base.clone();
+        edited[700_000..700_100].fill(0xee);
+        edited.extend_from_slice(&content(90_000, 9));
+        let file = write_file(&dir, "edited", &edited);
+
+        let dirty = dirty_ranges(
+            &[(700_000, 700_100)],
+            base.len() as u64,
+            u64::MAX,
+            edited.len() as u64,
+        );
+        let updated = tree.update(&file, edited.len() as u64, &dirty).unwrap();
+        assert_eq!(updated.root(), *blake3::hash(&edited).as_bytes());
+
+        // Truncation
+        let short = &base[..1_000_000];
+        let file = write_file(&dir, "short", short);
+        let dirty = dirty_ranges(&[], base.len() as u64, 1_000_000, 1_000_000);
+        let updated = tree.update(&file, 1_000_000, &dirty).unwrap();
+        assert_eq!(updated.root(), *blake3::hash(short).as_bytes());
+    }
+
+    #[test]
+    fn test_dirty_ranges_merge_and_clip() {
+        assert_eq!(
+            dirty_ranges(
+                &[(50, 60), (10, 20), (15, 30), (200, 300)],
+                1000,
+                u64::MAX,
+                250
+            ),
+            vec![(10, 30), (50, 60), (200, 250)]
+        );
+        // Growth past the base is always dirty
+        assert_eq!(dirty_ranges(&[], 100, u64::MAX, 150), vec![(100, 150)]);
+        // Truncated then regrown: everything from the truncation point
+        assert_eq!(
+            dirty_ranges(&[(0, 5)], 100, 40, 100),
+            vec![(0, 5), (40, 100)]
+        );
+        assert!(dirty_ranges(&[], 100, u64::MAX, 100).is_empty());
+    }
+}
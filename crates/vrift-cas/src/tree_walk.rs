@@ -0,0 +1,607 @@
+//! Parallel Directory Tree Walker
+//!
+//! One walker shared by every ingest path (streaming ingest, the watch-first
+//! pipeline, vdird's full and compensation scans):
+//!
+//! - A directory is the unit of work: each worker owns a LIFO deque and
+//!   steals from the others (crossbeam work-stealing) when it runs dry
+//! - Directories are listed through a dirfd with one large buffer per worker
+//!   (`getdents64` on Linux, `fdopendir`/`readdir` elsewhere)
+//! - Entry kinds come from `d_type`; nothing is stat'ed unless asked for, and
+//!   then via `fstatat` relative to the open dirfd (no path re-resolution)
+//!
+//! Symlinks are reported, never followed. Entry order is not deterministic.
+
+use std::ffi::{CString, OsStr};
+use std::os::unix::ffi::OsStrExt;
+use std::path::{Path, PathBuf};
+use std::sync::atomic::{AtomicBool, AtomicU64, AtomicUsize, Ordering};
+use std::sync::Mutex;
+
+use crossbeam::deque::{Injector, Stealer, Worker};
+
+/// getdents64 buffer per worker
+#[cfg(target_os = "linux")]
+const DENTS_BUF_SIZE: usize = 128 * 1024;
+
+/// Upper bound on default worker count
+const MAX_DEFAULT_THREADS: usize = 16;
+
+/// Entry type, from `d_type` (or `fstatat` when the filesystem reports DT_UNKNOWN)
+#[derive(Debug, Clone, Copy, PartialEq, Eq)]
+pub enum EntryKind {
+    File,
+    Dir,
+    Symlink,
+    Other,
+}
+
+/// Metadata captured when the walker pre-stats entries
+#[derive(Debug, Clone, Copy)]
+pub struct EntryStat {
+    pub size: u64,
+    /// Same encoding as `mtime_nsec_from_metadata`
+    pub mtime_nsec: u64,
+    pub mode: u32,
+}
+
+#[derive(Debug)]
+pub struct WalkEntry {
+    pub path: PathBuf,
+    pub kind: EntryKind,
+    /// Children of the root are depth 1
+    pub depth: usize,
+    /// Present when the walker was built `with_stat(true)`
+    pub stat: Option<EntryStat>,
+}
+
+impl WalkEntry {
+    #[inline]
+    pub fn is_file(&self) -> bool {
+        self.kind == EntryKind::File
+    }
+}
+
+/// Counters for one walk
+#[derive(Debug, Default, Clone, Copy)]
+pub struct WalkSummary {
+    pub entries: u64,
+    pub dirs: u64,
+    /// Directories that could not be opened or read
+    pub errors: u64,
+}
+
+type EntryFilter = dyn Fn(&Path, EntryKind) -> bool + Send + Sync;
+
+/// Parallel tree walker (builder-style configuration)
+pub struct TreeWalker {
+    root: PathBuf,
+    threads: usize,
+    with_stat: bool,
+    max_depth: usize,
+    skip_names: Vec<Vec<u8>>,
+    filter: Option<Box<EntryFilter>>,
+}
+
+struct Job {
+    path: PathBuf,
+    depth: usize,
+}
+
+struct Shared<'a, F> {
+    walker: &'a TreeWalker,
+    visit: &'a F,
+    injector: Injector<Job>,
+    stealers: Vec<Stealer<Job>>,
+    /// Directories queued or being listed
+    pending: AtomicUsize,
+    stop: AtomicBool,
+    entries: AtomicU64,
+    dirs: AtomicU64,
+    errors: AtomicU64,
+}
+
+pub fn default_walk_threads() -> usize {
+    num_cpus::get().clamp(1, MAX_DEFAULT_THREADS)
+}
+
+impl TreeWalker {
+    pub fn new<P: AsRef<Path>>(root: P) -> Self {
+        Self {
+            root: root.as_ref().to_path_buf(),
+            threads: default_walk_threads(),
+            with_stat: false,
+            max_depth: usize::MAX,
+            skip_names: Vec::new(),
+            filter: None,
+        }
+    }
+
+    pub fn threads(mut self, threads: usize) -> Self {
+        self.threads = threads.max(1);
+        self
+    }
+
+    /// Pre-stat every reported entry (`WalkEntry::stat`). Entries that vanish
+    /// between listing and stat are dropped.
+    pub fn with_stat(mut self, with_stat: bool) -> Self {
+        self.with_stat = with_stat;
+        self
+    }
+
+    /// Directories deeper than this are reported but not read (root = 0)
+    pub fn max_depth(mut self, max_depth: usize) -> Self {
+        self.max_depth = max_depth;
+        self
+    }
+
+    /// Skip entries with these exact names (and their subtrees)
+    pub fn skip_names<I, S>(mut self, names: I) -> Self
+    where
+        I: IntoIterator<Item = S>,
+        S: AsRef<OsStr>,
+    {
+        self.skip_names = names
+            .into_iter()
+            .map(|n| n.as_ref().as_bytes().to_vec())
+            .collect();
+        self
+    }
+
+    /// Keep only entries for which `filter` returns true; a rejected
+    /// directory is not descended into
+    pub fn filter<F>(mut self, filter: F) -> Self
+    where
+        F: Fn(&Path, EntryKind) -> bool + Send + Sync + 'static,
+    {
+        self.filter = Some(Box::new(filter));
+        self
+    }
+
+    /// Walk the tree, calling `visit` from worker threads for every entry
+    /// below the root. Returning false from `visit` stops the walk.
+    pub fn walk<F>(&self, visit: F) -> WalkSummary
+    where
+        F: Fn(WalkEntry) -> bool + Sync,
+    {
+        self.walk_indexed(|_, entry| visit(entry))
+    }
+
+    /// Collect all regular files (per-worker buffers, merged once)
+    pub fn collect_files(&self) -> Vec<PathBuf> {
+        let buckets: Vec<Mutex<Vec<PathBuf>>> =
+            (0..self.threads).map(|_| Mutex::new(Vec::new())).collect();
+        self.walk_indexed(|worker, entry| {
+            if entry.is_file() {
+                buckets[worker].lock().unwrap().push(entry.path);
+            }
+            true
+        });
+        let mut files = Vec::new();
+        for bucket in buckets {
+            files.append(&mut bucket.into_inner().unwrap());
+        }
+        files
+    }
+
+    /// `walk` with the index of the reporting worker (0..threads)
+    pub fn walk_indexed<F>(&self, visit: F) -> WalkSummary
+    where
+        F: Fn(usize, WalkEntry) -> bool + Sync,
+    {
+        let workers: Vec<Worker<Job>> = (0..self.threads).map(|_| Worker::new_lifo()).collect();
+        let shared = Shared {
+            walker: self,
+            visit: &visit,
+            injector: Injector::new(),
+            stealers: workers.iter().map(|w| w.stealer()).collect(),
+            pending: AtomicUsize::new(1),
+            stop: AtomicBool::new(false),
+            entries: AtomicU64::new(0),
+            dirs: AtomicU64::new(0),
+            errors: AtomicU64::new(0),
+        };
+        shared.injector.push(Job {
+            path: self.root.clone(),
+            depth: 0,
+        });
+
+        if workers.len() == 1 {
+            let local = workers.into_iter().next().unwrap();
+            run_worker(&shared, 0, &local);
+        } else {
+            std::thread::scope(|s| {
+                for (i, local) in workers.into_iter().enumerate() {
+                    let shared = &shared;
+                    s.spawn(move || run_worker(shared, i, &local));
+                }
+            });
+        }
+
+        WalkSummary {
+            entries: shared.entries.into_inner(),
+            dirs: shared.dirs.into_inner(),
+            errors: shared.errors.into_inner(),
+        }
+    }
+}
+
+fn find_job(
+    local: &Worker<Job>,
+    injector: &Injector<Job>,
+    stealers: &[Stealer<Job>],
+) -> Option<Job> {
+    local.pop().or_else(|| {
+        std::iter::repeat_with(|| {
+            injector
+                .steal_batch_and_pop(local)
+                .or_else(|| stealers.iter().map(|s| s.steal()).collect())
+        })
+        .find(|s| !s.is_retry())
+        .and_then(|s| s.success())
+    })
+}
+
+fn run_worker<F>(shared: &Shared<'_, F>, index: usize, local: &Worker<Job>)
+where
+    F: Fn(usize, WalkEntry) -> bool + Sync,
+{
+    let mut lister = DirLister::new();
+    let mut idle_spins = 0u32;
+    loop {
+        match find_job(local, &shared.injector, &shared.stealers) {
+            Some(job) => {
+                idle_spins = 0;
+                // After a stop, queued jobs are only drained so that
+                // `pending` still reaches zero
+                if !shared.stop.load(Ordering::Relaxed) {
+                    list_dir(shared, index, local, &mut lister, job);
+                }
+                shared.pending.fetch_sub(1, Ordering::AcqRel);
+            }
+            None => {
+                if shared.pending.load(Ordering::Acquire) == 0 {
+                    return;
+                }
+                idle_spins += 1;
+                if idle_spins < 64 {
+                    std::hint::spin_loop();
+                } else {
+                    std::thread::yield_now();
+                }
+            }
+        }
+    }
+}
+
+fn list_dir<F>(
+    shared: &Shared<'_, F>,
+    index: usize,
+    local: &Worker<Job>,
+    lister: &mut DirLister,
+    job: Job,
+) where
+    F: Fn(usize, WalkEntry) -> bool + Sync,
+{
+    let walker = shared.walker;
+    let Ok(cpath) = CString::new(job.path.as_os_str().as_bytes()) else {
+        shared.errors.fetch_add(1, Ordering::Relaxed);
+        return;
+    };
+    // SAFETY: valid NUL-terminated path; fd is closed by DirLister
+    let fd = unsafe {
+        libc::open(
+            cpath.as_ptr(),
+            libc::O_RDONLY | libc::O_DIRECTORY | libc::O_CLOEXEC,
+        )
+    };
+    if fd < 0 {
+        tracing::debug!(
+            "tree_walk: cannot open {}: {}",
+            job.path.display(),
+            std::io::Error::last_os_error()
+        );
+        shared.errors.fetch_add(1, Ordering::Relaxed);
+        return;
+    }
+    shared.dirs.fetch_add(1, Ordering::Relaxed);
+
+    let depth = job.depth + 1;
+    let result = lister.list(fd, |name, d_type| {
+        if shared.stop.load(Ordering::Relaxed) {
+            return false;
+        }
+        if name == b"." || name == b".." {
+            return true;
+        }
+        if walker.skip_names.iter().any(|skip| skip.as_slice() == name) {
+            return true;
+        }
+
+        let mut kind = kind_from_d_type(d_type);
+        let mut stat = None;
+        if walker.with_stat || kind.is_none() {
+            match fstatat_entry(fd, name) {
+                Some(st) => {
+                    kind = Some(kind_from_mode(st.st_mode));
+                    stat = walker.with_stat.then(|| entry_stat(&st));
+                }
+                None => return true, // Vanished since listing
+            }
+        }
+        let kind = kind.unwrap_or(EntryKind::Other);
+
+        let path = job.path.join(OsStr::from_bytes(name));
+        if let Some(filter) = &walker.filter {
+            if !filter(&path, kind) {
+                return true;
+            }
+        }
+        if kind == EntryKind::Dir && depth <= walker.max_depth {
+            shared.pending.fetch_add(1, Ordering::AcqRel);
+            local.push(Job {
+                path: path.clone(),
+                depth,
+            });
+        }
+
+        shared.entries.fetch_add(1, Ordering::Relaxed);
+        let keep_going = (shared.visit)(
+            index,
+            WalkEntry {
+                path,
+                kind,
+                depth,
+                stat,
+            },
+        );
+        if !keep_going {
+            shared.stop.store(true, Ordering::Relaxed);
+        }
+        keep_going
+    });
+    if let Err(e) = result {
+        tracing::debug!("tree_walk: cannot read {}: {}", job.path.display(), e);
+        shared.errors.fetch_add(1, Ordering::Relaxed);
+    }
+}
+
+fn kind_from_d_type(d_type: u8) -> Option<EntryKind> {
+    match d_type {
+        libc::DT_REG => Some(EntryKind::File),
+        libc::DT_DIR => Some(EntryKind::Dir),
+        libc::DT_LNK => Some(EntryKind::Symlink),
+        libc::DT_UNKNOWN => None,
+        _ => Some(EntryKind::Other),
+    }
+}
+
+fn kind_from_mode(mode: libc::mode_t) -> EntryKind {
+    match mode & libc::S_IFMT {
+        libc::S_IFREG => EntryKind::File,
+        libc::S_IFDIR => EntryKind::Dir,
+        libc::S_IFLNK => EntryKind::Symlink,
+        _ => EntryKind::Other,
+    }
+}
+
+fn fstatat_entry(dirfd: libc::c_int, name: &[u8]) -> Option<libc::stat> {
+    let mut cname = [0u8; 256];
+    if name.len() >= cname.len() {
+        return None;
+    }
+    cname[..name.len()].copy_from_slice(name);
+    // SAFETY: stat is plain old data, filled by the kernel on success
+    let mut st: libc::stat = unsafe { std::mem::zeroed() };
+    // SAFETY: cname is NUL-terminated, dirfd is open
+    let rc = unsafe {
+        libc::fstatat(
+            dirfd,
+            cname.as_ptr().cast(),
+            &mut st,
+            libc::AT_SYMLINK_NOFOLLOW,
+        )
+    };
+    (rc == 0).then_some(st)
+}
+
+#[allow(clippy::unnecessary_cast)] // mode_t is u16 on macOS, u32 on Linux
+fn entry_stat(st: &libc::stat) -> EntryStat {
+    EntryStat {
+        size: st.st_size as u64,
+        mtime_nsec: (st.st_mtime as u64)
+            .saturating_mul(1_000_000_000)
+            .saturating_add(st.st_mtime_nsec as u64),
+        mode: st.st_mode as u32,
+    }
+}
+
+// ============================================================================
+// Directory listing: getdents64 (Linux) / readdir (other Unix)
+// ============================================================================
+
+/// Per-worker listing state (one reusable buffer on Linux)
+struct DirLister {
+    #[cfg(target_os = "linux")]
+    buf: Vec<u8>,
+}
+
+impl DirLister {
+    fn new() -> Self {
+        Self {
+            #[cfg(target_os = "linux")]
+            buf: vec![0u8; DENTS_BUF_SIZE],
+        }
+    }
+
+    /// List `fd` (consumed and closed), calling `f(name, d_type)` until it
+    /// returns false
+    #[cfg(target_os = "linux")]
+    fn list<G>(&mut self, fd: libc::c_int, mut f: G) -> std::io::Result<()>
+    where
+        G: FnMut(&[u8], u8) -> bool,
+    {
+        // linux_dirent64: d_ino u64, d_off i64, d_reclen u16, d_type u8, d_name
+        const NAME_OFFSET: usize = 19;
+        let result = 'outer: loop {
+            // SAFETY: buf is valid for buf.len() bytes
+            let n = unsafe {
+                libc::syscall(
+                    libc::SYS_getdents64,
+                    fd,
+                    self.buf.as_mut_ptr(),
+                    self.buf.len(),
+                )
+            };
+            if n < 0 {
+                break Err(std::io::Error::last_os_error());
+            }
+            if n == 0 {
+                break Ok(());
+            }
+            let mut pos = 0usize;
+            while pos < n as usize {
+                let rec = &self.buf[pos..n as usize];
+                let reclen = u16::from_ne_bytes([rec[16], rec[17]]) as usize;
+                let d_type = rec[18];
+                let name_area = &rec[NAME_OFFSET..reclen];
+                let len = name_area
+                    .iter()
+                    .position(|&b| b == 0)
+                    .unwrap_or(name_area.len());
+                if !f(&name_area[..len], d_type) {
+                    break 'outer Ok(());
+                }
+                pos += reclen;
+            }
+        };
+        // SAFETY: fd was opened by the caller and is not used afterwards
+        unsafe { libc::close(fd) };
+        result
+    }
+
+    #[cfg(not(target_os = "linux"))]
+    fn list<G>(&mut self, fd: libc::c_int, mut f: G) -> std::io::Result<()>
+    where
+        G: FnMut(&[u8], u8) -> bool,
+    {
+        // SAFETY: fd is an open directory; fdopendir takes ownership of it
+        let dir = unsafe { libc::fdopendir(fd) };
+        if dir.is_null() {
+            let err = std::io::Error::last_os_error();
+            // SAFETY: fdopendir failed, so fd is still ours
+            unsafe { libc::close(fd) };
+            return Err(err);
+        }
+        // `f` keeps using fd for fstatat; it stays valid until closedir
+        loop {
+            // SAFETY: dir is a valid DIR* until closedir
+            let ent = unsafe { libc::readdir(dir) };
+            if ent.is_null() {
+                break;
+            }
+            // SAFETY: readdir returns a valid dirent with a NUL-terminated name
+            let (name, d_type) = unsafe {
+                let ent = &*ent;
+                (
+                    std::ffi::CStr::from_ptr(ent.d_name.as_ptr()).to_bytes(),
+                    ent.d_type,
+                )
+            };
+            if !f(name, d_type) {
+                break;
+            }
+        }
+        // SAFETY: closes the DIR* and its fd
+        unsafe { libc::closedir(dir) };
+        Ok(())
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+    use std::collections::BTreeSet;
+    use std::fs;
+    use tempfile::TempDir;
+
+    fn tree() -> TempDir {
+        let temp = TempDir::new().unwrap();
+        let root = temp.path();
+        for d in 0..8 {
+            let dir = root.join(format!("d{}", d)).join("nested");
+            fs::create_dir_all(&dir).unwrap();
+            for f in 0..50 {
+                fs::write(dir.join(format!("f{}.txt", f)), format!("{}-{}", d, f)).unwrap();
+            }
+        }
+        fs::create_dir_all(root.join(".git/objects")).unwrap();
+        fs::write(root.join(".git/objects/x"), "x").unwrap();
+        fs::write(root.join("top.txt"), "top").unwrap();
+        std::os::unix::fs::symlink("top.txt", root.join("link")).unwrap();
+        temp
+    }
+
+    #[test]
+    fn test_walk_matches_walkdir() {
+        let temp = tree();
+        let expected: BTreeSet<PathBuf> = walkdir::WalkDir::new(temp.path())
+            .into_iter()
+            .filter_map(|e| e.ok())
+            .filter(|e| e.file_type().is_file())
+            .map(|e| e.into_path())
+            .collect();
+
+        for threads in [1, 4] {
+            let files: BTreeSet<PathBuf> = TreeWalker::new(temp.path())
+                .threads(threads)
+                .collect_files()
+                .into_iter()
+                .collect();
+            assert_eq!(files, expected);
+        }
+    }
+
+    #[test]
+    fn test_skip_filter_depth_and_stat() {
+        let temp = tree();
+        let root = temp.path().to_path_buf();
+
+        let seen = Mutex::new(Vec::new());
+        let summary = TreeWalker::new(&root)
+            .skip_names([".git"])
+            .filter(|path, _| !path.ends_with("d3"))
+            .max_depth(1)
+            .with_stat(true)
+            .walk(|entry| {
+                seen.lock().unwrap().push(entry);
+                true
+            });
+        let seen = seen.into_inner().unwrap();
+
+        assert_eq!(summary.errors, 0);
+        assert!(seen.iter().all(|e| e.stat.is_some()));
+        assert!(!seen.iter().any(|e| e.path.starts_with(root.join(".git"))));
+        assert!(!seen.iter().any(|e| e.path.starts_with(root.join("d3"))));
+        // max_depth 1: d*/nested is reported but not read
+        assert!(seen
+            .iter()
+            .any(|e| e.path.ends_with("d0/nested") && e.depth == 2));
+        assert!(!seen.iter().any(|e| e.depth > 2));
+
+        let link = seen.iter().find(|e| e.path.ends_with("link")).unwrap();
+        assert_eq!(link.kind, EntryKind::Symlink);
+        let top = seen.iter().find(|e| e.path.ends_with("top.txt")).unwrap();
+        assert_eq!(top.stat.unwrap().size, 3);
+    }
+
+    #[test]
+    fn test_visit_can_stop_walk() {
+        let temp = tree();
+        let count = AtomicUsize::new(0);
+        TreeWalker::new(temp.path())
+            .threads(4)
+            .walk(|_| count.fetch_add(1, Ordering::Relaxed) < 10);
+        assert!(count.load(Ordering::Relaxed) < 100);
+    }
+}
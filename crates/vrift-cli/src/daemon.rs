@@ -43,6 +43,37 @@ pub async fn check_status(_project_root: &Path) -> Result<()> {
     Ok(())
 }
 
+/// Print vriftd's metrics followed by those of the project's vDird
+/// (Prometheus text format, ready for a textfile collector or pushgateway)
+pub async fn print_metrics(project_root: &Path) -> Result<()> {
+    let conn = connect_to_daemon(project_root).await?;
+    let mut text = request_metrics(conn.stream).await?;
+
+    let vdird = UnixStream::connect(&conn.vdird_socket)
+        .await
+        .with_context(|| format!("Failed to connect to vDird at {}", conn.vdird_socket))?;
+    text.push_str(&request_metrics(vdird).await?);
+
+    print!("{}", text);
+    Ok(())
+}
+
+async fn request_metrics(mut stream: UnixStream) -> Result<String> {
+    send_request(&mut stream, VeloRequest::Metrics).await?;
+    let resp = tokio::time::timeout(
+        std::time::Duration::from_secs(5),
+        read_response(&mut stream),
+    )
+    .await
+    .map_err(|_| anyhow::anyhow!("Timed out waiting for metrics (5s)"))??;
+
+    match resp {
+        VeloResponse::MetricsAck { text } => Ok(text),
+        VeloResponse::Error(e) => anyhow::bail!("Metrics failed: {}", e),
+        _ => anyhow::bail!("Unexpected metrics response: {:?}", resp),
+    }
+}
+
 pub async fn spawn_command(command: &[String], cwd: PathBuf, project_root: &Path) -> Result<()> {
     let conn = connect_to_daemon(project_root).await?;
     let mut stream = conn.stream;
@@ -74,6 +74,7 @@ pub fn cmd_doctor(project_dir: &Path) -> Result<()> {
     eprintln!();
     eprintln!("{}", style("Shim (Inception Layer)").bold());
     check_shim(project_dir, &mut d);
+    check_shim_metrics(project_dir, &mut d);
 
     // 5. CAS / TheSource
     eprintln!();
@@ -271,6 +272,57 @@ fn check_shim(project_dir: &Path, d: &mut DiagResult) {
     }
 }
 
+/// Interposition counters as aggregated by the project's vDird
+fn check_shim_metrics(project_dir: &Path, d: &mut DiagResult) {
+    let socket =
+        vrift_vdird::ProjectConfig::from_project_root(project_dir.to_path_buf()).socket_path;
+    let Ok(text) = query_metrics(&socket) else {
+        d.info("vDird not reachable: no interposition counters");
+        return;
+    };
+
+    let value = |name: &str| metric_value(&text, name).unwrap_or(0.0);
+    let hits = value("vrift_inception_vdir_hits_total");
+    let lookups = hits + value("vrift_inception_vdir_misses_total");
+    if lookups > 0.0 {
+        d.info(&format!(
+            "VDir hit rate: {:.1}% of {} lookups ({} processes reporting)",
+            hits * 100.0 / lookups,
+            lookups,
+            value("vrift_inception_processes")
+        ));
+    } else {
+        d.info("No VDir lookups recorded yet");
+    }
+
+    let fallbacks = value("vrift_inception_raw_fallbacks_total");
+    if fallbacks > 0.0 {
+        d.warn(&format!(
+            "{} calls fell back to the real syscall (daemon unreachable)",
+            fallbacks
+        ));
+    }
+}
+
+fn query_metrics(socket: &Path) -> std::io::Result<String> {
+    use vrift_ipc::{frame_sync, VeloRequest, VeloResponse};
+
+    let mut stream = std::os::unix::net::UnixStream::connect(socket)?;
+    stream.set_read_timeout(Some(std::time::Duration::from_secs(2)))?;
+    frame_sync::send_request(&mut stream, &VeloRequest::Metrics)?;
+    match frame_sync::read_response(&mut stream)?.1 {
+        VeloResponse::MetricsAck { text } => Ok(text),
+        _ => Err(std::io::ErrorKind::InvalidData.into()),
+    }
+}
+
+/// First sample of an unlabelled metric in Prometheus text
+fn metric_value(text: &str, name: &str) -> Option<f64> {
+    text.lines()
+        .filter(|line| !line.starts_with('#'))
+        .find_map(|line| line.strip_prefix(name)?.strip_prefix(' ')?.parse().ok())
+}
+
 fn check_cas(d: &mut DiagResult) {
     let cfg = vrift_config::Config::load().unwrap_or_default();
     let cas_root = cfg.cas_root();
@@ -1,15 +1,17 @@
 //! # Garbage Collection (RFC-0041)
 //!
-//! Multi-manifest garbage collection with registry integration and Bloom-assisted daemon sweep.
+//! Multi-manifest garbage collection with registry integration. The mark
+//! phase exports referenced hashes as a sorted live set; the daemon sweeps
+//! the CAS against it in parallel (see `vrift_cas::gc`).
 
 use anyhow::{Context, Result};
 use clap::Args;
 use std::collections::HashSet;
 use std::io::{self, Write};
 use std::path::{Path, PathBuf};
-use std::time::Instant;
-use vrift_cas::CasStore;
-use vrift_manifest::Manifest;
+use std::time::{Duration, Instant, SystemTime};
+use vrift_cas::{CasStore, LiveSet, SweepOptions};
+use vrift_manifest::MappedManifest;
 
 use crate::registry::ManifestRegistry;
 
@@ -30,6 +32,14 @@ pub struct GcArgs {
     /// Skip confirmation prompt (for scripts and CI)
     #[arg(long, short = 'y', default_value = "false")]
     yes: bool,
+
+    /// Keep orphans changed less than this many minutes before the mark
+    #[arg(long, default_value = "60")]
+    min_age_mins: u64,
+
+    /// Cap on sweep filesystem operations per second (0 = unlimited)
+    #[arg(long, default_value = "0")]
+    io_limit: u32,
 }
 
 pub async fn run(cas_root: &Path, args: GcArgs) -> Result<()> {
@@ -46,15 +56,14 @@ pub async fn run(cas_root: &Path, args: GcArgs) -> Result<()> {
     // Verify all manifests to detect stale ones
     let (active_count, stale_count) = registry.verify_all();
 
-    // Collect all referenced blob hashes
+    // Collect all referenced blob hashes. Blobs stored after this point
+    // are younger than the mark and survive the sweep.
+    let marked_at = SystemTime::now();
     let keep_set: HashSet<_> = if let Some(ref manifest_path) = args.manifest {
         println!();
         println!("  [Legacy Mode] Using single manifest: {:?}", manifest_path);
-        let manifest = Manifest::load(manifest_path).context("Failed to parse manifest")?;
-        manifest
-            .iter()
-            .map(|(_, entry)| entry.content_hash)
-            .collect()
+        let manifest = MappedManifest::open(manifest_path).context("Failed to parse manifest")?;
+        manifest.entries().map(|entry| entry.content_hash).collect()
     } else {
         println!();
         println!("  Registry Status:");
@@ -82,23 +91,37 @@ pub async fn run(cas_root: &Path, args: GcArgs) -> Result<()> {
         format_number(keep_set.len() as u64)
     );
 
-    // Build Bloom Filter from keep_set
-    use vrift_ipc::{BloomFilter, BLOOM_SIZE};
-    let mut bloom = BloomFilter::new(BLOOM_SIZE);
-    for hash in &keep_set {
-        bloom.add(&CasStore::hash_to_hex(hash));
+    // Export the live set for the (parallel, mmap-based) sweep
+    let gc_dir = cas_root.join("gc");
+    std::fs::create_dir_all(&gc_dir).context("Failed to create GC directory")?;
+    let live_set_path = gc_dir.join(format!("live-{}.set", std::process::id()));
+    LiveSet::write(&live_set_path, keep_set.iter().copied(), marked_at)
+        .context("Failed to write live set")?;
+    let result = sweep(cas_root, &live_set_path, &args).await;
+    let _ = std::fs::remove_file(&live_set_path);
+    if !result? {
+        return Ok(());
     }
 
+    // Save registry
+    registry.save()?;
+    println!();
+    Ok(())
+}
+
+/// Sweep against the exported live set: on the daemon with `--delete`,
+/// locally as a dry run otherwise. Returns false if cancelled.
+async fn sweep(cas_root: &Path, live_set_path: &Path, args: &GcArgs) -> Result<bool> {
     if args.delete {
         if !args.yes {
             println!();
-            print!("  ⚠️  Proceed with Bloom-assisted GC sweep on daemon? [y/N] ");
+            print!("  ⚠️  Proceed with GC sweep on daemon? [y/N] ");
             io::stdout().flush()?;
             let mut input = String::new();
             io::stdin().read_line(&mut input)?;
             if !input.trim().eq_ignore_ascii_case("y") {
                 println!("  Cancelled.");
-                return Ok(());
+                return Ok(false);
             }
         }
 
@@ -114,8 +137,10 @@ pub async fn run(cas_root: &Path, args: GcArgs) -> Result<()> {
         let mut stream = conn.stream;
         crate::daemon::send_request(
             &mut stream,
-            VeloRequest::CasSweep {
-                bloom_filter: bloom.bits.clone(),
+            VeloRequest::CasSweepLive {
+                live_set_path: live_set_path.to_string_lossy().into_owned(),
+                min_age_secs: args.min_age_mins * 60,
+                io_ops_per_sec: args.io_limit,
             },
         )
         .await?;
@@ -143,21 +168,24 @@ pub async fn run(cas_root: &Path, args: GcArgs) -> Result<()> {
     } else {
         println!("\n  📋 Dry Run: Scanning CAS for orphaned blobs...");
         let cas = CasStore::new(cas_root)?;
-        let mut orphan_count = 0u64;
-        let mut orphan_bytes = 0u64;
-
-        if let Ok(iter) = cas.iter() {
-            for hash in iter.flatten() {
-                if !keep_set.contains(&hash) {
-                    orphan_count += 1;
-                    if let Some(p) = cas.blob_path_for_hash(&hash) {
-                        if let Ok(meta) = std::fs::metadata(p) {
-                            orphan_bytes += meta.len();
-                        }
-                    }
-                }
-            }
-        }
+        let live = LiveSet::open(live_set_path)?;
+        let options = SweepOptions {
+            min_age: Duration::from_secs(args.min_age_mins * 60),
+            io_ops_per_sec: (args.io_limit > 0).then_some(args.io_limit),
+            dry_run: true,
+            ..Default::default()
+        };
+        let progress = cas.sweep_live(&live, &options, |progress, _| {
+            print!(
+                "\r   🔍 {}/{} shards, {} blobs scanned",
+                progress.shards_done,
+                progress.shards_total,
+                format_number(progress.scanned)
+            );
+            let _ = io::stdout().flush();
+        })?;
+        println!();
+        let (orphan_count, orphan_bytes) = (progress.deleted, progress.reclaimed_bytes);
 
         if orphan_count > 0 {
             println!(
@@ -168,15 +196,19 @@ pub async fn run(cas_root: &Path, args: GcArgs) -> Result<()> {
         } else {
             println!("   ✅ No orphans found.");
         }
+        if progress.skipped_young > 0 {
+            println!(
+                "   ⏳ {} recent orphans kept (younger than {} min)",
+                format_number(progress.skipped_young),
+                args.min_age_mins
+            );
+        }
 
         println!();
         println!("     👉 Run with --delete to trigger daemon sweep.");
     }
 
-    // Save registry
-    registry.save()?;
-    println!();
-    Ok(())
+    Ok(true)
 }
 
 /// Format bytes in human-readable form
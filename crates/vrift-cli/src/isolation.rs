@@ -187,7 +187,7 @@ fn setup_mounts(
     println!("   [Isolation] Populating LowerDir...");
     let link_farm = LinkFarm::new(cas);
     link_farm
-        .populate(&manifests, &lower_dir)
+        .populate_parallel(&manifests, &lower_dir)
         .context("Failed to populate Link Farm")?;
 
     // 3. Mount OverlayFS
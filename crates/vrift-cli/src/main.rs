@@ -7,6 +7,7 @@
 //! - `vrift ingest <dir>` - Import files to CAS and generate manifest
 //! - `vrift run <cmd>` - Execute command with VeloVFS virtualization
 //! - `vrift status` - Display CAS statistics
+//! - `vrift pack <trace>...` - Build a hot-path pack from access traces
 
 use std::fs;
 use std::path::{Path, PathBuf};
@@ -22,10 +23,12 @@ pub mod gc;
 mod inception;
 mod isolation;
 mod mount;
+mod pack;
 mod preflight;
 pub mod registry;
 #[allow(dead_code)]
 mod security_filter;
+mod trace;
 
 use vrift_cas::CasStore;
 use vrift_manifest::lmdb::LmdbManifest;
@@ -133,6 +136,10 @@ enum Commands {
         /// Show Inception Layer internal diagnostics
         #[arg(long)]
         inception: bool,
+
+        /// Print vriftd and vDird metrics in Prometheus text format
+        #[arg(long)]
+        metrics: bool,
     },
 
     /// Mount the manifest as a FUSE filesystem
@@ -141,6 +148,12 @@ enum Commands {
     /// Garbage Collect unreferenced blobs
     Gc(gc::GcArgs),
 
+    /// Pack hot blobs in first-access order from VRIFT_ACCESS_PROFILE traces
+    Pack(pack::PackArgs),
+
+    /// Decode VRIFT_FLIGHT_DUMP flight recorder dumps: latency histograms, Chrome trace
+    Trace(trace::TraceArgs),
+
     /// Resolve dependencies from a velo.lock file
     Resolve {
         /// Lockfile path
@@ -533,12 +546,19 @@ async fn async_main(
             session,
             directory,
             inception,
+            metrics,
         } => {
             let dir = directory.unwrap_or_else(|| std::env::current_dir().unwrap());
-            cmd_status(&cas_root, manifest.as_deref(), session, inception, &dir)
+            if metrics {
+                daemon::print_metrics(&dir).await
+            } else {
+                cmd_status(&cas_root, manifest.as_deref(), session, inception, &dir)
+            }
         }
         Commands::Mount(args) => mount::run(args, &cas_root),
         Commands::Gc(args) => gc::run(&cas_root, args).await,
+        Commands::Pack(args) => pack::run(&cas_root, args),
+        Commands::Trace(args) => trace::run(args),
         Commands::Resolve { lockfile } => cmd_resolve(&cas_root, &lockfile),
         Commands::Daemon { command } => match command {
             DaemonCommands::Status { directory } => {
@@ -893,16 +913,21 @@ fn cmd_manifest(command: ManifestCommands) -> Result<()> {
             }
 
             let manifest = LmdbManifest::open(&manifest_path)?;
-            let entries = manifest.iter()?;
-            let limit = limit.unwrap_or(entries.len());
-
-            println!("Manifest entries ({} total):", entries.len());
-            for (i, (path, entry)) in entries.iter().enumerate() {
-                if i >= limit {
-                    println!("... and {} more", entries.len() - limit);
-                    break;
+            let total = manifest.len()?;
+            let limit = limit.unwrap_or(total);
+
+            println!("Manifest entries ({} total):", total);
+            let mut shown = 0;
+            manifest.for_each(|path, entry| {
+                if shown >= limit {
+                    return false;
                 }
                 println!("  {} ({} bytes)", path, entry.vnode.size);
+                shown += 1;
+                true
+            })?;
+            if total > shown {
+                println!("... and {} more", total - shown);
             }
             Ok(())
         }
@@ -920,17 +945,22 @@ fn cmd_manifest(command: ManifestCommands) -> Result<()> {
             }
 
             let manifest = LmdbManifest::open(&manifest_path)?;
-            let entries = manifest.iter()?;
-
-            let total_size: u64 = entries.iter().map(|(_, e)| e.vnode.size).sum();
-            let dir_count = entries.iter().filter(|(p, _)| p.ends_with('/')).count();
-            let file_count = entries.len() - dir_count;
+            let (mut entry_count, mut dir_count, mut total_size) = (0u64, 0u64, 0u64);
+            manifest.for_each(|path, entry| {
+                entry_count += 1;
+                total_size += entry.vnode.size;
+                if path.ends_with('/') {
+                    dir_count += 1;
+                }
+                true
+            })?;
+            let file_count = entry_count - dir_count;
 
             println!("Manifest Statistics:");
             println!("  Path:       {}", manifest_path.display());
-            println!("  Entries:    {}", format_number(entries.len() as u64));
-            println!("  Files:      {}", format_number(file_count as u64));
-            println!("  Dirs:       {}", format_number(dir_count as u64));
+            println!("  Entries:    {}", format_number(entry_count));
+            println!("  Files:      {}", format_number(file_count));
+            println!("  Dirs:       {}", format_number(dir_count));
             println!("  Total Size: {}", format_bytes(total_size));
             Ok(())
         }
@@ -955,9 +985,6 @@ async fn cmd_sync(directory: &Path) -> Result<()> {
     }
 
     let manifest = LmdbManifest::open(&manifest_path)?;
-    let existing = manifest.iter()?;
-    let existing_paths: std::collections::HashSet<String> =
-        existing.iter().map(|(p, _)| p.clone()).collect();
 
     let mut new_files = 0u64;
     let mut new_dirs = 0u64;
@@ -974,7 +1001,7 @@ async fn cmd_sync(directory: &Path) -> Result<()> {
 
             let manifest_key = format!("/{}", rel.display());
 
-            if !existing_paths.contains(&manifest_key) {
+            if manifest.get(&manifest_key)?.is_none() {
                 if path.is_dir() {
                     println!("  [NEW DIR]  {}", manifest_key);
                     new_dirs += 1;
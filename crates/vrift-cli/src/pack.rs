@@ -0,0 +1,76 @@
+//! # Hot-path packs
+//!
+//! Builds `.vrift/hot.pack` from access traces recorded with
+//! `VRIFT_ACCESS_PROFILE=<file>`. The inception layer serves packed blobs
+//! from the pack, so a cold build reads one file front to back.
+
+use anyhow::{Context, Result};
+use clap::Args;
+use std::path::{Path, PathBuf};
+use std::time::Instant;
+use vrift_cas::CasStore;
+use vrift_pack::{build_pack, AccessProfile};
+
+#[derive(Args, Debug)]
+pub struct PackArgs {
+    /// Access traces recorded via VRIFT_ACCESS_PROFILE
+    #[arg(value_name = "TRACE", required = true)]
+    traces: Vec<PathBuf>,
+
+    /// Project directory (default: current directory)
+    #[arg(short, long)]
+    directory: Option<PathBuf>,
+
+    /// Output pack (default: <project>/.vrift/hot.pack)
+    #[arg(short, long)]
+    output: Option<PathBuf>,
+
+    /// Largest blob to pack, in KiB
+    #[arg(long, default_value = "1024")]
+    max_blob_kb: u64,
+}
+
+pub fn run(cas_root: &Path, args: PackArgs) -> Result<()> {
+    let start = Instant::now();
+    let traces = args
+        .traces
+        .iter()
+        .map(|path| std::fs::read(path).with_context(|| format!("Failed to read {:?}", path)))
+        .collect::<Result<Vec<_>>>()?;
+    let profile = AccessProfile::from_traces(traces.iter().map(Vec::as_slice));
+
+    let output = match args.output {
+        Some(output) => output,
+        None => {
+            let project = match args.directory {
+                Some(dir) => dir,
+                None => std::env::current_dir()?,
+            };
+            let vrift_dir = project.join(".vrift");
+            std::fs::create_dir_all(&vrift_dir)
+                .with_context(|| format!("Failed to create {:?}", vrift_dir))?;
+            vrift_dir.join("hot.pack")
+        }
+    };
+
+    let cas = CasStore::new(cas_root).context("Failed to open CAS")?;
+    let stats = build_pack(&cas, &profile, &output, args.max_blob_kb * 1024)
+        .with_context(|| format!("Failed to build {:?}", output))?;
+
+    println!();
+    println!("📦 Hot pack: {}", output.display());
+    println!("   Accessed: {} blobs", profile.access_order.len());
+    println!(
+        "   Packed:   {} blobs, {:.1} MiB",
+        stats.blobs,
+        stats.bytes as f64 / (1024.0 * 1024.0)
+    );
+    if stats.skipped > 0 {
+        println!(
+            "   Skipped:  {} (missing, empty or too large)",
+            stats.skipped
+        );
+    }
+    println!("   Time:     {:.2?}", start.elapsed());
+    Ok(())
+}
@@ -10,10 +10,10 @@ use std::time::Duration;
 
 use console::style;
 
-/// VDIR_MAGIC must match vrift-vdird/src/vdir.rs
+/// VDIR_MAGIC must match vrift-ipc/src/vdir_types.rs
 const VDIR_MAGIC: u32 = 0x56524654; // "VRFT"
-/// VDIR_VERSION must match vrift-vdird/src/vdir.rs
-const VDIR_VERSION: u32 = 2;
+/// VDIR_VERSION must match vrift-ipc/src/vdir_types.rs
+const VDIR_VERSION: u32 = 5;
 
 /// Result of preflight checks
 #[derive(Debug)]
@@ -21,7 +21,7 @@ use std::time::Duration;
 use uuid::Uuid;
 use vrift_cas::Blake3Hash;
 use vrift_config::path::normalize_or_original;
-use vrift_manifest::{LmdbManifest, Manifest};
+use vrift_manifest::{LmdbManifest, MappedManifest};
 
 /// Default lock timeout in seconds
 const DEFAULT_LOCK_TIMEOUT_SECS: u64 = 30;
@@ -294,19 +294,18 @@ impl ManifestRegistry {
                 let lmdb = LmdbManifest::open(&entry.source_path).with_context(|| {
                     format!("Failed to open LMDB manifest at {:?}", entry.source_path)
                 })?;
-                let entries = lmdb.iter().with_context(|| {
+                lmdb.for_each(|_, m_entry| {
+                    hashes.insert(m_entry.vnode.content_hash);
+                    true
+                })
+                .with_context(|| {
                     format!("Failed to iterate LMDB manifest at {:?}", entry.source_path)
                 })?;
-                for (_, m_entry) in entries {
-                    hashes.insert(m_entry.vnode.content_hash);
-                }
             } else {
-                // In-memory manifest (rkyv format)
-                let manifest = Manifest::load(&entry.source_path)
+                // Flat manifest (rkyv format), read in place
+                let manifest = MappedManifest::open(&entry.source_path)
                     .with_context(|| format!("Failed to load manifest: {:?}", entry.source_path))?;
-                for (_, vnode) in manifest.iter() {
-                    hashes.insert(vnode.content_hash);
-                }
+                hashes.extend(manifest.entries().map(|vnode| vnode.content_hash));
             }
         }
 
@@ -0,0 +1,239 @@
+//! # Flight recorder traces
+//!
+//! Decodes the binary dumps the inception layer writes with
+//! `VRIFT_FLIGHT_DUMP=<prefix>` (on SIGUSR2 and at exit): per-event latency
+//! percentiles and histograms, and optionally a Chrome trace (loads in
+//! `chrome://tracing` and Perfetto).
+
+use anyhow::{Context, Result};
+use clap::Args;
+use serde_json::{json, Value};
+use std::collections::BTreeMap;
+use std::path::PathBuf;
+use vrift_ipc::flight::{event_name, FlightDump};
+
+#[derive(Args, Debug)]
+pub struct TraceArgs {
+    /// Dumps written via VRIFT_FLIGHT_DUMP (`<prefix>.<pid>`)
+    #[arg(value_name = "DUMP", required = true)]
+    dumps: Vec<PathBuf>,
+
+    /// Also write a Chrome/Perfetto trace (JSON) here
+    #[arg(long, value_name = "FILE")]
+    chrome: Option<PathBuf>,
+}
+
+/// Latencies of one event type, in ns
+#[derive(Debug, Default)]
+struct EventStats {
+    count: u64,
+    /// Nonzero durations only (point events have none)
+    durations: Vec<u64>,
+}
+
+impl EventStats {
+    fn percentile(&self, p: f64) -> u64 {
+        if self.durations.is_empty() {
+            return 0;
+        }
+        let idx = ((self.durations.len() - 1) as f64 * p).round() as usize;
+        self.durations[idx]
+    }
+
+    /// Counts per power-of-two bucket: `[i]` holds `[2^i, 2^(i+1))` ns
+    fn histogram(&self) -> [u64; 64] {
+        let mut buckets = [0u64; 64];
+        for &d in &self.durations {
+            buckets[63 - d.max(1).leading_zeros() as usize] += 1;
+        }
+        buckets
+    }
+}
+
+fn summarize(dumps: &[FlightDump]) -> BTreeMap<u8, EventStats> {
+    let mut stats: BTreeMap<u8, EventStats> = BTreeMap::new();
+    for dump in dumps {
+        for entry in dump.entries.iter().filter(|e| e.event_type != 0) {
+            let s = stats.entry(entry.event_type).or_default();
+            s.count += 1;
+            if entry.duration > 0 {
+                s.durations.push(dump.duration_ns(entry));
+            }
+        }
+    }
+    for s in stats.values_mut() {
+        s.durations.sort_unstable();
+    }
+    stats
+}
+
+/// Chrome trace event format: a complete ("X") event per timed operation,
+/// an instant ("i") event otherwise. Timestamps are µs.
+fn chrome_trace(dumps: &[FlightDump]) -> Value {
+    let mut events = Vec::new();
+    for dump in dumps {
+        for entry in dump.entries.iter().filter(|e| e.event_type != 0) {
+            let end = dump.timestamp_ns(entry);
+            let dur = dump.duration_ns(entry);
+            let mut event = json!({
+                "name": event_name(entry.event_type),
+                "cat": "vfs",
+                "pid": dump.header.pid,
+                "tid": entry.tid,
+                "ts": end.saturating_sub(dur) as f64 / 1000.0,
+                "args": {
+                    "file_id": format!("0x{:016x}", entry.file_id),
+                    "result": entry.result,
+                },
+            });
+            if entry.duration > 0 {
+                event["ph"] = json!("X");
+                event["dur"] = json!(dur as f64 / 1000.0);
+            } else {
+                event["ph"] = json!("i");
+                event["s"] = json!("t");
+            }
+            events.push(event);
+        }
+    }
+    events.sort_by(|a, b| a["ts"].as_f64().partial_cmp(&b["ts"].as_f64()).unwrap());
+    json!({ "traceEvents": events, "displayTimeUnit": "ns" })
+}
+
+fn fmt_ns(ns: u64) -> String {
+    match ns {
+        0..=999 => format!("{}ns", ns),
+        1_000..=999_999 => format!("{:.1}µs", ns as f64 / 1e3),
+        1_000_000..=999_999_999 => format!("{:.1}ms", ns as f64 / 1e6),
+        _ => format!("{:.2}s", ns as f64 / 1e9),
+    }
+}
+
+pub fn run(args: TraceArgs) -> Result<()> {
+    let dumps = args
+        .dumps
+        .iter()
+        .map(|path| {
+            let bytes =
+                std::fs::read(path).with_context(|| format!("Failed to read {:?}", path))?;
+            FlightDump::parse(&bytes).with_context(|| format!("Failed to decode {:?}", path))
+        })
+        .collect::<Result<Vec<_>>>()?;
+
+    let stats = summarize(&dumps);
+    let total: u64 = stats.values().map(|s| s.count).sum();
+
+    println!();
+    println!(
+        "🛰  Flight recorder: {} dump(s), {} events",
+        dumps.len(),
+        total
+    );
+    println!();
+    println!(
+        "   {:<16} {:>9} {:>9} {:>9} {:>9}",
+        "Event", "Count", "p50", "p99", "max"
+    );
+    for (&event, s) in &stats {
+        if s.durations.is_empty() {
+            println!("   {:<16} {:>9}", event_name(event), s.count);
+            continue;
+        }
+        println!(
+            "   {:<16} {:>9} {:>9} {:>9} {:>9}",
+            event_name(event),
+            s.count,
+            fmt_ns(s.percentile(0.50)),
+            fmt_ns(s.percentile(0.99)),
+            fmt_ns(*s.durations.last().unwrap())
+        );
+    }
+
+    for (&event, s) in stats.iter().filter(|(_, s)| !s.durations.is_empty()) {
+        let buckets = s.histogram();
+        let first = buckets.iter().position(|&c| c > 0).unwrap_or(0);
+        let last = buckets.iter().rposition(|&c| c > 0).unwrap_or(0);
+        let peak = buckets.iter().copied().max().unwrap_or(1).max(1);
+        println!();
+        println!("   {} latency:", event_name(event));
+        for (i, &count) in buckets.iter().enumerate().take(last + 1).skip(first) {
+            let bar = "█".repeat((count * 40).div_ceil(peak) as usize);
+            println!("   {:>9} │{} {}", fmt_ns(1u64 << i), bar, count);
+        }
+    }
+
+    if let Some(out) = args.chrome {
+        let trace = chrome_trace(&dumps);
+        std::fs::write(&out, serde_json::to_vec(&trace)?)
+            .with_context(|| format!("Failed to write {:?}", out))?;
+        println!();
+        println!("   Chrome trace: {}", out.display());
+    }
+    Ok(())
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+    use vrift_ipc::flight::{FlightDumpHeader, FlightEntry};
+
+    // ticks == ns
+    fn dump(entries: &[FlightEntry]) -> FlightDump {
+        let header = FlightDumpHeader {
+            pid: 9,
+            count: entries.len() as u64,
+            ..Default::default()
+        };
+        let mut bytes = header.to_bytes().to_vec();
+        for e in entries {
+            bytes.extend_from_slice(&e.to_bytes());
+        }
+        FlightDump::parse(&bytes).unwrap()
+    }
+
+    fn entry(event_type: u8, timestamp: u64, duration: u32) -> FlightEntry {
+        FlightEntry {
+            timestamp,
+            duration,
+            tid: 3,
+            event_type,
+            ..FlightEntry::EMPTY
+        }
+    }
+
+    #[test]
+    fn test_summary_percentiles_and_histogram() {
+        let mut entries: Vec<_> = (1..=100)
+            .map(|i| entry(3, i * 1000, i as u32 * 10))
+            .collect();
+        entries.push(entry(9, 0, 0));
+        entries.push(FlightEntry::EMPTY);
+        let stats = summarize(&[dump(&entries)]);
+
+        assert_eq!(stats.len(), 2);
+        let stat = &stats[&3];
+        assert_eq!(stat.count, 100);
+        assert_eq!(stat.percentile(0.5), 510);
+        assert_eq!(stat.percentile(0.99), 990);
+        assert!(stats[&9].durations.is_empty());
+
+        let buckets = stat.histogram();
+        assert_eq!(buckets.iter().sum::<u64>(), 100);
+        assert_eq!(buckets[3], 1); // 10 ns
+        assert_eq!(buckets[9], 49); // 520..=1000 ns
+    }
+
+    #[test]
+    fn test_chrome_trace_events() {
+        let trace = chrome_trace(&[dump(&[entry(3, 5_000, 2_000), entry(9, 1_000, 0)])]);
+        let events = trace["traceEvents"].as_array().unwrap();
+        assert_eq!(events.len(), 2);
+        assert_eq!(events[0]["ph"], "i");
+        assert_eq!(events[0]["name"], "VfsInit");
+        assert_eq!(events[1]["ph"], "X");
+        assert_eq!(events[1]["ts"], 3.0);
+        assert_eq!(events[1]["dur"], 2.0);
+        assert_eq!(events[1]["pid"], 9);
+        assert_eq!(events[1]["tid"], 3);
+    }
+}
@@ -183,6 +183,18 @@ impl Config {
         if has_key("storage", "default_mode") {
             self.storage.default_mode = other.storage.default_mode;
         }
+        if has_key("storage", "remote") {
+            self.storage.remote = other.storage.remote;
+        }
+        if has_key("storage", "remote_cache_mb") {
+            self.storage.remote_cache_mb = other.storage.remote_cache_mb;
+        }
+        if has_key("storage", "remote_parallelism") {
+            self.storage.remote_parallelism = other.storage.remote_parallelism;
+        }
+        if has_key("storage", "remote_write_back") {
+            self.storage.remote_write_back = other.storage.remote_write_back;
+        }
 
         // Daemon
         if has_key("daemon", "socket") {
@@ -225,6 +237,9 @@ impl Config {
         if let Ok(path) = std::env::var("VR_THE_SOURCE") {
             self.storage.the_source = PathBuf::from(path);
         }
+        if let Ok(remote) = std::env::var("VRIFT_REMOTE_CAS") {
+            self.storage.remote = Some(remote).filter(|r| !r.is_empty());
+        }
 
         // Ingest
         if let Ok(threads) = std::env::var("VRIFT_THREADS") {
@@ -305,6 +320,7 @@ vfs_prefix = "{vfs_prefix}"
 [storage]
 the_source = "{the_source}"
 # default_mode = "solid"
+# remote = "http://cas.internal:8080/vrift"  # shared CAS, fetched on miss
 
 [daemon]
 # socket = "{socket}"
@@ -399,6 +415,17 @@ pub struct StorageConfig {
     pub the_source: PathBuf,
     /// Default projection mode: solid or phantom
     pub default_mode: String,
+    /// Remote CAS tier shared between nodes: an `http://` URL or a shared
+    /// directory. Blobs missing from TheSource are fetched from it by hash.
+    /// Env override: VRIFT_REMOTE_CAS
+    pub remote: Option<String>,
+    /// Local space for blobs fetched from the remote, in MiB; the least
+    /// recently used are evicted past it (default: 10240)
+    pub remote_cache_mb: u64,
+    /// Blobs fetched or pushed at once (default: 16)
+    pub remote_parallelism: usize,
+    /// Push newly ingested blobs to the remote (default: true)
+    pub remote_write_back: bool,
 }
 
 impl Default for StorageConfig {
@@ -406,6 +433,10 @@ impl Default for StorageConfig {
         Self {
             the_source: PathBuf::from(DEFAULT_CAS_ROOT),
             default_mode: "solid".to_string(),
+            remote: None,
+            remote_cache_mb: 10240,
+            remote_parallelism: 16,
+            remote_write_back: true,
         }
     }
 }
@@ -418,14 +449,30 @@ pub struct IngestConfig {
     pub threads: Option<usize>,
     /// Default tier: tier1, tier2, or auto
     pub default_tier: String,
-    /// Deduplication window in milliseconds (default: 200ms)
+    /// Debounce window in milliseconds: a path is ingested once its events
+    /// have been quiet this long (default: 200ms)
     pub dedup_window_ms: u64,
-    /// Batch size for high-frequency writes (default: 10)
+    /// Max coalesced events handed to the ingest workers at once (default: 10)
     pub batch_size: usize,
-    /// Batch timeout in milliseconds (default: 100ms)
+    /// Batch timeout in milliseconds (default: 100ms). Unused since live
+    /// ingest coalesces per path; kept so existing configs still parse.
     pub batch_timeout_ms: u64,
     /// Patterns to ignore during ingest and live watch
     pub ignore_patterns: Vec<String>,
+    /// Store reingested files at least this large (MiB) as content-defined
+    /// chunks so edits only write the changed chunks (0 = disabled). The
+    /// first open through the VFS adds a flat copy, kept while the file's
+    /// content is live.
+    pub chunk_threshold_mb: u64,
+    /// On CoW reingest, rehash only the ranges the inception layer saw
+    /// written (write, writev, pwrite[v][2], fallocate, ftruncate; shared
+    /// mappings over their whole window). Any change it did not make
+    /// itself moves the file's ctime and falls back to a full rehash, as
+    /// do a fork, a dup'd fd, an io_uring or shared mapping still open at
+    /// close, and macOS. Off by default: kernels without fine-grained
+    /// ctime (before 6.13) can miss a foreign write landing in the same
+    /// tick as a tracked one.
+    pub delta_reingest: bool,
 }
 
 impl Default for IngestConfig {
@@ -441,6 +488,8 @@ impl Default for IngestConfig {
                 ".vrift".to_string(),    // Vrift system directory (always needed)
                 ".DS_Store".to_string(), // macOS junk
             ],
+            chunk_threshold_mb: 0,
+            delta_reingest: false,
         }
     }
 }
@@ -538,6 +587,15 @@ pub struct DaemonConfig {
     pub cow_temp_dir: PathBuf,
     /// Log directory for daemon and inception-layer
     pub log_dir: PathBuf,
+    /// vDird group commit: while a burst of manifest mutations is arriving,
+    /// keep collecting for up to this many microseconds (0 = only coalesce
+    /// what is already queued)
+    pub group_commit_window_us: u64,
+    /// vDird group commit: max mutations applied per batch
+    pub group_commit_max: usize,
+    /// vDird prefetcher: blobs remembered per command + cwd and read ahead
+    /// when that command starts again (0 = off)
+    pub prefetch_max_blobs: usize,
 }
 
 impl Default for DaemonConfig {
@@ -553,6 +611,9 @@ impl Default for DaemonConfig {
             mmap_path: PathBuf::from("/tmp/vrift-manifest.mmap"),
             cow_temp_dir: PathBuf::from("/tmp"),
             log_dir: PathBuf::from("/tmp"),
+            group_commit_window_us: 200,
+            group_commit_max: 256,
+            prefetch_max_blobs: 4096,
         }
     }
 }
@@ -763,6 +824,23 @@ default_tier = "tier1"
         );
     }
 
+    #[test]
+    fn test_env_override_remote_cas() {
+        let _guard = ENV_LOCK.lock().unwrap(); // Serialize env tests
+        let mut config = Config::default();
+        assert_eq!(config.storage.remote, None);
+
+        std::env::set_var("VRIFT_REMOTE_CAS", "http://cas.internal:8080/vrift");
+        config.apply_env_overrides();
+        std::env::remove_var("VRIFT_REMOTE_CAS");
+
+        assert_eq!(
+            config.storage.remote.as_deref(),
+            Some("http://cas.internal:8080/vrift")
+        );
+        assert!(config.storage.remote_write_back);
+    }
+
     #[test]
     fn test_env_override_threads() {
         let _guard = ENV_LOCK.lock().unwrap(); // Serialize env tests
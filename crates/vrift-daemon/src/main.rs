@@ -36,9 +36,11 @@ async fn main() -> Result<()> {
     Ok(())
 }
 
-use std::collections::{HashMap, HashSet};
+mod shard;
+
+use std::collections::HashMap;
 use std::path::{Path, PathBuf};
-use std::sync::{Arc, Mutex};
+use std::sync::{Arc, Mutex, RwLock};
 
 use tokio::net::{UnixListener, UnixStream};
 use vrift_config::path::is_within_directory;
@@ -165,101 +167,6 @@ impl PeerCredentials {
     }
 }
 
-/// RFC-0049: Daemon Lock Manager for fs-independent flock virtualization
-/// Maintains lock state for VFS paths to support parallel build coordination
-struct LockManager {
-    // Map: Absolute Path -> Lock State
-    locks: Mutex<HashMap<String, LockState>>,
-}
-
-struct LockState {
-    // Exclusive owner (PID)
-    exclusive: Option<u32>,
-    // Shared owners (Set of PIDs)
-    shared: HashSet<u32>,
-    // Waiters notification
-    notify: Arc<tokio::sync::Notify>,
-}
-
-impl LockManager {
-    fn new() -> Self {
-        Self {
-            locks: Mutex::new(HashMap::new()),
-        }
-    }
-
-    // Try to acquire lock. Returns:
-    // Ok(true)  -> Granted
-    // Ok(false) -> Blocked (must wait)
-    // Err(_)    -> Error
-    fn try_acquire(&self, path: &str, pid: u32, op: i32) -> Result<bool, String> {
-        let mut locks = self.locks.lock().unwrap();
-        let state = locks.entry(path.to_string()).or_insert_with(|| LockState {
-            exclusive: None,
-            shared: HashSet::new(),
-            notify: Arc::new(tokio::sync::Notify::new()),
-        });
-
-        let is_ex = (op & libc::LOCK_EX) != 0;
-        let is_sh = (op & libc::LOCK_SH) != 0;
-
-        if is_ex {
-            // Exclusive lock requires: no exclusive owner AND no shared owners (except self)
-            if state.exclusive.is_some() && state.exclusive != Some(pid) {
-                return Ok(false);
-            }
-            if !state.shared.is_empty() && (state.shared.len() > 1 || !state.shared.contains(&pid))
-            {
-                return Ok(false);
-            }
-            // Grant exclusive
-            state.exclusive = Some(pid);
-            state.shared.remove(&pid); // Upgrade clears shared
-            Ok(true)
-        } else if is_sh {
-            // Shared lock requires: no exclusive owner (except self)
-            if state.exclusive.is_some() && state.exclusive != Some(pid) {
-                return Ok(false);
-            }
-            // Grant shared
-            if state.exclusive == Some(pid) {
-                state.exclusive = None; // Downgrade
-            }
-            state.shared.insert(pid);
-            Ok(true)
-        } else {
-            Err("Invalid lock operation".to_string())
-        }
-    }
-
-    fn release(&self, path: &str, pid: u32) {
-        let mut locks = self.locks.lock().unwrap();
-        if let Some(state) = locks.get_mut(path) {
-            if state.exclusive == Some(pid) {
-                state.exclusive = None;
-            }
-            state.shared.remove(&pid);
-            // If resource is free, notify waiters
-            if state.exclusive.is_none() && state.shared.is_empty() {
-                state.notify.notify_waiters();
-            } else if state.exclusive.is_none() {
-                // If only shared locks remain, notify waiters (allowing other shared locks)
-                state.notify.notify_waiters();
-            }
-        }
-    }
-
-    fn get_notify(&self, path: &str) -> Arc<tokio::sync::Notify> {
-        let mut locks = self.locks.lock().unwrap();
-        let state = locks.entry(path.to_string()).or_insert_with(|| LockState {
-            exclusive: None,
-            shared: HashSet::new(),
-            notify: Arc::new(tokio::sync::Notify::new()),
-        });
-        state.notify.clone()
-    }
-}
-
 /// Phase 1.1: Tracks a spawned vDird subprocess for a project
 struct VDirdProcess {
     project_root: PathBuf,
@@ -272,13 +179,14 @@ struct VDirdProcess {
 
 struct DaemonState {
     // In-memory index of CAS blobs (Hash -> Size) - Shared across all workspaces for global dedup
-    cas_index: Mutex<HashMap<[u8; 32], u64>>,
-    // Per-project vDird subprocess tracking
-    vdird_processes: Mutex<HashMap<PathBuf, Arc<VDirdProcess>>>,
+    cas_index: shard::CasIndex,
+    // Per-project vDird subprocess tracking (read on every registration,
+    // written only on spawn and reap)
+    vdird_processes: RwLock<HashMap<PathBuf, Arc<VDirdProcess>>>,
     // Content-Addressable Storage store
     cas: vrift_cas::CasStore,
     // Lock Manager for flock virtualization
-    lock_manager: LockManager,
+    lock_manager: shard::LockManager,
     // Daemon start time (for uptime reporting)
     start_time: std::time::Instant,
 }
@@ -314,10 +222,10 @@ async fn start_daemon() -> Result<()> {
     let cas = vrift_cas::CasStore::new(&cas_root)?;
 
     let state = Arc::new(DaemonState {
-        cas_index: Mutex::new(HashMap::new()),
-        vdird_processes: Mutex::new(HashMap::new()),
+        cas_index: shard::CasIndex::new(),
+        vdird_processes: RwLock::new(HashMap::new()),
         cas: cas.clone(),
-        lock_manager: LockManager::new(),
+        lock_manager: shard::LockManager::new(),
         start_time: std::time::Instant::now(),
     });
 
@@ -329,7 +237,7 @@ async fn start_daemon() -> Result<()> {
         if let Err(e) = scan_cas_root(&scan_state, &cas_root_capture).await {
             tracing::error!("vriftd: CAS scan failed: {}", e);
         } else {
-            let _count = scan_state.cas_index.lock().unwrap().len();
+            let _count = scan_state.cas_index.len();
             tracing::info!("vriftd: CAS warm-up complete. Indexed {} blobs.", _count);
         }
     });
@@ -358,7 +266,7 @@ async fn start_daemon() -> Result<()> {
                 interval.tick().await;
                 let mut stale_keys = Vec::new();
                 {
-                    let processes = health_state.vdird_processes.lock().unwrap();
+                    let processes = health_state.vdird_processes.read().unwrap();
                     for (key, vdird) in processes.iter() {
                         let pid = vdird.child_pid as libc::pid_t;
                         let mut status: libc::c_int = 0;
@@ -378,7 +286,7 @@ async fn start_daemon() -> Result<()> {
                     }
                 }
                 if !stale_keys.is_empty() {
-                    let mut processes = health_state.vdird_processes.lock().unwrap();
+                    let mut processes = health_state.vdird_processes.write().unwrap();
                     for key in &stale_keys {
                         if let Some(vdird) = processes.remove(key) {
                             let _ = std::fs::remove_file(&vdird.socket_path);
@@ -422,7 +330,7 @@ async fn start_daemon() -> Result<()> {
 
 async fn cleanup_vdird_processes(state: &DaemonState) {
     let processes = {
-        let mut processes = state.vdird_processes.lock().unwrap();
+        let mut processes = state.vdird_processes.write().unwrap();
         std::mem::take(&mut *processes)
     };
 
@@ -527,8 +435,9 @@ async fn handle_request(
             compatible: vrift_ipc::is_version_compatible(protocol_version),
         },
         VeloRequest::Status => {
-            let blob_count = state.cas_index.lock().unwrap().len();
-            let vdird_count = state.vdird_processes.lock().unwrap().len();
+            let blob_count = state.cas_index.len();
+            let vdird_count = state.vdird_processes.read().unwrap().len();
+            let locks = state.lock_manager.get_stats();
             let uptime = state.start_time.elapsed();
             let uptime_str = if uptime.as_secs() >= 3600 {
                 format!(
@@ -543,11 +452,58 @@ async fn handle_request(
             };
             VeloResponse::StatusAck {
                 status: format!(
-                    "Multi-tenant Operational (Global Blobs: {}, vDird Processes: {}, Uptime: {})",
-                    blob_count, vdird_count, uptime_str
+                    "Multi-tenant Operational (Global Blobs: {}, vDird Processes: {}, Uptime: {}, \
+                     Locks Held: {}, Lock Waits: {}, Contention: index={} locks={})",
+                    blob_count,
+                    vdird_count,
+                    uptime_str,
+                    locks.held,
+                    locks.waits,
+                    state.cas_index.contended(),
+                    locks.contended
                 ),
             }
         }
+        VeloRequest::Metrics => {
+            let locks = state.lock_manager.get_stats();
+            let mut out = vrift_ipc::metrics::PromText::new();
+            out.gauge(
+                "vriftd_cas_blobs",
+                "Blobs in the global CAS index",
+                state.cas_index.len() as f64,
+            );
+            out.gauge(
+                "vriftd_vdird_processes",
+                "Running per-project vDird processes",
+                state.vdird_processes.read().unwrap().len() as f64,
+            );
+            out.gauge(
+                "vriftd_uptime_seconds",
+                "Seconds since the daemon started",
+                state.start_time.elapsed().as_secs_f64(),
+            );
+            out.gauge(
+                "vriftd_locks_held",
+                "flock locks currently held",
+                locks.held as f64,
+            );
+            out.counter(
+                "vriftd_lock_waits_total",
+                "Blocking flock requests that had to wait for a release",
+                locks.waits,
+            );
+            out.counter(
+                "vriftd_cas_index_contended_total",
+                "CAS index shard acquisitions that had to wait",
+                state.cas_index.contended(),
+            );
+            out.counter(
+                "vriftd_lock_contended_total",
+                "Lock manager shard acquisitions that had to wait",
+                locks.contended,
+            );
+            VeloResponse::MetricsAck { text: out.finish() }
+        }
         VeloRequest::RegisterWorkspace {
             project_root: root_str,
         } => {
@@ -601,13 +557,11 @@ async fn handle_request(
             handle_spawn(command, env, cwd).await
         }
         VeloRequest::CasInsert { hash, size } => {
-            let mut index = state.cas_index.lock().unwrap();
-            index.insert(hash, size);
+            state.cas_index.insert(hash, size);
             VeloResponse::CasAck
         }
         VeloRequest::CasGet { hash } => {
-            let index = state.cas_index.lock().unwrap();
-            if let Some(&size) = index.get(&hash) {
+            if let Some(size) = state.cas_index.get(&hash) {
                 VeloResponse::CasFound { size }
             } else {
                 VeloResponse::CasNotFound
@@ -642,6 +596,16 @@ async fn handle_request(
                 "Manifest operations must be routed to vDird. Use the vdird_socket from RegisterAck.",
             ))
         }
+        VeloRequest::ManifestGetMany { paths } => {
+            tracing::warn!(
+                "vriftd: ManifestGetMany ({} paths) received — route to vDird instead",
+                paths.len()
+            );
+            VeloResponse::Error(VeloError::new(
+                VeloErrorKind::WorkspaceNotRegistered,
+                "Manifest operations must be routed to vDird. Use the vdird_socket from RegisterAck.",
+            ))
+        }
         VeloRequest::ManifestUpsert { path, .. } => {
             tracing::warn!(
                 "vriftd: ManifestUpsert '{}' received — route to vDird instead",
@@ -704,28 +668,13 @@ async fn handle_request(
                 }
             };
 
-            // Loop until acquired or error
-            loop {
-                match state.lock_manager.try_acquire(&path, pid, operation) {
-                    Ok(true) => return VeloResponse::FlockAck,
-                    Ok(false) => {
-                        // Blocked
-                        if operation & libc::LOCK_NB != 0 {
-                            // Non-blocking request
-                            return VeloResponse::Error(VeloError::new(
-                                VeloErrorKind::LockFailed,
-                                "EWOULDBLOCK",
-                            ));
-                        }
-                        // Blocking request: wait for notification
-                        let notify = state.lock_manager.get_notify(&path);
-                        notify.notified().await;
-                        // Retry loop after notification
-                    }
-                    Err(e) => {
-                        return VeloResponse::Error(VeloError::new(VeloErrorKind::LockFailed, e))
-                    }
+            // Waits (without blocking the runtime) until granted, unless LOCK_NB
+            match state.lock_manager.acquire(&path, pid, operation).await {
+                Ok(true) => VeloResponse::FlockAck,
+                Ok(false) => {
+                    VeloResponse::Error(VeloError::new(VeloErrorKind::LockFailed, "EWOULDBLOCK"))
                 }
+                Err(e) => VeloResponse::Error(VeloError::new(VeloErrorKind::LockFailed, e)),
             }
         }
         VeloRequest::FlockRelease { path } => {
@@ -741,27 +690,41 @@ async fn handle_request(
             VeloResponse::FlockAck
         }
         VeloRequest::CasSweep { bloom_filter } => {
-            match state.cas.sweep(&bloom_filter) {
-                Ok((deleted_count, reclaimed_bytes)) => {
-                    // Update global index
-                    let mut index = state.cas_index.lock().unwrap();
-                    index.clear();
-                    if let Ok(iter) = state.cas.iter() {
-                        for hash in iter.flatten() {
-                            if let Some(path) = state.cas.blob_path_for_hash(&hash) {
-                                if let Ok(meta) = std::fs::metadata(path) {
-                                    index.insert(hash, meta.len());
-                                }
-                            }
-                        }
-                    }
-                    VeloResponse::CasSweepAck {
-                        deleted_count,
-                        reclaimed_bytes,
-                    }
-                }
-                Err(e) => VeloResponse::Error(VeloError::internal(format!("Sweep failed: {}", e))),
-            }
+            sweep_cas(state, move |cas, on_shard| {
+                let bloom = vrift_cas::BloomFilter { bits: bloom_filter };
+                let options = vrift_cas::SweepOptions {
+                    min_age: std::time::Duration::ZERO,
+                    ..Default::default()
+                };
+                cas.sweep_with(
+                    &|hash| bloom.contains(&vrift_cas::CasStore::hash_to_hex(hash)),
+                    std::time::SystemTime::now(),
+                    &options,
+                    on_shard,
+                )
+            })
+            .await
+        }
+        VeloRequest::CasSweepLive {
+            live_set_path,
+            min_age_secs,
+            io_ops_per_sec,
+        } => {
+            sweep_cas(state, move |cas, on_shard| {
+                let live = vrift_cas::LiveSet::open(&live_set_path)?;
+                tracing::info!(
+                    "vriftd: GC sweep against {} live blobs ({})",
+                    live.len(),
+                    live_set_path
+                );
+                let options = vrift_cas::SweepOptions {
+                    min_age: std::time::Duration::from_secs(min_age_secs),
+                    io_ops_per_sec: (io_ops_per_sec > 0).then_some(io_ops_per_sec),
+                    ..Default::default()
+                };
+                cas.sweep_live(&live, &options, on_shard)
+            })
+            .await
         }
         VeloRequest::ManifestListDir { path } => {
             tracing::warn!(
@@ -773,6 +736,12 @@ async fn handle_request(
                 "Manifest operations must be routed to vDird. Use the vdird_socket from RegisterAck.",
             ))
         }
+        VeloRequest::AccessTrace { .. } | VeloRequest::PrefetchHint { .. } => {
+            VeloResponse::Error(VeloError::new(
+                VeloErrorKind::WorkspaceNotRegistered,
+                "Prefetch requests must be routed to vDird. Use the vdird_socket from RegisterAck.",
+            ))
+        }
         // IngestFullScan: Unified ingest architecture
         // CLI becomes thin client, daemon handles all ingest logic
         VeloRequest::IngestFullScan {
@@ -866,40 +835,16 @@ async fn handle_request(
             let cas_clone = cas_root_path.clone();
             let results = match tokio::task::spawn_blocking(move || {
                 if let Some(manifest_arc) = existing_manifest {
-                    // P0: Pre-load manifest into HashMap for O(1) cache lookups
-                    // (avoids per-file LMDB get() with transaction overhead)
-                    tracing::info!("spawn_blocking: pre-loading manifest into HashMap");
-                    let cache_map: std::collections::HashMap<String, CacheHint> = {
-                        match manifest_arc.iter() {
-                            Ok(entries) => entries
-                                .into_iter()
-                                .map(|(key, entry)| {
-                                    (
-                                        key,
-                                        CacheHint {
-                                            content_hash: entry.vnode.content_hash,
-                                            size: entry.vnode.size,
-                                            mtime: entry.vnode.mtime,
-                                        },
-                                    )
-                                })
-                                .collect(),
-                            Err(e) => {
-                                tracing::warn!(
-                                    "Failed to pre-load manifest: {}, falling back to empty cache",
-                                    e
-                                );
-                                std::collections::HashMap::new()
-                            }
-                        }
+                    // P0: mtime+size cache hits are looked up in LMDB per file
+                    // (mmap'd B-tree, no copy of the manifest held in memory)
+                    let cache_lookup = move |key: &str| -> Option<CacheHint> {
+                        let entry = manifest_arc.get(key).ok()??;
+                        Some(CacheHint {
+                            content_hash: entry.vnode.content_hash,
+                            size: entry.vnode.size,
+                            mtime: entry.vnode.mtime,
+                        })
                     };
-                    tracing::info!(
-                        "spawn_blocking: loaded {} entries into cache HashMap",
-                        cache_map.len()
-                    );
-                    let cache_map = std::sync::Arc::new(cache_map);
-                    let cache_lookup =
-                        move |key: &str| -> Option<CacheHint> { cache_map.get(key).cloned() };
                     let r = streaming_ingest_cached(
                         &source_clone,
                         &cas_clone,
@@ -1071,7 +1016,7 @@ fn write_ingest_manifest(
         let mtime = result.mtime;
         let mode = result.mode;
 
-        // #1: Use strip_prefix directly — jwalk yields absolute paths,
+        // #1: Use strip_prefix directly — the tree walker yields root-joined paths,
         // no need for per-file canonicalize() syscall
         let relative_path = result
             .source_path
@@ -1202,6 +1147,53 @@ async fn handle_spawn(
     }
 }
 
+type SweepShardFn<'a> = dyn Fn(&vrift_cas::SweepProgress, &[[u8; 32]]) + Sync + 'a;
+
+/// Run a CAS sweep on the blocking pool, then drop the deleted blobs from
+/// the index. Ingest (CasInsert/CasGet) is never locked out by the sweep.
+async fn sweep_cas<F>(state: &DaemonState, sweep: F) -> VeloResponse
+where
+    F: FnOnce(
+            &vrift_cas::CasStore,
+            &SweepShardFn<'_>,
+        ) -> vrift_cas::Result<vrift_cas::SweepProgress>
+        + Send
+        + 'static,
+{
+    let cas = state.cas.clone();
+    let result = tokio::task::spawn_blocking(move || {
+        let deleted = Mutex::new(Vec::new());
+        let progress = sweep(&cas, &|progress, hashes| {
+            deleted.lock().unwrap().extend_from_slice(hashes);
+            if progress.shards_done % 32 == 0 || progress.shards_done == progress.shards_total {
+                tracing::info!(
+                    "vriftd: GC {}/{} shards, {} scanned, {} deleted",
+                    progress.shards_done,
+                    progress.shards_total,
+                    progress.scanned,
+                    progress.deleted
+                );
+            }
+        })?;
+        Ok::<_, vrift_cas::CasError>((progress, deleted.into_inner().unwrap()))
+    })
+    .await;
+
+    match result {
+        Ok(Ok((progress, deleted))) => {
+            for hash in &deleted {
+                state.cas_index.remove(hash);
+            }
+            VeloResponse::CasSweepAck {
+                deleted_count: progress.deleted as u32,
+                reclaimed_bytes: progress.reclaimed_bytes,
+            }
+        }
+        Ok(Err(e)) => VeloResponse::Error(VeloError::internal(format!("Sweep failed: {}", e))),
+        Err(e) => VeloResponse::Error(VeloError::internal(format!("Sweep task failed: {}", e))),
+    }
+}
+
 async fn scan_cas_root(state: &DaemonState, cas_root_path: &str) -> Result<()> {
     let cas_root = vrift_manifest::normalize_path(cas_root_path);
 
@@ -1221,18 +1213,12 @@ async fn scan_cas_root(state: &DaemonState, cas_root_path: &str) -> Result<()> {
     // Iterating millions of files might take time, so blocking the runtime is bad if not careful.
     // But this is a separate task.
 
-    let mut index = state.cas_index.lock().unwrap();
-
     // Using blocking iterator
     for hash in (cas.iter()?).flatten() {
-        // For size, we currently don't store it in the filename, so we might need to stat.
-        // Statting every file is expensive.
-        // For MVP, if we don't have size efficiently, we can put 0 or Stat content.
-        // Optimized Velo stores [hash_prefix]/[hash] and we can trust it exists.
-        if let Some(path) = cas.blob_path_for_hash(&hash) {
-            if let Ok(metadata) = std::fs::metadata(path) {
-                index.insert(hash, metadata.len());
-            }
+        // RFC-0039 names carry the size: no stat, and chunked blobs are not
+        // materialized just to be indexed
+        if let Some(size) = cas.blob_size(&hash) {
+            state.cas_index.insert(hash, size);
         }
     }
 
@@ -1247,7 +1233,7 @@ async fn spawn_or_get_vdird(
 ) -> Result<Arc<VDirdProcess>> {
     // Check if already running
     {
-        let processes = state.vdird_processes.lock().unwrap();
+        let processes = state.vdird_processes.read().unwrap();
         if let Some(vdird) = processes.get(&project_root) {
             // Verify socket still exists (basic health check)
             if vdird.socket_path.exists() {
@@ -1332,7 +1318,7 @@ async fn spawn_or_get_vdird(
         child_pid,
     });
 
-    let mut processes = state.vdird_processes.lock().unwrap();
+    let mut processes = state.vdird_processes.write().unwrap();
     processes.insert(project_root, vdird.clone());
 
     Ok(vdird)
@@ -0,0 +1,477 @@
+//! Sharded daemon state: the global CAS index and the flock table
+//!
+//! Both used to sit behind one std mutex each, so every CasInsert/CasGet and
+//! every flock from every connection serialized on the same lock (and the
+//! warm-up scan held the index lock for the whole CAS walk). Entries are now
+//! spread over independent shards: the CAS index by the first hash byte
+//! (BLAKE3 output is uniform), the flock table by a hash of the path.
+//! Shard locks are only held for a map operation, never across an await.
+//!
+//! Contention is counted: a shard lock that was not free on first try, and
+//! a flock request that had to wait for a release.
+
+use std::collections::hash_map::DefaultHasher;
+use std::collections::{HashMap, HashSet};
+use std::hash::{Hash, Hasher};
+use std::sync::atomic::{AtomicU64, Ordering};
+use std::sync::{Arc, Mutex, MutexGuard};
+
+const CAS_SHARDS: usize = 64;
+const LOCK_SHARDS: usize = 32;
+
+/// Take a shard lock, counting the times it was already held
+fn lock_shard<'a, T>(shard: &'a Mutex<T>, contended: &AtomicU64) -> MutexGuard<'a, T> {
+    match shard.try_lock() {
+        Ok(guard) => guard,
+        Err(_) => {
+            contended.fetch_add(1, Ordering::Relaxed);
+            shard.lock().unwrap()
+        }
+    }
+}
+
+/// Global blob index: hash -> size
+pub struct CasIndex {
+    shards: Vec<Mutex<HashMap<[u8; 32], u64>>>,
+    contended: AtomicU64,
+}
+
+impl CasIndex {
+    pub fn new() -> Self {
+        Self {
+            shards: (0..CAS_SHARDS)
+                .map(|_| Mutex::new(HashMap::new()))
+                .collect(),
+            contended: AtomicU64::new(0),
+        }
+    }
+
+    fn shard(&self, hash: &[u8; 32]) -> MutexGuard<'_, HashMap<[u8; 32], u64>> {
+        lock_shard(&self.shards[hash[0] as usize % CAS_SHARDS], &self.contended)
+    }
+
+    pub fn insert(&self, hash: [u8; 32], size: u64) {
+        self.shard(&hash).insert(hash, size);
+    }
+
+    pub fn get(&self, hash: &[u8; 32]) -> Option<u64> {
+        self.shard(hash).get(hash).copied()
+    }
+
+    pub fn remove(&self, hash: &[u8; 32]) {
+        self.shard(hash).remove(hash);
+    }
+
+    /// Blob count. Shards are read one at a time, so this is a snapshot
+    /// only while no ingest is running.
+    pub fn len(&self) -> usize {
+        self.shards.iter().map(|s| s.lock().unwrap().len()).sum()
+    }
+
+    /// Shard locks that were found held
+    pub fn contended(&self) -> u64 {
+        self.contended.load(Ordering::Relaxed)
+    }
+}
+
+struct LockState {
+    // Exclusive owner (PID)
+    exclusive: Option<u32>,
+    // Shared owners (Set of PIDs)
+    shared: HashSet<u32>,
+    // Waiters notification
+    notify: Arc<tokio::sync::Notify>,
+}
+
+impl LockState {
+    fn new() -> Self {
+        Self {
+            exclusive: None,
+            shared: HashSet::new(),
+            notify: Arc::new(tokio::sync::Notify::new()),
+        }
+    }
+
+    fn is_free(&self) -> bool {
+        self.exclusive.is_none() && self.shared.is_empty()
+    }
+
+    /// Grant `pid` an exclusive or shared lock if compatible
+    fn grant(&mut self, pid: u32, exclusive: bool) -> bool {
+        if self.exclusive.is_some() && self.exclusive != Some(pid) {
+            return false;
+        }
+        if exclusive {
+            // Exclusive also requires no shared owners (except self)
+            if !self.shared.is_empty() && (self.shared.len() > 1 || !self.shared.contains(&pid)) {
+                return false;
+            }
+            self.exclusive = Some(pid);
+            self.shared.remove(&pid); // Upgrade clears shared
+        } else {
+            if self.exclusive == Some(pid) {
+                self.exclusive = None; // Downgrade
+            }
+            self.shared.insert(pid);
+        }
+        true
+    }
+}
+
+/// Snapshot of `LockManager` counters
+#[derive(Debug, Clone, Copy, Default)]
+pub struct LockStats {
+    /// Paths currently locked
+    pub held: usize,
+    /// Blocking requests that had to wait for a release
+    pub waits: u64,
+    /// Shard locks that were found held
+    pub contended: u64,
+}
+
+/// RFC-0049: Daemon Lock Manager for fs-independent flock virtualization
+/// Maintains lock state for VFS paths to support parallel build coordination
+pub struct LockManager {
+    // Absolute Path -> Lock State, sharded by path hash
+    shards: Vec<Mutex<HashMap<String, LockState>>>,
+    waits: AtomicU64,
+    contended: AtomicU64,
+}
+
+impl LockManager {
+    pub fn new() -> Self {
+        Self {
+            shards: (0..LOCK_SHARDS)
+                .map(|_| Mutex::new(HashMap::new()))
+                .collect(),
+            waits: AtomicU64::new(0),
+            contended: AtomicU64::new(0),
+        }
+    }
+
+    fn shard(&self, path: &str) -> MutexGuard<'_, HashMap<String, LockState>> {
+        let mut hasher = DefaultHasher::new();
+        path.hash(&mut hasher);
+        lock_shard(
+            &self.shards[hasher.finish() as usize % LOCK_SHARDS],
+            &self.contended,
+        )
+    }
+
+    /// Acquire a flock-style lock. Returns:
+    /// Ok(true)  -> Granted
+    /// Ok(false) -> Would block and `LOCK_NB` was requested
+    /// Err(_)    -> Invalid operation
+    ///
+    /// A blocking request registers for the path's notification while still
+    /// holding the shard lock, so a release between the check and the wait
+    /// is never missed. As with flock(2), a blocking conversion to exclusive
+    /// drops the caller's shared lock before it waits; two shared owners
+    /// upgrading at once would otherwise wait on each other forever.
+    pub async fn acquire(&self, path: &str, pid: u32, op: i32) -> Result<bool, String> {
+        let exclusive = if (op & libc::LOCK_EX) != 0 {
+            true
+        } else if (op & libc::LOCK_SH) != 0 {
+            false
+        } else {
+            return Err("Invalid lock operation".to_string());
+        };
+
+        loop {
+            let notify;
+            let mut notified;
+            {
+                let mut shard = self.shard(path);
+                let state = shard.entry(path.to_string()).or_insert_with(LockState::new);
+                let downgrade = !exclusive && state.exclusive == Some(pid);
+                if state.grant(pid, exclusive) {
+                    if downgrade {
+                        // Shared waiters can join now
+                        state.notify.notify_waiters();
+                    }
+                    return Ok(true);
+                }
+                if (op & libc::LOCK_NB) != 0 {
+                    return Ok(false);
+                }
+                if exclusive && state.shared.remove(&pid) {
+                    state.notify.notify_waiters();
+                }
+                notify = Arc::clone(&state.notify);
+                notified = Box::pin(notify.notified());
+                notified.as_mut().enable();
+            }
+            self.waits.fetch_add(1, Ordering::Relaxed);
+            notified.await;
+        }
+    }
+
+    pub fn release(&self, path: &str, pid: u32) {
+        let mut shard = self.shard(path);
+        let Some(state) = shard.get_mut(path) else {
+            return;
+        };
+        if state.exclusive == Some(pid) {
+            state.exclusive = None;
+        }
+        state.shared.remove(&pid);
+        // With no exclusive owner left, waiters may now succeed (an
+        // exclusive one once the last shared owner is gone, shared ones
+        // right away)
+        if state.exclusive.is_none() {
+            state.notify.notify_waiters();
+        }
+        // Waiters hold the notify themselves; a free entry is recreated on
+        // the next acquire
+        if state.is_free() {
+            shard.remove(path);
+        }
+    }
+
+    pub fn get_stats(&self) -> LockStats {
+        LockStats {
+            held: self.shards.iter().map(|s| s.lock().unwrap().len()).sum(),
+            waits: self.waits.load(Ordering::Relaxed),
+            contended: self.contended.load(Ordering::Relaxed),
+        }
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+    use std::sync::atomic::AtomicBool;
+    use std::time::Duration;
+
+    const WAIT: Duration = Duration::from_secs(5);
+
+    /// Yield until `count` blocking requests have registered their wait
+    async fn until_waiting(locks: &LockManager, count: u64) {
+        while locks.get_stats().waits < count {
+            tokio::task::yield_now().await;
+        }
+    }
+
+    fn spawn_acquire(
+        locks: &Arc<LockManager>,
+        path: &'static str,
+        pid: u32,
+        op: i32,
+    ) -> tokio::task::JoinHandle<Result<bool, String>> {
+        let locks = Arc::clone(locks);
+        tokio::spawn(async move { locks.acquire(path, pid, op).await })
+    }
+
+    #[test]
+    fn test_cas_index_across_shards() {
+        let index = CasIndex::new();
+        for i in 0..=255u8 {
+            let mut hash = [i; 32];
+            index.insert(hash, i as u64);
+            hash[1] ^= 1; // Same shard, other key
+            index.insert(hash, 1000 + i as u64);
+        }
+        assert_eq!(index.len(), 512);
+        assert_eq!(index.get(&[7; 32]), Some(7));
+
+        index.insert([7; 32], 70);
+        assert_eq!(index.get(&[7; 32]), Some(70));
+        index.remove(&[7; 32]);
+        assert_eq!(index.get(&[7; 32]), None);
+        let mut neighbour = [7; 32];
+        neighbour[1] ^= 1;
+        assert_eq!(index.get(&neighbour), Some(1007));
+        assert_eq!(index.len(), 511);
+    }
+
+    #[tokio::test]
+    async fn test_lock_nb_and_invalid_operations() {
+        let locks = LockManager::new();
+        assert_eq!(locks.acquire("/a", 1, libc::LOCK_EX).await, Ok(true));
+        assert_eq!(
+            locks.acquire("/a", 2, libc::LOCK_EX | libc::LOCK_NB).await,
+            Ok(false)
+        );
+        assert_eq!(
+            locks.acquire("/a", 2, libc::LOCK_SH | libc::LOCK_NB).await,
+            Ok(false)
+        );
+        // Re-locking what we hold, and other paths, never conflict
+        assert_eq!(
+            locks.acquire("/a", 1, libc::LOCK_EX | libc::LOCK_NB).await,
+            Ok(true)
+        );
+        assert_eq!(
+            locks.acquire("/b", 2, libc::LOCK_EX | libc::LOCK_NB).await,
+            Ok(true)
+        );
+        assert!(locks.acquire("/a", 2, libc::LOCK_NB).await.is_err());
+        assert!(locks.acquire("/a", 2, libc::LOCK_UN).await.is_err());
+
+        locks.release("/a", 1);
+        assert_eq!(locks.acquire("/a", 1, libc::LOCK_SH).await, Ok(true));
+        assert_eq!(
+            locks.acquire("/a", 2, libc::LOCK_SH | libc::LOCK_NB).await,
+            Ok(true)
+        );
+        assert_eq!(
+            locks.acquire("/a", 3, libc::LOCK_EX | libc::LOCK_NB).await,
+            Ok(false)
+        );
+        // A failed non-blocking upgrade keeps the shared lock
+        assert_eq!(
+            locks.acquire("/a", 1, libc::LOCK_EX | libc::LOCK_NB).await,
+            Ok(false)
+        );
+        locks.release("/a", 2);
+        assert_eq!(
+            locks.acquire("/a", 3, libc::LOCK_EX | libc::LOCK_NB).await,
+            Ok(false)
+        );
+        assert_eq!(
+            locks.acquire("/a", 1, libc::LOCK_EX | libc::LOCK_NB).await,
+            Ok(true)
+        );
+        assert_eq!(locks.get_stats().waits, 0);
+    }
+
+    #[tokio::test]
+    async fn test_release_wakes_blocked_waiter() {
+        let locks = Arc::new(LockManager::new());
+        locks.acquire("/a", 1, libc::LOCK_EX).await.unwrap();
+        let waiter = spawn_acquire(&locks, "/a", 2, libc::LOCK_EX);
+        until_waiting(&locks, 1).await;
+
+        locks.release("/a", 1);
+        let granted = tokio::time::timeout(WAIT, waiter).await;
+        assert_eq!(granted.expect("waiter was not woken").unwrap(), Ok(true));
+        assert_eq!(
+            locks.acquire("/a", 1, libc::LOCK_EX | libc::LOCK_NB).await,
+            Ok(false)
+        );
+    }
+
+    #[tokio::test(flavor = "multi_thread", worker_threads = 4)]
+    async fn test_contended_lock_never_loses_wakeups() {
+        let locks = Arc::new(LockManager::new());
+        let inside = Arc::new(AtomicBool::new(false));
+        let tasks: Vec<_> = (0..16u32)
+            .map(|pid| {
+                let locks = Arc::clone(&locks);
+                let inside = Arc::clone(&inside);
+                tokio::spawn(async move {
+                    for _ in 0..200 {
+                        locks.acquire("/a", pid, libc::LOCK_EX).await.unwrap();
+                        assert!(!inside.swap(true, Ordering::SeqCst), "two owners");
+                        tokio::task::yield_now().await;
+                        inside.store(false, Ordering::SeqCst);
+                        locks.release("/a", pid);
+                    }
+                })
+            })
+            .collect();
+        for task in tasks {
+            tokio::time::timeout(WAIT, task)
+                .await
+                .expect("a waiter was never woken")
+                .unwrap();
+        }
+        assert_eq!(locks.get_stats().held, 0);
+    }
+
+    #[tokio::test]
+    async fn test_upgrade_waits_for_other_shared_owners() {
+        let locks = Arc::new(LockManager::new());
+        locks.acquire("/a", 1, libc::LOCK_SH).await.unwrap();
+        locks.acquire("/a", 2, libc::LOCK_SH).await.unwrap();
+        let upgrade = spawn_acquire(&locks, "/a", 1, libc::LOCK_EX);
+        until_waiting(&locks, 1).await;
+        assert!(!upgrade.is_finished());
+
+        locks.release("/a", 2);
+        let granted = tokio::time::timeout(WAIT, upgrade).await;
+        assert_eq!(granted.expect("upgrade was not woken").unwrap(), Ok(true));
+        assert_eq!(
+            locks.acquire("/a", 2, libc::LOCK_SH | libc::LOCK_NB).await,
+            Ok(false)
+        );
+    }
+
+    #[tokio::test]
+    async fn test_concurrent_upgrades_do_not_deadlock() {
+        let locks = Arc::new(LockManager::new());
+        locks.acquire("/a", 1, libc::LOCK_SH).await.unwrap();
+        locks.acquire("/a", 2, libc::LOCK_SH).await.unwrap();
+        let first = spawn_acquire(&locks, "/a", 1, libc::LOCK_EX);
+        let second = spawn_acquire(&locks, "/a", 2, libc::LOCK_EX);
+
+        // Each upgrade drops its shared lock before waiting, so one wins
+        let first_won = tokio::time::timeout(WAIT, async {
+            loop {
+                if first.is_finished() {
+                    break true;
+                }
+                if second.is_finished() {
+                    break false;
+                }
+                tokio::task::yield_now().await;
+            }
+        })
+        .await
+        .expect("upgrades deadlocked");
+        let (won, winner, pending) = if first_won {
+            (first, 1, second)
+        } else {
+            (second, 2, first)
+        };
+        assert_eq!(won.await.unwrap(), Ok(true));
+
+        locks.release("/a", winner);
+        let granted = tokio::time::timeout(WAIT, pending).await;
+        assert_eq!(
+            granted.expect("other upgrade was not woken").unwrap(),
+            Ok(true)
+        );
+    }
+
+    #[tokio::test]
+    async fn test_downgrade_wakes_shared_waiters() {
+        let locks = Arc::new(LockManager::new());
+        locks.acquire("/a", 1, libc::LOCK_EX).await.unwrap();
+        let reader = spawn_acquire(&locks, "/a", 2, libc::LOCK_SH);
+        until_waiting(&locks, 1).await;
+
+        assert_eq!(locks.acquire("/a", 1, libc::LOCK_SH).await, Ok(true));
+        let granted = tokio::time::timeout(WAIT, reader).await;
+        assert_eq!(granted.expect("reader was not woken").unwrap(), Ok(true));
+    }
+
+    #[tokio::test]
+    async fn test_released_entry_is_recreated_for_waiters() {
+        let locks = Arc::new(LockManager::new());
+        locks.acquire("/a", 1, libc::LOCK_EX).await.unwrap();
+        let waiter = spawn_acquire(&locks, "/a", 2, libc::LOCK_EX);
+        until_waiting(&locks, 1).await;
+
+        // Free entries are dropped; the woken waiter has not run yet (single
+        // threaded runtime), so a newcomer gets a fresh entry first
+        locks.release("/a", 1);
+        assert_eq!(locks.get_stats().held, 0);
+        assert_eq!(
+            locks.acquire("/a", 3, libc::LOCK_EX | libc::LOCK_NB).await,
+            Ok(true)
+        );
+        until_waiting(&locks, 2).await;
+        assert!(!waiter.is_finished());
+
+        // The waiter re-registered on the fresh entry's notification
+        locks.release("/a", 3);
+        let granted = tokio::time::timeout(WAIT, waiter).await;
+        assert_eq!(
+            granted.expect("waiter lost with its entry").unwrap(),
+            Ok(true)
+        );
+        locks.release("/a", 2);
+        assert_eq!(locks.get_stats().held, 0);
+    }
+}
@@ -4,44 +4,151 @@
 //!
 //! Maps the Velo Manifest and CAS to a FUSE filesystem.
 //! - Inodes are assigned sequentially based on manifest entries.
-//! - Read operations fetch from CAS.
-//! - Metadata comes from Manifest.
+//! - Reads are served from a CAS mapping held per open file handle (shared
+//!   by handles of the same file) on a pool of worker threads.
+//! - Metadata comes from Manifest; the mount is an immutable snapshot, so
+//!   entries and attributes are cached by the kernel with long TTLs.
 
 #[cfg(all(feature = "fuse", target_os = "linux"))]
 mod imp {
     use std::collections::HashMap;
     use std::ffi::OsStr;
     use std::path::Path;
+    use std::sync::mpsc::{self, Receiver, Sender};
+    use std::sync::{Arc, Mutex, Weak};
     use std::time::{Duration, UNIX_EPOCH};
 
     use fuser::{
-        FileAttr, FileType, Filesystem, ReplyAttr, ReplyData, ReplyDirectory, ReplyEntry, Request,
+        FileAttr, FileType, Filesystem, KernelConfig, ReplyAttr, ReplyData, ReplyDirectory,
+        ReplyDirectoryPlus, ReplyEmpty, ReplyEntry, ReplyOpen, Request,
     };
     use libc::{c_int, ENOENT};
-    use vrift_cas::CasStore;
+    use vrift_cas::{CasStore, ChunkedBlob};
     use vrift_manifest::{Manifest, VnodeEntry};
 
-    const TTL: Duration = Duration::from_secs(60);
+    /// The mount is a read-only snapshot of one manifest: nothing it serves
+    /// ever changes, so the kernel may cache entries and attributes for long.
+    const TTL: Duration = Duration::from_secs(24 * 3600);
     const BLOCK_SIZE: u64 = 4096;
 
     struct InodeEntry {
-        path_hash: vrift_manifest::PathHash,
+        content_hash: vrift_cas::Blake3Hash,
         attr: FileAttr,
         children: Vec<(String, u64)>, // Name -> Inode
     }
 
+    /// Blob contents behind an open file handle
+    enum Blob {
+        Empty,
+        Flat(memmap2::Mmap),
+        Chunked(ChunkedBlob),
+    }
+
+    impl Blob {
+        fn load(cas: &CasStore, hash: &vrift_cas::Blake3Hash, size: u64) -> Option<Self> {
+            if size == 0 {
+                return Some(Self::Empty);
+            }
+            // Chunked blobs are read chunk by chunk instead of reassembled
+            match cas.get_chunked(hash) {
+                Ok(Some(chunked)) => Some(Self::Chunked(chunked)),
+                Ok(None) => cas.get_mmap(hash).ok().map(Self::Flat),
+                Err(_) => None,
+            }
+        }
+
+        /// Reply with `size` bytes at `offset`
+        fn reply(&self, offset: u64, size: u32, reply: ReplyData) {
+            match self {
+                Self::Empty => reply.data(&[]),
+                Self::Flat(map) => {
+                    let start = (offset as usize).min(map.len());
+                    let end = start.saturating_add(size as usize).min(map.len());
+                    reply.data(&map[start..end]);
+                }
+                Self::Chunked(blob) => {
+                    let len = (size as u64).min(blob.len().saturating_sub(offset)) as usize;
+                    let mut buf = vec![0u8; len];
+                    let n = blob.read_at(offset, &mut buf);
+                    reply.data(&buf[..n]);
+                }
+            }
+        }
+    }
+
+    struct ReadJob {
+        blob: Arc<Blob>,
+        offset: u64,
+        size: u32,
+        reply: ReplyData,
+    }
+
+    /// Worker threads serving reads. The fuser session dispatches requests
+    /// from one thread; copying a range out of the mapping (and faulting its
+    /// pages in) happens here, so cold reads of different files overlap.
+    struct ReadPool {
+        tx: Sender<ReadJob>,
+    }
+
+    impl ReadPool {
+        fn new(threads: usize) -> Self {
+            let (tx, rx) = mpsc::channel::<ReadJob>();
+            let rx = Arc::new(Mutex::new(rx));
+            for i in 0..threads {
+                let rx = Arc::clone(&rx);
+                std::thread::Builder::new()
+                    .name(format!("vrift-fuse-read-{}", i))
+                    .spawn(move || Self::worker(&rx))
+                    .expect("spawn FUSE read worker");
+            }
+            Self { tx }
+        }
+
+        fn worker(rx: &Mutex<Receiver<ReadJob>>) {
+            loop {
+                let job = match rx.lock().unwrap().recv() {
+                    Ok(job) => job,
+                    Err(_) => return, // Filesystem dropped
+                };
+                job.blob.reply(job.offset, job.size, job.reply);
+            }
+        }
+
+        fn submit(&self, job: ReadJob) {
+            if let Err(mpsc::SendError(job)) = self.tx.send(job) {
+                job.blob.reply(job.offset, job.size, job.reply);
+            }
+        }
+    }
+
     pub struct VeloFs {
         cas: CasStore,
         inodes: HashMap<u64, InodeEntry>,
         path_to_inode: HashMap<String, u64>,
+        /// (parent inode, name) -> inode
+        lookup_index: HashMap<(u64, String), u64>,
+        /// Open file handles
+        handles: HashMap<u64, Arc<Blob>>,
+        next_fh: u64,
+        /// Mapping per inode while any handle has it open, shared by handles
+        open_blobs: HashMap<u64, Weak<Blob>>,
+        reads: ReadPool,
     }
 
     impl VeloFs {
         pub fn new(manifest: &Manifest, cas: CasStore) -> Self {
+            let threads = std::thread::available_parallelism()
+                .map(|n| n.get())
+                .unwrap_or(4);
             let mut fs = Self {
                 cas,
                 inodes: HashMap::new(),
                 path_to_inode: HashMap::new(),
+                lookup_index: HashMap::new(),
+                handles: HashMap::new(),
+                next_fh: 1,
+                open_blobs: HashMap::new(),
+                reads: ReadPool::new(threads),
             };
             fs.init_from_manifest(manifest);
             fs
@@ -49,9 +156,9 @@ mod imp {
 
         /// Mount the filesystem at the given path (Ref: <https://docs.rs/fuser>)
         pub fn mount(self, mountpoint: &Path) -> anyhow::Result<()> {
-            // Performance Optimization: TTL=60s (Implies metadata caching).
-            // auto_cache / kernel_cache causing issues with current fuser/libfuse version in CI.
-            // TTL=60s provides significant getattr reduction.
+            // Page cache is kept per open (FOPEN_KEEP_CACHE) rather than via
+            // the auto_cache / kernel_cache mount options, which caused issues
+            // with the current fuser/libfuse version in CI.
 
             let opts = vec![
                 fuser::MountOption::RO,
@@ -70,7 +177,7 @@ mod imp {
             self.inodes.insert(
                 1,
                 InodeEntry {
-                    path_hash: [0; 32], // Dummy
+                    content_hash: [0; 32], // Dummy
                     attr: Self::default_dir_attr(1),
                     children: Vec::new(),
                 },
@@ -97,7 +204,7 @@ mod imp {
                 self.inodes.insert(
                     inode,
                     InodeEntry {
-                        path_hash: entry.content_hash,
+                        content_hash: entry.content_hash,
                         attr,
                         children: Vec::new(),
                     },
@@ -115,9 +222,11 @@ mod imp {
                     // Or better: ensure we find the parent inode
                     if let Some(parent_inode) = self.path_to_inode.get(parent_str) {
                         let name = p.file_name().unwrap().to_str().unwrap().to_string();
-                        if let Some(parent_entry) = self.inodes.get_mut(parent_inode) {
-                            parent_entry.children.push((name, inode));
+                        let parent_inode = *parent_inode;
+                        if let Some(parent_entry) = self.inodes.get_mut(&parent_inode) {
+                            parent_entry.children.push((name.clone(), inode));
                         }
+                        self.lookup_index.insert((parent_inode, name), inode);
                     } else {
                         // Parent might be missing from manifest if explicit entries omitted?
                         // For MVP assume valid manifest.
@@ -171,9 +280,58 @@ mod imp {
                 blksize: BLOCK_SIZE as u32,
             }
         }
+
+        /// Directory entries of `ino` after readdir `offset`:
+        /// (inode, next offset, kind, name), "." and ".." first
+        fn dir_entries(&self, ino: u64, offset: i64) -> Vec<(u64, i64, FileType, &str)> {
+            let Some(entry) = self.inodes.get(&ino) else {
+                return Vec::new();
+            };
+            // Parent hardcoded to 1 for simplicity for now
+            let dots = [
+                (ino, FileType::Directory, "."),
+                (1, FileType::Directory, ".."),
+            ];
+            let children = entry.children.iter().map(|(name, child_ino)| {
+                let kind = self
+                    .inodes
+                    .get(child_ino)
+                    .map(|e| e.attr.kind)
+                    .unwrap_or(FileType::RegularFile);
+                (*child_ino, kind, name.as_str())
+            });
+            // Offset of an entry is its 1-based position
+            dots.into_iter()
+                .chain(children)
+                .enumerate()
+                .skip(offset.max(0) as usize)
+                .map(|(i, (ino, kind, name))| (ino, (i + 1) as i64, kind, name))
+                .collect()
+        }
+
+        /// Mapping for `ino`, shared with its other open handles
+        fn open_blob(&mut self, ino: u64) -> Option<Arc<Blob>> {
+            if let Some(blob) = self.open_blobs.get(&ino).and_then(Weak::upgrade) {
+                return Some(blob);
+            }
+            let entry = self.inodes.get(&ino)?;
+            let blob = Arc::new(Blob::load(&self.cas, &entry.content_hash, entry.attr.size)?);
+            self.open_blobs.insert(ino, Arc::downgrade(&blob));
+            Some(blob)
+        }
     }
 
     impl Filesystem for VeloFs {
+        fn init(&mut self, _req: &Request, config: &mut KernelConfig) -> Result<(), c_int> {
+            // Directory listings carry attributes, saving a LOOKUP per entry
+            let readdirplus =
+                fuser::consts::FUSE_DO_READDIRPLUS | fuser::consts::FUSE_READDIRPLUS_AUTO;
+            if let Err(unsupported) = config.add_capabilities(readdirplus) {
+                log::debug!("Kernel lacks readdirplus capabilities {:#x}", unsupported);
+            }
+            Ok(())
+        }
+
         fn lookup(&mut self, _req: &Request, parent: u64, name: &OsStr, reply: ReplyEntry) {
             let name_str = match name.to_str() {
                 Some(s) => s,
@@ -183,17 +341,14 @@ mod imp {
                 }
             };
 
-            if let Some(parent_entry) = self.inodes.get(&parent) {
-                for (child_name, child_inode) in &parent_entry.children {
-                    if child_name == name_str {
-                        if let Some(child_entry) = self.inodes.get(child_inode) {
-                            reply.entry(&TTL, &child_entry.attr, 0);
-                            return;
-                        }
-                    }
-                }
+            let child = self
+                .lookup_index
+                .get(&(parent, name_str.to_string()))
+                .and_then(|ino| self.inodes.get(ino));
+            match child {
+                Some(child_entry) => reply.entry(&TTL, &child_entry.attr, 0),
+                None => reply.error(ENOENT),
             }
-            reply.error(ENOENT);
         }
 
         fn getattr(&mut self, _req: &Request, ino: u64, reply: ReplyAttr) {
@@ -203,38 +358,75 @@ mod imp {
             }
         }
 
+        fn open(&mut self, _req: &Request, ino: u64, _flags: c_int, reply: ReplyOpen) {
+            if !self.inodes.contains_key(&ino) {
+                reply.error(ENOENT);
+                return;
+            }
+            let Some(blob) = self.open_blob(ino) else {
+                reply.error(libc::EIO);
+                return;
+            };
+            let fh = self.next_fh;
+            self.next_fh += 1;
+            self.handles.insert(fh, blob);
+            // Content is immutable: keep the page cache across opens
+            reply.opened(fh, fuser::consts::FOPEN_KEEP_CACHE);
+        }
+
+        fn release(
+            &mut self,
+            _req: &Request,
+            ino: u64,
+            fh: u64,
+            _flags: c_int,
+            _lock_owner: Option<u64>,
+            _flush: bool,
+            reply: ReplyEmpty,
+        ) {
+            self.handles.remove(&fh);
+            if self
+                .open_blobs
+                .get(&ino)
+                .is_some_and(|blob| blob.strong_count() == 0)
+            {
+                self.open_blobs.remove(&ino);
+            }
+            reply.ok();
+        }
+
         fn read(
             &mut self,
             _req: &Request,
             ino: u64,
-            _fh: u64,
+            fh: u64,
             offset: i64,
             size: u32,
             _flags: c_int,
             _lock_owner: Option<u64>,
             reply: ReplyData,
         ) {
-            let entry = match self.inodes.get(&ino) {
-                Some(e) => e,
-                None => {
-                    reply.error(ENOENT);
-                    return;
-                }
-            };
-
-            match self.cas.get(&entry.path_hash) {
-                Ok(data) => {
-                    let offset = offset as usize;
-                    let size = size as usize;
-                    if offset >= data.len() {
-                        reply.data(&[]);
-                    } else {
-                        let end = (offset + size).min(data.len());
-                        reply.data(&data[offset..end]);
+            let blob = match self.handles.get(&fh) {
+                Some(blob) => Arc::clone(blob),
+                // Not opened through us (shouldn't happen): map for this read
+                None => match self.open_blob(ino) {
+                    Some(blob) => blob,
+                    None => {
+                        reply.error(if self.inodes.contains_key(&ino) {
+                            libc::EIO
+                        } else {
+                            ENOENT
+                        });
+                        return;
                     }
-                }
-                Err(_) => reply.error(libc::EIO),
-            }
+                },
+            };
+            self.reads.submit(ReadJob {
+                blob,
+                offset: offset.max(0) as u64,
+                size,
+                reply,
+            });
         }
 
         fn readdir(
@@ -245,38 +437,35 @@ mod imp {
             offset: i64,
             mut reply: ReplyDirectory,
         ) {
-            let entry = match self.inodes.get(&ino) {
-                Some(e) => e,
-                None => {
-                    reply.error(ENOENT);
-                    return;
-                }
-            };
-
-            if offset == 0 {
-                if reply.add(ino, 0, FileType::Directory, ".") {
-                    return;
-                }
-                if reply.add(1, 1, FileType::Directory, "..") {
-                    // Parent hardcoded to 1 for simplicity for now
-                    return;
+            if !self.inodes.contains_key(&ino) {
+                reply.error(ENOENT);
+                return;
+            }
+            for (child_ino, next, kind, name) in self.dir_entries(ino, offset) {
+                if reply.add(child_ino, next, kind, name) {
+                    break;
                 }
             }
+            reply.ok();
+        }
 
-            // Children
-            // Skip 'offset' entries (simplified logic: FUSE readdir offset usually starts at 1/2/3...)
-            // Real implementations need robust offset handling.
-            // Here we just use index in child array + 2 (for . and ..)
-            let skip = if offset > 1 { (offset - 2) as usize } else { 0 };
-
-            for (i, (name, child_ino)) in entry.children.iter().enumerate().skip(skip) {
-                let child_type = self
-                    .inodes
-                    .get(child_ino)
-                    .map(|e| e.attr.kind)
-                    .unwrap_or(FileType::RegularFile);
-                // offset for next entry is i + 3 (1-based index + 2 for dots)
-                if reply.add(*child_ino, (i + 3) as i64, child_type, name) {
+        fn readdirplus(
+            &mut self,
+            _req: &Request,
+            ino: u64,
+            _fh: u64,
+            offset: i64,
+            mut reply: ReplyDirectoryPlus,
+        ) {
+            if !self.inodes.contains_key(&ino) {
+                reply.error(ENOENT);
+                return;
+            }
+            for (child_ino, next, _kind, name) in self.dir_entries(ino, offset) {
+                let Some(child) = self.inodes.get(&child_ino) else {
+                    continue;
+                };
+                if reply.add(child_ino, next, name, &TTL, &child.attr, 0) {
                     break;
                 }
             }
@@ -3,8 +3,18 @@
  *
  * Provides clean, fixed-argument entry points for Rust inception layers
  * to solve the Variadic ABI hazard on macOS ARM64.
+ *
+ * On Linux it also owns the exported open/openat/access/faccessat/
+ * readlinkat/statx/fstatat/close symbols: early-init, tripped-circuit and
+ * provably non-VFS calls go straight to the kernel without entering Rust.
  */
 
+#if defined(__linux__)
+/* These symbols are defined here; fortify's inline wrappers would clash */
+#undef _FORTIFY_SOURCE
+#define _GNU_SOURCE
+#endif
+
 #include <errno.h>
 #include <fcntl.h>
 #include <signal.h>
@@ -12,6 +22,7 @@
 #include <stdbool.h>
 #include <stddef.h>
 #include <stdint.h>
+#include <string.h>
 #include <sys/types.h>
 #include <unistd.h>
 
@@ -32,19 +43,23 @@ int get_inception_errno() { return errno; }
 #define SYS_FSTATAT64 466
 #elif defined(__linux__) && defined(__x86_64__)
 #define SYS_OPEN 2
-#define SYS_OPENAT 257
-#define SYS_STAT64 4
-#define SYS_LSTAT64 6
+#define SYS_CLOSE 3
 #define SYS_ACCESS 21
-#define SYS_READLINK 89
+#define SYS_OPENAT 257
+#define SYS_NEWFSTATAT 262
+#define SYS_READLINKAT 267
+#define SYS_FACCESSAT 269
+#define SYS_STATX 332
+#define SYS_FACCESSAT2 439
 #elif defined(__linux__) && defined(__aarch64__)
+/* No open/access: the generic table only has the *at forms */
+#define SYS_FACCESSAT 48
 #define SYS_OPENAT 56
-#define SYS_STATAT 79
-#define SYS_ACCESSAT 48
+#define SYS_CLOSE 57
 #define SYS_READLINKAT 78
-#define SYS_FSTAT 80
-#define SYS_FSTATAT 79
-#define AT_FDCWD -100
+#define SYS_NEWFSTATAT 79
+#define SYS_STATX 291
+#define SYS_FACCESSAT2 439
 #endif
 
 /* --- External Rust Implementation & Flags --- */
@@ -85,8 +100,8 @@ __attribute__((constructor(65535))) void inception_late_init_constructor() {
 /* --- Raw Syscall Implementation --- */
 
 #if defined(__aarch64__)
-static inline long raw_syscall(long number, long arg1, long arg2, long arg3,
-                               long arg4) {
+static inline long raw_syscall6(long number, long arg1, long arg2, long arg3,
+                                long arg4, long arg5, long arg6) {
 #if defined(__APPLE__)
   long err_flag;
   register long x16 __asm__("x16") = number;
@@ -94,10 +109,12 @@ static inline long raw_syscall(long number, long arg1, long arg2, long arg3,
   register long x1 __asm__("x1") = arg2;
   register long x2 __asm__("x2") = arg3;
   register long x3 __asm__("x3") = arg4;
+  register long x4 __asm__("x4") = arg5;
+  register long x5 __asm__("x5") = arg6;
   __asm__ volatile("svc #0x80\n"
                    "cset %1, cs\n"
                    : "+r"(x0), "=r"(err_flag)
-                   : "r"(x16), "r"(x1), "r"(x2), "r"(x3)
+                   : "r"(x16), "r"(x1), "r"(x2), "r"(x3), "r"(x4), "r"(x5)
                    : "memory");
   if (err_flag) {
     errno = (int)x0;
@@ -110,9 +127,11 @@ static inline long raw_syscall(long number, long arg1, long arg2, long arg3,
   register long x1 __asm__("x1") = arg2;
   register long x2 __asm__("x2") = arg3;
   register long x3 __asm__("x3") = arg4;
+  register long x4 __asm__("x4") = arg5;
+  register long x5 __asm__("x5") = arg6;
   __asm__ volatile("svc #0\n"
                    : "+r"(x0)
-                   : "r"(x8), "r"(x1), "r"(x2), "r"(x3)
+                   : "r"(x8), "r"(x1), "r"(x2), "r"(x3), "r"(x4), "r"(x5)
                    : "memory");
   if (x0 < 0 && x0 >= -4095) {
     errno = (int)-x0;
@@ -122,12 +141,17 @@ static inline long raw_syscall(long number, long arg1, long arg2, long arg3,
 #endif
 }
 #elif defined(__x86_64__)
-static inline long raw_syscall(long number, long arg1, long arg2, long arg3,
-                               long arg4) {
+static inline long raw_syscall6(long number, long arg1, long arg2, long arg3,
+                                long arg4, long arg5, long arg6) {
   long ret;
+  /* Arguments 4-6 travel in r10, r8, r9 (not the C ABI's rcx) */
+  register long r10 __asm__("r10") = arg4;
+  register long r8 __asm__("r8") = arg5;
+  register long r9 __asm__("r9") = arg6;
   __asm__ volatile("syscall"
                    : "=a"(ret)
-                   : "a"(number), "D"(arg1), "S"(arg2), "d"(arg3), "r"(arg4)
+                   : "a"(number), "D"(arg1), "S"(arg2), "d"(arg3), "r"(r10),
+                     "r"(r8), "r"(r9)
                    : "rcx", "r11", "memory");
   if (ret < 0 && ret >= -4095) {
     errno = (int)-ret;
@@ -137,6 +161,9 @@ static inline long raw_syscall(long number, long arg1, long arg2, long arg3,
 }
 #endif
 
+#define raw_syscall(number, arg1, arg2, arg3, arg4)                            \
+  raw_syscall6(number, arg1, arg2, arg3, arg4, 0, 0)
+
 /* --- Implementation Functions (called by Rust proxies or direct inception
  * layers) --- */
 
@@ -220,6 +247,233 @@ int c_fstatat_bridge(int dirfd, const char *path, void *buf, int flags) {
 }
 #endif
 
+/* --- Linux fast path (LD_PRELOAD exports) --- */
+
+#if defined(__linux__) && (defined(__x86_64__) || defined(__aarch64__))
+
+extern int open_inception_c_impl(const char *path, int flags, mode_t mode);
+extern int access_inception(const char *path, int mode);
+extern bool velo_faccessat_vfs(int dirfd, const char *path);
+extern long readlinkat_inception(int dirfd, const char *path, char *buf,
+                                 size_t bufsiz);
+extern int statx_inception(int dirfd, const char *path, int flags,
+                           unsigned int mask, void *buf);
+extern int fstatat_inception(int dirfd, const char *path, void *buf,
+                             int flags);
+extern int close_inception(int fd);
+
+/* Rust atomics (AtomicBool / AtomicUsize) */
+extern volatile unsigned char CIRCUIT_TRIPPED;
+extern size_t OPEN_FD_COUNT;
+
+/* VFS prefix, published by Rust once the inception state exists */
+static char VFS_PREFIX[256];
+static size_t VFS_PREFIX_LEN;
+
+void vrift_publish_vfs_prefix(const char *prefix, size_t len) {
+  if (len == 0 || len > sizeof(VFS_PREFIX)) {
+    return;
+  }
+  memcpy(VFS_PREFIX, prefix, len);
+  __atomic_store_n(&VFS_PREFIX_LEN, len, __ATOMIC_RELEASE);
+}
+
+/* Early init or daemon unreachable: Rust would pass through anyway */
+static inline bool passthrough(void) {
+  return INITIALIZING >= 2 || CIRCUIT_TRIPPED;
+}
+
+/* True only for absolute paths that cannot resolve into the VFS prefix.
+ * Anything normalization could move ("//", "/./", "/../"), relative paths
+ * and calls before the prefix is known are left to the Rust resolver. */
+static inline bool outside_vfs(const char *path) {
+  size_t len = __atomic_load_n(&VFS_PREFIX_LEN, __ATOMIC_ACQUIRE);
+  if (len == 0 || path == NULL || path[0] != '/') {
+    return false;
+  }
+  bool differs = false;
+  size_t i = 0;
+  for (; path[i] != '\0'; i++) {
+    if (!differs && i < len && path[i] != VFS_PREFIX[i]) {
+      differs = true;
+    }
+    if (path[i] == '/') {
+      const char *next = &path[i + 1];
+      if (next[0] == '/') {
+        return false;
+      }
+      if (next[0] == '.' &&
+          (next[1] == '/' || next[1] == '\0' ||
+           (next[1] == '.' && (next[2] == '/' || next[2] == '\0')))) {
+        return false;
+      }
+    }
+  }
+  return differs || i < len;
+}
+
+static inline int open_needs_mode(int flags) {
+  return (flags & O_CREAT) || (flags & O_TMPFILE) == O_TMPFILE;
+}
+
+static inline int raw_open(const char *path, int flags, mode_t mode) {
+#if defined(SYS_OPEN)
+  return (int)raw_syscall(SYS_OPEN, (long)path, (long)flags, (long)mode, 0);
+#else
+  return (int)raw_syscall(SYS_OPENAT, (long)AT_FDCWD, (long)path, (long)flags,
+                          (long)mode);
+#endif
+}
+
+static inline int raw_faccessat(int dirfd, const char *path, int mode,
+                                int flags) {
+  if (flags == 0) {
+    return (int)raw_syscall(SYS_FACCESSAT, (long)dirfd, (long)path,
+                            (long)mode, 0);
+  }
+  int ret = (int)raw_syscall(SYS_FACCESSAT2, (long)dirfd, (long)path,
+                             (long)mode, (long)flags);
+  /* Pre-5.8 kernel: AT_EACCESS only matters for setuid/setgid processes */
+  if (ret < 0 && errno == ENOSYS && flags == AT_EACCESS &&
+      getuid() == geteuid() && getgid() == getegid()) {
+    ret = (int)raw_syscall(SYS_FACCESSAT, (long)dirfd, (long)path, (long)mode,
+                           0);
+  }
+  return ret;
+}
+
+static inline int linux_open(const char *path, int flags, mode_t mode) {
+  if (passthrough()) {
+    return raw_open(path, flags, mode);
+  }
+  if (outside_vfs(path)) {
+    int fd = raw_open(path, flags, mode);
+    if (fd >= 0) {
+      __atomic_fetch_add(&OPEN_FD_COUNT, 1, __ATOMIC_RELAXED);
+    }
+    return fd;
+  }
+  return open_inception_c_impl(path, flags, mode);
+}
+
+int open(const char *path, int flags, ...) {
+  mode_t mode = 0;
+  if (open_needs_mode(flags)) {
+    va_list args;
+    va_start(args, flags);
+    mode = (mode_t)va_arg(args, int);
+    va_end(args);
+  }
+  return linux_open(path, flags, mode);
+}
+
+int open64(const char *path, int flags, ...) {
+  mode_t mode = 0;
+  if (open_needs_mode(flags)) {
+    va_list args;
+    va_start(args, flags);
+    mode = (mode_t)va_arg(args, int);
+    va_end(args);
+  }
+  return linux_open(path, flags, mode);
+}
+
+static inline int linux_openat(int dirfd, const char *path, int flags,
+                               mode_t mode) {
+  if (passthrough()) {
+    return (int)raw_syscall(SYS_OPENAT, (long)dirfd, (long)path, (long)flags,
+                            (long)mode);
+  }
+  if (outside_vfs(path)) {
+    int fd = (int)raw_syscall(SYS_OPENAT, (long)dirfd, (long)path,
+                              (long)flags, (long)mode);
+    if (fd >= 0) {
+      __atomic_fetch_add(&OPEN_FD_COUNT, 1, __ATOMIC_RELAXED);
+    }
+    return fd;
+  }
+  return velo_openat_impl(dirfd, path, flags, mode);
+}
+
+int openat(int dirfd, const char *path, int flags, ...) {
+  mode_t mode = 0;
+  if (open_needs_mode(flags)) {
+    va_list args;
+    va_start(args, flags);
+    mode = (mode_t)va_arg(args, int);
+    va_end(args);
+  }
+  return linux_openat(dirfd, path, flags, mode);
+}
+
+int openat64(int dirfd, const char *path, int flags, ...) {
+  mode_t mode = 0;
+  if (open_needs_mode(flags)) {
+    va_list args;
+    va_start(args, flags);
+    mode = (mode_t)va_arg(args, int);
+    va_end(args);
+  }
+  return linux_openat(dirfd, path, flags, mode);
+}
+
+int access(const char *path, int mode) {
+  if (passthrough() || outside_vfs(path)) {
+    return raw_faccessat(AT_FDCWD, path, mode, 0);
+  }
+  return access_inception(path, mode);
+}
+
+int faccessat(int dirfd, const char *path, int mode, int flags) {
+  if (!passthrough() && !outside_vfs(path) && velo_faccessat_vfs(dirfd, path)) {
+    return 0;
+  }
+  return raw_faccessat(dirfd, path, mode, flags);
+}
+
+ssize_t readlinkat(int dirfd, const char *path, char *buf, size_t bufsiz) {
+  if (passthrough() || outside_vfs(path)) {
+    return raw_syscall(SYS_READLINKAT, (long)dirfd, (long)path, (long)buf,
+                       (long)bufsiz);
+  }
+  return readlinkat_inception(dirfd, path, buf, bufsiz);
+}
+
+int statx(int dirfd, const char *path, int flags, unsigned int mask,
+          void *buf) {
+  if (passthrough() || outside_vfs(path)) {
+    return (int)raw_syscall6(SYS_STATX, (long)dirfd, (long)path, (long)flags,
+                             (long)mask, (long)buf, 0);
+  }
+  return statx_inception(dirfd, path, flags, mask, buf);
+}
+
+static inline int linux_fstatat(int dirfd, const char *path, void *buf,
+                                int flags) {
+  if (passthrough() || outside_vfs(path)) {
+    return (int)raw_syscall(SYS_NEWFSTATAT, (long)dirfd, (long)path,
+                            (long)buf, (long)flags);
+  }
+  return fstatat_inception(dirfd, path, buf, flags);
+}
+
+/* struct stat and stat64 coincide on both 64-bit targets */
+int fstatat(int dirfd, const char *path, void *buf, int flags) {
+  return linux_fstatat(dirfd, path, buf, flags);
+}
+
+int fstatat64(int dirfd, const char *path, void *buf, int flags) {
+  return linux_fstatat(dirfd, path, buf, flags);
+}
+
+int close(int fd) {
+  if (passthrough()) {
+    return (int)raw_syscall(SYS_CLOSE, (long)fd, 0, 0, 0);
+  }
+  return close_inception(fd);
+}
+#endif
+
 #define SYS_RENAME 128
 #define SYS_RENAMEAT 444
 #define SYS_FCNTL 92
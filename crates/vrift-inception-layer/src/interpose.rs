@@ -793,40 +793,11 @@ pub static IT_READLINKAT: Interpose = Interpose {
 // =============================================================================
 // On Linux, LD_PRELOAD works by symbol interposition. We export functions
 // with the same names as libc functions to intercept them.
-
-#[cfg(target_os = "linux")]
-#[no_mangle]
-pub unsafe extern "C" fn open(path: *const c_char, flags: c_int, mode: mode_t) -> c_int {
-    crate::syscalls::open::open_inception_c_impl(path, flags, mode)
-}
-
-#[cfg(target_os = "linux")]
-#[no_mangle]
-pub unsafe extern "C" fn open64(path: *const c_char, flags: c_int, mode: mode_t) -> c_int {
-    crate::syscalls::open::open_inception_c_impl(path, flags, mode)
-}
-
-#[cfg(target_os = "linux")]
-#[no_mangle]
-pub unsafe extern "C" fn openat(
-    dirfd: c_int,
-    path: *const c_char,
-    flags: c_int,
-    mode: mode_t,
-) -> c_int {
-    crate::syscalls::open::velo_openat_impl(dirfd, path, flags, mode)
-}
-
-#[cfg(target_os = "linux")]
-#[no_mangle]
-pub unsafe extern "C" fn openat64(
-    dirfd: c_int,
-    path: *const c_char,
-    flags: c_int,
-    mode: mode_t,
-) -> c_int {
-    crate::syscalls::open::velo_openat_impl(dirfd, path, flags, mode)
-}
+//
+// open/open64/openat/openat64, access/faccessat, readlinkat, statx,
+// fstatat/fstatat64 and close are exported by the C bridge
+// (variadic_inception.c): it passes early-init, tripped-circuit and
+// non-VFS absolute paths to the kernel before entering Rust.
 
 // Linux chmod interception - blocks VFS mutations
 #[cfg(target_os = "linux")]
@@ -893,12 +864,6 @@ pub unsafe extern "C" fn rmdir(path: *const c_char) -> c_int {
     crate::syscalls::misc::rmdir_inception(path)
 }
 
-#[cfg(target_os = "linux")]
-#[no_mangle]
-pub unsafe extern "C" fn access(path: *const c_char, mode: c_int) -> c_int {
-    crate::syscalls::stat::access_inception(path, mode)
-}
-
 // Linux utimensat/touch interception
 #[cfg(target_os = "linux")]
 #[no_mangle]
@@ -958,17 +923,6 @@ pub unsafe extern "C" fn lchown(
     crate::syscalls::misc::lchown_inception(path, owner, group)
 }
 
-#[cfg(target_os = "linux")]
-#[no_mangle]
-pub unsafe extern "C" fn readlinkat(
-    dirfd: c_int,
-    path: *const c_char,
-    buf: *mut c_char,
-    bufsiz: libc::size_t,
-) -> libc::ssize_t {
-    crate::syscalls::misc::readlinkat_inception(dirfd, path, buf, bufsiz)
-}
-
 #[cfg(target_os = "linux")]
 #[no_mangle]
 pub unsafe extern "C" fn fchownat(
@@ -993,6 +947,122 @@ pub unsafe extern "C" fn ftruncate(fd: c_int, length: libc::off_t) -> c_int {
     crate::syscalls::io::ftruncate_inception(fd, length)
 }
 
+#[cfg(target_os = "linux")]
+#[no_mangle]
+pub unsafe extern "C" fn ftruncate64(fd: c_int, length: libc::off_t) -> c_int {
+    crate::syscalls::io::ftruncate_inception(fd, length)
+}
+
+#[cfg(target_os = "linux")]
+#[no_mangle]
+pub unsafe extern "C" fn write(
+    fd: c_int,
+    buf: *const c_void,
+    count: libc::size_t,
+) -> libc::ssize_t {
+    crate::syscalls::io::write_inception(fd, buf, count)
+}
+
+#[cfg(target_os = "linux")]
+#[no_mangle]
+pub unsafe extern "C" fn writev(
+    fd: c_int,
+    iov: *const libc::iovec,
+    iovcnt: c_int,
+) -> libc::ssize_t {
+    crate::syscalls::io::writev_inception(fd, iov, iovcnt)
+}
+
+#[cfg(target_os = "linux")]
+#[no_mangle]
+pub unsafe extern "C" fn pwrite(
+    fd: c_int,
+    buf: *const c_void,
+    count: libc::size_t,
+    offset: libc::off_t,
+) -> libc::ssize_t {
+    crate::syscalls::io::pwrite_inception(fd, buf, count, offset)
+}
+
+#[cfg(target_os = "linux")]
+#[no_mangle]
+pub unsafe extern "C" fn pwrite64(
+    fd: c_int,
+    buf: *const c_void,
+    count: libc::size_t,
+    offset: libc::off_t,
+) -> libc::ssize_t {
+    crate::syscalls::io::pwrite_inception(fd, buf, count, offset)
+}
+
+#[cfg(target_os = "linux")]
+#[no_mangle]
+pub unsafe extern "C" fn pwritev(
+    fd: c_int,
+    iov: *const libc::iovec,
+    iovcnt: c_int,
+    offset: libc::off_t,
+) -> libc::ssize_t {
+    crate::syscalls::io::pwritev_inception(fd, iov, iovcnt, offset, 0)
+}
+
+#[cfg(target_os = "linux")]
+#[no_mangle]
+pub unsafe extern "C" fn pwritev64(
+    fd: c_int,
+    iov: *const libc::iovec,
+    iovcnt: c_int,
+    offset: libc::off_t,
+) -> libc::ssize_t {
+    crate::syscalls::io::pwritev_inception(fd, iov, iovcnt, offset, 0)
+}
+
+#[cfg(target_os = "linux")]
+#[no_mangle]
+pub unsafe extern "C" fn pwritev2(
+    fd: c_int,
+    iov: *const libc::iovec,
+    iovcnt: c_int,
+    offset: libc::off_t,
+    flags: c_int,
+) -> libc::ssize_t {
+    crate::syscalls::io::pwritev_inception(fd, iov, iovcnt, offset, flags)
+}
+
+#[cfg(target_os = "linux")]
+#[no_mangle]
+pub unsafe extern "C" fn pwritev64v2(
+    fd: c_int,
+    iov: *const libc::iovec,
+    iovcnt: c_int,
+    offset: libc::off_t,
+    flags: c_int,
+) -> libc::ssize_t {
+    crate::syscalls::io::pwritev_inception(fd, iov, iovcnt, offset, flags)
+}
+
+#[cfg(target_os = "linux")]
+#[no_mangle]
+pub unsafe extern "C" fn fallocate(
+    fd: c_int,
+    mode: c_int,
+    offset: libc::off_t,
+    len: libc::off_t,
+) -> c_int {
+    crate::syscalls::io::fallocate_inception(fd, mode, offset, len)
+}
+
+#[cfg(target_os = "linux")]
+#[no_mangle]
+pub unsafe extern "C" fn fallocate64(
+    fd: c_int,
+    mode: c_int,
+    offset: libc::off_t,
+    len: libc::off_t,
+) -> c_int {
+    crate::syscalls::io::fallocate_inception(fd, mode, offset, len)
+}
+
 #[cfg(target_os = "linux")]
 #[no_mangle]
 pub unsafe extern "C" fn rename(old: *const c_char, new: *const c_char) -> c_int {
@@ -10,8 +10,10 @@
 // Forbidden:   libc::access, libc::close, libc::fcntl, std::fs::*, std::io::*
 // =============================================================================
 use crate::raw_context::RawContext;
+use crate::sync::{ConnPool, PooledConn};
 use libc::c_int;
 use std::ptr;
+use std::sync::atomic::{AtomicBool, Ordering};
 use std::time::{SystemTime, UNIX_EPOCH};
 
 /// The singleton RawContext for IPC operations.
@@ -80,6 +82,19 @@ pub(crate) unsafe fn raw_unix_connect(path: &str) -> c_int {
         std::mem::size_of::<libc::timeval>() as libc::socklen_t,
     );
 
+    // Pooled connections can outlive the peer: writes must return EPIPE, not raise SIGPIPE
+    #[cfg(target_os = "macos")]
+    {
+        let on: c_int = 1;
+        libc::setsockopt(
+            fd,
+            libc::SOL_SOCKET,
+            libc::SO_NOSIGPIPE,
+            &on as *const _ as *const libc::c_void,
+            std::mem::size_of::<c_int>() as libc::socklen_t,
+        );
+    }
+
     let mut addr: libc::sockaddr_un = std::mem::zeroed();
     addr.sun_family = libc::AF_UNIX as libc::sa_family_t;
 
@@ -113,110 +128,355 @@ pub(crate) unsafe fn raw_read_exact(fd: c_int, buf: &mut [u8]) -> bool {
     CTX.read_exact(fd, buf)
 }
 
-/// Send request and receive response using raw I/O via RawContext.
-/// RFC-0043: Ensuring workspace registration for every connection.
-/// RFC-0055: Auto-recovery after CIRCUIT_RECOVERY_DELAY seconds.
-unsafe fn sync_rpc(
-    socket_path: &str,
-    request: &vrift_ipc::VeloRequest,
-) -> Option<vrift_ipc::VeloResponse> {
-    use crate::state::{
-        EventType, CIRCUIT_BREAKER_FAILED_COUNT, CIRCUIT_BREAKER_THRESHOLD, CIRCUIT_RECOVERY_DELAY,
-        CIRCUIT_TRIPPED, CIRCUIT_TRIP_TIME,
-    };
-    use std::sync::atomic::Ordering;
-
-    // Check circuit breaker with auto-recovery
-    if CIRCUIT_TRIPPED.load(Ordering::Relaxed) {
-        let trip_time = CIRCUIT_TRIP_TIME.load(Ordering::Relaxed);
-        let now = std::time::SystemTime::now()
-            .duration_since(std::time::UNIX_EPOCH)
-            .map(|d| d.as_secs())
-            .unwrap_or(0);
-        let recovery_delay = CIRCUIT_RECOVERY_DELAY.load(Ordering::Relaxed);
-
-        if now >= trip_time + recovery_delay {
-            // Recovery window: try to reset circuit breaker
-            inception_info!(
-                "Circuit breaker recovery attempt after {}s",
-                now - trip_time
+/// Write a full buffer to an IPC socket without risking SIGPIPE.
+/// Pooled connections may outlive the peer (daemon/vDird restart); writing to
+/// them must fail with EPIPE instead of killing the host process.
+/// Linux: send(MSG_NOSIGNAL). macOS: SO_NOSIGPIPE is set in raw_unix_connect.
+unsafe fn sock_write_all(fd: c_int, data: &[u8]) -> bool {
+    #[cfg(target_os = "linux")]
+    {
+        let mut written = 0;
+        while written < data.len() {
+            let n = libc::send(
+                fd,
+                data[written..].as_ptr() as *const libc::c_void,
+                data.len() - written,
+                libc::MSG_NOSIGNAL,
             );
-            CIRCUIT_TRIPPED.store(false, Ordering::SeqCst);
-            CIRCUIT_BREAKER_FAILED_COUNT.store(0, Ordering::Relaxed);
-        } else {
-            return None;
+            if n < 0 {
+                if *libc::__errno_location() == libc::EINTR {
+                    continue;
+                }
+                return false;
+            }
+            if n == 0 {
+                return false;
+            }
+            written += n as usize;
+        }
+        true
+    }
+    #[cfg(not(target_os = "linux"))]
+    {
+        raw_write_all(fd, data)
+    }
+}
+
+// =============================================================================
+// Persistent connection pool
+// =============================================================================
+//
+// Short-lived processes (compilers, linkers) used to pay socket + connect +
+// RegisterWorkspace + close for EVERY manifest RPC. Connections are now kept
+// in a process-wide pool keyed by socket path and reused across calls:
+//
+// - Daemon connections are registered once; the daemon keeps the workspace as
+//   per-connection state, so a pooled connection skips RegisterWorkspace.
+// - Every response is matched to its request by seq_id. Fire-and-forget sends
+//   leave their acks unread on the connection; they are discarded by the next
+//   RPC on it (both servers answer in order), or drained at MAX_UNACKED.
+// - A pooled FD is re-validated (fstat: still a socket, same inode) before use,
+//   in case the application closed it and the number was reused.
+// - Fork: the child drops the inherited pool (pthread_atfork), so parent and
+//   child never interleave frames on one socket.
+// - The pool is drained when the circuit breaker trips.
+// =============================================================================
+
+static IPC_POOL: ConnPool = ConnPool::new();
+static POOL_ATFORK_REGISTERED: AtomicBool = AtomicBool::new(false);
+
+/// Unread fire-and-forget acks allowed on a pooled connection before they are
+/// drained, so the peer never blocks writing responses nobody reads.
+const MAX_UNACKED: u32 = 64;
+
+extern "C" fn pool_atfork_child() {
+    // SAFETY: the child is single-threaded here; closing our own socket copies
+    // does not affect the parent's connections.
+    IPC_POOL.reset_after_fork(|fd| unsafe {
+        ipc_raw_close(fd);
+    });
+}
+
+/// Registered lazily on first checkin (never during init — see BUG-007b).
+unsafe fn ensure_pool_atfork() {
+    if !POOL_ATFORK_REGISTERED.swap(true, Ordering::AcqRel) {
+        libc::pthread_atfork(None, None, Some(pool_atfork_child));
+    }
+}
+
+/// Socket identity (st_ino) of `fd`, or 0 if it is not a live socket.
+unsafe fn socket_ino(fd: c_int) -> u64 {
+    let mut st: libc::stat = std::mem::zeroed();
+    if CTX.fstat(fd, &mut st) != 0 || (st.st_mode & libc::S_IFMT) != libc::S_IFSOCK {
+        return 0;
+    }
+    st.st_ino as u64
+}
+
+/// Take a validated idle connection to `socket_path` from the pool.
+unsafe fn pool_checkout(socket_path: &str) -> Option<PooledConn> {
+    let socket_hash = vrift_ipc::fnv1a_hash(socket_path);
+    while let Some(conn) = IPC_POOL.checkout(socket_hash) {
+        if socket_ino(conn.fd) == conn.ino {
+            return Some(conn);
         }
+        // FD is no longer ours: forget it, but NEVER close it — that number
+        // may now belong to the application.
+        inception_warn!("pooled IPC fd {} was reused, dropping", conn.fd);
+    }
+    None
+}
+
+/// Return a connection to the pool (or close it if it cannot be pooled).
+unsafe fn release_conn(conn: PooledConn) {
+    use crate::state::CIRCUIT_TRIPPED;
+
+    if conn.ino == 0 || CIRCUIT_TRIPPED.load(Ordering::Relaxed) {
+        ipc_raw_close(conn.fd);
+        return;
     }
+    ensure_pool_atfork();
+    if let Err(conn) = IPC_POOL.checkin(conn) {
+        ipc_raw_close(conn.fd);
+    }
+}
+
+/// Close a connection whose stream state is unknown (I/O error, desync).
+#[inline(always)]
+unsafe fn discard_conn(conn: PooledConn) {
+    ipc_raw_close(conn.fd);
+}
 
+/// Connect a fresh socket (not pooled yet).
+unsafe fn connect_conn(socket_path: &str) -> Option<PooledConn> {
     let fd = raw_unix_connect(socket_path);
     if fd < 0 {
+        return None;
+    }
+    Some(PooledConn {
+        fd,
+        socket_hash: vrift_ipc::fnv1a_hash(socket_path),
+        ino: socket_ino(fd),
+        unacked: 0,
+        fresh: true,
+    })
+}
+
+/// RFC-0055: Circuit breaker gate, shared by daemon and vDird connections.
+/// Auto-recovers after CIRCUIT_RECOVERY_DELAY seconds.
+unsafe fn circuit_allows() -> bool {
+    use crate::state::{
+        CIRCUIT_BREAKER_FAILED_COUNT, CIRCUIT_RECOVERY_DELAY, CIRCUIT_TRIPPED, CIRCUIT_TRIP_TIME,
+    };
+
+    if !CIRCUIT_TRIPPED.load(Ordering::Relaxed) {
+        return true;
+    }
+    let trip_time = CIRCUIT_TRIP_TIME.load(Ordering::Relaxed);
+    let now = SystemTime::now()
+        .duration_since(UNIX_EPOCH)
+        .map(|d| d.as_secs())
+        .unwrap_or(0);
+    let recovery_delay = CIRCUIT_RECOVERY_DELAY.load(Ordering::Relaxed);
+
+    if now >= trip_time + recovery_delay {
+        // Recovery window: try to reset circuit breaker
+        inception_info!(
+            "Circuit breaker recovery attempt after {}s",
+            now - trip_time
+        );
+        CIRCUIT_TRIPPED.store(false, Ordering::SeqCst);
+        CIRCUIT_BREAKER_FAILED_COUNT.store(0, Ordering::Relaxed);
+        true
+    } else {
+        crate::state::metric_add(crate::state::Metric::RawFallback, 1);
+        false
+    }
+}
+
+/// Check out a pooled connection or connect a fresh one, feeding connect
+/// failures into the circuit breaker. Tripping the breaker drains the pool.
+unsafe fn acquire_conn(socket_path: &str, peer: &str) -> Option<PooledConn> {
+    use crate::state::{
+        EventType, CIRCUIT_BREAKER_FAILED_COUNT, CIRCUIT_BREAKER_THRESHOLD, CIRCUIT_RECOVERY_DELAY,
+        CIRCUIT_TRIPPED, CIRCUIT_TRIP_TIME,
+    };
+
+    if let Some(conn) = pool_checkout(socket_path) {
+        return Some(conn);
+    }
+
+    let start = crate::state::ticks();
+    let Some(conn) = connect_conn(socket_path) else {
+        crate::state::metric_add(crate::state::Metric::RawFallback, 1);
         let count = CIRCUIT_BREAKER_FAILED_COUNT.fetch_add(1, Ordering::SeqCst) + 1;
         let threshold = CIRCUIT_BREAKER_THRESHOLD.load(Ordering::Relaxed);
-        inception_record!(EventType::IpcFail, 0, count as i32);
+        inception_record!(EventType::IpcFail, 0, count as i32, since: start);
         if count >= threshold && !CIRCUIT_TRIPPED.swap(true, Ordering::SeqCst) {
             // Record trip time for auto-recovery
-            let now = std::time::SystemTime::now()
-                .duration_since(std::time::UNIX_EPOCH)
+            let now = SystemTime::now()
+                .duration_since(UNIX_EPOCH)
                 .map(|d| d.as_secs())
                 .unwrap_or(0);
             CIRCUIT_TRIP_TIME.store(now, Ordering::Relaxed);
+            IPC_POOL.drain(|fd| {
+                ipc_raw_close(fd);
+            });
             inception_error!(
-                "DAEMON CONNECTION FAILED {} TIMES. CIRCUIT BREAKER TRIPPED. WILL RETRY AFTER {}s.",
+                "{} CONNECTION FAILED {} TIMES. CIRCUIT BREAKER TRIPPED. WILL RETRY AFTER {}s.",
+                peer,
                 count,
                 CIRCUIT_RECOVERY_DELAY.load(Ordering::Relaxed)
             );
             inception_record!(EventType::CircuitTripped, 0, count as i32);
         }
         return None;
-    }
+    };
 
-    inception_record!(EventType::IpcSuccess, 0, fd);
+    inception_record!(EventType::IpcSuccess, 0, conn.fd, since: start);
 
     // Success - reset failure count
     CIRCUIT_BREAKER_FAILED_COUNT.store(0, Ordering::Relaxed);
+    Some(conn)
+}
 
-    // RFC-0043: Registration ensures the daemon knows which project manifest to query.
+/// RFC-0043: Registration ensures the daemon knows which project manifest to query.
+/// Only needed once per daemon connection — the daemon keeps it per connection.
+unsafe fn register_workspace(conn: &mut PooledConn) {
     let project_root = get_project_root();
+    if project_root.is_empty() {
+        return;
+    }
+    let register_req = vrift_ipc::VeloRequest::RegisterWorkspace { project_root };
+    if let Some(vrift_ipc::VeloResponse::RegisterAck { vdird_socket, .. }) =
+        rpc_on_conn(conn, &register_req)
+    {
+        // Phase 1.2: Parse RegisterAck to extract vDird socket path
+        cache_vdird_socket(&vdird_socket);
+    }
+}
+
+/// One request/response exchange on `conn`. Clears pending acks on success.
+unsafe fn rpc_on_conn(
+    conn: &mut PooledConn,
+    request: &vrift_ipc::VeloRequest,
+) -> Option<vrift_ipc::VeloResponse> {
+    let start = crate::state::monotonic_ns();
+    let response = send_request_on_fd(conn.fd, request)
+        .and_then(|seq_id| recv_response_on_fd(conn.fd, seq_id, conn.unacked));
+    crate::state::metric_ipc(start, response.is_some());
+    conn.unacked = 0;
+    response
+}
 
-    if !project_root.is_empty() {
-        let register_req = vrift_ipc::VeloRequest::RegisterWorkspace { project_root };
-        if send_request_on_fd(fd, &register_req) {
-            // Phase 1.2: Parse RegisterAck to extract vDird socket path
-            if let Some(vrift_ipc::VeloResponse::RegisterAck { vdird_socket, .. }) =
-                recv_response_on_fd(fd)
-            {
-                cache_vdird_socket(&vdird_socket);
-
-                // Phase 1.2: Manifest operations must be routed to vDird, not daemon.
-                // After caching the vDird socket, re-route manifest requests immediately.
-                if is_manifest_request(request) && !vdird_socket.is_empty() {
-                    ipc_raw_close(fd);
-                    // Route directly to the newly-cached vDird socket
-                    let vdird_fd = raw_unix_connect(&vdird_socket);
-                    if vdird_fd < 0 {
-                        return None;
-                    }
-                    if !send_request_on_fd(vdird_fd, request) {
-                        ipc_raw_close(vdird_fd);
-                        return None;
-                    }
-                    let response = recv_response_on_fd(vdird_fd);
-                    ipc_raw_close(vdird_fd);
-                    return response;
+/// Run `request` on an acquired connection and release it afterwards.
+///
+/// If the send fails on a REUSED connection the peer most likely restarted
+/// while it sat in the pool; the request never reached it, so it is retried
+/// once on a fresh connection. Receive failures are never retried — the peer
+/// may already have applied the request.
+unsafe fn exchange(
+    mut conn: PooledConn,
+    socket_path: &str,
+    peer: &str,
+    register: bool,
+    request: &vrift_ipc::VeloRequest,
+) -> Option<vrift_ipc::VeloResponse> {
+    let start = crate::state::monotonic_ns();
+    loop {
+        if let Some(seq_id) = send_request_on_fd(conn.fd, request) {
+            let response = recv_response_on_fd(conn.fd, seq_id, conn.unacked);
+            crate::state::metric_ipc(start, response.is_some());
+            return match response {
+                Some(response) => {
+                    conn.unacked = 0;
+                    release_conn(conn);
+                    Some(response)
                 }
-            }
+                None => {
+                    discard_conn(conn);
+                    None
+                }
+            };
+        }
+
+        let was_pooled = !conn.fresh;
+        discard_conn(conn);
+        if !was_pooled {
+            crate::state::metric_ipc(start, false);
+            return None;
         }
+        conn = acquire_fresh(socket_path, peer, register)?;
     }
+}
 
-    // Send original request (non-manifest ops go to daemon)
-    if !send_request_on_fd(fd, request) {
+/// Retry path for `exchange`: skip the pool (its other entries to the same
+/// peer are likely stale too) and connect anew.
+unsafe fn acquire_fresh(socket_path: &str, peer: &str, register: bool) -> Option<PooledConn> {
+    IPC_POOL.drain(|fd| {
         ipc_raw_close(fd);
+    });
+    let mut conn = acquire_conn(socket_path, peer)?;
+    if register {
+        register_workspace(&mut conn);
+    }
+    Some(conn)
+}
+
+/// vDird socket cached from a previous RegisterAck, if any.
+unsafe fn cached_vdird_socket() -> Option<&'static str> {
+    let state = crate::state::InceptionLayerState::get_no_spawn()?;
+    let path = state.vdird_socket_path.as_str();
+    if path.is_empty() {
+        None
+    } else {
+        Some(path)
+    }
+}
+
+/// vDird socket for this process, registering with vriftd first if no
+/// RegisterAck has been seen yet. Blocks on a round trip: worker thread only.
+pub(crate) unsafe fn resolve_vdird_socket() -> Option<&'static str> {
+    if let Some(path) = cached_vdird_socket() {
+        return Some(path);
+    }
+    let state = crate::state::InceptionLayerState::get_no_spawn()?;
+    if !circuit_allows() {
         return None;
     }
+    let mut conn = acquire_conn(&state.socket_path, "DAEMON")?;
+    register_workspace(&mut conn);
+    release_conn(conn);
+    cached_vdird_socket()
+}
 
-    let response = recv_response_on_fd(fd);
-    ipc_raw_close(fd);
-    response
+/// Send request and receive response on a pooled daemon connection.
+/// RFC-0043: Workspace registration happens once per connection.
+/// RFC-0055: Auto-recovery after CIRCUIT_RECOVERY_DELAY seconds.
+unsafe fn sync_rpc(
+    socket_path: &str,
+    request: &vrift_ipc::VeloRequest,
+) -> Option<vrift_ipc::VeloResponse> {
+    if !circuit_allows() {
+        return None;
+    }
+
+    let mut conn = acquire_conn(socket_path, "DAEMON")?;
+    if conn.fresh {
+        register_workspace(&mut conn);
+    }
+
+    // Phase 1.2: Manifest operations must be routed to vDird, not daemon.
+    // Once the vDird socket is cached, re-route manifest requests immediately.
+    if is_manifest_request(request) {
+        if let Some(vdird_socket) = cached_vdird_socket() {
+            release_conn(conn);
+            return sync_rpc_vdird(vdird_socket, request);
+        }
+    }
+
+    // Send original request (non-manifest ops go to daemon)
+    exchange(conn, socket_path, "DAEMON", true, request)
 }
 
 /// Phase 1.2: Check if a request is a manifest operation that must be routed to vDird.
@@ -224,6 +484,7 @@ fn is_manifest_request(request: &vrift_ipc::VeloRequest) -> bool {
     matches!(
         request,
         vrift_ipc::VeloRequest::ManifestGet { .. }
+            | vrift_ipc::VeloRequest::ManifestGetMany { .. }
             | vrift_ipc::VeloRequest::ManifestUpsert { .. }
             | vrift_ipc::VeloRequest::ManifestRemove { .. }
             | vrift_ipc::VeloRequest::ManifestRename { .. }
@@ -233,13 +494,25 @@ fn is_manifest_request(request: &vrift_ipc::VeloRequest) -> bool {
     )
 }
 
+/// Manifest mutations invalidate the local probe cache: vDird may not have
+/// applied them (and bumped the VDir generation) by the time we probe again.
+fn is_manifest_mutation(request: &vrift_ipc::VeloRequest) -> bool {
+    is_manifest_request(request)
+        && !matches!(
+            request,
+            vrift_ipc::VeloRequest::ManifestGet { .. }
+                | vrift_ipc::VeloRequest::ManifestGetMany { .. }
+                | vrift_ipc::VeloRequest::ManifestListDir { .. }
+        )
+}
+
 /// Phase 1.2: Cache the vDird socket path into InceptionLayerState.
 /// Called when RegisterAck is received with a vdird_socket field.
 unsafe fn cache_vdird_socket(vdird_socket: &str) {
     if vdird_socket.is_empty() {
         return;
     }
-    let ptr = crate::state::INCEPTION_LAYER_STATE.load(std::sync::atomic::Ordering::Acquire);
+    let ptr = crate::state::INCEPTION_LAYER_STATE.load(Ordering::Acquire);
     if !ptr.is_null() {
         // Safety: We only write to vdird_socket_path which is a FixedString (Copy, no alloc).
         // This is inherently racy but FixedString::set is a memcpy of bounded size,
@@ -252,17 +525,15 @@ unsafe fn cache_vdird_socket(vdird_socket: &str) {
     }
 }
 
-/// Phase 1.2: Send RPC directly to vDird socket (no RegisterWorkspace needed).
+/// Phase 1.2: Send RPC on a pooled vDird connection (no RegisterWorkspace needed).
 /// vDird is already project-scoped, so no workspace registration is required.
 unsafe fn sync_rpc_vdird(
     vdird_socket_path: &str,
     request: &vrift_ipc::VeloRequest,
 ) -> Option<vrift_ipc::VeloResponse> {
-    use crate::state::{
-        EventType, CIRCUIT_BREAKER_FAILED_COUNT, CIRCUIT_BREAKER_THRESHOLD, CIRCUIT_RECOVERY_DELAY,
-        CIRCUIT_TRIPPED, CIRCUIT_TRIP_TIME,
-    };
-    use std::sync::atomic::Ordering;
+    if is_manifest_mutation(request) {
+        crate::state::PROBE_CACHE.invalidate();
+    }
 
     // If no vDird socket cached yet, fall back to daemon socket via sync_rpc
     if vdird_socket_path.is_empty() {
@@ -274,59 +545,12 @@ unsafe fn sync_rpc_vdird(
     }
 
     // Check circuit breaker (shared with daemon connection)
-    if CIRCUIT_TRIPPED.load(Ordering::Relaxed) {
-        let trip_time = CIRCUIT_TRIP_TIME.load(Ordering::Relaxed);
-        let now = std::time::SystemTime::now()
-            .duration_since(std::time::UNIX_EPOCH)
-            .map(|d| d.as_secs())
-            .unwrap_or(0);
-        let recovery_delay = CIRCUIT_RECOVERY_DELAY.load(Ordering::Relaxed);
-
-        if now >= trip_time + recovery_delay {
-            inception_info!(
-                "Circuit breaker recovery attempt after {}s",
-                now - trip_time
-            );
-            CIRCUIT_TRIPPED.store(false, Ordering::SeqCst);
-            CIRCUIT_BREAKER_FAILED_COUNT.store(0, Ordering::Relaxed);
-        } else {
-            return None;
-        }
-    }
-
-    let fd = raw_unix_connect(vdird_socket_path);
-    if fd < 0 {
-        let count = CIRCUIT_BREAKER_FAILED_COUNT.fetch_add(1, Ordering::SeqCst) + 1;
-        let threshold = CIRCUIT_BREAKER_THRESHOLD.load(Ordering::Relaxed);
-        inception_record!(EventType::IpcFail, 0, count as i32);
-        if count >= threshold && !CIRCUIT_TRIPPED.swap(true, Ordering::SeqCst) {
-            let now = std::time::SystemTime::now()
-                .duration_since(std::time::UNIX_EPOCH)
-                .map(|d| d.as_secs())
-                .unwrap_or(0);
-            CIRCUIT_TRIP_TIME.store(now, Ordering::Relaxed);
-            inception_error!(
-                "VDIRD CONNECTION FAILED {} TIMES. CIRCUIT BREAKER TRIPPED.",
-                count
-            );
-            inception_record!(EventType::CircuitTripped, 0, count as i32);
-        }
+    if !circuit_allows() {
         return None;
     }
 
-    inception_record!(EventType::IpcSuccess, 0, fd);
-    CIRCUIT_BREAKER_FAILED_COUNT.store(0, Ordering::Relaxed);
-
-    // No RegisterWorkspace needed — vDird is already project-scoped
-    // Send request directly
-    if !send_request_on_fd(fd, request) {
-        ipc_raw_close(fd);
-        return None;
-    }
-
-    let response = recv_response_on_fd(fd);
-    ipc_raw_close(fd);
-    response
+    let conn = acquire_conn(vdird_socket_path, "VDIRD")?;
+    exchange(conn, vdird_socket_path, "VDIRD", false, request)
 }
 
 pub(crate) unsafe fn sync_ipc_manifest_remove(vdird_socket: &str, path: &str) -> bool {
@@ -413,14 +637,25 @@ pub(crate) unsafe fn sync_ipc_manifest_symlink(
     )
 }
 
+/// Ask vDird to make a CAS blob openable by path (materializes chunked blobs).
+pub(crate) unsafe fn sync_ipc_cas_materialize(vdird_socket: &str, hash: &[u8; 32]) -> bool {
+    let request = vrift_ipc::VeloRequest::CasGet { hash: *hash };
+    matches!(
+        sync_rpc_vdird(vdird_socket, &request),
+        Some(vrift_ipc::VeloResponse::CasFound { .. })
+    )
+}
+
 pub(crate) unsafe fn sync_ipc_manifest_reingest(
     vdird_socket: &str,
     vpath: &str,
     temp: &str,
+    delta: Option<vrift_ipc::ReingestDelta>,
 ) -> bool {
     let request = vrift_ipc::VeloRequest::ManifestReingest {
         vpath: vpath.to_string(),
         temp_path: temp.to_string(),
+        delta,
     };
     matches!(
         sync_rpc_vdird(vdird_socket, &request),
@@ -441,12 +676,27 @@ pub(crate) unsafe fn fire_and_forget_ipc(
     socket_path: &str,
     request: &vrift_ipc::VeloRequest,
 ) -> bool {
+    if is_manifest_mutation(request) {
+        crate::state::PROBE_CACHE.invalidate();
+    }
+
     // Serialize upfront so the worker only needs to connect + write
     let payload = match rkyv::to_bytes::<rkyv::rancor::Error>(request) {
         Ok(bytes) => bytes.to_vec(),
         Err(_) => return false,
     };
 
+    // Fast path: shm mutation ring straight to vDird (no socket, no worker hop).
+    // Every mutation that fits takes the ring so vDird applies them in order;
+    // only oversized payloads, or a consumer gone missing, use the socket.
+    if let Some(ring) =
+        crate::state::InceptionLayerState::get_no_spawn().and_then(|s| s.mutation_ring)
+    {
+        if push_mutation_ring(&ring, &payload) {
+            return true;
+        }
+    }
+
     // Try to push to ring buffer for async processing
     if let Some(reactor) = crate::sync::get_reactor() {
         let task = crate::sync::Task::IpcFireAndForget {
@@ -471,34 +721,103 @@ pub(crate) unsafe fn fire_and_forget_ipc(
     send_fire_and_forget_sync(socket_path, &payload)
 }
 
-/// Synchronous fallback for fire-and-forget: connect, register, send, close.
-/// Does not read the response — the daemon processes the request asynchronously.
-pub(crate) unsafe fn send_fire_and_forget_sync(socket_path: &str, payload: &[u8]) -> bool {
-    let fd = raw_unix_connect(socket_path);
-    if fd < 0 {
-        return false;
-    }
-
-    // Workspace registration (same as sync_rpc)
-    let project_root = get_project_root();
-    if !project_root.is_empty() {
-        let register_req = vrift_ipc::VeloRequest::RegisterWorkspace { project_root };
-        if send_request_on_fd(fd, &register_req) {
-            // Phase 1.2: Parse RegisterAck to cache vDird socket
-            if let Some(vrift_ipc::VeloResponse::RegisterAck { vdird_socket, .. }) =
-                recv_response_on_fd(fd)
-            {
-                cache_vdird_socket(&vdird_socket);
+/// How long a producer waits on a full mutation ring before giving up on it
+const RING_FULL_WAIT: std::time::Duration = std::time::Duration::from_secs(1);
+
+/// Push onto the vDird mutation ring. A full ring is waited on (ordering
+/// would be lost by overtaking it on the socket); false only when the payload
+/// can never fit or vDird has not drained for `RING_FULL_WAIT`.
+fn push_mutation_ring(ring: &vrift_ipc::mutation_ring::MutationRing, payload: &[u8]) -> bool {
+    use vrift_ipc::mutation_ring::PushError;
+
+    let owner = unsafe { libc::getpid() } as u32;
+    let mut full_since: Option<std::time::Instant> = None;
+    loop {
+        match ring.push(payload, owner) {
+            Ok(wake) => {
+                if wake {
+                    ring_doorbell(ring);
+                }
+                return true;
+            }
+            // vDird took our claim back (we stalled past its timeout): redo
+            Err(PushError::Revoked) => continue,
+            Err(PushError::TooLarge) => return false,
+            Err(PushError::Full) => {
+                let since = *full_since.get_or_insert_with(std::time::Instant::now);
+                if since.elapsed() >= RING_FULL_WAIT {
+                    inception_warn!("Mutation ring full for 1s, falling back to socket IPC");
+                    return false;
+                }
+                ring_doorbell(ring);
+                std::thread::sleep(std::time::Duration::from_micros(50));
             }
         }
     }
+}
+
+/// Wake the parked vDird ring consumer (shared futex on the doorbell word)
+#[cfg(target_os = "linux")]
+#[inline(never)]
+fn ring_doorbell(ring: &vrift_ipc::mutation_ring::MutationRing) {
+    unsafe {
+        libc::syscall(
+            libc::SYS_futex,
+            ring.doorbell_addr(),
+            libc::FUTEX_WAKE,
+            1,
+            ptr::null::<libc::timespec>(),
+            ptr::null::<u32>(),
+            0,
+        );
+    }
+}
+
+/// macOS has no cross-process futex: the consumer polls while parked
+#[cfg(not(target_os = "linux"))]
+#[inline(always)]
+fn ring_doorbell(_ring: &vrift_ipc::mutation_ring::MutationRing) {}
+
+/// Synchronous fire-and-forget send on a pooled connection.
+/// Does not wait for the response: the ack stays queued on the connection and
+/// is discarded by the next RPC on it (or drained once MAX_UNACKED pile up).
+pub(crate) unsafe fn send_fire_and_forget_sync(socket_path: &str, payload: &[u8]) -> bool {
+    let Some(mut conn) = pool_checkout(socket_path).or_else(|| connect_conn(socket_path)) else {
+        return false;
+    };
+    // Workspace registration (same as sync_rpc, once per connection)
+    if conn.fresh {
+        register_workspace(&mut conn);
+    }
 
     // Send the pre-serialized request
     let seq_id = vrift_ipc::next_seq_id();
     let header = vrift_ipc::IpcHeader::new_request(payload.len() as u32, seq_id);
-    let success = raw_write_all(fd, &header.to_bytes()) && raw_write_all(fd, payload);
-    ipc_raw_close(fd);
-    success
+    if !(sock_write_all(conn.fd, &header.to_bytes()) && sock_write_all(conn.fd, payload)) {
+        let was_pooled = !conn.fresh;
+        discard_conn(conn);
+        // Stale pooled connection: the request never left, retry on a fresh one
+        return was_pooled && send_fire_and_forget_fresh(socket_path, payload);
+    }
+
+    conn.unacked += 1;
+    if conn.unacked >= MAX_UNACKED {
+        // Drain all pending acks up to (and including) this request's
+        if recv_response_on_fd(conn.fd, seq_id, conn.unacked - 1).is_none() {
+            discard_conn(conn);
+            return true;
+        }
+        conn.unacked = 0;
+    }
+    release_conn(conn);
+    true
+}
+
+unsafe fn send_fire_and_forget_fresh(socket_path: &str, payload: &[u8]) -> bool {
+    IPC_POOL.drain(|fd| {
+        ipc_raw_close(fd);
+    });
+    send_fire_and_forget_sync(socket_path, payload)
 }
 
 /// Extract project root from env vars (shared between sync_rpc and fire-and-forget).
@@ -601,52 +920,81 @@ pub(crate) unsafe fn sync_ipc_manifest_get(
     }
 }
 
-// Helper: send request on existing FD (v3 frame protocol)
-unsafe fn send_request_on_fd(fd: libc::c_int, request: &vrift_ipc::VeloRequest) -> bool {
+// Helper: send request on existing FD (v3 frame protocol).
+// Returns the frame's seq_id so the caller can match the response.
+unsafe fn send_request_on_fd(fd: libc::c_int, request: &vrift_ipc::VeloRequest) -> Option<u32> {
     use vrift_ipc::{next_seq_id, IpcHeader};
 
-    let payload = match rkyv::to_bytes::<rkyv::rancor::Error>(request) {
-        Ok(b) => b,
-        Err(_) => return false,
-    };
+    let payload = rkyv::to_bytes::<rkyv::rancor::Error>(request).ok()?;
 
     if payload.len() > vrift_ipc::IpcHeader::MAX_LENGTH {
-        return false;
+        return None;
     }
 
     let seq_id = next_seq_id();
     let header = IpcHeader::new_request(payload.len() as u32, seq_id);
 
-    raw_write_all(fd, &header.to_bytes()) && raw_write_all(fd, &payload)
+    if sock_write_all(fd, &header.to_bytes()) && sock_write_all(fd, &payload) {
+        Some(seq_id)
+    } else {
+        None
+    }
 }
 
-// Helper: receive response on existing FD (v3 frame protocol)
-unsafe fn recv_response_on_fd(fd: libc::c_int) -> Option<vrift_ipc::VeloResponse> {
-    use vrift_ipc::IpcHeader;
+// Helper: receive the response to `seq_id` on existing FD (v3 frame protocol).
+// Up to `max_stale` earlier responses (unread fire-and-forget acks) are
+// skipped; any other mismatch means the stream is out of sync.
+unsafe fn recv_response_on_fd(
+    fd: libc::c_int,
+    seq_id: u32,
+    max_stale: u32,
+) -> Option<vrift_ipc::VeloResponse> {
+    use vrift_ipc::{FrameType, IpcHeader};
 
-    // Read header
-    let mut header_buf = [0u8; IpcHeader::SIZE];
-    if !raw_read_exact(fd, &mut header_buf) {
-        return None;
-    }
+    let mut stale = 0;
+    loop {
+        // Read header
+        let mut header_buf = [0u8; IpcHeader::SIZE];
+        if !raw_read_exact(fd, &mut header_buf) {
+            return None;
+        }
 
-    let header = IpcHeader::from_bytes(&header_buf);
-    if !header.is_valid() {
-        return None;
-    }
+        let header = IpcHeader::from_bytes(&header_buf);
+        if !header.is_valid() {
+            return None;
+        }
 
-    // Sanity check
-    if header.length as usize > 1024 * 1024 {
-        return None;
-    }
+        // Sanity check
+        if header.length as usize > 1024 * 1024 {
+            return None;
+        }
 
-    // Read payload
-    let mut payload = vec![0u8; header.length as usize];
-    if !raw_read_exact(fd, &mut payload) {
-        return None;
-    }
+        // Read payload
+        let mut payload = vec![0u8; header.length as usize];
+        if !raw_read_exact(fd, &mut payload) {
+            return None;
+        }
+
+        // RFC-0053: Skip heartbeats transparently
+        if header.frame_type() == Some(FrameType::Heartbeat) {
+            continue;
+        }
 
-    rkyv::from_bytes::<vrift_ipc::VeloResponse, rkyv::rancor::Error>(&payload).ok()
+        if header.seq_id != seq_id {
+            stale += 1;
+            if stale > max_stale {
+                inception_warn!(
+                    "IPC seq mismatch: expected {}, got {}",
+                    seq_id,
+                    header.seq_id
+                );
+                return None;
+            }
+            continue;
+        }
+
+        return rkyv::from_bytes::<vrift_ipc::VeloResponse, rkyv::rancor::Error>(&payload).ok();
+    }
 }
 
 /// Query directory listing from vDird
@@ -663,3 +1011,73 @@ pub(crate) unsafe fn sync_ipc_manifest_list_dir(
         _ => None,
     }
 }
+
+/// Batched manifest query: one vDird round trip for up to
+/// MANIFEST_GET_MANY_MAX paths. `result[i]` answers `paths[i]`.
+pub(crate) unsafe fn sync_ipc_manifest_get_many(
+    vdird_socket: &str,
+    paths: Vec<String>,
+) -> Option<Vec<Option<vrift_ipc::VnodeEntry>>> {
+    let expected = paths.len();
+    let request = vrift_ipc::VeloRequest::ManifestGetMany { paths };
+    match sync_rpc_vdird(vdird_socket, &request) {
+        Some(vrift_ipc::VeloResponse::ManifestGetManyAck { entries })
+            if entries.len() == expected =>
+        {
+            Some(entries)
+        }
+        _ => None,
+    }
+}
+
+/// Largest directory warmed in one go; bigger ones keep per-path IPC.
+/// Half the cache, so one directory cannot crowd out everything else.
+const WARM_MAX_CHILDREN: usize = crate::sync::probe_cache::PROBE_CACHE_SLOTS / 2;
+
+/// Warm the probe cache for directory `dir`: list it, fetch every child in
+/// ManifestGetMany batches, and mark the directory complete when all
+/// answers were cached under (`generation`, `epoch`).
+/// Returns true if the directory was marked complete.
+pub(crate) unsafe fn warm_probe_cache(
+    vdird_socket: &str,
+    dir: &str,
+    generation: u64,
+    epoch: u64,
+) -> bool {
+    use crate::state::{fnv1a_hash, PROBE_CACHE};
+
+    let parent_hash = fnv1a_hash(dir);
+    let listing = match sync_ipc_manifest_list_dir(vdird_socket, dir) {
+        Some(entries) if entries.len() <= WARM_MAX_CHILDREN => entries,
+        _ => {
+            PROBE_CACHE.finish_dir_warm(parent_hash, false, generation, epoch);
+            return false;
+        }
+    };
+
+    let base = dir.trim_end_matches('/');
+    let keys: Vec<String> = listing
+        .iter()
+        .map(|e| format!("{}/{}", base, e.name))
+        .collect();
+
+    let mut complete = true;
+    for chunk in keys.chunks(vrift_ipc::MANIFEST_GET_MANY_MAX) {
+        let Some(entries) = sync_ipc_manifest_get_many(vdird_socket, chunk.to_vec()) else {
+            complete = false;
+            break;
+        };
+        for (key, entry) in chunk.iter().zip(entries.iter()) {
+            complete &= PROBE_CACHE.insert(fnv1a_hash(key), entry.as_ref(), generation, epoch);
+        }
+    }
+
+    inception_debug!(
+        "probe cache: warmed {} ({} entries, complete={})",
+        dir,
+        keys.len(),
+        complete
+    );
+    PROBE_CACHE.finish_dir_warm(parent_hash, complete, generation, epoch);
+    complete
+}
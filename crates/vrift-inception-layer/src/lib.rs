@@ -44,6 +44,7 @@ pub mod macros;
 
 pub mod interpose;
 pub mod ipc;
+pub mod pack;
 pub mod path;
 pub mod raw_context;
 pub mod reals;
@@ -119,20 +120,9 @@ pub unsafe extern "C" fn vrift_get_telemetry(
     let init_state = crate::state::INITIALIZING.load(std::sync::atomic::Ordering::Relaxed);
     let pid = libc::getpid();
 
-    // Flight Recorder Summary
+    // Flight Recorder Summary (retained entries, no locking)
     let mut counts = [0u32; 16];
-    let head = crate::state::FLIGHT_RECORDER
-        .head
-        .load(std::sync::atomic::Ordering::Relaxed);
-    // Scan last N entries (approximate) to avoid heavyweight locking
-    let start = head.saturating_sub(1000);
-    for i in start..head {
-        let idx = i % crate::state::FLIGHT_RECORDER_SIZE;
-        let entry = &crate::state::FLIGHT_RECORDER.buffer[idx];
-        if entry.event_type > 0 && entry.event_type < 16 {
-            counts[entry.event_type as usize] += 1;
-        }
-    }
+    let total = crate::state::FLIGHT_RECORDER.event_counts(&mut counts);
 
     let _ = writeln!(writer, "{{");
     let _ = writeln!(writer, "  \"pid\": {},", pid);
@@ -158,13 +148,13 @@ pub unsafe extern "C" fn vrift_get_telemetry(
         );
     }
 
-    let _ = writeln!(writer, "  \"events_last_1k\": {{");
+    let _ = writeln!(writer, "  \"events_retained\": {{");
     for (i, name) in crate::state::EVENT_NAMES.iter().enumerate() {
         if i > 0 && i < counts.len() {
             let _ = writeln!(writer, "    \"{}\": {},", name, counts[i]);
         }
     }
-    let _ = writeln!(writer, "    \"total_recorded\": {}", head);
+    let _ = writeln!(writer, "    \"total_recorded\": {}", total);
     let _ = writeln!(writer, "  }}");
     let _ = write!(writer, "}}"); // End JSON
 
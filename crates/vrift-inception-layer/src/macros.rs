@@ -86,10 +86,19 @@ macro_rules! inception_log_at_level {
 }
 
 // Zero-allocation structured event recording (Flight Recorder)
+// `since: start` (a `state::ticks()` reading) records the time since as duration
 #[macro_export]
 macro_rules! inception_record {
     ($event:expr, $file_id:expr, $result:expr) => {{
-        $crate::state::FLIGHT_RECORDER.record($event, $file_id, $result as i32);
+        $crate::state::FLIGHT_RECORDER.record($event, $file_id, $result as i32, 0);
+    }};
+    ($event:expr, $file_id:expr, $result:expr, since: $start:expr) => {{
+        $crate::state::FLIGHT_RECORDER.record(
+            $event,
+            $file_id,
+            $result as i32,
+            $crate::state::ticks().saturating_sub($start),
+        );
     }};
 }
 
@@ -0,0 +1,658 @@
+//! Hot-path packfile support: access tracing and pack-backed opens.
+//!
+//! `VRIFT_ACCESS_PROFILE=<file>` makes every VFS read-open append a
+//! 40-byte record (CLOCK_MONOTONIC ns + content hash) to `<file>`;
+//! `vrift pack` turns the trace into `.vrift/hot.pack`, blobs laid out in
+//! first-access order. Opens of packed blobs are then served from the pack
+//! mapping, so a cold start reads one file sequentially instead of tens of
+//! thousands of loose blobs at random.
+//!
+//! The shim cannot link vrift-pack; this reads its v2 layout directly
+//! (header, 256-entry fanout, sorted 48-byte index entries).
+//!
+//! Pack-backed opens need memfd and are Linux only; macOS still traces.
+//! Each packed blob is copied out of the pack once per process into a
+//! sealed memfd that every later open of it reopens. The copies cost
+//! anonymous memory (RSS) of up to `PACK_MEMFD_BUDGET` and one fd each,
+//! at most `PACK_MEMFD_SLOTS`; blobs past either limit are opened loose.
+//!
+//! Independently of the profile, each process reports the blobs it opens to
+//! vDird's prefetcher (`AccessTrace`, first open of each blob only) and
+//! announces itself when it starts (`PrefetchHint`), so the next run of the
+//! same command finds its inputs already in the page cache. The hot path
+//! only appends to a buffer; the worker thread does the IPC.
+
+#![cfg_attr(not(target_os = "linux"), allow(dead_code))]
+
+use libc::c_int;
+use std::fmt::Write;
+use std::sync::atomic::{
+    AtomicBool, AtomicI32, AtomicPtr, AtomicU64, AtomicU8, AtomicUsize, Ordering,
+};
+use std::sync::OnceLock;
+
+use vrift_ipc::AccessedBlob;
+
+use crate::state::InceptionLayerState;
+use crate::sync::RecursiveMutex;
+
+const PACK_MAGIC: &[u8; 8] = b"VELOPACK";
+const PACK_VERSION: u32 = 2;
+const PACK_HEADER_SIZE: usize = 64;
+const PACK_FANOUT_SIZE: usize = 256 * 4;
+const PACK_ENTRY_SIZE: usize = 48;
+
+/// Largest blob served from the pack; bigger ones are opened loose
+const PACK_REDIRECT_MAX: u64 = 1024 * 1024;
+
+/// Bytes of packed blobs a process keeps copied out in memfds
+const PACK_MEMFD_BUDGET: u64 = 64 * 1024 * 1024;
+/// Direct-mapped by hash; a blob whose slot is taken is opened loose
+const PACK_MEMFD_SLOTS: usize = 256;
+
+const TRACE_RECORD_SIZE: usize = 40;
+
+/// A mapped, validated pack
+struct PackMap {
+    base: *const u8,
+    len: usize,
+    count: usize,
+    data_offset: usize,
+    data_len: usize,
+    fanout_offset: usize,
+    index_offset: usize,
+}
+
+unsafe impl Send for PackMap {}
+unsafe impl Sync for PackMap {}
+
+const PACK_UNKNOWN: u8 = 0;
+const PACK_LOADING: u8 = 1;
+const PACK_READY: u8 = 2;
+const PACK_ABSENT: u8 = 3;
+
+static PACK_STATE: AtomicU8 = AtomicU8::new(PACK_UNKNOWN);
+static PACK: AtomicPtr<PackMap> = AtomicPtr::new(std::ptr::null_mut());
+
+fn read_u32(bytes: &[u8], at: usize) -> u32 {
+    u32::from_le_bytes(bytes[at..at + 4].try_into().unwrap())
+}
+
+fn read_u64(bytes: &[u8], at: usize) -> u64 {
+    u64::from_le_bytes(bytes[at..at + 8].try_into().unwrap())
+}
+
+impl PackMap {
+    fn bytes(&self) -> &[u8] {
+        unsafe { std::slice::from_raw_parts(self.base, self.len) }
+    }
+
+    /// Validate a mapped pack (same checks as `PackReader::open`)
+    fn parse(base: *const u8, len: usize) -> Option<Self> {
+        let bytes = unsafe { std::slice::from_raw_parts(base, len) };
+        if len < PACK_HEADER_SIZE || &bytes[..8] != PACK_MAGIC || read_u32(bytes, 8) != PACK_VERSION
+        {
+            return None;
+        }
+        let count = read_u32(bytes, 12) as usize;
+        let fits =
+            |offset: u64, size: u64| offset.checked_add(size).is_some_and(|e| e <= len as u64);
+        let (data_offset, data_len) = (read_u64(bytes, 16), read_u64(bytes, 24));
+        let (fanout_offset, index_offset) = (read_u64(bytes, 32), read_u64(bytes, 40));
+        if !fits(data_offset, data_len)
+            || !fits(fanout_offset, PACK_FANOUT_SIZE as u64)
+            || !fits(index_offset, (count * PACK_ENTRY_SIZE) as u64)
+        {
+            return None;
+        }
+        let pack = Self {
+            base,
+            len,
+            count,
+            data_offset: data_offset as usize,
+            data_len: data_len as usize,
+            fanout_offset: fanout_offset as usize,
+            index_offset: index_offset as usize,
+        };
+        (pack.fanout(255) == count).then_some(pack)
+    }
+
+    fn fanout(&self, byte: u8) -> usize {
+        (read_u32(self.bytes(), self.fanout_offset + byte as usize * 4) as usize).min(self.count)
+    }
+
+    /// Data of `hash` in the pack
+    fn find(&self, hash: &[u8; 32]) -> Option<&[u8]> {
+        let bytes = self.bytes();
+        let mut lo = if hash[0] == 0 {
+            0
+        } else {
+            self.fanout(hash[0] - 1)
+        };
+        let mut hi = self.fanout(hash[0]);
+        while lo < hi {
+            let mid = lo + (hi - lo) / 2;
+            let at = self.index_offset + mid * PACK_ENTRY_SIZE;
+            let entry = &bytes[at..at + PACK_ENTRY_SIZE];
+            match entry[..32].cmp(&hash[..]) {
+                std::cmp::Ordering::Less => lo = mid + 1,
+                std::cmp::Ordering::Greater => hi = mid,
+                std::cmp::Ordering::Equal => {
+                    let (offset, length) = (read_u64(entry, 32), read_u64(entry, 40));
+                    if offset.checked_add(length)? > self.data_len as u64 {
+                        return None;
+                    }
+                    let start = self.data_offset + offset as usize;
+                    return Some(&bytes[start..start + length as usize]);
+                }
+            }
+        }
+        None
+    }
+}
+
+/// The project's hot pack, mapped on first use. Threads racing the first
+/// load just open loose blobs.
+fn hot_pack(state: &InceptionLayerState) -> Option<&'static PackMap> {
+    match PACK_STATE.load(Ordering::Acquire) {
+        PACK_READY => return unsafe { PACK.load(Ordering::Acquire).as_ref() },
+        PACK_UNKNOWN => {}
+        _ => return None,
+    }
+    if PACK_STATE
+        .compare_exchange(
+            PACK_UNKNOWN,
+            PACK_LOADING,
+            Ordering::AcqRel,
+            Ordering::Acquire,
+        )
+        .is_err()
+    {
+        return None;
+    }
+
+    match unsafe { map_pack(state.project_root.as_str()) } {
+        Some(pack) => {
+            PACK.store(Box::into_raw(Box::new(pack)), Ordering::Release);
+            PACK_STATE.store(PACK_READY, Ordering::Release);
+            unsafe { PACK.load(Ordering::Acquire).as_ref() }
+        }
+        None => {
+            PACK_STATE.store(PACK_ABSENT, Ordering::Release);
+            None
+        }
+    }
+}
+
+unsafe fn map_pack(project_root: &str) -> Option<PackMap> {
+    let mut path = [0u8; 1024];
+    let cap = path.len() - 1; // Room for the NUL
+    let mut writer = crate::macros::StackWriter::new(&mut path[..cap]);
+    let _ = write!(writer, "{}/.vrift/hot.pack", project_root);
+    let n = writer.as_str().len();
+    if n == 0 || n == cap {
+        return None;
+    }
+
+    let fd = libc::open(
+        path.as_ptr() as *const libc::c_char,
+        libc::O_RDONLY | libc::O_CLOEXEC,
+    );
+    if fd < 0 {
+        return None;
+    }
+    let mut st: libc::stat = std::mem::zeroed();
+    let len = if libc::fstat(fd, &mut st) == 0 {
+        st.st_size as usize
+    } else {
+        0
+    };
+    let base = if len >= PACK_HEADER_SIZE {
+        libc::mmap(
+            std::ptr::null_mut(),
+            len,
+            libc::PROT_READ,
+            libc::MAP_PRIVATE,
+            fd,
+            0,
+        )
+    } else {
+        libc::MAP_FAILED
+    };
+    libc::close(fd);
+    if base == libc::MAP_FAILED {
+        return None;
+    }
+
+    let pack = PackMap::parse(base as *const u8, len);
+    if pack.is_none() {
+        libc::munmap(base, len);
+    }
+    pack
+}
+
+/// A packed blob copied out into a sealed memfd, shared by its opens
+#[derive(Clone, Copy)]
+struct PackedMemfd {
+    hash: [u8; 32],
+    fd: c_int,
+    ino: u64,
+}
+
+struct PackedMemfds {
+    bytes: u64,
+    slots: [Option<PackedMemfd>; PACK_MEMFD_SLOTS],
+}
+
+static PACKED_MEMFDS: RecursiveMutex<PackedMemfds> = RecursiveMutex::new(PackedMemfds {
+    bytes: 0,
+    slots: [None; PACK_MEMFD_SLOTS],
+});
+
+fn memfd_slot(hash: &[u8; 32]) -> usize {
+    u64::from_le_bytes(hash[..8].try_into().unwrap()) as usize % PACK_MEMFD_SLOTS
+}
+
+/// Open a packed blob as a sealed memfd holding its content.
+///
+/// The first open copies the blob from the pack mapping (served by pack
+/// readahead); later opens reopen the same memfd through /proc, with their
+/// own file offset, so its pages are held once per process. Returns None
+/// (open the loose blob) when the blob is not packed, its slot is taken or
+/// the memfd budget is spent.
+#[cfg(target_os = "linux")]
+pub(crate) unsafe fn open_packed(
+    state: &InceptionLayerState,
+    hash: &[u8; 32],
+    size: u64,
+    flags: c_int,
+) -> Option<c_int> {
+    if size == 0 || size > PACK_REDIRECT_MAX {
+        return None;
+    }
+    let data = hot_pack(state)?.find(hash)?;
+    if data.len() as u64 != size {
+        return None;
+    }
+
+    let mut memfds = PACKED_MEMFDS.lock();
+    let slot = memfd_slot(hash);
+    let memfd = match memfds.slots[slot] {
+        Some(memfd) if memfd.hash == *hash => memfd,
+        Some(_) => return None,
+        None if memfds.bytes + size > PACK_MEMFD_BUDGET => return None,
+        None => {
+            let memfd = copy_to_memfd(hash, data)?;
+            memfds.slots[slot] = Some(memfd);
+            memfds.bytes += size;
+            memfd
+        }
+    };
+    drop(memfds);
+    reopen_memfd(memfd, flags)
+}
+
+/// Copy `data` into a fresh memfd, sealed read-only like the CAS blob it
+/// stands in for
+#[cfg(target_os = "linux")]
+unsafe fn copy_to_memfd(hash: &[u8; 32], data: &[u8]) -> Option<PackedMemfd> {
+    use crate::syscalls::linux_raw::{raw_close, raw_fstat, raw_write};
+
+    let fd = libc::memfd_create(
+        c"vrift-pack".as_ptr(),
+        libc::MFD_CLOEXEC | libc::MFD_ALLOW_SEALING,
+    );
+    if fd < 0 {
+        return None;
+    }
+    let mut written = 0;
+    while written < data.len() {
+        let n = raw_write(
+            fd,
+            data[written..].as_ptr() as *const libc::c_void,
+            data.len() - written,
+        );
+        if n <= 0 {
+            raw_close(fd);
+            return None;
+        }
+        written += n as usize;
+    }
+    let mut st: libc::stat = std::mem::zeroed();
+    if libc::fcntl(
+        fd,
+        libc::F_ADD_SEALS,
+        libc::F_SEAL_SHRINK | libc::F_SEAL_GROW | libc::F_SEAL_WRITE | libc::F_SEAL_SEAL,
+    ) != 0
+        || raw_fstat(fd, &mut st) != 0
+    {
+        raw_close(fd);
+        return None;
+    }
+    Some(PackedMemfd {
+        hash: *hash,
+        fd,
+        ino: st.st_ino as u64,
+    })
+}
+
+/// A new open file description of `memfd` (fresh offset, shared pages).
+/// The application may have closed or replaced the cached fd, so the
+/// reopened file must still be the memfd.
+#[cfg(target_os = "linux")]
+unsafe fn reopen_memfd(memfd: PackedMemfd, flags: c_int) -> Option<c_int> {
+    use crate::syscalls::linux_raw::{raw_close, raw_fstat, raw_open};
+
+    let mut path = [0u8; 32];
+    let cap = path.len() - 1; // Room for the NUL
+    let mut writer = crate::macros::StackWriter::new(&mut path[..cap]);
+    let _ = write!(writer, "/proc/self/fd/{}", memfd.fd);
+    let fd = raw_open(
+        path.as_ptr() as *const libc::c_char,
+        libc::O_RDONLY | (flags & libc::O_CLOEXEC),
+        0,
+    );
+    if fd < 0 {
+        return None;
+    }
+    let mut st: libc::stat = std::mem::zeroed();
+    if raw_fstat(fd, &mut st) != 0 || st.st_ino as u64 != memfd.ino {
+        raw_close(fd);
+        return None;
+    }
+    Some(fd)
+}
+
+// ============================================================================
+// Access tracing (VRIFT_ACCESS_PROFILE)
+// ============================================================================
+
+const TRACE_UNKNOWN: i32 = -2;
+const TRACE_OFF: i32 = -1;
+
+static TRACE_FD: AtomicI32 = AtomicI32::new(TRACE_UNKNOWN);
+
+fn monotonic_ns() -> u64 {
+    let mut now: libc::timespec = unsafe { std::mem::zeroed() };
+    unsafe { libc::clock_gettime(libc::CLOCK_MONOTONIC, &mut now) };
+    now.tv_sec as u64 * 1_000_000_000 + now.tv_nsec as u64
+}
+
+/// Record a VFS read-open of `hash`: queue it for the prefetcher (first open
+/// only) and append a trace record if `VRIFT_ACCESS_PROFILE` is set
+pub(crate) fn record_access(hash: &[u8; 32], size: u64) {
+    let fd = match TRACE_FD.load(Ordering::Relaxed) {
+        TRACE_UNKNOWN => unsafe { open_trace() },
+        fd => fd,
+    };
+    let first = !PREFETCH_OFF.load(Ordering::Relaxed) && first_access(hash);
+    if fd < 0 && !first {
+        return;
+    }
+
+    let nanos = monotonic_ns();
+    if first {
+        queue_access(hash, size, nanos);
+    }
+    if fd < 0 {
+        return;
+    }
+
+    let mut record = [0u8; TRACE_RECORD_SIZE];
+    record[..8].copy_from_slice(&nanos.to_le_bytes());
+    record[8..].copy_from_slice(hash);
+
+    // O_APPEND: records from concurrent processes never interleave
+    #[cfg(target_os = "macos")]
+    unsafe {
+        crate::syscalls::macos_raw::raw_write(fd, record.as_ptr() as *const _, record.len())
+    };
+    #[cfg(target_os = "linux")]
+    unsafe {
+        crate::syscalls::linux_raw::raw_write(fd, record.as_ptr() as *const _, record.len())
+    };
+}
+
+unsafe fn open_trace() -> c_int {
+    let path = libc::getenv(c"VRIFT_ACCESS_PROFILE".as_ptr());
+    let fd = if path.is_null() || *path == 0 {
+        TRACE_OFF
+    } else {
+        match libc::open(
+            path,
+            libc::O_WRONLY | libc::O_CREAT | libc::O_APPEND | libc::O_CLOEXEC,
+            0o644 as libc::c_uint,
+        ) {
+            fd if fd >= 0 => fd,
+            _ => TRACE_OFF,
+        }
+    };
+    match TRACE_FD.compare_exchange(TRACE_UNKNOWN, fd, Ordering::AcqRel, Ordering::Acquire) {
+        Ok(_) => fd,
+        Err(winner) => {
+            if fd >= 0 {
+                libc::close(fd);
+            }
+            winner
+        }
+    }
+}
+
+// ============================================================================
+// Prefetcher feed (AccessTrace / PrefetchHint to vDird)
+// ============================================================================
+
+/// Blobs per AccessTrace
+const ACCESS_BATCH: usize = vrift_ipc::ACCESS_TRACE_MAX;
+/// Queued opens; more are dropped until the worker catches up
+const ACCESS_BUFFER: usize = 4 * ACCESS_BATCH;
+/// A partial batch is sent once its oldest open has waited this long
+const ACCESS_FLUSH_AGE_NS: u64 = 10_000_000;
+/// Direct-mapped filter of blobs this process already queued. A collision
+/// just reports a blob twice; vDird dedups.
+const ACCESS_SEEN_SLOTS: usize = 4096;
+
+struct AccessBuffer {
+    len: usize,
+    blobs: [AccessedBlob; ACCESS_BUFFER],
+}
+
+static ACCESSES: RecursiveMutex<AccessBuffer> = RecursiveMutex::new(AccessBuffer {
+    len: 0,
+    blobs: [AccessedBlob {
+        hash: [0; 32],
+        size: 0,
+    }; ACCESS_BUFFER],
+});
+/// Mirrors `ACCESSES.len` so the idle worker can check without locking
+static ACCESS_PENDING: AtomicUsize = AtomicUsize::new(0);
+/// When the oldest queued open happened (CLOCK_MONOTONIC ns)
+static ACCESS_PENDING_SINCE: AtomicU64 = AtomicU64::new(0);
+static ACCESS_SEEN: [AtomicU64; ACCESS_SEEN_SLOTS] =
+    [const { AtomicU64::new(0) }; ACCESS_SEEN_SLOTS];
+/// Set once vDird turned out to be unreachable from this process
+static PREFETCH_OFF: AtomicBool = AtomicBool::new(false);
+static PROCESS_KEY: OnceLock<(String, String)> = OnceLock::new();
+
+fn first_access(hash: &[u8; 32]) -> bool {
+    // Tag is never 0, so an empty slot never matches
+    let tag = u64::from_le_bytes(hash[..8].try_into().unwrap()) | 1;
+    let slot = u64::from_le_bytes(hash[8..16].try_into().unwrap()) as usize % ACCESS_SEEN_SLOTS;
+    ACCESS_SEEN[slot].swap(tag, Ordering::Relaxed) != tag
+}
+
+fn queue_access(hash: &[u8; 32], size: u64, nanos: u64) {
+    let mut buffer = ACCESSES.lock();
+    let len = buffer.len;
+    if len == ACCESS_BUFFER {
+        return;
+    }
+    buffer.blobs[len] = AccessedBlob { hash: *hash, size };
+    buffer.len = len + 1;
+    if len == 0 {
+        ACCESS_PENDING_SINCE.store(nanos, Ordering::Relaxed);
+    }
+    ACCESS_PENDING.store(len + 1, Ordering::Relaxed);
+}
+
+/// argv[0] and the working directory at startup: the prefetcher's key
+fn process_key() -> &'static (String, String) {
+    PROCESS_KEY.get_or_init(|| {
+        let command = std::env::args_os()
+            .next()
+            .map(|arg| arg.to_string_lossy().into_owned())
+            .unwrap_or_default();
+        let cwd = std::env::current_dir()
+            .map(|dir| dir.to_string_lossy().into_owned())
+            .unwrap_or_default();
+        (command, cwd)
+    })
+}
+
+/// Send to vDird without waiting for the answer. Gives up for the rest of
+/// the process if vDird cannot be found.
+unsafe fn send_to_vdird(request: &vrift_ipc::VeloRequest) -> bool {
+    let Some(socket) = crate::ipc::resolve_vdird_socket() else {
+        PREFETCH_OFF.store(true, Ordering::Relaxed);
+        ACCESSES.lock().len = 0;
+        ACCESS_PENDING.store(0, Ordering::Relaxed);
+        return false;
+    };
+    match rkyv::to_bytes::<rkyv::rancor::Error>(request) {
+        Ok(payload) => crate::ipc::send_fire_and_forget_sync(socket, &payload),
+        Err(_) => false,
+    }
+}
+
+/// Worker thread, at startup: let vDird start reading ahead for this command
+pub(crate) fn send_prefetch_hint() {
+    let (command, cwd) = process_key();
+    if command.is_empty() {
+        return;
+    }
+    let request = vrift_ipc::VeloRequest::PrefetchHint {
+        command: command.clone(),
+        cwd: cwd.clone(),
+    };
+    unsafe { send_to_vdird(&request) };
+}
+
+/// Worker thread, when idle: send queued opens once a batch is full or the
+/// oldest has waited `ACCESS_FLUSH_AGE_NS`
+pub(crate) fn flush_accesses() {
+    let pending = ACCESS_PENDING.load(Ordering::Relaxed);
+    if pending == 0
+        || (pending < ACCESS_BATCH
+            && monotonic_ns().saturating_sub(ACCESS_PENDING_SINCE.load(Ordering::Relaxed))
+                < ACCESS_FLUSH_AGE_NS)
+    {
+        return;
+    }
+
+    let blobs = {
+        let mut buffer = ACCESSES.lock();
+        let (len, take) = (buffer.len, buffer.len.min(ACCESS_BATCH));
+        let blobs = buffer.blobs[..take].to_vec();
+        buffer.blobs.copy_within(take..len, 0);
+        buffer.len = len - take;
+        if buffer.len > 0 {
+            ACCESS_PENDING_SINCE.store(monotonic_ns(), Ordering::Relaxed);
+        }
+        ACCESS_PENDING.store(buffer.len, Ordering::Relaxed);
+        blobs
+    };
+    if blobs.is_empty() {
+        return;
+    }
+
+    let (command, cwd) = process_key();
+    let request = vrift_ipc::VeloRequest::AccessTrace {
+        command: command.clone(),
+        cwd: cwd.clone(),
+        blobs,
+    };
+    unsafe { send_to_vdird(&request) };
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    /// Pack in vrift-pack's v2 layout: header, data, fanout, index
+    fn build(blobs: &[([u8; 32], &[u8])]) -> Vec<u8> {
+        let mut sorted: Vec<_> = blobs.to_vec();
+        sorted.sort_by(|a, b| a.0.cmp(&b.0));
+
+        let mut data = Vec::new();
+        let mut index = Vec::new();
+        let mut fanout = [0u32; 256];
+        for (hash, blob) in &sorted {
+            index.extend_from_slice(hash);
+            index.extend_from_slice(&(data.len() as u64).to_le_bytes());
+            index.extend_from_slice(&(blob.len() as u64).to_le_bytes());
+            data.extend_from_slice(blob);
+            fanout[hash[0] as usize] += 1;
+        }
+        for i in 1..256 {
+            fanout[i] += fanout[i - 1];
+        }
+
+        let fanout_offset = (PACK_HEADER_SIZE + data.len()) as u64;
+        let mut out = Vec::new();
+        out.extend_from_slice(PACK_MAGIC);
+        out.extend_from_slice(&PACK_VERSION.to_le_bytes());
+        out.extend_from_slice(&(sorted.len() as u32).to_le_bytes());
+        out.extend_from_slice(&(PACK_HEADER_SIZE as u64).to_le_bytes());
+        out.extend_from_slice(&(data.len() as u64).to_le_bytes());
+        out.extend_from_slice(&fanout_offset.to_le_bytes());
+        out.extend_from_slice(&(fanout_offset + PACK_FANOUT_SIZE as u64).to_le_bytes());
+        out.resize(PACK_HEADER_SIZE, 0);
+        out.extend_from_slice(&data);
+        for count in fanout {
+            out.extend_from_slice(&count.to_le_bytes());
+        }
+        out.extend_from_slice(&index);
+        out
+    }
+
+    #[test]
+    fn test_find_in_mapped_pack() {
+        let blobs = [
+            ([0x00; 32], &b"zero"[..]),
+            ([0x7f; 32], b"mid"),
+            ([0xff; 32], b"last"),
+        ];
+        let bytes = build(&blobs);
+        let pack = PackMap::parse(bytes.as_ptr(), bytes.len()).expect("valid pack");
+
+        for (hash, blob) in &blobs {
+            assert_eq!(pack.find(hash), Some(*blob));
+        }
+        assert_eq!(pack.find(&[0x80; 32]), None);
+        assert!(PackMap::parse(bytes.as_ptr(), bytes.len() - 1).is_none());
+    }
+
+    #[cfg(target_os = "linux")]
+    #[test]
+    fn test_packed_memfd_reopens_share_content_not_offset() {
+        unsafe {
+            let memfd = copy_to_memfd(&[0x42; 32], b"packed blob").expect("memfd");
+            let a = reopen_memfd(memfd, libc::O_CLOEXEC).expect("first open");
+            let b = reopen_memfd(memfd, 0).expect("second open");
+            let mut buf = [0u8; 16];
+            assert_eq!(libc::read(a, buf.as_mut_ptr() as *mut _, buf.len()), 11);
+            assert_eq!(libc::read(b, buf.as_mut_ptr() as *mut _, 6), 6);
+            assert_eq!(&buf[..6], b"packed");
+            assert_eq!(libc::fcntl(b, libc::F_GETFD), 0);
+            assert!(libc::write(b, b"x".as_ptr() as *const _, 1) < 0);
+
+            // The cached fd number now names another file: open loose
+            let other = libc::memfd_create(c"other".as_ptr(), libc::MFD_CLOEXEC);
+            assert_eq!(libc::dup2(other, memfd.fd), memfd.fd);
+            assert!(reopen_memfd(memfd, 0).is_none());
+            for fd in [a, b, other, memfd.fd] {
+                libc::close(fd);
+            }
+        }
+    }
+}
@@ -2,7 +2,8 @@ use libc::{c_char, c_int, AT_FDCWD};
 use std::ffi::CStr;
 use std::ptr;
 
-use crate::state::FixedString;
+use crate::state::{FixedString, RESOLVE_CACHE};
+use vrift_ipc::vdir_types::VDirKey;
 
 /// RFC-0049: Unified path resolution for VFS domain.
 /// Encapsulates absolute path and the corresponding manifest key.
@@ -16,6 +17,8 @@ pub(crate) struct VfsPath {
 pub(crate) struct PathResolver {
     pub vfs_prefix: FixedString<256>,
     pub project_root: FixedString<1024>,
+    /// Identifies this configuration in the shared RESOLVE_CACHE
+    fingerprint: u64,
 }
 
 impl PathResolver {
@@ -24,20 +27,41 @@ impl PathResolver {
         prefix.set(vfs_prefix);
         let mut root = FixedString::new();
         root.set(project_root);
+        let fingerprint = vrift_ipc::fnv1a_hash(prefix.as_str())
+            ^ vrift_ipc::fnv1a_hash(root.as_str()).rotate_left(32);
         Self {
             vfs_prefix: prefix,
             project_root: root,
+            fingerprint,
         }
     }
 
     /// Resolve an incoming path (absolute or relative) into a VfsPath.
     /// Returns None if the path is not within the VFS domain.
+    /// Repeated paths are answered from RESOLVE_CACHE.
     pub fn resolve(&self, path: &str) -> Option<VfsPath> {
         // RFC-0050: Early exit if VFS is not configured
         if self.vfs_prefix.is_empty() {
             return None;
         }
 
+        let raw = VDirKey::from_path(path);
+        if let Some(cached) = RESOLVE_CACHE.lookup(raw.path_hash, raw.path_check, self.fingerprint)
+        {
+            return cached;
+        }
+        let resolved = self.resolve_uncached(path);
+        RESOLVE_CACHE.insert(
+            raw.path_hash,
+            raw.path_check,
+            self.fingerprint,
+            resolved.as_ref(),
+        );
+        resolved
+    }
+
+    /// Full resolution: join, normalize, check the prefix, extract the key
+    fn resolve_uncached(&self, path: &str) -> Option<VfsPath> {
         let mut abs_buf = [0u8; 1024];
         let mut abs_writer = crate::macros::StackWriter::new(&mut abs_buf);
         use std::fmt::Write;
@@ -286,3 +310,47 @@ pub(crate) unsafe fn resolve_path_at(
     // Cannot resolve relative path to arbitrary dirfd easily without OS help.
     None
 }
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    fn parts(vpath: Option<VfsPath>) -> Option<(String, String, u64)> {
+        vpath.map(|v| {
+            (
+                v.absolute.as_str().to_string(),
+                v.manifest_key.as_str().to_string(),
+                v.manifest_key_hash,
+            )
+        })
+    }
+
+    #[test]
+    fn test_resolve_cache_matches_uncached() {
+        let resolver = PathResolver::new("/proj", "/proj");
+        for path in [
+            "/proj/src/a.rs",
+            "src/a.rs",
+            "/proj/../proj/b//c.h",
+            "/proj",
+            "/usr/include/stdio.h",
+            "/projx/a",
+        ] {
+            let expected = parts(resolver.resolve_uncached(path));
+            assert_eq!(parts(resolver.resolve(path)), expected, "{}", path); // Fills
+            assert_eq!(parts(resolver.resolve(path)), expected, "{}", path); // Cached
+        }
+        assert_eq!(
+            parts(resolver.resolve("src/a.rs")).unwrap().1,
+            "/src/a.rs".to_string()
+        );
+
+        // Same raw path under another configuration is resolved afresh
+        let other = PathResolver::new("/other", "/other");
+        assert!(other.resolve("/proj/src/a.rs").is_none());
+        assert_eq!(
+            parts(other.resolve("src/a.rs")).unwrap().0,
+            "/other/src/a.rs"
+        );
+    }
+}
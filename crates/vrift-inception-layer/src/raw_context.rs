@@ -110,6 +110,19 @@ impl RawContext {
         }
     }
 
+    /// Raw fstat syscall. Avoids interposed `fstat_inception`.
+    #[inline(always)]
+    pub unsafe fn fstat(&self, fd: c_int, buf: *mut libc::stat) -> c_int {
+        #[cfg(target_os = "macos")]
+        {
+            crate::syscalls::macos_raw::raw_fstat64(fd, buf)
+        }
+        #[cfg(target_os = "linux")]
+        {
+            crate::syscalls::linux_raw::raw_fstat(fd, buf)
+        }
+    }
+
     // =========================================================================
     // Composite I/O helpers — higher-level operations built on raw primitives
     // =========================================================================
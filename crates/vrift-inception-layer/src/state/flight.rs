@@ -0,0 +1,551 @@
+// =============================================================================
+// state/flight.rs — Flight Recorder (RFC-0039 §82)
+// =============================================================================
+//
+// Always-on structured event trace. Every thread claims its own ring segment
+// on its first event and writes there only, so recording never shares a
+// cache line with another thread. Segments are static: nothing allocates,
+// and lookups never touch TLS (the owner is found by hashing pthread_self()).
+//
+// Entries carry raw clock ticks (TSC / CNTVCT, see ticks()) and, for events
+// that end an operation, the ticks it took. `VRIFT_FLIGHT_DUMP=<prefix>`
+// writes the binary dump (vrift_ipc::flight) to `<prefix>.<pid>` on SIGUSR2
+// and at exit; `vrift trace` decodes it.
+//
+// A claim also sets a pthread key whose destructor frees the segment when
+// the thread exits, so only more than FLIGHT_SEGMENTS live threads share
+// one: the extra ones write to their hashed segment (entries may then be
+// torn, as with the old global ring). The freed segment keeps its entries
+// until its next owner overwrites them.
+// =============================================================================
+
+use libc::c_void;
+use std::cell::UnsafeCell;
+use std::ffi::CStr;
+use std::sync::atomic::{AtomicU32, AtomicU64, AtomicUsize, Ordering};
+use vrift_ipc::flight::{FlightDumpHeader, FLIGHT_ENTRY_SIZE};
+
+pub use vrift_ipc::flight::{FlightEntry, EVENT_NAMES};
+
+#[repr(u8)]
+#[derive(Debug, Clone, Copy, PartialEq, Eq)]
+pub enum EventType {
+    OpenHit = 1,
+    OpenMiss = 2,
+    StatHit = 3,
+    StatMiss = 4,
+    CowTriggered = 5,
+    IpcFail = 6,
+    IpcSuccess = 7,
+    CircuitTripped = 8,
+    VfsInit = 9,
+    Close = 10,
+    ReingestSuccess = 11,
+    ReingestFail = 12,
+}
+
+pub const FLIGHT_SEGMENTS: usize = 64;
+pub const SEGMENT_ENTRIES: usize = 1024; // 64 * 1K entries * 32 bytes = 2MB (bss)
+
+/// Segments probed for a thread's own or a free one before sharing
+const SEGMENT_PROBE: usize = 8;
+
+#[repr(C, align(64))]
+pub struct Segment {
+    /// pthread_self() of the owning thread, 0 = free
+    owner: AtomicUsize,
+    tid: AtomicU32,
+    head: AtomicUsize,
+    entries: [UnsafeCell<FlightEntry>; SEGMENT_ENTRIES],
+}
+
+impl Segment {
+    #[allow(clippy::large_stack_frames)] // const fn for static init — never on runtime stack
+    const fn new() -> Self {
+        Self {
+            owner: AtomicUsize::new(0),
+            tid: AtomicU32::new(0),
+            head: AtomicUsize::new(0),
+            entries: [const { UnsafeCell::new(FlightEntry::EMPTY) }; SEGMENT_ENTRIES],
+        }
+    }
+
+    /// Entries recorded so far (including overwritten ones)
+    fn recorded(&self) -> usize {
+        self.head.load(Ordering::Acquire)
+    }
+
+    /// Retained entries, oldest first. Reads race with the owner; an entry
+    /// being overwritten may come out torn.
+    fn for_each(&self, head: usize, mut f: impl FnMut(&FlightEntry)) {
+        for i in head.saturating_sub(SEGMENT_ENTRIES)..head {
+            let entry = unsafe { std::ptr::read_volatile(self.entries[i % SEGMENT_ENTRIES].get()) };
+            f(&entry);
+        }
+    }
+}
+
+pub struct FlightRecorder {
+    segments: [Segment; FLIGHT_SEGMENTS],
+}
+
+// Safety: entries are plain data written through UnsafeCell by the owning
+// thread (or, when shared, by whoever took the slot from `head`).
+unsafe impl Sync for FlightRecorder {}
+
+impl FlightRecorder {
+    #[allow(clippy::large_stack_frames)] // const fn for static init — never on runtime stack
+    pub const fn new() -> Self {
+        Self {
+            segments: [const { Segment::new() }; FLIGHT_SEGMENTS],
+        }
+    }
+}
+
+impl Default for FlightRecorder {
+    #[allow(clippy::large_stack_frames)] // delegates to const fn new() for static init
+    fn default() -> Self {
+        Self::new()
+    }
+}
+
+impl FlightRecorder {
+    #[inline(always)]
+    pub fn record(&self, event: EventType, file_id: u64, result: i32, duration: u64) {
+        let seg = self.segment();
+        let idx = seg.head.fetch_add(1, Ordering::Release) % SEGMENT_ENTRIES;
+        // Safety: the slot belongs to this thread until the ring wraps
+        unsafe {
+            *seg.entries[idx].get() = FlightEntry {
+                timestamp: ticks(),
+                file_id,
+                duration: duration.min(u32::MAX as u64) as u32,
+                tid: seg.tid.load(Ordering::Relaxed),
+                result,
+                event_type: event as u8,
+                _pad: [0; 3],
+            };
+        }
+    }
+
+    /// The calling thread's segment, claimed on first use
+    #[inline(always)]
+    fn segment(&self) -> &Segment {
+        let me = unsafe { libc::pthread_self() } as usize;
+        let start = ((me as u64).wrapping_mul(0x9E3779B97F4A7C15) >> 58) as usize;
+        for i in 0..SEGMENT_PROBE {
+            let seg = &self.segments[(start + i) % FLIGHT_SEGMENTS];
+            let owner = seg.owner.load(Ordering::Relaxed);
+            if owner == me {
+                return seg;
+            }
+            if owner == 0
+                && seg
+                    .owner
+                    .compare_exchange(0, me, Ordering::AcqRel, Ordering::Relaxed)
+                    .is_ok()
+            {
+                seg.tid.store(current_tid(), Ordering::Relaxed);
+                release_on_exit(seg);
+                return seg;
+            }
+        }
+        &self.segments[start % FLIGHT_SEGMENTS]
+    }
+
+    /// Per-event-type counts over the retained entries; returns the number
+    /// of events recorded since startup
+    pub fn event_counts(&self, counts: &mut [u32]) -> u64 {
+        let mut total = 0u64;
+        for seg in &self.segments {
+            let head = seg.recorded();
+            total += head as u64;
+            seg.for_each(head, |e| {
+                if let Some(c) = counts.get_mut(e.event_type as usize) {
+                    *c += 1;
+                }
+            });
+        }
+        total
+    }
+}
+
+pub static FLIGHT_RECORDER: FlightRecorder = FlightRecorder::new();
+
+/// pthread key (+ 1; 0 = not created yet) holding the calling thread's
+/// claimed segment, freed by its destructor
+static SEGMENT_KEY: AtomicUsize = AtomicUsize::new(0);
+
+/// Free `seg` when the calling thread exits. Recorders are never dropped
+/// (static, or leaked in tests), so the pointer outlives the thread.
+#[cold]
+fn release_on_exit(seg: &Segment) {
+    // No pthread_key_create() during dyld's initialization (see
+    // InceptionLayerGuard::enter); threads claiming that early keep theirs
+    #[cfg(all(target_os = "macos", not(test)))]
+    if super::INCEPTION_LAYER_STATE
+        .load(Ordering::Acquire)
+        .is_null()
+    {
+        return;
+    }
+    let mut key = SEGMENT_KEY.load(Ordering::Acquire);
+    if key == 0 {
+        let mut created: libc::pthread_key_t = 0;
+        if unsafe { libc::pthread_key_create(&mut created, Some(release_segment)) } != 0 {
+            return; // Keys exhausted: the segment stays claimed
+        }
+        key = match SEGMENT_KEY.compare_exchange(
+            0,
+            created as usize + 1,
+            Ordering::AcqRel,
+            Ordering::Acquire,
+        ) {
+            Ok(_) => created as usize + 1,
+            Err(raced) => {
+                unsafe { libc::pthread_key_delete(created) };
+                raced
+            }
+        };
+    }
+    unsafe {
+        libc::pthread_setspecific(
+            (key - 1) as libc::pthread_key_t,
+            seg as *const Segment as *const c_void,
+        )
+    };
+}
+
+/// Key destructor: give the exiting thread's segment back
+unsafe extern "C" fn release_segment(seg: *mut c_void) {
+    let seg = &*(seg as *const Segment);
+    let me = libc::pthread_self() as usize;
+    // Release: our entries are complete before the next owner claims it
+    let _ = seg
+        .owner
+        .compare_exchange(me, 0, Ordering::Release, Ordering::Relaxed);
+}
+
+/// OS thread id, once per segment claim
+fn current_tid() -> u32 {
+    #[cfg(target_os = "linux")]
+    unsafe {
+        libc::syscall(libc::SYS_gettid) as u32
+    }
+    #[cfg(target_os = "macos")]
+    unsafe {
+        let mut tid = 0u64;
+        libc::pthread_threadid_np(0 as libc::pthread_t, &mut tid);
+        tid as u32
+    }
+}
+
+/// Cheapest monotonic clock: TSC on x86_64, the virtual counter on aarch64,
+/// CLOCK_MONOTONIC ns elsewhere. The dump header converts ticks to ns.
+#[inline(always)]
+pub fn ticks() -> u64 {
+    #[cfg(target_arch = "x86_64")]
+    unsafe {
+        std::arch::x86_64::_rdtsc()
+    }
+    #[cfg(target_arch = "aarch64")]
+    unsafe {
+        let cnt: u64;
+        std::arch::asm!("mrs {}, cntvct_el0", out(reg) cnt, options(nomem, nostack));
+        cnt
+    }
+    #[cfg(not(any(target_arch = "x86_64", target_arch = "aarch64")))]
+    {
+        monotonic_ns()
+    }
+}
+
+pub(crate) fn monotonic_ns() -> u64 {
+    let mut ts = libc::timespec {
+        tv_sec: 0,
+        tv_nsec: 0,
+    };
+    unsafe { libc::clock_gettime(libc::CLOCK_MONOTONIC, &mut ts) };
+    ts.tv_sec as u64 * 1_000_000_000 + ts.tv_nsec as u64
+}
+
+// (ticks, ns) sample taken at init; the dump adds a second one
+static BASE_TICKS: AtomicU64 = AtomicU64::new(0);
+static BASE_NS: AtomicU64 = AtomicU64::new(0);
+
+pub(crate) fn calibrate() {
+    BASE_NS.store(monotonic_ns(), Ordering::Relaxed);
+    BASE_TICKS.store(ticks(), Ordering::Relaxed);
+}
+
+// ============================================================================
+// Dumps
+// ============================================================================
+
+const DUMP_PREFIX_MAX: usize = 256;
+
+struct DumpPrefix(UnsafeCell<[u8; DUMP_PREFIX_MAX]>);
+// Safety: written once in arm_binary_dump() before DUMP_PREFIX_LEN publishes it
+unsafe impl Sync for DumpPrefix {}
+
+static DUMP_PREFIX: DumpPrefix = DumpPrefix(UnsafeCell::new([0; DUMP_PREFIX_MAX]));
+static DUMP_PREFIX_LEN: AtomicUsize = AtomicUsize::new(0);
+
+/// Arm the binary dump if `VRIFT_FLIGHT_DUMP` is set: SIGUSR2 and exit
+/// write `<prefix>.<pid>`
+pub(crate) unsafe fn arm_binary_dump() {
+    let val = libc::getenv(c"VRIFT_FLIGHT_DUMP".as_ptr());
+    if val.is_null() {
+        return;
+    }
+    let prefix = CStr::from_ptr(val).to_bytes();
+    if prefix.is_empty()
+        || prefix.len() > DUMP_PREFIX_MAX
+        || DUMP_PREFIX_LEN.load(Ordering::Acquire) != 0
+    {
+        return;
+    }
+    let buf = &mut *DUMP_PREFIX.0.get();
+    buf[..prefix.len()].copy_from_slice(prefix);
+    DUMP_PREFIX_LEN.store(prefix.len(), Ordering::Release);
+
+    extern "C" fn handle_sigusr2(_sig: libc::c_int) {
+        vfs_write_flight_dump();
+    }
+    extern "C" fn dump_atexit() {
+        vfs_write_flight_dump();
+    }
+    let mut action: libc::sigaction = std::mem::zeroed();
+    action.sa_sigaction = handle_sigusr2 as usize;
+    action.sa_flags = libc::SA_RESTART;
+    libc::sigemptyset(&mut action.sa_mask);
+    libc::sigaction(libc::SIGUSR2, &action, std::ptr::null_mut());
+    libc::atexit(dump_atexit);
+}
+
+unsafe fn write_all(fd: libc::c_int, mut bytes: &[u8]) -> bool {
+    while !bytes.is_empty() {
+        #[cfg(target_os = "macos")]
+        let n =
+            crate::syscalls::macos_raw::raw_write(fd, bytes.as_ptr() as *const c_void, bytes.len());
+        #[cfg(target_os = "linux")]
+        let n =
+            crate::syscalls::linux_raw::raw_write(fd, bytes.as_ptr() as *const c_void, bytes.len());
+        if n <= 0 {
+            return false;
+        }
+        bytes = &bytes[n as usize..];
+    }
+    true
+}
+
+/// Write the binary dump to `<VRIFT_FLIGHT_DUMP>.<pid>`. Async-signal-safe:
+/// raw syscalls and stack buffers only.
+pub fn vfs_write_flight_dump() -> bool {
+    let len = DUMP_PREFIX_LEN.load(Ordering::Acquire);
+    if len == 0 {
+        return false;
+    }
+    let pid = unsafe { libc::getpid() };
+
+    let mut path = [0u8; DUMP_PREFIX_MAX + 16];
+    let prefix = unsafe { &*DUMP_PREFIX.0.get() };
+    path[..len].copy_from_slice(&prefix[..len]);
+    let mut suffix = [0u8; 15];
+    let mut writer = crate::macros::StackWriter::new(&mut suffix);
+    use std::fmt::Write;
+    let _ = write!(writer, ".{}", pid);
+    let suffix = writer.as_str().as_bytes();
+    path[len..len + suffix.len()].copy_from_slice(suffix);
+
+    let flags = libc::O_WRONLY | libc::O_CREAT | libc::O_TRUNC | libc::O_CLOEXEC;
+    #[cfg(target_os = "macos")]
+    let fd = unsafe {
+        crate::syscalls::macos_raw::raw_openat(libc::AT_FDCWD, path.as_ptr() as _, flags, 0o644)
+    };
+    #[cfg(target_os = "linux")]
+    let fd = unsafe {
+        crate::syscalls::linux_raw::raw_openat(libc::AT_FDCWD, path.as_ptr() as _, flags, 0o644)
+    };
+    if fd < 0 {
+        return false;
+    }
+
+    // Fix each segment's extent first so the header count matches the body
+    let mut heads = [0usize; FLIGHT_SEGMENTS];
+    let mut count = 0u64;
+    for (head, seg) in heads.iter_mut().zip(&FLIGHT_RECORDER.segments) {
+        *head = seg.recorded();
+        count += (*head).min(SEGMENT_ENTRIES) as u64;
+    }
+    let header = FlightDumpHeader {
+        pid: pid as u32,
+        count,
+        base_ticks: BASE_TICKS.load(Ordering::Relaxed),
+        base_ns: BASE_NS.load(Ordering::Relaxed),
+        dump_ns: monotonic_ns(),
+        dump_ticks: ticks(),
+    };
+
+    let mut ok = unsafe { write_all(fd, &header.to_bytes()) };
+    let mut chunk = [0u8; 64 * FLIGHT_ENTRY_SIZE];
+    let mut used = 0;
+    for (&head, seg) in heads.iter().zip(&FLIGHT_RECORDER.segments) {
+        seg.for_each(head, |e| {
+            chunk[used..used + FLIGHT_ENTRY_SIZE].copy_from_slice(&e.to_bytes());
+            used += FLIGHT_ENTRY_SIZE;
+            if used == chunk.len() {
+                ok &= unsafe { write_all(fd, &chunk) };
+                used = 0;
+            }
+        });
+    }
+    ok &= unsafe { write_all(fd, &chunk[..used]) };
+
+    #[cfg(target_os = "macos")]
+    unsafe {
+        crate::syscalls::macos_raw::raw_close(fd)
+    };
+    #[cfg(target_os = "linux")]
+    unsafe {
+        crate::syscalls::linux_raw::raw_close(fd)
+    };
+    ok
+}
+
+/// Text dump of the retained entries to stderr, per thread
+pub fn vfs_dump_flight_recorder() {
+    // Use a fixed buffer to avoid allocations during dump
+    let mut buf = [0u8; 256];
+    use std::fmt::Write;
+
+    let emit = |msg: &str| {
+        let _ = unsafe { libc::write(2, msg.as_ptr() as *const c_void, msg.len()) };
+    };
+
+    let pid = unsafe { libc::getpid() };
+    let mut wrapper = crate::macros::StackWriter::new(&mut buf);
+    let _ = write!(
+        wrapper,
+        "\n--- [VFS] Flight Recorder Dump (PID: {}) ---\n",
+        pid
+    );
+    emit(wrapper.as_str());
+
+    for seg in &FLIGHT_RECORDER.segments {
+        seg.for_each(seg.recorded(), |entry| {
+            if entry.event_type == 0 {
+                return;
+            }
+            let event_name = EVENT_NAMES
+                .get(entry.event_type as usize)
+                .unwrap_or(&"INVALID");
+
+            let mut wrapper = crate::macros::StackWriter::new(&mut buf);
+            let _ = writeln!(
+                wrapper,
+                "[{:>15}] T{:<7} {:<16} ID:0x{:016x} RES:{} DUR:{}",
+                entry.timestamp, entry.tid, event_name, entry.file_id, entry.result, entry.duration
+            );
+            emit(wrapper.as_str());
+        });
+    }
+    emit("--- End of Dump ---\n");
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    // 2MB: build it zeroed on the heap, not on the test thread's stack
+    fn leaked_recorder() -> &'static FlightRecorder {
+        let layout = std::alloc::Layout::new::<FlightRecorder>();
+        unsafe { &*(std::alloc::alloc_zeroed(layout) as *const FlightRecorder) }
+    }
+
+    #[test]
+    fn test_threads_record_into_own_segments() {
+        let recorder = leaked_recorder();
+        // Keep all threads alive so none reuses another's pthread_t
+        let barrier: &'static std::sync::Barrier = Box::leak(Box::new(std::sync::Barrier::new(4)));
+        let threads: Vec<_> = (0..4)
+            .map(|_| {
+                std::thread::spawn(move || {
+                    for i in 0..10 {
+                        recorder.record(EventType::StatHit, i, 0, 5);
+                    }
+                    let seg = recorder.segment() as *const Segment as usize;
+                    barrier.wait();
+                    seg
+                })
+            })
+            .collect();
+        let segs: Vec<usize> = threads.into_iter().map(|t| t.join().unwrap()).collect();
+        for (i, a) in segs.iter().enumerate() {
+            assert!(!segs[i + 1..].contains(a), "threads shared a segment");
+        }
+
+        let mut counts = [0u32; 16];
+        assert_eq!(recorder.event_counts(&mut counts), 40);
+        assert_eq!(counts[EventType::StatHit as usize], 40);
+    }
+
+    #[test]
+    fn test_exited_threads_free_their_segments() {
+        let recorder = leaked_recorder();
+        let run = |threads: usize| -> Vec<(usize, bool)> {
+            let barrier: &'static std::sync::Barrier =
+                Box::leak(Box::new(std::sync::Barrier::new(threads)));
+            let handles: Vec<_> = (0..threads)
+                .map(|_| {
+                    std::thread::spawn(move || {
+                        recorder.record(EventType::OpenHit, 0, 0, 0);
+                        let seg = recorder.segment();
+                        let fresh = seg.tid.load(Ordering::Relaxed) == current_tid();
+                        barrier.wait();
+                        (seg as *const Segment as usize, fresh)
+                    })
+                })
+                .collect();
+            handles.into_iter().map(|t| t.join().unwrap()).collect()
+        };
+
+        // As many threads as segments claim theirs, then exit
+        run(FLIGHT_SEGMENTS);
+        let owned = recorder
+            .segments
+            .iter()
+            .filter(|s| s.owner.load(Ordering::Relaxed) != 0)
+            .count();
+        assert_eq!(owned, 0, "segments of exited threads still claimed");
+
+        let segs = run(4);
+        for (i, (seg, fresh)) in segs.iter().enumerate() {
+            assert!(fresh, "thread inherited an exited thread's tid");
+            assert!(
+                !segs[i + 1..].iter().any(|(other, _)| other == seg),
+                "threads shared a segment"
+            );
+        }
+        let mut counts = [0u32; 16];
+        assert_eq!(
+            recorder.event_counts(&mut counts),
+            FLIGHT_SEGMENTS as u64 + 4
+        );
+    }
+
+    #[test]
+    fn test_segment_keeps_newest_entries() {
+        let recorder = leaked_recorder();
+        for i in 0..(SEGMENT_ENTRIES as u64 + 10) {
+            recorder.record(EventType::OpenHit, i, 0, 0);
+        }
+        let seg = recorder.segment();
+        let mut ids = Vec::new();
+        seg.for_each(seg.recorded(), |e| ids.push(e.file_id));
+        assert_eq!(ids.len(), SEGMENT_ENTRIES);
+        assert_eq!(ids[0], 10);
+        assert_eq!(*ids.last().unwrap(), SEGMENT_ENTRIES as u64 + 9);
+        assert!(ids.windows(2).all(|w| w[0] < w[1]));
+    }
+}
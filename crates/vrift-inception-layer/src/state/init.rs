@@ -22,6 +22,7 @@ use std::ffi::CStr;
 use std::path::PathBuf;
 use std::ptr;
 use std::sync::atomic::Ordering;
+use vrift_ipc::mutation_ring::MutationRing;
 
 use super::{
     FixedString, IdentityBuildHasher, InceptionLayerState, LogLevel, CIRCUIT_BREAKER_THRESHOLD,
@@ -210,7 +211,7 @@ impl InceptionLayerState {
             socket_path.set(&unsafe { CStr::from_ptr(socket_ptr).to_string_lossy() });
         }
 
-        let (mmap_ptr, mmap_size) = open_manifest_mmap();
+        let (mmap_ptr, mmap_size, mutation_ring) = open_manifest_mmap();
 
         let mut project_root_fs = FixedString::<1024>::new();
         let manifest_ptr = unsafe { libc::getenv(c"VRIFT_MANIFEST".as_ptr()) };
@@ -345,6 +346,7 @@ impl InceptionLayerState {
                     bloom_ptr: ptr::null(),
                     mmap_ptr,
                     mmap_size,
+                    mutation_ring,
                     project_root: project_root_fs,
                     path_resolver: PathResolver::new(vfs_prefix.as_str(), project_root_fs.as_str()),
                     cached_soft_limit: std::sync::atomic::AtomicUsize::new(soft_limit),
@@ -354,6 +356,15 @@ impl InceptionLayerState {
             );
         }
 
+        // Linux C bridge: absolute paths outside the prefix skip Rust entirely
+        #[cfg(target_os = "linux")]
+        if vfs_prefix.len > 0 {
+            extern "C" {
+                fn vrift_publish_vfs_prefix(prefix: *const u8, len: usize);
+            }
+            unsafe { vrift_publish_vfs_prefix(vfs_prefix.data.as_ptr(), vfs_prefix.len) };
+        }
+
         // Perform proactive environment audit (Safe: uses getenv and safe logger)
         unsafe { Self::audit_environment() };
 
@@ -419,14 +430,16 @@ impl InceptionLayerState {
 // =============================================================================
 
 /// Open mmap'd manifest file for O(1) stat lookup.
-/// Returns (ptr, size) or (null, 0) if unavailable.
+/// Returns (ptr, mapping length, mutation ring) or (null, 0, None) if
+/// unavailable. The length is the reserved mapping, which is what munmap needs.
+/// The mutation ring is only attached next to a VDir (not a legacy manifest).
 /// Uses raw libc to avoid recursion through inception layer.
 /// BUG-007b: MUST NOT be inlined — allocates large stack buffers (PATH_MAX etc.)
 /// that would overflow the 512KB default pthread stack if merged into get().
 #[inline(never)]
 #[cold]
 #[allow(deprecated)]
-pub(crate) fn open_manifest_mmap() -> (*const u8, usize) {
+pub(crate) fn open_manifest_mmap() -> (*const u8, usize, Option<MutationRing>) {
     // Check if mmap is explicitly disabled
     unsafe {
         let env_key = c"VRIFT_DISABLE_MMAP";
@@ -434,7 +447,7 @@ pub(crate) fn open_manifest_mmap() -> (*const u8, usize) {
         if !env_val.is_null() {
             let val = CStr::from_ptr(env_val).to_str().unwrap_or("0");
             if val == "1" || val == "true" {
-                return (ptr::null(), 0);
+                return (ptr::null(), 0, None);
             }
         }
     }
@@ -455,7 +468,7 @@ pub(crate) fn open_manifest_mmap() -> (*const u8, usize) {
         // Fallback: Derive from VRIFT_MANIFEST (legacy path)
         let manifest_ptr = unsafe { libc::getenv(c"VRIFT_MANIFEST".as_ptr()) };
         if manifest_ptr.is_null() {
-            return (ptr::null(), 0);
+            return (ptr::null(), 0, None);
         }
 
         let root_bytes = unsafe { CStr::from_ptr(manifest_ptr).to_bytes() };
@@ -532,7 +545,7 @@ pub(crate) fn open_manifest_mmap() -> (*const u8, usize) {
         )
     };
     if fd < 0 {
-        return (ptr::null(), 0);
+        return (ptr::null(), 0, None);
     }
 
     // Get file size via fstat
@@ -550,33 +563,58 @@ pub(crate) fn open_manifest_mmap() -> (*const u8, usize) {
         unsafe {
             crate::syscalls::linux_raw::raw_close(fd)
         };
-        return (ptr::null(), 0);
+        return (ptr::null(), 0, None);
     }
     let size = stat_buf.st_size as usize;
+    if size < vrift_ipc::vdir_types::VDIR_HEADER_SIZE {
+        #[cfg(target_os = "macos")]
+        unsafe {
+            crate::syscalls::macos_raw::raw_close(fd)
+        };
+        #[cfg(target_os = "linux")]
+        unsafe {
+            crate::syscalls::linux_raw::raw_close(fd)
+        };
+        return (ptr::null(), 0, None);
+    }
 
-    // mmap the file read-only
-    #[cfg(target_os = "macos")]
-    let ptr = unsafe {
-        crate::syscalls::macos_raw::raw_mmap(
-            ptr::null_mut(),
-            size,
-            libc::PROT_READ,
-            libc::MAP_SHARED, // Phase 1.3: MAP_SHARED for real-time vDird visibility
-            fd,
-            0,
-        )
-    };
-    #[cfg(target_os = "linux")]
-    let ptr = unsafe {
-        crate::syscalls::linux_raw::raw_mmap(
-            ptr::null_mut(),
-            size,
-            libc::PROT_READ,
-            libc::MAP_SHARED, // Phase 1.3: MAP_SHARED for real-time vDird visibility
-            fd,
-            0,
-        )
-    };
+    // mmap the file read-only. Reserve VDIR_MAP_RESERVE of address space:
+    // vDird grows the file on resize and pages past today's EOF become valid
+    // in this same mapping once it does (lookups are bounded by the header's
+    // file_size, so no page past EOF is ever touched). Retry with the exact
+    // size if the reservation is refused (e.g. RLIMIT_AS).
+    let reserve = vrift_ipc::vdir_types::VDIR_MAP_RESERVE.max(size);
+    let mut map_len = reserve;
+    let mut ptr = libc::MAP_FAILED;
+    for len in [reserve, size] {
+        #[cfg(target_os = "macos")]
+        let mapped = unsafe {
+            crate::syscalls::macos_raw::raw_mmap(
+                ptr::null_mut(),
+                len,
+                libc::PROT_READ,
+                libc::MAP_SHARED, // Phase 1.3: MAP_SHARED for real-time vDird visibility
+                fd,
+                0,
+            )
+        };
+        #[cfg(target_os = "linux")]
+        let mapped = unsafe {
+            crate::syscalls::linux_raw::raw_mmap(
+                ptr::null_mut(),
+                len,
+                libc::PROT_READ,
+                libc::MAP_SHARED, // Phase 1.3: MAP_SHARED for real-time vDird visibility
+                fd,
+                0,
+            )
+        };
+        if mapped != libc::MAP_FAILED {
+            ptr = mapped;
+            map_len = len;
+            break;
+        }
+    }
     #[cfg(target_os = "macos")]
     unsafe {
         crate::syscalls::macos_raw::raw_close(fd)
@@ -587,29 +625,138 @@ pub(crate) fn open_manifest_mmap() -> (*const u8, usize) {
     };
 
     if ptr == libc::MAP_FAILED {
-        return (ptr::null(), 0);
+        return (ptr::null(), 0, None);
     }
 
     // Phase 1.3: Validate VDirHeader magic instead of ManifestMmapHeader
-    use vrift_ipc::vdir_types::{VDIR_HEADER_SIZE, VDIR_MAGIC};
-    if size < VDIR_HEADER_SIZE {
-        unsafe { libc::munmap(ptr, size) };
-        return (ptr::null(), 0);
-    }
+    use vrift_ipc::vdir_types::VDIR_MAGIC;
     let magic = unsafe { *(ptr as *const u32) };
     if magic != VDIR_MAGIC {
         // Fallback: Try legacy ManifestMmapHeader format
         if size >= vrift_ipc::ManifestMmapHeader::SIZE {
             let header = unsafe { &*(ptr as *const vrift_ipc::ManifestMmapHeader) };
             if header.is_valid() {
-                return (ptr as *const u8, size);
+                return (ptr as *const u8, map_len, None);
             }
         }
+        unsafe { libc::munmap(ptr, map_len) };
+        return (ptr::null(), 0, None);
+    }
+
+    let ring = open_mutation_ring(&path_buf);
+    open_metrics(&path_buf);
+    (ptr as *const u8, map_len, ring)
+}
+
+/// Map the vDird mutation ring (`<vdir_path>.ring`) read-write.
+/// `vdir_path` is the NUL-terminated VDir path. Returns None if vDird has not
+/// created the ring (older vDird) — mutations then go over the socket.
+#[inline(never)]
+#[cold]
+fn open_mutation_ring(vdir_path: &[u8]) -> Option<MutationRing> {
+    use vrift_ipc::mutation_ring::{mutation_ring_size, MUTATION_RING_SUFFIX};
+
+    let size = mutation_ring_size();
+    let ptr = map_vdir_sidecar(vdir_path, MUTATION_RING_SUFFIX, size)?;
+    let ring = unsafe { MutationRing::attach(ptr as *mut u8, size) };
+    if ring.is_none() {
+        unsafe { libc::munmap(ptr, size) };
+    }
+    ring
+}
+
+/// Map the vDird metrics file (`<vdir_path>.metrics`) read-write and claim
+/// this process's counter slot. Without it (older vDird) nothing is counted.
+#[inline(never)]
+#[cold]
+fn open_metrics(vdir_path: &[u8]) {
+    use vrift_ipc::metrics::{metrics_file_size, METRICS_SUFFIX};
+
+    let size = metrics_file_size();
+    let Some(ptr) = map_vdir_sidecar(vdir_path, METRICS_SUFFIX, size) else {
+        return;
+    };
+    if !unsafe { super::metrics::attach(ptr as *mut u8, size) } {
         unsafe { libc::munmap(ptr, size) };
-        return (ptr::null(), 0);
     }
+}
 
-    (ptr as *const u8, size)
+/// MAP_SHARED read-write mapping of `<vdir_path><suffix>`, if vDird created
+/// it with at least `size` bytes
+fn map_vdir_sidecar(vdir_path: &[u8], suffix: &str, size: usize) -> Option<*mut c_void> {
+    let path_len = vdir_path.iter().position(|&b| b == 0)?;
+    let suffix = suffix.as_bytes();
+    let mut sidecar_path = [0u8; 1024];
+    if path_len + suffix.len() + 1 > sidecar_path.len() {
+        return None;
+    }
+    sidecar_path[..path_len].copy_from_slice(&vdir_path[..path_len]);
+    sidecar_path[path_len..path_len + suffix.len()].copy_from_slice(suffix);
+    let sidecar_path_ptr = sidecar_path.as_ptr() as *const libc::c_char;
+
+    #[cfg(target_os = "macos")]
+    let fd = unsafe {
+        crate::syscalls::macos_raw::raw_open(sidecar_path_ptr, libc::O_RDWR | libc::O_CLOEXEC, 0)
+    };
+    #[cfg(target_os = "linux")]
+    let fd = unsafe {
+        crate::syscalls::linux_raw::raw_openat(
+            libc::AT_FDCWD,
+            sidecar_path_ptr,
+            libc::O_RDWR | libc::O_CLOEXEC,
+            0,
+        )
+    };
+    if fd < 0 {
+        return None;
+    }
+
+    let mut stat_buf: libc::stat = unsafe { std::mem::zeroed() };
+    #[cfg(target_os = "macos")]
+    let fstat_result = unsafe { crate::syscalls::macos_raw::raw_fstat64(fd, &mut stat_buf) };
+    #[cfg(target_os = "linux")]
+    let fstat_result = unsafe { crate::syscalls::linux_raw::raw_fstat(fd, &mut stat_buf) };
+
+    let ptr = if fstat_result == 0 && stat_buf.st_size as usize >= size {
+        #[cfg(target_os = "macos")]
+        let ptr = unsafe {
+            crate::syscalls::macos_raw::raw_mmap(
+                ptr::null_mut(),
+                size,
+                libc::PROT_READ | libc::PROT_WRITE,
+                libc::MAP_SHARED,
+                fd,
+                0,
+            )
+        };
+        #[cfg(target_os = "linux")]
+        let ptr = unsafe {
+            crate::syscalls::linux_raw::raw_mmap(
+                ptr::null_mut(),
+                size,
+                libc::PROT_READ | libc::PROT_WRITE,
+                libc::MAP_SHARED,
+                fd,
+                0,
+            )
+        };
+        ptr
+    } else {
+        libc::MAP_FAILED
+    };
+    #[cfg(target_os = "macos")]
+    unsafe {
+        crate::syscalls::macos_raw::raw_close(fd)
+    };
+    #[cfg(target_os = "linux")]
+    unsafe {
+        crate::syscalls::linux_raw::raw_close(fd)
+    };
+
+    if ptr == libc::MAP_FAILED {
+        return None;
+    }
+    Some(ptr)
 }
 
 // =============================================================================
@@ -692,7 +839,7 @@ fn install_panic_handler() {
         }
 
         // Dump flight recorder for post-mortem
-        FLIGHT_RECORDER.record(super::EventType::IpcFail, 0, -99);
+        FLIGHT_RECORDER.record(super::EventType::IpcFail, 0, -99, 0);
 
         // Abort instead of unwinding — unwinding in interposed context is catastrophic
         unsafe { libc::abort() };
@@ -0,0 +1,78 @@
+// =============================================================================
+// state/metrics.rs — Interposition counters in the vDird metrics file
+// =============================================================================
+//
+// This process's slot in `<vdir_path>.metrics` (layout: vrift_ipc::metrics),
+// claimed when the file is mapped at init. vDird reads it without IPC.
+// Bumping is one relaxed atomic add on a slot no other process touches;
+// without a slot (no file, or all slots taken) it is a null check.
+//
+// A forked child re-claims a slot for its own pid (atfork handler,
+// registered from the worker thread — never during init, see BUG-007b).
+// =============================================================================
+
+use std::sync::atomic::{AtomicBool, AtomicPtr, Ordering};
+use vrift_ipc::metrics::{MetricsBlock, MetricsSlot};
+
+pub use vrift_ipc::metrics::Metric;
+
+static BLOCK: AtomicPtr<u8> = AtomicPtr::new(std::ptr::null_mut());
+static SLOT: AtomicPtr<MetricsSlot> = AtomicPtr::new(std::ptr::null_mut());
+static ATFORK_REGISTERED: AtomicBool = AtomicBool::new(false);
+
+#[inline(always)]
+fn slot() -> Option<&'static MetricsSlot> {
+    let slot = SLOT.load(Ordering::Relaxed);
+    // SAFETY: the mapping is never unmapped once published
+    unsafe { slot.as_ref() }
+}
+
+#[inline(always)]
+pub(crate) fn metric_add(metric: Metric, n: u64) {
+    if let Some(slot) = slot() {
+        slot.add(metric, n);
+    }
+}
+
+/// Record one IPC round trip that started at `start_ns` (`monotonic_ns()`)
+#[inline(always)]
+pub(crate) fn metric_ipc(start_ns: u64, ok: bool) {
+    if let Some(slot) = slot() {
+        slot.record_ipc(super::flight::monotonic_ns().saturating_sub(start_ns), ok);
+    }
+}
+
+fn claim(block: MetricsBlock) {
+    let pid = unsafe { libc::getpid() } as u32;
+    let slot = block.claim(pid).map_or(std::ptr::null_mut(), |s| {
+        s as *const MetricsSlot as *mut MetricsSlot
+    });
+    SLOT.store(slot, Ordering::Relaxed);
+}
+
+/// Publish the mapped metrics file. `base` maps `metrics_file_size()` bytes
+/// read-write and is never unmapped.
+pub(crate) unsafe fn attach(base: *mut u8, len: usize) -> bool {
+    let Some(block) = MetricsBlock::attach(base, len) else {
+        return false;
+    };
+    BLOCK.store(base, Ordering::Release);
+    claim(block);
+    true
+}
+
+extern "C" fn metrics_atfork_child() {
+    let base = BLOCK.load(Ordering::Acquire);
+    SLOT.store(std::ptr::null_mut(), Ordering::Relaxed);
+    if let Some(block) =
+        unsafe { MetricsBlock::attach(base, vrift_ipc::metrics::metrics_file_size()) }
+    {
+        claim(block);
+    }
+}
+
+pub(crate) unsafe fn ensure_metrics_atfork() {
+    if !BLOCK.load(Ordering::Acquire).is_null() && !ATFORK_REGISTERED.swap(true, Ordering::AcqRel) {
+        libc::pthread_atfork(None, None, Some(metrics_atfork_child));
+    }
+}
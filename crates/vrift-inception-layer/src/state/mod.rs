@@ -4,19 +4,28 @@
 //
 // This module contains code that runs on EVERY interposed syscall:
 //   - get() / get_no_spawn() — global state access (small stack frame!)
-//   - query_manifest() / resolve_path() — per-call lookups
+//   - query_manifest() / resolve_path() — per-call lookups (VDir first, IPC on miss)
 //   - InceptionLayerGuard — recursion prevention
-//   - FlightRecorder / Logger / DirtyTracker — always-hot infrastructure
+//   - Logger / DirtyTracker — always-hot infrastructure
 //
+// The flight recorder lives in state/flight.rs, the vDird-visible counters
+// in state/metrics.rs
 // Cold-path init code lives in state/init.rs (behind #[inline(never)])
 // Background worker code lives in state/worker.rs
 // =============================================================================
 
+mod flight;
 mod init;
+mod metrics;
 mod worker;
 
+pub use flight::*;
+pub use metrics::Metric;
+pub(crate) use metrics::{ensure_metrics_atfork, metric_add, metric_ipc};
+
 use crate::ipc::*;
 use crate::path::{PathResolver, VfsPath};
+use crate::sync::probe_cache::{Probe, WARM_AFTER_MISSES};
 use crate::sync::RecursiveMutex;
 use libc::{c_int, c_void};
 use std::collections::HashMap;
@@ -106,104 +115,6 @@ pub enum LogLevel {
     Off = 5,
 }
 
-// ============================================================================
-// Flight Recorder (RFC-0039 §82)
-// ============================================================================
-
-#[repr(u8)]
-#[derive(Debug, Clone, Copy, PartialEq, Eq)]
-pub enum EventType {
-    OpenHit = 1,
-    OpenMiss = 2,
-    StatHit = 3,
-    StatMiss = 4,
-    CowTriggered = 5,
-    IpcFail = 6,
-    IpcSuccess = 7,
-    CircuitTripped = 8,
-    VfsInit = 9,
-    Close = 10,
-    ReingestSuccess = 11,
-    ReingestFail = 12,
-}
-
-#[repr(C)]
-#[derive(Debug, Clone, Copy)]
-pub struct FlightEntry {
-    pub timestamp: u64,
-    pub event_type: u8,
-    pub _pad: [u8; 7], // Alignment for u64
-    pub file_id: u64,  // 64-bit hash (FNV1a)
-    pub result: i32,
-    pub _pad2: [u8; 4], // Pad to 32 bytes
-}
-
-pub const FLIGHT_RECORDER_SIZE: usize = 32768; // 32K entries * 32 bytes = 1MB
-pub struct FlightRecorder {
-    pub buffer: [FlightEntry; FLIGHT_RECORDER_SIZE],
-    pub head: AtomicUsize,
-}
-
-impl FlightRecorder {
-    #[allow(clippy::large_stack_frames)] // const fn for static init — never on runtime stack
-    pub const fn new() -> Self {
-        Self {
-            buffer: [FlightEntry {
-                timestamp: 0,
-                event_type: 0,
-                _pad: [0; 7],
-                file_id: 0,
-                result: 0,
-                _pad2: [0; 4],
-            }; FLIGHT_RECORDER_SIZE],
-            head: AtomicUsize::new(0),
-        }
-    }
-}
-
-impl Default for FlightRecorder {
-    #[allow(clippy::large_stack_frames)] // delegates to const fn new() for static init
-    fn default() -> Self {
-        Self::new()
-    }
-}
-
-impl FlightRecorder {
-    #[inline(always)]
-    pub fn record(&self, event: EventType, file_id: u64, result: i32) {
-        let idx = self.head.fetch_add(1, Ordering::Relaxed) % FLIGHT_RECORDER_SIZE;
-        // Safety: We are writing to a pre-allocated buffer.
-        // In a high-concurrency dylib, we accept that entries might be semi-corrupted
-        // if two threads write to the same index exactly at the same time,
-        // but this is extremely rare and better than locking.
-        unsafe {
-            let entry = &mut *self.buffer.as_ptr().add(idx).cast_mut();
-            entry.timestamp = rdtsc();
-            entry.event_type = event as u8;
-            entry.file_id = file_id;
-            entry.result = result;
-        }
-    }
-}
-
-pub static FLIGHT_RECORDER: FlightRecorder = FlightRecorder::new();
-
-pub static EVENT_NAMES: &[&str] = &[
-    "UNKNOWN",
-    "OpenHit",
-    "OpenMiss",
-    "StatHit",
-    "StatMiss",
-    "CowTriggered",
-    "IpcFail",
-    "IpcSuccess",
-    "CircuitTripped",
-    "VfsInit",
-    "Close",
-    "ReingestSuccess",
-    "ReingestFail",
-];
-
 // ============================================================================
 // DirtyTracker: Lock-Free Pending Write Tracking (M3: Dirty Bit Logic)
 // ============================================================================
@@ -223,6 +134,12 @@ const TOMBSTONE: u64 = u64::MAX;
 /// Global dirty tracker instance
 pub static DIRTY_TRACKER: DirtyTracker = DirtyTracker::new();
 
+/// Directory-burst manifest cache (see sync/probe_cache.rs)
+pub(crate) static PROBE_CACHE: crate::sync::ProbeCache = crate::sync::ProbeCache::new();
+
+/// Raw path → VfsPath resolutions (see sync/resolve_cache.rs)
+pub(crate) static RESOLVE_CACHE: crate::sync::ResolveCache = crate::sync::ResolveCache::new();
+
 /// FNV-1a hash for path strings (same as vdir.rs)
 #[inline(always)]
 pub fn fnv1a_hash(path: &str) -> u64 {
@@ -365,23 +282,6 @@ impl DirtyTracker {
     }
 }
 
-#[inline(always)]
-fn rdtsc() -> u64 {
-    #[cfg(target_arch = "x86_64")]
-    unsafe {
-        std::arch::x86_64::_rdtsc()
-    }
-    #[cfg(target_arch = "aarch64")]
-    /* unsafe */
-    {
-        0
-    }
-    #[cfg(not(any(target_arch = "x86_64", target_arch = "aarch64")))]
-    {
-        0
-    }
-}
-
 impl LogLevel {
     pub fn from_u8(v: u8) -> Self {
         match v {
@@ -400,6 +300,8 @@ pub static LOG_LEVEL: AtomicU8 = AtomicU8::new(LogLevel::Info as u8);
 /// Circuit breaker state: trips after consecutive failures
 pub static CIRCUIT_BREAKER_FAILED_COUNT: AtomicUsize = AtomicUsize::new(0);
 pub static CIRCUIT_BREAKER_THRESHOLD: AtomicUsize = AtomicUsize::new(5);
+/// Read by the Linux C bridge fast path
+#[no_mangle]
 pub static CIRCUIT_TRIPPED: AtomicBool = AtomicBool::new(false);
 /// Unix timestamp when circuit was tripped (for auto-recovery)
 pub static CIRCUIT_TRIP_TIME: AtomicU64 = AtomicU64::new(0);
@@ -615,41 +517,6 @@ pub(crate) unsafe fn inception_log(msg: &str) {
     }
 }
 
-pub fn vfs_dump_flight_recorder() {
-    let head = FLIGHT_RECORDER.head.load(Ordering::Relaxed);
-    let start = head.saturating_sub(FLIGHT_RECORDER_SIZE);
-
-    // Use a fixed buffer to avoid allocations during dump
-    let mut buf = [0u8; 256];
-
-    let pid = unsafe { libc::getpid() };
-    let header = format!("\n--- [VFS] Flight Recorder Dump (PID: {}) ---\n", pid);
-    let _ = unsafe { libc::write(2, header.as_ptr() as *const c_void, header.len()) };
-
-    for i in start..head {
-        let entry = &FLIGHT_RECORDER.buffer[i % FLIGHT_RECORDER_SIZE];
-        if entry.event_type == 0 {
-            continue;
-        }
-
-        let event_name = EVENT_NAMES
-            .get(entry.event_type as usize)
-            .unwrap_or(&"INVALID");
-
-        let mut wrapper = crate::macros::StackWriter::new(&mut buf);
-        use std::fmt::Write;
-        let _ = writeln!(
-            wrapper,
-            "[{:>15}] {:<16} ID:0x{:016x} RES:{}",
-            entry.timestamp, event_name, entry.file_id, entry.result
-        );
-        let msg = wrapper.as_str();
-        let _ = unsafe { libc::write(2, msg.as_ptr() as *const c_void, msg.len()) };
-    }
-    let footer = "--- End of Dump ---\n";
-    let _ = unsafe { libc::write(2, footer.as_ptr() as *const c_void, footer.len()) };
-}
-
 // ============================================================================
 // FixedString: Zero-Allocation String Storage
 // ============================================================================
@@ -777,6 +644,8 @@ pub(crate) struct SyntheticDir {
     pub vpath: FixedString<1024>,
     pub entries: Vec<vrift_ipc::DirEntry>,
     pub position: usize,
+    /// Served from the VDir directory index (entries unused) while Some
+    pub vdir: Option<VDirDirCursor>,
 }
 unsafe impl Send for SyntheticDir {} // Raw pointers in open_dirs HashMap
 unsafe impl Sync for SyntheticDir {}
@@ -793,7 +662,10 @@ pub(crate) static SYNTHETIC_DIR_COUNTER: std::sync::atomic::AtomicUsize =
 // Phase 1.3: vdir_lookup — seqlock-protected O(1) stat from VDir mmap
 // ============================================================================
 
-use vrift_ipc::vdir_types::{VDirEntry, VDIR_ENTRY_SIZE, VDIR_HEADER_SIZE, VDIR_MAGIC};
+use vrift_ipc::vdir_types::{
+    vdir_dir_key, vdir_find, VDirDirs, VDirKey, VDIR_CHILD_DIR, VDIR_HEADER_SIZE, VDIR_MAGIC,
+    VDIR_NAME_MAX, VDIR_VERSION,
+};
 
 /// Result from VDir lookup (VDirEntry fields needed for stat)
 #[derive(Debug, Clone, Copy)]
@@ -812,6 +684,11 @@ const MAX_SEQLOCK_SPINS: u32 = 1000;
 
 /// O(1) seqlock-protected stat lookup from VDir MAP_SHARED mmap.
 /// ZERO ALLOCATIONS, ZERO LOCKS, ZERO SYSCALLS — safe for PSFS hot path.
+/// SIMD group probe over the tag array, then the 64-bit hash and the
+/// secondary path_check must both match. During an incremental resize the
+/// live table is probed first, then the old one — a resize never forces
+/// readers onto IPC. `mmap_size` is the reserved mapping length; tables are
+/// bounded by the header's `file_size`.
 #[inline(always)]
 pub(crate) fn vdir_lookup(
     mmap_ptr: *const u8,
@@ -822,9 +699,11 @@ pub(crate) fn vdir_lookup(
         return None;
     }
 
-    // Validate magic (first 4 bytes of header)
+    // Validate magic + version (first 8 bytes of header). A VDir from an
+    // older vDird uses a different table layout: fall back to IPC.
     let magic = unsafe { *(mmap_ptr as *const u32) };
-    if magic != VDIR_MAGIC {
+    let version = unsafe { *((mmap_ptr as usize + 4) as *const u32) };
+    if magic != VDIR_MAGIC || version != VDIR_VERSION {
         return None;
     }
 
@@ -836,16 +715,8 @@ pub(crate) fn vdir_lookup(
         "AtomicU64 (generation) not 8-byte aligned"
     );
     let gen_ptr = unsafe { &*(gen_addr as *const AtomicU64) };
-    // table_capacity at offset 20 (u32), table_offset at offset 24 (u32)
-    let table_capacity = unsafe { *((mmap_ptr as usize + 20) as *const u32) } as usize;
-    let table_offset = unsafe { *((mmap_ptr as usize + 24) as *const u32) } as usize;
-
-    if table_capacity == 0 {
-        return None;
-    }
 
-    let path_hash = vrift_ipc::fnv1a_hash(path);
-    let start_slot = (path_hash as usize) % table_capacity;
+    let key = VDirKey::from_path(path);
 
     // Seqlock read loop with bounded spin
     let mut spins: u32 = 0;
@@ -855,38 +726,25 @@ pub(crate) fn vdir_lookup(
             // Writer active (odd generation) — spin with upper bound
             spins += 1;
             if spins > MAX_SEQLOCK_SPINS {
+                count_vdir_lookup(false, spins);
                 return None; // Fallback: vDird may have crashed mid-write
             }
             core::hint::spin_loop();
             continue;
         }
 
-        // O(1) hash table lookup with linear probing
-        let mut result: Option<VDirStatResult> = None;
-        for i in 0..table_capacity {
-            let slot = (start_slot + i) % table_capacity;
-            let entry_offset = table_offset + slot * VDIR_ENTRY_SIZE;
-            if entry_offset + VDIR_ENTRY_SIZE > mmap_size {
-                break;
-            }
-            let entry = unsafe { &*(mmap_ptr.add(entry_offset) as *const VDirEntry) };
-
-            if entry.path_hash == 0 {
-                break; // Empty slot = not found
-            }
-
-            if entry.path_hash == path_hash {
-                result = Some(VDirStatResult {
-                    size: entry.size,
-                    mtime_sec: entry.mtime_sec,
-                    mtime_nsec: entry.mtime_nsec,
-                    mode: entry.mode,
-                    flags: entry.flags,
-                    cas_hash: entry.cas_hash,
-                });
-                break;
+        // Geometry (live + old table, file_size) is re-read inside the seqlock
+        let result = unsafe { vdir_find(mmap_ptr, mmap_size, key) }.map(|entry| {
+            let entry = unsafe { &*entry };
+            VDirStatResult {
+                size: entry.size,
+                mtime_sec: entry.mtime_sec,
+                mtime_nsec: entry.mtime_nsec,
+                mode: entry.mode,
+                flags: entry.flags,
+                cas_hash: entry.cas_hash,
             }
-        }
+        });
 
         // Re-read generation to check for concurrent write
         let g2 = gen_ptr.load(Ordering::Acquire);
@@ -894,18 +752,202 @@ pub(crate) fn vdir_lookup(
             // Data changed during read — retry (also bounded by MAX_SEQLOCK_SPINS)
             spins += 1;
             if spins > MAX_SEQLOCK_SPINS {
+                count_vdir_lookup(false, spins);
                 return None;
             }
             core::hint::spin_loop();
             continue;
         }
 
+        count_vdir_lookup(result.is_some(), spins);
         return result;
     }
 }
 
-// mmap_dir_lookup removed — VDir entries store only path hashes (no filenames),
-// so readdir is served via IPC. Readdir is not on the PSFS hot path.
+#[inline(always)]
+fn count_vdir_lookup(hit: bool, spins: u32) {
+    metric_add(
+        if hit {
+            Metric::VdirHit
+        } else {
+            Metric::VdirMiss
+        },
+        1,
+    );
+    if spins > 0 {
+        metric_add(Metric::SeqlockRetry, spins as u64);
+    }
+}
+
+/// Current (even) VDir generation, or None if no VDir is mapped or a writer
+/// is active. Used to stamp locally cached manifest answers.
+#[inline(always)]
+pub(crate) fn vdir_generation(mmap_ptr: *const u8, mmap_size: usize) -> Option<u64> {
+    if mmap_ptr.is_null() || mmap_size < VDIR_HEADER_SIZE {
+        return None;
+    }
+    if unsafe { *(mmap_ptr as *const u32) } != VDIR_MAGIC {
+        return None;
+    }
+    let gen_ptr = unsafe { &*((mmap_ptr as usize + 8) as *const AtomicU64) };
+    let generation = gen_ptr.load(Ordering::Acquire);
+    if generation & 1 != 0 {
+        None
+    } else {
+        Some(generation)
+    }
+}
+
+// ============================================================================
+// vdir_readdir — directory listings from the VDir index (no IPC, no rkyv)
+// ============================================================================
+
+/// Read position in a directory stream served from the VDir index.
+/// Across an index rebuild the position is re-derived from the last name
+/// returned (children are name-sorted), so no entry is repeated.
+#[derive(Clone, Copy)]
+pub(crate) struct VDirDirCursor {
+    key: VDirKey,
+    generation: u64,
+    position: usize,
+    last: [u8; VDIR_NAME_MAX],
+    last_len: usize,
+}
+
+impl VDirDirCursor {
+    /// Last name returned (empty before the first entry)
+    pub(crate) fn last_name(&self) -> &[u8] {
+        &self.last[..self.last_len]
+    }
+}
+
+/// Result of one `vdir_readdir` step
+#[derive(Debug, Clone, Copy, PartialEq, Eq)]
+pub(crate) enum VDirReaddir {
+    /// Name (NUL-terminated) of `len` bytes written to the output buffer
+    Entry {
+        len: usize,
+        is_dir: bool,
+    },
+    End,
+    /// Index stale/rebuilt without this directory: continue over IPC
+    Unavailable,
+}
+
+/// Seqlock read over a VDir mapping that has the current layout version.
+/// Returns the even generation the read was consistent with.
+#[inline(always)]
+fn vdir_read_consistent<T>(
+    mmap_ptr: *const u8,
+    mmap_size: usize,
+    mut read: impl FnMut(u64) -> T,
+) -> Option<(u64, T)> {
+    if mmap_ptr.is_null() || mmap_size < VDIR_HEADER_SIZE {
+        return None;
+    }
+    let magic = unsafe { *(mmap_ptr as *const u32) };
+    let version = unsafe { *((mmap_ptr as usize + 4) as *const u32) };
+    if magic != VDIR_MAGIC || version != VDIR_VERSION {
+        return None;
+    }
+    let gen_ptr = unsafe { &*((mmap_ptr as usize + 8) as *const AtomicU64) };
+
+    for _ in 0..MAX_SEQLOCK_SPINS {
+        let g1 = gen_ptr.load(Ordering::Acquire);
+        if g1 & 1 != 0 {
+            core::hint::spin_loop();
+            continue;
+        }
+        let value = read(g1);
+        if gen_ptr.load(Ordering::Acquire) == g1 {
+            return Some((g1, value));
+        }
+        core::hint::spin_loop();
+    }
+    None // Fallback: vDird may have crashed mid-write
+}
+
+/// Start a directory stream for manifest directory `dir` from the VDir
+/// index. None if the index is stale or does not know `dir` (use IPC).
+/// ZERO ALLOCATIONS, ZERO LOCKS, ZERO SYSCALLS.
+pub(crate) fn vdir_opendir(
+    mmap_ptr: *const u8,
+    mmap_size: usize,
+    dir: &str,
+) -> Option<VDirDirCursor> {
+    let key = VDirKey::from_path(vdir_dir_key(dir));
+    let (generation, found) = vdir_read_consistent(mmap_ptr, mmap_size, |_| unsafe {
+        VDirDirs::open(mmap_ptr, mmap_size)
+            .and_then(|dirs| dirs.find(key))
+            .is_some()
+    })?;
+    found.then_some(VDirDirCursor {
+        key,
+        generation,
+        position: 0,
+        last: [0; VDIR_NAME_MAX],
+        last_len: 0,
+    })
+}
+
+/// Next entry of a VDir-served directory stream. The child name is copied
+/// straight from the mapping into `name_out` — the one copy readdir needs.
+/// ZERO ALLOCATIONS, ZERO LOCKS, ZERO SYSCALLS.
+pub(crate) fn vdir_readdir(
+    mmap_ptr: *const u8,
+    mmap_size: usize,
+    cursor: &mut VDirDirCursor,
+    name_out: &mut [u8],
+) -> VDirReaddir {
+    if name_out.is_empty() {
+        return VDirReaddir::Unavailable;
+    }
+    let read = vdir_read_consistent(mmap_ptr, mmap_size, |generation| unsafe {
+        let list = VDirDirs::open(mmap_ptr, mmap_size)?.find(cursor.key)?;
+        // Same generation: nothing moved since the last call
+        let index = if generation == cursor.generation || cursor.last_len == 0 {
+            cursor.position
+        } else {
+            list.seek_after(cursor.last_name())
+        };
+        if index >= list.len() {
+            return Some(None);
+        }
+        let (name, kind) = list.get(index)?;
+        let len = name.len().min(name_out.len() - 1);
+        std::ptr::copy_nonoverlapping(name.as_ptr(), name_out.as_mut_ptr(), len);
+        name_out[len] = 0;
+        Some(Some((index, len, kind & VDIR_CHILD_DIR != 0)))
+    });
+
+    match read {
+        Some((generation, Some(Some((index, len, is_dir))))) => {
+            let keep = len.min(VDIR_NAME_MAX);
+            cursor.last[..keep].copy_from_slice(&name_out[..keep]);
+            cursor.last_len = keep;
+            cursor.position = index + 1;
+            cursor.generation = generation;
+            VDirReaddir::Entry { len, is_dir }
+        }
+        Some((_, Some(None))) => VDirReaddir::End,
+        _ => VDirReaddir::Unavailable,
+    }
+}
+
+/// True only if `path` is provably absent: not in the VDir tables and
+/// rejected by the manifest filter, both within one seqlock generation.
+/// A stale index, a missing filter or a torn read all answer false (ask IPC).
+/// ZERO ALLOCATIONS, ZERO LOCKS, ZERO SYSCALLS.
+#[inline(always)]
+pub(crate) fn vdir_known_absent(mmap_ptr: *const u8, mmap_size: usize, path: &str) -> bool {
+    let key = VDirKey::from_path(path);
+    let read = vdir_read_consistent(mmap_ptr, mmap_size, |_| unsafe {
+        vdir_find(mmap_ptr, mmap_size, key).is_none()
+            && VDirDirs::open(mmap_ptr, mmap_size).and_then(|dirs| dirs.may_contain(key))
+                == Some(false)
+    });
+    matches!(read, Some((_, true)))
+}
 
 // ============================================================================
 // InceptionLayerState: Core struct & hot-path methods
@@ -924,6 +966,8 @@ pub(crate) struct InceptionLayerState {
     pub bloom_ptr: *const u8,
     pub mmap_ptr: *const u8,
     pub mmap_size: usize,
+    /// Shm ring to vDird for fire-and-forget manifest mutations (None: socket only)
+    pub mutation_ring: Option<vrift_ipc::mutation_ring::MutationRing>,
     pub project_root: FixedString<1024>,
     pub path_resolver: PathResolver,
     pub cached_soft_limit: AtomicUsize,
@@ -1009,6 +1053,7 @@ impl InceptionLayerState {
         };
 
         // RFC-0039 §82: Record initialization event
+        flight::calibrate();
         inception_record!(EventType::VfsInit, 0, 0);
 
         // BUG-004: setup_signal_handler and atexit are dangerous during dyld bootstrap.
@@ -1022,6 +1067,8 @@ impl InceptionLayerState {
             unsafe { init::setup_signal_handler() };
             unsafe { libc::atexit(init::dump_logs_atexit) };
         }
+        // Opt-in like the handlers above: only when VRIFT_FLIGHT_DUMP is set
+        unsafe { flight::arm_binary_dump() };
 
         // Activate VFS - now it's safe to call into Rust from C wrappers.
         activate_vfs();
@@ -1042,12 +1089,50 @@ impl InceptionLayerState {
                 _pad: 0,
             });
         }
+        let key = vpath.manifest_key.as_str();
+
+        // Negative filter: toolchains probe far more missing paths than real
+        // ones; a guaranteed miss needs no round trip
+        if vdir_known_absent(self.mmap_ptr, self.mmap_size, key) {
+            inception_record!(EventType::StatMiss, vpath.manifest_key_hash, 21); // 21 = filter_miss
+            return None;
+        }
+
+        // Without a VDir generation there is nothing to stamp cached answers with
+        let Some(generation) = vdir_generation(self.mmap_ptr, self.mmap_size) else {
+            return unsafe { sync_ipc_manifest_get(&self.vdird_socket_path, key) };
+        };
+
+        // Directory-burst cache: sibling probes are answered locally once the
+        // directory has been warmed with a single ManifestGetMany round trip
+        let epoch = PROBE_CACHE.epoch();
+        let parent = crate::sync::probe_cache::parent_key(key);
+        let parent_hash = fnv1a_hash(parent);
+        match PROBE_CACHE.lookup(vpath.manifest_key_hash, parent_hash, generation, epoch) {
+            Probe::Hit(entry) => return Some(entry),
+            Probe::Negative => return None,
+            Probe::Miss => {}
+        }
+
+        if PROBE_CACHE.note_dir_miss(parent_hash, generation, epoch) >= WARM_AFTER_MISSES
+            && unsafe { warm_probe_cache(&self.vdird_socket_path, parent, generation, epoch) }
+        {
+            match PROBE_CACHE.lookup(vpath.manifest_key_hash, parent_hash, generation, epoch) {
+                Probe::Hit(entry) => return Some(entry),
+                Probe::Negative => return None,
+                Probe::Miss => {}
+            }
+        }
+
         // Fallback to IPC query (vDird → LMDB)
-        unsafe { sync_ipc_manifest_get(&self.vdird_socket_path, vpath.manifest_key.as_str()) }
+        let entry = unsafe { sync_ipc_manifest_get(&self.vdird_socket_path, key) };
+        PROBE_CACHE.insert(vpath.manifest_key_hash, entry.as_ref(), generation, epoch);
+        entry
     }
 
-    /// Query manifest directly via IPC (bypasses mmap cache)
-    /// Required for open() which needs content_hash to locate CAS blob
+    /// Query manifest directly via IPC (bypasses VDir mmap)
+    /// Use only when an authoritative vDird/LMDB answer is required; hot paths
+    /// (stat, open) should go through query_manifest() instead.
     pub(crate) fn query_manifest_ipc(&self, vpath: &VfsPath) -> Option<vrift_ipc::VnodeEntry> {
         // Use the centrally resolved manifest key
         unsafe { sync_ipc_manifest_get(&self.vdird_socket_path, &vpath.manifest_key) }
@@ -1150,10 +1235,42 @@ impl InceptionLayerState {
         }
     }
 
+    /// Point `path` at an existing blob (a cloned copy)
+    /// Phase 3: Fire-and-forget — queued to worker thread
+    #[allow(clippy::unnecessary_cast)] // mode_t is u16 on macOS, u32 on Linux
+    pub(crate) fn manifest_clone(
+        &self,
+        path: &str,
+        hash: [u8; 32],
+        size: u64,
+        mode: libc::mode_t,
+    ) -> Result<(), ()> {
+        use std::time::{SystemTime, UNIX_EPOCH};
+        let request = vrift_ipc::VeloRequest::ManifestUpsert {
+            path: path.to_string(),
+            entry: vrift_ipc::VnodeEntry {
+                content_hash: hash,
+                size,
+                mtime: SystemTime::now()
+                    .duration_since(UNIX_EPOCH)
+                    .map(|d| d.as_secs())
+                    .unwrap_or(0),
+                mode: mode as u32,
+                flags: 0,
+                _pad: 0,
+            },
+        };
+        if unsafe { fire_and_forget_ipc(&self.vdird_socket_path, &request) } {
+            Ok(())
+        } else {
+            Err(())
+        }
+    }
+
     /// Query daemon for directory listing (for opendir/readdir)
     #[allow(dead_code)]
     pub(crate) fn query_dir_listing(&self, path: &str) -> Option<Vec<vrift_ipc::DirEntry>> {
-        // Fall back to IPC (readdir is not on the PSFS hot path and VDir doesn't store filenames)
+        // IPC listing: used when the VDir directory index is stale or lacks `path`
         unsafe { sync_ipc_manifest_list_dir(&self.vdird_socket_path, path) }
     }
 
@@ -1522,4 +1639,287 @@ mod dirty_tracker_tests {
             }
         }
     }
+
+    /// Build a VDir image in memory (64-byte aligned) with the given paths
+    fn build_vdir(capacity: usize, paths: &[(&str, u64)]) -> Vec<u64> {
+        use vrift_ipc::vdir_types::*;
+        let size = vdir_file_size(capacity);
+        let mut buf = vec![0u64; size.div_ceil(8)];
+        let base = buf.as_mut_ptr() as *mut u8;
+        unsafe {
+            let header = &mut *(base as *mut VDirHeader);
+            header.magic = VDIR_MAGIC;
+            header.version = VDIR_VERSION;
+            header.table_capacity = capacity as u32;
+            header.table_offset = vdir_table_offset(capacity) as u32;
+            header.tags_offset = VDIR_TAGS_OFFSET as u32;
+            header.file_size = size as u64;
+            let tags = base.add(VDIR_TAGS_OFFSET);
+            let entries = base.add(vdir_table_offset(capacity)) as *mut VDirEntry;
+            for &(path, size) in paths {
+                let key = VDirKey::from_path(path);
+                let VDirProbe::Vacant(slot) = vdir_probe(tags, entries, capacity, key) else {
+                    panic!("duplicate or full");
+                };
+                *tags.add(slot) = vdir_tag(key.path_hash);
+                *entries.add(slot) = VDirEntry {
+                    path_hash: key.path_hash,
+                    path_check: key.path_check,
+                    size,
+                    ..Default::default()
+                };
+            }
+        }
+        buf
+    }
+
+    #[test]
+    fn test_vdir_lookup_group_probe() {
+        let paths: Vec<(String, u64)> = (0..200).map(|i| (format!("src/f{}.rs", i), i)).collect();
+        let refs: Vec<(&str, u64)> = paths.iter().map(|(p, s)| (p.as_str(), *s)).collect();
+        let buf = build_vdir(256, &refs);
+        let ptr = buf.as_ptr() as *const u8;
+        let size = buf.len() * 8;
+
+        for (path, expected) in &refs {
+            assert_eq!(vdir_lookup(ptr, size, path).unwrap().size, *expected);
+        }
+        assert!(vdir_lookup(ptr, size, "src/missing.rs").is_none());
+    }
+
+    #[test]
+    fn test_vdir_lookup_rejects_old_version_and_truncated_map() {
+        let buf = build_vdir(64, &[("a.rs", 1)]);
+        let ptr = buf.as_ptr() as *const u8;
+        let size = buf.len() * 8;
+        assert!(vdir_lookup(ptr, size, "a.rs").is_some());
+        // Mapping shorter than the table the header describes (file grew)
+        assert!(vdir_lookup(ptr, VDIR_HEADER_SIZE + 64, "a.rs").is_none());
+
+        let mut old = buf.clone();
+        unsafe { *((old.as_mut_ptr() as *mut u8).add(4) as *mut u32) = 3 };
+        assert!(vdir_lookup(old.as_ptr() as *const u8, size, "a.rs").is_none());
+    }
+
+    /// Append a published directory index (and a manifest filter over
+    /// `keys`, if any) to a VDir image built by `build_vdir`
+    fn with_dir_index(
+        mut buf: Vec<u64>,
+        dirs: &[(&str, &[(&str, bool)])],
+        keys: &[&str],
+    ) -> Vec<u64> {
+        use vrift_ipc::vdir_types::*;
+        let dir_capacity = (dirs.len() * 2).next_power_of_two().max(16);
+        let child_count: usize = dirs.iter().map(|(_, c)| c.len()).sum();
+        let names_len: usize = dirs
+            .iter()
+            .flat_map(|(_, c)| c.iter().map(|(n, _)| n.len()))
+            .sum();
+        let slots = VDirDirsHeader::slots_offset();
+        let children = slots + dir_capacity * std::mem::size_of::<VDirDirSlot>();
+        let names = children + child_count * std::mem::size_of::<VDirChild>();
+        let filter = (names + names_len).next_multiple_of(VDIR_FILTER_BLOCK);
+        let filter_blocks = if keys.is_empty() {
+            0
+        } else {
+            vdir_filter_blocks(keys.len())
+        };
+        let region_size = filter + filter_blocks * VDIR_FILTER_BLOCK;
+
+        let offset = (buf.len() * 8).next_multiple_of(64);
+        buf.resize((offset + region_size).div_ceil(8), 0);
+        let base = buf.as_mut_ptr() as *mut u8;
+        unsafe {
+            let header = &mut *(base as *mut VDirHeader);
+            header.dirs_offset = offset as u32;
+            header.file_size = (offset + region_size) as u64;
+            let region = base.add(offset);
+            *(region as *mut VDirDirsHeader) = VDirDirsHeader {
+                region_size: region_size as u32,
+                dir_capacity: dir_capacity as u32,
+                dir_count: dirs.len() as u32,
+                child_count: child_count as u32,
+                names_len: names_len as u32,
+                filter_offset: filter as u32,
+                filter_blocks: filter_blocks as u32,
+                ..Default::default()
+            };
+            let words = std::slice::from_raw_parts_mut(
+                region.add(filter) as *mut u32,
+                filter_blocks * VDIR_FILTER_BLOCK / 4,
+            );
+            for key in keys {
+                vdir_filter_insert(words, VDirKey::from_path(key));
+            }
+            let (mut child, mut name_at) = (0usize, 0usize);
+            for &(dir, entries) in dirs {
+                let key = VDirKey::from_path(dir);
+                let mut slot = key.path_hash as usize & (dir_capacity - 1);
+                while (*(region.add(slots) as *const VDirDirSlot).add(slot)).dir_check != 0 {
+                    slot = (slot + 1) & (dir_capacity - 1);
+                }
+                *(region.add(slots) as *mut VDirDirSlot).add(slot) = VDirDirSlot {
+                    dir_hash: key.path_hash,
+                    dir_check: key.path_check,
+                    child_start: child as u32,
+                    child_count: entries.len() as u32,
+                    _pad: 0,
+                };
+                for &(name, is_dir) in entries {
+                    *(region.add(children) as *mut VDirChild).add(child) = VDirChild {
+                        name_offset: name_at as u32,
+                        name_len: name.len() as u16,
+                        kind: if is_dir { VDIR_CHILD_DIR } else { 0 },
+                        _pad: 0,
+                    };
+                    std::ptr::copy_nonoverlapping(
+                        name.as_ptr(),
+                        region.add(names + name_at),
+                        name.len(),
+                    );
+                    child += 1;
+                    name_at += name.len();
+                }
+            }
+        }
+        buf
+    }
+
+    fn read_all(buf: &[u64], cursor: &mut VDirDirCursor) -> Vec<(String, bool)> {
+        let (ptr, size) = (buf.as_ptr() as *const u8, buf.len() * 8);
+        let mut name = [0u8; 256];
+        let mut out = Vec::new();
+        loop {
+            match vdir_readdir(ptr, size, cursor, &mut name) {
+                VDirReaddir::Entry { len, is_dir } => {
+                    assert_eq!(name[len], 0);
+                    out.push((String::from_utf8(name[..len].to_vec()).unwrap(), is_dir));
+                }
+                VDirReaddir::End => return out,
+                VDirReaddir::Unavailable => panic!("index unavailable"),
+            }
+        }
+    }
+
+    #[test]
+    fn test_vdir_readdir_lists_index() {
+        let buf = with_dir_index(
+            build_vdir(64, &[("src/a.rs", 1)]),
+            &[
+                ("/", &[("src", true)]),
+                ("src", &[("a.rs", false), ("b", true)]),
+            ],
+            &[],
+        );
+        let (ptr, size) = (buf.as_ptr() as *const u8, buf.len() * 8);
+
+        let mut root = vdir_opendir(ptr, size, "/").unwrap();
+        assert_eq!(read_all(&buf, &mut root), vec![("src".to_string(), true)]);
+        let mut src = vdir_opendir(ptr, size, "src/").unwrap();
+        assert_eq!(
+            read_all(&buf, &mut src),
+            vec![("a.rs".to_string(), false), ("b".to_string(), true)]
+        );
+        assert!(vdir_opendir(ptr, size, "missing").is_none());
+        // Old layout or no index: IPC fallback
+        let plain = build_vdir(64, &[]);
+        assert!(vdir_opendir(plain.as_ptr() as *const u8, plain.len() * 8, "/").is_none());
+    }
+
+    #[test]
+    fn test_vdir_readdir_resumes_by_name_after_rebuild() {
+        let before = with_dir_index(
+            build_vdir(64, &[]),
+            &[("d", &[("a", false), ("c", false), ("e", false)])],
+            &[],
+        );
+        let mut cursor = vdir_opendir(before.as_ptr() as *const u8, before.len() * 8, "d").unwrap();
+        let mut name = [0u8; 256];
+        let step = vdir_readdir(
+            before.as_ptr() as *const u8,
+            before.len() * 8,
+            &mut cursor,
+            &mut name,
+        );
+        assert_eq!(
+            step,
+            VDirReaddir::Entry {
+                len: 1,
+                is_dir: false
+            }
+        );
+
+        // Rebuilt index (new generation) gained "b" and "d": resume after "a"
+        let mut after = with_dir_index(
+            build_vdir(64, &[]),
+            &[(
+                "d",
+                &[
+                    ("a", false),
+                    ("b", false),
+                    ("c", false),
+                    ("d", false),
+                    ("e", false),
+                ],
+            )],
+            &[],
+        );
+        unsafe { *((after.as_mut_ptr() as *mut u8).add(8) as *mut u64) = 2 };
+        let rest: Vec<String> = read_all(&after, &mut cursor)
+            .into_iter()
+            .map(|(n, _)| n)
+            .collect();
+        assert_eq!(rest, vec!["b", "c", "d", "e"]);
+
+        // Stale index: caller switches to IPC
+        unsafe {
+            let offset = *((after.as_ptr() as *const u8).add(52) as *const u32) as usize;
+            (*((after.as_mut_ptr() as *mut u8).add(offset)
+                as *mut vrift_ipc::vdir_types::VDirDirsHeader))
+                .flags = vrift_ipc::vdir_types::VDIR_DIRS_STALE;
+        }
+        let step = vdir_readdir(
+            after.as_ptr() as *const u8,
+            after.len() * 8,
+            &mut cursor,
+            &mut name,
+        );
+        assert_eq!(step, VDirReaddir::Unavailable);
+    }
+
+    #[test]
+    fn test_vdir_known_absent_needs_vdir_and_filter_miss() {
+        let buf = with_dir_index(
+            build_vdir(64, &[("/src/new.rs", 1)]),
+            &[("/", &[("src", true)])],
+            &["/src/main.rs", "/src/lib.rs"],
+        );
+        let (ptr, size) = (buf.as_ptr() as *const u8, buf.len() * 8);
+
+        assert!(!vdir_known_absent(ptr, size, "/src/main.rs")); // In the manifest
+        assert!(!vdir_known_absent(ptr, size, "/src/new.rs")); // VDir overlay only
+        assert!(vdir_known_absent(ptr, size, "/src/main.ts"));
+        assert!(vdir_known_absent(ptr, size, "/include/stdio.h"));
+
+        // No filter published, or a stale index: never claim absence
+        let unfiltered = with_dir_index(build_vdir(64, &[]), &[("/", &[])], &[]);
+        let unfiltered_size = unfiltered.len() * 8;
+        assert!(!vdir_known_absent(
+            unfiltered.as_ptr() as *const u8,
+            unfiltered_size,
+            "/x"
+        ));
+        let mut stale = buf.clone();
+        unsafe {
+            let offset = *((stale.as_ptr() as *const u8).add(52) as *const u32) as usize;
+            (*((stale.as_mut_ptr() as *mut u8).add(offset)
+                as *mut vrift_ipc::vdir_types::VDirDirsHeader))
+                .flags = vrift_ipc::vdir_types::VDIR_DIRS_STALE;
+        }
+        assert!(!vdir_known_absent(
+            stale.as_ptr() as *const u8,
+            size,
+            "/src/main.ts"
+        ));
+    }
 }
@@ -5,7 +5,8 @@
 // Manages the background worker thread that processes tasks from the ring buffer.
 // Includes:
 //   - spawn_worker()  — #[inline(never)] to isolate pthread_create side effects
-//   - worker_entry()  — adaptive backoff loop (spin → yield → sleep)
+//   - worker_entry()  — adaptive backoff loop (spin → yield → sleep); sends
+//                       the prefetch hint first and access traces when idle
 //   - process_task()  — dispatch ring buffer tasks
 // =============================================================================
 
@@ -48,6 +49,10 @@ impl InceptionLayerState {
             None => return std::ptr::null_mut(),
         };
 
+        // Off the caller's threads: vDird starts reading ahead for this command
+        crate::pack::send_prefetch_hint();
+        unsafe { super::ensure_metrics_atfork() };
+
         // Worker thread loop with adaptive backoff for CPU efficiency
         let mut backoff_count = 0u32;
         loop {
@@ -66,6 +71,7 @@ impl InceptionLayerState {
                     // Yield CPU for short idle periods
                     std::thread::yield_now();
                 } else {
+                    crate::pack::flush_accesses();
                     // Sleep for prolonged idle (1μs reduces CPU while staying responsive)
                     std::thread::sleep(std::time::Duration::from_micros(1));
                 }
@@ -83,16 +89,24 @@ impl InceptionLayerState {
                     }
                 }
             }
-            crate::sync::Task::Reingest { vpath, temp_path } => {
+            crate::sync::Task::Reingest {
+                vpath,
+                temp_path,
+                delta,
+            } => {
                 if let Some(state) = InceptionLayerState::get_no_spawn() {
+                    let size = temp_file_size(&temp_path);
                     unsafe {
                         if crate::ipc::sync_ipc_manifest_reingest(
                             &state.socket_path,
                             &vpath,
                             &temp_path,
+                            delta,
                         ) {
                             // M4: Clear dirty status ONLY after the daemon confirms reingest.
                             DIRTY_TRACKER.clear_dirty(&vpath);
+                            super::metric_add(super::Metric::ReingestFile, 1);
+                            super::metric_add(super::Metric::ReingestBytes, size);
                         }
                     }
                 }
@@ -113,3 +127,20 @@ impl InceptionLayerState {
         }
     }
 }
+
+/// Size of a staged file (raw stat: the worker must not re-enter the shim)
+fn temp_file_size(path: &str) -> u64 {
+    let Ok(cpath) = std::ffi::CString::new(path) else {
+        return 0;
+    };
+    let mut buf: libc::stat = unsafe { std::mem::zeroed() };
+    #[cfg(target_os = "macos")]
+    let res = unsafe { crate::syscalls::macos_raw::raw_stat(cpath.as_ptr(), &mut buf) };
+    #[cfg(target_os = "linux")]
+    let res = unsafe { crate::syscalls::linux_raw::raw_stat(cpath.as_ptr(), &mut buf) };
+    if res == 0 {
+        buf.st_size as u64
+    } else {
+        0
+    }
+}
@@ -0,0 +1,302 @@
+// =============================================================================
+// ConnPool: Lock-free pool of persistent IPC socket FDs
+// =============================================================================
+//
+// Each slot holds at most one idle connection. A thread checks a connection
+// OUT (exclusive ownership, no other thread can touch the socket), uses it,
+// and checks it back IN. Ownership handoff is a per-slot CAS state machine:
+//
+//   EMPTY ──checkin CAS──▶ BUSY ──publish──▶ IDLE
+//   IDLE  ──checkout CAS─▶ BUSY ──release──▶ EMPTY
+//
+// ZERO ALLOCATIONS, ZERO SYSCALLS — the pool only does bookkeeping. Closing,
+// validating (fstat identity) and fork handling are done by the caller through
+// RawContext (see ipc.rs), so this module never re-enters the inception layer.
+// =============================================================================
+
+use libc::c_int;
+use std::sync::atomic::{AtomicI32, AtomicU32, AtomicU64, AtomicU8, Ordering};
+
+/// Max idle connections kept per process (shared by daemon + vDird sockets)
+pub const POOL_SLOTS: usize = 16;
+
+const SLOT_EMPTY: u8 = 0;
+const SLOT_BUSY: u8 = 1;
+const SLOT_IDLE: u8 = 2;
+
+/// A checked-out connection. Owned exclusively by the current thread until
+/// it is checked back in or closed.
+#[derive(Debug, Clone, Copy)]
+pub struct PooledConn {
+    pub fd: c_int,
+    /// FNV-1a hash of the socket path this connection was opened against
+    pub socket_hash: u64,
+    /// st_ino of the socket at connect time — detects FD number reuse if the
+    /// application closed our FD behind our back (e.g. closefrom/close_range)
+    pub ino: u64,
+    /// Fire-and-forget requests whose responses have not been read yet
+    pub unacked: u32,
+    /// True if this connection was freshly connected (never pooled)
+    pub fresh: bool,
+}
+
+// One slot per cache line: concurrent checkouts from different threads
+// must not false-share.
+#[repr(align(64))]
+struct Slot {
+    state: AtomicU8,
+    fd: AtomicI32,
+    socket_hash: AtomicU64,
+    ino: AtomicU64,
+    unacked: AtomicU32,
+}
+
+impl Slot {
+    const fn new() -> Self {
+        Self {
+            state: AtomicU8::new(SLOT_EMPTY),
+            fd: AtomicI32::new(-1),
+            socket_hash: AtomicU64::new(0),
+            ino: AtomicU64::new(0),
+            unacked: AtomicU32::new(0),
+        }
+    }
+}
+
+pub struct ConnPool {
+    slots: [Slot; POOL_SLOTS],
+}
+
+impl Default for ConnPool {
+    fn default() -> Self {
+        Self::new()
+    }
+}
+
+impl ConnPool {
+    pub const fn new() -> Self {
+        Self {
+            slots: [const { Slot::new() }; POOL_SLOTS],
+        }
+    }
+
+    /// Take an idle connection to `socket_hash`, if any.
+    #[inline]
+    pub fn checkout(&self, socket_hash: u64) -> Option<PooledConn> {
+        for slot in &self.slots {
+            if slot.state.load(Ordering::Relaxed) != SLOT_IDLE
+                || slot.socket_hash.load(Ordering::Relaxed) != socket_hash
+            {
+                continue;
+            }
+            if slot
+                .state
+                .compare_exchange(SLOT_IDLE, SLOT_BUSY, Ordering::Acquire, Ordering::Relaxed)
+                .is_err()
+            {
+                continue; // Another thread won the race
+            }
+            // Re-check under ownership: the slot may have been recycled for
+            // another socket between the relaxed probe and the CAS.
+            if slot.socket_hash.load(Ordering::Relaxed) != socket_hash {
+                slot.state.store(SLOT_IDLE, Ordering::Release);
+                continue;
+            }
+            let conn = PooledConn {
+                fd: slot.fd.swap(-1, Ordering::Relaxed),
+                socket_hash,
+                ino: slot.ino.load(Ordering::Relaxed),
+                unacked: slot.unacked.load(Ordering::Relaxed),
+                fresh: false,
+            };
+            slot.state.store(SLOT_EMPTY, Ordering::Release);
+            return Some(conn);
+        }
+        None
+    }
+
+    /// Return a connection to the pool. If every slot is occupied the
+    /// connection is handed back so the caller can close it.
+    #[inline]
+    pub fn checkin(&self, conn: PooledConn) -> Result<(), PooledConn> {
+        for slot in &self.slots {
+            if slot
+                .state
+                .compare_exchange(SLOT_EMPTY, SLOT_BUSY, Ordering::Acquire, Ordering::Relaxed)
+                .is_err()
+            {
+                continue;
+            }
+            slot.fd.store(conn.fd, Ordering::Relaxed);
+            slot.socket_hash.store(conn.socket_hash, Ordering::Relaxed);
+            slot.ino.store(conn.ino, Ordering::Relaxed);
+            slot.unacked.store(conn.unacked, Ordering::Relaxed);
+            slot.state.store(SLOT_IDLE, Ordering::Release);
+            return Ok(());
+        }
+        Err(conn)
+    }
+
+    /// Remove every idle connection, passing each FD to `close`.
+    /// Used when the circuit breaker trips and in the post-fork child.
+    pub fn drain(&self, mut close: impl FnMut(c_int)) {
+        for slot in &self.slots {
+            if slot
+                .state
+                .compare_exchange(SLOT_IDLE, SLOT_BUSY, Ordering::Acquire, Ordering::Relaxed)
+                .is_ok()
+            {
+                let fd = slot.fd.swap(-1, Ordering::Relaxed);
+                slot.state.store(SLOT_EMPTY, Ordering::Release);
+                if fd >= 0 {
+                    close(fd);
+                }
+            }
+        }
+    }
+
+    /// Reset the pool in a freshly forked child.
+    ///
+    /// Only the forking thread survives fork(), so a slot left BUSY by another
+    /// parent thread will never be released; force every slot back to EMPTY.
+    /// The inherited sockets are shared with the parent and MUST NOT be used
+    /// by the child — closing the child's copy is safe.
+    pub fn reset_after_fork(&self, mut close: impl FnMut(c_int)) {
+        for slot in &self.slots {
+            let state = slot.state.swap(SLOT_EMPTY, Ordering::AcqRel);
+            let fd = slot.fd.swap(-1, Ordering::Relaxed);
+            if state == SLOT_IDLE && fd >= 0 {
+                close(fd);
+            }
+        }
+    }
+
+    /// Number of idle connections (for debugging)
+    pub fn idle_count(&self) -> usize {
+        self.slots
+            .iter()
+            .filter(|s| s.state.load(Ordering::Relaxed) == SLOT_IDLE)
+            .count()
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    fn conn(fd: c_int, socket_hash: u64) -> PooledConn {
+        PooledConn {
+            fd,
+            socket_hash,
+            ino: fd as u64 + 1000,
+            unacked: 0,
+            fresh: true,
+        }
+    }
+
+    #[test]
+    fn test_checkout_empty_pool() {
+        let pool = ConnPool::new();
+        assert!(pool.checkout(42).is_none());
+    }
+
+    #[test]
+    fn test_checkin_then_checkout() {
+        let pool = ConnPool::new();
+        assert!(pool.checkin(conn(7, 42)).is_ok());
+        assert_eq!(pool.idle_count(), 1);
+
+        let c = pool.checkout(42).unwrap();
+        assert_eq!(c.fd, 7);
+        assert_eq!(c.ino, 1007);
+        assert!(!c.fresh);
+        assert_eq!(pool.idle_count(), 0);
+        assert!(pool.checkout(42).is_none());
+    }
+
+    #[test]
+    fn test_checkout_filters_by_socket() {
+        let pool = ConnPool::new();
+        pool.checkin(conn(7, 1)).unwrap();
+        assert!(pool.checkout(2).is_none());
+        assert_eq!(pool.checkout(1).unwrap().fd, 7);
+    }
+
+    #[test]
+    fn test_checkin_full_pool_returns_conn() {
+        let pool = ConnPool::new();
+        for i in 0..POOL_SLOTS {
+            pool.checkin(conn(i as c_int, 1)).unwrap();
+        }
+        let overflow = pool.checkin(conn(99, 1)).unwrap_err();
+        assert_eq!(overflow.fd, 99);
+    }
+
+    #[test]
+    fn test_unacked_preserved() {
+        let pool = ConnPool::new();
+        let mut c = conn(3, 1);
+        c.unacked = 5;
+        pool.checkin(c).unwrap();
+        assert_eq!(pool.checkout(1).unwrap().unacked, 5);
+    }
+
+    #[test]
+    fn test_drain_closes_idle() {
+        let pool = ConnPool::new();
+        pool.checkin(conn(3, 1)).unwrap();
+        pool.checkin(conn(4, 2)).unwrap();
+        let mut closed = Vec::new();
+        pool.drain(|fd| closed.push(fd));
+        closed.sort();
+        assert_eq!(closed, vec![3, 4]);
+        assert_eq!(pool.idle_count(), 0);
+    }
+
+    #[test]
+    fn test_reset_after_fork_clears_busy() {
+        let pool = ConnPool::new();
+        pool.checkin(conn(3, 1)).unwrap();
+        // Simulate a slot left BUSY by a thread that does not exist in the child
+        pool.slots[5].state.store(SLOT_BUSY, Ordering::Relaxed);
+
+        let mut closed = Vec::new();
+        pool.reset_after_fork(|fd| closed.push(fd));
+        assert_eq!(closed, vec![3]);
+        assert!(pool
+            .slots
+            .iter()
+            .all(|s| s.state.load(Ordering::Relaxed) == SLOT_EMPTY));
+    }
+
+    #[test]
+    fn test_concurrent_checkout_is_exclusive() {
+        use std::sync::Arc;
+        use std::thread;
+
+        let pool = Arc::new(ConnPool::new());
+        for i in 0..8 {
+            pool.checkin(conn(i, 1)).unwrap();
+        }
+        let handles: Vec<_> = (0..4)
+            .map(|_| {
+                let pool = Arc::clone(&pool);
+                thread::spawn(move || {
+                    for _ in 0..10_000 {
+                        if let Some(c) = pool.checkout(1) {
+                            pool.checkin(c).unwrap();
+                        }
+                    }
+                })
+            })
+            .collect();
+        for h in handles {
+            h.join().unwrap();
+        }
+        // No connection lost or duplicated
+        let mut fds = Vec::new();
+        pool.drain(|fd| fds.push(fd));
+        fds.sort();
+        assert_eq!(fds, (0..8).collect::<Vec<_>>());
+    }
+}
@@ -1,9 +1,15 @@
+pub mod conn_pool;
 pub mod fd_table;
+pub mod probe_cache;
 pub mod recursive_mutex;
+pub mod resolve_cache;
 pub mod ring_buffer;
 
+pub use conn_pool::{ConnPool, PooledConn};
 pub use fd_table::FdTable;
+pub use probe_cache::ProbeCache;
 pub use recursive_mutex::RecursiveMutex;
+pub(crate) use resolve_cache::ResolveCache;
 pub use ring_buffer::{RingBuffer, Task};
 
 use std::cell::UnsafeCell;
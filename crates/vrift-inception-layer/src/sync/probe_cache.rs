@@ -0,0 +1,453 @@
+// =============================================================================
+// ProbeCache: Local positive/negative manifest cache for directory bursts
+// =============================================================================
+//
+// Compilers and module resolvers probe many sibling paths in a row (include
+// search paths, package.json walk-ups). Paths that miss the VDir mmap used to
+// cost one vDird round trip EACH. Once a directory has been probed a few
+// times, ipc.rs lists it and fetches all children in one ManifestGetMany
+// frame; this cache then answers every later probe under that directory
+// locally — positives from the batch, negatives from the "complete" marker.
+//
+// Coherence: every slot is stamped with (VDir generation, local epoch).
+//   - VDir generation: bumped by vDird on ANY manifest write, from any process
+//   - local epoch: bumped by this process when it sends a manifest mutation
+//     that vDird may not have applied yet
+// A slot is only valid when both match the current values, so a mutation
+// anywhere invalidates the whole cache at once (O(1), no sweep).
+//
+// Completeness invariant: a slot valid for the current stamp is NEVER
+// overwritten. A directory is only marked complete after every child was
+// inserted under that stamp, so "not in cache + parent complete" really
+// means "not in manifest".
+//
+// Each slot is guarded by its own seqlock (odd = writer active), the same
+// scheme as the VDir mmap. ZERO ALLOCATIONS, ZERO SYSCALLS.
+// =============================================================================
+
+use std::cell::UnsafeCell;
+use std::sync::atomic::{fence, AtomicU32, AtomicU64, Ordering};
+
+/// Total slots (files + directory markers)
+pub const PROBE_CACHE_SLOTS: usize = 4096;
+
+/// Linear probe window; a slot run longer than this is treated as full
+const PROBE_WINDOW: usize = 16;
+
+/// Directory misses (per stamp) before the directory is warmed in bulk
+pub const WARM_AFTER_MISSES: u32 = 3;
+
+/// Directory markers use a salted key so they never collide with the
+/// directory's own file-level entry.
+const DIR_SALT: u64 = 0x9e37_79b9_7f4a_7c15;
+
+const KIND_EMPTY: u8 = 0;
+const KIND_POSITIVE: u8 = 1;
+const KIND_NEGATIVE: u8 = 2;
+/// Directory seen missing; `misses` counts probes under it
+const KIND_DIR_PROBED: u8 = 3;
+/// Every child of the directory is cached (missing child = negative)
+const KIND_DIR_COMPLETE: u8 = 4;
+/// Directory too large to warm; stop counting until the next stamp
+const KIND_DIR_SKIP: u8 = 5;
+
+/// Result of a cache probe
+#[derive(Debug, PartialEq, Eq)]
+pub enum Probe {
+    Hit(vrift_ipc::VnodeEntry),
+    Negative,
+    Miss,
+}
+
+#[derive(Clone, Copy)]
+struct SlotData {
+    key: u64,
+    generation: u64,
+    epoch: u64,
+    kind: u8,
+    misses: u32,
+    content_hash: [u8; 32],
+    size: u64,
+    mtime: u64,
+    mode: u32,
+    flags: u16,
+}
+
+impl SlotData {
+    const fn empty() -> Self {
+        Self {
+            key: 0,
+            generation: 0,
+            epoch: 0,
+            kind: KIND_EMPTY,
+            misses: 0,
+            content_hash: [0; 32],
+            size: 0,
+            mtime: 0,
+            mode: 0,
+            flags: 0,
+        }
+    }
+
+    #[inline]
+    fn is_current(&self, generation: u64, epoch: u64) -> bool {
+        self.kind != KIND_EMPTY && self.generation == generation && self.epoch == epoch
+    }
+}
+
+struct Slot {
+    seq: AtomicU32,
+    /// Copy of data.key for a lock-free pre-filter while probing
+    key: AtomicU64,
+    data: UnsafeCell<SlotData>,
+}
+
+impl Slot {
+    const fn new() -> Self {
+        Self {
+            seq: AtomicU32::new(0),
+            key: AtomicU64::new(0),
+            data: UnsafeCell::new(SlotData::empty()),
+        }
+    }
+
+    /// Seqlock read. None if a writer is active or raced with us.
+    #[inline]
+    fn read(&self) -> Option<SlotData> {
+        let s1 = self.seq.load(Ordering::Acquire);
+        if s1 & 1 != 0 {
+            return None;
+        }
+        // SAFETY: torn reads are detected by the sequence check below
+        let data = unsafe { std::ptr::read_volatile(self.data.get()) };
+        fence(Ordering::Acquire);
+        if self.seq.load(Ordering::Relaxed) != s1 {
+            return None;
+        }
+        Some(data)
+    }
+
+    /// Take the slot's write lock. Returns the even sequence it was taken at.
+    #[inline]
+    fn try_lock(&self) -> Option<u32> {
+        let s = self.seq.load(Ordering::Relaxed);
+        if s & 1 != 0 {
+            return None;
+        }
+        self.seq
+            .compare_exchange(s, s + 1, Ordering::Acquire, Ordering::Relaxed)
+            .ok()?;
+        fence(Ordering::Release);
+        Some(s)
+    }
+
+    #[inline]
+    fn unlock(&self, s: u32) {
+        self.seq.store(s.wrapping_add(2), Ordering::Release);
+    }
+}
+
+// SAFETY: slot data is only written under the per-slot seqlock
+unsafe impl Sync for Slot {}
+
+pub struct ProbeCache {
+    slots: [Slot; PROBE_CACHE_SLOTS],
+    epoch: AtomicU64,
+}
+
+impl Default for ProbeCache {
+    fn default() -> Self {
+        Self::new()
+    }
+}
+
+impl ProbeCache {
+    pub const fn new() -> Self {
+        Self {
+            slots: [const { Slot::new() }; PROBE_CACHE_SLOTS],
+            epoch: AtomicU64::new(0),
+        }
+    }
+
+    /// Current local epoch (read BEFORE issuing the IPC whose result is cached)
+    #[inline]
+    pub fn epoch(&self) -> u64 {
+        self.epoch.load(Ordering::Acquire)
+    }
+
+    /// Invalidate everything: this process sent a manifest mutation.
+    #[inline]
+    pub fn invalidate(&self) {
+        self.epoch.fetch_add(1, Ordering::AcqRel);
+    }
+
+    #[inline]
+    fn find(&self, key: u64, generation: u64, epoch: u64) -> Option<SlotData> {
+        let start = (key as usize) % PROBE_CACHE_SLOTS;
+        for i in 0..PROBE_WINDOW {
+            let slot = &self.slots[(start + i) % PROBE_CACHE_SLOTS];
+            if slot.key.load(Ordering::Relaxed) != key {
+                continue;
+            }
+            if let Some(data) = slot.read() {
+                if data.key == key && data.is_current(generation, epoch) {
+                    return Some(data);
+                }
+            }
+        }
+        None
+    }
+
+    /// Lock a slot that may hold `key`: one already holding it, an empty one,
+    /// or one whose stamp is stale. Never evicts a current entry.
+    #[inline]
+    fn lock_for(&self, key: u64, generation: u64, epoch: u64) -> Option<(&Slot, u32)> {
+        let start = (key as usize) % PROBE_CACHE_SLOTS;
+        let mut candidate = None;
+        for i in 0..PROBE_WINDOW {
+            let slot = &self.slots[(start + i) % PROBE_CACHE_SLOTS];
+            let Some(s) = slot.try_lock() else {
+                continue;
+            };
+            // SAFETY: we hold the slot's write lock
+            let data = unsafe { &*slot.data.get() };
+            if data.key == key && data.kind != KIND_EMPTY {
+                // Existing entry for this key always wins over a free slot
+                if let Some((c, cs)) = candidate {
+                    Slot::unlock(c, cs);
+                }
+                return Some((slot, s));
+            }
+            if candidate.is_none() && !data.is_current(generation, epoch) {
+                candidate = Some((slot, s));
+                continue;
+            }
+            slot.unlock(s);
+        }
+        candidate
+    }
+
+    #[inline]
+    fn dir_key(parent_hash: u64) -> u64 {
+        parent_hash ^ DIR_SALT
+    }
+
+    /// Probe for `key_hash` (a manifest key) under `parent_hash` (its directory).
+    pub fn lookup(&self, key_hash: u64, parent_hash: u64, generation: u64, epoch: u64) -> Probe {
+        if let Some(data) = self.find(key_hash, generation, epoch) {
+            return match data.kind {
+                KIND_POSITIVE => Probe::Hit(vrift_ipc::VnodeEntry {
+                    content_hash: data.content_hash,
+                    size: data.size,
+                    mtime: data.mtime,
+                    mode: data.mode,
+                    flags: data.flags,
+                    _pad: 0,
+                }),
+                KIND_NEGATIVE => Probe::Negative,
+                _ => Probe::Miss,
+            };
+        }
+        match self.find(Self::dir_key(parent_hash), generation, epoch) {
+            Some(data) if data.kind == KIND_DIR_COMPLETE => Probe::Negative,
+            _ => Probe::Miss,
+        }
+    }
+
+    /// Cache the manifest answer for `key_hash` (None = not found).
+    /// Returns false if the probe window is full.
+    pub fn insert(
+        &self,
+        key_hash: u64,
+        entry: Option<&vrift_ipc::VnodeEntry>,
+        generation: u64,
+        epoch: u64,
+    ) -> bool {
+        let Some((slot, s)) = self.lock_for(key_hash, generation, epoch) else {
+            return false;
+        };
+        let mut data = SlotData::empty();
+        data.key = key_hash;
+        data.generation = generation;
+        data.epoch = epoch;
+        match entry {
+            Some(e) => {
+                data.kind = KIND_POSITIVE;
+                data.content_hash = e.content_hash;
+                data.size = e.size;
+                data.mtime = e.mtime;
+                data.mode = e.mode;
+                data.flags = e.flags;
+            }
+            None => data.kind = KIND_NEGATIVE,
+        }
+        // SAFETY: we hold the slot's write lock
+        unsafe { std::ptr::write_volatile(slot.data.get(), data) };
+        slot.key.store(key_hash, Ordering::Relaxed);
+        slot.unlock(s);
+        true
+    }
+
+    /// Count a VDir miss under `parent_hash`. Returns the number of misses
+    /// seen for that directory under the current stamp, or 0 if the
+    /// directory is already warmed or marked as not worth warming.
+    pub fn note_dir_miss(&self, parent_hash: u64, generation: u64, epoch: u64) -> u32 {
+        let key = Self::dir_key(parent_hash);
+        let Some((slot, s)) = self.lock_for(key, generation, epoch) else {
+            return 0;
+        };
+        // SAFETY: we hold the slot's write lock
+        let data = unsafe { &mut *slot.data.get() };
+        let misses = if data.key == key && data.is_current(generation, epoch) {
+            if data.kind != KIND_DIR_PROBED {
+                slot.unlock(s);
+                return 0;
+            }
+            data.misses.saturating_add(1)
+        } else {
+            1
+        };
+        *data = SlotData::empty();
+        data.key = key;
+        data.generation = generation;
+        data.epoch = epoch;
+        data.kind = KIND_DIR_PROBED;
+        data.misses = misses;
+        slot.key.store(key, Ordering::Relaxed);
+        slot.unlock(s);
+        misses
+    }
+
+    /// Finish a bulk warm of `parent_hash`. `complete` must only be true if
+    /// every child was inserted under this same (generation, epoch).
+    pub fn finish_dir_warm(&self, parent_hash: u64, complete: bool, generation: u64, epoch: u64) {
+        let key = Self::dir_key(parent_hash);
+        let Some((slot, s)) = self.lock_for(key, generation, epoch) else {
+            return;
+        };
+        // SAFETY: we hold the slot's write lock
+        let data = unsafe { &mut *slot.data.get() };
+        *data = SlotData::empty();
+        data.key = key;
+        data.generation = generation;
+        data.epoch = epoch;
+        data.kind = if complete {
+            KIND_DIR_COMPLETE
+        } else {
+            KIND_DIR_SKIP
+        };
+        slot.key.store(key, Ordering::Relaxed);
+        slot.unlock(s);
+    }
+}
+
+/// Parent directory of a manifest key ("/a/b.h" → "/a", "/b.h" → "/")
+#[inline]
+pub fn parent_key(key: &str) -> &str {
+    match key.rfind('/') {
+        Some(0) => "/",
+        Some(i) => &key[..i],
+        None => "",
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    fn entry(size: u64) -> vrift_ipc::VnodeEntry {
+        vrift_ipc::VnodeEntry {
+            content_hash: [size as u8; 32],
+            size,
+            mtime: 1,
+            mode: 0o644,
+            flags: 0,
+            _pad: 0,
+        }
+    }
+
+    #[test]
+    fn test_empty_cache_misses() {
+        let cache = ProbeCache::new();
+        assert_eq!(cache.lookup(1, 2, 0, 0), Probe::Miss);
+    }
+
+    #[test]
+    fn test_positive_and_negative() {
+        let cache = ProbeCache::new();
+        assert!(cache.insert(10, Some(&entry(5)), 2, 0));
+        assert!(cache.insert(11, None, 2, 0));
+        match cache.lookup(10, 99, 2, 0) {
+            Probe::Hit(e) => assert_eq!(e.size, 5),
+            other => panic!("expected hit, got {:?}", other),
+        }
+        assert_eq!(cache.lookup(11, 99, 2, 0), Probe::Negative);
+    }
+
+    #[test]
+    fn test_generation_change_invalidates() {
+        let cache = ProbeCache::new();
+        cache.insert(10, Some(&entry(5)), 2, 0);
+        assert_eq!(cache.lookup(10, 99, 4, 0), Probe::Miss);
+    }
+
+    #[test]
+    fn test_local_epoch_invalidates() {
+        let cache = ProbeCache::new();
+        let epoch = cache.epoch();
+        cache.insert(10, Some(&entry(5)), 2, epoch);
+        cache.invalidate();
+        assert_eq!(cache.lookup(10, 99, 2, cache.epoch()), Probe::Miss);
+    }
+
+    #[test]
+    fn test_complete_dir_answers_negative() {
+        let cache = ProbeCache::new();
+        cache.insert(10, Some(&entry(5)), 2, 0);
+        cache.finish_dir_warm(99, true, 2, 0);
+        assert!(matches!(cache.lookup(10, 99, 2, 0), Probe::Hit(_)));
+        assert_eq!(cache.lookup(12345, 99, 2, 0), Probe::Negative);
+        // Other directories are unaffected
+        assert_eq!(cache.lookup(12345, 98, 2, 0), Probe::Miss);
+    }
+
+    #[test]
+    fn test_note_dir_miss_counts_and_stops() {
+        let cache = ProbeCache::new();
+        assert_eq!(cache.note_dir_miss(99, 2, 0), 1);
+        assert_eq!(cache.note_dir_miss(99, 2, 0), 2);
+        // New generation restarts the count
+        assert_eq!(cache.note_dir_miss(99, 4, 0), 1);
+        cache.finish_dir_warm(99, false, 4, 0);
+        assert_eq!(cache.note_dir_miss(99, 4, 0), 0);
+        assert_eq!(cache.lookup(1, 99, 4, 0), Probe::Miss);
+    }
+
+    #[test]
+    fn test_current_entries_are_never_evicted() {
+        let cache = ProbeCache::new();
+        // Fill one probe window with keys that share a start slot
+        let base = 7u64;
+        for i in 0..PROBE_WINDOW as u64 {
+            assert!(cache.insert(base + i * PROBE_CACHE_SLOTS as u64, None, 2, 0));
+        }
+        assert!(!cache.insert(base + 1000 * PROBE_CACHE_SLOTS as u64, None, 2, 0));
+        // Stale entries are reusable
+        assert!(cache.insert(base + 1000 * PROBE_CACHE_SLOTS as u64, None, 4, 0));
+    }
+
+    #[test]
+    fn test_reinsert_same_key_updates() {
+        let cache = ProbeCache::new();
+        cache.insert(10, None, 2, 0);
+        cache.insert(10, Some(&entry(8)), 2, 0);
+        assert!(matches!(cache.lookup(10, 99, 2, 0), Probe::Hit(e) if e.size == 8));
+    }
+
+    #[test]
+    fn test_parent_key() {
+        assert_eq!(parent_key("/a/b/c.h"), "/a/b");
+        assert_eq!(parent_key("/c.h"), "/");
+        assert_eq!(parent_key("c.h"), "");
+    }
+}
@@ -0,0 +1,278 @@
+// =============================================================================
+// ResolveCache: raw path → VfsPath resolution cache
+// =============================================================================
+//
+// PathResolver::resolve runs on every intercepted path syscall: a join with
+// project_root, normalization, prefix checks and manifest-key extraction.
+// Toolchains pass the same few thousand paths over and over, so the answer
+// — including "not in the VFS", by far the most common one — is cached here.
+//
+// Keying: the raw path's VDirKey (64-bit FNV-1a + 32-bit secondary hash, the
+// same identity the VDir relies on) plus a fingerprint of the resolver
+// configuration. Relative paths resolve against project_root, never the
+// process cwd, so no cwd generation is involved.
+//
+// A slot stores the normalized absolute path once; the manifest key is kept
+// as a suffix of it (resolutions where it is not a suffix are not cached).
+//
+// Direct-mapped: a colliding insert simply replaces the slot. Each slot is
+// guarded by its own seqlock like ProbeCache; a reader racing a writer just
+// misses. ZERO ALLOCATIONS, ZERO SYSCALLS.
+// =============================================================================
+
+use std::cell::UnsafeCell;
+use std::sync::atomic::{fence, AtomicU32, Ordering};
+
+use crate::path::VfsPath;
+use crate::state::FixedString;
+
+/// Total slots (power of two)
+pub const RESOLVE_CACHE_SLOTS: usize = 1024;
+
+/// Longest normalized absolute path that is cached
+pub const RESOLVE_CACHE_PATH_MAX: usize = 256;
+
+const KIND_EMPTY: u8 = 0;
+/// Path is outside the VFS domain
+const KIND_OUTSIDE: u8 = 1;
+/// Path resolved to a VfsPath
+const KIND_INSIDE: u8 = 2;
+
+#[derive(Clone, Copy)]
+struct SlotData {
+    raw_hash: u64,
+    raw_check: u32,
+    kind: u8,
+    abs_len: u16,
+    key_start: u16,
+    fingerprint: u64,
+    manifest_key_hash: u64,
+    absolute: [u8; RESOLVE_CACHE_PATH_MAX],
+}
+
+impl SlotData {
+    const fn empty() -> Self {
+        Self {
+            raw_hash: 0,
+            raw_check: 0,
+            kind: KIND_EMPTY,
+            abs_len: 0,
+            key_start: 0,
+            fingerprint: 0,
+            manifest_key_hash: 0,
+            absolute: [0; RESOLVE_CACHE_PATH_MAX],
+        }
+    }
+}
+
+struct Slot {
+    seq: AtomicU32,
+    data: UnsafeCell<SlotData>,
+}
+
+impl Slot {
+    const fn new() -> Self {
+        Self {
+            seq: AtomicU32::new(0),
+            data: UnsafeCell::new(SlotData::empty()),
+        }
+    }
+
+    /// Seqlock read. None if a writer is active or raced with us.
+    #[inline]
+    fn read(&self) -> Option<SlotData> {
+        let s1 = self.seq.load(Ordering::Acquire);
+        if s1 & 1 != 0 {
+            return None;
+        }
+        // SAFETY: torn reads are detected by the sequence check below
+        let data = unsafe { std::ptr::read_volatile(self.data.get()) };
+        fence(Ordering::Acquire);
+        if self.seq.load(Ordering::Relaxed) != s1 {
+            return None;
+        }
+        Some(data)
+    }
+
+    /// Take the slot's write lock. Returns the even sequence it was taken at.
+    #[inline]
+    fn try_lock(&self) -> Option<u32> {
+        let s = self.seq.load(Ordering::Relaxed);
+        if s & 1 != 0 {
+            return None;
+        }
+        self.seq
+            .compare_exchange(s, s + 1, Ordering::Acquire, Ordering::Relaxed)
+            .ok()?;
+        fence(Ordering::Release);
+        Some(s)
+    }
+
+    #[inline]
+    fn unlock(&self, s: u32) {
+        self.seq.store(s.wrapping_add(2), Ordering::Release);
+    }
+}
+
+// SAFETY: slot data is only written under the per-slot seqlock
+unsafe impl Sync for Slot {}
+
+pub(crate) struct ResolveCache {
+    slots: [Slot; RESOLVE_CACHE_SLOTS],
+}
+
+impl Default for ResolveCache {
+    fn default() -> Self {
+        Self::new()
+    }
+}
+
+impl ResolveCache {
+    pub const fn new() -> Self {
+        Self {
+            slots: [const { Slot::new() }; RESOLVE_CACHE_SLOTS],
+        }
+    }
+
+    #[inline(always)]
+    fn slot(&self, raw_hash: u64) -> &Slot {
+        &self.slots[raw_hash as usize & (RESOLVE_CACHE_SLOTS - 1)]
+    }
+
+    /// Cached resolution of a raw path: `Some(None)` = outside the VFS,
+    /// `Some(Some(vpath))` = resolved, None = not cached.
+    #[inline]
+    pub fn lookup(
+        &self,
+        raw_hash: u64,
+        raw_check: u32,
+        fingerprint: u64,
+    ) -> Option<Option<VfsPath>> {
+        let data = self.slot(raw_hash).read()?;
+        if data.kind == KIND_EMPTY
+            || data.raw_hash != raw_hash
+            || data.raw_check != raw_check
+            || data.fingerprint != fingerprint
+        {
+            return None;
+        }
+        if data.kind == KIND_OUTSIDE {
+            return Some(None);
+        }
+        let abs_len = (data.abs_len as usize).min(RESOLVE_CACHE_PATH_MAX);
+        let absolute = std::str::from_utf8(&data.absolute[..abs_len]).ok()?;
+        let manifest_key = absolute.get(data.key_start as usize..)?;
+        let mut vpath = VfsPath {
+            absolute: FixedString::new(),
+            manifest_key: FixedString::new(),
+            manifest_key_hash: data.manifest_key_hash,
+        };
+        vpath.absolute.set(absolute);
+        vpath.manifest_key.set(manifest_key);
+        Some(Some(vpath))
+    }
+
+    /// Cache the resolution of a raw path (None = outside the VFS). Paths
+    /// too long to store, or whose manifest key is not a suffix of the
+    /// absolute path, are skipped.
+    pub fn insert(
+        &self,
+        raw_hash: u64,
+        raw_check: u32,
+        fingerprint: u64,
+        resolved: Option<&VfsPath>,
+    ) {
+        let mut data = SlotData::empty();
+        data.raw_hash = raw_hash;
+        data.raw_check = raw_check;
+        data.fingerprint = fingerprint;
+        match resolved {
+            None => data.kind = KIND_OUTSIDE,
+            Some(vpath) => {
+                let absolute = vpath.absolute.as_str();
+                let key = vpath.manifest_key.as_str();
+                if absolute.len() > RESOLVE_CACHE_PATH_MAX || !absolute.ends_with(key) {
+                    return;
+                }
+                data.kind = KIND_INSIDE;
+                data.abs_len = absolute.len() as u16;
+                data.key_start = (absolute.len() - key.len()) as u16;
+                data.manifest_key_hash = vpath.manifest_key_hash;
+                data.absolute[..absolute.len()].copy_from_slice(absolute.as_bytes());
+            }
+        }
+
+        let slot = self.slot(raw_hash);
+        let Some(s) = slot.try_lock() else {
+            return; // Another thread is filling this slot
+        };
+        // SAFETY: we hold the slot's write lock
+        unsafe { std::ptr::write_volatile(slot.data.get(), data) };
+        slot.unlock(s);
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    fn vpath(absolute: &str, key: &str) -> VfsPath {
+        let mut v = VfsPath {
+            absolute: FixedString::new(),
+            manifest_key: FixedString::new(),
+            manifest_key_hash: vrift_ipc::fnv1a_hash(key),
+        };
+        v.absolute.set(absolute);
+        v.manifest_key.set(key);
+        v
+    }
+
+    #[test]
+    fn test_empty_cache_misses() {
+        let cache = ResolveCache::new();
+        assert!(cache.lookup(1, 2, 3).is_none());
+    }
+
+    #[test]
+    fn test_inside_and_outside() {
+        let cache = ResolveCache::new();
+        cache.insert(10, 1, 7, Some(&vpath("/proj/src/a.rs", "/src/a.rs")));
+        cache.insert(11, 1, 7, None);
+
+        let hit = cache.lookup(10, 1, 7).unwrap().unwrap();
+        assert_eq!(hit.absolute.as_str(), "/proj/src/a.rs");
+        assert_eq!(hit.manifest_key.as_str(), "/src/a.rs");
+        assert_eq!(hit.manifest_key_hash, vrift_ipc::fnv1a_hash("/src/a.rs"));
+        assert!(cache.lookup(11, 1, 7).unwrap().is_none());
+    }
+
+    #[test]
+    fn test_check_and_fingerprint_must_match() {
+        let cache = ResolveCache::new();
+        cache.insert(10, 1, 7, None);
+        assert!(cache.lookup(10, 2, 7).is_none()); // 64-bit hash collision
+        assert!(cache.lookup(10, 1, 8).is_none()); // Other resolver config
+    }
+
+    #[test]
+    fn test_collision_replaces_slot() {
+        let cache = ResolveCache::new();
+        cache.insert(10, 1, 7, None);
+        cache.insert(10 + RESOLVE_CACHE_SLOTS as u64, 1, 7, None);
+        assert!(cache.lookup(10, 1, 7).is_none());
+        assert!(cache
+            .lookup(10 + RESOLVE_CACHE_SLOTS as u64, 1, 7)
+            .is_some());
+    }
+
+    #[test]
+    fn test_uncacheable_resolutions_are_skipped() {
+        let cache = ResolveCache::new();
+        // Key is not a suffix of the absolute path (project root itself)
+        cache.insert(10, 1, 7, Some(&vpath("/proj", "/")));
+        assert!(cache.lookup(10, 1, 7).is_none());
+        let long = format!("/proj/{}", "x".repeat(RESOLVE_CACHE_PATH_MAX));
+        cache.insert(11, 1, 7, Some(&vpath(&long, &long[5..])));
+        assert!(cache.lookup(11, 1, 7).is_none());
+    }
+}
@@ -13,6 +13,7 @@ pub enum Task {
     Reingest {
         vpath: String,
         temp_path: String,
+        delta: Option<vrift_ipc::ReingestDelta>,
     },
     Log(String),
     /// Phase 3: Fire-and-forget IPC — pre-serialized request bytes pushed to worker.
@@ -37,40 +37,61 @@ pub unsafe extern "C" fn opendir_inception(path: *const libc::c_char) -> *mut c_
     };
 
     // Check if path is in VFS domain
-    if !state.inception_applicable(path_str) {
-        return real(path);
+    let vpath = match state.resolve_path(path_str) {
+        Some(v) => v,
+        None => return real(path),
+    };
+
+    let mut fs_vpath = crate::state::FixedString::<1024>::new();
+    fs_vpath.set(path_str);
+
+    // Fast path: listing straight from the VDir directory index (no IPC)
+    if let Some(cursor) = vdir_opendir(state.mmap_ptr, state.mmap_size, &vpath.manifest_key) {
+        return track_synthetic_dir(
+            state,
+            SyntheticDir {
+                vpath: fs_vpath,
+                entries: Vec::new(),
+                position: 0,
+                vdir: Some(cursor),
+            },
+        );
     }
 
     // Query directory listing from daemon
     if let Some(entries) = state.query_dir_listing(path_str) {
-        // Create synthetic directory
-        let mut fs_vpath = crate::state::FixedString::<1024>::new();
-        fs_vpath.set(path_str);
-        let syn_dir = Box::new(SyntheticDir {
-            vpath: fs_vpath,
-            entries,
-            position: 0,
-        });
-        let ptr = Box::into_raw(syn_dir) as *mut c_void;
-
-        // Track in open_dirs
-        let mut dirs = state.open_dirs.lock();
-        dirs.insert(
-            ptr as usize,
+        return track_synthetic_dir(
+            state,
             SyntheticDir {
-                vpath: crate::state::FixedString::new(),
-                entries: vec![],
+                vpath: fs_vpath,
+                entries,
                 position: 0,
+                vdir: None,
             },
         );
-
-        return ptr;
     }
 
     // Fallback to real
     real(path)
 }
 
+/// Box a synthetic directory and register it in open_dirs
+#[cfg(target_os = "macos")]
+unsafe fn track_synthetic_dir(state: &InceptionLayerState, syn_dir: SyntheticDir) -> *mut c_void {
+    let ptr = Box::into_raw(Box::new(syn_dir)) as *mut c_void;
+    let mut dirs = state.open_dirs.lock();
+    dirs.insert(
+        ptr as usize,
+        SyntheticDir {
+            vpath: crate::state::FixedString::new(),
+            entries: vec![],
+            position: 0,
+            vdir: None,
+        },
+    );
+    ptr
+}
+
 /// Static buffer for readdir dirent (readdir returns pointer to static data)
 #[cfg(target_os = "macos")]
 static mut DIRENT_BUF: libc::dirent = libc::dirent {
@@ -108,6 +129,34 @@ pub unsafe extern "C" fn readdir_inception(dir: *mut c_void) -> *mut libc::diren
             drop(dirs); // Release lock before accessing syn_dir
 
             let sd = &mut *syn_dir;
+            let dirent_ptr = std::ptr::addr_of_mut!(DIRENT_BUF);
+
+            if let Some(cursor) = sd.vdir.as_mut() {
+                let d_name =
+                    &mut *(std::ptr::addr_of_mut!((*dirent_ptr).d_name) as *mut [u8; 1024]);
+                match vdir_readdir(state.mmap_ptr, state.mmap_size, cursor, d_name) {
+                    VDirReaddir::Entry { len, is_dir } => {
+                        return fill_dirent(dirent_ptr, len, is_dir);
+                    }
+                    VDirReaddir::End => return std::ptr::null_mut(),
+                    VDirReaddir::Unavailable => {
+                        // Index went stale mid-stream: finish over IPC, in the
+                        // same name order, after the last name returned
+                        let mut entries = state
+                            .query_dir_listing(sd.vpath.as_str())
+                            .unwrap_or_default();
+                        entries.sort_unstable_by(|a, b| a.name.as_bytes().cmp(b.name.as_bytes()));
+                        let last = cursor.last_name();
+                        if !last.is_empty() {
+                            entries.retain(|e| e.name.as_bytes() > last);
+                        }
+                        sd.entries = entries;
+                        sd.position = 0;
+                        sd.vdir = None;
+                    }
+                }
+            }
+
             if sd.position >= sd.entries.len() {
                 return std::ptr::null_mut();
             }
@@ -115,30 +164,33 @@ pub unsafe extern "C" fn readdir_inception(dir: *mut c_void) -> *mut libc::diren
             let entry = &sd.entries[sd.position];
             sd.position += 1;
 
-            // Fill dirent buffer
-            DIRENT_BUF.d_ino = 1; // Synthetic inode
-            DIRENT_BUF.d_type = if entry.is_dir {
-                libc::DT_DIR
-            } else {
-                libc::DT_REG
-            };
-            DIRENT_BUF.d_namlen = entry.name.len() as u16;
-
             // Copy name to buffer
             let name_bytes = entry.name.as_bytes();
             let copy_len = name_bytes.len().min(1023);
-            let dirent_ptr = std::ptr::addr_of_mut!(DIRENT_BUF);
             let d_name_ptr = std::ptr::addr_of_mut!((*dirent_ptr).d_name);
             std::ptr::copy_nonoverlapping(name_bytes.as_ptr(), d_name_ptr as *mut u8, copy_len);
             (*dirent_ptr).d_name[copy_len] = 0;
 
-            return dirent_ptr;
+            return fill_dirent(dirent_ptr, copy_len, entry.is_dir);
         }
     }
 
     real(dir)
 }
 
+/// Fill the dirent header fields for a name already copied into d_name
+#[cfg(target_os = "macos")]
+unsafe fn fill_dirent(
+    dirent_ptr: *mut libc::dirent,
+    name_len: usize,
+    is_dir: bool,
+) -> *mut libc::dirent {
+    (*dirent_ptr).d_ino = 1; // Synthetic inode
+    (*dirent_ptr).d_type = if is_dir { libc::DT_DIR } else { libc::DT_REG };
+    (*dirent_ptr).d_namlen = name_len as u16;
+    dirent_ptr
+}
+
 #[no_mangle]
 #[cfg(target_os = "macos")]
 pub unsafe extern "C" fn closedir_inception(dir: *mut c_void) -> c_int {
@@ -5,9 +5,12 @@
 
 use crate::state::InceptionLayerGuard;
 use libc::{c_int, c_void, off_t, size_t, ssize_t};
-use std::sync::atomic::AtomicUsize;
+use std::cell::UnsafeCell;
+use std::sync::atomic::{AtomicBool, AtomicUsize, Ordering};
 
-/// Global counter for open FDs to monitor saturation (RFC-0051)
+/// Global counter for open FDs to monitor saturation (RFC-0051).
+/// Also bumped by the Linux C bridge for opens it passes through.
+#[no_mangle]
 pub static OPEN_FD_COUNT: AtomicUsize = AtomicUsize::new(0);
 
 // RFC-0051 / Pattern 2648: Lock-Free FD tracking via Tiered Atomic Array.
@@ -21,8 +24,476 @@ pub struct FdEntry {
     pub temp_path: crate::state::FixedString<1024>,
     pub is_vfs: bool,
     pub cached_stat: Option<libc::stat>,
+    /// CAS blob a read-only VFS fd serves (clone source for copy_file_range)
+    pub content_hash: Option<[u8; 32]>,
     pub mmap_count: usize,
     pub lock_fd: i32, // -1 if no lock FD held
+    pub writes: WriteTracker,
+}
+
+// ============================================================================
+// CoW write tracking - what close() reports to the daemon as ReingestDelta
+// ============================================================================
+
+/// Ranges kept per fd. On overflow the two closest ranges are merged, so the
+/// tracked set only ever grows into a superset of what was written.
+const MAX_WRITE_RANGES: usize = 16;
+
+#[derive(Clone, Copy)]
+pub struct WriteLog {
+    ranges: [[u64; 2]; MAX_WRITE_RANGES],
+    count: usize,
+    truncated_to: u64,
+    mutations: u32,
+    lost: bool,
+    /// Blob the file was replaced by wholesale (a cloned copy), superseding
+    /// the tracker's base
+    rebased: Option<([u8; 32], u64)>,
+    /// Set by `cloned`, cleared by any later write or truncate
+    clean_clone: bool,
+    /// ctime of the file after the last change the log recorded
+    stamp: Option<[i64; 2]>,
+}
+
+impl WriteLog {
+    const fn new() -> Self {
+        Self {
+            ranges: [[0; 2]; MAX_WRITE_RANGES],
+            count: 0,
+            truncated_to: u64::MAX,
+            mutations: 0,
+            lost: false,
+            rebased: None,
+            clean_clone: false,
+            stamp: None,
+        }
+    }
+
+    /// Add `[start, end)`, keeping ranges sorted and disjoint
+    pub fn written(&mut self, start: u64, end: u64) {
+        self.mutations = self.mutations.saturating_add(1);
+        self.clean_clone = false;
+        if start < end {
+            self.insert(start, end);
+        }
+    }
+
+    pub fn truncated(&mut self, len: u64) {
+        self.mutations = self.mutations.saturating_add(1);
+        self.clean_clone = false;
+        self.truncated_to = self.truncated_to.min(len);
+    }
+
+    pub fn lose(&mut self) {
+        self.lost = true;
+    }
+
+    /// The whole file now holds blob `(hash, size)`; earlier writes are moot
+    pub fn cloned(&mut self, hash: [u8; 32], size: u64) {
+        *self = Self {
+            mutations: self.mutations.saturating_add(1),
+            rebased: Some((hash, size)),
+            clean_clone: true,
+            stamp: self.stamp,
+            ..Self::new()
+        };
+    }
+
+    /// Record the file's ctime as of the change just logged
+    pub fn stamp(&mut self, fd: c_int) {
+        self.stamp = file_ctime(fd);
+    }
+
+    /// Nothing changed the file since the last `stamp`. The kernel moves
+    /// ctime on every write, from any fd or process, so a moved ctime is a
+    /// change the hooks never saw and the log is lost.
+    pub fn check_stamp(&mut self, fd: c_int) {
+        if self.stamp.is_none() || file_ctime(fd) != self.stamp {
+            self.lost = true;
+        }
+    }
+
+    fn insert(&mut self, start: u64, end: u64) {
+        let n = self.count;
+        let r = &mut self.ranges;
+        let i = r[..n].partition_point(|x| x[1] < start);
+
+        // Absorb every range overlapping or touching the new one
+        let (mut s, mut e, mut j) = (start, end, i);
+        while j < n && r[j][0] <= e {
+            s = s.min(r[j][0]);
+            e = e.max(r[j][1]);
+            j += 1;
+        }
+        if j > i {
+            r[i] = [s, e];
+            r.copy_within(j..n, i + 1);
+            self.count = n - (j - i - 1);
+            return;
+        }
+
+        if n == MAX_WRITE_RANGES {
+            let k = (1..n).min_by_key(|&k| r[k][0] - r[k - 1][1]).unwrap_or(1);
+            r[k - 1][1] = r[k][1];
+            r.copy_within(k + 1..n, k);
+            self.count = n - 1;
+            return self.insert(start, end);
+        }
+        r.copy_within(i..n, i + 1);
+        r[i] = [start, end];
+        self.count = n + 1;
+    }
+}
+
+/// Writes made through a CoW fd since its temp file was copied from `base`.
+///
+/// Fed by the write/pwrite/writev/pwritev/fallocate/ftruncate/mmap hooks.
+/// Anything the tracker cannot account for loses the log, and close() then
+/// leaves the daemon to rehash the whole file: a contended update, a dup'd
+/// fd, sendfile into the fd, a fork, or any change the hooks did not make
+/// (the ctime stamp moved: stdio, aio, io_uring, another process). At close
+/// the log is also lost while another fd or a shared mapping can still
+/// reach the file (see `WriteTracker::seal`).
+pub struct WriteTracker {
+    /// (content hash, size) of the blob the temp file started as
+    base: Option<([u8; 32], u64)>,
+    busy: AtomicBool,
+    lost: AtomicBool,
+    log: UnsafeCell<WriteLog>,
+}
+
+impl WriteTracker {
+    pub const fn untracked() -> Self {
+        Self::new(None)
+    }
+
+    pub const fn new(base: Option<([u8; 32], u64)>) -> Self {
+        Self {
+            base,
+            busy: AtomicBool::new(false),
+            lost: AtomicBool::new(false),
+            log: UnsafeCell::new(WriteLog::new()),
+        }
+    }
+
+    #[inline]
+    fn is_active(&self) -> bool {
+        self.base.is_some()
+    }
+
+    /// Run `f` with the log locked. A contended lock means two threads
+    /// mutated the file at once; the log is lost rather than waited on.
+    pub fn track<R>(&self, f: impl FnOnce(&mut WriteLog) -> R) -> Option<R> {
+        if self
+            .busy
+            .compare_exchange(false, true, Ordering::Acquire, Ordering::Relaxed)
+            .is_err()
+        {
+            self.lose();
+            return None;
+        }
+        // Safety: `busy` gives exclusive access to the log
+        let r = f(unsafe { &mut *self.log.get() });
+        self.busy.store(false, Ordering::Release);
+        Some(r)
+    }
+
+    pub fn lose(&self) {
+        self.lost.store(true, Ordering::Release);
+    }
+
+    /// `track` for a hook changing the file through `fd`: the file must be
+    /// as last stamped before the change, and is stamped again after it
+    pub fn track_write<R>(&self, fd: c_int, f: impl FnOnce(&mut WriteLog) -> R) -> Option<R> {
+        self.track(|log| {
+            log.check_stamp(fd);
+            let r = f(log);
+            log.stamp(fd);
+            r
+        })
+    }
+
+    /// Called on close, before the fd goes: keep the log only if every
+    /// change to the file so far is in it and nothing else can change it
+    /// later, i.e. no other fd, io_uring or shared mapping of this process
+    /// reaches the file and no child can have inherited the fd.
+    pub unsafe fn seal(&self, fd: c_int) {
+        if !self.is_active() {
+            return;
+        }
+        // macOS leaves write/pwrite uninterposed: nothing to vouch with
+        #[cfg(not(target_os = "linux"))]
+        {
+            let _ = fd;
+            self.lose();
+        }
+        #[cfg(target_os = "linux")]
+        {
+            use crate::syscalls::linux_raw::{raw_fcntl, raw_fstat};
+
+            let sealed = self.track(|log| {
+                if log.lost || log.mutations == 0 {
+                    return; // no delta either way: skip the scan
+                }
+                log.check_stamp(fd);
+                let mut st: libc::stat = std::mem::zeroed();
+                if log.lost
+                    || raw_fcntl(fd, libc::F_GETFD, 0) & libc::FD_CLOEXEC == 0
+                    || raw_fstat(fd, &mut st) != 0
+                    || reachable_elsewhere(fd, st.st_dev as u64, st.st_ino as u64)
+                {
+                    log.lost = true;
+                }
+            });
+            if sealed.is_none() {
+                self.lose();
+            }
+        }
+    }
+
+    /// Delta for the daemon, or None if a full rehash is needed
+    pub fn delta(&self) -> Option<vrift_ipc::ReingestDelta> {
+        if !self.is_active() {
+            return None;
+        }
+        let log = self.track(|log| *log)?;
+        if log.lost || log.mutations == 0 || self.lost.load(Ordering::Acquire) {
+            return None;
+        }
+        let (base_hash, base_size) = log.rebased.or(self.base)?;
+        Some(vrift_ipc::ReingestDelta {
+            base_hash,
+            base_size,
+            truncated_to: log.truncated_to,
+            ranges: log.ranges[..log.count].to_vec(),
+            cloned: log.clean_clone,
+        })
+    }
+}
+
+impl Clone for WriteTracker {
+    /// Copies describe the entry, they never feed a delta
+    fn clone(&self) -> Self {
+        Self::untracked()
+    }
+}
+
+impl std::fmt::Debug for WriteTracker {
+    fn fmt(&self, f: &mut std::fmt::Formatter<'_>) -> std::fmt::Result {
+        f.debug_struct("WriteTracker")
+            .field("base", &self.base.is_some())
+            .finish()
+    }
+}
+
+/// ctime of the file behind `fd`
+fn file_ctime(fd: c_int) -> Option<[i64; 2]> {
+    let mut st: libc::stat = unsafe { std::mem::zeroed() };
+    #[cfg(target_os = "linux")]
+    let ok = unsafe { crate::syscalls::linux_raw::raw_fstat(fd, &mut st) } == 0;
+    #[cfg(target_os = "macos")]
+    let ok = unsafe { crate::syscalls::macos_raw::raw_fstat64(fd, &mut st) } == 0;
+    ok.then_some([st.st_ctime as i64, st.st_ctime_nsec as i64])
+}
+
+/// Whether anything in this process other than `fd` can still change file
+/// `(dev, ino)`: another fd on it (a dup, an fd passed back in), any
+/// io_uring instance, or a shared mapping of it. Unreadable /proc counts as
+/// yes.
+#[cfg(target_os = "linux")]
+unsafe fn reachable_elsewhere(fd: c_int, dev: u64, ino: u64) -> bool {
+    use crate::syscalls::linux_raw::{raw_close, raw_fstat, raw_open, raw_read, raw_readlinkat};
+
+    // Raw open + getdents64: opendir is interposed by this very library
+    let dir_fd = raw_open(
+        c"/proc/self/fd".as_ptr(),
+        libc::O_RDONLY | libc::O_DIRECTORY | libc::O_CLOEXEC,
+        0,
+    );
+    if dir_fd < 0 {
+        return true;
+    }
+    let mut found = false;
+    let mut buf = [0u8; 4096];
+    'fds: loop {
+        let n = libc::syscall(libc::SYS_getdents64, dir_fd, buf.as_mut_ptr(), buf.len());
+        if n < 0 {
+            found = true;
+            break;
+        }
+        if n == 0 {
+            break;
+        }
+        let mut pos = 0;
+        while pos < n as usize {
+            let ent = buf.as_ptr().add(pos) as *const libc::dirent64;
+            pos += (*ent).d_reclen as usize;
+            let name = std::ffi::CStr::from_ptr((*ent).d_name.as_ptr());
+            let Some(other) = name.to_str().ok().and_then(|n| n.parse::<c_int>().ok()) else {
+                continue;
+            };
+            if other == fd || other == dir_fd {
+                continue;
+            }
+            let mut link = [0u8; 32];
+            let len = raw_readlinkat(
+                dir_fd,
+                name.as_ptr(),
+                link.as_mut_ptr() as *mut libc::c_char,
+                link.len(),
+            );
+            if len > 0 && &link[..len as usize] == b"anon_inode:[io_uring]" {
+                found = true;
+                break 'fds;
+            }
+            let mut st: libc::stat = std::mem::zeroed();
+            if raw_fstat(other, &mut st) == 0 && st.st_dev as u64 == dev && st.st_ino as u64 == ino
+            {
+                found = true;
+                break 'fds;
+            }
+        }
+    }
+    raw_close(dir_fd);
+    if found {
+        return true;
+    }
+
+    // "start-end perms offset major:minor inode path": only the fields up
+    // to the inode matter, so each line is cut at LINE bytes
+    const LINE: usize = 128;
+    let maps = raw_open(
+        c"/proc/self/maps".as_ptr(),
+        libc::O_RDONLY | libc::O_CLOEXEC,
+        0,
+    );
+    if maps < 0 {
+        return true;
+    }
+    let (major, minor) = (
+        libc::major(dev as libc::dev_t),
+        libc::minor(dev as libc::dev_t),
+    );
+    let mut line = [0u8; LINE];
+    let mut len = 0;
+    'read: loop {
+        let n = raw_read(maps, buf.as_mut_ptr() as *mut c_void, buf.len());
+        if n < 0 {
+            found = true;
+            break;
+        }
+        if n == 0 {
+            break;
+        }
+        for &b in &buf[..n as usize] {
+            if b != b'\n' {
+                if len < LINE {
+                    line[len] = b;
+                    len += 1;
+                }
+                continue;
+            }
+            if maps_line_shares(&line[..len], major, minor, ino) {
+                found = true;
+                break 'read;
+            }
+            len = 0;
+        }
+    }
+    raw_close(maps);
+    found
+}
+
+/// Whether a /proc/self/maps line is a shared mapping of file
+/// (major:minor, ino)
+#[cfg(target_os = "linux")]
+fn maps_line_shares(line: &[u8], major: u32, minor: u32, ino: u64) -> bool {
+    let Ok(line) = std::str::from_utf8(line) else {
+        return false;
+    };
+    let mut fields = line.split_ascii_whitespace();
+    let (Some(_), Some(perms), Some(_), Some(dev), Some(inode)) = (
+        fields.next(),
+        fields.next(),
+        fields.next(),
+        fields.next(),
+        fields.next(),
+    ) else {
+        return false;
+    };
+    let Some((maj, min)) = dev.split_once(':') else {
+        return false;
+    };
+    perms.as_bytes().get(3) == Some(&b's')
+        && u32::from_str_radix(maj, 16) == Ok(major)
+        && u32::from_str_radix(min, 16) == Ok(minor)
+        && inode.parse::<u64>() == Ok(ino)
+}
+
+static WRITES_ATFORK: AtomicBool = AtomicBool::new(false);
+
+/// A forked child shares the parent's CoW files: its copies of the logs
+/// would miss the parent's writes, so they are dropped. (The parent's logs
+/// notice the child's writes through the ctime stamp.)
+extern "C" fn writes_atfork_child() {
+    if let Some(state) = crate::state::InceptionLayerState::get_no_spawn() {
+        state.open_fds.for_each(|entry| entry.writes.lose());
+    }
+}
+
+/// Register `writes_atfork_child`, once a CoW fd is tracked (never during
+/// init, see BUG-007b)
+pub(crate) fn ensure_writes_atfork() {
+    if !WRITES_ATFORK.swap(true, Ordering::AcqRel) {
+        unsafe { libc::pthread_atfork(None, None, Some(writes_atfork_child)) };
+    }
+}
+
+/// Write tracker of a CoW fd, without triggering state initialization
+#[inline]
+fn write_tracker(fd: c_int) -> Option<&'static WriteTracker> {
+    if fd < 0 || crate::state::INITIALIZING.load(Ordering::Relaxed) != 0 {
+        return None;
+    }
+    let state = crate::state::InceptionLayerState::get_no_spawn()?;
+    let entry_ptr = state.open_fds.get(fd as u32);
+    if entry_ptr.is_null() {
+        return None;
+    }
+    // Safety: entries are reclaimed after a grace period (see get_fd_entry)
+    let tracker = unsafe { &(*entry_ptr).writes };
+    tracker.is_active().then_some(tracker)
+}
+
+/// (content hash, size) of the blob a read-only VFS fd serves, without
+/// triggering state initialization
+#[inline]
+pub(crate) fn fd_blob(fd: c_int) -> Option<([u8; 32], u64)> {
+    if fd < 0 || crate::state::INITIALIZING.load(Ordering::Relaxed) != 0 {
+        return None;
+    }
+    let state = crate::state::InceptionLayerState::get_no_spawn()?;
+    let entry_ptr = state.open_fds.get(fd as u32);
+    if entry_ptr.is_null() {
+        return None;
+    }
+    // Safety: entries are reclaimed after a grace period (see get_fd_entry)
+    let entry = unsafe { &*entry_ptr };
+    Some((entry.content_hash?, entry.cached_stat?.st_size as u64))
+}
+
+/// Mark `[offset, offset + len)` of a CoW fd dirty (e.g. a shared mapping)
+pub(crate) fn track_fd_range(fd: c_int, offset: u64, len: u64) {
+    if let Some(tracker) = write_tracker(fd) {
+        tracker.track(|log| log.written(offset, offset.saturating_add(len)));
+    }
+}
+
+/// The fd is about to be written in ways the tracker cannot see
+pub(crate) fn untrack_fd_writes(fd: c_int) {
+    if let Some(tracker) = write_tracker(fd) {
+        tracker.lose();
+    }
 }
 
 // RFC-0051 / Pattern 2648: Using Mutex for FD_TABLE to avoid RwLock hazards during dyld bootstrap.
@@ -36,6 +507,19 @@ pub fn track_fd(
     is_vfs: bool,
     cached_stat: Option<libc::stat>,
     manifest_key_hash: u64,
+) {
+    track_fd_with(fd, path, is_vfs, cached_stat, manifest_key_hash, None);
+}
+
+/// `track_fd` for an fd that serves CAS blob `content_hash`
+#[inline(always)]
+pub fn track_fd_with(
+    fd: c_int,
+    path: &str,
+    is_vfs: bool,
+    cached_stat: Option<libc::stat>,
+    manifest_key_hash: u64,
+    content_hash: Option<[u8; 32]>,
 ) {
     if fd < 0 {
         return;
@@ -51,8 +535,10 @@ pub fn track_fd(
         temp_path: crate::state::FixedString::new(),
         is_vfs,
         cached_stat,
+        content_hash,
         mmap_count: 0,
         lock_fd: -1,
+        writes: WriteTracker::untracked(),
     }));
 
     if let Some(state) = crate::state::InceptionLayerState::get() {
@@ -155,14 +641,17 @@ pub unsafe extern "C" fn dup_inception(oldfd: c_int) -> c_int {
     let newfd = crate::syscalls::linux_raw::raw_dup(oldfd);
 
     if newfd >= 0 {
+        // Writes through the copy bypass oldfd's write tracker
+        untrack_fd_writes(oldfd);
         // Copy tracking from oldfd to newfd
         if let Some(entry) = get_fd_entry(oldfd) {
-            track_fd(
+            track_fd_with(
                 newfd,
                 entry.vpath.as_str(),
                 entry.is_vfs,
                 entry.cached_stat,
                 entry.manifest_key_hash,
+                entry.content_hash,
             );
         }
     }
@@ -204,14 +693,16 @@ pub unsafe extern "C" fn dup2_inception(oldfd: c_int, newfd: c_int) -> c_int {
     let result = crate::syscalls::linux_raw::raw_dup2(oldfd, newfd);
 
     if result >= 0 {
+        untrack_fd_writes(oldfd);
         // Copy tracking from oldfd to newfd
         if let Some(entry) = get_fd_entry(oldfd) {
-            track_fd(
+            track_fd_with(
                 result,
                 entry.vpath.as_str(),
                 entry.is_vfs,
                 entry.cached_stat,
                 entry.manifest_key_hash,
+                entry.content_hash,
             );
         }
     }
@@ -264,10 +755,24 @@ pub unsafe extern "C" fn lseek_inception(fd: c_int, offset: off_t, whence: c_int
 #[no_mangle]
 pub unsafe extern "C" fn ftruncate_inception(fd: c_int, length: off_t) -> c_int {
     // Pattern 2930: Use raw syscall to avoid post-init dlsym hazard
-    #[cfg(target_os = "macos")]
-    return crate::syscalls::macos_raw::raw_ftruncate(fd, length);
     #[cfg(target_os = "linux")]
-    return crate::syscalls::linux_raw::raw_ftruncate(fd, length);
+    use crate::syscalls::linux_raw::raw_ftruncate;
+    #[cfg(target_os = "macos")]
+    use crate::syscalls::macos_raw::raw_ftruncate;
+
+    if let Some(tracker) = write_tracker(fd) {
+        let tracked = tracker.track_write(fd, |log| {
+            let res = raw_ftruncate(fd, length);
+            if res == 0 {
+                log.truncated(length as u64);
+            }
+            res
+        });
+        if let Some(res) = tracked {
+            return res;
+        }
+    }
+    raw_ftruncate(fd, length)
 }
 
 // ============================================================================
@@ -276,10 +781,163 @@ pub unsafe extern "C" fn ftruncate_inception(fd: c_int, length: off_t) -> c_int
 
 #[no_mangle]
 pub unsafe extern "C" fn write_inception(fd: c_int, buf: *const c_void, count: size_t) -> ssize_t {
+    #[cfg(target_os = "linux")]
+    use crate::syscalls::linux_raw::raw_write;
     #[cfg(target_os = "macos")]
-    return crate::syscalls::macos_raw::raw_write(fd, buf, count);
+    use crate::syscalls::macos_raw::raw_write;
+
+    // CoW fd: write and read back the offset under the tracker lock, so the
+    // recorded range is exact even with O_APPEND
+    if let Some(tracker) = write_tracker(fd) {
+        let tracked = tracker.track_write(fd, |log| {
+            let n = raw_write(fd, buf, count);
+            written_before_offset(log, fd, n);
+            n
+        });
+        if let Some(n) = tracked {
+            return n;
+        }
+    }
+    raw_write(fd, buf, count)
+}
+
+/// `n` bytes were just written at the file offset, which now ends them
+unsafe fn written_before_offset(log: &mut WriteLog, fd: c_int, n: ssize_t) {
     #[cfg(target_os = "linux")]
-    return crate::syscalls::linux_raw::raw_write(fd, buf, count);
+    use crate::syscalls::linux_raw::raw_lseek;
+    #[cfg(target_os = "macos")]
+    use crate::syscalls::macos_raw::raw_lseek;
+
+    if n > 0 {
+        let end = raw_lseek(fd, 0, libc::SEEK_CUR);
+        if end >= n as off_t {
+            log.written((end - n as off_t) as u64, end as u64);
+        } else {
+            log.lose();
+        }
+    }
+}
+
+/// `n` bytes were just written at `offset`, unless the fd appends (Linux
+/// pwrite on O_APPEND writes at the end)
+#[cfg(target_os = "linux")]
+unsafe fn written_at(log: &mut WriteLog, fd: c_int, offset: off_t, n: ssize_t) {
+    let flags = crate::syscalls::linux_raw::raw_fcntl(fd, libc::F_GETFL, 0);
+    if flags < 0 || flags & libc::O_APPEND != 0 || offset < 0 {
+        log.lose();
+    } else if n > 0 {
+        log.written(offset as u64, offset as u64 + n as u64);
+    }
+}
+
+#[cfg(target_os = "linux")]
+#[no_mangle]
+pub unsafe extern "C" fn writev_inception(
+    fd: c_int,
+    iov: *const libc::iovec,
+    iovcnt: c_int,
+) -> ssize_t {
+    use crate::syscalls::linux_raw::raw_writev;
+
+    if let Some(tracker) = write_tracker(fd) {
+        let tracked = tracker.track_write(fd, |log| {
+            let n = raw_writev(fd, iov, iovcnt);
+            written_before_offset(log, fd, n);
+            n
+        });
+        if let Some(n) = tracked {
+            return n;
+        }
+    }
+    raw_writev(fd, iov, iovcnt)
+}
+
+#[cfg(target_os = "linux")]
+#[no_mangle]
+pub unsafe extern "C" fn pwrite_inception(
+    fd: c_int,
+    buf: *const c_void,
+    count: size_t,
+    offset: off_t,
+) -> ssize_t {
+    use crate::syscalls::linux_raw::raw_pwrite64;
+
+    if let Some(tracker) = write_tracker(fd) {
+        let tracked = tracker.track_write(fd, |log| {
+            let n = raw_pwrite64(fd, buf, count, offset);
+            written_at(log, fd, offset, n);
+            n
+        });
+        if let Some(n) = tracked {
+            return n;
+        }
+    }
+    raw_pwrite64(fd, buf, count, offset)
+}
+
+/// pwritev and pwritev2 (`flags` 0 for pwritev). pwritev2 at offset -1
+/// writes at the file offset, like writev.
+#[cfg(target_os = "linux")]
+#[no_mangle]
+pub unsafe extern "C" fn pwritev_inception(
+    fd: c_int,
+    iov: *const libc::iovec,
+    iovcnt: c_int,
+    offset: off_t,
+    flags: c_int,
+) -> ssize_t {
+    use crate::syscalls::linux_raw::raw_pwritev2;
+
+    if let Some(tracker) = write_tracker(fd) {
+        let tracked = tracker.track_write(fd, |log| {
+            let n = raw_pwritev2(fd, iov, iovcnt, offset, flags);
+            if flags & libc::RWF_APPEND != 0 {
+                log.lose();
+            } else if offset == -1 {
+                written_before_offset(log, fd, n);
+            } else {
+                written_at(log, fd, offset, n);
+            }
+            n
+        });
+        if let Some(n) = tracked {
+            return n;
+        }
+    }
+    raw_pwritev2(fd, iov, iovcnt, offset, flags)
+}
+
+/// fallocate: allocating, punching or zeroing `[offset, offset + len)`
+/// dirties at most that range; collapsing or inserting one shifts the rest
+/// of the file
+#[cfg(target_os = "linux")]
+#[no_mangle]
+pub unsafe extern "C" fn fallocate_inception(
+    fd: c_int,
+    mode: c_int,
+    offset: off_t,
+    len: off_t,
+) -> c_int {
+    use crate::syscalls::linux_raw::raw_fallocate;
+
+    if let Some(tracker) = write_tracker(fd) {
+        let tracked = tracker.track_write(fd, |log| {
+            let res = raw_fallocate(fd, mode, offset, len);
+            if mode & (libc::FALLOC_FL_COLLAPSE_RANGE | libc::FALLOC_FL_INSERT_RANGE) != 0
+                || offset < 0
+                || len < 0
+            {
+                log.lose();
+            } else if res == 0 {
+                log.written(offset as u64, offset as u64 + len as u64);
+            }
+            res
+        });
+        if let Some(res) = tracked {
+            return res;
+        }
+    }
+    raw_fallocate(fd, mode, offset, len)
 }
 
 #[no_mangle]
@@ -344,6 +1002,11 @@ pub unsafe extern "C" fn close_inception(fd: c_int) -> c_int {
     let file_id = 0; // Simplified for general close
     inception_record!(EventType::Close, file_id, fd);
 
+    // The delta is decided while the fd still names the file
+    if let Some(info) = &cow_info {
+        info.writes.seal(fd);
+    }
+
     // Final close of the file
     #[cfg(target_os = "macos")]
     let res = crate::syscalls::macos_raw::raw_close(fd);
@@ -364,17 +1027,16 @@ pub unsafe extern "C" fn close_inception(fd: c_int) -> c_int {
             let _ = reactor.ring_buffer.push(crate::sync::Task::Reingest {
                 vpath: info.vpath.to_string(),
                 temp_path: info.temp_path.to_string(),
+                delta: info.writes.delta(),
             });
         }
 
         res
     } else {
-        // Not a COW file, but might be a VFS read-only file or non-VFS file
+        // Not a COW file, but might be a VFS read-only file or non-VFS file.
+        // Already closed above: a second close could hit a reused fd.
         untrack_fd(fd);
-        #[cfg(target_os = "macos")]
-        return crate::syscalls::macos_raw::raw_close(fd);
-        #[cfg(target_os = "linux")]
-        return crate::syscalls::linux_raw::raw_close(fd);
+        res
     }
 }
 
@@ -396,6 +1058,7 @@ pub unsafe extern "C" fn sendfile_inception(
     if crate::syscalls::misc::quick_block_vfs_fd_mutation(s).is_some() {
         return -1;
     }
+    untrack_fd_writes(s);
     crate::syscalls::macos_raw::raw_sendfile(fd, s, offset, len, hdtr, flags)
 }
 
@@ -407,9 +1070,13 @@ pub unsafe extern "C" fn sendfile_inception(
     offset: *mut libc::off_t,
     count: libc::size_t,
 ) -> libc::ssize_t {
+    if let Some(n) = clone_vfs_copy(in_fd, offset, out_fd, std::ptr::null_mut(), count) {
+        return n;
+    }
     if crate::syscalls::misc::quick_block_vfs_fd_mutation(out_fd).is_some() {
         return -1;
     }
+    untrack_fd_writes(out_fd);
     crate::syscalls::linux_raw::raw_sendfile(out_fd, in_fd, offset, count)
 }
 
@@ -423,8 +1090,173 @@ pub unsafe extern "C" fn copy_file_range_inception(
     len: libc::size_t,
     flags: libc::c_uint,
 ) -> libc::ssize_t {
+    if flags == 0 {
+        if let Some(n) = clone_vfs_copy(fd_in, off_in, fd_out, off_out, len) {
+            return n;
+        }
+    }
     if crate::syscalls::misc::quick_block_vfs_fd_mutation(fd_out).is_some() {
         return -1;
     }
+    untrack_fd_writes(fd_out);
     crate::syscalls::linux_raw::raw_copy_file_range(fd_in, off_in, fd_out, off_out, len, flags)
 }
+
+/// Whole-file copy from a VFS blob fd into a VFS file, done as a
+/// manifest-level clone instead of a data copy.
+///
+/// The destination's bytes come from FICLONE when the filesystem can share
+/// extents, else from an in-kernel copy, so nothing passes through this
+/// process; and the destination's manifest entry reuses the source's
+/// content hash instead of vDird rehashing it:
+/// - CoW fd: the write log is rebased onto the source blob, so close()
+///   reports a delta with nothing written and the reingest is a clone
+/// - new file: the entry is upserted right away
+///
+/// Returns None when this is not a whole-file VFS copy, or the clone failed;
+/// the caller then takes the normal path.
+#[cfg(target_os = "linux")]
+unsafe fn clone_vfs_copy(
+    fd_in: c_int,
+    off_in: *mut off_t,
+    fd_out: c_int,
+    off_out: *mut off_t,
+    len: size_t,
+) -> Option<ssize_t> {
+    use crate::syscalls::linux_raw::{raw_copy_file_range, raw_fstat, raw_lseek};
+
+    let _guard = InceptionLayerGuard::enter()?;
+    let src = get_fd_entry(fd_in)?;
+    let hash = src.content_hash?;
+    let size = src.cached_stat?.st_size as u64;
+    if size == 0 || (len as u64) < size {
+        return None;
+    }
+    let dst = get_fd_entry(fd_out)?;
+    if !dst.is_vfs || dst.cached_stat.is_some() {
+        return None;
+    }
+    // A CoW fd without a base blob takes the rehash path on close
+    let tracker = write_tracker(fd_out);
+    if !dst.temp_path.is_empty() && tracker.is_none() {
+        return None;
+    }
+
+    let position = |fd: c_int, off: *mut off_t| {
+        if off.is_null() {
+            raw_lseek(fd, 0, libc::SEEK_CUR)
+        } else {
+            *off
+        }
+    };
+    if position(fd_in, off_in) != 0 || position(fd_out, off_out) != 0 {
+        return None;
+    }
+    // Bytes past `size` in the destination would survive the copy
+    let mut st: libc::stat = std::mem::zeroed();
+    if raw_fstat(fd_out, &mut st) != 0 || st.st_size as u64 > size {
+        return None;
+    }
+
+    // FICLONE (0x40049409), else copy in the kernel at explicit offsets
+    if libc::ioctl(fd_out, 0x40049409, fd_in) != 0 {
+        let mut copied = 0u64;
+        while copied < size {
+            let mut at_in = copied as off_t;
+            let mut at_out = copied as off_t;
+            let n = raw_copy_file_range(
+                fd_in,
+                &mut at_in,
+                fd_out,
+                &mut at_out,
+                (size - copied) as size_t,
+                0,
+            );
+            if n <= 0 {
+                if copied > 0 {
+                    untrack_fd_writes(fd_out);
+                }
+                return None;
+            }
+            copied += n as u64;
+        }
+    }
+
+    // Advance offsets as the syscall would have
+    for (fd, off) in [(fd_in, off_in), (fd_out, off_out)] {
+        if off.is_null() {
+            raw_lseek(fd, size as off_t, libc::SEEK_SET);
+        } else {
+            *off = size as off_t;
+        }
+    }
+
+    match tracker {
+        Some(tracker) => {
+            // The clone replaced everything: re-stamp without checking
+            tracker.track(|log| {
+                log.cloned(hash, size);
+                log.stamp(fd_out);
+            });
+        }
+        None => {
+            // Best effort: live ingest still picks the file up if this is lost
+            if let Some(state) = crate::state::InceptionLayerState::get() {
+                let _ = state.manifest_clone(&dst.manifest_key, hash, size, st.st_mode);
+            }
+        }
+    }
+    inception_log!(
+        "CLONE COPY: '{}' -> '{}' ({} bytes)",
+        src.vpath,
+        dst.vpath,
+        size
+    );
+    Some(size as ssize_t)
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    #[test]
+    fn test_clone_marker_only_for_untouched_clones() {
+        let tracker = WriteTracker::new(Some(([1; 32], 100)));
+        tracker.track(|log| log.cloned([2; 32], 50));
+        let delta = tracker.delta().unwrap();
+        assert!(delta.cloned);
+        assert_eq!(delta.base_hash, [2; 32]);
+
+        tracker.track(|log| log.written(0, 4));
+        assert!(!tracker.delta().unwrap().cloned);
+    }
+
+    #[test]
+    fn test_truncate_to_base_size_is_not_a_clone() {
+        // ftruncate(fd, base_size) then writes the hooks never saw
+        let tracker = WriteTracker::new(Some(([1; 32], 100)));
+        tracker.track(|log| log.truncated(100));
+        let delta = tracker.delta().unwrap();
+        assert!(delta.ranges.is_empty() && delta.truncated_to >= delta.base_size);
+        assert!(!delta.cloned);
+    }
+
+    #[test]
+    fn test_foreign_change_loses_the_log() {
+        let path = std::env::temp_dir().join(format!("vrift-stamp-{}", std::process::id()));
+        let file = std::fs::File::create(&path).unwrap();
+        let fd = std::os::fd::AsRawFd::as_raw_fd(&file);
+        let tracker = WriteTracker::new(Some(([1; 32], 0)));
+        tracker.track(|log| log.stamp(fd));
+
+        tracker.track_write(fd, |log| log.written(0, 4));
+        assert_eq!(tracker.delta().unwrap().ranges, vec![[0, 4]]);
+
+        // A write the hooks did not see (another fd, a child) moves ctime
+        std::thread::sleep(std::time::Duration::from_millis(20));
+        std::fs::write(&path, b"data").unwrap();
+        tracker.track_write(fd, |log| log.written(4, 8));
+        assert!(tracker.delta().is_none());
+        std::fs::remove_file(path).unwrap();
+    }
+}
@@ -2104,3 +2104,117 @@ pub unsafe fn raw_flock(fd: c_int, operation: c_int) -> c_int {
         }
     }
 }
+
+// =============================================================================
+// Positional / vectored writes (CoW write tracking)
+// =============================================================================
+
+/// Six-argument syscall for the write wrappers below
+#[inline(always)]
+unsafe fn raw_syscall6(nr: [i64; 2], args: [i64; 6]) -> i64 {
+    #[cfg(target_arch = "x86_64")]
+    {
+        let ret: i64;
+        std::arch::asm!(
+            "syscall",
+            in("rax") nr[0],
+            in("rdi") args[0],
+            in("rsi") args[1],
+            in("rdx") args[2],
+            in("r10") args[3],
+            in("r8") args[4],
+            in("r9") args[5],
+            lateout("rax") ret,
+            lateout("rcx") _,
+            lateout("r11") _,
+        );
+        if ret < 0 {
+            set_errno_from_ret(ret);
+            -1
+        } else {
+            ret
+        }
+    }
+    #[cfg(target_arch = "aarch64")]
+    {
+        let ret: i64;
+        std::arch::asm!(
+            "svc #0",
+            in("x8") nr[1],
+            inlateout("x0") args[0] => ret,
+            in("x1") args[1],
+            in("x2") args[2],
+            in("x3") args[3],
+            in("x4") args[4],
+            in("x5") args[5],
+        );
+        if ret < 0 {
+            set_errno_from_ret(ret);
+            -1
+        } else {
+            ret
+        }
+    }
+}
+
+/// Raw pwrite64 syscall
+#[inline(always)]
+pub unsafe fn raw_pwrite64(fd: c_int, buf: *const c_void, count: size_t, offset: off_t) -> ssize_t {
+    raw_syscall6(
+        [18, 68], // SYS_pwrite64
+        [fd as i64, buf as i64, count as i64, offset, 0, 0],
+    ) as ssize_t
+}
+
+/// Raw writev syscall
+#[inline(always)]
+pub unsafe fn raw_writev(fd: c_int, iov: *const libc::iovec, iovcnt: c_int) -> ssize_t {
+    raw_syscall6(
+        [20, 66], // SYS_writev
+        [fd as i64, iov as i64, iovcnt as i64, 0, 0, 0],
+    ) as ssize_t
+}
+
+/// Raw pwritev2 syscall; flags 0 uses plain pwritev (pre-4.6 kernels).
+/// The offset travels as (low, high) words; on 64-bit the low word is all
+/// of it.
+#[inline(always)]
+pub unsafe fn raw_pwritev2(
+    fd: c_int,
+    iov: *const libc::iovec,
+    iovcnt: c_int,
+    offset: off_t,
+    flags: c_int,
+) -> ssize_t {
+    let args = [
+        fd as i64,
+        iov as i64,
+        iovcnt as i64,
+        offset,
+        0,
+        flags as i64,
+    ];
+    if flags == 0 && offset >= 0 {
+        raw_syscall6([296, 70], args) as ssize_t // SYS_pwritev
+    } else {
+        raw_syscall6([328, 287], args) as ssize_t // SYS_pwritev2
+    }
+}
+
+/// Raw fallocate syscall
+#[inline(always)]
+pub unsafe fn raw_fallocate(fd: c_int, mode: c_int, offset: off_t, len: off_t) -> c_int {
+    raw_syscall6(
+        [285, 47], // SYS_fallocate
+        [fd as i64, mode as i64, offset, len, 0, 0],
+    ) as c_int
+}
+
+/// Raw fcntl syscall (integer-argument commands only)
+#[inline(always)]
+pub unsafe fn raw_fcntl(fd: c_int, cmd: c_int, arg: i64) -> c_int {
+    raw_syscall6(
+        [72, 25], // SYS_fcntl
+        [fd as i64, cmd as i64, arg, 0, 0, 0],
+    ) as c_int
+}
@@ -1,5 +1,15 @@
 use libc::{c_int, c_void, off_t, size_t};
 
+/// Read-only blob mappings up to this size are prefaulted (MAP_POPULATE):
+/// a `.so` or `.node` is touched nearly everywhere, so one populate beats a
+/// fault per page
+#[cfg(target_os = "linux")]
+const POPULATE_MAX: u64 = 2 << 20;
+
+/// Larger ones up to this size get MADV_WILLNEED readahead instead
+#[cfg(target_os = "linux")]
+const WILLNEED_MAX: u64 = 64 << 20;
+
 #[no_mangle]
 pub unsafe extern "C" fn mmap_inception(
     addr: *mut c_void,
@@ -11,10 +21,26 @@ pub unsafe extern "C" fn mmap_inception(
 ) -> *mut c_void {
     // RFC-0051: Always use raw syscall for mmap to avoid any dlsym dependency.
     // mmap is called during __malloc_init before dlsym is safe.
+    #[cfg(target_os = "linux")]
+    if (prot & libc::PROT_WRITE) == 0 {
+        if let Some(ptr) = map_blob(addr, len, prot, flags, fd, offset) {
+            return ptr;
+        }
+    }
+
     #[cfg(target_os = "macos")]
-    return crate::syscalls::macos_raw::raw_mmap(addr, len, prot, flags, fd, offset);
+    let ptr = crate::syscalls::macos_raw::raw_mmap(addr, len, prot, flags, fd, offset);
     #[cfg(target_os = "linux")]
-    return crate::syscalls::linux_raw::raw_mmap(addr, len, prot, flags, fd, offset);
+    let ptr = crate::syscalls::linux_raw::raw_mmap(addr, len, prot, flags, fd, offset);
+
+    // Stores through a shared mapping of a CoW fd are invisible to the write
+    // hooks, and munmap cannot name the fd: dirty the whole window up front.
+    // Read-only ones too, since CoW fds are writable and mprotect can make
+    // the mapping writable later without naming the fd either.
+    if fd >= 0 && ptr != libc::MAP_FAILED && (flags & libc::MAP_SHARED) != 0 {
+        crate::syscalls::io::track_fd_range(fd, offset as u64, len as u64);
+    }
+    ptr
 }
 
 #[no_mangle]
@@ -25,3 +51,54 @@ pub unsafe extern "C" fn munmap_inception(addr: *mut c_void, len: size_t) -> c_i
     #[cfg(target_os = "linux")]
     return crate::syscalls::linux_raw::raw_munmap(addr, len);
 }
+
+/// Map a read-only VFS fd straight from its CAS blob.
+///
+/// Blobs are content-addressed, so every process mapping the same library
+/// or bundle, in any project, shares its page-cache pages. A loose-blob fd
+/// already maps the blob; a pack-served fd is a sealed memfd copy private
+/// to this process (see `pack::open_packed`), so the loose blob is mapped
+/// in its place when present. None: not a VFS blob fd, map as usual.
+#[cfg(target_os = "linux")]
+unsafe fn map_blob(
+    addr: *mut c_void,
+    len: size_t,
+    prot: c_int,
+    flags: c_int,
+    fd: c_int,
+    offset: off_t,
+) -> Option<*mut c_void> {
+    use crate::syscalls::linux_raw::{raw_close, raw_mmap, raw_open};
+
+    let (hash, size) = crate::syscalls::io::fd_blob(fd)?;
+    let _guard = crate::state::InceptionLayerGuard::enter()?;
+
+    let mut blob_fd = -1;
+    if libc::fcntl(fd, libc::F_GET_SEALS) >= 0 {
+        let state = crate::state::InceptionLayerState::get_no_spawn()?;
+        let mut buf = [0u8; 1024];
+        if let Some(path) =
+            crate::syscalls::open::cas_blob_path(&mut buf, state.cas_root.as_str(), &hash, size)
+        {
+            blob_fd = raw_open(path.as_ptr(), libc::O_RDONLY | libc::O_CLOEXEC, 0);
+        }
+    }
+
+    let hinted = if size <= POPULATE_MAX {
+        flags | libc::MAP_POPULATE
+    } else {
+        flags
+    };
+    let mut ptr = libc::MAP_FAILED;
+    if blob_fd >= 0 {
+        ptr = raw_mmap(addr, len, prot, hinted, blob_fd, offset);
+        raw_close(blob_fd);
+    }
+    if ptr == libc::MAP_FAILED {
+        ptr = raw_mmap(addr, len, prot, hinted, fd, offset);
+    }
+    if ptr != libc::MAP_FAILED && size > POPULATE_MAX && size <= WILLNEED_MAX {
+        libc::madvise(ptr, len, libc::MADV_WILLNEED);
+    }
+    Some(ptr)
+}
@@ -14,6 +14,7 @@ pub(crate) unsafe fn open_impl(path: *const c_char, flags: c_int, mode: mode_t)
     if path.is_null() {
         return None;
     }
+    let start = ticks();
 
     let path_cstr = CStr::from_ptr(path);
     let path_str = match path_cstr.to_str() {
@@ -30,13 +31,15 @@ pub(crate) unsafe fn open_impl(path: *const c_char, flags: c_int, mode: mode_t)
                 path_str,
                 p.absolute
             );
-            inception_record!(EventType::OpenHit, p.manifest_key_hash, 0);
+            inception_record!(EventType::OpenHit, p.manifest_key_hash, 0, since: start);
             p
         }
         None => return None,
     };
 
-    let entry = match state.query_manifest_ipc(&vpath) {
+    // Phase 1.3: Resolve content hash/size/mode from the seqlock-protected VDir mmap
+    // (zero syscalls). Only a VDir miss pays the vDird IPC round trip (→ LMDB).
+    let entry = match state.query_manifest(&vpath) {
         Some(e) => {
             inception_log!(
                 "manifest lookup '{}': FOUND (mode=0o{:o}, size={})",
@@ -58,7 +61,7 @@ pub(crate) unsafe fn open_impl(path: *const c_char, flags: c_int, mode: mode_t)
                 vpath.manifest_key,
                 is_write
             );
-            inception_record!(EventType::OpenMiss, vpath.manifest_key_hash, 0);
+            inception_record!(EventType::OpenMiss, vpath.manifest_key_hash, 0, since: start);
 
             let fd = unsafe { raw_open(path, flags, mode) };
             if fd >= 0 {
@@ -76,17 +79,16 @@ pub(crate) unsafe fn open_impl(path: *const c_char, flags: c_int, mode: mode_t)
         }
     };
 
-    let hash_hex = hex_encode(&entry.content_hash);
-    let blob_path = format!(
-        "{}/blake3/{}/{}/{}_{}.bin",
-        state.cas_root,
-        &hash_hex[0..2],
-        &hash_hex[2..4],
-        hash_hex,
-        entry.size
-    );
+    // CAS blob path, NUL-terminated on the stack (no format!/CString)
+    let mut blob_buf = [0u8; 1024];
+    let blob_cpath = cas_blob_path(
+        &mut blob_buf,
+        state.cas_root.as_str(),
+        &entry.content_hash,
+        entry.size,
+    )?;
 
-    inception_log!("redirection path: '{}'", blob_path);
+    inception_log!("redirection path: '{}'", blob_cpath.to_str().unwrap_or(""));
 
     let is_write = (flags & (libc::O_WRONLY | libc::O_RDWR | libc::O_APPEND | libc::O_TRUNC)) != 0;
 
@@ -151,9 +153,19 @@ pub(crate) unsafe fn open_impl(path: *const c_char, flags: c_int, mode: mode_t)
 
         inception_log!("COW TRIGGERED: '{}' -> '{}'", vpath.absolute, temp_path);
         inception_record!(EventType::CowTriggered, vpath.manifest_key_hash, 0);
-
-        let blob_cpath = std::ffi::CString::new(blob_path.as_str()).ok()?;
-        let src_fd = unsafe { libc::open(blob_cpath.as_ptr(), libc::O_RDONLY | libc::O_CLOEXEC) };
+        metric_add(Metric::CowSession, 1);
+
+        let src_fd = unsafe {
+            open_blob(
+                state,
+                blob_cpath,
+                &entry.content_hash,
+                libc::O_RDONLY | libc::O_CLOEXEC,
+                0,
+            )
+        };
+        // Blob the temp file is an exact copy of, for delta reingest on close
+        let mut base = None;
         if src_fd >= 0 {
             let dst_fd = unsafe {
                 libc::open(
@@ -164,13 +176,25 @@ pub(crate) unsafe fn open_impl(path: *const c_char, flags: c_int, mode: mode_t)
             };
             if dst_fd >= 0 {
                 let mut buf = [0u8; 8192];
+                let mut copied = 0u64;
+                let mut complete = true;
                 loop {
                     let n =
                         unsafe { libc::read(src_fd, buf.as_mut_ptr() as *mut c_void, buf.len()) };
                     if n <= 0 {
+                        complete = n == 0;
+                        break;
+                    }
+                    let w =
+                        unsafe { libc::write(dst_fd, buf.as_ptr() as *const c_void, n as usize) };
+                    if w != n {
+                        complete = false;
                         break;
                     }
-                    unsafe { libc::write(dst_fd, buf.as_ptr() as *const c_void, n as usize) };
+                    copied += n as u64;
+                }
+                if complete && copied == entry.size {
+                    base = Some((entry.content_hash, entry.size));
                 }
                 unsafe { libc::close(dst_fd) };
             }
@@ -200,9 +224,20 @@ pub(crate) unsafe fn open_impl(path: *const c_char, flags: c_int, mode: mode_t)
                 temp_path,
                 is_vfs: true,
                 cached_stat: None,
+                content_hash: None,
                 mmap_count: 0,
                 lock_fd: -1,
+                writes: crate::syscalls::io::WriteTracker::new(base),
             }));
+            unsafe {
+                (*entry).writes.track(|log| {
+                    if (flags & libc::O_TRUNC) != 0 {
+                        log.truncated(0);
+                    }
+                    log.stamp(fd);
+                })
+            };
+            crate::syscalls::io::ensure_writes_atfork();
 
             let old = state.open_fds.set(fd as u32, entry);
             if !old.is_null() {
@@ -214,8 +249,15 @@ pub(crate) unsafe fn open_impl(path: *const c_char, flags: c_int, mode: mode_t)
             Some(fd)
         }
     } else {
-        let blob_cpath = std::ffi::CString::new(blob_path.as_str()).ok()?;
-        let fd = unsafe { libc::open(blob_cpath.as_ptr(), flags, mode as libc::c_uint) };
+        crate::pack::record_access(&entry.content_hash, entry.size);
+        #[cfg(target_os = "linux")]
+        let packed =
+            unsafe { crate::pack::open_packed(state, &entry.content_hash, entry.size, flags) };
+        #[cfg(not(target_os = "linux"))]
+        let packed = None;
+        let fd = packed.unwrap_or_else(|| unsafe {
+            open_blob(state, blob_cpath, &entry.content_hash, flags, mode)
+        });
         if fd >= 0 {
             // 🔥 Build and cache stat for VFS file
             let mut cached_stat: libc::stat = unsafe { std::mem::zeroed() };
@@ -226,12 +268,13 @@ pub(crate) unsafe fn open_impl(path: *const c_char, flags: c_int, mode: mode_t)
             cached_stat.st_nlink = 1;
             cached_stat.st_ino = vpath.manifest_key_hash as _;
 
-            crate::syscalls::io::track_fd(
+            crate::syscalls::io::track_fd_with(
                 fd,
                 &vpath.manifest_key,
                 true,
                 Some(cached_stat),
                 vpath.manifest_key_hash,
+                Some(entry.content_hash),
             );
             Some(fd)
         } else {
@@ -246,16 +289,64 @@ pub unsafe extern "C" fn velo_open_impl(path: *const c_char, flags: c_int, mode:
     open_impl(path, flags, mode).unwrap_or_else(|| raw_open(path, flags, mode))
 }
 
-fn hex_encode(hash: &[u8; 32]) -> String {
+fn hex_encode(hash: &[u8; 32]) -> [u8; 64] {
     const HEX_CHARS: &[u8; 16] = b"0123456789abcdef";
-    let mut result = String::with_capacity(64);
-    for byte in hash {
-        result.push(HEX_CHARS[(byte >> 4) as usize] as char);
-        result.push(HEX_CHARS[(byte & 0x0f) as usize] as char);
+    let mut result = [0u8; 64];
+    for (i, byte) in hash.iter().enumerate() {
+        result[i * 2] = HEX_CHARS[(byte >> 4) as usize];
+        result[i * 2 + 1] = HEX_CHARS[(byte & 0x0f) as usize];
     }
     result
 }
 
+/// Open a CAS blob by path. A chunked blob has no flat file until vDird
+/// materializes it, so ENOENT costs one materialize request and a retry.
+unsafe fn open_blob(
+    state: &InceptionLayerState,
+    blob_cpath: &CStr,
+    hash: &[u8; 32],
+    flags: c_int,
+    mode: mode_t,
+) -> c_int {
+    let fd = libc::open(blob_cpath.as_ptr(), flags, mode as libc::c_uint);
+    if fd >= 0
+        || crate::get_errno() != libc::ENOENT
+        || !crate::ipc::sync_ipc_cas_materialize(&state.vdird_socket_path, hash)
+    {
+        return fd;
+    }
+    libc::open(blob_cpath.as_ptr(), flags, mode as libc::c_uint)
+}
+
+/// `{cas_root}/blake3/ab/cd/{hash}_{size}.bin` as a C string in `buf`.
+/// None if it does not fit.
+pub(crate) fn cas_blob_path<'a>(
+    buf: &'a mut [u8; 1024],
+    cas_root: &str,
+    hash: &[u8; 32],
+    size: u64,
+) -> Option<&'a CStr> {
+    let hex = hex_encode(hash);
+    let hex = std::str::from_utf8(&hex).ok()?;
+    let cap = buf.len() - 1; // Room for the NUL
+    let mut writer = crate::macros::StackWriter::new(&mut buf[..cap]);
+    let _ = write!(
+        writer,
+        "{}/blake3/{}/{}/{}_{}.bin",
+        cas_root,
+        &hex[0..2],
+        &hex[2..4],
+        hex,
+        size
+    );
+    let len = writer.as_str().len();
+    if len == cap {
+        return None; // Truncated
+    }
+    buf[len] = 0;
+    CStr::from_bytes_with_nul(&buf[..=len]).ok()
+}
+
 #[cfg(target_os = "macos")]
 #[no_mangle]
 pub unsafe extern "C" fn open_inception(p: *const c_char, f: c_int, m: mode_t) -> c_int {
@@ -457,3 +548,21 @@ pub unsafe extern "C" fn creat_inception(path: *const c_char, mode: mode_t) -> c
     // Route through open_inception_c_impl (platform-generic entry point)
     open_inception_c_impl(path, flags, mode)
 }
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    #[test]
+    fn test_cas_blob_path_on_stack() {
+        let mut buf = [0u8; 1024];
+        let path = cas_blob_path(&mut buf, "/cas", &[0xab; 32], 7).unwrap();
+        assert_eq!(
+            path.to_str().unwrap(),
+            format!("/cas/blake3/ab/ab/{}_7.bin", "ab".repeat(32))
+        );
+        // Too long for the buffer: caller falls back instead of truncating
+        let root = "x".repeat(1000);
+        assert!(cas_blob_path(&mut buf, &root, &[0; 32], 1).is_none());
+    }
+}
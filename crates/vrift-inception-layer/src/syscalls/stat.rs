@@ -43,6 +43,7 @@ pub struct statx {
 /// RFC-0044: Virtual stat implementation using Hot Stat Cache
 /// Returns None to fallback to OS, Some(0) on success, Some(-1) on error
 unsafe fn stat_impl_common(path_str: &str, buf: *mut libc_stat) -> Option<c_int> {
+    let start = ticks();
     let state = InceptionLayerState::get()?;
 
     // 1. Resolve path to VFS domain
@@ -71,7 +72,7 @@ unsafe fn stat_impl_common(path_str: &str, buf: *mut libc_stat) -> Option<c_int>
                     (*buf).st_dev = 0x52494654; // "RIFT"
                     (*buf).st_ino = vpath.manifest_key_hash as _;
                 }
-                inception_record!(EventType::StatHit, vpath.manifest_key_hash, 10); // 10 = dirty_hit (temp file stat)
+                inception_record!(EventType::StatHit, vpath.manifest_key_hash, 10, since: start); // 10 = dirty_hit (temp file stat)
                 return Some(0);
             }
         }
@@ -80,7 +81,7 @@ unsafe fn stat_impl_common(path_str: &str, buf: *mut libc_stat) -> Option<c_int>
     } else {
         // Try Hot Stat Cache — Phase 1.3: seqlock-protected VDir lookup
         if let Some(entry) = vdir_lookup(state.mmap_ptr, state.mmap_size, manifest_path) {
-            inception_record!(EventType::StatHit, vpath.manifest_key_hash, 11); // 11 = vdir_hit (seqlock)
+            inception_record!(EventType::StatHit, vpath.manifest_key_hash, 11, since: start); // 11 = vdir_hit (seqlock)
             std::ptr::write_bytes(buf, 0, 1);
             (*buf).st_size = entry.size as _;
             #[cfg(target_os = "macos")]
@@ -120,14 +121,15 @@ unsafe fn stat_impl_common(path_str: &str, buf: *mut libc_stat) -> Option<c_int>
         (*buf).st_dev = 0x52494654; // "RIFT"
         (*buf).st_nlink = 1;
         (*buf).st_ino = vpath.manifest_key_hash as _;
-        inception_record!(EventType::StatHit, vpath.manifest_key_hash, 12); // 12 = ipc_hit
+        inception_record!(EventType::StatHit, vpath.manifest_key_hash, 12, since: start); // 12 = ipc_hit
         return Some(0);
     }
 
     inception_record!(
         EventType::StatMiss,
         vrift_ipc::fnv1a_hash(path_str),
-        -libc::ENOENT
+        -libc::ENOENT,
+        since: start
     );
 
     None
@@ -329,6 +331,27 @@ pub unsafe extern "C" fn access_inception(path: *const c_char, mode: c_int) -> c
     velo_access_impl(path, mode)
 }
 
+/// faccessat(2) VFS check for the Linux C bridge: true when `path` resolves
+/// inside the VFS (access granted). The bridge has already handled early
+/// init and the tripped circuit; everything else goes to the kernel.
+#[no_mangle]
+#[cfg(target_os = "linux")]
+pub unsafe extern "C" fn velo_faccessat_vfs(dirfd: c_int, path: *const c_char) -> bool {
+    let _guard = match InceptionLayerGuard::enter() {
+        Some(g) => g,
+        None => return false,
+    };
+    if path.is_null() || (dirfd != libc::AT_FDCWD && *path != b'/' as c_char) {
+        return false;
+    }
+    let Ok(path_str) = CStr::from_ptr(path).to_str() else {
+        return false;
+    };
+    InceptionLayerState::get()
+        .map(|s| s.inception_applicable(path_str))
+        .unwrap_or(false)
+}
+
 #[no_mangle]
 pub unsafe extern "C" fn velo_fstatat_impl(
     dirfd: c_int,
@@ -443,41 +466,63 @@ pub unsafe extern "C" fn statx_inception(
         );
     }
 
-    let path_str = match CStr::from_ptr(path).to_str() {
-        Ok(s) => s,
-        Err(_) => {
-            return crate::syscalls::linux_raw::raw_statx(
-                dirfd,
-                path,
-                flags,
-                mask,
-                buf as *mut libc::c_void,
-            )
-        }
+    let path_cstr = CStr::from_ptr(path);
+    if statx_needs_kernel(dirfd, path_cstr) {
+        return crate::syscalls::linux_raw::raw_statx(
+            dirfd,
+            path,
+            flags,
+            mask,
+            buf as *mut libc::c_void,
+        );
+    }
+    let Some(_guard) = InceptionLayerGuard::enter() else {
+        return crate::syscalls::linux_raw::raw_statx(
+            dirfd,
+            path,
+            flags,
+            mask,
+            buf as *mut libc::c_void,
+        );
     };
 
-    // VFS lookup
-    if let Some(state) = InceptionLayerState::get() {
-        if let Some(vpath) = state.resolve_path(path_str) {
-            if let Some(entry) = state.query_manifest(&vpath) {
-                std::ptr::write_bytes(buf, 0, 1);
-                (*buf).stx_mask = 0x7FF; // basic stats
-                (*buf).stx_size = entry.size as _;
-                (*buf).stx_mode = entry.mode as _;
-                (*buf).stx_ino = vrift_ipc::fnv1a_hash(path_str) as _;
-                (*buf).stx_nlink = 1;
-                (*buf).stx_mtime.tv_sec = entry.mtime as _;
-                (*buf).stx_blksize = 4096;
-                (*buf).stx_blocks = entry.size.div_ceil(512);
-                inception_record!(EventType::StatHit, (*buf).stx_ino, 0);
-                return 0;
-            }
+    if let Ok(path_str) = path_cstr.to_str() {
+        let mut st: libc_stat = std::mem::zeroed();
+        if stat_impl_common(path_str, &mut st) == Some(0) && statx_vfs_answers(st.st_mode, flags) {
+            std::ptr::write_bytes(buf, 0, 1);
+            (*buf).stx_mask = 0x7FF; // STATX_BASIC_STATS
+            (*buf).stx_size = st.st_size as _;
+            (*buf).stx_mode = st.st_mode as _;
+            (*buf).stx_ino = st.st_ino as _;
+            (*buf).stx_nlink = st.st_nlink as _;
+            (*buf).stx_mtime.tv_sec = st.st_mtime as _;
+            (*buf).stx_mtime.tv_nsec = st.st_mtime_nsec as _;
+            (*buf).stx_blksize = 4096;
+            (*buf).stx_blocks = (st.st_size as u64).div_ceil(512);
+            return 0;
         }
     }
 
     crate::syscalls::linux_raw::raw_statx(dirfd, path, flags, mask, buf as *mut libc::c_void)
 }
 
+/// statx lookups relative to an fd — `AT_EMPTY_PATH` (`File::metadata`)
+/// or a relative path under a real dirfd — name nothing the VFS can
+/// resolve by path; the kernel answers them, as before statx was hooked.
+#[cfg(target_os = "linux")]
+fn statx_needs_kernel(dirfd: c_int, path: &CStr) -> bool {
+    let path = path.to_bytes();
+    path.is_empty() || (dirfd != libc::AT_FDCWD && path[0] != b'/')
+}
+
+/// Whether a VFS entry with `mode` is the statx answer under `flags`. The
+/// VFS does not follow symlinks, so a symlink entry only answers with
+/// `AT_SYMLINK_NOFOLLOW`; otherwise the kernel resolves it.
+#[cfg(target_os = "linux")]
+fn statx_vfs_answers(mode: libc::mode_t, flags: c_int) -> bool {
+    mode & libc::S_IFMT != libc::S_IFLNK || flags & libc::AT_SYMLINK_NOFOLLOW != 0
+}
+
 /// Helper: Find an open temp_path for a given manifest path.
 unsafe fn find_live_temp_path(manifest_path: &str) -> Option<crate::state::FixedString<1024>> {
     let state = InceptionLayerState::get()?;
@@ -489,3 +534,29 @@ unsafe fn find_live_temp_path(manifest_path: &str) -> Option<crate::state::Fixed
     });
     result
 }
+
+#[cfg(all(test, target_os = "linux"))]
+mod tests {
+    use super::*;
+
+    #[test]
+    fn test_statx_fd_relative_lookups_go_to_the_kernel() {
+        // File::metadata(): statx(fd, "", AT_EMPTY_PATH)
+        assert!(statx_needs_kernel(3, c""));
+        assert!(statx_needs_kernel(libc::AT_FDCWD, c""));
+        // Relative to a directory fd, not the cwd
+        assert!(statx_needs_kernel(3, c"rel/file"));
+        assert!(!statx_needs_kernel(3, c"/vrift/file"));
+        assert!(!statx_needs_kernel(libc::AT_FDCWD, c"rel/file"));
+    }
+
+    #[test]
+    fn test_statx_symlink_entries_need_nofollow() {
+        assert!(statx_vfs_answers(libc::S_IFREG | 0o644, 0));
+        assert!(!statx_vfs_answers(libc::S_IFLNK | 0o777, 0));
+        assert!(statx_vfs_answers(
+            libc::S_IFLNK | 0o777,
+            libc::AT_SYMLINK_NOFOLLOW
+        ));
+    }
+}
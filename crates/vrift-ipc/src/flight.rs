@@ -0,0 +1,294 @@
+//! Flight recorder dump format — written by the InceptionLayer, decoded by
+//! `vrift trace`.
+//!
+//! The InceptionLayer keeps per-thread rings of `FlightEntry` records (always
+//! on, no allocation) and writes them to `<VRIFT_FLIGHT_DUMP>.<pid>` on
+//! SIGUSR2 or at exit. This module defines the on-disk layout and parses it.
+//!
+//! Layout (little-endian):
+//! ```text
+//! offset  field                        size
+//! ------  ---------------------------  ----
+//!    0    FlightDumpHeader               64
+//!   64    entries[count]    count * FLIGHT_ENTRY_SIZE
+//! ```
+//!
+//! Timestamps and durations are raw clock ticks: the TSC on x86_64, the
+//! virtual counter on aarch64, nanoseconds elsewhere. The header carries two
+//! (ticks, CLOCK_MONOTONIC ns) samples, taken at startup and at dump time,
+//! to convert them.
+
+use thiserror::Error;
+
+/// Magic number: "VRFR" in little-endian
+pub const FLIGHT_MAGIC: u32 = 0x52465256;
+
+/// Layout version. Bump on incompatible changes.
+pub const FLIGHT_VERSION: u32 = 1;
+
+pub const FLIGHT_HEADER_SIZE: usize = 64;
+pub const FLIGHT_ENTRY_SIZE: usize = 32;
+
+/// Names of the InceptionLayer `EventType`s, by discriminant
+pub const EVENT_NAMES: &[&str] = &[
+    "UNKNOWN",
+    "OpenHit",
+    "OpenMiss",
+    "StatHit",
+    "StatMiss",
+    "CowTriggered",
+    "IpcFail",
+    "IpcSuccess",
+    "CircuitTripped",
+    "VfsInit",
+    "Close",
+    "ReingestSuccess",
+    "ReingestFail",
+];
+
+pub fn event_name(event_type: u8) -> &'static str {
+    EVENT_NAMES
+        .get(event_type as usize)
+        .copied()
+        .unwrap_or("INVALID")
+}
+
+fn read_u32(bytes: &[u8], at: usize) -> u32 {
+    u32::from_le_bytes(bytes[at..at + 4].try_into().unwrap())
+}
+
+fn read_u64(bytes: &[u8], at: usize) -> u64 {
+    u64::from_le_bytes(bytes[at..at + 8].try_into().unwrap())
+}
+
+/// One recorded event
+#[repr(C)]
+#[derive(Debug, Clone, Copy, Default, PartialEq, Eq)]
+pub struct FlightEntry {
+    /// Clock ticks when the event was recorded
+    pub timestamp: u64,
+    /// 64-bit path hash (FNV1a) or other event-specific id
+    pub file_id: u64,
+    /// Ticks spent in the operation the event ends (0 = point event)
+    pub duration: u32,
+    /// OS thread id
+    pub tid: u32,
+    pub result: i32,
+    pub event_type: u8,
+    pub _pad: [u8; 3],
+}
+
+impl FlightEntry {
+    pub const EMPTY: Self = Self {
+        timestamp: 0,
+        file_id: 0,
+        duration: 0,
+        tid: 0,
+        result: 0,
+        event_type: 0,
+        _pad: [0; 3],
+    };
+
+    pub fn to_bytes(&self) -> [u8; FLIGHT_ENTRY_SIZE] {
+        let mut out = [0u8; FLIGHT_ENTRY_SIZE];
+        out[0..8].copy_from_slice(&self.timestamp.to_le_bytes());
+        out[8..16].copy_from_slice(&self.file_id.to_le_bytes());
+        out[16..20].copy_from_slice(&self.duration.to_le_bytes());
+        out[20..24].copy_from_slice(&self.tid.to_le_bytes());
+        out[24..28].copy_from_slice(&self.result.to_le_bytes());
+        out[28] = self.event_type;
+        out
+    }
+
+    pub fn from_bytes(bytes: &[u8]) -> Self {
+        Self {
+            timestamp: read_u64(bytes, 0),
+            file_id: read_u64(bytes, 8),
+            duration: read_u32(bytes, 16),
+            tid: read_u32(bytes, 20),
+            result: read_u32(bytes, 24) as i32,
+            event_type: bytes[28],
+            _pad: [0; 3],
+        }
+    }
+}
+
+/// Dump header
+#[derive(Debug, Clone, Copy, Default, PartialEq, Eq)]
+pub struct FlightDumpHeader {
+    pub pid: u32,
+    /// Entries following the header
+    pub count: u64,
+    /// Clock sample at startup
+    pub base_ticks: u64,
+    pub base_ns: u64,
+    /// Clock sample at dump time
+    pub dump_ticks: u64,
+    pub dump_ns: u64,
+}
+
+impl FlightDumpHeader {
+    pub fn to_bytes(&self) -> [u8; FLIGHT_HEADER_SIZE] {
+        let mut out = [0u8; FLIGHT_HEADER_SIZE];
+        out[0..4].copy_from_slice(&FLIGHT_MAGIC.to_le_bytes());
+        out[4..8].copy_from_slice(&FLIGHT_VERSION.to_le_bytes());
+        out[8..12].copy_from_slice(&self.pid.to_le_bytes());
+        out[12..16].copy_from_slice(&(FLIGHT_ENTRY_SIZE as u32).to_le_bytes());
+        out[16..24].copy_from_slice(&self.count.to_le_bytes());
+        out[24..32].copy_from_slice(&self.base_ticks.to_le_bytes());
+        out[32..40].copy_from_slice(&self.base_ns.to_le_bytes());
+        out[40..48].copy_from_slice(&self.dump_ticks.to_le_bytes());
+        out[48..56].copy_from_slice(&self.dump_ns.to_le_bytes());
+        out
+    }
+}
+
+#[derive(Debug, Error, PartialEq, Eq)]
+pub enum FlightError {
+    #[error("not a flight recorder dump")]
+    BadMagic,
+    #[error("unsupported flight recorder dump version {0}")]
+    Version(u32),
+    #[error("flight recorder dump truncated")]
+    Truncated,
+}
+
+/// A parsed dump
+#[derive(Debug, Clone)]
+pub struct FlightDump {
+    pub header: FlightDumpHeader,
+    pub entries: Vec<FlightEntry>,
+    ns_per_tick: f64,
+}
+
+impl FlightDump {
+    /// Parse a dump. A dump cut short (the process died mid-write) keeps the
+    /// entries that are complete.
+    pub fn parse(bytes: &[u8]) -> Result<Self, FlightError> {
+        if bytes.len() < FLIGHT_HEADER_SIZE {
+            return Err(FlightError::Truncated);
+        }
+        if read_u32(bytes, 0) != FLIGHT_MAGIC {
+            return Err(FlightError::BadMagic);
+        }
+        let version = read_u32(bytes, 4);
+        if version != FLIGHT_VERSION || read_u32(bytes, 12) as usize != FLIGHT_ENTRY_SIZE {
+            return Err(FlightError::Version(version));
+        }
+        let header = FlightDumpHeader {
+            pid: read_u32(bytes, 8),
+            count: read_u64(bytes, 16),
+            base_ticks: read_u64(bytes, 24),
+            base_ns: read_u64(bytes, 32),
+            dump_ticks: read_u64(bytes, 40),
+            dump_ns: read_u64(bytes, 48),
+        };
+
+        let body = &bytes[FLIGHT_HEADER_SIZE..];
+        let count = (header.count as usize).min(body.len() / FLIGHT_ENTRY_SIZE);
+        let entries = body
+            .chunks_exact(FLIGHT_ENTRY_SIZE)
+            .take(count)
+            .map(FlightEntry::from_bytes)
+            .collect();
+
+        let ns_per_tick =
+            if header.dump_ticks > header.base_ticks && header.dump_ns > header.base_ns {
+                (header.dump_ns - header.base_ns) as f64
+                    / (header.dump_ticks - header.base_ticks) as f64
+            } else {
+                1.0
+            };
+
+        Ok(Self {
+            header,
+            entries,
+            ns_per_tick,
+        })
+    }
+
+    /// CLOCK_MONOTONIC time of an entry, in ns
+    pub fn timestamp_ns(&self, entry: &FlightEntry) -> u64 {
+        let delta = entry.timestamp as f64 - self.header.base_ticks as f64;
+        (self.header.base_ns as f64 + delta * self.ns_per_tick).max(0.0) as u64
+    }
+
+    pub fn duration_ns(&self, entry: &FlightEntry) -> u64 {
+        (entry.duration as f64 * self.ns_per_tick) as u64
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    fn dump(header: FlightDumpHeader, entries: &[FlightEntry]) -> Vec<u8> {
+        let mut bytes = header.to_bytes().to_vec();
+        for entry in entries {
+            bytes.extend_from_slice(&entry.to_bytes());
+        }
+        bytes
+    }
+
+    #[test]
+    fn test_flight_entry_layout() {
+        assert_eq!(std::mem::size_of::<FlightEntry>(), FLIGHT_ENTRY_SIZE);
+    }
+
+    #[test]
+    fn test_dump_roundtrip_converts_ticks() {
+        // 3 ticks per ns
+        let header = FlightDumpHeader {
+            pid: 42,
+            count: 2,
+            base_ticks: 3_000,
+            base_ns: 1_000,
+            dump_ticks: 33_000,
+            dump_ns: 11_000,
+        };
+        let entries = [
+            FlightEntry {
+                timestamp: 6_000,
+                file_id: 0xabc,
+                duration: 300,
+                tid: 7,
+                result: -2,
+                event_type: 4,
+                _pad: [0; 3],
+            },
+            FlightEntry {
+                timestamp: 9_000,
+                event_type: 1,
+                ..FlightEntry::EMPTY
+            },
+        ];
+
+        let parsed = FlightDump::parse(&dump(header, &entries)).unwrap();
+        assert_eq!(parsed.header, header);
+        assert_eq!(parsed.entries, entries);
+        assert_eq!(parsed.timestamp_ns(&parsed.entries[0]), 2_000);
+        assert_eq!(parsed.duration_ns(&parsed.entries[0]), 100);
+        assert_eq!(event_name(parsed.entries[0].event_type), "StatMiss");
+    }
+
+    #[test]
+    fn test_truncated_dump_keeps_complete_entries() {
+        let header = FlightDumpHeader {
+            count: 3,
+            ..Default::default()
+        };
+        let mut bytes = dump(header, &[FlightEntry::EMPTY; 3]);
+        bytes.truncate(bytes.len() - 10);
+        assert_eq!(FlightDump::parse(&bytes).unwrap().entries.len(), 2);
+
+        bytes[0] = 0;
+        assert_eq!(
+            FlightDump::parse(&bytes).unwrap_err(),
+            FlightError::BadMagic
+        );
+        assert_eq!(
+            FlightDump::parse(&bytes[..10]).unwrap_err(),
+            FlightError::Truncated
+        );
+    }
+}
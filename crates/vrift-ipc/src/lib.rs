@@ -1,3 +1,6 @@
+pub mod flight;
+pub mod metrics;
+pub mod mutation_ring;
 pub mod vdir_types;
 use rkyv::Archive;
 use serde::{Deserialize, Serialize};
@@ -551,6 +554,10 @@ pub mod frame_async {
     }
 }
 
+/// Maximum number of paths in one `ManifestGetMany` request.
+/// Keeps a batched response comfortably below the client's 1MB frame limit.
+pub const MANIFEST_GET_MANY_MAX: usize = 1024;
+
 #[derive(Debug, Serialize, Deserialize, Archive, rkyv::Serialize, rkyv::Deserialize)]
 pub enum VeloRequest {
     Handshake {
@@ -579,6 +586,12 @@ pub enum VeloRequest {
     ManifestGet {
         path: String,
     },
+    /// Batched ManifestGet: one frame for a burst of sibling probes.
+    /// Answered by `ManifestGetManyAck` with one result per path, in order.
+    /// At most `MANIFEST_GET_MANY_MAX` paths per request.
+    ManifestGetMany {
+        paths: Vec<String>,
+    },
     /// Manifest payload
     ManifestUpsert {
         path: String,
@@ -604,6 +617,9 @@ pub enum VeloRequest {
         vpath: String,
         /// Actual temp file path to read and hash
         temp_path: String,
+        /// What the writer changed relative to the blob the temp file was
+        /// copied from; None means rehash the whole file
+        delta: Option<ReingestDelta>,
     },
     /// List directory entries for VFS synthesis
     ManifestListDir {
@@ -623,6 +639,15 @@ pub enum VeloRequest {
         /// Bloom Filter of all active hashes in the manifest
         bloom_filter: Vec<u8>,
     },
+    /// Trigger Garbage Collection against a live set file (`vrift_cas::LiveSet`)
+    CasSweepLive {
+        /// Sorted live hashes written by the CLI's mark phase
+        live_set_path: String,
+        /// Keep orphans changed less than this long before the mark
+        min_age_secs: u64,
+        /// Cap on sweep filesystem operations per second (0 = unlimited)
+        io_ops_per_sec: u32,
+    },
     /// Register a workspace with the daemon
     RegisterWorkspace {
         /// The absolute path to the project root
@@ -650,6 +675,45 @@ pub enum VeloRequest {
         /// Force full file read+hash, bypassing mtime+size cache skip (P0)
         force_hash: bool,
     },
+    /// Blobs a process opened from the VFS, in first-open order (vDird
+    /// prefetcher). Fire-and-forget, at most `ACCESS_TRACE_MAX` per request.
+    AccessTrace {
+        /// argv[0] of the process
+        command: String,
+        /// Working directory the process started in
+        cwd: String,
+        blobs: Vec<AccessedBlob>,
+    },
+    /// A process started: warm the page cache with the blobs `command` run
+    /// from `cwd` opened last time. Answered by `PrefetchAck`.
+    PrefetchHint {
+        command: String,
+        cwd: String,
+    },
+    /// Counters in Prometheus text format (`metrics::PromText`): each
+    /// vriftd/vDird reports its own. Answered by `MetricsAck`.
+    Metrics,
+}
+
+/// Maximum number of blobs in one `AccessTrace` request.
+pub const ACCESS_TRACE_MAX: usize = 128;
+
+/// One CAS blob read by a traced process
+#[derive(
+    Debug,
+    Clone,
+    Copy,
+    PartialEq,
+    Eq,
+    Serialize,
+    Deserialize,
+    Archive,
+    rkyv::Serialize,
+    rkyv::Deserialize,
+)]
+pub struct AccessedBlob {
+    pub hash: [u8; 32],
+    pub size: u64,
 }
 
 #[derive(Debug, Clone, Serialize, Deserialize, Archive, rkyv::Serialize, rkyv::Deserialize)]
@@ -658,6 +722,26 @@ pub struct DirEntry {
     pub is_dir: bool,
 }
 
+/// Changes made to a CoW temp file since it was copied from a CAS blob,
+/// as tracked by the inception layer. Lets the reingest rehash only the
+/// dirty byte ranges when the base blob's hash tree is known.
+#[derive(
+    Debug, Clone, PartialEq, Eq, Serialize, Deserialize, Archive, rkyv::Serialize, rkyv::Deserialize,
+)]
+pub struct ReingestDelta {
+    /// Content hash of the blob the temp file started as
+    pub base_hash: [u8; 32],
+    pub base_size: u64,
+    /// Lowest length the file was truncated to (`u64::MAX` if never)
+    pub truncated_to: u64,
+    /// Written byte ranges, `[start, end)`
+    pub ranges: Vec<[u64; 2]>,
+    /// The whole file was cloned from `base_hash` (copy_file_range /
+    /// sendfile of a VFS blob) and not touched since. Only this lets the
+    /// daemon skip reading the file; empty `ranges` alone do not.
+    pub cloned: bool,
+}
+
 #[cfg(feature = "manifest")]
 pub use vrift_manifest::VnodeEntry;
 
@@ -856,6 +940,10 @@ pub enum VeloResponse {
     ManifestAck {
         entry: Option<VnodeEntry>,
     },
+    /// Response to `ManifestGetMany`: `entries[i]` answers `paths[i]`
+    ManifestGetManyAck {
+        entries: Vec<Option<VnodeEntry>>,
+    },
     /// Directory listing response for VFS synthesis
     ManifestListAck {
         entries: Vec<DirEntry>,
@@ -891,6 +979,14 @@ pub enum VeloResponse {
         /// Manifest path
         manifest_path: String,
     },
+    /// AccessTrace: blobs newly learned; PrefetchHint: blobs scheduled for
+    /// readahead
+    PrefetchAck {
+        blobs: u32,
+    },
+    MetricsAck {
+        text: String,
+    },
     /// Structured error response (Phase 3: replaces Error(String))
     Error(VeloError),
 }
@@ -1426,6 +1522,35 @@ mod tests {
         assert!(matches!(decoded, VeloResponse::StatusAck { .. }));
     }
 
+    #[test]
+    fn test_manifest_get_many_roundtrip() {
+        let req = VeloRequest::ManifestGetMany {
+            paths: vec!["/src/a.h".to_string(), "/src/b.h".to_string()],
+        };
+        let bytes = rkyv::to_bytes::<rkyv::rancor::Error>(&req).unwrap();
+        let decoded: VeloRequest =
+            rkyv::from_bytes::<VeloRequest, rkyv::rancor::Error>(&bytes).unwrap();
+        match decoded {
+            VeloRequest::ManifestGetMany { paths } => assert_eq!(paths, ["/src/a.h", "/src/b.h"]),
+            _ => panic!("Expected ManifestGetMany"),
+        }
+
+        let resp = VeloResponse::ManifestGetManyAck {
+            entries: vec![Some(VnodeEntry::new_file([7u8; 32], 42, 0, 0o644)), None],
+        };
+        let bytes = rkyv::to_bytes::<rkyv::rancor::Error>(&resp).unwrap();
+        let decoded: VeloResponse =
+            rkyv::from_bytes::<VeloResponse, rkyv::rancor::Error>(&bytes).unwrap();
+        match decoded {
+            VeloResponse::ManifestGetManyAck { entries } => {
+                assert_eq!(entries.len(), 2);
+                assert_eq!(entries[0].as_ref().unwrap().size, 42);
+                assert!(entries[1].is_none());
+            }
+            _ => panic!("Expected ManifestGetManyAck"),
+        }
+    }
+
     #[test]
     fn test_default_socket_path() {
         // Verify default socket path is set
@@ -0,0 +1,472 @@
+//! Interposition metrics — per-process counter blocks in a shm file next to
+//! the VDir.
+//!
+//! Every InceptionLayer client process claims one slot (CAS on `pid`) and
+//! bumps its counters with relaxed atomic adds. Slots are cache-line
+//! aligned, so processes never share a line. vDird reads the whole file
+//! without IPC, folds the slots of exited processes into its own running
+//! totals and frees them (`MetricsSlot::reap`).
+//!
+//! This module only defines the layout, the counters and the Prometheus
+//! text rendering; mapping the file lives with each side.
+//!
+//! Layout:
+//! ```text
+//! offset  field                      size
+//! ------  -------------------------  ----
+//!    0    magic / version / geometry  128
+//!  128    slots[METRICS_SLOTS]   METRICS_SLOTS * METRICS_SLOT_SIZE
+//! ```
+
+use std::fmt::Write;
+use std::sync::atomic::{AtomicU32, AtomicU64, Ordering};
+
+/// Magic number: "VRMT" in little-endian
+pub const METRICS_MAGIC: u32 = 0x544D5256;
+
+/// Layout version. Bump on incompatible changes (including new counters
+/// that do not fit in `METRICS_COUNTERS`).
+pub const METRICS_VERSION: u32 = 1;
+
+/// Client processes tracked at once; later ones run without metrics
+pub const METRICS_SLOTS: usize = 512;
+
+/// Counter words per slot (room to add counters without a layout change)
+pub const METRICS_COUNTERS: usize = 32;
+
+/// Metrics file lives next to the VDir file: `<vdir_path>.metrics`
+pub const METRICS_SUFFIX: &str = ".metrics";
+
+const HEADER_SIZE: usize = 128;
+
+pub const METRICS_SLOT_SIZE: usize = std::mem::size_of::<MetricsSlot>();
+
+/// Total file size
+pub const fn metrics_file_size() -> usize {
+    HEADER_SIZE + METRICS_SLOTS * METRICS_SLOT_SIZE
+}
+
+/// Upper bounds (µs) of the IPC latency buckets; one more bucket catches
+/// everything slower
+pub const IPC_LATENCY_BOUNDS_US: [u64; 8] = [10, 25, 50, 100, 250, 500, 1_000, 5_000];
+
+const IPC_LATENCY_BASE: usize = 16;
+
+/// Counter indices
+#[repr(usize)]
+#[derive(Debug, Clone, Copy, PartialEq, Eq)]
+pub enum Metric {
+    /// Lookups answered from the VDir mmap
+    VdirHit = 0,
+    /// Lookups not found in the VDir table
+    VdirMiss = 1,
+    /// Seqlock reads retried because vDird was writing
+    SeqlockRetry = 2,
+    /// Synchronous request/response round trips
+    IpcCall = 3,
+    /// Round trips that got no response
+    IpcError = 4,
+    IpcLatencySumNs = 5,
+    /// Calls served by the real syscall because vriftd/vDird was unreachable
+    /// (connect failure or open circuit breaker)
+    RawFallback = 6,
+    /// Copy-on-write sessions (file opened for writing out of the CAS)
+    CowSession = 7,
+    /// Files handed back to vDird for reingest on close
+    ReingestFile = 8,
+    ReingestBytes = 9,
+}
+
+/// Counter index of the IPC latency bucket for a round trip of `ns`
+pub fn ipc_latency_bucket(ns: u64) -> usize {
+    let us = ns / 1_000;
+    IPC_LATENCY_BASE
+        + IPC_LATENCY_BOUNDS_US
+            .iter()
+            .position(|&bound| us < bound)
+            .unwrap_or(IPC_LATENCY_BOUNDS_US.len())
+}
+
+const _: () = assert!(IPC_LATENCY_BASE + IPC_LATENCY_BOUNDS_US.len() < METRICS_COUNTERS);
+const _: () = assert!((Metric::ReingestBytes as usize) < IPC_LATENCY_BASE);
+
+#[repr(C)]
+struct Header {
+    magic: u32,
+    version: u32,
+    slots: u32,
+    slot_size: u32,
+    _pad: [u8; HEADER_SIZE - 16],
+}
+
+/// One client process
+#[repr(C, align(128))]
+pub struct MetricsSlot {
+    /// Owning process, 0 = free
+    pid: AtomicU32,
+    _pad: [u8; 124],
+    counters: [AtomicU64; METRICS_COUNTERS],
+}
+
+impl MetricsSlot {
+    #[inline(always)]
+    pub fn add(&self, metric: Metric, n: u64) {
+        self.add_at(metric as usize, n);
+    }
+
+    #[inline(always)]
+    pub fn add_at(&self, idx: usize, n: u64) {
+        self.counters[idx].fetch_add(n, Ordering::Relaxed);
+    }
+
+    /// One IPC round trip
+    #[inline(always)]
+    pub fn record_ipc(&self, ns: u64, ok: bool) {
+        self.add(Metric::IpcCall, 1);
+        if !ok {
+            self.add(Metric::IpcError, 1);
+        }
+        self.add(Metric::IpcLatencySumNs, ns);
+        self.add_at(ipc_latency_bucket(ns), 1);
+    }
+
+    pub fn pid(&self) -> u32 {
+        self.pid.load(Ordering::Acquire)
+    }
+
+    fn read(&self, into: &mut [u64; METRICS_COUNTERS]) {
+        for (out, c) in into.iter_mut().zip(&self.counters) {
+            *out += c.load(Ordering::Relaxed);
+        }
+    }
+
+    /// Move the counters of an exited owner into `into` and free the slot.
+    /// Only for slots whose process is gone (nobody writes any more).
+    pub fn reap(&self, into: &mut [u64; METRICS_COUNTERS]) {
+        for (out, c) in into.iter_mut().zip(&self.counters) {
+            *out += c.swap(0, Ordering::Relaxed);
+        }
+        self.pid.store(0, Ordering::Release);
+    }
+}
+
+/// Handle to a mapped metrics file (Copy; the mapping outlives it)
+#[derive(Clone, Copy)]
+pub struct MetricsBlock {
+    base: *mut u8,
+}
+
+// SAFETY: only atomics are accessed through the pointer
+unsafe impl Send for MetricsBlock {}
+unsafe impl Sync for MetricsBlock {}
+
+impl MetricsBlock {
+    /// Initialize a fresh (zeroed) mapping.
+    ///
+    /// # Safety
+    /// `ptr` must be a writable mapping of at least `len` bytes, aligned to
+    /// 128, that outlives every use of the returned handle.
+    pub unsafe fn init(ptr: *mut u8, len: usize) -> Option<Self> {
+        if ptr.is_null() || len < metrics_file_size() || !(ptr as usize).is_multiple_of(128) {
+            return None;
+        }
+        std::ptr::write_bytes(ptr, 0, metrics_file_size());
+        let header = &mut *(ptr as *mut Header);
+        header.slots = METRICS_SLOTS as u32;
+        header.slot_size = METRICS_SLOT_SIZE as u32;
+        header.version = METRICS_VERSION;
+        std::sync::atomic::fence(Ordering::Release);
+        header.magic = METRICS_MAGIC;
+        Some(Self { base: ptr })
+    }
+
+    /// Attach to an initialized mapping; None if it is foreign or of another
+    /// layout version.
+    ///
+    /// # Safety
+    /// As for `init`.
+    pub unsafe fn attach(ptr: *mut u8, len: usize) -> Option<Self> {
+        if ptr.is_null() || len < metrics_file_size() || !(ptr as usize).is_multiple_of(128) {
+            return None;
+        }
+        let header = &*(ptr as *const Header);
+        if header.magic != METRICS_MAGIC
+            || header.version != METRICS_VERSION
+            || header.slots as usize != METRICS_SLOTS
+            || header.slot_size as usize != METRICS_SLOT_SIZE
+        {
+            return None;
+        }
+        Some(Self { base: ptr })
+    }
+
+    pub fn slots(&self) -> &[MetricsSlot] {
+        unsafe {
+            std::slice::from_raw_parts(
+                self.base.add(HEADER_SIZE) as *const MetricsSlot,
+                METRICS_SLOTS,
+            )
+        }
+    }
+
+    /// Slot for `pid`: the one it already owns (exec keeps the pid), else a
+    /// free one. None when every slot is taken.
+    pub fn claim(&self, pid: u32) -> Option<&MetricsSlot> {
+        let slots = self.slots();
+        if let Some(own) = slots.iter().find(|s| s.pid() == pid) {
+            return Some(own);
+        }
+        let start = pid as usize % METRICS_SLOTS;
+        (0..METRICS_SLOTS)
+            .map(|i| &slots[(start + i) % METRICS_SLOTS])
+            .find(|s| {
+                s.pid
+                    .compare_exchange(0, pid, Ordering::AcqRel, Ordering::Relaxed)
+                    .is_ok()
+            })
+    }
+
+    /// Sum over the live slots, reaping those whose process `is_alive`
+    /// rejects into `retired`
+    pub fn collect(
+        &self,
+        retired: &mut [u64; METRICS_COUNTERS],
+        is_alive: impl Fn(u32) -> bool,
+    ) -> MetricsSnapshot {
+        let mut snapshot = MetricsSnapshot::default();
+        for slot in self.slots() {
+            let pid = slot.pid();
+            if pid == 0 {
+                continue;
+            }
+            if is_alive(pid) {
+                slot.read(&mut snapshot.counters);
+                snapshot.processes += 1;
+            } else {
+                slot.reap(retired);
+            }
+        }
+        for (c, r) in snapshot.counters.iter_mut().zip(retired.iter()) {
+            *c += r;
+        }
+        snapshot
+    }
+}
+
+/// Counters summed over all processes that ever reported
+#[derive(Debug, Clone, Copy, PartialEq, Eq)]
+pub struct MetricsSnapshot {
+    pub counters: [u64; METRICS_COUNTERS],
+    /// Live processes with a slot
+    pub processes: usize,
+}
+
+impl Default for MetricsSnapshot {
+    fn default() -> Self {
+        Self {
+            counters: [0; METRICS_COUNTERS],
+            processes: 0,
+        }
+    }
+}
+
+impl MetricsSnapshot {
+    pub fn get(&self, metric: Metric) -> u64 {
+        self.counters[metric as usize]
+    }
+
+    /// VDir hit rate in [0, 1], None before any lookup
+    pub fn vdir_hit_rate(&self) -> Option<f64> {
+        let hits = self.get(Metric::VdirHit);
+        let total = hits + self.get(Metric::VdirMiss);
+        (total > 0).then(|| hits as f64 / total as f64)
+    }
+
+    /// Render as Prometheus text exposition
+    pub fn render(&self, out: &mut PromText) {
+        out.gauge(
+            "vrift_inception_processes",
+            "Client processes currently reporting",
+            self.processes as f64,
+        );
+        for (metric, name, help) in [
+            (
+                Metric::VdirHit,
+                "vrift_inception_vdir_hits_total",
+                "Lookups answered from the VDir mmap",
+            ),
+            (
+                Metric::VdirMiss,
+                "vrift_inception_vdir_misses_total",
+                "Lookups the VDir could not answer",
+            ),
+            (
+                Metric::SeqlockRetry,
+                "vrift_inception_seqlock_retries_total",
+                "VDir seqlock reads retried during a vDird write",
+            ),
+            (
+                Metric::RawFallback,
+                "vrift_inception_raw_fallbacks_total",
+                "Calls passed to the real syscall because the daemon was unreachable",
+            ),
+            (
+                Metric::CowSession,
+                "vrift_inception_cow_sessions_total",
+                "Copy-on-write sessions",
+            ),
+            (
+                Metric::ReingestFile,
+                "vrift_inception_reingest_files_total",
+                "Files reingested on close",
+            ),
+            (
+                Metric::ReingestBytes,
+                "vrift_inception_reingest_bytes_total",
+                "Bytes reingested on close",
+            ),
+            (
+                Metric::IpcError,
+                "vrift_inception_ipc_errors_total",
+                "IPC round trips without a response",
+            ),
+        ] {
+            out.counter(name, help, self.get(metric));
+        }
+
+        let buckets =
+            &self.counters[IPC_LATENCY_BASE..=IPC_LATENCY_BASE + IPC_LATENCY_BOUNDS_US.len()];
+        out.histogram(
+            "vrift_inception_ipc_duration_seconds",
+            "IPC round trip latency",
+            &IPC_LATENCY_BOUNDS_US.map(|us| us as f64 / 1e6),
+            buckets,
+            self.get(Metric::IpcLatencySumNs) as f64 / 1e9,
+        );
+    }
+}
+
+/// Minimal Prometheus text format (0.0.4) writer. No `# EOF`, so the output
+/// of several components can be concatenated.
+#[derive(Debug, Default)]
+pub struct PromText {
+    text: String,
+}
+
+impl PromText {
+    pub fn new() -> Self {
+        Self::default()
+    }
+
+    fn header(&mut self, name: &str, help: &str, kind: &str) {
+        let _ = writeln!(self.text, "# HELP {} {}", name, help);
+        let _ = writeln!(self.text, "# TYPE {} {}", name, kind);
+    }
+
+    pub fn counter(&mut self, name: &str, help: &str, value: u64) {
+        self.header(name, help, "counter");
+        let _ = writeln!(self.text, "{} {}", name, value);
+    }
+
+    pub fn gauge(&mut self, name: &str, help: &str, value: f64) {
+        self.header(name, help, "gauge");
+        let _ = writeln!(self.text, "{} {}", name, value);
+    }
+
+    /// `buckets` are per-bucket (not cumulative) counts, one per bound plus
+    /// the overflow bucket
+    pub fn histogram(&mut self, name: &str, help: &str, bounds: &[f64], buckets: &[u64], sum: f64) {
+        self.header(name, help, "histogram");
+        let mut cumulative = 0;
+        for (bound, count) in bounds.iter().zip(buckets) {
+            cumulative += count;
+            let _ = writeln!(
+                self.text,
+                "{}_bucket{{le=\"{}\"}} {}",
+                name, bound, cumulative
+            );
+        }
+        cumulative += buckets.get(bounds.len()).copied().unwrap_or(0);
+        let _ = writeln!(self.text, "{}_bucket{{le=\"+Inf\"}} {}", name, cumulative);
+        let _ = writeln!(self.text, "{}_sum {}", name, sum);
+        let _ = writeln!(self.text, "{}_count {}", name, cumulative);
+    }
+
+    pub fn finish(self) -> String {
+        self.text
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    #[repr(C, align(128))]
+    struct Aligned([u8; metrics_file_size()]);
+
+    fn block() -> (Box<Aligned>, MetricsBlock) {
+        let mut mem = Box::new(Aligned([0xAA; metrics_file_size()]));
+        let block = unsafe { MetricsBlock::init(mem.0.as_mut_ptr(), metrics_file_size()) }.unwrap();
+        (mem, block)
+    }
+
+    #[test]
+    fn test_slot_layout() {
+        assert_eq!(METRICS_SLOT_SIZE, 384);
+        assert_eq!(std::mem::size_of::<Header>(), HEADER_SIZE);
+    }
+
+    #[test]
+    fn test_claim_collect_and_reap() {
+        let (mut mem, block) = block();
+        assert!(unsafe { MetricsBlock::attach(mem.0.as_mut_ptr(), metrics_file_size()) }.is_some());
+
+        let a = block.claim(100).unwrap();
+        let b = block.claim(200).unwrap();
+        assert!(!std::ptr::eq(a, b));
+        assert!(std::ptr::eq(block.claim(100).unwrap(), a));
+
+        a.add(Metric::VdirHit, 3);
+        b.add(Metric::VdirHit, 1);
+        b.add(Metric::VdirMiss, 1);
+        b.record_ipc(30_000, true);
+        b.record_ipc(9_000_000, false);
+
+        let mut retired = [0; METRICS_COUNTERS];
+        let live = block.collect(&mut retired, |_| true);
+        assert_eq!(live.processes, 2);
+        assert_eq!(live.get(Metric::VdirHit), 4);
+        assert_eq!(live.vdir_hit_rate(), Some(0.8));
+
+        // 200 exits: its counts survive in `retired`, its slot is free again
+        let after = block.collect(&mut retired, |pid| pid != 200);
+        assert_eq!(after.processes, 1);
+        assert_eq!(after.counters, live.counters);
+        assert_eq!(b.pid(), 0);
+        assert_eq!(retired[Metric::IpcCall as usize], 2);
+        assert_eq!(retired[ipc_latency_bucket(30_000)], 1);
+        assert_eq!(retired[IPC_LATENCY_BASE + IPC_LATENCY_BOUNDS_US.len()], 1);
+    }
+
+    #[test]
+    fn test_render_histogram_is_cumulative() {
+        let (_mem, block) = block();
+        let slot = block.claim(1).unwrap();
+        slot.record_ipc(5_000, true); // < 10µs
+        slot.record_ipc(40_000, true); // < 50µs
+        slot.record_ipc(40_000, false);
+
+        let mut out = PromText::new();
+        block
+            .collect(&mut [0; METRICS_COUNTERS], |_| true)
+            .render(&mut out);
+        let text = out.finish();
+        assert!(text.contains("vrift_inception_ipc_duration_seconds_bucket{le=\"0.00001\"} 1\n"));
+        assert!(text.contains("vrift_inception_ipc_duration_seconds_bucket{le=\"0.000025\"} 1\n"));
+        assert!(text.contains("vrift_inception_ipc_duration_seconds_bucket{le=\"0.00005\"} 3\n"));
+        assert!(text.contains("vrift_inception_ipc_duration_seconds_bucket{le=\"+Inf\"} 3\n"));
+        assert!(text.contains("vrift_inception_ipc_duration_seconds_count 3\n"));
+        assert!(text.contains("vrift_inception_ipc_errors_total 1\n"));
+        assert!(text.contains("# TYPE vrift_inception_vdir_hits_total counter\n"));
+    }
+}
@@ -0,0 +1,674 @@
+//! Mutation ring — cross-process MPSC queue in a shm file next to the VDir.
+//!
+//! Producers (InceptionLayer, one per client process and thread) push
+//! pre-serialized fire-and-forget `VeloRequest`s; the single consumer (vDird)
+//! drains them in batches. No socket, no syscall on the push path unless the
+//! consumer is parked, in which case the producer rings a futex doorbell.
+//!
+//! This module only defines the layout and the lock-free protocol; mapping
+//! the file and the futex wait/wake syscalls live with each side.
+//!
+//! Layout:
+//! ```text
+//! offset  field                      size
+//! ------  -------------------------  ----
+//!    0    magic / version / geometry  64
+//!  128    head     (producers, CAS)    8   ┐ each on its own
+//!  256    tail     (consumer)          8   │ 128-byte line pair
+//!  384    parked + doorbell            8   ┘ (no false sharing)
+//!  512    slots[capacity]   capacity * MUTATION_RING_SLOT_SIZE
+//! ```
+//!
+//! Each slot carries a sequence word (bounded MPMC queue scheme, used here
+//! with one consumer): `seq == pos` → free for the producer of `pos`,
+//! `seq == pos | WRITING` → claimed and being filled, `seq == pos + 1` →
+//! published, readable by the consumer. The consumer frees a slot for the
+//! next lap with `seq = pos + capacity`.
+//!
+//! A request bigger than one slot spans consecutive slots, claimed with one
+//! head CAS. The first slot holds the total length; the rest are published
+//! before it, so the consumer sees the whole span at once. Every request a
+//! process sends therefore goes through the ring in push order, whatever
+//! its size, and nothing overtakes it through the socket.
+//!
+//! A producer that stops between claiming and publishing stalls the ring
+//! (`PopResult::Stalled`). The consumer revokes the claim (`revoke_stalled`)
+//! instead of giving up on the ring: a claim not yet being written is taken
+//! back with a CAS, and the producer retries its push; one being written is
+//! taken back only once its owner process is gone.
+
+use std::sync::atomic::{fence, AtomicU32, AtomicU64, Ordering};
+
+/// Magic number: "VRMR" in little-endian
+pub const MUTATION_RING_MAGIC: u32 = 0x524D5256;
+
+/// Layout version. Bump on incompatible changes.
+pub const MUTATION_RING_VERSION: u32 = 2;
+
+/// Number of slots (power of 2)
+pub const MUTATION_RING_CAPACITY: usize = 4096;
+
+/// Bytes per slot (sequence + length + owner + payload)
+pub const MUTATION_RING_SLOT_SIZE: usize = 512;
+
+/// Payload bytes carried by one slot
+pub const MUTATION_RING_SLOT_PAYLOAD: usize = MUTATION_RING_SLOT_SIZE - SLOT_DATA_OFFSET;
+
+/// Most slots one request may span
+pub const MUTATION_RING_MAX_SPAN: usize = 64;
+
+/// Largest payload the ring accepts (a manifest mutation of two PATH_MAX
+/// paths fits); bigger requests use the socket
+pub const MUTATION_RING_MAX_PAYLOAD: usize = MUTATION_RING_SLOT_PAYLOAD * MUTATION_RING_MAX_SPAN;
+
+/// Ring file lives next to the VDir file: `<vdir_path>.ring`
+pub const MUTATION_RING_SUFFIX: &str = ".ring";
+
+const HEADER_SIZE: usize = 512;
+const SLOT_DATA_OFFSET: usize = 16;
+
+/// `seq` flag: the slot's producer is filling it (positions stay far below)
+const WRITING: u64 = 1 << 63;
+
+/// `len` of a slot that continues the request started before it
+const CONTINUATION: u32 = u32::MAX;
+
+/// Laps a slot's `seq` is ahead of position `pos` (negative: still held by
+/// the previous lap, 0: at `pos`, whether free or being written)
+#[inline(always)]
+fn lap(seq: u64, pos: u64) -> i64 {
+    (seq & !WRITING).wrapping_sub(pos) as i64
+}
+
+/// Slots a payload of `len` bytes spans
+const fn span_of(len: usize) -> usize {
+    if len == 0 {
+        1
+    } else {
+        len.div_ceil(MUTATION_RING_SLOT_PAYLOAD)
+    }
+}
+
+const _: () = assert!(MUTATION_RING_CAPACITY.is_power_of_two());
+
+/// Total file size for the default geometry
+pub const fn mutation_ring_size() -> usize {
+    HEADER_SIZE + MUTATION_RING_CAPACITY * MUTATION_RING_SLOT_SIZE
+}
+
+#[repr(C, align(128))]
+struct Line<T>(T);
+
+#[repr(C)]
+struct Geometry {
+    magic: u32,
+    version: u32,
+    capacity: u32,
+    slot_size: u32,
+    _pad: [u8; 48],
+}
+
+#[repr(C)]
+struct Doorbell {
+    /// 1 while the consumer is (about to be) waiting on `doorbell`
+    parked: AtomicU32,
+    /// Futex word: bumped by producers that saw `parked == 1`
+    doorbell: AtomicU32,
+}
+
+/// Shared header (first 512 bytes of the ring file).
+#[repr(C)]
+pub struct MutationRingHeader {
+    geometry: Line<Geometry>,
+    head: Line<AtomicU64>,
+    tail: Line<AtomicU64>,
+    bell: Line<Doorbell>,
+}
+
+const _: () = assert!(std::mem::size_of::<MutationRingHeader>() == HEADER_SIZE);
+
+#[repr(C)]
+struct SlotHeader {
+    seq: AtomicU64,
+    /// Payload bytes of the whole request (first slot) or `CONTINUATION`
+    len: AtomicU32,
+    /// Process id of the producer, set before `WRITING`
+    owner: AtomicU32,
+}
+
+const _: () = assert!(std::mem::size_of::<SlotHeader>() == SLOT_DATA_OFFSET);
+
+/// Why a push did not go through the ring
+#[derive(Debug, PartialEq, Eq)]
+pub enum PushError {
+    /// No room yet: retry once the consumer has drained
+    Full,
+    /// Over `MUTATION_RING_MAX_PAYLOAD`: use the socket
+    TooLarge,
+    /// The consumer took back a claim this push held too long: retry
+    Revoked,
+}
+
+/// Consumer-side result of one pop
+#[derive(Debug, PartialEq, Eq)]
+pub enum PopResult {
+    /// One request was copied into the caller's buffer
+    Item,
+    Empty,
+    /// A producer claimed the next slot but has not published it yet
+    Stalled,
+}
+
+/// View over a mapped ring. Copyable handle; the mapping must outlive it.
+#[derive(Clone, Copy)]
+pub struct MutationRing {
+    base: *mut u8,
+}
+
+// SAFETY: all shared state is accessed through atomics; slot payloads are
+// handed over by the per-slot sequence protocol.
+unsafe impl Send for MutationRing {}
+unsafe impl Sync for MutationRing {}
+
+impl MutationRing {
+    /// Initialize a fresh ring in `mem` (consumer only, before producers map it).
+    ///
+    /// # Safety
+    /// `mem` must be at least `mutation_ring_size()` bytes, 128-byte aligned
+    /// (page-aligned mmap), writable, and not in use by any producer.
+    pub unsafe fn init(mem: *mut u8, len: usize) -> Option<Self> {
+        if mem.is_null() || len < mutation_ring_size() || (mem as usize) % 128 != 0 {
+            return None;
+        }
+        std::ptr::write_bytes(mem, 0, HEADER_SIZE);
+        let ring = Self { base: mem };
+        for pos in 0..MUTATION_RING_CAPACITY {
+            let slot = ring.slot(pos as u64);
+            slot.seq.store(pos as u64, Ordering::Relaxed);
+            slot.len.store(0, Ordering::Relaxed);
+        }
+        let geometry = &mut *(mem as *mut Geometry);
+        geometry.capacity = MUTATION_RING_CAPACITY as u32;
+        geometry.slot_size = MUTATION_RING_SLOT_SIZE as u32;
+        geometry.version = MUTATION_RING_VERSION;
+        fence(Ordering::Release);
+        // Magic last: a producer never sees a half-initialized ring as valid
+        (*(mem as *const AtomicU32)).store(MUTATION_RING_MAGIC, Ordering::Release);
+        Some(ring)
+    }
+
+    /// Attach to an existing ring, validating magic, version and geometry.
+    ///
+    /// # Safety
+    /// `mem` must point to a live shared mapping of at least `len` bytes.
+    pub unsafe fn attach(mem: *mut u8, len: usize) -> Option<Self> {
+        if mem.is_null() || len < mutation_ring_size() || (mem as usize) % 128 != 0 {
+            return None;
+        }
+        if (*(mem as *const AtomicU32)).load(Ordering::Acquire) != MUTATION_RING_MAGIC {
+            return None;
+        }
+        let geometry = &*(mem as *const Geometry);
+        if geometry.version != MUTATION_RING_VERSION
+            || geometry.capacity as usize != MUTATION_RING_CAPACITY
+            || geometry.slot_size as usize != MUTATION_RING_SLOT_SIZE
+        {
+            return None;
+        }
+        Some(Self { base: mem })
+    }
+
+    #[inline(always)]
+    fn header(&self) -> &MutationRingHeader {
+        unsafe { &*(self.base as *const MutationRingHeader) }
+    }
+
+    #[inline(always)]
+    fn slot(&self, pos: u64) -> &SlotHeader {
+        let idx = (pos as usize) & (MUTATION_RING_CAPACITY - 1);
+        unsafe {
+            &*(self.base.add(HEADER_SIZE + idx * MUTATION_RING_SLOT_SIZE) as *const SlotHeader)
+        }
+    }
+
+    #[inline(always)]
+    fn slot_data(&self, pos: u64) -> *mut u8 {
+        let idx = (pos as usize) & (MUTATION_RING_CAPACITY - 1);
+        unsafe {
+            self.base
+                .add(HEADER_SIZE + idx * MUTATION_RING_SLOT_SIZE + SLOT_DATA_OFFSET)
+        }
+    }
+
+    /// Producer: enqueue one pre-serialized request for process `owner`.
+    /// Returns `Ok(true)` if the consumer is parked and must be woken
+    /// (futex wake on `doorbell_addr()`).
+    #[inline]
+    pub fn push(&self, payload: &[u8], owner: u32) -> Result<bool, PushError> {
+        if payload.len() > MUTATION_RING_MAX_PAYLOAD {
+            return Err(PushError::TooLarge);
+        }
+        let span = span_of(payload.len()) as u64;
+        let head = &self.header().head.0;
+        let mut pos = head.load(Ordering::Relaxed);
+        loop {
+            // Slots are freed in order, so the span is free if its first
+            // and last slots are
+            let first = lap(self.slot(pos).seq.load(Ordering::Acquire), pos);
+            let last = lap(
+                self.slot(pos + span - 1).seq.load(Ordering::Acquire),
+                pos + span - 1,
+            );
+            if first == 0 && last == 0 {
+                // CAS: atomically claim the span — only one producer succeeds
+                match head.compare_exchange_weak(
+                    pos,
+                    pos.wrapping_add(span),
+                    Ordering::Relaxed,
+                    Ordering::Relaxed,
+                ) {
+                    Ok(_) => break,
+                    Err(current) => pos = current,
+                }
+            } else if first < 0 || (first == 0 && last < 0) {
+                return Err(PushError::Full);
+            } else {
+                pos = head.load(Ordering::Relaxed);
+            }
+        }
+
+        // Start writing unless the consumer revoked the claim meanwhile
+        let slot = self.slot(pos);
+        slot.owner.store(owner, Ordering::Relaxed);
+        if slot
+            .seq
+            .compare_exchange(pos, pos | WRITING, Ordering::AcqRel, Ordering::Relaxed)
+            .is_err()
+        {
+            return Err(PushError::Revoked);
+        }
+
+        // Safety: we own the span until the first slot is published; the
+        // consumer does not look past an unpublished first slot
+        for (i, chunk) in payload
+            .chunks(MUTATION_RING_SLOT_PAYLOAD)
+            .enumerate()
+            .skip(1)
+        {
+            let at = pos + i as u64;
+            unsafe {
+                std::ptr::copy_nonoverlapping(chunk.as_ptr(), self.slot_data(at), chunk.len());
+            }
+            let cont = self.slot(at);
+            cont.len.store(CONTINUATION, Ordering::Relaxed);
+            cont.seq.store(at + 1, Ordering::Release);
+        }
+        let head_len = payload.len().min(MUTATION_RING_SLOT_PAYLOAD);
+        unsafe {
+            std::ptr::copy_nonoverlapping(payload.as_ptr(), self.slot_data(pos), head_len);
+        }
+        slot.len.store(payload.len() as u32, Ordering::Relaxed);
+        slot.seq.store(pos.wrapping_add(1), Ordering::Release);
+
+        // Dekker pairing with consumer_park(): publish, then check parked
+        fence(Ordering::SeqCst);
+        let bell = &self.header().bell.0;
+        if bell.parked.load(Ordering::Relaxed) != 0 {
+            bell.doorbell.fetch_add(1, Ordering::Release);
+            return Ok(true);
+        }
+        Ok(false)
+    }
+
+    /// Consumer: copy the next request into `out` (cleared first).
+    pub fn pop(&self, out: &mut Vec<u8>) -> PopResult {
+        let tail = &self.header().tail.0;
+        loop {
+            let pos = tail.load(Ordering::Relaxed);
+            let slot = self.slot(pos);
+            let seq = slot.seq.load(Ordering::Acquire);
+            if seq != pos.wrapping_add(1) {
+                let head = self.header().head.0.load(Ordering::Acquire);
+                return if head == pos {
+                    PopResult::Empty
+                } else {
+                    PopResult::Stalled
+                };
+            }
+            let len = slot.len.load(Ordering::Relaxed);
+            if len == CONTINUATION {
+                // Rest of a revoked request: its start is gone, drop it
+                self.release(pos, 1);
+                continue;
+            }
+            let len = (len as usize).min(MUTATION_RING_MAX_PAYLOAD);
+            let span = span_of(len);
+            out.clear();
+            for i in 0..span {
+                let at = pos + i as u64;
+                // Continuations were published before the first slot
+                debug_assert_eq!(self.slot(at).seq.load(Ordering::Acquire), at + 1);
+                let n = (len - i * MUTATION_RING_SLOT_PAYLOAD).min(MUTATION_RING_SLOT_PAYLOAD);
+                out.extend_from_slice(unsafe { std::slice::from_raw_parts(self.slot_data(at), n) });
+            }
+            self.release(pos, span as u64);
+            return PopResult::Item;
+        }
+    }
+
+    /// Free `count` slots from `pos` for the next lap and move the tail past
+    #[inline]
+    fn release(&self, pos: u64, count: u64) {
+        for at in pos..pos + count {
+            self.slot(at).seq.store(
+                at.wrapping_add(MUTATION_RING_CAPACITY as u64),
+                Ordering::Release,
+            );
+        }
+        self.header()
+            .tail
+            .0
+            .store(pos.wrapping_add(count), Ordering::Release);
+    }
+
+    /// Consumer: take back the stalled claim at the tail, so the ring moves
+    /// on. A claim not being written yet is revoked outright (its producer
+    /// sees `PushError::Revoked` and pushes again); one being written only
+    /// if `is_gone(owner)` says its producer process no longer exists.
+    /// Returns false if the slot is not revocable (yet).
+    pub fn revoke_stalled(&self, is_gone: impl FnOnce(u32) -> bool) -> bool {
+        let pos = self.header().tail.0.load(Ordering::Relaxed);
+        if self.header().head.0.load(Ordering::Acquire) == pos {
+            return false;
+        }
+        let slot = self.slot(pos);
+        let freed = pos.wrapping_add(MUTATION_RING_CAPACITY as u64);
+        let seq = slot.seq.load(Ordering::Acquire);
+        let revoked = if seq == pos {
+            slot.seq
+                .compare_exchange(pos, freed, Ordering::AcqRel, Ordering::Relaxed)
+                .is_ok()
+        } else if seq == pos | WRITING && is_gone(slot.owner.load(Ordering::Relaxed)) {
+            slot.seq.store(freed, Ordering::Release);
+            true
+        } else {
+            false
+        };
+        if revoked {
+            self.header()
+                .tail
+                .0
+                .store(pos.wrapping_add(1), Ordering::Release);
+        }
+        revoked
+    }
+
+    /// Consumer: announce intent to sleep. Returns the doorbell value to wait
+    /// on; the caller MUST re-check for items before sleeping.
+    pub fn consumer_park(&self) -> u32 {
+        let bell = &self.header().bell.0;
+        bell.parked.store(1, Ordering::Relaxed);
+        fence(Ordering::SeqCst);
+        bell.doorbell.load(Ordering::Acquire)
+    }
+
+    pub fn consumer_unpark(&self) {
+        self.header().bell.0.parked.store(0, Ordering::Relaxed);
+    }
+
+    /// True if a published item is waiting at the tail
+    pub fn has_ready(&self) -> bool {
+        let pos = self.header().tail.0.load(Ordering::Relaxed);
+        self.slot(pos).seq.load(Ordering::Acquire) == pos.wrapping_add(1)
+    }
+
+    /// Address of the futex word for wait/wake
+    pub fn doorbell_addr(&self) -> *const AtomicU32 {
+        &self.header().bell.0.doorbell
+    }
+
+    /// Items pushed but not yet consumed (approximate)
+    pub fn len(&self) -> usize {
+        let head = self.header().head.0.load(Ordering::Acquire);
+        let tail = self.header().tail.0.load(Ordering::Acquire);
+        head.wrapping_sub(tail) as usize
+    }
+
+    pub fn is_empty(&self) -> bool {
+        self.len() == 0
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    /// 128-byte aligned heap region standing in for the shm mapping
+    struct Region {
+        buf: Vec<Line<[u8; 128]>>,
+    }
+
+    impl Region {
+        fn new() -> Self {
+            let lines = mutation_ring_size().div_ceil(128);
+            let mut buf = Vec::with_capacity(lines);
+            buf.resize_with(lines, || Line([0u8; 128]));
+            Self { buf }
+        }
+
+        fn ptr(&mut self) -> *mut u8 {
+            self.buf.as_mut_ptr() as *mut u8
+        }
+    }
+
+    #[test]
+    fn test_header_layout() {
+        assert_eq!(std::mem::size_of::<MutationRingHeader>(), 512);
+        assert_eq!(MUTATION_RING_SLOT_PAYLOAD, 496);
+    }
+
+    #[test]
+    fn test_attach_requires_init() {
+        let mut region = Region::new();
+        let len = mutation_ring_size();
+        assert!(unsafe { MutationRing::attach(region.ptr(), len) }.is_none());
+        unsafe { MutationRing::init(region.ptr(), len) }.unwrap();
+        assert!(unsafe { MutationRing::attach(region.ptr(), len) }.is_some());
+        assert!(unsafe { MutationRing::attach(region.ptr(), len - 1) }.is_none());
+    }
+
+    #[test]
+    fn test_push_pop_fifo() {
+        let mut region = Region::new();
+        let ring = unsafe { MutationRing::init(region.ptr(), mutation_ring_size()) }.unwrap();
+        let mut out = Vec::new();
+        assert_eq!(ring.pop(&mut out), PopResult::Empty);
+
+        assert_eq!(ring.push(b"first", 1), Ok(false));
+        assert_eq!(ring.push(b"second", 1), Ok(false));
+        assert_eq!(ring.len(), 2);
+
+        assert_eq!(ring.pop(&mut out), PopResult::Item);
+        assert_eq!(out, b"first");
+        assert_eq!(ring.pop(&mut out), PopResult::Item);
+        assert_eq!(out, b"second");
+        assert_eq!(ring.pop(&mut out), PopResult::Empty);
+        assert!(ring.is_empty());
+    }
+
+    #[test]
+    fn test_full_and_wraparound() {
+        let mut region = Region::new();
+        let ring = unsafe { MutationRing::init(region.ptr(), mutation_ring_size()) }.unwrap();
+        let mut out = Vec::new();
+        for lap in 0..3u32 {
+            for i in 0..MUTATION_RING_CAPACITY as u32 {
+                ring.push(&(lap * 100_000 + i).to_le_bytes(), 1).unwrap();
+            }
+            assert_eq!(ring.push(b"x", 1), Err(PushError::Full));
+            for i in 0..MUTATION_RING_CAPACITY as u32 {
+                assert_eq!(ring.pop(&mut out), PopResult::Item);
+                assert_eq!(out, (lap * 100_000 + i).to_le_bytes());
+            }
+        }
+    }
+
+    #[test]
+    fn test_too_large_rejected() {
+        let mut region = Region::new();
+        let ring = unsafe { MutationRing::init(region.ptr(), mutation_ring_size()) }.unwrap();
+        let big = vec![0u8; MUTATION_RING_MAX_PAYLOAD + 1];
+        assert_eq!(ring.push(&big, 1), Err(PushError::TooLarge));
+        assert!(ring.push(&big[..MUTATION_RING_MAX_PAYLOAD], 1).is_ok());
+    }
+
+    #[test]
+    fn test_parked_consumer_requests_wake() {
+        let mut region = Region::new();
+        let ring = unsafe { MutationRing::init(region.ptr(), mutation_ring_size()) }.unwrap();
+        let bell = ring.consumer_park();
+        assert_eq!(ring.push(b"a", 1), Ok(true));
+        // Doorbell moved: a futex wait on the old value returns immediately
+        assert_ne!(
+            unsafe { (*ring.doorbell_addr()).load(Ordering::Acquire) },
+            bell
+        );
+        ring.consumer_unpark();
+        assert_eq!(ring.push(b"b", 1), Ok(false));
+    }
+
+    #[test]
+    fn test_large_requests_span_slots_in_order() {
+        let mut region = Region::new();
+        let ring = unsafe { MutationRing::init(region.ptr(), mutation_ring_size()) }.unwrap();
+        let big: Vec<u8> = (0..MUTATION_RING_SLOT_PAYLOAD * 3 + 7)
+            .map(|i| i as u8)
+            .collect();
+        let exact = vec![9u8; MUTATION_RING_SLOT_PAYLOAD * 2];
+        let mut out = Vec::new();
+        // Several laps, so spans also wrap past the end of the slot array
+        for _ in 0..MUTATION_RING_CAPACITY {
+            ring.push(b"small", 1).unwrap();
+            ring.push(&big, 1).unwrap();
+            ring.push(&exact, 1).unwrap();
+            assert_eq!(ring.len(), 1 + 4 + 2);
+            assert_eq!(ring.pop(&mut out), PopResult::Item);
+            assert_eq!(out, b"small");
+            assert_eq!(ring.pop(&mut out), PopResult::Item);
+            assert_eq!(out, big);
+            assert_eq!(ring.pop(&mut out), PopResult::Item);
+            assert_eq!(out, exact);
+        }
+        assert_eq!(ring.pop(&mut out), PopResult::Empty);
+
+        // A span never overruns the free slots
+        for _ in 0..MUTATION_RING_CAPACITY - 2 {
+            ring.push(b"x", 1).unwrap();
+        }
+        assert_eq!(ring.push(&big, 1), Err(PushError::Full));
+        assert!(ring.push(&exact, 1).is_ok());
+    }
+
+    #[test]
+    fn test_revoke_unwritten_claim() {
+        let mut region = Region::new();
+        let ring = unsafe { MutationRing::init(region.ptr(), mutation_ring_size()) }.unwrap();
+        // A producer claimed a two-slot span and was preempted before writing
+        ring.header().head.0.fetch_add(2, Ordering::Relaxed);
+        ring.push(b"next", 1).unwrap();
+        let mut out = Vec::new();
+        assert_eq!(ring.pop(&mut out), PopResult::Stalled);
+
+        assert!(ring.revoke_stalled(|_| panic!("not being written")));
+        assert_eq!(ring.pop(&mut out), PopResult::Stalled);
+        assert!(ring.revoke_stalled(|_| false));
+        assert_eq!(ring.pop(&mut out), PopResult::Item);
+        assert_eq!(out, b"next");
+
+        // The late producer loses its claim instead of writing a reused slot
+        let slot = ring.slot(0);
+        assert!(slot
+            .seq
+            .compare_exchange(0, WRITING, Ordering::AcqRel, Ordering::Relaxed)
+            .is_err());
+        assert_eq!(ring.pop(&mut out), PopResult::Empty);
+    }
+
+    #[test]
+    fn test_revoke_writing_claim_only_once_owner_is_gone() {
+        let mut region = Region::new();
+        let ring = unsafe { MutationRing::init(region.ptr(), mutation_ring_size()) }.unwrap();
+        // The owner died mid-span: first slot writing, one continuation out
+        ring.header().head.0.fetch_add(2, Ordering::Relaxed);
+        ring.slot(0).owner.store(42, Ordering::Relaxed);
+        ring.slot(0).seq.store(WRITING, Ordering::Release);
+        ring.slot(1).len.store(CONTINUATION, Ordering::Relaxed);
+        ring.slot(1).seq.store(2, Ordering::Release);
+        ring.push(b"after", 7).unwrap();
+
+        let mut out = Vec::new();
+        assert_eq!(ring.pop(&mut out), PopResult::Stalled);
+        assert!(!ring.revoke_stalled(|owner| owner != 42));
+        assert!(ring.revoke_stalled(|owner| owner == 42));
+        // The orphaned continuation is dropped, not delivered
+        assert_eq!(ring.pop(&mut out), PopResult::Item);
+        assert_eq!(out, b"after");
+        assert_eq!(ring.pop(&mut out), PopResult::Empty);
+    }
+
+    #[test]
+    fn test_concurrent_producers() {
+        use std::sync::atomic::AtomicUsize;
+        use std::sync::Arc;
+
+        let mut region = Region::new();
+        let ring = unsafe { MutationRing::init(region.ptr(), mutation_ring_size()) }.unwrap();
+        const PER_THREAD: u32 = 20_000;
+        let done = Arc::new(AtomicUsize::new(0));
+
+        let producers: Vec<_> = (0..4u32)
+            .map(|t| {
+                let done = Arc::clone(&done);
+                std::thread::spawn(move || {
+                    for i in 0..PER_THREAD {
+                        // Every 7th request spans several slots
+                        let mut msg = (t << 24 | i).to_le_bytes().to_vec();
+                        if i % 7 == 0 {
+                            msg.resize(MUTATION_RING_SLOT_PAYLOAD * 2 + 1, t as u8);
+                        }
+                        while ring.push(&msg, 1).is_err() {
+                            std::hint::spin_loop();
+                        }
+                    }
+                    done.fetch_add(1, Ordering::Release);
+                })
+            })
+            .collect();
+
+        // Per-producer order must be preserved
+        let mut next = [0u32; 4];
+        let mut out = Vec::new();
+        let mut received = 0;
+        while received < 4 * PER_THREAD {
+            match ring.pop(&mut out) {
+                PopResult::Item => {
+                    let v = u32::from_le_bytes(out[..4].try_into().unwrap());
+                    let (t, i) = ((v >> 24) as usize, v & 0xFF_FFFF);
+                    assert_eq!(i, next[t]);
+                    if i % 7 == 0 {
+                        assert_eq!(out.len(), MUTATION_RING_SLOT_PAYLOAD * 2 + 1);
+                        assert!(out[4..].iter().all(|&b| b == t as u8));
+                    }
+                    next[t] += 1;
+                    received += 1;
+                }
+                _ => std::hint::spin_loop(),
+            }
+        }
+        for p in producers {
+            p.join().unwrap();
+        }
+        assert_eq!(done.load(Ordering::Acquire), 4);
+        assert!(ring.is_empty());
+    }
+}
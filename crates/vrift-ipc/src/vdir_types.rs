@@ -2,16 +2,53 @@
 //!
 //! These types define the on-disk/mmap layout of the VDir hash table.
 //! Any field changes here MUST maintain `#[repr(C)]` ABI stability.
+//!
+//! Layout (Swiss-table style, one or two table regions):
+//! ```text
+//! [ VDirHeader 64B ][ region: tags 1B x cap | pad to 64B | VDirEntry 72B x cap ] ...
+//! ```
+//! Probing scans the dense tag array 16 slots at a time (SSE2 / NEON), and
+//! only touches a 72-byte entry when its 7-bit tag matches. Entries carry a
+//! secondary 32-bit path hash so 64-bit FNV-1a collisions are detected.
+//!
+//! Resize is incremental (v4): vDird appends a table of twice the capacity
+//! at the end of the file, publishes it as the live table and keeps the old
+//! one in the header while entries migrate in bounded chunks. Readers probe
+//! the live table, then the old one, so they never see a half-built table.
+//! The file only grows; clients map `VDIR_MAP_RESERVE` bytes up front so a
+//! table appended past their original EOF is already inside their mapping.
+//!
+//! Directory listings (v5) live in a separate region: a hash table of
+//! directories, each pointing at a name-sorted run of children in a shared
+//! name arena. Readers iterate it under the same seqlock generation, so
+//! readdir needs no IPC and no deserialization. vDird rebuilds the whole
+//! region off to the side and publishes it by swapping `dirs_offset`.
+//!
+//! The same region carries a split-block bloom filter of every manifest key.
+//! A key that misses both the VDir tables and the filter cannot exist, so
+//! clients answer those probes (header search paths, extension guessing,
+//! `node_modules` walk-ups) without an IPC round trip.
 
 /// VDir magic number: "VRFT" in little-endian
 pub const VDIR_MAGIC: u32 = 0x56524654;
 
 /// VDir format version. Bump on incompatible changes.
-pub const VDIR_VERSION: u32 = 2; // v2: Added CRC32 checksum
+pub const VDIR_VERSION: u32 = 5; // v5: Directory listing index (dirs_offset)
 
-/// Default hash table capacity (slots)
+/// Default hash table capacity (slots, power of 2, multiple of VDIR_GROUP_WIDTH)
 pub const VDIR_DEFAULT_CAPACITY: usize = 65536;
 
+/// Slots per probe group (one 16-byte SIMD load of tags)
+pub const VDIR_GROUP_WIDTH: usize = 16;
+
+/// Tag byte of a never-written slot
+pub const VDIR_TAG_EMPTY: u8 = 0;
+
+/// Address space readers reserve for the VDir mapping. Table offsets are
+/// u32, so 4 GiB covers any VDir; pages past EOF are never touched because
+/// lookups are bounded by `VDirHeader::file_size`.
+pub const VDIR_MAP_RESERVE: usize = if usize::BITS >= 64 { 1 << 32 } else { 64 << 20 };
+
 /// Compile-time entry size (for offset calculations)
 pub const VDIR_ENTRY_SIZE: usize = std::mem::size_of::<VDirEntry>();
 
@@ -48,7 +85,13 @@ pub const FLAG_DIR: u16 = 0x0008;
 /// 20      table_capacity    4
 /// 24      table_offset      4
 /// 28      crc32             4
-/// 32      _pad             32
+/// 32      tags_offset       4    (tag array, 1 byte per slot)
+/// 36      old_capacity      4    (0 = no resize in progress)
+/// 40      old_tags_offset   4
+/// 44      old_table_offset  4
+/// 48      migrate_cursor    4    (old slots below this are migrated)
+/// 52      dirs_offset       4    (directory index region, 0 = none)
+/// 56      file_size         8    (bytes of the file in use by tables)
 /// ```
 #[repr(C)]
 #[derive(Debug, Clone, Copy)]
@@ -59,8 +102,14 @@ pub struct VDirHeader {
     pub entry_count: u32,
     pub table_capacity: u32,
     pub table_offset: u32,
-    pub crc32: u32,     // CRC32 checksum of header (fields before crc32)
-    pub _pad: [u8; 32], // Pad to 64 bytes
+    pub crc32: u32,       // CRC32 checksum of header (fields before crc32)
+    pub tags_offset: u32, // Offset of the tag array
+    pub old_capacity: u32,
+    pub old_tags_offset: u32,
+    pub old_table_offset: u32,
+    pub migrate_cursor: u32,
+    pub dirs_offset: u32, // VDirDirsHeader of the published directory index
+    pub file_size: u64,
 }
 
 // Compile-time assertion: VDirHeader must be exactly 64 bytes
@@ -70,7 +119,7 @@ const _: () = assert!(std::mem::size_of::<VDirHeader>() == 64);
 // VDirEntry — 72 bytes per slot in the hash table
 // ---------------------------------------------------------------------------
 
-/// Single VDir entry in the hash table (open addressing, linear probing).
+/// Single VDir entry in the hash table (open addressing, group probing).
 ///
 /// Layout (72 bytes total):
 /// ```text
@@ -83,7 +132,8 @@ const _: () = assert!(std::mem::size_of::<VDirHeader>() == 64);
 /// 56      mtime_nsec     4
 /// 60      mode           4
 /// 64      flags          2
-/// 66      _pad           6
+/// 66      _pad           2
+/// 68      path_check     4   (secondary path hash, 0 = unknown)
 /// ```
 #[repr(C)]
 #[derive(Debug, Clone, Copy, Default)]
@@ -95,7 +145,8 @@ pub struct VDirEntry {
     pub mtime_nsec: u32,
     pub mode: u32,
     pub flags: u16, // FLAG_DIRTY | FLAG_DELETED | FLAG_SYMLINK | FLAG_DIR
-    pub _pad: [u16; 3],
+    pub _pad: u16,
+    pub path_check: u32, // vdir_path_check(path); 0 = written by hash only
 }
 
 // Compile-time assertion: VDirEntry must be exactly 72 bytes
@@ -132,3 +183,1047 @@ impl VDirEntry {
         (self.flags & FLAG_SYMLINK) != 0
     }
 }
+
+// ---------------------------------------------------------------------------
+// Keys and hashing
+// ---------------------------------------------------------------------------
+
+/// Secondary path hash stored in `VDirEntry::path_check`.
+///
+/// Independent of FNV-1a (multiply-rotate + murmur3 finalizer), so a 64-bit
+/// `path_hash` collision is caught instead of returning the wrong file.
+/// Never returns 0 (reserved for "unknown").
+#[inline]
+pub fn vdir_path_check(path: &str) -> u32 {
+    let mut h: u32 = 0x9E37_79B9 ^ path.len() as u32;
+    for &b in path.as_bytes() {
+        h = (h ^ b as u32).wrapping_mul(0x85EB_CA6B).rotate_left(13);
+    }
+    h ^= h >> 16;
+    h = h.wrapping_mul(0x85EB_CA6B);
+    h ^= h >> 13;
+    h = h.wrapping_mul(0xC2B2_AE35);
+    h ^= h >> 16;
+    if h == 0 {
+        1
+    } else {
+        h
+    }
+}
+
+/// Lookup key: primary FNV-1a hash plus the secondary check (0 = match any).
+#[derive(Debug, Clone, Copy, PartialEq, Eq)]
+pub struct VDirKey {
+    pub path_hash: u64,
+    pub path_check: u32,
+}
+
+impl VDirKey {
+    #[inline]
+    pub fn from_path(path: &str) -> Self {
+        Self {
+            path_hash: crate::fnv1a_hash(path),
+            path_check: vdir_path_check(path),
+        }
+    }
+
+    #[inline]
+    pub fn of_entry(entry: &VDirEntry) -> Self {
+        Self {
+            path_hash: entry.path_hash,
+            path_check: entry.path_check,
+        }
+    }
+
+    /// True if `entry` holds this key. An unknown (0) check on either side
+    /// falls back to the 64-bit hash alone.
+    #[inline(always)]
+    pub fn matches(&self, entry: &VDirEntry) -> bool {
+        entry.path_hash == self.path_hash
+            && (self.path_check == 0
+                || entry.path_check == 0
+                || entry.path_check == self.path_check)
+    }
+}
+
+/// Hash-only key (tests and callers without the path)
+impl From<u64> for VDirKey {
+    fn from(path_hash: u64) -> Self {
+        Self {
+            path_hash,
+            path_check: 0,
+        }
+    }
+}
+
+/// Tag byte for a full slot: high bit set + top 7 bits of the hash
+/// (the low bits already chose the group).
+#[inline(always)]
+pub fn vdir_tag(path_hash: u64) -> u8 {
+    0x80 | (path_hash >> 57) as u8
+}
+
+// ---------------------------------------------------------------------------
+// Geometry
+// ---------------------------------------------------------------------------
+
+/// True if `capacity` is usable for group probing
+#[inline(always)]
+pub fn vdir_capacity_valid(capacity: usize) -> bool {
+    capacity >= VDIR_GROUP_WIDTH && capacity.is_power_of_two()
+}
+
+/// Tag array offset of the initial table (right after the header)
+pub const VDIR_TAGS_OFFSET: usize = VDIR_HEADER_SIZE;
+
+/// Entry array offset for `capacity` slots (64-byte aligned after the tags)
+#[inline]
+pub const fn vdir_table_offset(capacity: usize) -> usize {
+    (VDIR_TAGS_OFFSET + capacity + 63) & !63
+}
+
+/// Bytes of one table region (tags + padding + entries)
+#[inline]
+pub const fn vdir_region_size(capacity: usize) -> usize {
+    ((capacity + 63) & !63) + capacity * VDIR_ENTRY_SIZE
+}
+
+/// Total file size for a fresh VDir of `capacity` slots
+#[inline]
+pub const fn vdir_file_size(capacity: usize) -> usize {
+    VDIR_HEADER_SIZE + vdir_region_size(capacity)
+}
+
+/// One hash table region inside the VDir file
+#[derive(Debug, Clone, Copy, PartialEq, Eq)]
+pub struct VDirTable {
+    pub tags_offset: usize,
+    pub table_offset: usize,
+    pub capacity: usize,
+}
+
+impl VDirTable {
+    /// Table region starting at `offset` (64-byte aligned)
+    #[inline]
+    pub const fn at(offset: usize, capacity: usize) -> Self {
+        Self {
+            tags_offset: offset,
+            table_offset: offset + ((capacity + 63) & !63),
+            capacity,
+        }
+    }
+
+    /// The table new entries go to
+    #[inline(always)]
+    pub fn live(header: &VDirHeader) -> Self {
+        Self {
+            tags_offset: header.tags_offset as usize,
+            table_offset: header.table_offset as usize,
+            capacity: header.table_capacity as usize,
+        }
+    }
+
+    /// The table being migrated away from, if a resize is in progress
+    #[inline(always)]
+    pub fn old(header: &VDirHeader) -> Option<Self> {
+        if header.old_capacity == 0 {
+            return None;
+        }
+        Some(Self {
+            tags_offset: header.old_tags_offset as usize,
+            table_offset: header.old_table_offset as usize,
+            capacity: header.old_capacity as usize,
+        })
+    }
+
+    /// End offset of the region
+    #[inline(always)]
+    pub fn end(&self) -> usize {
+        (self.tags_offset + self.capacity).max(self.table_offset + self.capacity * VDIR_ENTRY_SIZE)
+    }
+
+    /// Valid geometry lying entirely within the first `len` bytes
+    #[inline(always)]
+    pub fn fits(&self, len: usize) -> bool {
+        vdir_capacity_valid(self.capacity) && self.end() <= len
+    }
+
+    /// Probe this table for `key`.
+    ///
+    /// # Safety
+    /// `base` must map at least `self.end()` bytes (check `fits`).
+    #[inline(always)]
+    pub unsafe fn probe(&self, base: *const u8, key: VDirKey) -> VDirProbe {
+        vdir_probe(
+            base.add(self.tags_offset),
+            self.entry(base, 0),
+            self.capacity,
+            key,
+        )
+    }
+
+    /// Pointer to the entry in `slot`.
+    ///
+    /// # Safety
+    /// Same as `probe`; `slot < capacity`.
+    #[inline(always)]
+    pub unsafe fn entry(&self, base: *const u8, slot: usize) -> *const VDirEntry {
+        base.add(self.table_offset + slot * VDIR_ENTRY_SIZE) as *const VDirEntry
+    }
+}
+
+/// Bytes of a `len`-byte mapping that belong to the VDir (`file_size`).
+#[inline(always)]
+fn vdir_bound(header: &VDirHeader, len: usize) -> usize {
+    match header.file_size as usize {
+        0 => len,
+        used => used.min(len),
+    }
+}
+
+/// Find `key` in a mapped VDir: live table first, then the old table while
+/// a resize is migrating. Tables outside `min(len, file_size)` are skipped.
+/// ZERO ALLOCATIONS, ZERO SYSCALLS. Callers provide seqlock consistency.
+///
+/// # Safety
+/// `base` must map `len` readable bytes starting with a VDirHeader.
+#[inline(always)]
+pub unsafe fn vdir_find(base: *const u8, len: usize, key: VDirKey) -> Option<*const VDirEntry> {
+    if len < VDIR_HEADER_SIZE {
+        return None;
+    }
+    let header = &*(base as *const VDirHeader);
+    let bound = vdir_bound(header, len);
+
+    let live = VDirTable::live(header);
+    if live.fits(bound) {
+        if let VDirProbe::Found(slot) = live.probe(base, key) {
+            return Some(live.entry(base, slot));
+        }
+    }
+    let old = VDirTable::old(header)?;
+    if old.fits(bound) {
+        if let VDirProbe::Found(slot) = old.probe(base, key) {
+            return Some(old.entry(base, slot));
+        }
+    }
+    None
+}
+
+// ---------------------------------------------------------------------------
+// Directory index — name arena + per-directory child runs (readdir)
+// ---------------------------------------------------------------------------
+
+/// Directory index is out of date; readers fall back to IPC
+pub const VDIR_DIRS_STALE: u32 = 0x0001;
+
+/// `VDirChild::kind` bit: child is a directory
+pub const VDIR_CHILD_DIR: u8 = 0x01;
+
+/// Longest child name served from the index (NAME_MAX)
+pub const VDIR_NAME_MAX: usize = 255;
+
+/// Compile-time directory index header size
+pub const VDIR_DIRS_HEADER_SIZE: usize = std::mem::size_of::<VDirDirsHeader>();
+
+/// Directory index region header, at `VDirHeader::dirs_offset`.
+///
+/// Region layout (64-byte aligned, offsets relative to the region):
+/// ```text
+/// [ VDirDirsHeader 64B ][ VDirDirSlot 24B x dir_capacity ][ VDirChild 8B x child_count ][ names ]
+/// [ pad to 32B ][ filter: 32B block x filter_blocks ]
+/// ```
+/// Directory slots are an open-addressing table keyed by the directory's
+/// `VDirKey` (linear probing, `dir_check == 0` = empty). Each slot owns
+/// `child_count` consecutive children sorted by name bytes. The filter is
+/// optional (`filter_blocks == 0`); see `vdir_filter_insert`.
+#[repr(C)]
+#[derive(Debug, Clone, Copy, Default)]
+pub struct VDirDirsHeader {
+    pub region_size: u32, // Bytes reserved for this region (>= used size)
+    pub dir_capacity: u32,
+    pub dir_count: u32,
+    pub child_count: u32,
+    pub names_len: u32,
+    pub flags: u32,        // VDIR_DIRS_STALE
+    pub spare_offset: u32, // Writer's other buffer, rebuilt into next (0 = none)
+    pub spare_size: u32,
+    pub revision: u64,      // Manifest revision the index was built from
+    pub filter_offset: u32, // Negative-lookup filter (32-byte aligned, 0 = none)
+    pub filter_blocks: u32,
+    pub _reserved: [u8; 16],
+}
+
+const _: () = assert!(std::mem::size_of::<VDirDirsHeader>() == 64);
+
+/// One directory in the index
+#[repr(C)]
+#[derive(Debug, Clone, Copy, Default)]
+pub struct VDirDirSlot {
+    pub dir_hash: u64,
+    pub dir_check: u32, // vdir_path_check(dir); 0 = empty slot
+    pub child_start: u32,
+    pub child_count: u32,
+    pub _pad: u32,
+}
+
+const _: () = assert!(std::mem::size_of::<VDirDirSlot>() == 24);
+
+/// One directory child: a name in the arena plus its kind
+#[repr(C)]
+#[derive(Debug, Clone, Copy, Default)]
+pub struct VDirChild {
+    pub name_offset: u32,
+    pub name_len: u16,
+    pub kind: u8, // VDIR_CHILD_DIR
+    pub _pad: u8,
+}
+
+const _: () = assert!(std::mem::size_of::<VDirChild>() == 8);
+
+impl VDirDirsHeader {
+    /// Offset of the directory slots
+    #[inline(always)]
+    pub const fn slots_offset() -> usize {
+        VDIR_DIRS_HEADER_SIZE
+    }
+
+    /// Offset of the child array
+    #[inline(always)]
+    pub fn children_offset(&self) -> usize {
+        Self::slots_offset() + self.dir_capacity as usize * std::mem::size_of::<VDirDirSlot>()
+    }
+
+    /// Offset of the name arena
+    #[inline(always)]
+    pub fn names_offset(&self) -> usize {
+        self.children_offset() + self.child_count as usize * std::mem::size_of::<VDirChild>()
+    }
+
+    /// Offset the filter is placed at, after the name arena
+    #[inline(always)]
+    pub fn filter_offset_after_names(&self) -> usize {
+        (self.names_offset() + self.names_len as usize).next_multiple_of(VDIR_FILTER_BLOCK)
+    }
+
+    /// Bytes of the region in use
+    #[inline(always)]
+    pub fn used_size(&self) -> usize {
+        let names_end = self.names_offset() + self.names_len as usize;
+        match self.filter_blocks {
+            0 => names_end,
+            blocks => {
+                names_end.max(self.filter_offset as usize + blocks as usize * VDIR_FILTER_BLOCK)
+            }
+        }
+    }
+}
+
+// ---------------------------------------------------------------------------
+// Negative-lookup filter — split-block bloom over manifest keys
+// ---------------------------------------------------------------------------
+
+/// Bytes per filter block: eight 32-bit words, one bit set in each per key,
+/// so a query touches a single cache line
+pub const VDIR_FILTER_BLOCK: usize = 32;
+
+/// Filter bits per manifest key (~0.2% false positives)
+pub const VDIR_FILTER_BITS_PER_KEY: usize = 16;
+
+/// Per-word multipliers (the Parquet split-block bloom salts)
+const VDIR_FILTER_SALT: [u32; 8] = [
+    0x47b6137b, 0x44974d91, 0x8824ad5b, 0xa2b7289d, 0x705495c7, 0x2df1424b, 0x9efc4947, 0x5c6bfb31,
+];
+
+/// Filter blocks for `keys` manifest keys
+#[inline]
+pub fn vdir_filter_blocks(keys: usize) -> usize {
+    (keys * VDIR_FILTER_BITS_PER_KEY)
+        .div_ceil(VDIR_FILTER_BLOCK * 8)
+        .max(1)
+}
+
+/// (block index, per-word bit masks) of `key` in a filter of `blocks` blocks
+#[inline(always)]
+fn vdir_filter_probe(key: VDirKey, blocks: usize) -> (usize, [u32; 8]) {
+    // Mix both path hashes: the high half picks the block, the low half the bits
+    let h = (key.path_hash ^ ((key.path_check as u64) << 32)).wrapping_mul(0x9E37_79B9_7F4A_7C15);
+    let h = h ^ (h >> 29);
+    let block = (((h >> 32) * blocks as u64) >> 32) as usize;
+    let low = h as u32;
+    let mut masks = [0u32; 8];
+    for (mask, salt) in masks.iter_mut().zip(VDIR_FILTER_SALT) {
+        *mask = 1 << (low.wrapping_mul(salt) >> 27);
+    }
+    (block, masks)
+}
+
+/// Add `key` to a filter of `filter.len() / 8` blocks (writer side)
+pub fn vdir_filter_insert(filter: &mut [u32], key: VDirKey) {
+    let (block, masks) = vdir_filter_probe(key, filter.len() / 8);
+    for (word, mask) in filter[block * 8..block * 8 + 8].iter_mut().zip(masks) {
+        *word |= mask;
+    }
+}
+
+/// Directory key used by the index: trailing slashes stripped, "/" for root.
+/// Matches `vdir_parent` so `vdir_parent(p).0` is always a valid key.
+#[inline]
+pub fn vdir_dir_key(path: &str) -> &str {
+    let trimmed = path.trim_end_matches('/');
+    if trimmed.is_empty() && path.starts_with('/') {
+        "/"
+    } else {
+        trimmed
+    }
+}
+
+/// Split a manifest path into (parent directory key, name)
+#[inline]
+pub fn vdir_parent(path: &str) -> (&str, &str) {
+    match path.rfind('/') {
+        Some(0) => ("/", &path[1..]),
+        Some(i) => (&path[..i], &path[i + 1..]),
+        None => ("", path),
+    }
+}
+
+/// Published directory index of a mapped VDir.
+/// Every offset is validated against the region and the mapping, so a view
+/// taken while vDird rewrites the region reads garbage at worst — never
+/// out of bounds. Callers discard such reads via the seqlock.
+#[derive(Debug, Clone, Copy)]
+pub struct VDirDirs {
+    base: *const u8,
+    slots: usize,
+    dir_capacity: usize,
+    children: usize,
+    child_count: usize,
+    names: usize,
+    names_len: usize,
+    filter: usize,
+    filter_blocks: usize,
+    pub revision: u64,
+}
+
+/// Children of one directory in the index
+#[derive(Debug, Clone, Copy)]
+pub struct VDirDirList {
+    dirs: VDirDirs,
+    start: usize,
+    count: usize,
+}
+
+impl VDirDirs {
+    /// Directory index of a mapped VDir, if one is published and fresh.
+    ///
+    /// # Safety
+    /// `base` must map `len` readable bytes starting with a VDirHeader.
+    #[inline]
+    pub unsafe fn open(base: *const u8, len: usize) -> Option<Self> {
+        if len < VDIR_HEADER_SIZE {
+            return None;
+        }
+        let header = &*(base as *const VDirHeader);
+        let bound = vdir_bound(header, len);
+        let offset = header.dirs_offset as usize;
+        if offset == 0 || !offset.is_multiple_of(8) || offset + VDIR_DIRS_HEADER_SIZE > bound {
+            return None;
+        }
+
+        let dirs = &*(base.add(offset) as *const VDirDirsHeader);
+        let dir_capacity = dirs.dir_capacity as usize;
+        if dirs.flags & VDIR_DIRS_STALE != 0 || !dir_capacity.is_power_of_two() {
+            return None;
+        }
+        // Validate in u64 so garbage counts cannot wrap on 32-bit targets
+        let used = VDIR_DIRS_HEADER_SIZE as u64
+            + dir_capacity as u64 * std::mem::size_of::<VDirDirSlot>() as u64
+            + dirs.child_count as u64 * std::mem::size_of::<VDirChild>() as u64
+            + dirs.names_len as u64;
+        if used > dirs.region_size as u64 || offset as u64 + used > bound as u64 {
+            return None;
+        }
+        let filter = offset + dirs.filter_offset as usize;
+        let filter_blocks = dirs.filter_blocks as usize;
+        if filter_blocks != 0 {
+            let end = dirs.filter_offset as u64 + filter_blocks as u64 * VDIR_FILTER_BLOCK as u64;
+            if !filter.is_multiple_of(4)
+                || dirs.filter_offset == 0
+                || end > dirs.region_size as u64
+                || offset as u64 + end > bound as u64
+            {
+                return None;
+            }
+        }
+
+        Some(Self {
+            base,
+            slots: offset + VDirDirsHeader::slots_offset(),
+            dir_capacity,
+            children: offset + dirs.children_offset(),
+            child_count: dirs.child_count as usize,
+            names: offset + dirs.names_offset(),
+            names_len: dirs.names_len as usize,
+            filter,
+            filter_blocks,
+            revision: dirs.revision,
+        })
+    }
+
+    /// Negative lookup: `Some(false)` means `key` is not in the manifest the
+    /// index was built from. None when no filter is published.
+    /// ZERO ALLOCATIONS, ZERO SYSCALLS.
+    ///
+    /// # Safety
+    /// The mapping `open` was called on must still be mapped.
+    #[inline]
+    pub unsafe fn may_contain(&self, key: VDirKey) -> Option<bool> {
+        if self.filter_blocks == 0 {
+            return None;
+        }
+        let (block, masks) = vdir_filter_probe(key, self.filter_blocks);
+        let words = self.base.add(self.filter + block * VDIR_FILTER_BLOCK) as *const u32;
+        let mut hit = true;
+        for (i, mask) in masks.into_iter().enumerate() {
+            hit &= *words.add(i) & mask != 0;
+        }
+        Some(hit)
+    }
+
+    /// Children of the directory `key` (see `vdir_dir_key`).
+    /// ZERO ALLOCATIONS, ZERO SYSCALLS.
+    ///
+    /// # Safety
+    /// The mapping `open` was called on must still be mapped.
+    #[inline]
+    pub unsafe fn find(&self, key: VDirKey) -> Option<VDirDirList> {
+        let mask = self.dir_capacity - 1;
+        let mut slot = key.path_hash as usize & mask;
+        for _ in 0..self.dir_capacity {
+            let dir = &*(self
+                .base
+                .add(self.slots + slot * std::mem::size_of::<VDirDirSlot>())
+                as *const VDirDirSlot);
+            if dir.dir_check == 0 {
+                return None;
+            }
+            if dir.dir_hash == key.path_hash && dir.dir_check == key.path_check {
+                let start = dir.child_start as usize;
+                let count = dir.child_count as usize;
+                if start + count > self.child_count {
+                    return None;
+                }
+                return Some(VDirDirList {
+                    dirs: *self,
+                    start,
+                    count,
+                });
+            }
+            slot = (slot + 1) & mask;
+        }
+        None
+    }
+}
+
+impl VDirDirList {
+    #[inline(always)]
+    pub fn len(&self) -> usize {
+        self.count
+    }
+
+    #[inline(always)]
+    pub fn is_empty(&self) -> bool {
+        self.count == 0
+    }
+
+    /// Child `index` as (name, kind). None if out of range or malformed.
+    ///
+    /// # Safety
+    /// Same as `VDirDirs::find`. The name borrows the mapping: copy it out
+    /// before validating the seqlock.
+    #[inline]
+    pub unsafe fn get(&self, index: usize) -> Option<(&[u8], u8)> {
+        if index >= self.count {
+            return None;
+        }
+        let d = &self.dirs;
+        let child = &*(d
+            .base
+            .add(d.children + (self.start + index) * std::mem::size_of::<VDirChild>())
+            as *const VDirChild);
+        let offset = child.name_offset as usize;
+        let len = child.name_len as usize;
+        if offset + len > d.names_len {
+            return None;
+        }
+        let name = std::slice::from_raw_parts(d.base.add(d.names + offset), len);
+        Some((name, child.kind))
+    }
+
+    /// Index of the first child whose name sorts after `name` (resumes an
+    /// iteration across index rebuilds).
+    ///
+    /// # Safety
+    /// Same as `get`.
+    pub unsafe fn seek_after(&self, name: &[u8]) -> usize {
+        let (mut lo, mut hi) = (0, self.count);
+        while lo < hi {
+            let mid = (lo + hi) / 2;
+            match self.get(mid) {
+                Some((child, _)) if child <= name => lo = mid + 1,
+                Some(_) => hi = mid,
+                None => return self.count, // Torn read: the seqlock retries
+            }
+        }
+        lo
+    }
+}
+
+// ---------------------------------------------------------------------------
+// Group probing — shared by vDird (writer) and InceptionLayer (reader)
+// ---------------------------------------------------------------------------
+
+/// Bitmask of matching lanes in one group. Lanes are `1 << LANE_SHIFT` bits
+/// wide so the NEON path can skip the movemask emulation.
+#[derive(Clone, Copy)]
+pub struct GroupMask(u64);
+
+#[cfg(target_arch = "aarch64")]
+const LANE_SHIFT: u32 = 2;
+#[cfg(not(target_arch = "aarch64"))]
+const LANE_SHIFT: u32 = 0;
+
+impl GroupMask {
+    #[inline(always)]
+    pub fn any(self) -> bool {
+        self.0 != 0
+    }
+}
+
+impl Iterator for GroupMask {
+    type Item = usize;
+
+    #[inline(always)]
+    fn next(&mut self) -> Option<usize> {
+        if self.0 == 0 {
+            return None;
+        }
+        let lane = (self.0.trailing_zeros() >> LANE_SHIFT) as usize;
+        self.0 &= self.0 - 1;
+        Some(lane)
+    }
+}
+
+/// Lanes of the 16 tags at `tags` equal to `tag`.
+///
+/// # Safety
+/// `tags` must be valid for a 16-byte read.
+#[inline(always)]
+pub unsafe fn group_match(tags: *const u8, tag: u8) -> GroupMask {
+    #[cfg(target_arch = "x86_64")]
+    {
+        use core::arch::x86_64::*;
+        // SSE2 is part of the x86_64 baseline
+        let group = _mm_loadu_si128(tags as *const __m128i);
+        let cmp = _mm_cmpeq_epi8(group, _mm_set1_epi8(tag as i8));
+        GroupMask(_mm_movemask_epi8(cmp) as u16 as u64)
+    }
+    #[cfg(target_arch = "aarch64")]
+    {
+        use core::arch::aarch64::*;
+        let group = vld1q_u8(tags);
+        let cmp = vceqq_u8(group, vdupq_n_u8(tag));
+        // Narrow each 0xFF/0x00 byte to a nibble, keep one bit per lane
+        let nibbles = vshrn_n_u16::<4>(vreinterpretq_u16_u8(cmp));
+        GroupMask(vget_lane_u64::<0>(vreinterpret_u64_u8(nibbles)) & 0x1111_1111_1111_1111)
+    }
+    #[cfg(not(any(target_arch = "x86_64", target_arch = "aarch64")))]
+    {
+        let mut mask = 0u64;
+        for lane in 0..VDIR_GROUP_WIDTH {
+            if *tags.add(lane) == tag {
+                mask |= 1 << lane;
+            }
+        }
+        GroupMask(mask)
+    }
+}
+
+/// Result of probing for a key
+#[derive(Debug, Clone, Copy, PartialEq, Eq)]
+pub enum VDirProbe {
+    /// Slot holding the key
+    Found(usize),
+    /// Key absent; first empty slot on its probe sequence (insert here)
+    Vacant(usize),
+    /// Every group visited without a match or an empty slot
+    Full,
+}
+
+/// Probe the table for `key`. ZERO ALLOCATIONS, ZERO SYSCALLS.
+///
+/// Group sequence is triangular (g, g+1, g+3, g+6, ...) over a power-of-2
+/// group count, which visits every group exactly once. Entries are never
+/// removed (deletes are FLAG_DELETED), so an empty lane ends the search.
+///
+/// # Safety
+/// `tags` must be valid for `capacity` bytes and `entries` for `capacity`
+/// entries; `vdir_capacity_valid(capacity)` must hold.
+#[inline(always)]
+pub unsafe fn vdir_probe(
+    tags: *const u8,
+    entries: *const VDirEntry,
+    capacity: usize,
+    key: VDirKey,
+) -> VDirProbe {
+    let group_mask = capacity / VDIR_GROUP_WIDTH - 1;
+    let tag = vdir_tag(key.path_hash);
+    let mut group = (key.path_hash as usize) & group_mask;
+
+    for stride in 0..=group_mask {
+        let base = group * VDIR_GROUP_WIDTH;
+        let group_tags = tags.add(base);
+        for lane in group_match(group_tags, tag) {
+            let slot = base + lane;
+            if key.matches(&*entries.add(slot)) {
+                return VDirProbe::Found(slot);
+            }
+        }
+        if let Some(lane) = group_match(group_tags, VDIR_TAG_EMPTY).next() {
+            return VDirProbe::Vacant(base + lane);
+        }
+        group = (group + stride + 1) & group_mask;
+    }
+    VDirProbe::Full
+}
+
+/// Number of groups visited before reaching `slot` from the key's home
+/// group (1 = found in its home group). For statistics only.
+pub fn vdir_probe_distance(path_hash: u64, slot: usize, capacity: usize) -> usize {
+    let group_mask = capacity / VDIR_GROUP_WIDTH - 1;
+    let target = slot / VDIR_GROUP_WIDTH;
+    let mut group = (path_hash as usize) & group_mask;
+    for stride in 0..=group_mask {
+        if group == target {
+            return stride + 1;
+        }
+        group = (group + stride + 1) & group_mask;
+    }
+    group_mask + 1
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    fn table(capacity: usize) -> (Vec<u8>, Vec<VDirEntry>) {
+        (vec![0u8; capacity], vec![VDirEntry::default(); capacity])
+    }
+
+    fn insert(tags: &mut [u8], entries: &mut [VDirEntry], entry: VDirEntry) -> usize {
+        let key = VDirKey::of_entry(&entry);
+        let probe = unsafe { vdir_probe(tags.as_ptr(), entries.as_ptr(), tags.len(), key) };
+        let slot = match probe {
+            VDirProbe::Found(slot) | VDirProbe::Vacant(slot) => slot,
+            VDirProbe::Full => panic!("table full"),
+        };
+        tags[slot] = vdir_tag(entry.path_hash);
+        entries[slot] = entry;
+        slot
+    }
+
+    fn find(tags: &[u8], entries: &[VDirEntry], key: VDirKey) -> VDirProbe {
+        unsafe { vdir_probe(tags.as_ptr(), entries.as_ptr(), tags.len(), key) }
+    }
+
+    #[test]
+    fn test_header_and_entry_sizes() {
+        assert_eq!(VDIR_HEADER_SIZE, 64);
+        assert_eq!(VDIR_ENTRY_SIZE, 72);
+        assert_eq!(vdir_table_offset(65536) % 64, 0);
+        assert_eq!(vdir_file_size(16), 64 + 64 + 16 * 72);
+        let table = VDirTable::at(VDIR_TAGS_OFFSET, 65536);
+        assert_eq!(table.table_offset, vdir_table_offset(65536));
+        assert_eq!(table.end(), vdir_file_size(65536));
+    }
+
+    #[test]
+    fn test_group_match_lanes() {
+        let mut tags = [0u8; 16];
+        tags[0] = 0x85;
+        tags[7] = 0x85;
+        tags[15] = 0x85;
+        tags[3] = 0x90;
+        let lanes: Vec<usize> = unsafe { group_match(tags.as_ptr(), 0x85) }.collect();
+        assert_eq!(lanes, vec![0, 7, 15]);
+        let empty: Vec<usize> = unsafe { group_match(tags.as_ptr(), VDIR_TAG_EMPTY) }.collect();
+        assert_eq!(empty.len(), 12);
+        assert!(!unsafe { group_match(tags.as_ptr(), 0xAA) }.any());
+    }
+
+    #[test]
+    fn test_probe_insert_and_find() {
+        let (mut tags, mut entries) = table(1024);
+        for i in 0..700u64 {
+            let path = format!("src/file_{}.rs", i);
+            let key = VDirKey::from_path(&path);
+            insert(
+                &mut tags,
+                &mut entries,
+                VDirEntry {
+                    path_hash: key.path_hash,
+                    path_check: key.path_check,
+                    size: i,
+                    ..Default::default()
+                },
+            );
+        }
+        for i in 0..700u64 {
+            let key = VDirKey::from_path(&format!("src/file_{}.rs", i));
+            match find(&tags, &entries, key) {
+                VDirProbe::Found(slot) => assert_eq!(entries[slot].size, i),
+                other => panic!("missing file_{}: {:?}", i, other),
+            }
+        }
+        assert!(matches!(
+            find(&tags, &entries, VDirKey::from_path("src/absent.rs")),
+            VDirProbe::Vacant(_)
+        ));
+    }
+
+    #[test]
+    fn test_probe_detects_primary_hash_collision() {
+        let (mut tags, mut entries) = table(64);
+        // Same 64-bit hash, different paths (different secondary checks)
+        let a = VDirKey {
+            path_hash: 0xDEAD_BEEF,
+            path_check: 11,
+        };
+        let b = VDirKey {
+            path_hash: 0xDEAD_BEEF,
+            path_check: 22,
+        };
+        let slot_a = insert(
+            &mut tags,
+            &mut entries,
+            VDirEntry {
+                path_hash: a.path_hash,
+                path_check: a.path_check,
+                size: 1,
+                ..Default::default()
+            },
+        );
+        assert!(matches!(find(&tags, &entries, b), VDirProbe::Vacant(_)));
+
+        let slot_b = insert(
+            &mut tags,
+            &mut entries,
+            VDirEntry {
+                path_hash: b.path_hash,
+                path_check: b.path_check,
+                size: 2,
+                ..Default::default()
+            },
+        );
+        assert_ne!(slot_a, slot_b);
+        assert_eq!(find(&tags, &entries, a), VDirProbe::Found(slot_a));
+        assert_eq!(find(&tags, &entries, b), VDirProbe::Found(slot_b));
+        // Hash-only lookups still resolve (first match)
+        assert!(matches!(
+            find(&tags, &entries, VDirKey::from(0xDEAD_BEEF)),
+            VDirProbe::Found(_)
+        ));
+    }
+
+    #[test]
+    fn test_probe_full_table() {
+        let (mut tags, mut entries) = table(16);
+        for i in 0..16u64 {
+            insert(
+                &mut tags,
+                &mut entries,
+                VDirEntry {
+                    path_hash: i + 1,
+                    ..Default::default()
+                },
+            );
+        }
+        assert_eq!(find(&tags, &entries, VDirKey::from(999)), VDirProbe::Full);
+        assert!(matches!(
+            find(&tags, &entries, VDirKey::from(5)),
+            VDirProbe::Found(_)
+        ));
+    }
+
+    #[test]
+    fn test_probe_sequence_visits_every_group() {
+        let capacity = 4096;
+        let groups = capacity / VDIR_GROUP_WIDTH;
+        let mut seen = vec![false; groups];
+        for slot in (0..capacity).step_by(VDIR_GROUP_WIDTH) {
+            let distance = vdir_probe_distance(12345, slot, capacity);
+            assert!(distance <= groups);
+            assert!(!seen[distance - 1], "group visited twice");
+            seen[distance - 1] = true;
+        }
+    }
+
+    #[test]
+    fn test_path_check_never_zero_and_distinct() {
+        assert_ne!(vdir_path_check(""), 0);
+        assert_ne!(vdir_path_check("a/b"), vdir_path_check("b/a"));
+        assert_ne!(vdir_path_check("file_1"), vdir_path_check("file_2"));
+    }
+
+    #[test]
+    fn test_find_consults_old_table_during_migration() {
+        // Old table (16 slots) right after the header, live table (32) after it
+        let old = VDirTable::at(VDIR_TAGS_OFFSET, 16);
+        let live = VDirTable::at(old.end(), 32);
+        let mut buf = vec![0u64; live.end().div_ceil(8)];
+        let base = buf.as_mut_ptr() as *mut u8;
+
+        let put = |table: VDirTable, path: &str, size: u64| unsafe {
+            let key = VDirKey::from_path(path);
+            let VDirProbe::Vacant(slot) = table.probe(base, key) else {
+                panic!("slot taken");
+            };
+            *base.add(table.tags_offset + slot) = vdir_tag(key.path_hash);
+            *(table.entry(base, slot) as *mut VDirEntry) = VDirEntry {
+                path_hash: key.path_hash,
+                path_check: key.path_check,
+                size,
+                ..Default::default()
+            };
+        };
+        put(old, "unmigrated.rs", 1);
+        put(old, "updated.rs", 2);
+        put(live, "updated.rs", 3);
+
+        unsafe {
+            let header = &mut *(base as *mut VDirHeader);
+            header.magic = VDIR_MAGIC;
+            header.table_capacity = 32;
+            header.tags_offset = live.tags_offset as u32;
+            header.table_offset = live.table_offset as u32;
+            header.old_capacity = 16;
+            header.old_tags_offset = old.tags_offset as u32;
+            header.old_table_offset = old.table_offset as u32;
+            header.file_size = live.end() as u64;
+        }
+        let len = live.end();
+        let find = |path: &str| unsafe {
+            vdir_find(base, len, VDirKey::from_path(path)).map(|e| (*e).size)
+        };
+
+        assert_eq!(find("unmigrated.rs"), Some(1));
+        assert_eq!(find("updated.rs"), Some(3)); // live table wins
+        assert_eq!(find("absent.rs"), None);
+
+        // Mapping shorter than the live table: old table still served
+        assert_eq!(
+            unsafe { vdir_find(base, old.end(), VDirKey::from_path("unmigrated.rs")) }
+                .map(|e| unsafe { (*e).size }),
+            Some(1)
+        );
+    }
+
+    #[test]
+    fn test_dir_key_and_parent() {
+        assert_eq!(vdir_dir_key("/"), "/");
+        assert_eq!(vdir_dir_key("//"), "/");
+        assert_eq!(vdir_dir_key("/src/"), "/src");
+        assert_eq!(vdir_dir_key("/src"), "/src");
+        assert_eq!(vdir_parent("/src/main.rs"), ("/src", "main.rs"));
+        assert_eq!(vdir_parent("/src"), ("/", "src"));
+        assert_eq!(vdir_parent("rel"), ("", "rel"));
+    }
+
+    #[test]
+    fn test_dirs_rejects_stale_and_out_of_bounds_index() {
+        let len = VDIR_HEADER_SIZE + VDIR_DIRS_HEADER_SIZE + 16 * 24;
+        let mut buf = vec![0u64; len.div_ceil(8)];
+        let base = buf.as_mut_ptr() as *mut u8;
+        unsafe {
+            let header = &mut *(base as *mut VDirHeader);
+            header.dirs_offset = VDIR_HEADER_SIZE as u32;
+            header.file_size = len as u64;
+            let dirs = &mut *(base.add(VDIR_HEADER_SIZE) as *mut VDirDirsHeader);
+            dirs.dir_capacity = 16;
+            dirs.region_size = (len - VDIR_HEADER_SIZE) as u32;
+            assert!(VDirDirs::open(base, len).is_some());
+            assert!(VDirDirs::open(base, len)
+                .unwrap()
+                .find(VDirKey::from_path("/"))
+                .is_none());
+
+            dirs.flags = VDIR_DIRS_STALE;
+            assert!(VDirDirs::open(base, len).is_none());
+            dirs.flags = 0;
+
+            // Counts claiming more than the region / mapping holds
+            dirs.names_len = 1 << 20;
+            assert!(VDirDirs::open(base, len).is_none());
+            dirs.names_len = 0;
+            dirs.dir_capacity = 15;
+            assert!(VDirDirs::open(base, len).is_none());
+        }
+    }
+
+    #[test]
+    fn test_filter_no_false_negatives() {
+        let keys = 10_000;
+        let blocks = vdir_filter_blocks(keys);
+        let filter_offset = VDIR_DIRS_HEADER_SIZE + 16 * 24;
+        let region = filter_offset + blocks * VDIR_FILTER_BLOCK;
+        let len = VDIR_HEADER_SIZE + region;
+        let mut buf = vec![0u64; len.div_ceil(8)];
+        let base = buf.as_mut_ptr() as *mut u8;
+        unsafe {
+            let header = &mut *(base as *mut VDirHeader);
+            header.dirs_offset = VDIR_HEADER_SIZE as u32;
+            header.file_size = len as u64;
+            let dirs = &mut *(base.add(VDIR_HEADER_SIZE) as *mut VDirDirsHeader);
+            dirs.dir_capacity = 16;
+            dirs.region_size = region as u32;
+            assert_eq!(
+                VDirDirs::open(base, len)
+                    .unwrap()
+                    .may_contain(VDirKey::from_path("/a")),
+                None
+            );
+
+            dirs.filter_offset = filter_offset as u32;
+            dirs.filter_blocks = blocks as u32;
+            assert_eq!(dirs.used_size(), region);
+            let filter = std::slice::from_raw_parts_mut(
+                base.add(VDIR_HEADER_SIZE + filter_offset) as *mut u32,
+                blocks * 8,
+            );
+            for i in 0..keys {
+                vdir_filter_insert(filter, VDirKey::from_path(&format!("/src/f{}.rs", i)));
+            }
+
+            let view = VDirDirs::open(base, len).unwrap();
+            for i in 0..keys {
+                let key = VDirKey::from_path(&format!("/src/f{}.rs", i));
+                assert_eq!(view.may_contain(key), Some(true));
+            }
+            let false_positives = (0..keys)
+                .filter(|i| {
+                    view.may_contain(VDirKey::from_path(&format!("/inc/h{}.h", i))) == Some(true)
+                })
+                .count();
+            assert!(
+                false_positives < keys / 100,
+                "{} false positives",
+                false_positives
+            );
+
+            // Filter claiming more blocks than the region holds
+            dirs.filter_blocks = blocks as u32 + 1;
+            assert!(VDirDirs::open(base, len).is_none());
+        }
+    }
+}
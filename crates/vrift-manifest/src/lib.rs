@@ -8,6 +8,7 @@
 //! ## Storage Backends
 //!
 //! - `Manifest`: In-memory HashMap with rkyv file persistence
+//! - `MappedManifest`: A saved `Manifest` mapped and read in place
 //! - `LmdbManifest`: LMDB-backed with ACID transactions (RFC-0039)
 
 pub mod lmdb;
@@ -18,7 +19,7 @@ pub use tier::{classify_tier, TierClassifier, DEFAULT_TIER1_PATTERNS, DEFAULT_TI
 
 use std::collections::HashMap;
 use std::fs::File;
-use std::io::{self, BufReader, BufWriter};
+use std::io::{self, BufWriter};
 use std::path::Path;
 
 use rkyv::Archive;
@@ -275,14 +276,10 @@ impl Manifest {
     }
 
     /// Load a manifest from a file
+    ///
+    /// Use [`MappedManifest`] to read entries without building the maps.
     pub fn load<P: AsRef<Path>>(path: P) -> Result<Self> {
-        let file = File::open(path)?;
-        let mut reader = BufReader::new(file);
-        let mut data = Vec::new();
-        std::io::Read::read_to_end(&mut reader, &mut data)?;
-        let manifest = rkyv::from_bytes::<Self, rkyv::rancor::Error>(&data)
-            .map_err(|e| ManifestError::Rkyv(e.to_string()))?;
-        Ok(manifest)
+        MappedManifest::open(path)?.to_manifest()
     }
 
     /// Get manifest statistics
@@ -308,6 +305,90 @@ impl Manifest {
     }
 }
 
+/// A saved [`Manifest`] accessed in place: the file is mapped and its rkyv
+/// archive validated once on open, then lookups and iteration read the
+/// archived hash maps directly. Nothing is deserialized or allocated, so
+/// opening a multi-million-entry manifest costs one validation pass.
+pub struct MappedManifest {
+    map: memmap2::Mmap,
+}
+
+impl MappedManifest {
+    pub fn open<P: AsRef<Path>>(path: P) -> Result<Self> {
+        let file = File::open(path)?;
+        // SAFETY: manifests are replaced by rename, never rewritten in place
+        let map = unsafe { memmap2::Mmap::map(&file)? };
+        rkyv::access::<ArchivedManifest, rkyv::rancor::Error>(&map)
+            .map_err(|e| ManifestError::Rkyv(e.to_string()))?;
+        Ok(Self { map })
+    }
+
+    fn archived(&self) -> &ArchivedManifest {
+        // SAFETY: validated in `open`, and the mapping is immutable
+        unsafe { rkyv::access_unchecked::<ArchivedManifest>(&self.map) }
+    }
+
+    pub fn version(&self) -> u32 {
+        self.archived().version.to_native()
+    }
+
+    /// Get an entry by path
+    pub fn get(&self, path: &str) -> Option<&ArchivedVnodeEntry> {
+        self.get_by_hash(&compute_path_hash(path))
+    }
+
+    /// Get an entry by path hash
+    pub fn get_by_hash(&self, hash: &PathHash) -> Option<&ArchivedVnodeEntry> {
+        self.archived().entries.get(hash)
+    }
+
+    pub fn len(&self) -> usize {
+        self.archived().entries.len()
+    }
+
+    pub fn is_empty(&self) -> bool {
+        self.len() == 0
+    }
+
+    /// Iterate over all entries with their paths
+    pub fn iter(&self) -> impl Iterator<Item = (&str, &ArchivedVnodeEntry)> {
+        let archived = self.archived();
+        archived
+            .paths
+            .iter()
+            .filter_map(|(hash, path)| archived.entries.get(hash).map(|e| (path.as_str(), e)))
+    }
+
+    /// Iterate over all entries without their paths
+    pub fn entries(&self) -> impl Iterator<Item = &ArchivedVnodeEntry> {
+        self.archived().entries.values()
+    }
+
+    /// Deserialize into an owned, mutable [`Manifest`]
+    pub fn to_manifest(&self) -> Result<Manifest> {
+        rkyv::deserialize::<Manifest, rkyv::rancor::Error>(self.archived())
+            .map_err(|e| ManifestError::Rkyv(e.to_string()))
+    }
+}
+
+impl ArchivedVnodeEntry {
+    /// Native copy of this entry
+    pub fn to_native(&self) -> VnodeEntry {
+        VnodeEntry {
+            content_hash: self.content_hash,
+            size: self.size.to_native(),
+            mtime: self.mtime.to_native(),
+            mode: self.mode.to_native(),
+            flags: self.flags.to_native(),
+            _pad: 0,
+        }
+    }
+
+    pub fn is_dir(&self) -> bool {
+        self.flags.to_native() & (VnodeFlags::Directory as u16) != 0
+    }
+}
+
 /// Robust path normalization (expands tilde and resolves absolute)
 pub fn normalize_path(p: &str) -> std::path::PathBuf {
     if let Some(stripped) = p.strip_prefix("~/") {
@@ -385,6 +466,35 @@ mod tests {
         assert!(loaded.get("/test/file.txt").is_some());
     }
 
+    #[test]
+    fn test_mapped_manifest_reads_in_place() {
+        let temp = TempDir::new().unwrap();
+        let manifest_path = temp.path().join("test.manifest");
+
+        let mut manifest = Manifest::new();
+        for i in 0..100u8 {
+            manifest.insert(
+                &format!("/src/file{}.rs", i),
+                VnodeEntry::new_file([i; 32], i as u64, 7, 0o644),
+            );
+        }
+        manifest.insert("/src", VnodeEntry::new_directory(0, 0o755));
+        manifest.save(&manifest_path).unwrap();
+
+        let mapped = MappedManifest::open(&manifest_path).unwrap();
+        assert_eq!(mapped.len(), 101);
+        assert_eq!(mapped.version(), 1);
+        let entry = mapped.get("src/file42.rs").unwrap();
+        assert_eq!(entry.to_native(), *manifest.get("/src/file42.rs").unwrap());
+        assert!(mapped.get("/src").unwrap().is_dir());
+        assert!(mapped.get("/missing").is_none());
+        assert_eq!(mapped.iter().count(), 101);
+        assert_eq!(mapped.entries().filter(|e| !e.is_dir()).count(), 100);
+
+        std::fs::write(&manifest_path, b"not an archive").unwrap();
+        assert!(MappedManifest::open(&manifest_path).is_err());
+    }
+
     #[test]
     fn test_manifest_stats() {
         let mut manifest = Manifest::new();
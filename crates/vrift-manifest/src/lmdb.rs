@@ -5,6 +5,7 @@
 //! - Delta Layer: Mutable modifications (DashMap)
 
 use std::path::Path;
+use std::sync::atomic::{AtomicU64, Ordering};
 use std::sync::Arc;
 
 use dashmap::DashMap;
@@ -90,6 +91,9 @@ pub struct LmdbManifest {
 
     /// Path hash → path string for delta entries
     delta_paths: Arc<DashMap<PathHash, String>>,
+
+    /// Bumped by every insert/remove into the delta layer
+    revision: AtomicU64,
 }
 
 impl LmdbManifest {
@@ -137,6 +141,7 @@ impl LmdbManifest {
             paths_db,
             delta: Arc::new(DashMap::new()),
             delta_paths: Arc::new(DashMap::new()),
+            revision: AtomicU64::new(0),
         })
     }
 
@@ -155,6 +160,7 @@ impl LmdbManifest {
         };
         self.delta.insert(hash, DeltaEntry::Modified(entry));
         self.delta_paths.insert(hash, path.to_string());
+        self.revision.fetch_add(1, Ordering::Release);
     }
 
     /// Get an entry by path (checks delta first, then base)
@@ -208,6 +214,16 @@ impl LmdbManifest {
         let hash = compute_path_hash(path);
         self.delta.insert(hash, DeltaEntry::Deleted);
         self.delta_paths.remove(&hash);
+        self.revision.fetch_add(1, Ordering::Release);
+    }
+
+    /// Content revision: changes whenever an entry is inserted or removed
+    /// here, or any process (vriftd ingest, the CLI) commits to the LMDB
+    /// environment. Lets derived views (the VDir directory index and
+    /// manifest filter) detect staleness without rescanning.
+    pub fn revision(&self) -> u64 {
+        // last_txn_id lives in the shared lock file, so it sees other writers
+        self.revision.load(Ordering::Acquire) + self.env.info().last_txn_id as u64
     }
 
     /// Get the original path string for a hash
@@ -294,41 +310,60 @@ impl LmdbManifest {
         Ok(self.len()? == 0)
     }
 
-    /// Iterate over all entries (base + delta merged)
+    /// Stream all entries (base + delta merged) through `visit` without
+    /// collecting them. Returning false from `visit` stops the scan.
     ///
-    /// Note: This is an expensive operation for large manifests
-    pub fn iter(&self) -> LmdbResult<Vec<(String, ManifestEntry)>> {
-        let rtxn = self.env.read_txn()?;
-        let mut result = Vec::new();
-        let mut deleted_hashes = std::collections::HashSet::new();
-
-        // Collect delta deletions
-        for entry in self.delta.iter() {
-            if matches!(entry.value(), DeltaEntry::Deleted) {
-                deleted_hashes.insert(*entry.key());
-            }
-        }
-
-        // Add delta modifications first
+    /// Base entries come from one read transaction with a cursor over each
+    /// database, advanced in lockstep (both are keyed by path hash), so
+    /// there are no per-entry lookups and paths are borrowed from the LMDB
+    /// map. `visit` must not modify this manifest.
+    pub fn for_each<F>(&self, mut visit: F) -> LmdbResult<()>
+    where
+        F: FnMut(&str, &ManifestEntry) -> bool,
+    {
+        // Delta modifications first
         for entry in self.delta.iter() {
             if let DeltaEntry::Modified(manifest_entry) = entry.value() {
                 if let Some(path_ref) = self.delta_paths.get(entry.key()) {
-                    result.push((path_ref.value().clone(), manifest_entry.clone()));
+                    if !visit(path_ref.value(), manifest_entry) {
+                        return Ok(());
+                    }
                 }
             }
         }
 
-        // Add base entries not in delta
-        let mut iter = self.entries_db.iter(&rtxn)?;
-        while let Some(Ok((hash_bytes, entry))) = iter.next() {
-            let hash: PathHash = hash_bytes.try_into().unwrap_or([0u8; 32]);
-            if !self.delta.contains_key(&hash) && !deleted_hashes.contains(&hash) {
-                if let Some(path) = self.paths_db.get(&rtxn, &hash)? {
-                    result.push((path.to_string(), entry));
-                }
+        // Base entries not shadowed by the delta (modified or whiteout)
+        let rtxn = self.env.read_txn()?;
+        let mut paths = self.paths_db.iter(&rtxn)?;
+        let mut next_path = paths.next().transpose()?;
+        for item in self.entries_db.iter(&rtxn)? {
+            let (hash_bytes, entry) = item?;
+            while next_path.is_some_and(|(key, _)| key < hash_bytes) {
+                next_path = paths.next().transpose()?;
+            }
+            let Some((_, path)) = next_path.filter(|&(key, _)| key == hash_bytes) else {
+                continue; // No path recorded
+            };
+            let Ok(hash) = PathHash::try_from(hash_bytes) else {
+                continue;
+            };
+            if !self.delta.contains_key(&hash) && !visit(path, &entry) {
+                break;
             }
         }
+        Ok(())
+    }
 
+    /// Iterate over all entries (base + delta merged)
+    ///
+    /// Note: This collects every entry; prefer [`Self::for_each`] for
+    /// large manifests
+    pub fn iter(&self) -> LmdbResult<Vec<(String, ManifestEntry)>> {
+        let mut result = Vec::new();
+        self.for_each(|path, entry| {
+            result.push((path.to_string(), entry.clone()));
+            true
+        })?;
         Ok(result)
     }
 
@@ -340,35 +375,22 @@ impl LmdbManifest {
 
     /// Get environment statistics
     pub fn stats(&self) -> LmdbResult<ManifestStats> {
-        let entries = self.iter()?;
-
-        let mut file_count = 0u64;
-        let mut dir_count = 0u64;
-        let mut total_size = 0u64;
-        let mut tier1_count = 0u64;
-        let mut tier2_count = 0u64;
-
-        for (_, entry) in &entries {
+        let mut stats = ManifestStats::default();
+        self.for_each(|_, entry| {
             if entry.vnode.is_dir() {
-                dir_count += 1;
+                stats.dir_count += 1;
             } else {
-                file_count += 1;
-                total_size += entry.vnode.size;
+                stats.file_count += 1;
+                stats.total_size += entry.vnode.size;
             }
 
             match entry.tier {
-                AssetTier::Tier1Immutable => tier1_count += 1,
-                AssetTier::Tier2Mutable => tier2_count += 1,
+                AssetTier::Tier1Immutable => stats.tier1_count += 1,
+                AssetTier::Tier2Mutable => stats.tier2_count += 1,
             }
-        }
-
-        Ok(ManifestStats {
-            file_count,
-            dir_count,
-            total_size,
-            tier1_count,
-            tier2_count,
-        })
+            true
+        })?;
+        Ok(stats)
     }
 }
 
@@ -473,6 +495,80 @@ mod tests {
         assert!(manifest.get("/to_delete.txt").unwrap().is_none());
     }
 
+    #[test]
+    fn test_lmdb_manifest_revision() {
+        let temp = TempDir::new().unwrap();
+        let manifest = LmdbManifest::open(temp.path().join("manifest")).unwrap();
+        let opened = manifest.revision();
+        assert_eq!(manifest.revision(), opened);
+
+        manifest.insert(
+            "/a.txt",
+            VnodeEntry::new_file([1u8; 32], 1, 0, 0o644),
+            AssetTier::Tier2Mutable,
+        );
+        let after_insert = manifest.revision();
+        assert!(after_insert > opened);
+
+        // A write transaction moves it too (also when another process commits)
+        manifest.commit().unwrap();
+        let after_commit = manifest.revision();
+        assert!(after_commit > after_insert);
+
+        manifest.remove("/a.txt");
+        assert!(manifest.revision() > after_commit);
+    }
+
+    #[test]
+    fn test_lmdb_manifest_for_each_merges_delta() {
+        let temp = TempDir::new().unwrap();
+        let manifest = LmdbManifest::open(temp.path().join("manifest")).unwrap();
+        for i in 0..50u8 {
+            manifest.insert(
+                &format!("/f{}", i),
+                VnodeEntry::new_file([i; 32], i as u64, 0, 0o644),
+                AssetTier::Tier2Mutable,
+            );
+        }
+        manifest.commit().unwrap();
+
+        manifest.remove("/f3");
+        manifest.insert(
+            "/f4",
+            VnodeEntry::new_file([0xee; 32], 4, 0, 0o644),
+            AssetTier::Tier2Mutable,
+        );
+        manifest.insert(
+            "/new",
+            VnodeEntry::new_file([0xff; 32], 1, 0, 0o644),
+            AssetTier::Tier1Immutable,
+        );
+
+        let mut seen = std::collections::HashMap::new();
+        manifest
+            .for_each(|path, entry| {
+                assert!(seen
+                    .insert(path.to_string(), entry.vnode.content_hash)
+                    .is_none());
+                true
+            })
+            .unwrap();
+        assert_eq!(seen.len(), 50);
+        assert!(!seen.contains_key("/f3"));
+        assert_eq!(seen["/f4"], [0xee; 32]);
+        assert_eq!(seen["/f7"], [7; 32]);
+        assert_eq!(seen["/new"], [0xff; 32]);
+
+        let mut visited = 0;
+        manifest
+            .for_each(|_, _| {
+                visited += 1;
+                visited < 10
+            })
+            .unwrap();
+        assert_eq!(visited, 10);
+    }
+
     #[test]
     fn test_tier_classification() {
         assert_eq!(AssetTier::default(), AssetTier::Tier2Mutable);
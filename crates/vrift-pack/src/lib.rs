@@ -10,20 +10,27 @@
 //! Based on profile-guided packing: files accessed together during startup
 //! are packed contiguously.
 //!
-//! ## Packfile Format
+//! ## Packfile Format (v2)
 //!
 //! ```text
 //! +----------------+
-//! | Header (32B)   |  Magic, version, entry count
+//! | Header (64B)   |  Magic, version, entry count, section offsets
 //! +----------------+
-//! | Index Table    |  [Hash, Offset, Length] × N
+//! | Blob Data      |  Raw concatenated blobs, in first-access order
 //! +----------------+
-//! | Blob Data      |  Raw concatenated blobs
+//! | Fanout (1 KiB) |  256 × u32: entries whose hash[0] <= i
+//! +----------------+
+//! | Index Table    |  [Hash, Offset, Length] × N, sorted by hash
 //! +----------------+
 //! ```
+//!
+//! All integers are little endian. The index is searched in place in the
+//! mmap (fanout bucket, then binary search), so opening a pack costs no
+//! allocation or deserialization, and readers outside this crate (the
+//! inception layer) can use it with nothing but the layout above.
 
-use std::collections::HashMap;
-use std::fs::File;
+use std::collections::HashSet;
+use std::fs::{self, File};
 use std::io::{self, BufReader, BufWriter, Seek, SeekFrom, Write};
 use std::path::{Path, PathBuf};
 
@@ -32,12 +39,18 @@ use rkyv::Archive;
 use serde::{Deserialize, Serialize};
 use thiserror::Error;
 
-use vrift_cas::Blake3Hash;
+use vrift_cas::{Blake3Hash, CasStore};
 
 /// Magic bytes for packfile identification
-const PACK_MAGIC: &[u8; 8] = b"VELOPACK";
+pub const PACK_MAGIC: &[u8; 8] = b"VELOPACK";
 /// Current packfile format version
-const PACK_VERSION: u32 = 1;
+pub const PACK_VERSION: u32 = 2;
+/// Fixed header size
+pub const PACK_HEADER_SIZE: usize = 64;
+/// Cumulative per-first-byte entry counts
+pub const PACK_FANOUT_SIZE: usize = 256 * 4;
+/// Index entry: hash (32), data offset (u64), length (u64)
+pub const PACK_ENTRY_SIZE: usize = 48;
 
 /// Errors that can occur during packfile operations
 #[derive(Error, Debug)]
@@ -53,49 +66,84 @@ pub enum PackError {
 
     #[error("Blob not found in pack: {hash}")]
     NotFound { hash: String },
+
+    #[error("CAS error: {0}")]
+    Cas(#[from] vrift_cas::CasError),
 }
 
 pub type Result<T> = std::result::Result<T, PackError>;
 
-/// Packfile header (fixed 32 bytes)
-#[derive(Debug, Clone, Serialize, Deserialize, Archive, rkyv::Serialize, rkyv::Deserialize)]
-#[rkyv(derive(Debug))]
+fn read_u32(bytes: &[u8], at: usize) -> u32 {
+    u32::from_le_bytes(bytes[at..at + 4].try_into().unwrap())
+}
+
+fn read_u64(bytes: &[u8], at: usize) -> u64 {
+    u64::from_le_bytes(bytes[at..at + 8].try_into().unwrap())
+}
+
+/// Packfile header (fixed 64 bytes)
+///
+/// magic (8), version (u32), entry count (u32), data offset, data length,
+/// fanout offset, index offset (u64 each), 16 reserved bytes.
+#[derive(Debug, Clone, Copy, PartialEq, Eq)]
 struct PackHeader {
-    magic: [u8; 8],
-    version: u32,
     entry_count: u32,
-    index_offset: u64,
     data_offset: u64,
+    data_len: u64,
+    fanout_offset: u64,
+    index_offset: u64,
 }
 
 impl PackHeader {
-    fn new(entry_count: u32, index_offset: u64, data_offset: u64) -> Self {
-        Self {
-            magic: *PACK_MAGIC,
-            version: PACK_VERSION,
-            entry_count,
-            index_offset,
-            data_offset,
-        }
+    fn encode(&self) -> [u8; PACK_HEADER_SIZE] {
+        let mut out = [0u8; PACK_HEADER_SIZE];
+        out[..8].copy_from_slice(PACK_MAGIC);
+        out[8..12].copy_from_slice(&PACK_VERSION.to_le_bytes());
+        out[12..16].copy_from_slice(&self.entry_count.to_le_bytes());
+        out[16..24].copy_from_slice(&self.data_offset.to_le_bytes());
+        out[24..32].copy_from_slice(&self.data_len.to_le_bytes());
+        out[32..40].copy_from_slice(&self.fanout_offset.to_le_bytes());
+        out[40..48].copy_from_slice(&self.index_offset.to_le_bytes());
+        out
     }
 
-    fn validate(&self) -> Result<()> {
-        if &self.magic != PACK_MAGIC {
+    /// Parse and bounds-check against a file of `file_len` bytes
+    fn decode(bytes: &[u8], file_len: u64) -> Result<Self> {
+        if bytes.len() < PACK_HEADER_SIZE {
+            return Err(PackError::Invalid("File too small".to_string()));
+        }
+        if &bytes[..8] != PACK_MAGIC {
             return Err(PackError::Invalid("Bad magic bytes".to_string()));
         }
-        if self.version != PACK_VERSION {
+        let version = read_u32(bytes, 8);
+        if version != PACK_VERSION {
             return Err(PackError::Invalid(format!(
                 "Unsupported version: {}",
-                self.version
+                version
             )));
         }
-        Ok(())
+        let header = Self {
+            entry_count: read_u32(bytes, 12),
+            data_offset: read_u64(bytes, 16),
+            data_len: read_u64(bytes, 24),
+            fanout_offset: read_u64(bytes, 32),
+            index_offset: read_u64(bytes, 40),
+        };
+
+        let fits = |offset: u64, len: u64| offset.checked_add(len).is_some_and(|e| e <= file_len);
+        let index_len = header.entry_count as u64 * PACK_ENTRY_SIZE as u64;
+        if !fits(header.data_offset, header.data_len)
+            || !fits(header.fanout_offset, PACK_FANOUT_SIZE as u64)
+            || !fits(header.index_offset, index_len)
+        {
+            return Err(PackError::Invalid("Section extends past EOF".to_string()));
+        }
+        Ok(header)
     }
 }
 
 /// Index entry for a blob in the packfile
-#[derive(Debug, Clone, Serialize, Deserialize, Archive, rkyv::Serialize, rkyv::Deserialize)]
-#[rkyv(derive(Debug))]
+#[derive(Debug, Clone, Copy, PartialEq, Eq)]
 pub struct PackIndexEntry {
     /// BLAKE3 hash of the blob
     pub hash: Blake3Hash,
@@ -105,68 +153,111 @@ pub struct PackIndexEntry {
     pub length: u64,
 }
 
+impl PackIndexEntry {
+    fn encode(&self) -> [u8; PACK_ENTRY_SIZE] {
+        let mut out = [0u8; PACK_ENTRY_SIZE];
+        out[..32].copy_from_slice(&self.hash);
+        out[32..40].copy_from_slice(&self.offset.to_le_bytes());
+        out[40..48].copy_from_slice(&self.length.to_le_bytes());
+        out
+    }
+
+    fn decode(bytes: &[u8]) -> Self {
+        Self {
+            hash: bytes[..32].try_into().unwrap(),
+            offset: read_u64(bytes, 32),
+            length: read_u64(bytes, 40),
+        }
+    }
+}
+
 /// Reader for packfiles
 pub struct PackReader {
     path: PathBuf,
     mmap: Mmap,
-    index: HashMap<Blake3Hash, PackIndexEntry>,
-    data_offset: u64,
+    header: PackHeader,
 }
 
 impl PackReader {
     /// Open a packfile for reading
+    ///
+    /// Only the header and fanout table are validated; the index is used in
+    /// place, so this costs the same for ten blobs or a million.
     pub fn open<P: AsRef<Path>>(path: P) -> Result<Self> {
         let path = path.as_ref().to_path_buf();
         let file = File::open(&path)?;
         let mmap = unsafe { Mmap::map(&file) }.map_err(io::Error::other)?;
-
-        if mmap.len() < 32 {
-            return Err(PackError::Invalid("File too small".to_string()));
+        let header = PackHeader::decode(&mmap, mmap.len() as u64)?;
+
+        let reader = Self { path, mmap, header };
+        let mut prev = 0;
+        for i in 0..=255u8 {
+            let count = reader.fanout(i);
+            if count < prev {
+                return Err(PackError::Invalid("Fanout not monotonic".to_string()));
+            }
+            prev = count;
         }
+        if prev != header.entry_count as usize {
+            return Err(PackError::Invalid(
+                "Fanout does not match entry count".to_string(),
+            ));
+        }
+        Ok(reader)
+    }
 
-        // Read header
-        let header: PackHeader = rkyv::from_bytes::<PackHeader, rkyv::rancor::Error>(&mmap[..32])
-            .map_err(|e| PackError::Rkyv(e.to_string()))?;
-        header.validate()?;
-
-        // Read index
-        let index_start = header.index_offset as usize;
-        let index_end = header.data_offset as usize;
-        let index_bytes = &mmap[index_start..index_end];
-        let entries: Vec<PackIndexEntry> =
-            rkyv::from_bytes::<Vec<PackIndexEntry>, rkyv::rancor::Error>(index_bytes)
-                .map_err(|e| PackError::Rkyv(e.to_string()))?;
+    /// Number of entries whose hash starts with a byte <= `byte`
+    #[inline]
+    fn fanout(&self, byte: u8) -> usize {
+        read_u32(
+            &self.mmap,
+            self.header.fanout_offset as usize + byte as usize * 4,
+        ) as usize
+    }
 
-        let index: HashMap<Blake3Hash, PackIndexEntry> =
-            entries.into_iter().map(|e| (e.hash, e)).collect();
+    #[inline]
+    fn entry_bytes(&self, i: usize) -> &[u8] {
+        let start = self.header.index_offset as usize + i * PACK_ENTRY_SIZE;
+        &self.mmap[start..start + PACK_ENTRY_SIZE]
+    }
 
-        Ok(Self {
-            path,
-            mmap,
-            index,
-            data_offset: header.data_offset,
-        })
+    /// Index entry for `hash`: fanout bucket, then binary search in place
+    pub fn find(&self, hash: &Blake3Hash) -> Option<PackIndexEntry> {
+        let first = hash[0];
+        let mut lo = if first == 0 {
+            0
+        } else {
+            self.fanout(first - 1)
+        };
+        let mut hi = self.fanout(first);
+        while lo < hi {
+            let mid = lo + (hi - lo) / 2;
+            let entry = self.entry_bytes(mid);
+            match entry[..32].cmp(&hash[..]) {
+                std::cmp::Ordering::Less => lo = mid + 1,
+                std::cmp::Ordering::Greater => hi = mid,
+                std::cmp::Ordering::Equal => return Some(PackIndexEntry::decode(entry)),
+            }
+        }
+        None
     }
 
     /// Get a blob by hash (zero-copy via mmap slice)
     pub fn get(&self, hash: &Blake3Hash) -> Result<&[u8]> {
-        let entry = self.index.get(hash).ok_or_else(|| PackError::NotFound {
-            hash: vrift_cas::CasStore::hash_to_hex(hash),
+        let entry = self.find(hash).ok_or_else(|| PackError::NotFound {
+            hash: CasStore::hash_to_hex(hash),
         })?;
 
-        let start = self.data_offset as usize + entry.offset as usize;
-        let end = start + entry.length as usize;
-
-        if end > self.mmap.len() {
+        if entry.offset.saturating_add(entry.length) > self.header.data_len {
             return Err(PackError::Invalid("Blob extends past EOF".to_string()));
         }
-
-        Ok(&self.mmap[start..end])
+        let start = (self.header.data_offset + entry.offset) as usize;
+        Ok(&self.mmap[start..start + entry.length as usize])
     }
 
     /// Check if a blob exists in this packfile
     pub fn contains(&self, hash: &Blake3Hash) -> bool {
-        self.index.contains_key(hash)
+        self.find(hash).is_some()
     }
 
     /// Get packfile path
@@ -176,80 +267,115 @@ impl PackReader {
 
     /// Get number of blobs in the packfile
     pub fn len(&self) -> usize {
-        self.index.len()
+        self.header.entry_count as usize
     }
 
     /// Check if packfile is empty
     pub fn is_empty(&self) -> bool {
-        self.index.is_empty()
+        self.header.entry_count == 0
     }
 
-    /// Iterate over all hashes in the packfile
+    /// Iterate over all hashes in the packfile (in hash order)
     pub fn hashes(&self) -> impl Iterator<Item = &Blake3Hash> {
-        self.index.keys()
+        (0..self.len()).map(|i| <&Blake3Hash>::try_from(&self.entry_bytes(i)[..32]).unwrap())
     }
 }
 
 /// Builder for creating new packfiles
+///
+/// Blobs are streamed to a temp file next to the output in the order they
+/// are added; `finish` appends the index and renames it into place, so a
+/// pack being read (or mapped by a running process) is never half-written.
 pub struct PackWriter {
     output_path: PathBuf,
+    temp_path: PathBuf,
+    writer: BufWriter<File>,
     entries: Vec<PackIndexEntry>,
-    data: Vec<u8>,
+    seen: HashSet<Blake3Hash>,
+    data_len: u64,
 }
 
 impl PackWriter {
     /// Create a new packfile writer
-    pub fn new<P: AsRef<Path>>(output_path: P) -> Self {
-        Self {
-            output_path: output_path.as_ref().to_path_buf(),
+    pub fn create<P: AsRef<Path>>(output_path: P) -> Result<Self> {
+        let output_path = output_path.as_ref().to_path_buf();
+        let mut temp_name = output_path.file_name().unwrap_or_default().to_os_string();
+        temp_name.push(format!(".{}.tmp", std::process::id()));
+        let temp_path = output_path.with_file_name(temp_name);
+
+        let mut writer = BufWriter::new(File::create(&temp_path)?);
+        // Reserve space for header (written by finish)
+        writer.write_all(&[0u8; PACK_HEADER_SIZE])?;
+        Ok(Self {
+            output_path,
+            temp_path,
+            writer,
             entries: Vec::new(),
-            data: Vec::new(),
-        }
+            seen: HashSet::new(),
+            data_len: 0,
+        })
     }
 
-    /// Add a blob to the packfile
-    pub fn add(&mut self, hash: Blake3Hash, data: &[u8]) {
-        let offset = self.data.len() as u64;
-        let length = data.len() as u64;
-
+    /// Add a blob to the packfile (a hash already added is skipped)
+    pub fn add(&mut self, hash: Blake3Hash, data: &[u8]) -> Result<()> {
+        if !self.seen.insert(hash) {
+            return Ok(());
+        }
+        self.writer.write_all(data)?;
         self.entries.push(PackIndexEntry {
             hash,
-            offset,
-            length,
+            offset: self.data_len,
+            length: data.len() as u64,
         });
-
-        self.data.extend_from_slice(data);
+        self.data_len += data.len() as u64;
+        Ok(())
     }
 
     /// Write the packfile to disk
-    pub fn finish(self) -> Result<PathBuf> {
-        let file = File::create(&self.output_path)?;
-        let mut writer = BufWriter::new(file);
-
-        // Reserve space for header (will write at end)
-        let header_size = 32u64;
-        writer.write_all(&[0u8; 32])?;
-
-        // Write index
-        let index_offset = header_size;
-        let index_bytes = rkyv::to_bytes::<rkyv::rancor::Error>(&self.entries)
-            .map_err(|e| PackError::Rkyv(e.to_string()))?;
-        writer.write_all(&index_bytes)?;
+    pub fn finish(mut self) -> Result<PathBuf> {
+        match self.write_index() {
+            Ok(()) => {
+                fs::rename(&self.temp_path, &self.output_path)?;
+                Ok(self.output_path)
+            }
+            Err(e) => {
+                let _ = fs::remove_file(&self.temp_path);
+                Err(e)
+            }
+        }
+    }
 
-        // Write data
-        let data_offset = header_size + index_bytes.len() as u64;
-        writer.write_all(&self.data)?;
+    fn write_index(&mut self) -> Result<()> {
+        self.entries.sort_unstable_by(|a, b| a.hash.cmp(&b.hash));
 
-        // Write header at beginning
-        let header = PackHeader::new(self.entries.len() as u32, index_offset, data_offset);
-        let header_bytes = rkyv::to_bytes::<rkyv::rancor::Error>(&header)
-            .map_err(|e| PackError::Rkyv(e.to_string()))?;
+        let mut fanout = [0u32; 256];
+        for entry in &self.entries {
+            fanout[entry.hash[0] as usize] += 1;
+        }
+        for i in 1..256 {
+            fanout[i] += fanout[i - 1];
+        }
 
-        writer.seek(SeekFrom::Start(0))?;
-        writer.write_all(&header_bytes)?;
+        let fanout_offset = PACK_HEADER_SIZE as u64 + self.data_len;
+        for count in fanout {
+            self.writer.write_all(&count.to_le_bytes())?;
+        }
+        for entry in &self.entries {
+            self.writer.write_all(&entry.encode())?;
+        }
 
-        writer.flush()?;
-        Ok(self.output_path)
+        let header = PackHeader {
+            entry_count: self.entries.len() as u32,
+            data_offset: PACK_HEADER_SIZE as u64,
+            data_len: self.data_len,
+            fanout_offset,
+            index_offset: fanout_offset + PACK_FANOUT_SIZE as u64,
+        };
+        self.writer.seek(SeekFrom::Start(0))?;
+        self.writer.write_all(&header.encode())?;
+        self.writer.flush()?;
+        self.writer.get_ref().sync_all()?;
+        Ok(())
     }
 }
 
@@ -290,6 +416,70 @@ impl AccessProfile {
             .map_err(|e| PackError::Rkyv(e.to_string()))?;
         Ok(profile)
     }
+
+    /// Build a profile from access traces written by the inception layer
+    /// (`VRIFT_ACCESS_PROFILE`): records from every traced process, merged
+    /// by time, each blob placed at its first access.
+    pub fn from_traces<'a>(traces: impl IntoIterator<Item = &'a [u8]>) -> Self {
+        let mut records: Vec<(u64, Blake3Hash)> = traces
+            .into_iter()
+            .flat_map(|trace| trace.chunks_exact(TRACE_RECORD_SIZE))
+            .map(|rec| (read_u64(rec, 0), rec[8..].try_into().unwrap()))
+            .collect();
+        records.sort_by_key(|&(time, _)| time);
+
+        let mut seen = HashSet::with_capacity(records.len());
+        Self {
+            access_order: records
+                .into_iter()
+                .filter(|(_, hash)| seen.insert(*hash))
+                .map(|(_, hash)| hash)
+                .collect(),
+        }
+    }
+}
+
+/// One access-trace record: first-access time (CLOCK_MONOTONIC ns, u64 LE)
+/// followed by the blob hash
+pub const TRACE_RECORD_SIZE: usize = 40;
+
+/// What `build_pack` put into a pack
+#[derive(Debug, Default, Clone, Copy, PartialEq, Eq)]
+pub struct PackStats {
+    pub blobs: usize,
+    pub bytes: u64,
+    /// Profiled blobs left out: missing from the CAS, empty, or too large
+    pub skipped: usize,
+}
+
+/// Write the blobs of `profile` (up to `max_blob` bytes each) from `cas`
+/// into a pack at `output`, laid out in access order so a cold start
+/// replaying the profile reads the pack front to back.
+pub fn build_pack<P: AsRef<Path>>(
+    cas: &CasStore,
+    profile: &AccessProfile,
+    output: P,
+    max_blob: u64,
+) -> Result<PackStats> {
+    let mut writer = PackWriter::create(output)?;
+    let mut stats = PackStats::default();
+
+    for hash in &profile.access_order {
+        let blob = match cas.get_mmap(hash) {
+            Ok(map) if !map.is_empty() && map.len() as u64 <= max_blob => map,
+            Ok(_) | Err(vrift_cas::CasError::NotFound { .. }) => {
+                stats.skipped += 1;
+                continue;
+            }
+            Err(e) => return Err(e.into()),
+        };
+        writer.add(*hash, &blob)?;
+        stats.blobs += 1;
+        stats.bytes += blob.len() as u64;
+    }
+
+    writer.finish()?;
+    Ok(stats)
 }
 
 #[cfg(test)]
@@ -304,15 +494,16 @@ mod tests {
         let pack_path = temp.path().join("test.pack");
 
         // Create packfile
-        let mut writer = PackWriter::new(&pack_path);
+        let mut writer = PackWriter::create(&pack_path).unwrap();
 
         let data1 = b"Hello, world!";
         let data2 = b"Goodbye, world!";
         let hash1 = CasStore::compute_hash(data1);
         let hash2 = CasStore::compute_hash(data2);
 
-        writer.add(hash1, data1);
-        writer.add(hash2, data2);
+        writer.add(hash1, data1).unwrap();
+        writer.add(hash2, data2).unwrap();
+        writer.add(hash1, data1).unwrap(); // Duplicate - should be ignored
         writer.finish().unwrap();
 
         // Read packfile
@@ -346,4 +537,72 @@ mod tests {
         let loaded = AccessProfile::load(&profile_path).unwrap();
         assert_eq!(loaded.access_order.len(), 2);
     }
+
+    #[test]
+    fn test_index_lookup_in_place() {
+        let temp = TempDir::new().unwrap();
+        let pack_path = temp.path().join("many.pack");
+
+        let blobs: Vec<Vec<u8>> = (0..2000u32)
+            .map(|i| format!("blob number {}", i).into_bytes())
+            .collect();
+        let mut writer = PackWriter::create(&pack_path).unwrap();
+        for blob in &blobs {
+            writer.add(CasStore::compute_hash(blob), blob).unwrap();
+        }
+        writer.finish().unwrap();
+
+        let reader = PackReader::open(&pack_path).unwrap();
+        assert_eq!(reader.len(), blobs.len());
+        for blob in &blobs {
+            assert_eq!(
+                reader.get(&CasStore::compute_hash(blob)).unwrap(),
+                &blob[..]
+            );
+        }
+        assert!(!reader.contains(&[0u8; 32]));
+        assert!(!reader.contains(&[0xffu8; 32]));
+        let hashes: Vec<_> = reader.hashes().collect();
+        assert!(hashes.windows(2).all(|w| w[0] < w[1]));
+
+        // Corrupt fanout is rejected at open
+        let mut bytes = fs::read(&pack_path).unwrap();
+        let fanout_offset = read_u64(&bytes, 32) as usize;
+        bytes[fanout_offset + 255 * 4] ^= 1;
+        fs::write(&pack_path, &bytes).unwrap();
+        assert!(PackReader::open(&pack_path).is_err());
+    }
+
+    #[test]
+    fn test_build_pack_in_first_access_order() {
+        let temp = TempDir::new().unwrap();
+        let cas = CasStore::new(temp.path().join("cas")).unwrap();
+        let a = cas.store(b"first touched").unwrap();
+        let b = cas.store(b"second touched").unwrap();
+        let big = cas.store(&[7u8; 4096]).unwrap();
+
+        // Two processes; `b` is first seen by the second one
+        let record = |time: u64, hash: &Blake3Hash| {
+            let mut rec = time.to_le_bytes().to_vec();
+            rec.extend_from_slice(hash);
+            rec
+        };
+        let trace1 = [record(10, &a), record(30, &big), record(40, &b)].concat();
+        let trace2 = [record(20, &b), record(25, &a), record(50, &[9u8; 32])].concat();
+        let profile = AccessProfile::from_traces([&trace1[..], &trace2[..]]);
+        assert_eq!(profile.access_order, vec![a, b, big, [9u8; 32]]);
+
+        let pack_path = temp.path().join("hot.pack");
+        let stats = build_pack(&cas, &profile, &pack_path, 1024).unwrap();
+        assert_eq!(stats.blobs, 2);
+        assert_eq!(stats.skipped, 2); // Too large, and not in the CAS
+
+        let reader = PackReader::open(&pack_path).unwrap();
+        assert_eq!(reader.find(&a).unwrap().offset, 0);
+        assert_eq!(
+            reader.find(&b).unwrap().offset,
+            b"first touched".len() as u64
+        );
+        assert_eq!(reader.get(&b).unwrap(), b"second touched");
+    }
 }
@@ -7,12 +7,17 @@
 //! - OverlayFS mounting (Linux only)
 //! - Namespace isolation (Linux only)
 
+use std::collections::{HashMap, HashSet};
+use std::ffi::{CStr, CString};
 use std::fs;
+use std::os::fd::{AsRawFd, RawFd};
+use std::os::unix::ffi::OsStrExt;
 use std::path::{Path, PathBuf};
+use std::sync::atomic::{AtomicBool, AtomicUsize, Ordering};
 
 use thiserror::Error;
 use vrift_cas::CasStore;
-use vrift_manifest::Manifest;
+use vrift_manifest::{Manifest, VnodeEntry};
 
 #[derive(Error, Debug)]
 pub enum RuntimeError {
@@ -45,11 +50,20 @@ use nix::mount::{mount, MsFlags};
 /// LowerDir for OverlayFS.
 pub struct LinkFarm {
     cas: CasStore,
+    // Worker threads for `populate_parallel`
+    threads: usize,
 }
 
 impl LinkFarm {
     pub fn new(cas: CasStore) -> Self {
-        Self { cas }
+        let threads = std::thread::available_parallelism().map_or(4, |n| n.get());
+        Self { cas, threads }
+    }
+
+    /// Set the worker thread count for `populate_parallel`
+    pub fn with_threads(mut self, threads: usize) -> Self {
+        self.threads = threads.max(1);
+        self
     }
 
     /// Populate the target directory with hard links based on one or more manifests.
@@ -153,6 +167,243 @@ impl LinkFarm {
         }
         Ok(())
     }
+
+    /// Parallel variant of [`populate`](Self::populate) for large farms.
+    ///
+    /// The manifests are merged first (later ones win), so every path is
+    /// written once. Directories are created one depth level at a time,
+    /// each level spread over the worker threads; files are then grouped by
+    /// parent directory and linked with `linkat` relative to one dirfd per
+    /// directory. Blob paths are derived from hash and size instead of
+    /// probing the CAS directory; the probe is only a fallback for blobs
+    /// stored under another name (chunk lists).
+    pub fn populate_parallel(&self, manifests: &[Manifest], target: &Path) -> Result<()> {
+        fs::create_dir_all(target)?;
+
+        let mut merged: HashMap<&str, &VnodeEntry> = HashMap::new();
+        for manifest in manifests {
+            for (path_str, entry) in manifest.iter() {
+                let relative = path_str.trim_matches('/');
+                if !relative.is_empty() {
+                    merged.insert(relative, entry);
+                }
+            }
+        }
+
+        // Every directory, explicit or implied by a parent, once
+        let mut dirs: HashSet<&str> = HashSet::new();
+        let mut by_parent: HashMap<&str, Vec<(&str, &VnodeEntry)>> = HashMap::new();
+        for (&relative, &entry) in &merged {
+            let (parent, name) = relative.rsplit_once('/').unwrap_or(("", relative));
+            let mut ancestor = if entry.is_dir() { relative } else { parent };
+            while !ancestor.is_empty() && dirs.insert(ancestor) {
+                ancestor = ancestor.rsplit_once('/').map_or("", |(up, _)| up);
+            }
+            if entry.is_file() || entry.is_symlink() {
+                by_parent.entry(parent).or_default().push((name, entry));
+            }
+        }
+
+        let mut levels: Vec<Vec<&str>> = Vec::new();
+        for dir in dirs {
+            let depth = dir.matches('/').count();
+            if levels.len() <= depth {
+                levels.resize_with(depth + 1, Vec::new);
+            }
+            levels[depth].push(dir);
+        }
+
+        let root = fs::File::open(target)?;
+        let root_fd = root.as_raw_fd();
+
+        for level in &levels {
+            self.run_sharded(level, |dir| match at::mkdir(root_fd, &c_path(dir)?) {
+                Err(e) if e.kind() == std::io::ErrorKind::AlreadyExists => Ok(()),
+                result => result.map_err(RuntimeError::Io),
+            })?;
+        }
+
+        let groups: Vec<_> = by_parent.into_iter().collect();
+        self.run_sharded(&groups, |(parent, entries)| {
+            let dir = if parent.is_empty() {
+                None
+            } else {
+                Some(at::open_dir(root_fd, &c_path(parent)?)?)
+            };
+            let dir_fd = dir.as_ref().map_or(root_fd, |d| d.as_raw_fd());
+            for &(name, entry) in entries {
+                let name = c_path(name)?;
+                if entry.is_file() {
+                    self.link_blob(entry, dir_fd, &name, target, parent)?;
+                } else {
+                    let target_bytes = self.cas.get(&entry.content_hash)?;
+                    let link_target = CString::new(target_bytes).map_err(|_| {
+                        RuntimeError::Overlay("Invalid symlink target in CAS".into())
+                    })?;
+                    replacing(dir_fd, &name, || at::symlink(&link_target, dir_fd, &name))?;
+                }
+            }
+            Ok(())
+        })
+    }
+
+    /// Hard link one file entry into `dir_fd` (symlink across devices)
+    fn link_blob(
+        &self,
+        entry: &VnodeEntry,
+        dir_fd: RawFd,
+        name: &CStr,
+        target: &Path,
+        parent: &str,
+    ) -> Result<()> {
+        let hash = &entry.content_hash;
+        // Guess the name before listing the shard: `.bin` (ingest, remote
+        // fetch, materialized copies), then the bare `store_by_move` name
+        let mut src = PathBuf::new();
+        let mut linked = Err(std::io::ErrorKind::NotFound.into());
+        for ext in ["bin", ""] {
+            src = self.cas.blob_path_with_metadata(hash, entry.size, ext);
+            linked = replacing(dir_fd, name, || at::link(&c_path(&src)?, dir_fd, name));
+            if !is_not_found(&linked) {
+                break;
+            }
+        }
+        if is_not_found(&linked) {
+            src = self
+                .cas
+                .blob_path_for_hash(hash)
+                .ok_or_else(|| RuntimeError::BlobNotFound(format!("{:?}", hash)))?;
+            linked = replacing(dir_fd, name, || at::link(&c_path(&src)?, dir_fd, name));
+        }
+        match linked {
+            Ok(()) => {}
+            // Fallback to symlink if hard link fails with EPERM or EXDEV
+            Err(e)
+                if e.kind() == std::io::ErrorKind::PermissionDenied
+                    || e.raw_os_error() == Some(libc::EXDEV) =>
+            {
+                tracing::debug!(
+                    "Hard link failed (EPERM/EXDEV), falling back to symlink: {}",
+                    src.display()
+                );
+                replacing(dir_fd, name, || at::symlink(&c_path(&src)?, dir_fd, name))?;
+            }
+            Err(e) => return Err(RuntimeError::Io(e)),
+        }
+
+        if let Err(e) = at::chmod(dir_fd, name, entry.mode) {
+            tracing::warn!(
+                "Failed to set permissions on {}: {}",
+                target
+                    .join(parent)
+                    .join(name.to_string_lossy().as_ref())
+                    .display(),
+                e
+            );
+        }
+        Ok(())
+    }
+
+    /// Run `work` over `items` on up to `self.threads` threads, stopping at
+    /// the first error
+    fn run_sharded<T, F>(&self, items: &[T], work: F) -> Result<()>
+    where
+        T: Sync,
+        F: Fn(&T) -> Result<()> + Sync,
+    {
+        let threads = self.threads.min(items.len()).max(1);
+        let next = AtomicUsize::new(0);
+        let failed = AtomicBool::new(false);
+        let worker = || -> Result<()> {
+            while !failed.load(Ordering::Relaxed) {
+                let Some(item) = items.get(next.fetch_add(1, Ordering::Relaxed)) else {
+                    break;
+                };
+                if let Err(e) = work(item) {
+                    failed.store(true, Ordering::Relaxed);
+                    return Err(e);
+                }
+            }
+            Ok(())
+        };
+        if threads == 1 {
+            return worker();
+        }
+        std::thread::scope(|scope| {
+            let handles: Vec<_> = (0..threads).map(|_| scope.spawn(worker)).collect();
+            handles
+                .into_iter()
+                .try_for_each(|h| h.join().expect("link farm worker panicked"))
+        })
+    }
+}
+
+fn is_not_found(result: &std::io::Result<()>) -> bool {
+    matches!(result, Err(e) if e.kind() == std::io::ErrorKind::NotFound)
+}
+
+/// Run `create`, replacing an existing non-directory entry `name` on EEXIST
+fn replacing<F>(dir_fd: RawFd, name: &CStr, create: F) -> std::io::Result<()>
+where
+    F: Fn() -> std::io::Result<()>,
+{
+    match create() {
+        Err(e) if e.kind() == std::io::ErrorKind::AlreadyExists => {
+            at::unlink(dir_fd, name)?;
+            create()
+        }
+        result => result,
+    }
+}
+
+fn c_path<P: AsRef<std::ffi::OsStr> + ?Sized>(path: &P) -> std::io::Result<CString> {
+    CString::new(path.as_ref().as_bytes())
+        .map_err(|e| std::io::Error::new(std::io::ErrorKind::InvalidInput, e))
+}
+
+/// `*at` syscalls for the parallel link farm
+mod at {
+    use std::ffi::CStr;
+    use std::io;
+    use std::os::fd::{FromRawFd, OwnedFd, RawFd};
+
+    fn check(ret: libc::c_int) -> io::Result<()> {
+        if ret == 0 {
+            Ok(())
+        } else {
+            Err(io::Error::last_os_error())
+        }
+    }
+
+    pub fn open_dir(dir_fd: RawFd, path: &CStr) -> io::Result<OwnedFd> {
+        let flags = libc::O_RDONLY | libc::O_DIRECTORY | libc::O_CLOEXEC;
+        let fd = unsafe { libc::openat(dir_fd, path.as_ptr(), flags) };
+        if fd < 0 {
+            return Err(io::Error::last_os_error());
+        }
+        // Safety: fd was just returned by openat and is owned by nobody else
+        Ok(unsafe { OwnedFd::from_raw_fd(fd) })
+    }
+
+    pub fn mkdir(dir_fd: RawFd, path: &CStr) -> io::Result<()> {
+        check(unsafe { libc::mkdirat(dir_fd, path.as_ptr(), 0o777) })
+    }
+
+    pub fn link(src: &CStr, dir_fd: RawFd, name: &CStr) -> io::Result<()> {
+        check(unsafe { libc::linkat(libc::AT_FDCWD, src.as_ptr(), dir_fd, name.as_ptr(), 0) })
+    }
+
+    pub fn symlink(target: &CStr, dir_fd: RawFd, name: &CStr) -> io::Result<()> {
+        check(unsafe { libc::symlinkat(target.as_ptr(), dir_fd, name.as_ptr()) })
+    }
+
+    pub fn unlink(dir_fd: RawFd, name: &CStr) -> io::Result<()> {
+        check(unsafe { libc::unlinkat(dir_fd, name.as_ptr(), 0) })
+    }
+
+    pub fn chmod(dir_fd: RawFd, name: &CStr, mode: u32) -> io::Result<()> {
+        check(unsafe { libc::fchmodat(dir_fd, name.as_ptr(), mode as libc::mode_t, 0) })
+    }
 }
 
 /// OverlayFS Manager (Linux only)
@@ -451,4 +702,81 @@ mod tests {
             app_content
         );
     }
+
+    #[test]
+    fn test_link_farm_populate_parallel() {
+        let temp = TempDir::new().unwrap();
+        let cas = CasStore::new(temp.path().join("cas")).unwrap();
+        let lower = temp.path().join("lower");
+
+        let old = cas.store(b"old").unwrap();
+        let new = cas.store(b"new").unwrap();
+        let link = cas.store(b"../lib/libz.so").unwrap();
+
+        let mut base = Manifest::new();
+        base.insert("/bin/tool", VnodeEntry::new_file(old, 3, 0, 0o755));
+        base.insert("/usr/share/empty", VnodeEntry::new_directory(0, 0o755));
+        base.insert("/usr/share/docs", VnodeEntry::new_directory(0, 0o755));
+        base.insert(
+            "/usr/share/docs/README",
+            VnodeEntry::new_file(old, 3, 0, 0o644),
+        );
+        let mut app = Manifest::new();
+        app.insert("/bin/tool", VnodeEntry::new_file(new, 3, 0, 0o755));
+        app.insert("/lib/libz.so", VnodeEntry::new_file(new, 3, 0, 0o644));
+        app.insert("/bin/libz", VnodeEntry::new_symlink(link, 14, 0));
+        for i in 0..200 {
+            app.insert(
+                &format!("/deep/{}/{}/f{}", i % 7, i % 3, i),
+                VnodeEntry::new_file(old, 3, 0, 0o644),
+            );
+        }
+
+        // Pre-existing file is replaced
+        fs::create_dir_all(lower.join("bin")).unwrap();
+        fs::write(lower.join("bin/tool"), b"stale").unwrap();
+
+        let farm = LinkFarm::new(cas).with_threads(4);
+        farm.populate_parallel(&[base, app], &lower).unwrap();
+
+        assert_eq!(fs::read(lower.join("bin/tool")).unwrap(), b"new");
+        assert_eq!(fs::read(lower.join("bin/libz")).unwrap(), b"new");
+        assert_eq!(
+            fs::read_link(lower.join("bin/libz")).unwrap(),
+            PathBuf::from("../lib/libz.so")
+        );
+        assert!(lower.join("usr/share/empty").is_dir());
+        assert_eq!(
+            fs::read(lower.join("usr/share/docs/README")).unwrap(),
+            b"old"
+        );
+        assert_eq!(fs::read(lower.join("deep/4/2/f11")).unwrap(), b"old");
+    }
+
+    #[test]
+    fn test_link_farm_links_ingested_bin_blob() {
+        use std::os::unix::fs::MetadataExt;
+
+        let temp = TempDir::new().unwrap();
+        let cas_root = temp.path().join("cas");
+        let cas = CasStore::new(&cas_root).unwrap();
+        let source = temp.path().join("libfoo.so");
+        fs::write(&source, b"ingested object").unwrap();
+        let ingested = vrift_cas::ingest_solid_tier2(&source, &cas_root).unwrap();
+        let blob = cas.blob_path_with_metadata(&ingested.hash, ingested.size, "bin");
+        assert!(blob.exists(), "ingest writes hash_size.bin");
+
+        let mut manifest = Manifest::new();
+        manifest.insert(
+            "/lib/libfoo.so",
+            VnodeEntry::new_file(ingested.hash, ingested.size, 0, 0o644),
+        );
+        let lower = temp.path().join("lower");
+        LinkFarm::new(cas)
+            .populate_parallel(&[manifest], &lower)
+            .unwrap();
+
+        let linked = fs::metadata(lower.join("lib/libfoo.so")).unwrap();
+        assert_eq!(linked.ino(), fs::metadata(&blob).unwrap().ino());
+    }
 }
@@ -0,0 +1,387 @@
+//! Coalescing stage between the event producers (FS watch, compensation
+//! scan) and the ingest workers
+//!
+//! A `git checkout` or `cargo build` reports the same path many times
+//! (create, several modifies, a rename). Events are folded into one pending
+//! state per path, keyed by path hash, and a path is released once it has
+//! been quiet for the debounce window, or has been pending for `max_defer`
+//! so a file written continuously is still ingested. Handlers re-read the
+//! filesystem, so only the latest state of a path matters.
+//!
+//! At most one event per path is with the workers at a time: a path released
+//! while its previous event is still being ingested is parked until the
+//! consumer reports that event `complete`, so a path is never ingested
+//! concurrently with itself or out of order.
+
+use std::collections::{HashMap, HashSet, VecDeque};
+use std::path::{Path, PathBuf};
+use std::sync::atomic::{AtomicU64, Ordering};
+use std::time::{Duration, Instant};
+
+use crate::vdir::fnv1a_hash;
+use crate::watch::IngestEvent;
+
+/// Pipeline counters, shared with whoever reports them
+#[derive(Debug, Default)]
+pub struct IngestMetrics {
+    received: AtomicU64,
+    coalesced: AtomicU64,
+    emitted: AtomicU64,
+    completed: AtomicU64,
+    pending: AtomicU64,
+    peak_pending: AtomicU64,
+    in_flight: AtomicU64,
+}
+
+/// Snapshot of `IngestMetrics`
+#[derive(Debug, Clone, Copy, Default, PartialEq, Eq)]
+pub struct IngestStats {
+    /// Events received from producers
+    pub received: u64,
+    /// Events folded into an already-pending path
+    pub coalesced: u64,
+    /// Paths handed to the workers
+    pub emitted: u64,
+    /// Paths the workers finished
+    pub completed: u64,
+    /// Paths waiting out their debounce window
+    pub pending: u64,
+    /// Highest `pending` seen
+    pub peak_pending: u64,
+    /// Paths being ingested right now (backpressure: equals the pool size
+    /// while the workers are saturated)
+    pub in_flight: u64,
+}
+
+impl IngestMetrics {
+    pub fn get_stats(&self) -> IngestStats {
+        IngestStats {
+            received: self.received.load(Ordering::Relaxed),
+            coalesced: self.coalesced.load(Ordering::Relaxed),
+            emitted: self.emitted.load(Ordering::Relaxed),
+            completed: self.completed.load(Ordering::Relaxed),
+            pending: self.pending.load(Ordering::Relaxed),
+            peak_pending: self.peak_pending.load(Ordering::Relaxed),
+            in_flight: self.in_flight.load(Ordering::Relaxed),
+        }
+    }
+
+    pub(crate) fn worker_started(&self) {
+        self.in_flight.fetch_add(1, Ordering::Relaxed);
+    }
+
+    pub(crate) fn worker_finished(&self) {
+        self.in_flight.fetch_sub(1, Ordering::Relaxed);
+        self.completed.fetch_add(1, Ordering::Relaxed);
+    }
+}
+
+struct Pending {
+    event: IngestEvent,
+    first_seen: Instant,
+    last_seen: Instant,
+}
+
+/// Per-path latest-state map with a debounce window
+pub struct Coalescer {
+    pending: HashMap<u64, Pending>,
+    /// (key, time) per push, oldest first. An entry touched again later has
+    /// newer markers; its stale ones are skipped.
+    order: VecDeque<(u64, Instant)>,
+    /// Released early (hash collision with a different pending path, or
+    /// unparked by `complete`)
+    ready: Vec<IngestEvent>,
+    /// Paths handed out whose event has not completed yet
+    in_flight: HashSet<PathBuf>,
+    /// Latest released event per in-flight path, held until it completes
+    parked: HashMap<PathBuf, IngestEvent>,
+    debounce: Duration,
+    max_defer: Duration,
+}
+
+impl Coalescer {
+    pub fn new(debounce: Duration, max_defer: Duration) -> Self {
+        Self {
+            pending: HashMap::new(),
+            order: VecDeque::new(),
+            ready: Vec::new(),
+            in_flight: HashSet::new(),
+            parked: HashMap::new(),
+            debounce,
+            max_defer: max_defer.max(debounce),
+        }
+    }
+
+    /// Fold an event into its path's pending state (latest wins)
+    pub fn push(&mut self, event: IngestEvent, now: Instant, metrics: &IngestMetrics) {
+        metrics.received.fetch_add(1, Ordering::Relaxed);
+        let key = fnv1a_hash(&event_path(&event).to_string_lossy());
+        self.order.push_back((key, now));
+
+        if let Some(pending) = self.pending.get_mut(&key) {
+            if event_path(&pending.event) == event_path(&event) {
+                pending.event = event;
+                pending.last_seen = now;
+                metrics.coalesced.fetch_add(1, Ordering::Relaxed);
+                return;
+            }
+            // Hash collision with another pending path: release that one now
+            if let Some(other) = self.pending.remove(&key) {
+                self.ready.push(other.event);
+            }
+        }
+        self.pending.insert(
+            key,
+            Pending {
+                event,
+                first_seen: now,
+                last_seen: now,
+            },
+        );
+        self.update_pending(metrics);
+    }
+
+    /// Release up to `max` paths whose window has closed
+    pub fn take_ready(
+        &mut self,
+        now: Instant,
+        max: usize,
+        metrics: &IngestMetrics,
+    ) -> Vec<IngestEvent> {
+        let mut out = Vec::new();
+        let mut ready = std::mem::take(&mut self.ready).into_iter();
+        while out.len() < max {
+            let Some(event) = ready.next() else {
+                break;
+            };
+            self.hand_out(event, &mut out, metrics);
+        }
+        self.ready.extend(ready);
+        while out.len() < max {
+            let Some(&(key, at)) = self.order.front() else {
+                break;
+            };
+            if now.saturating_duration_since(at) < self.debounce {
+                break;
+            }
+            self.order.pop_front();
+            let Some(pending) = self.pending.get(&key) else {
+                continue;
+            };
+            let quiet = pending.last_seen == at;
+            let overdue = now.saturating_duration_since(pending.first_seen) >= self.max_defer;
+            if quiet || overdue {
+                if let Some(pending) = self.pending.remove(&key) {
+                    self.hand_out(pending.event, &mut out, metrics);
+                }
+            }
+        }
+        metrics
+            .emitted
+            .fetch_add(out.len() as u64, Ordering::Relaxed);
+        self.update_pending(metrics);
+        out
+    }
+
+    /// Release everything still pending (producers are gone). Events for
+    /// in-flight paths stay parked; see `has_parked`.
+    pub fn take_all(&mut self, metrics: &IngestMetrics) -> Vec<IngestEvent> {
+        let mut events = std::mem::take(&mut self.ready);
+        self.order.clear();
+        events.extend(self.pending.drain().map(|(_, p)| p.event));
+        let mut out = Vec::with_capacity(events.len());
+        for event in events {
+            self.hand_out(event, &mut out, metrics);
+        }
+        metrics
+            .emitted
+            .fetch_add(out.len() as u64, Ordering::Relaxed);
+        self.update_pending(metrics);
+        out
+    }
+
+    /// The worker handling `path`'s event is done: the path is free again,
+    /// and its parked event (if any) is released immediately
+    pub fn complete(&mut self, path: &Path) {
+        self.in_flight.remove(path);
+        if let Some(event) = self.parked.remove(path) {
+            self.ready.push(event);
+        }
+    }
+
+    /// Events waiting for their path's in-flight event to complete
+    pub fn has_parked(&self) -> bool {
+        !self.parked.is_empty()
+    }
+
+    /// Hand `event` to the workers, or park it while its path is in flight
+    /// (latest wins)
+    fn hand_out(
+        &mut self,
+        event: IngestEvent,
+        out: &mut Vec<IngestEvent>,
+        metrics: &IngestMetrics,
+    ) {
+        let path = event_path(&event);
+        if self.in_flight.contains(path) {
+            if self.parked.insert(path.to_path_buf(), event).is_some() {
+                metrics.coalesced.fetch_add(1, Ordering::Relaxed);
+            }
+            return;
+        }
+        self.in_flight.insert(path.to_path_buf());
+        out.push(event);
+    }
+
+    /// Earliest time `take_ready` may return something
+    pub fn next_deadline(&self) -> Option<Instant> {
+        if !self.ready.is_empty() {
+            return Some(Instant::now());
+        }
+        self.order.front().map(|&(_, at)| at + self.debounce)
+    }
+
+    pub fn len(&self) -> usize {
+        self.pending.len() + self.ready.len() + self.parked.len()
+    }
+
+    pub fn is_empty(&self) -> bool {
+        self.len() == 0
+    }
+
+    fn update_pending(&self, metrics: &IngestMetrics) {
+        let pending = self.len() as u64;
+        metrics.pending.store(pending, Ordering::Relaxed);
+        metrics.peak_pending.fetch_max(pending, Ordering::Relaxed);
+    }
+}
+
+pub(crate) fn event_path(event: &IngestEvent) -> &Path {
+    match event {
+        IngestEvent::FileChanged { path }
+        | IngestEvent::DirCreated { path }
+        | IngestEvent::Removed { path }
+        | IngestEvent::SymlinkCreated { path, .. } => path,
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+    use std::path::PathBuf;
+
+    fn changed(path: &str) -> IngestEvent {
+        IngestEvent::FileChanged {
+            path: PathBuf::from(path),
+        }
+    }
+
+    #[test]
+    fn test_storm_on_one_path_emits_latest_once() {
+        let metrics = IngestMetrics::default();
+        let mut c = Coalescer::new(Duration::from_millis(100), Duration::from_secs(1));
+        let t0 = Instant::now();
+
+        for i in 0..50 {
+            c.push(changed("/p/a.rs"), t0 + Duration::from_millis(i), &metrics);
+        }
+        c.push(
+            IngestEvent::Removed {
+                path: PathBuf::from("/p/a.rs"),
+            },
+            t0 + Duration::from_millis(50),
+            &metrics,
+        );
+        c.push(changed("/p/b.rs"), t0 + Duration::from_millis(50), &metrics);
+        assert_eq!(c.len(), 2);
+
+        // Still inside the debounce window
+        assert!(c
+            .take_ready(t0 + Duration::from_millis(120), 16, &metrics)
+            .is_empty());
+
+        let out = c.take_ready(t0 + Duration::from_millis(150), 16, &metrics);
+        assert_eq!(out.len(), 2);
+        assert!(out
+            .iter()
+            .any(|e| matches!(e, IngestEvent::Removed { path } if path.ends_with("a.rs"))));
+        assert!(c.is_empty());
+
+        let stats = metrics.get_stats();
+        assert_eq!(stats.received, 52);
+        assert_eq!(stats.coalesced, 50);
+        assert_eq!(stats.emitted, 2);
+        assert_eq!(stats.pending, 0);
+        assert_eq!(stats.peak_pending, 2);
+    }
+
+    #[test]
+    fn test_continuously_written_path_released_after_max_defer() {
+        let metrics = IngestMetrics::default();
+        let mut c = Coalescer::new(Duration::from_millis(100), Duration::from_millis(500));
+        let t0 = Instant::now();
+
+        let mut released = None;
+        for i in 0..100u64 {
+            let now = t0 + Duration::from_millis(i * 10);
+            c.push(changed("/p/log.txt"), now, &metrics);
+            if !c.take_ready(now, 16, &metrics).is_empty() {
+                released = Some(i * 10);
+                break;
+            }
+        }
+        let at = released.expect("never released while written");
+        assert!((500..600).contains(&at), "released at {}ms", at);
+    }
+
+    #[test]
+    fn test_take_ready_respects_batch_limit() {
+        let metrics = IngestMetrics::default();
+        let mut c = Coalescer::new(Duration::from_millis(10), Duration::from_secs(1));
+        let t0 = Instant::now();
+        for i in 0..10 {
+            c.push(changed(&format!("/p/{}", i)), t0, &metrics);
+        }
+        let later = t0 + Duration::from_millis(20);
+        assert_eq!(c.take_ready(later, 4, &metrics).len(), 4);
+        assert_eq!(c.take_ready(later, 100, &metrics).len(), 6);
+        assert_eq!(c.next_deadline(), None);
+    }
+
+    #[test]
+    fn test_busy_path_is_parked_until_complete() {
+        let metrics = IngestMetrics::default();
+        let mut c = Coalescer::new(Duration::from_millis(10), Duration::from_secs(1));
+        let t0 = Instant::now();
+        let at = |ms| t0 + Duration::from_millis(ms);
+
+        c.push(changed("/p/a.rs"), at(0), &metrics);
+        assert_eq!(c.take_ready(at(20), 16, &metrics).len(), 1);
+
+        // Newer states of a.rs while its first event is being ingested
+        c.push(changed("/p/a.rs"), at(30), &metrics);
+        c.push(changed("/p/b.rs"), at(30), &metrics);
+        let out = c.take_ready(at(50), 16, &metrics);
+        assert_eq!(out.len(), 1, "only b.rs may run");
+        assert!(matches!(&out[0], IngestEvent::FileChanged { path } if path.ends_with("b.rs")));
+        c.push(
+            IngestEvent::Removed {
+                path: PathBuf::from("/p/a.rs"),
+            },
+            at(60),
+            &metrics,
+        );
+        assert!(c.take_ready(at(80), 16, &metrics).is_empty());
+        assert!(c.take_all(&metrics).is_empty());
+        assert!(c.has_parked());
+        assert_eq!(c.len(), 1);
+
+        // The first a.rs event completes: only the latest state follows
+        c.complete(Path::new("/p/a.rs"));
+        let out = c.take_ready(at(80), 16, &metrics);
+        assert_eq!(out.len(), 1);
+        assert!(matches!(&out[0], IngestEvent::Removed { path } if path.ends_with("a.rs")));
+        assert!(c.take_ready(at(200), 16, &metrics).is_empty());
+        assert!(c.is_empty());
+    }
+}
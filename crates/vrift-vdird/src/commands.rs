@@ -1,21 +1,51 @@
 //! Command handlers for vdir_d
 
-use crate::vdir::{fnv1a_hash, VDir, VDirEntry, FLAG_DIR};
+use crate::coalesce::IngestMetrics;
+use crate::dir_index::DirIndexBuilder;
+use crate::metrics::InceptionMetrics;
+use crate::prefetch::Prefetcher;
+use crate::vdir::{VDir, VDirEntry, VDirKey, FLAG_DIR};
 use crate::ProjectConfig;
 use anyhow::Result;
 use std::fs;
 use std::os::unix::fs::MetadataExt;
 use std::path::{Path, PathBuf};
+use std::sync::Arc;
 use tracing::{debug, error, info, warn};
+use vrift_ipc::metrics::PromText;
 use vrift_ipc::{
-    VeloError, VeloErrorKind, VeloRequest, VeloResponse, VnodeEntry, PROTOCOL_VERSION,
+    ReingestDelta, VeloError, VeloErrorKind, VeloRequest, VeloResponse, VnodeEntry,
+    MANIFEST_GET_MANY_MAX, PROTOCOL_VERSION,
 };
 
+/// Mutations applied per VDir write transaction by `handle_mutations`.
+/// Readers spin while one is open and fall back to IPC if it outlasts them.
+const MUTATION_WINDOW_MAX: usize = 32;
+
 /// Command handler for vdir_d
 pub struct CommandHandler {
     config: ProjectConfig,
     vdir: VDir,
     manifest: std::sync::Arc<vrift_manifest::lmdb::LmdbManifest>,
+    prefetch: Arc<Prefetcher>,
+    inception_metrics: Option<Arc<InceptionMetrics>>,
+    ingest_metrics: Option<Arc<IngestMetrics>>,
+    remote: Option<Arc<vrift_cas::RemoteCas>>,
+}
+
+/// VDir entry for an LMDB entry that is not in the overlay yet
+fn persisted_vdir_entry(key: VDirKey, vnode: VnodeEntry) -> VDirEntry {
+    VDirEntry {
+        path_hash: key.path_hash,
+        cas_hash: vnode.content_hash,
+        size: vnode.size,
+        mtime_sec: vnode.mtime as i64,
+        mtime_nsec: 0,
+        mode: vnode.mode,
+        flags: vnode.flags,
+        _pad: 0,
+        path_check: key.path_check,
+    }
 }
 
 impl CommandHandler {
@@ -24,13 +54,103 @@ impl CommandHandler {
         vdir: VDir,
         manifest: std::sync::Arc<vrift_manifest::lmdb::LmdbManifest>,
     ) -> Self {
+        let prefetch = Arc::new(Prefetcher::open(
+            &config.project_root.join(".vrift").join("prefetch.bin"),
+            &config.cas_path,
+        ));
         Self {
             config,
             vdir,
             manifest,
+            prefetch,
+            inception_metrics: None,
+            ingest_metrics: None,
+            remote: None,
         }
     }
 
+    /// Client counters exported by `VeloRequest::Metrics`
+    pub fn set_inception_metrics(&mut self, metrics: Arc<InceptionMetrics>) {
+        self.inception_metrics = Some(metrics);
+    }
+
+    pub fn inception_metrics(&self) -> Option<Arc<InceptionMetrics>> {
+        self.inception_metrics.clone()
+    }
+
+    /// Watch-ingest pipeline counters exported by `VeloRequest::Metrics`
+    pub fn set_ingest_metrics(&mut self, metrics: Arc<IngestMetrics>) {
+        self.ingest_metrics = Some(metrics);
+    }
+
+    /// Remote CAS tier over `cas_path`: blobs missing locally are fetched
+    /// from it, newly ingested ones pushed to it (`storage.remote_write_back`)
+    pub fn set_remote_cas(&mut self, remote: Arc<vrift_cas::RemoteCas>) {
+        self.remote = Some(remote);
+    }
+
+    /// TheSource, backed by the remote tier if there is one
+    pub fn cas_store(&self) -> vrift_cas::Result<vrift_cas::CasStore> {
+        let store = vrift_cas::CasStore::new(&self.config.cas_path)?;
+        Ok(match &self.remote {
+            Some(remote) => store.with_remote(Arc::clone(remote)),
+            None => store,
+        })
+    }
+
+    /// Push blobs this node just stored to the remote tier, in the background
+    fn write_back(&self, hashes: Vec<[u8; 32]>) {
+        if self.remote.is_none()
+            || hashes.is_empty()
+            || !vrift_config::config().storage.remote_write_back
+        {
+            return;
+        }
+        let Ok(store) = self.cas_store() else {
+            return;
+        };
+        tokio::task::spawn_blocking(move || {
+            let pushed = store.push(&hashes);
+            debug!(requested = hashes.len(), pushed, "Remote write-back");
+        });
+    }
+
+    /// True while the VDir is migrating entries after an incremental resize
+    pub fn vdir_migrating(&self) -> bool {
+        self.vdir.is_migrating()
+    }
+
+    /// Migrate one chunk of a pending VDir resize. Returns true while unfinished.
+    pub fn vdir_migrate_step(&mut self) -> bool {
+        self.vdir.migrate_step()
+    }
+
+    /// Shared manifest handle (for work done outside the handler lock)
+    pub fn manifest(&self) -> std::sync::Arc<vrift_manifest::lmdb::LmdbManifest> {
+        std::sync::Arc::clone(&self.manifest)
+    }
+
+    /// Learned access sequences (saved outside the handler lock)
+    pub fn prefetcher(&self) -> Arc<Prefetcher> {
+        Arc::clone(&self.prefetch)
+    }
+
+    /// Paths the VDir added or removed since open (each marked the
+    /// directory index stale as it applied)
+    pub fn vdir_dir_changes(&self) -> u64 {
+        self.vdir.dir_changes()
+    }
+
+    /// Stop clients serving readdir from the VDir until the next publish
+    pub fn mark_dir_index_stale(&mut self) -> bool {
+        self.vdir.mark_dir_index_stale()
+    }
+
+    /// Publish a directory index image built by `build_dir_index`
+    pub fn publish_dir_index(&mut self, image: &[u8], dir_changes: u64) -> Result<()> {
+        self.vdir.publish_dir_index(image, dir_changes)
+    }
+
     /// Handle incoming request
     pub async fn handle_request(&mut self, request: VeloRequest) -> VeloResponse {
         match request {
@@ -61,6 +181,8 @@ impl CommandHandler {
 
             VeloRequest::ManifestGet { path } => self.handle_manifest_get(&path),
 
+            VeloRequest::ManifestGetMany { paths } => self.handle_manifest_get_many(&paths),
+
             VeloRequest::ManifestUpsert { path, entry } => {
                 self.handle_manifest_upsert(&path, entry)
             }
@@ -68,18 +190,24 @@ impl CommandHandler {
             VeloRequest::ManifestRemove { path } => self.handle_manifest_remove(&path),
 
             VeloRequest::ManifestRename { old_path, new_path } => {
-                self.handle_manifest_rename(&old_path, &new_path)
+                let persisted = self.persisted_entry(&old_path);
+                self.handle_manifest_rename(&old_path, &new_path, persisted)
             }
 
             VeloRequest::ManifestUpdateMtime { path, mtime_ns } => {
-                self.handle_manifest_update_mtime(&path, mtime_ns)
+                let persisted = self.persisted_entry(&path);
+                self.handle_manifest_update_mtime(&path, mtime_ns, persisted)
             }
 
             VeloRequest::ManifestListDir { path } => self.handle_manifest_list_dir(&path),
 
-            VeloRequest::ManifestReingest { vpath, temp_path } => {
-                self.handle_reingest(&vpath, &temp_path).await
-            }
+            VeloRequest::ManifestReingest {
+                vpath,
+                temp_path,
+                delta,
+            } => self.handle_reingest(&vpath, &temp_path, delta).await,
+
+            VeloRequest::CasGet { hash } => cas_get(self.cas_store(), &hash),
 
             VeloRequest::IngestFullScan {
                 path,
@@ -103,6 +231,52 @@ impl CommandHandler {
                 .await
             }
 
+            VeloRequest::AccessTrace {
+                command,
+                cwd,
+                blobs,
+            } => {
+                let learned = self.prefetch.learn(&command, &cwd, &blobs);
+                // Blobs the inception layer opened by path bypass CasStore
+                // reads: this is the remote cache's record of their use
+                if let Some(remote) = &self.remote {
+                    for blob in &blobs {
+                        remote.touch(&blob.hash);
+                    }
+                }
+                VeloResponse::PrefetchAck {
+                    blobs: learned as u32,
+                }
+            }
+
+            VeloRequest::PrefetchHint { command, cwd } => {
+                let blobs = self
+                    .prefetch
+                    .hint(&command, &cwd, std::time::Instant::now());
+                let count = blobs.len() as u32;
+                if !blobs.is_empty() {
+                    debug!(command = %command, cwd = %cwd, count, "Prefetching");
+                    let prefetch = Arc::clone(&self.prefetch);
+                    let remote_store = self.remote.as_ref().and_then(|_| self.cas_store().ok());
+                    tokio::task::spawn_blocking(move || {
+                        // Blobs only the remote tier has arrive in one batch first
+                        if let Some(store) = remote_store {
+                            let hashes: Vec<_> = blobs.iter().map(|b| b.hash).collect();
+                            store.fetch_missing(&hashes);
+                            if let Some(remote) = store.remote() {
+                                hashes.iter().for_each(|hash| remote.touch(hash));
+                            }
+                        }
+                        prefetch.read_ahead(&blobs)
+                    });
+                }
+                VeloResponse::PrefetchAck { blobs: count }
+            }
+
+            VeloRequest::Metrics => VeloResponse::MetricsAck {
+                text: self.render_metrics(),
+            },
+
             // Not yet implemented - forward to future handlers
             _ => {
                 warn!(?request, "Unhandled request type");
@@ -111,54 +285,237 @@ impl CommandHandler {
         }
     }
 
+    /// Prometheus text for this project: client counters, VDir table,
+    /// prefetch and watch-ingest pipeline
+    fn render_metrics(&self) -> String {
+        let mut out = PromText::new();
+        if let Some(metrics) = &self.inception_metrics {
+            metrics.collect().render(&mut out);
+        }
+
+        let vdir = self.vdir.get_stats();
+        out.gauge(
+            "vrift_vdir_entries",
+            "Entries in the VDir table",
+            vdir.entry_count as f64,
+        );
+        out.gauge(
+            "vrift_vdir_capacity",
+            "VDir table slots",
+            vdir.capacity as f64,
+        );
+        out.gauge(
+            "vrift_vdir_load_factor",
+            "VDir table occupancy",
+            vdir.load_factor,
+        );
+        out.gauge(
+            "vrift_vdir_max_collision_chain",
+            "Longest VDir probe chain, in probe groups",
+            vdir.max_collision_chain as f64,
+        );
+        out.gauge(
+            "vrift_vdir_migration_pending",
+            "Old-table slots not yet migrated by an incremental resize",
+            vdir.migration_pending as f64,
+        );
+        out.counter(
+            "vrift_vdir_generation",
+            "VDir write generation",
+            vdir.generation,
+        );
+
+        let prefetch = self.prefetch.get_stats();
+        out.gauge(
+            "vrift_prefetch_sequences",
+            "Commands with a learned access sequence",
+            prefetch.sequences as f64,
+        );
+        out.counter(
+            "vrift_prefetch_hints_total",
+            "PrefetchHints received",
+            prefetch.hints,
+        );
+        out.counter(
+            "vrift_prefetch_blobs_total",
+            "Blobs handed to the kernel for readahead",
+            prefetch.prefetched,
+        );
+
+        if let Some(metrics) = &self.ingest_metrics {
+            let ingest = metrics.get_stats();
+            out.counter(
+                "vrift_ingest_events_total",
+                "Watch events received",
+                ingest.received,
+            );
+            out.counter(
+                "vrift_ingest_coalesced_total",
+                "Watch events folded into an already-pending path",
+                ingest.coalesced,
+            );
+            out.counter(
+                "vrift_ingest_completed_total",
+                "Paths the ingest workers finished",
+                ingest.completed,
+            );
+            out.gauge(
+                "vrift_ingest_pending",
+                "Paths waiting out their debounce window",
+                ingest.pending as f64,
+            );
+            out.gauge(
+                "vrift_ingest_in_flight",
+                "Paths being ingested",
+                ingest.in_flight as f64,
+            );
+        }
+        out.finish()
+    }
+
+    /// Apply a group of manifest mutations in VDir write transactions of up
+    /// to `MUTATION_WINDOW_MAX`, one generation bump each. LMDB lookups are
+    /// done before a transaction opens, so readers only wait out VDir
+    /// writes. Responses are positional.
+    ///
+    /// A response means the mutation is visible to readers of the VDir, not
+    /// that it is on disk: the VDir is a runtime overlay and is not synced.
+    pub fn handle_mutations(&mut self, requests: Vec<VeloRequest>) -> Vec<VeloResponse> {
+        let mut responses = Vec::with_capacity(requests.len());
+        let mut requests = requests.into_iter().peekable();
+        while requests.peek().is_some() {
+            let window: Vec<_> = requests
+                .by_ref()
+                .take(MUTATION_WINDOW_MAX)
+                .map(|request| {
+                    let persisted = self.persisted_for(&request);
+                    (request, persisted)
+                })
+                .collect();
+            self.vdir.begin_batch();
+            for (request, persisted) in window {
+                responses.push(self.handle_mutation(request, persisted));
+            }
+            self.vdir.end_batch();
+        }
+        responses
+    }
+
+    /// LMDB entry a mutation falls back to when the VDir misses
+    fn persisted_for(&self, request: &VeloRequest) -> Option<VnodeEntry> {
+        match request {
+            VeloRequest::ManifestRename { old_path, .. } => self.persisted_entry(old_path),
+            VeloRequest::ManifestUpdateMtime { path, .. } => self.persisted_entry(path),
+            _ => None,
+        }
+    }
+
+    /// LMDB entry for `path` (persistent storage under the VDir overlay)
+    fn persisted_entry(&self, path: &str) -> Option<VnodeEntry> {
+        match self.manifest.get(path) {
+            Ok(entry) => entry.map(|e| e.vnode),
+            Err(e) => {
+                warn!(path = %path, error = %e, "LMDB lookup failed");
+                None
+            }
+        }
+    }
+
+    /// Dispatch one fire-and-forget mutation (see `ring::is_ring_mutation`)
+    fn handle_mutation(
+        &mut self,
+        request: VeloRequest,
+        persisted: Option<VnodeEntry>,
+    ) -> VeloResponse {
+        match request {
+            VeloRequest::ManifestUpsert { path, entry } => {
+                self.handle_manifest_upsert(&path, entry)
+            }
+            VeloRequest::ManifestRemove { path } => self.handle_manifest_remove(&path),
+            VeloRequest::ManifestRename { old_path, new_path } => {
+                self.handle_manifest_rename(&old_path, &new_path, persisted)
+            }
+            VeloRequest::ManifestUpdateMtime { path, mtime_ns } => {
+                self.handle_manifest_update_mtime(&path, mtime_ns, persisted)
+            }
+            request => {
+                warn!(?request, "Not a manifest mutation");
+                VeloResponse::Error(VeloError::internal("Not a manifest mutation"))
+            }
+        }
+    }
+
     /// Handle ManifestGet
-    /// First checks VDir (runtime overlay for COW), then falls back to LMDB (persistent storage)
     fn handle_manifest_get(&self, path: &str) -> VeloResponse {
-        let path_hash = fnv1a_hash(path);
+        VeloResponse::ManifestAck {
+            entry: self.lookup_entry(path),
+        }
+    }
+
+    /// Handle ManifestGetMany: answer a burst of probes in one frame.
+    /// Results are positional; oversized batches are rejected.
+    fn handle_manifest_get_many(&self, paths: &[String]) -> VeloResponse {
+        if paths.len() > MANIFEST_GET_MANY_MAX {
+            return VeloResponse::Error(VeloError::internal(format!(
+                "ManifestGetMany: {} paths exceeds limit of {}",
+                paths.len(),
+                MANIFEST_GET_MANY_MAX
+            )));
+        }
+        let entries: Vec<_> = paths.iter().map(|p| self.lookup_entry(p)).collect();
+        debug!(
+            count = paths.len(),
+            found = entries.iter().filter(|e| e.is_some()).count(),
+            "ManifestGetMany"
+        );
+        VeloResponse::ManifestGetManyAck { entries }
+    }
 
+    /// Resolve one manifest path.
+    /// First checks VDir (runtime overlay for COW), then falls back to LMDB (persistent storage)
+    fn lookup_entry(&self, path: &str) -> Option<VnodeEntry> {
         // 1. First check VDir (runtime overlay for COW mutations)
-        if let Some(entry) = self.vdir.lookup(path_hash) {
-            let vnode = VnodeEntry {
+        if let Some(entry) = self.vdir.lookup(VDirKey::from_path(path)) {
+            return Some(VnodeEntry {
                 content_hash: entry.cas_hash,
                 size: entry.size,
                 mtime: entry.mtime_sec as u64,
                 mode: entry.mode,
                 flags: entry.flags,
                 _pad: 0,
-            };
-            return VeloResponse::ManifestAck { entry: Some(vnode) };
+            });
         }
 
         // 2. Fallback to LMDB (persistent storage)
         match self.manifest.get(path) {
             Ok(Some(entry)) => {
                 debug!(path = %path, "ManifestGet: found in LMDB");
-                VeloResponse::ManifestAck {
-                    entry: Some(entry.vnode),
-                }
+                Some(entry.vnode)
             }
             Ok(None) => {
                 debug!(path = %path, "ManifestGet: not found in VDir or LMDB");
-                VeloResponse::ManifestAck { entry: None }
+                None
             }
             Err(e) => {
                 warn!(path = %path, error = %e, "ManifestGet: LMDB lookup failed");
-                VeloResponse::ManifestAck { entry: None }
+                None
             }
         }
     }
 
     /// Handle ManifestUpsert
     fn handle_manifest_upsert(&mut self, path: &str, entry: VnodeEntry) -> VeloResponse {
+        let key = VDirKey::from_path(path);
         let vdir_entry = VDirEntry {
-            path_hash: fnv1a_hash(path),
+            path_hash: key.path_hash,
             cas_hash: entry.content_hash,
             size: entry.size,
             mtime_sec: entry.mtime as i64,
             mtime_nsec: 0,
             mode: entry.mode,
             flags: entry.flags,
-            _pad: [0; 3],
+            _pad: 0,
+            path_check: key.path_check,
         };
 
         match self.vdir.upsert(vdir_entry) {
@@ -175,8 +532,7 @@ impl CommandHandler {
 
     /// Handle ManifestRemove
     fn handle_manifest_remove(&mut self, path: &str) -> VeloResponse {
-        let path_hash = fnv1a_hash(path);
-        if self.vdir.mark_dirty(path_hash, false) {
+        if self.vdir.mark_removed(VDirKey::from_path(path)) {
             // For now, just clear dirty bit. Full deletion would require tombstone.
             debug!(path = %path, "Marked for removal");
             VeloResponse::ManifestAck { entry: None }
@@ -185,37 +541,32 @@ impl CommandHandler {
         }
     }
 
-    /// Handle ManifestRename: remove old path, upsert under new path
-    fn handle_manifest_rename(&mut self, old_path: &str, new_path: &str) -> VeloResponse {
-        let old_hash = fnv1a_hash(old_path);
-        let new_hash = fnv1a_hash(new_path);
+    /// Handle ManifestRename: remove old path, upsert under new path.
+    /// `persisted` is the LMDB entry of `old_path` (see `persisted_entry`).
+    fn handle_manifest_rename(
+        &mut self,
+        old_path: &str,
+        new_path: &str,
+        persisted: Option<VnodeEntry>,
+    ) -> VeloResponse {
+        let old_key = VDirKey::from_path(old_path);
+        let new_key = VDirKey::from_path(new_path);
 
         // Lookup old entry (VDir first, then LMDB)
-        let old_entry = if let Some(entry) = self.vdir.lookup(old_hash) {
-            Some(*entry)
-        } else if let Ok(Some(lmdb_entry)) = self.manifest.get(old_path) {
-            Some(VDirEntry {
-                path_hash: old_hash,
-                cas_hash: lmdb_entry.vnode.content_hash,
-                size: lmdb_entry.vnode.size,
-                mtime_sec: lmdb_entry.vnode.mtime as i64,
-                mtime_nsec: 0,
-                mode: lmdb_entry.vnode.mode,
-                flags: lmdb_entry.vnode.flags,
-                _pad: [0; 3],
-            })
-        } else {
-            None
+        let old_entry = match self.vdir.lookup(old_key) {
+            Some(entry) => Some(*entry),
+            None => persisted.map(|vnode| persisted_vdir_entry(old_key, vnode)),
         };
 
         match old_entry {
             Some(entry) => {
                 // Mark old path as removed
-                self.vdir.mark_dirty(old_hash, false);
+                self.vdir.mark_removed(old_key);
 
                 // Insert under new path hash
                 let new_entry = VDirEntry {
-                    path_hash: new_hash,
+                    path_hash: new_key.path_hash,
+                    path_check: new_key.path_check,
                     ..entry
                 };
                 match self.vdir.upsert(new_entry) {
@@ -236,28 +587,22 @@ impl CommandHandler {
         }
     }
 
-    /// Handle ManifestUpdateMtime: update mtime on existing entry
-    fn handle_manifest_update_mtime(&mut self, path: &str, mtime_ns: u64) -> VeloResponse {
-        let path_hash = fnv1a_hash(path);
+    /// Handle ManifestUpdateMtime: update mtime on existing entry.
+    /// `persisted` is the LMDB entry of `path` (see `persisted_entry`).
+    fn handle_manifest_update_mtime(
+        &mut self,
+        path: &str,
+        mtime_ns: u64,
+        persisted: Option<VnodeEntry>,
+    ) -> VeloResponse {
+        let key = VDirKey::from_path(path);
         let mtime_sec = (mtime_ns / 1_000_000_000) as i64;
         let mtime_nsec = (mtime_ns % 1_000_000_000) as u32;
 
         // Look up existing entry (VDir first, then LMDB)
-        let existing = if let Some(entry) = self.vdir.lookup(path_hash) {
-            Some(*entry)
-        } else if let Ok(Some(lmdb_entry)) = self.manifest.get(path) {
-            Some(VDirEntry {
-                path_hash,
-                cas_hash: lmdb_entry.vnode.content_hash,
-                size: lmdb_entry.vnode.size,
-                mtime_sec: lmdb_entry.vnode.mtime as i64,
-                mtime_nsec: 0,
-                mode: lmdb_entry.vnode.mode,
-                flags: lmdb_entry.vnode.flags,
-                _pad: [0; 3],
-            })
-        } else {
-            None
+        let existing = match self.vdir.lookup(key) {
+            Some(entry) => Some(*entry),
+            None => persisted.map(|vnode| persisted_vdir_entry(key, vnode)),
         };
 
         match existing {
@@ -265,6 +610,7 @@ impl CommandHandler {
                 let updated = VDirEntry {
                     mtime_sec,
                     mtime_nsec,
+                    path_check: key.path_check,
                     ..entry
                 };
                 match self.vdir.upsert(updated) {
@@ -299,54 +645,91 @@ impl CommandHandler {
         let mut entries = Vec::new();
         let mut seen = std::collections::HashSet::new();
 
-        // Query LMDB for all entries, filter by prefix
-        if let Ok(all_entries) = self.manifest.iter() {
-            for (entry_path, manifest_entry) in &all_entries {
-                if !entry_path.starts_with(&prefix) {
-                    continue;
-                }
-                // Extract direct child name (strip prefix, take first component)
-                let relative = &entry_path[prefix.len()..];
-                let child_name = if let Some(slash_pos) = relative.find('/') {
-                    // This is a deeper path → the direct child is a directory
-                    let name = &relative[..slash_pos];
-                    if !seen.insert(name.to_string()) {
-                        continue; // Already seen this directory
-                    }
-                    entries.push(vrift_ipc::DirEntry {
-                        name: name.to_string(),
-                        is_dir: true,
-                    });
-                    continue;
-                } else {
-                    relative
-                };
-
-                if child_name.is_empty() {
-                    continue;
-                }
-                if !seen.insert(child_name.to_string()) {
-                    continue;
-                }
-
-                let is_dir = manifest_entry.vnode.flags & FLAG_DIR != 0;
+        // Stream LMDB entries, filter by prefix
+        let _ = self.manifest.for_each(|entry_path, manifest_entry| {
+            let Some(relative) = entry_path.strip_prefix(prefix.as_str()) else {
+                return true;
+            };
+            // Extract direct child name (first component); a deeper path
+            // means the direct child is a directory
+            let (child_name, is_dir) = match relative.find('/') {
+                Some(slash_pos) => (&relative[..slash_pos], true),
+                None => (relative, manifest_entry.vnode.flags & FLAG_DIR != 0),
+            };
+            if !child_name.is_empty() && seen.insert(child_name.to_string()) {
                 entries.push(vrift_ipc::DirEntry {
                     name: child_name.to_string(),
                     is_dir,
                 });
             }
-        }
+            true
+        });
 
         debug!(path = %path, count = entries.len(), "ListDir");
         VeloResponse::ManifestListAck { entries }
     }
 
+    /// Store a large reingested file and keep its BLAKE3 hash tree, so the
+    /// next reingest of it only rehashes (and re-chunks) what was written.
+    fn store_with_tree(
+        store: &vrift_cas::CasStore,
+        temp: &Path,
+        size: u64,
+        delta: Option<&ReingestDelta>,
+    ) -> vrift_cas::Result<vrift_cas::Blake3Hash> {
+        use vrift_cas::tree_hash::dirty_ranges;
+        use vrift_cas::TreeHash;
+
+        let file = fs::File::open(temp)?;
+        let base = delta
+            .filter(|_| vrift_config::config().ingest.delta_reingest)
+            .and_then(|d| Some((d, store.load_tree(&d.base_hash)?)))
+            .filter(|(d, tree)| tree.len() == d.base_size);
+
+        let (tree, rechunk) = match base {
+            Some((d, base_tree)) => {
+                let written: Vec<_> = d.ranges.iter().map(|r| (r[0], r[1])).collect();
+                let dirty = dirty_ranges(&written, d.base_size, d.truncated_to, size);
+                debug!(ranges = dirty.len(), "Delta reingest");
+                (
+                    base_tree.update(&file, size, &dirty)?,
+                    Some((d.base_hash, dirty)),
+                )
+            }
+            None => (TreeHash::compute(&file, size)?, None),
+        };
+        drop(file);
+
+        let hash = tree.root();
+        let rechunk = rechunk
+            .as_ref()
+            .map(|(base, dirty)| (base, dirty.as_slice()));
+        store.store_by_move_hashed(temp, &hash, rechunk)?;
+        if let Err(e) = store.save_tree(&tree) {
+            warn!(error = %e, "Failed to save hash tree");
+        }
+        Ok(hash)
+    }
+
+    /// Whether `delta` reports an untouched clone of its base blob
+    fn is_clean_clone(delta: &ReingestDelta, delta_reingest: bool) -> bool {
+        delta_reingest
+            && delta.cloned
+            && delta.ranges.is_empty()
+            && delta.truncated_to >= delta.base_size
+    }
+
     /// Handle ManifestReingest (CoW commit)
-    async fn handle_reingest(&mut self, vpath: &str, temp_path: &str) -> VeloResponse {
+    async fn handle_reingest(
+        &mut self,
+        vpath: &str,
+        temp_path: &str,
+        delta: Option<ReingestDelta>,
+    ) -> VeloResponse {
         let temp = PathBuf::from(temp_path);
 
         // 1. Initialize CAS store
-        let store = match vrift_cas::CasStore::new(&self.config.cas_path) {
+        let store = match self.cas_store() {
             Ok(s) => s,
             Err(e) => {
                 error!(error = %e, "Failed to initialize CAS store");
@@ -356,9 +739,37 @@ impl CommandHandler {
                 ));
             }
         };
+        // Large artifacts: only the chunks changed by this write are stored
+        let store = match vrift_config::config().ingest.chunk_threshold_mb {
+            0 => store,
+            mb => store.with_chunking(vrift_cas::ChunkingConfig::with_threshold(mb << 20)),
+        };
+
+        // A copy the inception layer cloned and never dirtied: the entry
+        // reuses the base hash without reading data. Empty ranges alone do
+        // not qualify (writes the inception layer misses leave none), and
+        // the shortcut trusts tracking as much as delta reingest does.
+        if let Some(d) = delta
+            .as_ref()
+            .filter(|d| Self::is_clean_clone(d, vrift_config::config().ingest.delta_reingest))
+        {
+            if let Ok(meta) = fs::metadata(&temp) {
+                if meta.len() == d.base_size && store.blob_size(&d.base_hash).is_some() {
+                    let _ = fs::remove_file(&temp);
+                    debug!(vpath = %vpath, "Reingest is a clone");
+                    return self.commit_reingest(vpath, d.base_hash, d.base_size, &meta);
+                }
+            }
+        }
 
         // 2. Ingest to CAS via move (atomic & deduplicated)
-        let hash_bytes = match store.store_by_move(&temp) {
+        let stored = match fs::metadata(&temp) {
+            Ok(m) if vrift_cas::TreeHash::applies_to(m.len()) => {
+                Self::store_with_tree(&store, &temp, m.len(), delta.as_ref())
+            }
+            _ => store.store_by_move(&temp),
+        };
+        let hash_bytes = match stored {
             Ok(h) => h,
             Err(e) => {
                 error!(error = %e, temp = %temp_path, "CAS ingestion failed");
@@ -369,25 +780,40 @@ impl CommandHandler {
             }
         };
 
-        // 3. Get metadata for the committed file
-        let cas_path = store.blob_path_for_hash(&hash_bytes).unwrap();
-        let meta = match fs::metadata(&cas_path) {
+        // 3. Get metadata for the committed file; a chunked blob's size is
+        // in its name, not its chunk list's length
+        let meta = match store.blob_metadata(&hash_bytes) {
             Ok(m) => m,
             Err(e) => {
                 return VeloResponse::Error(VeloError::io_error(format!("Metadata error: {}", e)));
             }
         };
+        let size = store.blob_size(&hash_bytes).unwrap_or(meta.len());
 
         // 4. Update VDir
+        self.write_back(vec![hash_bytes]);
+        self.commit_reingest(vpath, hash_bytes, size, &meta)
+    }
+
+    /// Point `vpath` at the reingested blob
+    fn commit_reingest(
+        &mut self,
+        vpath: &str,
+        hash_bytes: [u8; 32],
+        size: u64,
+        meta: &fs::Metadata,
+    ) -> VeloResponse {
+        let key = VDirKey::from_path(vpath);
         let entry = VDirEntry {
-            path_hash: fnv1a_hash(vpath),
+            path_hash: key.path_hash,
             cas_hash: hash_bytes,
-            size: meta.len(),
+            size,
             mtime_sec: meta.mtime(),
             mtime_nsec: meta.mtime_nsec() as u32,
             mode: meta.mode(),
             flags: if meta.is_dir() { FLAG_DIR } else { 0 },
-            _pad: [0; 3],
+            _pad: 0,
+            path_check: key.path_check,
         };
 
         if let Err(e) = self.vdir.upsert(entry) {
@@ -399,7 +825,7 @@ impl CommandHandler {
         VeloResponse::ManifestAck {
             entry: Some(VnodeEntry {
                 content_hash: hash_bytes,
-                size: meta.len(),
+                size,
                 mtime: meta.mtime() as u64,
                 mode: meta.mode(),
                 flags: 0,
@@ -422,8 +848,7 @@ impl CommandHandler {
         cas_root_override: Option<&str>,
     ) -> VeloResponse {
         use std::time::Instant;
-        use vrift_cas::{parallel_ingest_with_progress, IngestMode};
-        use walkdir::WalkDir;
+        use vrift_cas::{parallel_ingest_with_progress, IngestMode, TreeWalker};
 
         let source_path = PathBuf::from(path);
         let manifest_out = PathBuf::from(manifest_path);
@@ -440,12 +865,7 @@ impl CommandHandler {
         let start = Instant::now();
 
         // 1. Collect files
-        let file_paths: Vec<PathBuf> = WalkDir::new(&source_path)
-            .into_iter()
-            .filter_map(|e| e.ok())
-            .filter(|e| e.file_type().is_file())
-            .map(|e| e.path().to_path_buf())
-            .collect();
+        let file_paths: Vec<PathBuf> = TreeWalker::new(&source_path).collect_files();
 
         let total_files = file_paths.len() as u64;
         if total_files == 0 {
@@ -519,6 +939,17 @@ impl CommandHandler {
             "Full scan ingest complete"
         );
 
+        // The remote tier is in front of TheSource only
+        if effective_cas_path == self.config.cas_path {
+            let new_blobs = results
+                .iter()
+                .flatten()
+                .filter(|r| r.was_new)
+                .map(|r| r.hash)
+                .collect();
+            self.write_back(new_blobs);
+        }
+
         VeloResponse::IngestAck {
             files: total_files,
             blobs: unique_blobs,
@@ -585,6 +1016,55 @@ impl CommandHandler {
     }
 }
 
+/// Handle CasGet: make a blob openable by path. Chunked blobs are
+/// materialized into a flat file for the inception layer's direct open,
+/// blobs only the remote tier has are fetched. May block on the network
+/// with a remote tier — the socket runs it off the handler lock.
+pub fn cas_get(store: vrift_cas::Result<vrift_cas::CasStore>, hash: &[u8; 32]) -> VeloResponse {
+    let store = match store {
+        Ok(s) => s,
+        Err(e) => {
+            error!(error = %e, "Failed to initialize CAS store");
+            return VeloResponse::Error(VeloError::internal(format!("CAS init error: {}", e)));
+        }
+    };
+
+    match store.materialize(hash) {
+        Ok(path) => match fs::metadata(&path) {
+            Ok(meta) => VeloResponse::CasFound { size: meta.len() },
+            Err(_) => VeloResponse::CasNotFound,
+        },
+        Err(vrift_cas::CasError::NotFound { .. }) => VeloResponse::CasNotFound,
+        Err(e) => {
+            error!(error = %e, hash = %hex::encode(hash), "CAS materialize failed");
+            VeloResponse::Error(VeloError::io_error(format!("CAS error: {}", e)))
+        }
+    }
+}
+
+/// Build the VDir directory index image from the manifest: the same
+/// children `ManifestListDir` reports, for every directory at once.
+/// O(manifest) — run it off the handler lock.
+pub fn build_dir_index(
+    manifest: &vrift_manifest::lmdb::LmdbManifest,
+    revision: u64,
+) -> Result<Vec<u8>> {
+    let entries = manifest
+        .iter()
+        .map_err(|e| anyhow::anyhow!("Failed to iterate manifest: {}", e))?;
+    let mut builder = DirIndexBuilder::new();
+    for (path, entry) in &entries {
+        builder.add(path, entry.vnode.flags & FLAG_DIR != 0);
+    }
+    debug!(
+        entries = entries.len(),
+        dirs = builder.dir_count(),
+        revision,
+        "Built directory index"
+    );
+    builder.build(revision)
+}
+
 #[cfg(test)]
 mod tests {
     use super::*;
@@ -870,6 +1350,7 @@ mod tests {
             .handle_request(VeloRequest::ManifestReingest {
                 vpath: "hello.txt".to_string(),
                 temp_path: temp_file.to_str().unwrap().to_string(),
+                delta: None,
             })
             .await;
 
@@ -899,6 +1380,36 @@ mod tests {
         }
     }
 
+    #[tokio::test]
+    async fn test_reingest_large_file_keeps_hash_tree() {
+        let (mut handler, temp) = create_test_handler();
+
+        let data: Vec<u8> = (0..3 * 1024 * 1024u32).map(|i| (i % 251) as u8).collect();
+        let temp_file = temp.path().join("staging").join("big.tmp");
+        std::fs::create_dir_all(temp_file.parent().unwrap()).unwrap();
+        std::fs::write(&temp_file, &data).unwrap();
+
+        let response = handler
+            .handle_request(VeloRequest::ManifestReingest {
+                vpath: "big.bin".to_string(),
+                temp_path: temp_file.to_str().unwrap().to_string(),
+                delta: None,
+            })
+            .await;
+
+        let hash = match response {
+            VeloResponse::ManifestAck { entry: Some(e) } => e.content_hash,
+            other => panic!("Expected ManifestAck, got {:?}", other),
+        };
+        assert_eq!(hash, *blake3::hash(&data).as_bytes());
+
+        let store = vrift_cas::CasStore::new(&handler.config.cas_path).unwrap();
+        assert_eq!(
+            store.load_tree(&hash).map(|t| t.len()),
+            Some(data.len() as u64)
+        );
+    }
+
     #[tokio::test]
     async fn test_reingest_nonexistent_file_returns_error() {
         let (mut handler, _temp) = create_test_handler();
@@ -907,6 +1418,7 @@ mod tests {
             .handle_request(VeloRequest::ManifestReingest {
                 vpath: "test.txt".to_string(),
                 temp_path: "/nonexistent/path/file.tmp".to_string(),
+                delta: None,
             })
             .await;
 
@@ -918,6 +1430,89 @@ mod tests {
         }
     }
 
+    #[tokio::test]
+    async fn test_reingest_clone_delta_reuses_base_hash() {
+        let (mut handler, temp) = create_test_handler();
+        let store = vrift_cas::CasStore::new(&handler.config.cas_path).unwrap();
+        let base = store.store(b"cloned bytes").unwrap();
+
+        let temp_file = temp.path().join("staging").join("copy.tmp");
+        std::fs::create_dir_all(temp_file.parent().unwrap()).unwrap();
+        std::fs::write(&temp_file, b"cloned bytes").unwrap();
+
+        let response = handler
+            .handle_request(VeloRequest::ManifestReingest {
+                vpath: "copy.txt".to_string(),
+                temp_path: temp_file.to_str().unwrap().to_string(),
+                delta: Some(ReingestDelta {
+                    base_hash: base,
+                    base_size: 12,
+                    truncated_to: u64::MAX,
+                    ranges: Vec::new(),
+                    cloned: true,
+                }),
+            })
+            .await;
+
+        match response {
+            VeloResponse::ManifestAck { entry: Some(e) } => {
+                assert_eq!(e.content_hash, base);
+                assert_eq!(e.size, 12);
+            }
+            other => panic!("Expected ManifestAck, got {:?}", other),
+        }
+        assert!(!temp_file.exists());
+    }
+
+    #[tokio::test]
+    async fn test_reingest_truncate_and_untracked_write_is_rehashed() {
+        let (mut handler, temp) = create_test_handler();
+        let store = vrift_cas::CasStore::new(&handler.config.cas_path).unwrap();
+        let base = store.store(b"original bytes").unwrap();
+
+        // ftruncate(fd, base_size), then a write the tracker never saw
+        let temp_file = temp.path().join("staging").join("edited.tmp");
+        std::fs::create_dir_all(temp_file.parent().unwrap()).unwrap();
+        std::fs::write(&temp_file, b"modified bytes").unwrap();
+        let delta = ReingestDelta {
+            base_hash: base,
+            base_size: 14,
+            truncated_to: 14,
+            ranges: Vec::new(),
+            cloned: false,
+        };
+        assert!(!CommandHandler::is_clean_clone(&delta, true));
+        assert!(CommandHandler::is_clean_clone(
+            &ReingestDelta {
+                cloned: true,
+                ..delta.clone()
+            },
+            true
+        ));
+        assert!(!CommandHandler::is_clean_clone(
+            &ReingestDelta {
+                cloned: true,
+                ..delta.clone()
+            },
+            false
+        ));
+
+        let response = handler
+            .handle_request(VeloRequest::ManifestReingest {
+                vpath: "edited.txt".to_string(),
+                temp_path: temp_file.to_str().unwrap().to_string(),
+                delta: Some(delta),
+            })
+            .await;
+
+        match response {
+            VeloResponse::ManifestAck { entry: Some(e) } => {
+                assert_eq!(e.content_hash, *blake3::hash(b"modified bytes").as_bytes());
+            }
+            other => panic!("Expected ManifestAck, got {:?}", other),
+        }
+    }
+
     // ==================== ManifestRename Tests ====================
 
     #[tokio::test]
@@ -982,6 +1577,74 @@ mod tests {
 
     // ==================== ManifestUpdateMtime Tests ====================
 
+    #[tokio::test]
+    async fn test_handle_mutations_applies_batch_in_order() {
+        let (mut handler, _temp) = create_test_handler();
+        let entry = VnodeEntry {
+            content_hash: [7; 32],
+            size: 10,
+            mtime: 1,
+            mode: 0o644,
+            flags: 0,
+            _pad: 0,
+        };
+
+        let responses = handler.handle_mutations(vec![
+            VeloRequest::ManifestUpsert {
+                path: "a.txt".to_string(),
+                entry: entry.clone(),
+            },
+            VeloRequest::ManifestRename {
+                old_path: "a.txt".to_string(),
+                new_path: "b.txt".to_string(),
+            },
+            VeloRequest::Status,
+        ]);
+        assert_eq!(responses.len(), 3);
+        assert!(matches!(responses[0], VeloResponse::ManifestAck { .. }));
+        assert!(matches!(responses[1], VeloResponse::ManifestAck { .. }));
+        assert!(matches!(responses[2], VeloResponse::Error(_)));
+        assert_eq!(handler.lookup_entry("b.txt").unwrap().content_hash, [7; 32]);
+    }
+
+    #[tokio::test]
+    async fn test_handle_mutations_spans_several_windows() {
+        let (mut handler, _temp) = create_test_handler();
+        let count = MUTATION_WINDOW_MAX * 2 + 1;
+        let mut requests: Vec<_> = (0..count)
+            .map(|i| VeloRequest::ManifestUpsert {
+                path: format!("f{}", i),
+                entry: VnodeEntry {
+                    content_hash: [i as u8; 32],
+                    size: i as u64,
+                    mtime: 1,
+                    mode: 0o644,
+                    flags: 0,
+                    _pad: 0,
+                },
+            })
+            .collect();
+        // Renames a path upserted in an earlier window of the same batch
+        requests.push(VeloRequest::ManifestRename {
+            old_path: "f0".to_string(),
+            new_path: "g0".to_string(),
+        });
+
+        let responses = handler.handle_mutations(requests);
+        assert_eq!(responses.len(), count + 1);
+        assert!(responses
+            .iter()
+            .all(|r| matches!(r, VeloResponse::ManifestAck { .. })));
+        assert_eq!(handler.lookup_entry("g0").unwrap().size, 0);
+        assert_eq!(
+            handler
+                .lookup_entry(&format!("f{}", count - 1))
+                .unwrap()
+                .size,
+            (count - 1) as u64
+        );
+    }
+
     #[tokio::test]
     async fn test_manifest_update_mtime() {
         let (mut handler, _temp) = create_test_handler();
@@ -1026,6 +1689,61 @@ mod tests {
         }
     }
 
+    // ==================== ManifestGetMany Tests ====================
+
+    #[tokio::test]
+    async fn test_manifest_get_many_positional_results() {
+        let (mut handler, _temp) = create_test_handler();
+
+        handler
+            .handle_request(VeloRequest::ManifestUpsert {
+                path: "/inc/b.h".to_string(),
+                entry: VnodeEntry {
+                    content_hash: [9; 32],
+                    size: 77,
+                    mtime: 0,
+                    mode: 0o644,
+                    flags: 0,
+                    _pad: 0,
+                },
+            })
+            .await;
+
+        let response = handler
+            .handle_request(VeloRequest::ManifestGetMany {
+                paths: vec![
+                    "/inc/a.h".to_string(),
+                    "/inc/b.h".to_string(),
+                    "/inc/c.h".to_string(),
+                ],
+            })
+            .await;
+
+        match response {
+            VeloResponse::ManifestGetManyAck { entries } => {
+                assert_eq!(entries.len(), 3);
+                assert!(entries[0].is_none());
+                assert_eq!(entries[1].as_ref().unwrap().size, 77);
+                assert!(entries[2].is_none());
+            }
+            _ => panic!("Expected ManifestGetManyAck"),
+        }
+    }
+
+    #[tokio::test]
+    async fn test_manifest_get_many_rejects_oversized_batch() {
+        let (mut handler, _temp) = create_test_handler();
+
+        let paths = (0..=MANIFEST_GET_MANY_MAX)
+            .map(|i| format!("/f{}", i))
+            .collect();
+        let response = handler
+            .handle_request(VeloRequest::ManifestGetMany { paths })
+            .await;
+
+        assert!(matches!(response, VeloResponse::Error(_)));
+    }
+
     // ==================== ManifestListDir Tests ====================
 
     #[tokio::test]
@@ -1045,15 +1763,108 @@ mod tests {
         }
     }
 
+    #[tokio::test]
+    async fn test_dir_index_matches_list_dir() {
+        let (mut handler, temp) = create_test_handler();
+        let manifest = handler.manifest();
+        for path in ["/src/main.rs", "/src/util/mod.rs", "/Cargo.toml"] {
+            manifest.insert(
+                path,
+                VnodeEntry::new_file([0; 32], 1, 0, 0o644),
+                vrift_manifest::lmdb::AssetTier::Tier2Mutable,
+            );
+        }
+
+        let image = build_dir_index(&manifest, manifest.revision()).unwrap();
+        handler
+            .publish_dir_index(&image, handler.vdir_dir_changes())
+            .unwrap();
+
+        let mut expected = match handler
+            .handle_request(VeloRequest::ManifestListDir {
+                path: "/src".to_string(),
+            })
+            .await
+        {
+            VeloResponse::ManifestListAck { entries } => entries
+                .into_iter()
+                .map(|e| (e.name.into_bytes(), e.is_dir))
+                .collect::<Vec<_>>(),
+            _ => panic!("Expected ManifestListAck"),
+        };
+        expected.sort();
+
+        // Read the published index the way a client maps it
+        let bytes = std::fs::read(temp.path().join("test.vdir")).unwrap();
+        let mut aligned = vec![0u64; bytes.len().div_ceil(8)];
+        let base = aligned.as_mut_ptr() as *mut u8;
+        unsafe { std::ptr::copy_nonoverlapping(bytes.as_ptr(), base, bytes.len()) };
+        let dirs = unsafe { crate::vdir::VDirDirs::open(base, bytes.len()) }.unwrap();
+        assert_eq!(dirs.revision, manifest.revision());
+        let list = unsafe { dirs.find(VDirKey::from_path("/src")) }.unwrap();
+        let indexed: Vec<_> = (0..list.len())
+            .map(|i| {
+                let (name, kind) = unsafe { list.get(i) }.unwrap();
+                (name.to_vec(), kind & crate::vdir::VDIR_CHILD_DIR != 0)
+            })
+            .collect();
+        assert_eq!(indexed, expected);
+    }
+
+    // ==================== CasGet Tests ====================
+
+    #[tokio::test]
+    async fn test_cas_get_unknown_hash_not_found() {
+        let (mut handler, _temp) = create_test_handler();
+
+        let response = handler
+            .handle_request(VeloRequest::CasGet { hash: [0; 32] })
+            .await;
+
+        assert!(matches!(response, VeloResponse::CasNotFound));
+    }
+
+    #[tokio::test]
+    async fn test_cas_get_fetches_from_remote_tier() {
+        use vrift_cas::remote::DirTier;
+        use vrift_cas::RemoteTier;
+
+        let (mut handler, temp) = create_test_handler();
+        let shared = temp.path().join("shared");
+        let remote = vrift_cas::RemoteCas::new(
+            Box::new(DirTier::new(&shared)),
+            &handler.config.cas_path,
+            u64::MAX,
+            2,
+        )
+        .unwrap();
+        handler.set_remote_cas(Arc::new(remote));
+
+        // Unique content: the test CAS root may be shared
+        let data = format!("built on another node: {}", temp.path().display());
+        let hash = vrift_cas::CasStore::compute_hash(data.as_bytes());
+        DirTier::new(&shared).put(&hash, data.as_bytes()).unwrap();
+
+        let response = handler.handle_request(VeloRequest::CasGet { hash }).await;
+
+        match response {
+            VeloResponse::CasFound { size } => assert_eq!(size, data.len() as u64),
+            other => panic!("Expected CasFound, got {:?}", other),
+        }
+    }
+
     // ==================== Unhandled Request Tests ====================
 
     #[tokio::test]
     async fn test_unhandled_request_returns_not_implemented() {
         let (mut handler, _temp) = create_test_handler();
 
-        // CasGet is not yet implemented
+        // CasInsert is not yet implemented
         let response = handler
-            .handle_request(VeloRequest::CasGet { hash: [0; 32] })
+            .handle_request(VeloRequest::CasInsert {
+                hash: [0; 32],
+                size: 0,
+            })
             .await;
 
         match response {
@@ -1103,4 +1914,53 @@ mod tests {
             }
         }
     }
+
+    // ==================== Prefetch Tests ====================
+
+    #[tokio::test]
+    async fn test_access_trace_then_hint_schedules_prefetch() {
+        let (mut handler, _temp) = create_test_handler();
+        let blobs: Vec<_> = (1..=2u8)
+            .map(|i| vrift_ipc::AccessedBlob {
+                hash: [i; 32],
+                size: 10,
+            })
+            .collect();
+
+        let response = handler
+            .handle_request(VeloRequest::AccessTrace {
+                command: "rustc".to_string(),
+                cwd: "/p".to_string(),
+                blobs,
+            })
+            .await;
+        assert!(matches!(response, VeloResponse::PrefetchAck { blobs: 2 }));
+
+        let response = handler
+            .handle_request(VeloRequest::PrefetchHint {
+                command: "rustc".to_string(),
+                cwd: "/p".to_string(),
+            })
+            .await;
+        assert!(matches!(response, VeloResponse::PrefetchAck { blobs: 2 }));
+    }
+
+    // ==================== Metrics Tests ====================
+
+    #[tokio::test]
+    async fn test_metrics_exports_client_counters() {
+        let (mut handler, temp) = create_test_handler();
+        let metrics = InceptionMetrics::create_or_open(&temp.path().join("vdir.metrics")).unwrap();
+        handler.set_inception_metrics(Arc::new(metrics));
+
+        let response = handler.handle_request(VeloRequest::Metrics).await;
+        match response {
+            VeloResponse::MetricsAck { text } => {
+                assert!(text.contains("# TYPE vrift_inception_vdir_hits_total counter"));
+                assert!(text.contains("vrift_vdir_capacity "));
+                assert!(text.contains("vrift_prefetch_hints_total 0"));
+            }
+            _ => panic!("Expected MetricsAck"),
+        }
+    }
 }
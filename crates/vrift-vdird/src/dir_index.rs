@@ -0,0 +1,441 @@
+//! Directory listing index — written into the VDir for shm readdir
+//!
+//! vDird turns the manifest's flat path list into the directory region
+//! described in `vrift_ipc::vdir_types` (per-directory child runs over one
+//! name arena) and publishes it with `VDir::publish_dir_index`.
+//! InceptionLayer clients then serve opendir/readdir from the mapping.
+//! The region also carries the negative-lookup filter over every manifest
+//! key, so it goes stale and is rebuilt together with the listings.
+//!
+//! The index is rebuilt whole, off the request path. A VDir mutation that
+//! adds or removes a path marks it stale in its own write transaction; the
+//! maintenance tick marks it stale when ingest moves the manifest revision,
+//! and rebuilds once both have been quiet for a tick (or stale too long).
+
+use anyhow::Result;
+use std::collections::{BTreeMap, HashMap};
+use std::time::{Duration, Instant};
+use vrift_ipc::vdir_types::{
+    vdir_filter_blocks, vdir_filter_insert, vdir_parent, VDirChild, VDirDirSlot, VDirDirsHeader,
+    VDirKey, VDIR_CHILD_DIR, VDIR_DIRS_HEADER_SIZE, VDIR_FILTER_BLOCK, VDIR_NAME_MAX,
+};
+
+/// Upper bound on how long a busy manifest keeps the index stale
+pub const DIR_INDEX_MAX_STALE: Duration = Duration::from_millis(500);
+
+/// Collects manifest paths into directory → sorted children
+#[derive(Default)]
+pub struct DirIndexBuilder {
+    dirs: HashMap<String, BTreeMap<String, bool>>,
+    /// Every manifest key added (for the negative-lookup filter)
+    keys: Vec<VDirKey>,
+}
+
+impl DirIndexBuilder {
+    pub fn new() -> Self {
+        Self::default()
+    }
+
+    /// Add a manifest path and every ancestor directory it implies
+    pub fn add(&mut self, path: &str, is_dir: bool) {
+        self.keys.push(VDirKey::from_path(path));
+        if is_dir {
+            self.dirs.entry(path.to_string()).or_default();
+        }
+        let mut path = path;
+        let mut is_dir = is_dir;
+        loop {
+            let (parent, name) = vdir_parent(path);
+            if name.is_empty() || name.len() > VDIR_NAME_MAX {
+                return;
+            }
+            let children = self.dirs.entry(parent.to_string()).or_default();
+            match children.get_mut(name) {
+                Some(existing) => {
+                    // Ancestors were recorded when this name was first seen
+                    *existing |= is_dir;
+                    return;
+                }
+                None => {
+                    children.insert(name.to_string(), is_dir);
+                }
+            }
+            if parent == "/" || parent.is_empty() {
+                return;
+            }
+            path = parent;
+            is_dir = true;
+        }
+    }
+
+    /// Number of directories collected
+    pub fn dir_count(&self) -> usize {
+        self.dirs.len()
+    }
+
+    /// Serialize the region image (spare fields are filled in by the VDir)
+    pub fn build(&self, revision: u64) -> Result<Vec<u8>> {
+        // <= 50% load keeps linear probe runs short
+        let dir_capacity = (self.dirs.len() * 2).next_power_of_two().max(16);
+        let child_count: usize = self.dirs.values().map(BTreeMap::len).sum();
+        let names_len: usize = self
+            .dirs
+            .values()
+            .flat_map(BTreeMap::keys)
+            .map(String::len)
+            .sum();
+        anyhow::ensure!(
+            child_count <= u32::MAX as usize && names_len <= u32::MAX as usize,
+            "Directory index too large ({} children, {} name bytes)",
+            child_count,
+            names_len
+        );
+
+        let mut header = VDirDirsHeader {
+            dir_capacity: dir_capacity as u32,
+            dir_count: self.dirs.len() as u32,
+            child_count: child_count as u32,
+            names_len: names_len as u32,
+            revision,
+            ..Default::default()
+        };
+        let filter_blocks = vdir_filter_blocks(self.keys.len());
+        header.filter_offset = header.filter_offset_after_names().min(u32::MAX as usize) as u32;
+        header.filter_blocks = filter_blocks.min(u32::MAX as usize) as u32;
+        let used = header.used_size();
+        anyhow::ensure!(
+            used <= u32::MAX as usize,
+            "Directory index too large ({} bytes)",
+            used
+        );
+        header.region_size = used as u32;
+
+        let mut image = vec![0u8; used];
+        put(&mut image, 0, header);
+
+        let children_at = header.children_offset();
+        let names_at = header.names_offset();
+        let mut child_index = 0usize;
+        let mut name_offset = 0usize;
+
+        for (dir, children) in &self.dirs {
+            let key = VDirKey::from_path(dir);
+            let slot = free_slot(&image, dir_capacity, key.path_hash);
+            put(
+                &mut image,
+                slot_at(slot),
+                VDirDirSlot {
+                    dir_hash: key.path_hash,
+                    dir_check: key.path_check,
+                    child_start: child_index as u32,
+                    child_count: children.len() as u32,
+                    _pad: 0,
+                },
+            );
+
+            // BTreeMap<String> iterates in byte order: the sort readers rely on
+            for (name, &is_dir) in children {
+                put(
+                    &mut image,
+                    children_at + child_index * std::mem::size_of::<VDirChild>(),
+                    VDirChild {
+                        name_offset: name_offset as u32,
+                        name_len: name.len() as u16,
+                        kind: if is_dir { VDIR_CHILD_DIR } else { 0 },
+                        _pad: 0,
+                    },
+                );
+                let at = names_at + name_offset;
+                image[at..at + name.len()].copy_from_slice(name.as_bytes());
+                name_offset += name.len();
+                child_index += 1;
+            }
+        }
+
+        let mut filter = vec![0u32; filter_blocks * VDIR_FILTER_BLOCK / 4];
+        for &key in &self.keys {
+            vdir_filter_insert(&mut filter, key);
+        }
+        for (i, word) in filter.iter().enumerate() {
+            put(&mut image, header.filter_offset as usize + i * 4, *word);
+        }
+
+        Ok(image)
+    }
+}
+
+/// Byte offset of directory slot `slot` in the image
+fn slot_at(slot: usize) -> usize {
+    VDIR_DIRS_HEADER_SIZE + slot * std::mem::size_of::<VDirDirSlot>()
+}
+
+/// First empty slot on the linear probe sequence of `hash`
+fn free_slot(image: &[u8], capacity: usize, hash: u64) -> usize {
+    let mask = capacity - 1;
+    let mut slot = hash as usize & mask;
+    loop {
+        let check_at = slot_at(slot) + 8; // VDirDirSlot::dir_check
+        if image[check_at..check_at + 4] == [0; 4] {
+            return slot;
+        }
+        slot = (slot + 1) & mask;
+    }
+}
+
+/// Write a `repr(C)` value at `offset` (the image Vec is not aligned)
+fn put<T: Copy>(image: &mut [u8], offset: usize, value: T) {
+    assert!(offset + std::mem::size_of::<T>() <= image.len());
+    unsafe { std::ptr::write_unaligned(image.as_mut_ptr().add(offset) as *mut T, value) }
+}
+
+/// What the maintenance tick should do with the directory index
+#[derive(Debug, Clone, Copy, PartialEq, Eq)]
+pub enum DirIndexAction {
+    /// Index matches the manifest
+    None,
+    /// Manifest moved (ingest): stop readers using the index, rebuild
+    /// later. VDir mutations mark it stale themselves, as they apply.
+    MarkStale,
+    /// Rebuild from the manifest at this revision
+    Rebuild(u64),
+}
+
+/// Debounce for index rebuilds: a burst of manifest changes (npm install,
+/// a watcher storm) costs one stale mark and one rebuild, not one each.
+#[derive(Debug, Default)]
+pub struct DirIndexRefresh {
+    /// (manifest revision, VDir dir changes) of the last rebuild
+    built: Option<(u64, u64)>,
+    last_seen: Option<(u64, u64)>,
+    stale_since: Option<Instant>,
+}
+
+impl DirIndexRefresh {
+    pub fn new() -> Self {
+        Self::default()
+    }
+
+    /// Decide for the current manifest `revision` and `VDir::dir_changes`
+    pub fn next(&mut self, revision: u64, dir_changes: u64, now: Instant) -> DirIndexAction {
+        let seen = (revision, dir_changes);
+        if self.built == Some(seen) {
+            self.last_seen = Some(seen);
+            return DirIndexAction::None;
+        }
+        let quiet = self.last_seen == Some(seen);
+        self.last_seen = Some(seen);
+        match self.stale_since {
+            // Only VDir mutations since the rebuild: already marked
+            None if self.built.is_some_and(|(built, _)| built == revision) => {
+                self.stale_since = Some(now);
+                DirIndexAction::None
+            }
+            None => {
+                self.stale_since = Some(now);
+                DirIndexAction::MarkStale
+            }
+            Some(since) if quiet || now.duration_since(since) >= DIR_INDEX_MAX_STALE => {
+                DirIndexAction::Rebuild(revision)
+            }
+            Some(_) => DirIndexAction::None,
+        }
+    }
+
+    /// The rebuild `next` asked for finished — published, or failed and
+    /// left the index stale. Either way, wait for the manifest or the VDir
+    /// to move again.
+    pub fn settled(&mut self) {
+        self.built = self.last_seen;
+        self.stale_since = None;
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+    use vrift_ipc::vdir_types::{vdir_dir_key, VDirDirs, VDirHeader, VDIR_HEADER_SIZE};
+
+    /// Map an image behind a minimal VDir header, as the VDir publishes it
+    fn with_index<R>(image: &[u8], f: impl FnOnce(VDirDirs) -> R) -> R {
+        let len = VDIR_HEADER_SIZE + image.len();
+        let mut buf = vec![0u64; len.div_ceil(8)];
+        let base = buf.as_mut_ptr() as *mut u8;
+        unsafe {
+            let header = &mut *(base as *mut VDirHeader);
+            header.dirs_offset = VDIR_HEADER_SIZE as u32;
+            header.file_size = len as u64;
+            std::ptr::copy_nonoverlapping(image.as_ptr(), base.add(VDIR_HEADER_SIZE), image.len());
+            f(VDirDirs::open(base, len).expect("index"))
+        }
+    }
+
+    fn list(dirs: &VDirDirs, dir: &str) -> Option<Vec<(String, bool)>> {
+        let list = unsafe { dirs.find(VDirKey::from_path(vdir_dir_key(dir))) }?;
+        Some(
+            (0..list.len())
+                .map(|i| {
+                    let (name, kind) = unsafe { list.get(i) }.unwrap();
+                    (
+                        String::from_utf8(name.to_vec()).unwrap(),
+                        kind & VDIR_CHILD_DIR != 0,
+                    )
+                })
+                .collect(),
+        )
+    }
+
+    #[test]
+    fn test_build_lists_children_sorted_with_implied_dirs() {
+        let mut b = DirIndexBuilder::new();
+        b.add("/src/main.rs", false);
+        b.add("/src/lib.rs", false);
+        b.add("/node_modules/react/index.js", false);
+        b.add("/README.md", false);
+        b.add("/empty", true);
+        let image = b.build(7).unwrap();
+
+        with_index(&image, |dirs| {
+            assert_eq!(dirs.revision, 7);
+            assert_eq!(
+                list(&dirs, "/").unwrap(),
+                vec![
+                    ("README.md".to_string(), false),
+                    ("empty".to_string(), true),
+                    ("node_modules".to_string(), true),
+                    ("src".to_string(), true),
+                ]
+            );
+            assert_eq!(
+                list(&dirs, "/src/").unwrap(),
+                vec![
+                    ("lib.rs".to_string(), false),
+                    ("main.rs".to_string(), false)
+                ]
+            );
+            assert_eq!(
+                list(&dirs, "/node_modules").unwrap(),
+                vec![("react".to_string(), true)]
+            );
+            assert_eq!(list(&dirs, "/empty").unwrap(), vec![]);
+            assert!(list(&dirs, "/missing").is_none());
+            assert!(list(&dirs, "/src/main.rs").is_none());
+        });
+    }
+
+    #[test]
+    fn test_build_many_directories() {
+        let mut b = DirIndexBuilder::new();
+        for pkg in 0..500 {
+            for file in 0..4 {
+                b.add(&format!("/node_modules/pkg{}/f{}.js", pkg, file), false);
+            }
+        }
+        assert_eq!(b.dir_count(), 502); // "/", node_modules, 500 packages
+        let image = b.build(1).unwrap();
+
+        with_index(&image, |dirs| {
+            assert_eq!(list(&dirs, "/node_modules").unwrap().len(), 500);
+            for pkg in 0..500 {
+                let children = list(&dirs, &format!("/node_modules/pkg{}", pkg)).unwrap();
+                assert_eq!(children.len(), 4, "pkg{}", pkg);
+            }
+        });
+    }
+
+    #[test]
+    fn test_seek_after_resumes_by_name() {
+        let mut b = DirIndexBuilder::new();
+        for name in ["a", "c", "e"] {
+            b.add(&format!("/d/{}", name), false);
+        }
+        let image = b.build(1).unwrap();
+        with_index(&image, |dirs| unsafe {
+            let list = dirs.find(VDirKey::from_path("/d")).unwrap();
+            assert_eq!(list.seek_after(b""), 0);
+            assert_eq!(list.seek_after(b"a"), 1);
+            assert_eq!(list.seek_after(b"b"), 1); // "b" was removed: continue at "c"
+            assert_eq!(list.seek_after(b"e"), 3);
+        });
+    }
+
+    #[test]
+    fn test_filter_covers_manifest_keys() {
+        let mut b = DirIndexBuilder::new();
+        for i in 0..1000 {
+            b.add(&format!("/src/f{}.rs", i), false);
+        }
+        let image = b.build(1).unwrap();
+        with_index(&image, |dirs| unsafe {
+            for i in 0..1000 {
+                let key = VDirKey::from_path(&format!("/src/f{}.rs", i));
+                assert_eq!(dirs.may_contain(key), Some(true));
+            }
+            let misses = (0..1000)
+                .filter(|i| {
+                    dirs.may_contain(VDirKey::from_path(&format!("/src/f{}.ts", i))) == Some(false)
+                })
+                .count();
+            assert!(misses > 950, "{} of 1000 misses rejected", misses);
+        });
+    }
+
+    #[test]
+    fn test_file_and_dir_with_same_name_is_dir() {
+        let mut b = DirIndexBuilder::new();
+        b.add("/x", false);
+        b.add("/x/y", false);
+        let image = b.build(1).unwrap();
+        with_index(&image, |dirs| {
+            assert_eq!(list(&dirs, "/").unwrap(), vec![("x".to_string(), true)]);
+        });
+    }
+
+    #[test]
+    fn test_refresh_debounces_bursts() {
+        let t0 = Instant::now();
+        let tick = Duration::from_millis(20);
+        let mut r = DirIndexRefresh::new();
+
+        // Startup: nothing built yet
+        assert_eq!(r.next(5, 0, t0), DirIndexAction::MarkStale);
+        assert_eq!(r.next(5, 0, t0 + tick), DirIndexAction::Rebuild(5));
+        r.settled();
+        assert_eq!(r.next(5, 0, t0 + tick * 2), DirIndexAction::None);
+
+        // Burst: stale once, wait while the revision keeps moving
+        assert_eq!(r.next(6, 0, t0 + tick * 3), DirIndexAction::MarkStale);
+        assert_eq!(r.next(7, 0, t0 + tick * 4), DirIndexAction::None);
+        assert_eq!(r.next(8, 0, t0 + tick * 5), DirIndexAction::None);
+        assert_eq!(r.next(8, 0, t0 + tick * 6), DirIndexAction::Rebuild(8));
+        r.settled();
+
+        // Never quiet: rebuilt anyway once stale for DIR_INDEX_MAX_STALE
+        let t1 = t0 + tick * 10;
+        assert_eq!(r.next(9, 0, t1), DirIndexAction::MarkStale);
+        assert_eq!(r.next(10, 0, t1 + tick), DirIndexAction::None);
+        assert_eq!(
+            r.next(11, 0, t1 + DIR_INDEX_MAX_STALE),
+            DirIndexAction::Rebuild(11)
+        );
+        r.settled();
+    }
+
+    #[test]
+    fn test_refresh_rebuilds_after_vdir_mutations_without_marking() {
+        let t0 = Instant::now();
+        let tick = Duration::from_millis(20);
+        let mut r = DirIndexRefresh::new();
+        assert_eq!(r.next(5, 0, t0), DirIndexAction::MarkStale);
+        assert_eq!(r.next(5, 0, t0 + tick), DirIndexAction::Rebuild(5));
+        r.settled();
+
+        // The mutations marked the index in their own transactions
+        assert_eq!(r.next(5, 3, t0 + tick * 2), DirIndexAction::None);
+        assert_eq!(r.next(5, 3, t0 + tick * 3), DirIndexAction::Rebuild(5));
+        r.settled();
+        assert_eq!(r.next(5, 3, t0 + tick * 4), DirIndexAction::None);
+
+        // Ingest moving the manifest still needs the tick's mark
+        assert_eq!(r.next(6, 4, t0 + tick * 5), DirIndexAction::MarkStale);
+    }
+}
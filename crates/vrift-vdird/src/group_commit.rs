@@ -0,0 +1,187 @@
+//! Group commit for manifest mutations arriving over the socket
+//!
+//! Every connection used to apply its ManifestUpsert/Remove/Rename/
+//! UpdateMtime under its own handler write lock and VDir write transaction,
+//! so a parallel `npm install` serialized thousands of generation bumps.
+//! Connections now hand mutations to one committer task. It collects a burst
+//! (up to `daemon.group_commit_max`, and for at most
+//! `daemon.group_commit_window_us` once more than one is queued) and applies
+//! it with `CommandHandler::handle_mutations`: one lock, and one generation
+//! bump per window of a few dozen mutations so readers never wait out a
+//! whole batch. Waiters are answered once their mutation is published, i.e.
+//! visible in the VDir; nothing is synced to disk first.
+//!
+//! A lone mutation is applied immediately; the window only runs while a
+//! burst is already in progress. It waits on the tokio timer, so it closes
+//! on the timer's millisecond tick rather than to the microsecond.
+
+use crate::commands::CommandHandler;
+use std::sync::Arc;
+use std::time::Duration;
+use tokio::sync::{mpsc, oneshot, RwLock};
+use tokio::time::{timeout_at, Instant};
+use tracing::debug;
+use vrift_ipc::{VeloError, VeloRequest, VeloResponse};
+
+type Pending = (VeloRequest, oneshot::Sender<VeloResponse>);
+
+/// Handle to the committer task
+pub struct GroupCommit {
+    tx: mpsc::Sender<Pending>,
+}
+
+impl GroupCommit {
+    /// Start the committer task with the configured window and batch size
+    pub fn spawn(handler: Arc<RwLock<CommandHandler>>) -> Self {
+        let (window, max) = {
+            let config = vrift_config::config();
+            (
+                Duration::from_micros(config.daemon.group_commit_window_us),
+                config.daemon.group_commit_max.max(1),
+            )
+        };
+        Self::spawn_with(handler, window, max)
+    }
+
+    pub fn spawn_with(handler: Arc<RwLock<CommandHandler>>, window: Duration, max: usize) -> Self {
+        let (tx, rx) = mpsc::channel(max * 4);
+        tokio::spawn(run_committer(rx, handler, window, max));
+        Self { tx }
+    }
+
+    /// Queue a mutation and wait until the batch holding it is published
+    pub async fn submit(&self, request: VeloRequest) -> VeloResponse {
+        let (reply, response) = oneshot::channel();
+        if self.tx.send((request, reply)).await.is_err() {
+            return VeloResponse::Error(VeloError::internal("Group commit stopped"));
+        }
+        response
+            .await
+            .unwrap_or_else(|_| VeloResponse::Error(VeloError::internal("Mutation dropped")))
+    }
+}
+
+async fn run_committer(
+    mut rx: mpsc::Receiver<Pending>,
+    handler: Arc<RwLock<CommandHandler>>,
+    window: Duration,
+    max: usize,
+) {
+    let mut batch = Vec::with_capacity(max);
+    while collect(&mut rx, &mut batch, window, max).await {
+        let (requests, waiters): (Vec<_>, Vec<_>) = batch.drain(..).unzip();
+        let count = requests.len();
+        let responses = handler.write().await.handle_mutations(requests);
+        for (waiter, response) in waiters.into_iter().zip(responses) {
+            // Client gone: nothing to answer
+            let _ = waiter.send(response);
+        }
+        debug!(count, "Group commit");
+    }
+}
+
+/// Wait for the next mutation, then gather the rest of the burst.
+/// Returns false once every sender is gone.
+async fn collect(
+    rx: &mut mpsc::Receiver<Pending>,
+    batch: &mut Vec<Pending>,
+    window: Duration,
+    max: usize,
+) -> bool {
+    let Some(first) = rx.recv().await else {
+        return false;
+    };
+    batch.push(first);
+    drain_ready(rx, batch, max);
+    if batch.len() == 1 || window.is_zero() {
+        return true;
+    }
+
+    // Burst in progress: sleep until the next mutation or the window closes
+    let deadline = Instant::now() + window;
+    while batch.len() < max {
+        match timeout_at(deadline, rx.recv()).await {
+            Ok(Some(pending)) => {
+                batch.push(pending);
+                drain_ready(rx, batch, max);
+            }
+            // Window closed, or the last sender left: apply what we have
+            Ok(None) | Err(_) => break,
+        }
+    }
+    true
+}
+
+fn drain_ready(rx: &mut mpsc::Receiver<Pending>, batch: &mut Vec<Pending>, max: usize) {
+    while batch.len() < max {
+        match rx.try_recv() {
+            Ok(pending) => batch.push(pending),
+            Err(_) => break,
+        }
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+    use crate::vdir::VDir;
+    use crate::ProjectConfig;
+    use tempfile::tempdir;
+    use vrift_ipc::VnodeEntry;
+
+    #[tokio::test]
+    async fn test_concurrent_mutations_are_all_applied() {
+        let temp = tempdir().unwrap();
+        let config = ProjectConfig::from_project_root(temp.path().to_path_buf());
+        let vdir = VDir::create_or_open(&temp.path().join("test.vdir")).unwrap();
+        let manifest = Arc::new(
+            vrift_manifest::lmdb::LmdbManifest::open(temp.path().join("manifest.lmdb")).unwrap(),
+        );
+        let handler = Arc::new(RwLock::new(CommandHandler::new(config, vdir, manifest)));
+        let commits = Arc::new(GroupCommit::spawn_with(
+            Arc::clone(&handler),
+            Duration::from_micros(500),
+            16,
+        ));
+
+        let tasks: Vec<_> = (0..100u8)
+            .map(|i| {
+                let commits = Arc::clone(&commits);
+                tokio::spawn(async move {
+                    commits
+                        .submit(VeloRequest::ManifestUpsert {
+                            path: format!("/f{}", i),
+                            entry: VnodeEntry {
+                                content_hash: [i; 32],
+                                size: i as u64,
+                                mtime: 0,
+                                mode: 0o644,
+                                flags: 0,
+                                _pad: 0,
+                            },
+                        })
+                        .await
+                })
+            })
+            .collect();
+        for task in tasks {
+            assert!(matches!(
+                task.await.unwrap(),
+                VeloResponse::ManifestAck { entry: Some(_) }
+            ));
+        }
+
+        let mut h = handler.write().await;
+        for i in 0..100u8 {
+            let response = h
+                .handle_request(VeloRequest::ManifestGet {
+                    path: format!("/f{}", i),
+                })
+                .await;
+            match response {
+                VeloResponse::ManifestAck { entry: Some(e) } => assert_eq!(e.content_hash, [i; 32]),
+                _ => panic!("missing /f{}", i),
+            }
+        }
+    }
+}
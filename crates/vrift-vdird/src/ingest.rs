@@ -3,15 +3,19 @@
 //! All ingest events from L1 (Shim IPC), L2 (FS Watch), and L3 (Compensation Scan)
 //! flow through this single queue for serialized, conflict-free processing.
 
-use std::collections::HashSet;
 use std::path::PathBuf;
 use std::sync::atomic::{AtomicU8, Ordering};
+use std::sync::Arc;
 use std::time::{Duration, Instant};
-use tokio::sync::mpsc;
+use tokio::sync::{mpsc, Semaphore};
 use tracing::{debug, info};
 
+use crate::coalesce::{event_path, Coalescer, IngestMetrics};
 use crate::watch::IngestEvent;
 
+/// A path written continuously is released after this many debounce windows
+const MAX_DEFER_WINDOWS: u32 = 10;
+
 /// State machine states for Ingest Queue
 #[derive(Debug, Clone, Copy, PartialEq, Eq)]
 #[repr(u8)]
@@ -47,35 +51,52 @@ impl From<u8> for IngestState {
     }
 }
 
-/// Ingest Queue with deduplication
+/// Ingest Queue: producers' events are coalesced per path before ingest
 pub struct IngestQueue {
     /// Event receiver
     rx: mpsc::Receiver<IngestEvent>,
+    /// All producers have hung up
+    closed: bool,
     /// State
     state: AtomicU8,
-    /// Recent paths for deduplication (path -> last_seen)
-    recent: HashSet<PathBuf>,
-    /// Dedup window
-    dedup_window: Duration,
-    /// Last cleanup time
-    last_cleanup: Instant,
+    /// Per-path latest state, released after the debounce window
+    coalescer: Coalescer,
+    /// Paths whose handed-out event the workers finished
+    done_tx: mpsc::UnboundedSender<PathBuf>,
+    done_rx: mpsc::UnboundedReceiver<PathBuf>,
+    /// Pipeline counters (see `IngestMetrics::get_stats`)
+    metrics: Arc<IngestMetrics>,
 }
 
 impl IngestQueue {
     /// Create a new ingest queue
     pub fn new(rx: mpsc::Receiver<IngestEvent>) -> Self {
         let config = vrift_config::config();
-        let dedup_window = Duration::from_millis(config.ingest.dedup_window_ms);
+        let debounce = Duration::from_millis(config.ingest.dedup_window_ms);
+        let (done_tx, done_rx) = mpsc::unbounded_channel();
 
         Self {
             rx,
+            closed: false,
             state: AtomicU8::new(IngestState::Init as u8),
-            recent: HashSet::new(),
-            dedup_window,
-            last_cleanup: Instant::now(),
+            coalescer: Coalescer::new(debounce, debounce * MAX_DEFER_WINDOWS),
+            done_tx,
+            done_rx,
+            metrics: Arc::new(IngestMetrics::default()),
         }
     }
 
+    /// Shared pipeline counters
+    pub fn metrics(&self) -> Arc<IngestMetrics> {
+        Arc::clone(&self.metrics)
+    }
+
+    /// Where workers report the path of each event they finish (see
+    /// `Completion`); a path is not handed out again until then
+    pub fn completions(&self) -> mpsc::UnboundedSender<PathBuf> {
+        self.done_tx.clone()
+    }
+
     /// Get current state
     pub fn state(&self) -> IngestState {
         IngestState::from(self.state.load(Ordering::Acquire))
@@ -105,48 +126,77 @@ impl IngestQueue {
         }
     }
 
-    /// Check if path is in recent set (for deduplication)
-    fn is_recent(&self, path: &PathBuf) -> bool {
-        self.recent.contains(path)
+    /// Move everything the producers have queued into the coalescer
+    fn absorb(&mut self, first: Option<IngestEvent>) {
+        let now = Instant::now();
+        match first {
+            Some(event) => self.coalescer.push(event, now, &self.metrics),
+            None => {
+                self.closed = true;
+                return;
+            }
+        }
+        while let Ok(event) = self.rx.try_recv() {
+            self.coalescer.push(event, now, &self.metrics);
+        }
     }
 
-    /// Mark path as recently processed
-    fn mark_recent(&mut self, path: PathBuf) {
-        self.recent.insert(path);
-    }
+    /// Next batch of up to `max` coalesced events. Returns None once the
+    /// producers are gone and everything pending has been handed out.
+    pub async fn next_batch(&mut self, max: usize) -> Option<Vec<IngestEvent>> {
+        loop {
+            let ready = self
+                .coalescer
+                .take_ready(Instant::now(), max, &self.metrics);
+            if !ready.is_empty() {
+                return Some(ready);
+            }
+            if self.closed {
+                let rest = self.coalescer.take_all(&self.metrics);
+                if !rest.is_empty() {
+                    return Some(rest);
+                }
+                if !self.coalescer.has_parked() {
+                    return None;
+                }
+                // Parked behind an in-flight event of the same path
+                if let Some(path) = self.done_rx.recv().await {
+                    self.coalescer.complete(&path);
+                }
+                continue;
+            }
 
-    /// Cleanup old entries from recent set
-    fn cleanup_recent(&mut self) {
-        if self.last_cleanup.elapsed() > self.dedup_window {
-            self.recent.clear();
-            self.last_cleanup = Instant::now();
+            let deadline = self
+                .coalescer
+                .next_deadline()
+                .map(tokio::time::Instant::from_std);
+            let window = async move {
+                match deadline {
+                    Some(deadline) => tokio::time::sleep_until(deadline).await,
+                    None => std::future::pending().await,
+                }
+            };
+            tokio::select! {
+                first = self.rx.recv() => self.absorb(first),
+                Some(path) = self.done_rx.recv() => self.coalescer.complete(&path),
+                _ = window => {}
+            }
         }
     }
 
-    /// Process next event (with deduplication)
-    pub async fn next(&mut self) -> Option<IngestEvent> {
-        self.cleanup_recent();
-
+    /// Drive `fut` to completion while still absorbing producer events, so
+    /// a saturated worker pool does not stall the watcher
+    async fn absorb_while<F: std::future::Future>(&mut self, fut: F) -> F::Output {
+        tokio::pin!(fut);
         loop {
-            match self.rx.recv().await {
-                Some(event) => {
-                    let path = match &event {
-                        IngestEvent::FileChanged { path } => path,
-                        IngestEvent::DirCreated { path } => path,
-                        IngestEvent::Removed { path } => path,
-                        IngestEvent::SymlinkCreated { path, .. } => path,
-                    };
-
-                    // Dedup check
-                    if self.is_recent(path) {
-                        debug!(?path, "Dedup: skipping recent path");
-                        continue;
-                    }
-
-                    self.mark_recent(path.clone());
-                    return Some(event);
-                }
-                None => return None,
+            if self.closed {
+                return fut.await;
+            }
+            tokio::select! {
+                biased;
+                output = &mut fut => return output,
+                first = self.rx.recv() => self.absorb(first),
+                Some(path) = self.done_rx.recv() => self.coalescer.complete(&path),
             }
         }
     }
@@ -215,6 +265,12 @@ impl IngestHandler {
 
                         // Insert into manifest with classified tier
                         self.manifest.insert(&rel_path, vnode, tier);
+                        if result.was_new
+                            && self.cas.remote().is_some()
+                            && vrift_config::config().storage.remote_write_back
+                        {
+                            self.cas.push(&[result.hash]);
+                        }
 
                         info!(
                             path = %rel_path,
@@ -348,82 +404,101 @@ impl IngestHandler {
     }
 }
 
-/// Consumer task that processes ingest events with batching and async CAS
-pub async fn run_consumer(mut queue: IngestQueue, handler: std::sync::Arc<IngestHandler>) {
-    use tokio::time::timeout;
+/// Reports a worker's path back to the queue when dropped, so the path is
+/// freed even if its handler panicked
+struct Completion {
+    path: PathBuf,
+    done: mpsc::UnboundedSender<PathBuf>,
+}
 
+impl Drop for Completion {
+    fn drop(&mut self) {
+        let _ = self.done.send(std::mem::take(&mut self.path));
+    }
+}
+
+/// Consumer task: coalesced batches feed a bounded pool of blocking
+/// ingest workers. While every worker is busy the queue keeps absorbing (and
+/// coalescing) events instead of letting the producer channel fill up. Each
+/// path has at most one event with the workers (see `Coalescer::complete`).
+pub async fn run_consumer(mut queue: IngestQueue, handler: Arc<IngestHandler>) {
     // Extract config values in a scoped block to drop RwLockReadGuard before await
-    let (batch_size, batch_timeout) = {
+    let (batch_size, workers) = {
         let config = vrift_config::config();
-        (
-            config.ingest.batch_size,
-            Duration::from_millis(config.ingest.batch_timeout_ms),
-        )
+        let workers = config.ingest.threads.unwrap_or_else(|| {
+            std::thread::available_parallelism()
+                .map(|n| n.get())
+                .unwrap_or(4)
+        });
+        (config.ingest.batch_size.max(1), workers.max(1))
     };
 
-    info!(batch_size, batch_timeout_ms = ?batch_timeout, "Ingest consumer started with batching");
+    info!(batch_size, workers, "Ingest consumer started");
 
     // Mark consumer ready
     queue.transition(IngestState::ConsumerReady);
 
-    let mut batch: Vec<IngestEvent> = Vec::with_capacity(batch_size);
-
-    loop {
-        // Collect events up to batch_size or timeout
-        let deadline = Instant::now() + batch_timeout;
-
-        while batch.len() < batch_size {
-            let remaining = deadline.saturating_duration_since(Instant::now());
-            if remaining.is_zero() {
-                break;
-            }
-
-            match timeout(remaining, queue.next()).await {
-                Ok(Some(event)) => {
-                    debug!(?event, "Queued ingest event for batch");
-                    batch.push(event);
-                }
-                Ok(None) => {
-                    // Channel closed, process remaining and exit
-                    if !batch.is_empty() {
-                        process_batch(&handler, std::mem::take(&mut batch)).await;
-                    }
-                    info!("Ingest consumer stopped (channel closed)");
-                    return;
-                }
-                Err(_) => {
-                    // Timeout, process current batch
-                    break;
-                }
-            }
-        }
-
-        // Process batch if not empty
-        if !batch.is_empty() {
-            let batch_len = batch.len();
-            debug!(batch_len, "Processing ingest batch");
-            process_batch(&handler, std::mem::take(&mut batch)).await;
+    let pool = Arc::new(Semaphore::new(workers));
+    let metrics = queue.metrics();
+    let done = queue.completions();
+
+    while let Some(batch) = queue.next_batch(batch_size).await {
+        debug!(batch_len = batch.len(), stats = ?metrics.get_stats(), "Processing ingest batch");
+        for event in batch {
+            let permit = queue
+                .absorb_while(Arc::clone(&pool).acquire_owned())
+                .await
+                .expect("ingest pool closed");
+            let handler = Arc::clone(&handler);
+            let metrics = Arc::clone(&metrics);
+            let completion = Completion {
+                path: event_path(&event).to_path_buf(),
+                done: done.clone(),
+            };
+            metrics.worker_started();
+            // CPU/IO-bound CAS operations
+            tokio::task::spawn_blocking(move || {
+                handler.handle(event);
+                metrics.worker_finished();
+                drop(completion);
+                drop(permit);
+            });
         }
     }
-}
 
-/// Process a batch of ingest events with async CAS storage
-async fn process_batch(handler: &std::sync::Arc<IngestHandler>, events: Vec<IngestEvent>) {
-    use tokio::task::JoinSet;
-
-    let mut join_set: JoinSet<()> = JoinSet::new();
+    // Channel closed: wait for in-flight workers
+    let _ = pool.acquire_many(workers as u32).await;
+    info!(stats = ?metrics.get_stats(), "Ingest consumer stopped (channel closed)");
+}
 
-    for event in events {
-        let handler = handler.clone();
-        join_set.spawn(async move {
-            // Use spawn_blocking for CPU/IO-bound CAS operations
-            let _ = tokio::task::spawn_blocking(move || {
-                handler.handle(event);
-            })
-            .await;
-        });
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    #[tokio::test]
+    async fn test_path_waits_for_its_in_flight_event() {
+        let (tx, rx) = mpsc::channel(16);
+        let mut queue = IngestQueue::new(rx);
+        let done = queue.completions();
+        let path = PathBuf::from("/p/a.rs");
+
+        tx.send(IngestEvent::FileChanged { path: path.clone() })
+            .await
+            .unwrap();
+        let first = queue.next_batch(8).await.unwrap();
+        assert!(matches!(&first[..], [IngestEvent::FileChanged { .. }]));
+
+        // The removal must not overtake the change still being ingested
+        tx.send(IngestEvent::Removed { path: path.clone() })
+            .await
+            .unwrap();
+        drop(tx);
+        let early = tokio::time::timeout(Duration::from_secs(1), queue.next_batch(8)).await;
+        assert!(early.is_err(), "released while a.rs was in flight");
+
+        done.send(path).unwrap();
+        let second = queue.next_batch(8).await.unwrap();
+        assert!(matches!(&second[..], [IngestEvent::Removed { .. }]));
+        assert!(queue.next_batch(8).await.is_none());
     }
-
-    // Wait for all tasks in batch to complete
-    while join_set.join_next().await.is_some() {}
 }
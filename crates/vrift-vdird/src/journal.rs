@@ -2,17 +2,37 @@
 //!
 //! Records intent before reingest operations and clears on completion,
 //! enabling idempotent recovery after crashes.
+//!
+//! ## On-disk format
+//!
+//! An append-only log split into segments `<path>.<seq>` (8 digits). Each
+//! record is one 64-byte block, followed for intent records by the vpath and
+//! temp path padded to whole blocks:
+//!
+//! ```text
+//! 0   magic "VRJ1"       4   kind           5   has_hash   6   tail blocks (u16)
+//! 8   vpath key (FNV-1a) 16  started_at     24  cas_hash [32]
+//! 56  vpath len (u16)    58  temp len (u16) 60  CRC32 of header[..60] + tail
+//! ```
+//!
+//! Recovery replays segments oldest first and stops each one at the first
+//! torn or corrupt record. Every operation is one `write(2)`, so it survives
+//! a vDird crash immediately; fsync (needed only against power loss) is
+//! group-committed every `SYNC_EVERY` records or `SYNC_INTERVAL`. Once the
+//! log outgrows the live entries it is compacted into a fresh segment.
 
 use std::collections::HashMap;
-use std::fs::{self, File};
-use std::io::{self, BufReader, BufWriter};
+use std::fs::{self, File, OpenOptions};
+use std::io::{self, Write};
 use std::path::{Path, PathBuf};
-use std::time::{SystemTime, UNIX_EPOCH};
+use std::time::{Duration, Instant, SystemTime, UNIX_EPOCH};
 
 use rkyv::Archive;
 use serde::{Deserialize, Serialize};
 use tracing::{debug, info, warn};
 
+use crate::vdir::fnv1a_hash;
+
 /// Journal entry for a pending reingest operation
 #[derive(Debug, Clone, Serialize, Deserialize, Archive, rkyv::Serialize, rkyv::Deserialize)]
 #[rkyv(derive(Debug))]
@@ -27,48 +47,116 @@ pub struct JournalEntry {
     pub started_at: u64,
 }
 
+const RECORD_MAGIC: &[u8; 4] = b"VRJ1";
+const BLOCK: usize = 64;
+const KIND_INTENT: u8 = 1;
+const KIND_CAS_HASH: u8 = 2;
+const KIND_COMPLETE: u8 = 3;
+
+/// Roll to a new segment once the current one reaches this size
+const SEGMENT_MAX: u64 = 4 << 20;
+
+/// fsync after this many unsynced records...
+const SYNC_EVERY: usize = 64;
+/// ...or when the last fsync is older than this
+const SYNC_INTERVAL: Duration = Duration::from_millis(50);
+
+/// Compact once the log holds at least this many records and more than
+/// `COMPACT_RATIO` per live entry
+const COMPACT_MIN_RECORDS: u64 = 4096;
+const COMPACT_RATIO: u64 = 4;
+
 /// Reingest journal for crash recovery
 pub struct ReingestJournal {
-    /// Path to journal file
+    /// Journal path: segments are `<path>.<seq>`; a file at `path` itself is
+    /// a pre-segment journal, migrated on open
     path: PathBuf,
     /// In-memory entries
     entries: HashMap<String, JournalEntry>,
+    /// Segment currently appended to
+    segment: File,
+    segment_seq: u64,
+    segment_len: u64,
+    /// Live segments, oldest first (includes the current one)
+    segments: Vec<u64>,
+    /// Records across live segments
+    records: u64,
+    unsynced: usize,
+    last_sync: Instant,
 }
 
 impl ReingestJournal {
-    /// Open or create journal at the given path
+    /// Open or create journal at the given path, replaying its segments
     pub fn open(path: &Path) -> io::Result<Self> {
-        let entries = if path.exists() {
-            match File::open(path) {
-                Ok(file) => {
-                    let reader = BufReader::new(file);
-                    let mut data = Vec::new();
-                    std::io::Read::read_to_end(&mut reader.into_inner(), &mut data).ok();
-                    match rkyv::from_bytes::<HashMap<String, JournalEntry>, rkyv::rancor::Error>(
-                        &data,
-                    ) {
-                        Ok(entries) => entries,
-                        Err(e) => {
-                            warn!(error = %e, "Failed to deserialize journal, starting fresh");
-                            HashMap::new()
-                        }
-                    }
-                }
-                Err(e) => {
-                    warn!(error = %e, "Failed to open journal, starting fresh");
-                    HashMap::new()
-                }
+        if let Some(parent) = path.parent() {
+            fs::create_dir_all(parent)?;
+        }
+
+        let legacy = path.is_file();
+        let mut entries = Self::load_legacy(path);
+
+        let mut keys: HashMap<u64, String> =
+            entries.keys().map(|v| (fnv1a_hash(v), v.clone())).collect();
+        let segments = list_segments(path)?;
+        for &seq in &segments {
+            let data = fs::read(segment_path(path, seq))?;
+            let replayed = replay(&data, &mut entries, &mut keys);
+            if replayed < data.len() {
+                warn!(
+                    segment = seq,
+                    offset = replayed,
+                    "Journal segment has a torn tail, ignoring the rest"
+                );
             }
-        } else {
-            HashMap::new()
-        };
+        }
+
+        // Continue in a fresh segment holding only the live entries; older
+        // segments (and a legacy file) are removed once it is durable.
+        let seq = segments.last().copied().unwrap_or(0) + 1;
+        let (segment, segment_len) = write_segment(path, seq, &entries)?;
+        remove_segments(path, &segments);
+        if legacy {
+            fs::remove_file(path)?;
+            info!(
+                entries = entries.len(),
+                "Migrated reingest journal to segments"
+            );
+        }
 
         Ok(Self {
             path: path.to_path_buf(),
+            records: entries.len() as u64,
             entries,
+            segment,
+            segment_seq: seq,
+            segment_len,
+            segments: vec![seq],
+            unsynced: 0,
+            last_sync: Instant::now(),
         })
     }
 
+    /// Entries of a pre-segment journal (one rkyv-serialized map at `path`)
+    fn load_legacy(path: &Path) -> HashMap<String, JournalEntry> {
+        if !path.is_file() {
+            return HashMap::new();
+        }
+        let data = match fs::read(path) {
+            Ok(data) => data,
+            Err(e) => {
+                warn!(error = %e, "Failed to open journal, starting fresh");
+                return HashMap::new();
+            }
+        };
+        match rkyv::from_bytes::<HashMap<String, JournalEntry>, rkyv::rancor::Error>(&data) {
+            Ok(entries) => entries,
+            Err(e) => {
+                warn!(error = %e, "Failed to deserialize journal, starting fresh");
+                HashMap::new()
+            }
+        }
+    }
+
     /// Record intent to reingest a file
     pub fn record(&mut self, vpath: &str, temp_path: &str) -> io::Result<()> {
         let entry = JournalEntry {
@@ -80,31 +168,50 @@ impl ReingestJournal {
                 .map(|d| d.as_secs())
                 .unwrap_or(0),
         };
-
-        self.entries.insert(vpath.to_string(), entry);
-        self.flush()?;
+        self.insert(entry)?;
 
         debug!(vpath, temp_path, "Recorded reingest intent");
         Ok(())
     }
 
+    fn insert(&mut self, entry: JournalEntry) -> io::Result<()> {
+        let mut buf = Vec::with_capacity(BLOCK * 2);
+        encode_intent(&entry, &mut buf)?;
+        self.append(&buf)?;
+        self.entries.insert(entry.vpath.clone(), entry);
+        self.maybe_compact()
+    }
+
     /// Update entry with CAS hash after successful CAS ingest
     pub fn set_cas_hash(&mut self, vpath: &str, hash: [u8; 32]) -> io::Result<()> {
+        if !self.entries.contains_key(vpath) {
+            return Ok(());
+        }
+        let mut buf = Vec::with_capacity(BLOCK);
+        encode_header(KIND_CAS_HASH, vpath, Some(&hash), 0, 0, 0, &[], &mut buf);
+        self.append(&buf)?;
         if let Some(entry) = self.entries.get_mut(vpath) {
             entry.cas_hash = Some(hash);
-            self.flush()?;
-            debug!(vpath, "Updated journal with CAS hash");
         }
+        debug!(vpath, "Updated journal with CAS hash");
         Ok(())
     }
 
     /// Mark reingest as complete and remove from journal
     pub fn complete(&mut self, vpath: &str) -> io::Result<()> {
-        if self.entries.remove(vpath).is_some() {
-            self.flush()?;
-            debug!(vpath, "Removed completed reingest from journal");
+        if !self.entries.contains_key(vpath) {
+            return Ok(());
         }
-        Ok(())
+        self.append_complete(vpath)?;
+        self.entries.remove(vpath);
+        debug!(vpath, "Removed completed reingest from journal");
+        self.maybe_compact()
+    }
+
+    fn append_complete(&mut self, vpath: &str) -> io::Result<()> {
+        let mut buf = Vec::with_capacity(BLOCK);
+        encode_header(KIND_COMPLETE, vpath, None, 0, 0, 0, &[], &mut buf);
+        self.append(&buf)
     }
 
     /// Get pending entries for recovery
@@ -140,33 +247,81 @@ impl ReingestJournal {
 
         let count = stale_keys.len();
         for key in stale_keys {
+            self.append_complete(&key)?;
             self.entries.remove(&key);
         }
 
         if count > 0 {
-            self.flush()?;
+            self.sync()?;
+            self.maybe_compact()?;
             info!(count, "Cleaned stale journal entries");
         }
 
         Ok(count)
     }
 
-    /// Flush journal to disk
-    fn flush(&self) -> io::Result<()> {
-        // Ensure parent directory exists
-        if let Some(parent) = self.path.parent() {
-            fs::create_dir_all(parent)?;
+    /// Append one encoded record; fsync when the group commit is due
+    fn append(&mut self, record: &[u8]) -> io::Result<()> {
+        self.segment.write_all(record)?;
+        self.segment_len += record.len() as u64;
+        self.records += 1;
+        self.unsynced += 1;
+        if self.unsynced >= SYNC_EVERY || self.last_sync.elapsed() >= SYNC_INTERVAL {
+            self.sync()?;
+        }
+        if self.segment_len >= SEGMENT_MAX {
+            self.roll()?;
         }
+        Ok(())
+    }
 
-        // Write atomically via temp file
-        let temp_path = self.path.with_extension("tmp");
-        let file = File::create(&temp_path)?;
-        let mut writer = BufWriter::new(file);
-        let data = rkyv::to_bytes::<rkyv::rancor::Error>(&self.entries)
-            .map_err(|e| io::Error::new(io::ErrorKind::InvalidData, e.to_string()))?;
-        std::io::Write::write_all(&mut writer, &data)?;
+    /// fsync records appended since the last group commit
+    pub fn sync(&mut self) -> io::Result<()> {
+        if self.unsynced > 0 {
+            self.segment.sync_data()?;
+            self.unsynced = 0;
+        }
+        self.last_sync = Instant::now();
+        Ok(())
+    }
 
-        fs::rename(&temp_path, &self.path)?;
+    /// Seal the current segment and continue in a new one
+    fn roll(&mut self) -> io::Result<()> {
+        self.sync()?;
+        self.segment_seq += 1;
+        self.segment = create_segment(&segment_path(&self.path, self.segment_seq))?;
+        self.segment_len = 0;
+        self.segments.push(self.segment_seq);
+        Ok(())
+    }
+
+    fn maybe_compact(&mut self) -> io::Result<()> {
+        if self.records >= COMPACT_MIN_RECORDS
+            && self.records > COMPACT_RATIO * self.entries.len() as u64
+        {
+            self.compact()?;
+        }
+        Ok(())
+    }
+
+    /// Rewrite the live entries into a new segment, then drop older ones.
+    /// A crash in between leaves both; replaying them yields the same state.
+    fn compact(&mut self) -> io::Result<()> {
+        let seq = self.segment_seq + 1;
+        let (segment, segment_len) = write_segment(&self.path, seq, &self.entries)?;
+        remove_segments(&self.path, &self.segments);
+        debug!(
+            from = self.records,
+            to = self.entries.len(),
+            "Compacted reingest journal"
+        );
+        self.segment = segment;
+        self.segment_seq = seq;
+        self.segment_len = segment_len;
+        self.segments = vec![seq];
+        self.records = self.entries.len() as u64;
+        self.unsynced = 0;
+        self.last_sync = Instant::now();
         Ok(())
     }
 
@@ -181,6 +336,196 @@ impl ReingestJournal {
     }
 }
 
+impl Drop for ReingestJournal {
+    fn drop(&mut self) {
+        if let Err(e) = self.sync() {
+            warn!(error = %e, "Failed to sync reingest journal");
+        }
+    }
+}
+
+fn segment_path(path: &Path, seq: u64) -> PathBuf {
+    let mut name = path.as_os_str().to_owned();
+    name.push(format!(".{:08}", seq));
+    PathBuf::from(name)
+}
+
+fn create_segment(path: &Path) -> io::Result<File> {
+    OpenOptions::new()
+        .create(true)
+        .truncate(true)
+        .write(true)
+        .open(path)
+}
+
+/// Write `entries` as intent records into a new, synced segment `seq`.
+/// Returns the open segment and its length.
+fn write_segment(
+    path: &Path,
+    seq: u64,
+    entries: &HashMap<String, JournalEntry>,
+) -> io::Result<(File, u64)> {
+    let mut buf = Vec::with_capacity(entries.len() * BLOCK * 2);
+    for entry in entries.values() {
+        encode_intent(entry, &mut buf)?;
+    }
+    let mut segment = create_segment(&segment_path(path, seq))?;
+    segment.write_all(&buf)?;
+    segment.sync_data()?;
+    if let Some(parent) = path.parent() {
+        // Make the new segment's directory entry durable (best effort)
+        if let Ok(dir) = File::open(parent) {
+            let _ = dir.sync_all();
+        }
+    }
+    Ok((segment, buf.len() as u64))
+}
+
+fn remove_segments(path: &Path, segments: &[u64]) {
+    for &seq in segments {
+        if let Err(e) = fs::remove_file(segment_path(path, seq)) {
+            warn!(segment = seq, error = %e, "Failed to remove compacted journal segment");
+        }
+    }
+}
+
+/// Sequence numbers of the segments next to `path`, oldest first
+fn list_segments(path: &Path) -> io::Result<Vec<u64>> {
+    let (Some(dir), Some(name)) = (path.parent(), path.file_name()) else {
+        return Ok(Vec::new());
+    };
+    let prefix = format!("{}.", name.to_string_lossy());
+    let mut segments: Vec<u64> = fs::read_dir(dir)?
+        .filter_map(|e| e.ok())
+        .filter_map(|e| {
+            let name = e.file_name();
+            let seq = name.to_str()?.strip_prefix(&prefix)?;
+            if seq.len() != 8 {
+                return None;
+            }
+            seq.parse().ok()
+        })
+        .collect();
+    segments.sort_unstable();
+    Ok(segments)
+}
+
+fn encode_intent(entry: &JournalEntry, buf: &mut Vec<u8>) -> io::Result<()> {
+    let (vpath, temp) = (entry.vpath.as_bytes(), entry.temp_path.as_bytes());
+    if vpath.len() > u16::MAX as usize || temp.len() > u16::MAX as usize {
+        return Err(io::Error::new(
+            io::ErrorKind::InvalidInput,
+            "journal path too long",
+        ));
+    }
+    let mut tail = Vec::with_capacity((vpath.len() + temp.len()).next_multiple_of(BLOCK));
+    tail.extend_from_slice(vpath);
+    tail.extend_from_slice(temp);
+    tail.resize(tail.len().next_multiple_of(BLOCK), 0);
+    encode_header(
+        KIND_INTENT,
+        &entry.vpath,
+        entry.cas_hash.as_ref(),
+        entry.started_at,
+        vpath.len() as u16,
+        temp.len() as u16,
+        &tail,
+        buf,
+    );
+    Ok(())
+}
+
+#[allow(clippy::too_many_arguments)]
+fn encode_header(
+    kind: u8,
+    vpath: &str,
+    cas_hash: Option<&[u8; 32]>,
+    started_at: u64,
+    vpath_len: u16,
+    temp_len: u16,
+    tail: &[u8],
+    buf: &mut Vec<u8>,
+) {
+    let mut header = [0u8; BLOCK];
+    header[0..4].copy_from_slice(RECORD_MAGIC);
+    header[4] = kind;
+    header[5] = cas_hash.is_some() as u8;
+    header[6..8].copy_from_slice(&((tail.len() / BLOCK) as u16).to_le_bytes());
+    header[8..16].copy_from_slice(&fnv1a_hash(vpath).to_le_bytes());
+    header[16..24].copy_from_slice(&started_at.to_le_bytes());
+    if let Some(hash) = cas_hash {
+        header[24..56].copy_from_slice(hash);
+    }
+    header[56..58].copy_from_slice(&vpath_len.to_le_bytes());
+    header[58..60].copy_from_slice(&temp_len.to_le_bytes());
+    let mut crc = crc32fast::Hasher::new();
+    crc.update(&header[..60]);
+    crc.update(tail);
+    header[60..64].copy_from_slice(&crc.finalize().to_le_bytes());
+    buf.extend_from_slice(&header);
+    buf.extend_from_slice(tail);
+}
+
+/// Apply the records in one segment. Returns the length of its valid prefix.
+fn replay(
+    data: &[u8],
+    entries: &mut HashMap<String, JournalEntry>,
+    keys: &mut HashMap<u64, String>,
+) -> usize {
+    let u16_at = |b: &[u8], at: usize| u16::from_le_bytes([b[at], b[at + 1]]) as usize;
+    let u64_at = |b: &[u8], at: usize| u64::from_le_bytes(b[at..at + 8].try_into().unwrap());
+
+    let mut offset = 0;
+    while let Some(header) = data.get(offset..offset + BLOCK) {
+        if &header[0..4] != RECORD_MAGIC {
+            break;
+        }
+        let tail_len = u16_at(header, 6) * BLOCK;
+        let Some(tail) = data.get(offset + BLOCK..offset + BLOCK + tail_len) else {
+            break;
+        };
+        let mut crc = crc32fast::Hasher::new();
+        crc.update(&header[..60]);
+        crc.update(tail);
+        if crc.finalize().to_le_bytes() != header[60..64] {
+            break;
+        }
+
+        let key = u64_at(header, 8);
+        let cas_hash = (header[5] != 0).then(|| header[24..56].try_into().unwrap());
+        match header[4] {
+            KIND_INTENT => {
+                let (vpath_len, temp_len) = (u16_at(header, 56), u16_at(header, 58));
+                let Some(paths) = tail.get(..vpath_len + temp_len) else {
+                    break;
+                };
+                let vpath = String::from_utf8_lossy(&paths[..vpath_len]).into_owned();
+                let entry = JournalEntry {
+                    vpath: vpath.clone(),
+                    temp_path: String::from_utf8_lossy(&paths[vpath_len..]).into_owned(),
+                    cas_hash,
+                    started_at: u64_at(header, 16),
+                };
+                keys.insert(key, vpath.clone());
+                entries.insert(vpath, entry);
+            }
+            KIND_CAS_HASH => {
+                if let Some(entry) = keys.get(&key).and_then(|v| entries.get_mut(v)) {
+                    entry.cas_hash = cas_hash;
+                }
+            }
+            KIND_COMPLETE => {
+                if let Some(vpath) = keys.remove(&key) {
+                    entries.remove(&vpath);
+                }
+            }
+            _ => break,
+        }
+        offset += BLOCK + tail_len;
+    }
+    offset
+}
+
 #[cfg(test)]
 mod tests {
     use super::*;
@@ -246,8 +591,7 @@ mod tests {
             cas_hash: None,
             started_at: 0, // Very old
         };
-        journal.entries.insert("old.txt".to_string(), old_entry);
-        journal.flush().unwrap();
+        journal.insert(old_entry).unwrap();
 
         // Add recent entry
         journal.record("new.txt", "/tmp/new.tmp").unwrap();
@@ -258,4 +602,54 @@ mod tests {
         assert_eq!(journal.len(), 1);
         assert!(journal.entries.contains_key("new.txt"));
     }
+
+    #[test]
+    fn test_journal_replay_stops_at_torn_tail() {
+        let dir = tempdir().unwrap();
+        let path = dir.path().join("journal.bin");
+
+        let seq = {
+            let mut journal = ReingestJournal::open(&path).unwrap();
+            journal.record("a.txt", "/tmp/a.tmp").unwrap();
+            journal.record("b.txt", "/tmp/b.tmp").unwrap();
+            journal.complete("a.txt").unwrap();
+            journal.segment_seq
+        };
+
+        // Half-written record at the end (crash mid-append)
+        let mut segment = OpenOptions::new()
+            .append(true)
+            .open(segment_path(&path, seq))
+            .unwrap();
+        segment.write_all(&RECORD_MAGIC[..]).unwrap();
+        segment.write_all(&[KIND_COMPLETE; 20]).unwrap();
+        drop(segment);
+
+        let journal = ReingestJournal::open(&path).unwrap();
+        assert_eq!(journal.len(), 1);
+        assert_eq!(journal.pending_entries()[0].temp_path, "/tmp/b.tmp");
+        // Replayed into one fresh segment
+        assert_eq!(list_segments(&path).unwrap(), vec![seq + 1]);
+    }
+
+    #[test]
+    fn test_journal_compacts_churn() {
+        let dir = tempdir().unwrap();
+        let path = dir.path().join("journal.bin");
+
+        let mut journal = ReingestJournal::open(&path).unwrap();
+        journal.record("keep.txt", "/tmp/keep.tmp").unwrap();
+        for i in 0..COMPACT_MIN_RECORDS {
+            let vpath = format!("churn/{}.o", i);
+            journal.record(&vpath, "/tmp/churn.tmp").unwrap();
+            journal.complete(&vpath).unwrap();
+        }
+        assert!(journal.records < COMPACT_MIN_RECORDS);
+        assert_eq!(journal.segments.len(), 1);
+        drop(journal);
+
+        let journal = ReingestJournal::open(&path).unwrap();
+        assert_eq!(journal.len(), 1);
+        assert!(journal.entries.contains_key("keep.txt"));
+    }
 }
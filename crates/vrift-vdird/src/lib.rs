@@ -14,11 +14,33 @@
 //! Clients (InceptionLayer) communicate via Unix Domain Socket:
 //! - Socket path: `~/.vrift/sockets/<project_id>.sock`
 //! - Protocol: rkyv-serialized VeloRequest/VeloResponse
+//!
+//! Fire-and-forget manifest mutations may instead arrive through a shm
+//! mutation ring next to the VDir file (see `ring`). Either way they are
+//! applied in batches, a few dozen per VDir generation bump (see
+//! `group_commit`).
+//!
+//! Directory listings are published into the VDir as well (see `dir_index`)
+//! so clients serve readdir from shared memory, together with a filter of
+//! manifest keys that lets them reject guaranteed misses without IPC.
+//!
+//! Processes also report the blobs they open; the next run of the same
+//! command has them read ahead before it asks (see `prefetch`).
+//!
+//! Their interposition counters (VDir hits, IPC latency, fallbacks) land in
+//! a shm file vDird aggregates; `VeloRequest::Metrics` exports them in
+//! Prometheus text format (see `metrics`).
 
+pub mod coalesce;
 pub mod commands;
+pub mod dir_index;
+pub mod group_commit;
 pub mod ignore;
 pub mod ingest;
 pub mod journal;
+pub mod metrics;
+pub mod prefetch;
+pub mod ring;
 pub mod scan;
 pub mod socket;
 pub mod state;
@@ -26,7 +48,8 @@ pub mod vdir;
 pub mod watch;
 
 use anyhow::Result;
-use std::path::PathBuf;
+use std::path::{Path, PathBuf};
+use std::sync::Arc;
 use tracing::info;
 
 /// Project configuration for a vdir_d instance
@@ -180,8 +203,16 @@ pub async fn run_daemon(config: ProjectConfig) -> Result<()> {
         .map_err(|e| anyhow::anyhow!("Failed to initialize CAS: {}", e))?;
     info!(root = %cas.root().display(), "CAS store initialized");
 
+    // Remote CAS tier shared between nodes (fetch on miss, write-back)
+    let remote = open_remote_cas(&config.cas_path);
+    let cas = match &remote {
+        Some(remote) if cas.root() == config.cas_path => cas.with_remote(Arc::clone(remote)),
+        _ => cas,
+    };
+
     // Phase 1: Start consumer FIRST (consumer-first pattern)
     let ingest_queue = ingest::IngestQueue::new(ingest_rx);
+    let ingest_metrics = ingest_queue.metrics();
     let handler = std::sync::Arc::new(ingest::IngestHandler::new(
         config.project_root.clone(),
         manifest.clone(),
@@ -217,6 +248,7 @@ pub async fn run_daemon(config: ProjectConfig) -> Result<()> {
     // P1: Periodic manifest commit task (every 30 seconds)
     let commit_manifest = manifest.clone();
     let commit_state_path = state_path.clone();
+    let commit_ingest_metrics = ingest_metrics.clone();
     let commit_handle = tokio::spawn(async move {
         let mut interval = tokio::time::interval(std::time::Duration::from_secs(30));
         loop {
@@ -233,7 +265,10 @@ pub async fn run_daemon(config: ProjectConfig) -> Result<()> {
                     if let Err(e) = state.save(&commit_state_path) {
                         tracing::warn!(error = %e, "Failed to save state after commit");
                     }
-                    tracing::debug!("Periodic manifest commit completed");
+                    tracing::debug!(
+                        ingest = ?commit_ingest_metrics.get_stats(),
+                        "Periodic manifest commit completed"
+                    );
                 }
                 Err(e) => {
                     tracing::warn!(error = %e, "Periodic manifest commit failed");
@@ -243,7 +278,8 @@ pub async fn run_daemon(config: ProjectConfig) -> Result<()> {
     });
     info!("Periodic commit task started (30s interval)");
 
-    let socket_handle = socket::run_listener(config, vdir, manifest.clone());
+    let socket_handle =
+        socket::run_listener(config, vdir, manifest.clone(), ingest_metrics, remote);
 
     // Wait for any task to complete, or signal for graceful shutdown
     tokio::select! {
@@ -280,6 +316,28 @@ pub async fn run_daemon(config: ProjectConfig) -> Result<()> {
     Ok(())
 }
 
+/// Remote tier from `storage.remote`, opened once over `cas_path` (its
+/// fetch cache is per CAS root). None if unset or unusable.
+fn open_remote_cas(cas_path: &Path) -> Option<Arc<vrift_cas::RemoteCas>> {
+    let storage = vrift_config::config().storage.clone();
+    let url = storage.remote.as_deref()?;
+    match vrift_cas::RemoteCas::open(
+        url,
+        cas_path,
+        storage.remote_cache_mb << 20,
+        storage.remote_parallelism,
+    ) {
+        Ok(remote) => {
+            info!(remote = %url, cache_mb = storage.remote_cache_mb, "Remote CAS tier enabled");
+            Some(Arc::new(remote))
+        }
+        Err(e) => {
+            tracing::warn!(remote = %url, error = %e, "Remote CAS tier unavailable");
+            None
+        }
+    }
+}
+
 #[cfg(test)]
 mod tests {
     use super::*;
@@ -0,0 +1,124 @@
+//! Interposition counters reported by client processes
+//!
+//! Each InceptionLayer process bumps its own slot of a shm file next to the
+//! VDir file (layout: `vrift_ipc::metrics`). vDird sums the slots on demand
+//! and periodically reaps the slots of exited processes into retired
+//! totals, so counters stay monotonic and slots get reused.
+
+use anyhow::{Context, Result};
+use memmap2::MmapMut;
+use std::fs::OpenOptions;
+use std::path::{Path, PathBuf};
+use std::sync::Mutex;
+use tracing::info;
+use vrift_ipc::metrics::{
+    metrics_file_size, MetricsBlock, MetricsSnapshot, METRICS_COUNTERS, METRICS_SUFFIX,
+};
+
+/// Metrics file path for a VDir file: `<vdir_path>.metrics`
+pub fn metrics_path(vdir_path: &Path) -> PathBuf {
+    let mut path = vdir_path.as_os_str().to_owned();
+    path.push(METRICS_SUFFIX);
+    PathBuf::from(path)
+}
+
+/// Mapped metrics file
+pub struct InceptionMetrics {
+    _mmap: MmapMut,
+    block: MetricsBlock,
+    /// Counts of processes whose slot was reaped
+    retired: Mutex<[u64; METRICS_COUNTERS]>,
+}
+
+impl InceptionMetrics {
+    /// Open the metrics file, keeping slots of clients still running from a
+    /// previous vDird run. A missing or foreign file is (re)initialized.
+    pub fn create_or_open(path: &Path) -> Result<Self> {
+        let size = metrics_file_size();
+        let file = OpenOptions::new()
+            .read(true)
+            .write(true)
+            .create(true)
+            .truncate(false)
+            .open(path)
+            .context("Failed to open metrics file")?;
+
+        let fresh = file.metadata()?.len() != size as u64;
+        if fresh {
+            file.set_len(size as u64)?;
+        }
+
+        let mut mmap = unsafe { MmapMut::map_mut(&file)? };
+        let ptr = mmap.as_mut_ptr();
+
+        let attached = if fresh {
+            None
+        } else {
+            unsafe { MetricsBlock::attach(ptr, size) }
+        };
+        let block = match attached {
+            Some(block) => block,
+            None => {
+                info!(path = %path.display(), size, "Initialized metrics file");
+                unsafe { MetricsBlock::init(ptr, size) }
+                    .context("Metrics file mapping is misaligned")?
+            }
+        };
+
+        Ok(Self {
+            _mmap: mmap,
+            block,
+            retired: Mutex::new([0; METRICS_COUNTERS]),
+        })
+    }
+
+    /// Totals over live and exited clients; reaps the slots of the latter
+    pub fn collect(&self) -> MetricsSnapshot {
+        let mut retired = self.retired.lock().unwrap();
+        self.block.collect(&mut retired, process_alive)
+    }
+}
+
+/// False only once the pid is gone (EPERM still means it exists)
+fn process_alive(pid: u32) -> bool {
+    let alive = unsafe { libc::kill(pid as libc::pid_t, 0) } == 0;
+    alive || std::io::Error::last_os_error().raw_os_error() != Some(libc::ESRCH)
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+    use vrift_ipc::metrics::Metric;
+
+    #[test]
+    fn test_reopen_keeps_live_slots_and_reaps_dead() {
+        let dir = tempfile::tempdir().unwrap();
+        let path = metrics_path(&dir.path().join("test.vdir"));
+        let own = std::process::id();
+
+        {
+            let metrics = InceptionMetrics::create_or_open(&path).unwrap();
+            metrics.block.claim(own).unwrap().add(Metric::VdirHit, 3);
+            // Not a valid pid, so always dead
+            metrics
+                .block
+                .claim(i32::MAX as u32)
+                .unwrap()
+                .add(Metric::VdirMiss, 1);
+        }
+
+        let metrics = InceptionMetrics::create_or_open(&path).unwrap();
+        let snapshot = metrics.collect();
+        assert_eq!(snapshot.processes, 1);
+        assert_eq!(snapshot.get(Metric::VdirHit), 3);
+        assert_eq!(snapshot.get(Metric::VdirMiss), 1);
+
+        // The reaped slot is free again; its counts stay in the totals
+        assert!(metrics
+            .block
+            .slots()
+            .iter()
+            .all(|s| s.pid() != i32::MAX as u32));
+        assert_eq!(metrics.collect().get(Metric::VdirMiss), 1);
+    }
+}
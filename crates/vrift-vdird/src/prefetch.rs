@@ -0,0 +1,458 @@
+//! Access-trace driven prefetch
+//!
+//! Builds rerun the same commands over mostly the same inputs. The inception
+//! layer reports the blobs each process opens (`AccessTrace`, first-open
+//! order) and announces the process as soon as it starts (`PrefetchHint`).
+//! Sequences are learned per argv[0] + working directory; on a hint, the
+//! blobs that command read in its recent runs are handed to the kernel for
+//! readahead (`posix_fadvise(WILLNEED)`, `F_RDADVISE` on macOS) while the
+//! process is still starting up, so its opens hit the page cache.
+//!
+//! Every hint starts a new run of its sequence. Blobs not read during the
+//! last `STALE_RUNS` runs are no longer prefetched, and make room for new
+//! ones once the sequence is full. Sequences are saved to
+//! `.vrift/prefetch.bin` so they survive a vDird restart.
+
+use std::collections::HashMap;
+use std::fs;
+use std::io;
+use std::path::{Path, PathBuf};
+use std::sync::atomic::{AtomicBool, AtomicU64, Ordering};
+use std::sync::Mutex;
+use std::time::{Duration, Instant};
+
+use rkyv::Archive;
+use serde::{Deserialize, Serialize};
+use tracing::{debug, info, warn};
+use vrift_ipc::AccessedBlob;
+
+use crate::vdir::fnv1a_hash;
+
+/// Runs a blob may go unread before it stops being prefetched
+const STALE_RUNS: u32 = 8;
+
+/// Commands remembered; the least recently started one is forgotten first
+const MAX_SEQUENCES: usize = 1024;
+
+/// Hints for one sequence closer together than this share one readahead
+/// (a parallel build starts the same command many times at once)
+const REPREFETCH_INTERVAL: Duration = Duration::from_secs(2);
+
+#[derive(Debug, Clone, Serialize, Deserialize, Archive, rkyv::Serialize, rkyv::Deserialize)]
+struct LearnedBlob {
+    blob: AccessedBlob,
+    /// Last run that opened it
+    last_run: u32,
+}
+
+/// On-disk form of one sequence
+#[derive(Debug, Clone, Serialize, Deserialize, Archive, rkyv::Serialize, rkyv::Deserialize)]
+struct StoredSequence {
+    key: u64,
+    run: u32,
+    last_used: u64,
+    blobs: Vec<LearnedBlob>,
+}
+
+#[derive(Debug, Default, Serialize, Deserialize, Archive, rkyv::Serialize, rkyv::Deserialize)]
+struct PrefetchTable {
+    sequences: Vec<StoredSequence>,
+}
+
+#[derive(Default)]
+struct Sequence {
+    run: u32,
+    /// Hint clock value of the last start
+    last_used: u64,
+    /// First-open order
+    blobs: Vec<LearnedBlob>,
+    index: HashMap<[u8; 32], usize>,
+    /// Nothing stale left to evict; stays set until the next run
+    full: bool,
+    last_prefetch: Option<Instant>,
+}
+
+fn is_stale(last_run: u32, run: u32) -> bool {
+    run.wrapping_sub(last_run) > STALE_RUNS
+}
+
+impl Sequence {
+    fn from_stored(stored: StoredSequence) -> Self {
+        let mut seq = Self {
+            run: stored.run,
+            last_used: stored.last_used,
+            blobs: stored.blobs,
+            ..Default::default()
+        };
+        seq.reindex();
+        seq
+    }
+
+    fn to_stored(&self, key: u64) -> StoredSequence {
+        StoredSequence {
+            key,
+            run: self.run,
+            last_used: self.last_used,
+            blobs: self.blobs.clone(),
+        }
+    }
+
+    fn reindex(&mut self) {
+        self.index = self
+            .blobs
+            .iter()
+            .enumerate()
+            .map(|(i, b)| (b.blob.hash, i))
+            .collect();
+    }
+
+    /// Record blobs opened during the current run. Returns how many were new.
+    fn learn(&mut self, blobs: &[AccessedBlob], max: usize) -> usize {
+        let mut learned = 0;
+        for blob in blobs {
+            if let Some(&i) = self.index.get(&blob.hash) {
+                self.blobs[i].last_run = self.run;
+                continue;
+            }
+            if self.blobs.len() >= max && (self.full || !self.evict_stale()) {
+                self.full = true;
+                continue;
+            }
+            self.index.insert(blob.hash, self.blobs.len());
+            self.blobs.push(LearnedBlob {
+                blob: *blob,
+                last_run: self.run,
+            });
+            learned += 1;
+        }
+        learned
+    }
+
+    fn evict_stale(&mut self) -> bool {
+        let (before, run) = (self.blobs.len(), self.run);
+        self.blobs.retain(|b| !is_stale(b.last_run, run));
+        if self.blobs.len() == before {
+            return false;
+        }
+        self.reindex();
+        true
+    }
+
+    /// Blobs read recently enough to be worth prefetching, in first-open order
+    fn predict(&self) -> Vec<AccessedBlob> {
+        self.blobs
+            .iter()
+            .filter(|b| !is_stale(b.last_run, self.run))
+            .map(|b| b.blob)
+            .collect()
+    }
+}
+
+/// Snapshot of `Prefetcher` counters
+#[derive(Debug, Clone, Copy, Default, PartialEq, Eq)]
+pub struct PrefetchStats {
+    /// Commands with a learned sequence
+    pub sequences: usize,
+    /// PrefetchHints received
+    pub hints: u64,
+    /// Blobs handed to the kernel for readahead
+    pub prefetched: u64,
+}
+
+/// Learned access sequences for one project
+pub struct Prefetcher {
+    sequences: Mutex<HashMap<u64, Sequence>>,
+    path: PathBuf,
+    cas: Option<vrift_cas::CasStore>,
+    max_blobs: usize,
+    clock: AtomicU64,
+    dirty: AtomicBool,
+    hints: AtomicU64,
+    prefetched: AtomicU64,
+}
+
+impl Prefetcher {
+    /// Load the sequences saved at `path`, with the configured size limit
+    pub fn open(path: &Path, cas_root: &Path) -> Self {
+        let max_blobs = vrift_config::config().daemon.prefetch_max_blobs;
+        Self::open_with(path, cas_root, max_blobs)
+    }
+
+    pub fn open_with(path: &Path, cas_root: &Path, max_blobs: usize) -> Self {
+        let table = match fs::read(path) {
+            Ok(data) => match rkyv::from_bytes::<PrefetchTable, rkyv::rancor::Error>(&data) {
+                Ok(table) => table,
+                Err(e) => {
+                    warn!(path = %path.display(), error = %e, "Discarding unreadable prefetch table");
+                    PrefetchTable::default()
+                }
+            },
+            Err(e) if e.kind() == io::ErrorKind::NotFound => PrefetchTable::default(),
+            Err(e) => {
+                warn!(path = %path.display(), error = %e, "Failed to read prefetch table");
+                PrefetchTable::default()
+            }
+        };
+        let clock = table
+            .sequences
+            .iter()
+            .map(|s| s.last_used)
+            .max()
+            .unwrap_or(0);
+        let sequences: HashMap<u64, Sequence> = table
+            .sequences
+            .into_iter()
+            .map(|s| (s.key, Sequence::from_stored(s)))
+            .collect();
+        if !sequences.is_empty() {
+            info!(count = sequences.len(), "Loaded prefetch sequences");
+        }
+
+        Self {
+            sequences: Mutex::new(sequences),
+            path: path.to_path_buf(),
+            cas: vrift_cas::CasStore::new(cas_root).ok(),
+            max_blobs,
+            clock: AtomicU64::new(clock),
+            dirty: AtomicBool::new(false),
+            hints: AtomicU64::new(0),
+            prefetched: AtomicU64::new(0),
+        }
+    }
+
+    fn key(command: &str, cwd: &str) -> u64 {
+        fnv1a_hash(&format!("{}\0{}", command, cwd))
+    }
+
+    /// Record an `AccessTrace`. Returns the number of blobs newly learned.
+    pub fn learn(&self, command: &str, cwd: &str, blobs: &[AccessedBlob]) -> usize {
+        if self.max_blobs == 0 || blobs.is_empty() {
+            return 0;
+        }
+        let key = Self::key(command, cwd);
+        let mut sequences = self.sequences.lock().unwrap();
+        if !sequences.contains_key(&key) {
+            Self::make_room(&mut sequences);
+        }
+        let learned = sequences
+            .entry(key)
+            .or_default()
+            .learn(blobs, self.max_blobs);
+        drop(sequences);
+        self.dirty.store(true, Ordering::Relaxed);
+        learned
+    }
+
+    /// A process of `command` started in `cwd`: begin a new run and return
+    /// the blobs to read ahead (empty if a readahead has just been issued)
+    pub fn hint(&self, command: &str, cwd: &str, now: Instant) -> Vec<AccessedBlob> {
+        self.hints.fetch_add(1, Ordering::Relaxed);
+        if self.max_blobs == 0 {
+            return Vec::new();
+        }
+        let key = Self::key(command, cwd);
+        let mut sequences = self.sequences.lock().unwrap();
+        let Some(seq) = sequences.get_mut(&key) else {
+            return Vec::new();
+        };
+        seq.run = seq.run.wrapping_add(1);
+        seq.full = false;
+        seq.last_used = self.clock.fetch_add(1, Ordering::Relaxed) + 1;
+        self.dirty.store(true, Ordering::Relaxed);
+        if seq
+            .last_prefetch
+            .is_some_and(|at| now.saturating_duration_since(at) < REPREFETCH_INTERVAL)
+        {
+            return Vec::new();
+        }
+        seq.last_prefetch = Some(now);
+        seq.predict()
+    }
+
+    fn make_room(sequences: &mut HashMap<u64, Sequence>) {
+        if sequences.len() < MAX_SEQUENCES {
+            return;
+        }
+        let oldest = sequences
+            .iter()
+            .min_by_key(|(_, s)| s.last_used)
+            .map(|(&k, _)| k);
+        if let Some(key) = oldest {
+            sequences.remove(&key);
+        }
+    }
+
+    /// Ask the kernel to read `blobs` into the page cache. Blocking (opens
+    /// every blob); returns how many were found.
+    pub fn read_ahead(&self, blobs: &[AccessedBlob]) -> usize {
+        let Some(cas) = &self.cas else {
+            return 0;
+        };
+        let mut issued = 0;
+        for blob in blobs {
+            // Loose blobs first, then a materialized copy of a chunked one
+            let found = ["", "bin"].iter().find_map(|ext| {
+                fs::File::open(cas.blob_path_with_metadata(&blob.hash, blob.size, ext)).ok()
+            });
+            if let Some(file) = found {
+                advise_willneed(&file, blob.size);
+                issued += 1;
+            }
+        }
+        self.prefetched.fetch_add(issued as u64, Ordering::Relaxed);
+        debug!(requested = blobs.len(), issued, "Prefetch issued");
+        issued
+    }
+
+    /// Write the table if it changed since the last save
+    pub fn save_if_dirty(&self) -> io::Result<()> {
+        if !self.dirty.swap(false, Ordering::Relaxed) {
+            return Ok(());
+        }
+        let table = PrefetchTable {
+            sequences: self
+                .sequences
+                .lock()
+                .unwrap()
+                .iter()
+                .map(|(&key, seq)| seq.to_stored(key))
+                .collect(),
+        };
+        let result = Self::write_table(&self.path, &table);
+        if result.is_err() {
+            self.dirty.store(true, Ordering::Relaxed);
+        }
+        result
+    }
+
+    fn write_table(path: &Path, table: &PrefetchTable) -> io::Result<()> {
+        if let Some(parent) = path.parent() {
+            fs::create_dir_all(parent)?;
+        }
+        let data = rkyv::to_bytes::<rkyv::rancor::Error>(table)
+            .map_err(|e| io::Error::new(io::ErrorKind::InvalidData, e.to_string()))?;
+
+        // Write atomically via temp file
+        let temp_path = path.with_extension("tmp");
+        fs::write(&temp_path, data.as_slice())?;
+        fs::rename(&temp_path, path)
+    }
+
+    pub fn get_stats(&self) -> PrefetchStats {
+        PrefetchStats {
+            sequences: self.sequences.lock().unwrap().len(),
+            hints: self.hints.load(Ordering::Relaxed),
+            prefetched: self.prefetched.load(Ordering::Relaxed),
+        }
+    }
+}
+
+#[cfg(target_os = "linux")]
+fn advise_willneed(file: &fs::File, _size: u64) {
+    use std::os::unix::io::AsRawFd;
+    unsafe { libc::posix_fadvise(file.as_raw_fd(), 0, 0, libc::POSIX_FADV_WILLNEED) };
+}
+
+#[cfg(target_os = "macos")]
+fn advise_willneed(file: &fs::File, size: u64) {
+    use std::os::unix::io::AsRawFd;
+    let advice = libc::radvisory {
+        ra_offset: 0,
+        ra_count: size.min(i32::MAX as u64) as libc::c_int,
+    };
+    unsafe { libc::fcntl(file.as_raw_fd(), libc::F_RDADVISE, &advice) };
+}
+
+#[cfg(not(any(target_os = "linux", target_os = "macos")))]
+fn advise_willneed(_file: &fs::File, _size: u64) {}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+    use tempfile::tempdir;
+
+    fn blob(n: u8) -> AccessedBlob {
+        AccessedBlob {
+            hash: [n; 32],
+            size: n as u64,
+        }
+    }
+
+    fn hashes(blobs: &[AccessedBlob]) -> Vec<u8> {
+        blobs.iter().map(|b| b.hash[0]).collect()
+    }
+
+    #[test]
+    fn test_hint_predicts_previous_run_in_order() {
+        let dir = tempdir().unwrap();
+        let p = Prefetcher::open_with(&dir.path().join("prefetch.bin"), dir.path(), 64);
+        let t0 = Instant::now();
+
+        // Unknown command: nothing to prefetch
+        assert!(p.hint("rustc", "/p", t0).is_empty());
+        assert_eq!(p.learn("rustc", "/p", &[blob(3), blob(1), blob(3)]), 2);
+        assert_eq!(p.learn("rustc", "/p", &[blob(2), blob(1)]), 1);
+        // Same command elsewhere is a different sequence
+        p.learn("rustc", "/q", &[blob(9)]);
+
+        assert_eq!(hashes(&p.hint("rustc", "/p", t0)), vec![3, 1, 2]);
+        // A burst of starts shares the first readahead
+        assert!(p
+            .hint("rustc", "/p", t0 + Duration::from_millis(10))
+            .is_empty());
+        assert_eq!(hashes(&p.hint("rustc", "/q", t0)), vec![9]);
+    }
+
+    #[test]
+    fn test_blobs_unread_for_stale_runs_are_dropped() {
+        let dir = tempdir().unwrap();
+        let p = Prefetcher::open_with(&dir.path().join("prefetch.bin"), dir.path(), 2);
+        let mut now = Instant::now();
+
+        p.hint("cc", "/p", now);
+        p.learn("cc", "/p", &[blob(1), blob(2)]);
+        // Full: a new blob is ignored while everything is recent
+        assert_eq!(p.learn("cc", "/p", &[blob(3)]), 0);
+
+        // Later runs only read blob 1
+        for _ in 0..=STALE_RUNS {
+            now += REPREFETCH_INTERVAL;
+            p.hint("cc", "/p", now);
+            p.learn("cc", "/p", &[blob(1)]);
+        }
+        now += REPREFETCH_INTERVAL;
+        assert_eq!(hashes(&p.hint("cc", "/p", now)), vec![1]);
+        // Blob 2 went stale and makes room
+        assert_eq!(p.learn("cc", "/p", &[blob(3)]), 1);
+    }
+
+    #[test]
+    fn test_sequences_survive_reopen() {
+        let dir = tempdir().unwrap();
+        let path = dir.path().join(".vrift").join("prefetch.bin");
+        {
+            let p = Prefetcher::open_with(&path, dir.path(), 64);
+            p.learn("node", "/app", &[blob(5), blob(6)]);
+            p.save_if_dirty().unwrap();
+        }
+        let p = Prefetcher::open_with(&path, dir.path(), 64);
+        assert_eq!(p.get_stats().sequences, 1);
+        assert_eq!(hashes(&p.hint("node", "/app", Instant::now())), vec![5, 6]);
+    }
+
+    #[test]
+    fn test_read_ahead_opens_loose_blobs() {
+        let dir = tempdir().unwrap();
+        let cas = vrift_cas::CasStore::new(dir.path().join("cas")).unwrap();
+        let data = b"prefetched content";
+        let hash = cas.store(data).unwrap();
+        let p = Prefetcher::open_with(&dir.path().join("prefetch.bin"), cas.root(), 64);
+
+        let present = AccessedBlob {
+            hash,
+            size: data.len() as u64,
+        };
+        assert_eq!(p.read_ahead(&[present, blob(7)]), 1);
+        assert_eq!(p.get_stats().prefetched, 1);
+    }
+}
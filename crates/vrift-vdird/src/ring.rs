@@ -0,0 +1,328 @@
+//! Mutation ring consumer — shm fast path for fire-and-forget manifest writes
+//!
+//! InceptionLayer clients push pre-serialized mutations (ManifestRemove,
+//! ManifestRename, ManifestUpdateMtime, ManifestUpsert) into a shm ring next
+//! to the VDir file instead of sending them over the socket (layout and
+//! protocol: `vrift_ipc::mutation_ring`). A dedicated thread drains the ring
+//! in batches and hands each batch to the CommandHandler under ONE write lock
+//! and ONE VDir write transaction.
+//!
+//! The thread only sleeps on the futex doorbell when the ring is empty, so
+//! producers pay a syscall only when the consumer is actually parked.
+//!
+//! A claim left unpublished for `STALL_TIMEOUT` (a preempted or dead
+//! producer) is revoked so the ring keeps flowing; the rest of a revoked
+//! span follows without waiting again.
+
+use crate::commands::CommandHandler;
+use anyhow::{Context, Result};
+use memmap2::MmapMut;
+use std::fs::OpenOptions;
+use std::path::{Path, PathBuf};
+use std::sync::Arc;
+use std::time::{Duration, Instant};
+use tokio::sync::{mpsc, RwLock};
+use tracing::{debug, info, warn};
+use vrift_ipc::mutation_ring::{
+    mutation_ring_size, MutationRing, PopResult, MUTATION_RING_MAX_PAYLOAD, MUTATION_RING_SUFFIX,
+};
+use vrift_ipc::{VeloRequest, VeloResponse};
+
+/// Max requests applied per handler lock acquisition
+const BATCH_MAX: usize = 256;
+
+/// Upper bound on a parked wait (also the poll interval where no futex exists)
+#[cfg(target_os = "linux")]
+const PARK_TIMEOUT: Duration = Duration::from_millis(100);
+#[cfg(not(target_os = "linux"))]
+const PARK_TIMEOUT: Duration = Duration::from_millis(2);
+
+/// A claimed-but-unpublished slot older than this is revoked
+/// (see `MutationRing::revoke_stalled`)
+const STALL_TIMEOUT: Duration = Duration::from_secs(1);
+
+/// Ring file path for a VDir file: `<vdir_path>.ring`
+pub fn ring_path(vdir_path: &Path) -> PathBuf {
+    let mut path = vdir_path.as_os_str().to_owned();
+    path.push(MUTATION_RING_SUFFIX);
+    PathBuf::from(path)
+}
+
+/// Mapped ring file (owned by the consumer thread)
+pub struct MutationRingFile {
+    _mmap: MmapMut,
+    ring: MutationRing,
+}
+
+impl MutationRingFile {
+    /// Open the ring file, keeping pending items from a previous vDird run.
+    /// A missing or foreign ring (other layout version) is (re)initialized.
+    pub fn create_or_open(path: &Path) -> Result<Self> {
+        let size = mutation_ring_size();
+        let file = OpenOptions::new()
+            .read(true)
+            .write(true)
+            .create(true)
+            .truncate(false)
+            .open(path)
+            .context("Failed to open mutation ring file")?;
+
+        let fresh = file.metadata()?.len() != size as u64;
+        if fresh {
+            file.set_len(size as u64)?;
+        }
+
+        let mut mmap = unsafe { MmapMut::map_mut(&file)? };
+        let ptr = mmap.as_mut_ptr();
+
+        let attached = if fresh {
+            None
+        } else {
+            unsafe { MutationRing::attach(ptr, size) }
+        };
+        let ring = match attached {
+            Some(ring) => {
+                if !ring.is_empty() {
+                    info!(
+                        pending = ring.len(),
+                        "Replaying mutation ring from previous run"
+                    );
+                }
+                ring
+            }
+            None => {
+                info!(path = %path.display(), size, "Initialized mutation ring");
+                unsafe { MutationRing::init(ptr, size) }
+                    .context("Mutation ring mapping is misaligned")?
+            }
+        };
+
+        Ok(Self { _mmap: mmap, ring })
+    }
+
+    pub fn ring(&self) -> MutationRing {
+        self.ring
+    }
+}
+
+/// Mutations accepted from the ring. Anything else is a protocol error:
+/// only fire-and-forget requests have no response channel.
+pub fn is_ring_mutation(request: &VeloRequest) -> bool {
+    matches!(
+        request,
+        VeloRequest::ManifestRemove { .. }
+            | VeloRequest::ManifestRename { .. }
+            | VeloRequest::ManifestUpdateMtime { .. }
+            | VeloRequest::ManifestUpsert { .. }
+    )
+}
+
+/// Start the ring consumer for this project.
+pub fn spawn_consumer(vdir_path: &Path, handler: Arc<RwLock<CommandHandler>>) -> Result<()> {
+    let path = ring_path(vdir_path);
+    let file = MutationRingFile::create_or_open(&path)?;
+    let (tx, mut rx) = mpsc::channel::<Vec<VeloRequest>>(16);
+
+    std::thread::Builder::new()
+        .name("vdird-ring".to_string())
+        .spawn(move || drain_loop(file, tx))
+        .context("Failed to spawn mutation ring thread")?;
+
+    tokio::spawn(async move {
+        while let Some(batch) = rx.recv().await {
+            let count = batch.len();
+            let responses = handler.write().await.handle_mutations(batch);
+            for response in responses {
+                if let VeloResponse::Error(e) = response {
+                    warn!(error = %e, "Ring mutation failed");
+                }
+            }
+            debug!(count, "Applied mutation ring batch");
+        }
+    });
+
+    info!(path = %path.display(), "Mutation ring consumer started");
+    Ok(())
+}
+
+/// Consumer thread: drain → batch → hand off; park only when empty.
+fn drain_loop(file: MutationRingFile, tx: mpsc::Sender<Vec<VeloRequest>>) {
+    let ring = file.ring();
+    let mut buf = Vec::with_capacity(MUTATION_RING_MAX_PAYLOAD);
+    let mut stalled_since: Option<Instant> = None;
+    // Just revoked a claim: the rest of its span is stalled too
+    let mut revoking = false;
+    let mut warned = false;
+
+    loop {
+        let mut batch = Vec::new();
+        let mut stalled = false;
+        while batch.len() < BATCH_MAX {
+            match ring.pop(&mut buf) {
+                PopResult::Item => {
+                    match rkyv::from_bytes::<VeloRequest, rkyv::rancor::Error>(&buf) {
+                        Ok(request) if is_ring_mutation(&request) => batch.push(request),
+                        Ok(request) => warn!(?request, "Non-mutation request in ring, dropped"),
+                        Err(e) => warn!(error = %e, "Failed to deserialize ring request"),
+                    }
+                }
+                PopResult::Empty => break,
+                PopResult::Stalled => {
+                    stalled = true;
+                    break;
+                }
+            }
+        }
+
+        if !batch.is_empty() || !stalled {
+            stalled_since = None;
+            revoking = false;
+            warned = false;
+        }
+        if !batch.is_empty() {
+            if tx.blocking_send(batch).is_err() {
+                return; // Runtime shutting down
+            }
+            continue;
+        }
+
+        if stalled {
+            let since = *stalled_since.get_or_insert_with(Instant::now);
+            if !revoking && since.elapsed() < STALL_TIMEOUT {
+                // Producer is mid-push; it publishes within nanoseconds normally
+                std::thread::sleep(Duration::from_millis(1));
+                continue;
+            }
+            if ring.revoke_stalled(producer_gone) {
+                if !revoking {
+                    warn!("Mutation ring producer stalled mid-push; revoked its claim");
+                }
+                revoking = true;
+                stalled_since = None;
+            } else {
+                // Being written by a live producer: wait for it
+                if !warned {
+                    warn!(
+                        stalled_ms = since.elapsed().as_millis() as u64,
+                        "Mutation ring producer stalled while writing"
+                    );
+                    warned = true;
+                }
+                revoking = false;
+                std::thread::sleep(Duration::from_millis(1));
+            }
+            continue;
+        }
+
+        // Empty: announce park, re-check, then sleep on the doorbell
+        let bell = ring.consumer_park();
+        if !ring.has_ready() && ring.is_empty() {
+            wait_doorbell(&ring, bell, PARK_TIMEOUT);
+        }
+        ring.consumer_unpark();
+    }
+}
+
+/// The producer process `pid` no longer exists
+fn producer_gone(pid: u32) -> bool {
+    let alive = unsafe { libc::kill(pid as libc::pid_t, 0) } == 0;
+    !alive && std::io::Error::last_os_error().raw_os_error() == Some(libc::ESRCH)
+}
+
+#[cfg(target_os = "linux")]
+fn wait_doorbell(ring: &MutationRing, bell: u32, timeout: Duration) {
+    let ts = libc::timespec {
+        tv_sec: timeout.as_secs() as libc::time_t,
+        tv_nsec: timeout.subsec_nanos() as libc::c_long,
+    };
+    // Shared (non-PRIVATE) futex: producers live in other processes.
+    // EAGAIN (doorbell already moved), EINTR and ETIMEDOUT all just re-poll.
+    unsafe {
+        libc::syscall(
+            libc::SYS_futex,
+            ring.doorbell_addr(),
+            libc::FUTEX_WAIT,
+            bell,
+            &ts as *const libc::timespec,
+            std::ptr::null::<u32>(),
+            0,
+        );
+    }
+}
+
+#[cfg(not(target_os = "linux"))]
+fn wait_doorbell(_ring: &MutationRing, _bell: u32, timeout: Duration) {
+    // No portable cross-process futex: short poll instead
+    std::thread::sleep(timeout);
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+    use tempfile::tempdir;
+
+    #[test]
+    fn test_ring_path_appends_suffix() {
+        assert_eq!(
+            ring_path(Path::new("/dev/shm/vrift_vdir_abc")),
+            PathBuf::from("/dev/shm/vrift_vdir_abc.ring")
+        );
+        assert_eq!(
+            ring_path(Path::new("/tmp/abc.vdir")),
+            PathBuf::from("/tmp/abc.vdir.ring")
+        );
+    }
+
+    #[test]
+    fn test_create_or_open_keeps_pending_items() {
+        let temp = tempdir().unwrap();
+        let path = temp.path().join("test.vdir.ring");
+
+        {
+            let file = MutationRingFile::create_or_open(&path).unwrap();
+            file.ring().push(b"pending", 1).unwrap();
+        }
+
+        let file = MutationRingFile::create_or_open(&path).unwrap();
+        let mut out = Vec::new();
+        assert_eq!(file.ring().pop(&mut out), PopResult::Item);
+        assert_eq!(out, b"pending");
+    }
+
+    #[test]
+    fn test_create_or_open_resets_foreign_ring() {
+        let temp = tempdir().unwrap();
+        let path = temp.path().join("test.vdir.ring");
+
+        {
+            let file = MutationRingFile::create_or_open(&path).unwrap();
+            file.ring().push(b"lost", 1).unwrap();
+        }
+        // Bump the version word: a ring from another layout
+        let mut bytes = std::fs::read(&path).unwrap();
+        bytes[4] ^= 0xff;
+        std::fs::write(&path, &bytes).unwrap();
+
+        let file = MutationRingFile::create_or_open(&path).unwrap();
+        assert!(file.ring().is_empty());
+    }
+
+    #[test]
+    fn test_producer_gone() {
+        assert!(!producer_gone(std::process::id()));
+        let mut child = std::process::Command::new("true").spawn().unwrap();
+        let pid = child.id();
+        child.wait().unwrap();
+        assert!(producer_gone(pid));
+    }
+
+    #[test]
+    fn test_only_mutations_accepted() {
+        assert!(is_ring_mutation(&VeloRequest::ManifestRemove {
+            path: "/a".to_string()
+        }));
+        assert!(!is_ring_mutation(&VeloRequest::ManifestGet {
+            path: "/a".to_string()
+        }));
+    }
+}
@@ -5,9 +5,11 @@
 
 use std::fs;
 use std::path::{Path, PathBuf};
-use std::time::SystemTime;
+use std::sync::Mutex;
+use std::time::{Duration, SystemTime};
 use tokio::sync::mpsc;
 use tracing::{debug, info, warn};
+use vrift_cas::{EntryKind, TreeWalker};
 
 use crate::ignore::IgnoreMatcher;
 use crate::watch::IngestEvent;
@@ -53,69 +55,69 @@ impl CompensationScanner {
         }
     }
 
-    /// Check if path should be ignored
-    fn should_ignore(&self, path: &Path) -> bool {
-        self.config.ignore.should_ignore(path)
-    }
-
     /// Scan directory and emit events for changed files
+    ///
+    /// Uses the shared parallel tree walker; events are sorted by path so a
+    /// directory's event always precedes those of its contents.
     pub fn scan(&self) -> Vec<IngestEvent> {
-        let mut events = Vec::new();
-        self.scan_dir(&self.config.root, 0, &mut events);
-        events
-    }
-
-    /// Recursive directory scan
-    fn scan_dir(&self, dir: &Path, depth: usize, events: &mut Vec<IngestEvent>) {
-        if depth > self.config.max_depth {
-            return;
+        let last_scan = self.config.last_scan;
+        let ignore = self.config.ignore.clone();
+        let events = Mutex::new(Vec::new());
+
+        let summary = TreeWalker::new(&self.config.root)
+            .with_stat(true)
+            .max_depth(self.config.max_depth)
+            .filter(move |path, _| !ignore.should_ignore(path))
+            .walk(|entry| {
+                let mtime = entry
+                    .stat
+                    .map(|st| SystemTime::UNIX_EPOCH + Duration::from_nanos(st.mtime_nsec))
+                    .unwrap_or(SystemTime::UNIX_EPOCH);
+
+                // Check if entry was modified after last scan
+                if mtime > last_scan {
+                    let event = match entry.kind {
+                        EntryKind::Dir => {
+                            debug!(path = %entry.path.display(), "Compensation: new directory");
+                            IngestEvent::DirCreated { path: entry.path }
+                        }
+                        EntryKind::Symlink => {
+                            let target = fs::read_link(&entry.path).unwrap_or_default();
+                            debug!(path = %entry.path.display(), "Compensation: new symlink");
+                            IngestEvent::SymlinkCreated {
+                                path: entry.path,
+                                target,
+                            }
+                        }
+                        _ => {
+                            debug!(path = %entry.path.display(), "Compensation: changed file");
+                            IngestEvent::FileChanged { path: entry.path }
+                        }
+                    };
+                    events.lock().unwrap().push(event);
+                }
+                true
+            });
+
+        if summary.errors > 0 {
+            warn!(
+                errors = summary.errors,
+                "Some directories could not be read"
+            );
         }
 
-        let entries = match fs::read_dir(dir) {
-            Ok(e) => e,
-            Err(e) => {
-                warn!(path = %dir.display(), error = %e, "Failed to read directory");
-                return;
-            }
-        };
-
-        for entry in entries.flatten() {
-            let path = entry.path();
-
-            if self.should_ignore(&path) {
-                continue;
-            }
-
-            let metadata = match entry.metadata() {
-                Ok(m) => m,
-                Err(_) => continue,
-            };
-
-            let mtime = metadata.modified().unwrap_or(SystemTime::UNIX_EPOCH);
-
-            // Check if file was modified after last scan
-            if mtime > self.config.last_scan {
-                if metadata.is_dir() {
-                    debug!(path = %path.display(), "Compensation: new directory");
-                    events.push(IngestEvent::DirCreated { path: path.clone() });
-                } else if metadata.is_symlink() {
-                    let target = fs::read_link(&path).unwrap_or_default();
-                    debug!(path = %path.display(), "Compensation: new symlink");
-                    events.push(IngestEvent::SymlinkCreated {
-                        path: path.clone(),
-                        target,
-                    });
-                } else {
-                    debug!(path = %path.display(), "Compensation: changed file");
-                    events.push(IngestEvent::FileChanged { path: path.clone() });
-                }
-            }
+        let mut events = events.into_inner().unwrap();
+        events.sort_by(|a, b| event_path(a).cmp(event_path(b)));
+        events
+    }
+}
 
-            // Recurse into directories
-            if metadata.is_dir() {
-                self.scan_dir(&path, depth + 1, events);
-            }
-        }
+fn event_path(event: &IngestEvent) -> &Path {
+    match event {
+        IngestEvent::FileChanged { path }
+        | IngestEvent::DirCreated { path }
+        | IngestEvent::Removed { path }
+        | IngestEvent::SymlinkCreated { path, .. } => path,
     }
 }
 
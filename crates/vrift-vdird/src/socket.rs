@@ -2,7 +2,11 @@
 //!
 //! Uses IpcHeader frame protocol for all IPC communication.
 
+use crate::coalesce::IngestMetrics;
 use crate::commands::CommandHandler;
+use crate::dir_index::{DirIndexAction, DirIndexRefresh};
+use crate::group_commit::GroupCommit;
+use crate::metrics::{metrics_path, InceptionMetrics};
 use crate::vdir::VDir;
 use crate::ProjectConfig;
 use anyhow::Result;
@@ -18,6 +22,8 @@ pub async fn run_listener(
     config: ProjectConfig,
     vdir: VDir,
     manifest: std::sync::Arc<vrift_manifest::lmdb::LmdbManifest>,
+    ingest_metrics: Arc<IngestMetrics>,
+    remote: Option<Arc<vrift_cas::RemoteCas>>,
 ) -> Result<()> {
     // Remove existing socket if present
     if config.socket_path.exists() {
@@ -27,18 +33,34 @@ pub async fn run_listener(
     let listener = UnixListener::bind(&config.socket_path)?;
     info!(socket = %config.socket_path.display(), "Listening for connections");
 
-    let handler = Arc::new(RwLock::new(CommandHandler::new(
-        config.clone(),
-        vdir,
-        manifest,
-    )));
+    let mut handler = CommandHandler::new(config.clone(), vdir, manifest);
+    handler.set_ingest_metrics(ingest_metrics);
+    if let Some(remote) = remote {
+        handler.set_remote_cas(remote);
+    }
+    match InceptionMetrics::create_or_open(&metrics_path(&config.vdir_path)) {
+        Ok(metrics) => handler.set_inception_metrics(Arc::new(metrics)),
+        Err(e) => warn!(error = %e, "Metrics file unavailable, client counters not collected"),
+    }
+    let handler = Arc::new(RwLock::new(handler));
+
+    // Shm fast path for fire-and-forget mutations; the socket still accepts them
+    if let Err(e) = crate::ring::spawn_consumer(&config.vdir_path, Arc::clone(&handler)) {
+        warn!(error = %e, "Mutation ring unavailable, mutations use the socket only");
+    }
+
+    spawn_vdir_maintenance(Arc::clone(&handler));
+
+    // Socket mutations from all connections are applied in shared batches
+    let commits = Arc::new(GroupCommit::spawn(Arc::clone(&handler)));
 
     loop {
         match listener.accept().await {
             Ok((stream, _addr)) => {
                 let handler = Arc::clone(&handler);
+                let commits = Arc::clone(&commits);
                 tokio::spawn(async move {
-                    if let Err(e) = handle_client(stream, handler).await {
+                    if let Err(e) = handle_client(stream, handler, commits).await {
                         warn!(error = %e, "Client handler error");
                     }
                 });
@@ -50,8 +72,89 @@ pub async fn run_listener(
     }
 }
 
+/// Chunks migrated per idle tick (each in its own seqlock write window)
+const MIGRATE_CHUNKS_PER_TICK: usize = 16;
+
+/// Ticks between saves of the learned prefetch sequences and reaps of
+/// exited clients' metrics slots (5s)
+const PREFETCH_SAVE_TICKS: u32 = 250;
+
+/// Idle-time VDir upkeep, every 20ms:
+/// - progress for an incremental resize. Upserts already migrate one chunk
+///   each; this drains the tail once writes go quiet so readers stop
+///   probing two tables.
+/// - the directory index and manifest filter. Marked stale as soon as the
+///   manifest moves (clients then stop trusting negative lookups), rebuilt
+///   off the handler lock once it settles.
+/// - every 5s, a save of changed prefetch sequences and a reap of the
+///   metrics slots of exited clients (frees them for new processes).
+fn spawn_vdir_maintenance(handler: Arc<RwLock<CommandHandler>>) {
+    tokio::spawn(async move {
+        let mut interval = tokio::time::interval(std::time::Duration::from_millis(20));
+        let mut dir_index = DirIndexRefresh::new();
+        let mut ticks = 0u32;
+        loop {
+            interval.tick().await;
+            ticks = ticks.wrapping_add(1);
+            if ticks.is_multiple_of(PREFETCH_SAVE_TICKS) {
+                let prefetch = handler.read().await.prefetcher();
+                let saved = tokio::task::spawn_blocking(move || prefetch.save_if_dirty()).await;
+                if let Ok(Err(e)) = saved {
+                    warn!(error = %e, "Failed to save prefetch sequences");
+                }
+                if let Some(metrics) = handler.read().await.inception_metrics() {
+                    metrics.collect();
+                }
+            }
+            if handler.read().await.vdir_migrating() {
+                let mut h = handler.write().await;
+                for _ in 0..MIGRATE_CHUNKS_PER_TICK {
+                    if !h.vdir_migrate_step() {
+                        break;
+                    }
+                }
+            }
+
+            let (manifest, dir_changes) = {
+                let h = handler.read().await;
+                (h.manifest(), h.vdir_dir_changes())
+            };
+            let now = std::time::Instant::now();
+            match dir_index.next(manifest.revision(), dir_changes, now) {
+                DirIndexAction::None => {}
+                DirIndexAction::MarkStale => {
+                    handler.write().await.mark_dir_index_stale();
+                }
+                DirIndexAction::Rebuild(revision) => {
+                    let built = tokio::task::spawn_blocking(move || {
+                        crate::commands::build_dir_index(&manifest, revision)
+                    })
+                    .await;
+                    let result = match built {
+                        Ok(Ok(image)) => {
+                            handler.write().await.publish_dir_index(&image, dir_changes)
+                        }
+                        Ok(Err(e)) => Err(e),
+                        Err(e) => Err(e.into()),
+                    };
+                    if let Err(e) = result {
+                        // Index stays stale (clients list over IPC) until the
+                        // manifest moves again
+                        warn!(error = %e, "Directory index rebuild failed");
+                    }
+                    dir_index.settled();
+                }
+            }
+        }
+    });
+}
+
 /// Handle a single client connection using IpcHeader frame protocol
-async fn handle_client(mut stream: UnixStream, handler: Arc<RwLock<CommandHandler>>) -> Result<()> {
+async fn handle_client(
+    mut stream: UnixStream,
+    handler: Arc<RwLock<CommandHandler>>,
+    commits: Arc<GroupCommit>,
+) -> Result<()> {
     debug!("New client connected");
 
     loop {
@@ -129,8 +232,16 @@ async fn handle_client(mut stream: UnixStream, handler: Arc<RwLock<CommandHandle
 
         debug!(?request, "Received request");
 
-        // Handle request
-        let response = {
+        // Handle request (mutations join the next group commit)
+        let response = if crate::ring::is_ring_mutation(&request) {
+            commits.submit(request).await
+        } else if let VeloRequest::CasGet { hash } = request {
+            // Materialize / remote fetch: blocking I/O, off the handler lock
+            let store = handler.read().await.cas_store();
+            tokio::task::spawn_blocking(move || crate::commands::cas_get(store, &hash))
+                .await
+                .unwrap_or_else(|e| VeloResponse::Error(VeloError::internal(e.to_string())))
+        } else {
             let mut h = handler.write().await;
             h.handle_request(request).await
         };
@@ -10,18 +10,27 @@ use tracing::{debug, info, warn};
 // Re-export shared VDir types from vrift-ipc (SSOT)
 pub use vrift_ipc::vdir_types::*;
 
+/// Old-table slots migrated per write transaction during an incremental resize.
+/// Bounds the seqlock write window; a 64K-slot table drains in 256 upserts.
+pub const MIGRATE_CHUNK: usize = 256;
+
 /// VDir manager
 pub struct VDir {
     mmap: MmapMut,
     capacity: usize,
     path: std::path::PathBuf,
+    /// Inside `begin_batch`/`end_batch`: single write transactions join it
+    in_batch: bool,
+    /// Paths added or removed since open; each marked the directory index
+    /// stale in its own write transaction
+    dir_changes: u64,
 }
 
 impl VDir {
     /// Create or open existing VDir mmap file
     pub fn create_or_open(path: &Path) -> Result<Self> {
         let capacity = VDIR_DEFAULT_CAPACITY;
-        let file_size = VDIR_HEADER_SIZE + (capacity * VDIR_ENTRY_SIZE);
+        let file_size = vdir_file_size(capacity);
 
         let file = OpenOptions::new()
             .read(true)
@@ -42,31 +51,56 @@ impl VDir {
         let mut mmap = unsafe { MmapMut::map_mut(&file)? };
 
         // Initialize or validate header
-        let header = unsafe { &mut *(mmap.as_mut_ptr() as *mut VDirHeader) };
-        let needs_init = header.magic != VDIR_MAGIC || header.version != VDIR_VERSION;
+        let needs_init = mmap.len() < VDIR_HEADER_SIZE || {
+            let header = unsafe { &*(mmap.as_ptr() as *const VDirHeader) };
+            header.magic != VDIR_MAGIC
+                || header.version != VDIR_VERSION
+                || !Self::geometry_valid(header, mmap.len())
+        };
 
         if needs_init {
-            if header.magic == VDIR_MAGIC && header.version < VDIR_VERSION {
+            let header = unsafe { &*(mmap.as_ptr() as *const VDirHeader) };
+            if mmap.len() >= VDIR_HEADER_SIZE
+                && header.magic == VDIR_MAGIC
+                && header.version < VDIR_VERSION
+            {
                 info!(
                     old_version = header.version,
                     new_version = VDIR_VERSION,
-                    "Upgrading VDir version"
+                    "Upgrading VDir version (table layout changed, reinitializing)"
                 );
             }
+            // Layout may differ from the previous version: start from a zeroed
+            // table. Never shrink the file — stale clients may still map it.
+            if mmap.len() < file_size {
+                drop(mmap);
+                file.set_len(file_size as u64)?;
+                mmap = unsafe { MmapMut::map_mut(&file)? };
+            }
+            mmap[VDIR_TAGS_OFFSET..file_size].fill(0);
+
+            let header = unsafe { &mut *(mmap.as_mut_ptr() as *mut VDirHeader) };
             *header = VDirHeader {
                 magic: VDIR_MAGIC,
                 version: VDIR_VERSION,
                 generation: 0,
                 entry_count: 0,
                 table_capacity: capacity as u32,
-                table_offset: VDIR_HEADER_SIZE as u32,
+                table_offset: vdir_table_offset(capacity) as u32,
                 crc32: 0,
-                _pad: [0; 32],
+                tags_offset: VDIR_TAGS_OFFSET as u32,
+                old_capacity: 0,
+                old_tags_offset: 0,
+                old_table_offset: 0,
+                migrate_cursor: 0,
+                dirs_offset: 0,
+                file_size: file_size as u64,
             };
             header.crc32 = Self::compute_header_crc(header);
             mmap.flush()?;
             debug!("Initialized VDir header");
         } else {
+            let header = unsafe { &mut *(mmap.as_mut_ptr() as *mut VDirHeader) };
             // Validate CRC
             let stored_crc = header.crc32;
             let computed_crc = Self::compute_header_crc(header);
@@ -96,13 +130,40 @@ impl VDir {
                 header.crc32 = Self::compute_header_crc(header);
                 mmap.flush()?;
             }
+
+            if header.old_capacity != 0 {
+                info!(
+                    cursor = header.migrate_cursor,
+                    old_capacity = header.old_capacity,
+                    "Resuming interrupted VDir migration"
+                );
+            }
         }
 
-        Ok(Self {
+        // An existing VDir keeps its (possibly grown) capacity
+        let capacity = unsafe { &*(mmap.as_ptr() as *const VDirHeader) }.table_capacity as usize;
+
+        let mut vdir = Self {
             mmap,
             capacity,
             path: path.to_path_buf(),
-        })
+            in_batch: false,
+            dir_changes: 0,
+        };
+        // The manifest may have changed while no vDird was running
+        vdir.mark_dir_index_stale();
+        Ok(vdir)
+    }
+
+    /// Live (and old, if migrating) tables and the directory index header
+    /// lie within the file
+    fn geometry_valid(header: &VDirHeader, len: usize) -> bool {
+        let used = header.file_size as usize;
+        used <= len
+            && VDirTable::live(header).fits(used)
+            && VDirTable::old(header).is_none_or(|old| old.fits(used))
+            && (header.dirs_offset == 0
+                || header.dirs_offset as usize + VDIR_DIRS_HEADER_SIZE <= used)
     }
 
     /// Compute CRC32 of header fields (excluding crc32 field itself)
@@ -127,26 +188,24 @@ impl VDir {
         unsafe { &mut *(self.mmap.as_mut_ptr() as *mut VDirHeader) }
     }
 
-    /// Get entry table slice
-    fn entries(&self) -> &[VDirEntry] {
-        let offset = self.header().table_offset as usize;
-        unsafe {
-            std::slice::from_raw_parts(
-                self.mmap.as_ptr().add(offset) as *const VDirEntry,
-                self.capacity,
-            )
-        }
+    /// Live table (new entries are written here)
+    fn live(&self) -> VDirTable {
+        VDirTable::live(self.header())
     }
 
-    /// Get mutable entry table slice
-    fn entries_mut(&mut self) -> &mut [VDirEntry] {
-        let offset = self.header().table_offset as usize;
-        unsafe {
-            std::slice::from_raw_parts_mut(
-                self.mmap.as_mut_ptr().add(offset) as *mut VDirEntry,
-                self.capacity,
-            )
-        }
+    /// Table being migrated away from, if a resize is in progress
+    fn old(&self) -> Option<VDirTable> {
+        VDirTable::old(self.header())
+    }
+
+    /// Entry in `slot` of `table`
+    fn entry(&self, table: VDirTable, slot: usize) -> &VDirEntry {
+        unsafe { &*table.entry(self.mmap.as_ptr(), slot) }
+    }
+
+    /// Mutable entry in `slot` of `table`
+    fn entry_mut(&mut self, table: VDirTable, slot: usize) -> &mut VDirEntry {
+        unsafe { &mut *(table.entry(self.mmap.as_ptr(), slot) as *mut VDirEntry) }
     }
 
     /// Open an existing VDir in read-only mode (for observability)
@@ -157,22 +216,36 @@ impl VDir {
             .context("Failed to open VDir file in read-only mode")?;
 
         let mmap_ro = unsafe { memmap2::Mmap::map(&file)? };
+        if mmap_ro.len() < VDIR_HEADER_SIZE {
+            anyhow::bail!("VDir file too small: {} bytes", mmap_ro.len());
+        }
         let header = unsafe { &*(mmap_ro.as_ptr() as *const VDirHeader) };
 
         if header.magic != VDIR_MAGIC {
             anyhow::bail!("Invalid VDir magic: {:x}", header.magic);
         }
+        if header.version != VDIR_VERSION {
+            anyhow::bail!(
+                "Unsupported VDir version: {} (expected {})",
+                header.version,
+                VDIR_VERSION
+            );
+        }
 
         let capacity = header.table_capacity as usize;
 
         // For read-only mode, we still store it in the MmapMut field via transition.
         // We MUST NOT call mutable methods if opened this way.
+        // Lookups re-read geometry from the header and skip tables the writer
+        // appended past this mapping.
         let mmap = unsafe { std::mem::transmute::<memmap2::Mmap, MmapMut>(mmap_ro) };
 
         Ok(Self {
             mmap,
             capacity,
             path: path.to_path_buf(),
+            in_batch: false,
+            dir_changes: 0,
         })
     }
 
@@ -180,6 +253,9 @@ impl VDir {
     /// Stores current_gen + 1 (odd) with Release ordering to signal "write in progress".
     /// Readers seeing an odd generation will spin-wait.
     pub fn begin_write(&mut self) {
+        if self.in_batch {
+            return;
+        }
         let gen_ptr = &self.header().generation as *const u64;
         let atomic = unsafe { &*(gen_ptr as *const AtomicU64) };
         let current = atomic.load(Ordering::Relaxed);
@@ -195,6 +271,9 @@ impl VDir {
     /// Stores current_gen + 1 (even) with Release ordering to signal "data stable".
     /// Also recomputes header CRC.
     pub fn end_write(&mut self) {
+        if self.in_batch {
+            return;
+        }
         // Recompute CRC before bumping to even (readers validate CRC after gen check)
         self.header_mut().crc32 = Self::compute_header_crc(self.header());
         let gen_ptr = &self.header().generation as *const u64;
@@ -208,82 +287,124 @@ impl VDir {
         atomic.store(current + 1, Ordering::Release);
     }
 
-    /// Find slot for path hash (linear probing)
-    fn find_slot(&self, path_hash: u64) -> Option<usize> {
-        let start = (path_hash as usize) % self.capacity;
-        for i in 0..self.capacity {
-            let slot = (start + i) % self.capacity;
-            let entry = &self.entries()[slot];
-            if entry.is_empty() || entry.path_hash == path_hash {
-                return Some(slot);
-            }
-        }
-        None
+    /// Open a batch: every write until `end_batch` lands in ONE seqlock
+    /// write transaction and publishes as one generation bump. Keep batches
+    /// short; readers spin while it is open.
+    pub fn begin_batch(&mut self) {
+        debug_assert!(!self.in_batch, "begin_batch called inside a batch");
+        self.begin_write();
+        self.in_batch = true;
     }
 
-    /// Lookup entry by path hash
-    pub fn lookup(&self, path_hash: u64) -> Option<&VDirEntry> {
-        let start = (path_hash as usize) % self.capacity;
-        for i in 0..self.capacity {
-            let slot = (start + i) % self.capacity;
-            let entry = &self.entries()[slot];
-            if entry.is_empty() {
-                return None;
-            }
-            if entry.path_hash == path_hash {
-                return Some(entry);
-            }
+    /// Close and publish the batch opened by `begin_batch`
+    pub fn end_batch(&mut self) {
+        debug_assert!(self.in_batch, "end_batch called without begin_batch");
+        self.in_batch = false;
+        self.end_write();
+    }
+
+    /// Locate a key: live table first, then the old table while migrating
+    fn find(&self, key: VDirKey) -> Option<(VDirTable, usize)> {
+        let live = self.live();
+        if !live.fits(self.mmap.len()) {
+            return None; // Read-only view older than the writer's last resize
+        }
+        // SAFETY: geometry checked against the mapping above / below
+        if let VDirProbe::Found(slot) = unsafe { live.probe(self.mmap.as_ptr(), key) } {
+            return Some((live, slot));
+        }
+        let old = self.old()?;
+        if !old.fits(self.mmap.len()) {
+            return None;
+        }
+        match unsafe { old.probe(self.mmap.as_ptr(), key) } {
+            VDirProbe::Found(slot) => Some((old, slot)),
+            VDirProbe::Vacant(_) | VDirProbe::Full => None,
         }
-        None
+    }
+
+    /// Lookup entry by key. A bare `u64` path hash matches on the primary
+    /// hash only; use `VDirKey::from_path` to also verify the secondary hash.
+    pub fn lookup(&self, key: impl Into<VDirKey>) -> Option<&VDirEntry> {
+        self.find(key.into())
+            .map(|(table, slot)| self.entry(table, slot))
+    }
+
+    /// Write entry + tag into a slot (caller holds the seqlock)
+    fn write_slot(&mut self, table: VDirTable, slot: usize, entry: VDirEntry) {
+        self.mmap[table.tags_offset + slot] = vdir_tag(entry.path_hash);
+        *self.entry_mut(table, slot) = entry;
     }
 
     /// Insert or update entry
     pub fn upsert(&mut self, entry: VDirEntry) -> Result<()> {
+        let key = VDirKey::of_entry(&entry);
+
         // Dynamic Resize: Check if resulting load factor would exceed 75%
         let current_count = self.header().entry_count as usize;
-        let existing_entry = self.lookup(entry.path_hash);
-        let is_new = existing_entry.is_none();
+        let existing = self.find(key).map(|(table, slot)| *self.entry(table, slot));
+        let is_new = existing.is_none();
 
         if is_new && (current_count + 1) as f64 / self.capacity as f64 > 0.75 {
             self.resize(self.capacity * 2)?;
         }
 
-        let slot = self.find_slot(entry.path_hash).context("VDir full")?;
+        // Always write to the live table; a stale copy left in the old table
+        // is shadowed (live is probed first) and skipped by migration.
+        let live = self.live();
+        let slot = match unsafe { live.probe(self.mmap.as_ptr(), key) } {
+            VDirProbe::Found(slot) | VDirProbe::Vacant(slot) => slot,
+            VDirProbe::Full => anyhow::bail!("VDir full"),
+        };
 
-        let existing = &self.entries()[slot];
-        let is_new = existing.is_empty();
+        // Keep a known path_check if the caller only had the hash
+        let mut entry = entry;
+        if entry.path_check == 0 {
+            if let Some(existing) = existing {
+                entry.path_check = existing.path_check;
+            }
+        }
 
         self.begin_write();
-        self.entries_mut()[slot] = entry;
+        self.write_slot(live, slot, entry);
 
         if is_new {
             self.header_mut().entry_count += 1;
+            self.dir_changed();
         }
 
+        self.migrate_chunk(MIGRATE_CHUNK);
         self.end_write();
         Ok(())
     }
 
     /// Mark entry as dirty
-    pub fn mark_dirty(&mut self, path_hash: u64, dirty: bool) -> bool {
-        if let Some(slot) = self.find_slot(path_hash) {
-            let entries = self.entries_mut();
-            let entry = &mut entries[slot];
-            if !entry.is_empty() && entry.path_hash == path_hash {
-                self.begin_write();
-                // Re-acquire mutable entry after begin_write borrows self
-                let entries = self.entries_mut();
-                let entry = &mut entries[slot];
-                if dirty {
-                    entry.flags |= FLAG_DIRTY;
-                } else {
-                    entry.flags &= !FLAG_DIRTY;
-                }
-                self.end_write();
-                return true;
-            }
+    pub fn mark_dirty(&mut self, key: impl Into<VDirKey>, dirty: bool) -> bool {
+        let Some((table, slot)) = self.find(key.into()) else {
+            return false;
+        };
+        self.begin_write();
+        let entry = self.entry_mut(table, slot);
+        if dirty {
+            entry.flags |= FLAG_DIRTY;
+        } else {
+            entry.flags &= !FLAG_DIRTY;
         }
-        false
+        self.end_write();
+        true
+    }
+
+    /// A path was removed: clear its dirty bit and mark the directory index
+    /// stale, in one write transaction
+    pub fn mark_removed(&mut self, key: impl Into<VDirKey>) -> bool {
+        let Some((table, slot)) = self.find(key.into()) else {
+            return false;
+        };
+        self.begin_write();
+        self.entry_mut(table, slot).flags &= !FLAG_DIRTY;
+        self.dir_changed();
+        self.end_write();
+        true
     }
 
     /// Flush mmap to disk
@@ -292,106 +413,303 @@ impl VDir {
         Ok(())
     }
 
-    /// Calculate VDir statistics for observability
+    /// Calculate VDir statistics for observability.
+    /// Collision chains are measured in probe groups (1 = home group) over
+    /// the live table.
     pub fn get_stats(&self) -> VDirStats {
-        let entries = self.entries();
+        let live = self.live();
         let capacity = self.capacity;
-        let mut occupied = 0;
         let mut max_chain = 0;
         let mut total_chain = 0;
+        let mut live_entries = 0;
 
-        for (i, entry) in entries.iter().enumerate().take(capacity) {
-            if !entry.is_empty() {
-                occupied += 1;
-
-                // Calculate collision chain length for this entry
-                let ideal_slot = (entry.path_hash as usize) % capacity;
-                let actual_slot = i;
-                let chain_len = if actual_slot >= ideal_slot {
-                    actual_slot - ideal_slot + 1
-                } else {
-                    (capacity - ideal_slot) + actual_slot + 1
-                };
-
+        if live.fits(self.mmap.len()) {
+            let tags = &self.mmap[live.tags_offset..live.tags_offset + live.capacity];
+            for (slot, &tag) in tags.iter().enumerate() {
+                if tag == VDIR_TAG_EMPTY {
+                    continue;
+                }
+                live_entries += 1;
+                let path_hash = self.entry(live, slot).path_hash;
+                let chain_len = vdir_probe_distance(path_hash, slot, capacity);
                 max_chain = max_chain.max(chain_len);
                 total_chain += chain_len;
             }
         }
 
+        // Distinct keys across both tables while migrating
+        let occupied = self.header().entry_count as usize;
         let load_factor = if capacity > 0 {
             occupied as f64 / capacity as f64
         } else {
             0.0
         };
 
-        let avg_chain = if occupied > 0 {
-            total_chain as f64 / occupied as f64
+        let avg_chain = if live_entries > 0 {
+            total_chain as f64 / live_entries as f64
         } else {
             0.0
         };
 
+        let header = self.header();
         VDirStats {
             capacity,
             entry_count: occupied,
             load_factor,
             max_collision_chain: max_chain,
             avg_collision_chain: avg_chain,
-            generation: self.header().generation,
+            generation: header.generation,
+            migration_pending: (header.old_capacity
+                - header.migrate_cursor.min(header.old_capacity))
+                as usize,
         }
     }
 
-    /// Resize VDir to a new capacity.
-    /// Rehashes all existing entries into a larger table.
+    /// Move up to `budget` old-table slots into the live table.
+    /// Caller holds the seqlock. Returns true while migration is unfinished.
+    fn migrate_chunk(&mut self, budget: usize) -> bool {
+        let Some(old) = self.old() else {
+            return false;
+        };
+        let live = self.live();
+        let cursor = self.header().migrate_cursor as usize;
+        let end = (cursor + budget).min(old.capacity);
+
+        for slot in cursor..end {
+            if self.mmap[old.tags_offset + slot] == VDIR_TAG_EMPTY {
+                continue;
+            }
+            let entry = *self.entry(old, slot);
+            // Already in the live table means it was updated after the resize
+            // started: the live copy is newer.
+            if let VDirProbe::Vacant(target) =
+                unsafe { live.probe(self.mmap.as_ptr(), VDirKey::of_entry(&entry)) }
+            {
+                self.write_slot(live, target, entry);
+            }
+        }
+
+        let header = self.header_mut();
+        if end < old.capacity {
+            header.migrate_cursor = end as u32;
+            return true;
+        }
+        // Done: retire the old table. Its region stays in the file (never
+        // shrunk while clients map it) and is not reused.
+        header.old_capacity = 0;
+        header.old_tags_offset = 0;
+        header.old_table_offset = 0;
+        header.migrate_cursor = 0;
+        info!("vdir: Incremental resize complete.");
+        false
+    }
+
+    /// True while an incremental resize is still migrating entries
+    pub fn is_migrating(&self) -> bool {
+        self.header().old_capacity != 0
+    }
+
+    /// Migrate one chunk in its own write transaction (idle-time progress).
+    /// Returns true while migration is unfinished.
+    pub fn migrate_step(&mut self) -> bool {
+        if !self.is_migrating() {
+            return false;
+        }
+        self.begin_write();
+        let more = self.migrate_chunk(MIGRATE_CHUNK);
+        self.end_write();
+        more
+    }
+
+    /// Drain a pending migration, one bounded chunk per write transaction
+    pub fn finish_migration(&mut self) {
+        while self.migrate_step() {}
+    }
+
+    /// Resize VDir to a new capacity (incremental).
+    ///
+    /// Appends a fresh table at the end of the file and publishes it as the
+    /// live table in one short write transaction; the current table becomes
+    /// the old table and is drained by `migrate_chunk` on later writes.
+    /// Readers never observe a table that is being rebuilt.
     pub fn resize(&mut self, new_capacity: usize) -> Result<()> {
+        anyhow::ensure!(
+            vdir_capacity_valid(new_capacity),
+            "VDir capacity must be a power of 2 >= {}",
+            VDIR_GROUP_WIDTH
+        );
+        // One resize at a time: finish the previous migration first
+        self.finish_migration();
+
+        let region = (self.header().file_size as usize + 63) & !63;
+        let table = VDirTable::at(region, new_capacity);
+        let new_size = table.end();
+        anyhow::ensure!(
+            new_size <= u32::MAX as usize,
+            "VDir would exceed 4 GiB ({} slots)",
+            new_capacity
+        );
         info!(
-            "vdir: Resizing from {} to {} entries...",
+            "vdir: Resizing from {} to {} entries (incremental)...",
             self.capacity, new_capacity
         );
 
-        // 1. Snapshot existing entries
-        // We use a Vec because we're about to unmap/remap.
-        let entries_snapshot: Vec<VDirEntry> = self
-            .entries()
-            .iter()
-            .filter(|e| !e.is_empty())
-            .cloned()
-            .collect();
+        // 1. Grow file and remap (readers keep using the current tables)
+        self.grow_to(new_size)?;
 
-        // 2. Resize file and remap
-        let file = OpenOptions::new().read(true).write(true).open(&self.path)?;
-        let new_size = VDIR_HEADER_SIZE + (new_capacity * VDIR_ENTRY_SIZE);
-        file.set_len(new_size as u64)?;
+        // 2. Clear the new region. Not yet referenced by the header, so it
+        // needs no seqlock (bytes may be left over from a reinitialized file).
+        self.mmap[region..new_size].fill(0);
 
-        // Re-map MmapMut
-        self.mmap = unsafe { MmapMut::map_mut(&file)? };
-        self.capacity = new_capacity;
-
-        // 3. Update header
+        // 3. Publish: live -> old, new region -> live
+        let live = self.live();
         self.begin_write();
         let header = self.header_mut();
+        header.old_capacity = live.capacity as u32;
+        header.old_tags_offset = live.tags_offset as u32;
+        header.old_table_offset = live.table_offset as u32;
+        header.migrate_cursor = 0;
         header.table_capacity = new_capacity as u32;
-        header.entry_count = 0; // Reset count, re-increment during insertion
+        header.tags_offset = table.tags_offset as u32;
+        header.table_offset = table.table_offset as u32;
+        header.file_size = new_size as u64;
+        self.end_write();
+        self.capacity = new_capacity;
 
-        // 4. Clear table (zero out)
-        let entries_ptr = unsafe { self.mmap.as_mut_ptr().add(VDIR_HEADER_SIZE) };
-        unsafe {
-            std::ptr::write_bytes(entries_ptr, 0, new_capacity * VDIR_ENTRY_SIZE);
+        self.flush()?;
+        Ok(())
+    }
+
+    /// Grow the file to at least `size` bytes and remap it
+    fn grow_to(&mut self, size: usize) -> Result<()> {
+        let file = OpenOptions::new().read(true).write(true).open(&self.path)?;
+        if (file.metadata()?.len() as usize) < size {
+            file.set_len(size as u64)?;
         }
+        self.mmap = unsafe { MmapMut::map_mut(&file)? };
+        Ok(())
+    }
 
-        // 5. Re-insert (rehash)
-        for entry in entries_snapshot {
-            // Internal upsert-like logic without seqlock wrapping (already in seqlock)
-            let slot = self
-                .find_slot(entry.path_hash)
-                .context("VDir full after resize")?;
-            self.entries_mut()[slot] = entry;
-            self.header_mut().entry_count += 1;
+    /// Header of the published directory index, if any
+    fn dirs_header(&self) -> Option<&VDirDirsHeader> {
+        let offset = self.header().dirs_offset as usize;
+        if offset == 0 || offset + VDIR_DIRS_HEADER_SIZE > self.mmap.len() {
+            return None;
         }
+        Some(unsafe { &*(self.mmap.as_ptr().add(offset) as *const VDirDirsHeader) })
+    }
 
+    /// Manifest revision of the published directory index (None if absent
+    /// or stale)
+    pub fn dir_index_revision(&self) -> Option<u64> {
+        self.dirs_header()
+            .filter(|dirs| dirs.flags & VDIR_DIRS_STALE == 0)
+            .map(|dirs| dirs.revision)
+    }
+
+    /// Send readers back to IPC listings until the next publish.
+    /// Returns true if a fresh index was marked.
+    pub fn mark_dir_index_stale(&mut self) -> bool {
+        if self.dir_index_revision().is_none() {
+            return false;
+        }
+        self.begin_write();
+        self.set_dirs_stale();
+        self.end_write();
+        true
+    }
+
+    /// Paths added or removed since open (see `DirIndexRefresh::next`)
+    pub fn dir_changes(&self) -> u64 {
+        self.dir_changes
+    }
+
+    /// A path was added or removed: the index no longer matches. Caller
+    /// holds the seqlock, so readers never see the mutation with a fresh
+    /// index.
+    fn dir_changed(&mut self) {
+        self.dir_changes += 1;
+        if self.dir_index_revision().is_some() {
+            self.set_dirs_stale();
+        }
+    }
+
+    /// Set `VDIR_DIRS_STALE` on the published index (caller holds the seqlock)
+    fn set_dirs_stale(&mut self) {
+        let offset = self.header().dirs_offset as usize;
+        let dirs = unsafe { &mut *(self.mmap.as_mut_ptr().add(offset) as *mut VDirDirsHeader) };
+        dirs.flags |= VDIR_DIRS_STALE;
+    }
+
+    /// Publish a directory index image (see `dir_index::DirIndexBuilder`).
+    ///
+    /// Double-buffered: the image goes into the region readers are NOT
+    /// using (the previous index, kept as the spare) or, if that is too
+    /// small, a region appended at the end of the file. One short write
+    /// transaction then swaps `dirs_offset`. A reader still walking a region
+    /// when it is overwritten by a later publish fails its seqlock check.
+    ///
+    /// `dir_changes` is `dir_changes()` as of the manifest snapshot the
+    /// image was built from: paths added or removed since then leave the
+    /// new index stale.
+    pub fn publish_dir_index(&mut self, image: &[u8], dir_changes: u64) -> Result<()> {
+        anyhow::ensure!(
+            image.len() >= VDIR_DIRS_HEADER_SIZE,
+            "Directory index image too small"
+        );
+        let live = self
+            .dirs_header()
+            .map(|dirs| (self.header().dirs_offset, *dirs));
+
+        let (offset, size) = match live {
+            Some((_, dirs))
+                if dirs.spare_offset != 0 && dirs.spare_size as usize >= image.len() =>
+            {
+                (dirs.spare_offset as usize, dirs.spare_size as usize)
+            }
+            _ => {
+                // Headroom so the next few rebuilds fit the same buffer
+                let offset = (self.header().file_size as usize + 63) & !63;
+                let size = (image.len() + image.len() / 4 + 4095) & !4095;
+                (offset, size)
+            }
+        };
+        let end = offset + size;
+        anyhow::ensure!(
+            end <= u32::MAX as usize,
+            "VDir would exceed 4 GiB (directory index of {} bytes)",
+            image.len()
+        );
+        if end > self.mmap.len() {
+            self.grow_to(end)?;
+        }
+
+        // Not referenced by the header yet: written outside the seqlock
+        self.mmap[offset..offset + image.len()].copy_from_slice(image);
+        let dirs = unsafe { &mut *(self.mmap.as_mut_ptr().add(offset) as *mut VDirDirsHeader) };
+        dirs.region_size = size as u32;
+        dirs.flags = if dir_changes == self.dir_changes {
+            0
+        } else {
+            VDIR_DIRS_STALE
+        };
+        (dirs.spare_offset, dirs.spare_size) = match live {
+            Some((live_offset, live_dirs)) => (live_offset, live_dirs.region_size),
+            None => (0, 0),
+        };
+
+        self.begin_write();
+        let header = self.header_mut();
+        header.dirs_offset = offset as u32;
+        header.file_size = header.file_size.max(end as u64);
         self.end_write();
-        self.flush()?;
 
-        info!("vdir: Resize complete.");
+        debug!(
+            offset,
+            size,
+            bytes = image.len(),
+            "Published directory index"
+        );
         Ok(())
     }
 }
@@ -405,6 +723,8 @@ pub struct VDirStats {
     pub max_collision_chain: usize,
     pub avg_collision_chain: f64,
     pub generation: u64,
+    /// Old-table slots not yet migrated by an incremental resize
+    pub migration_pending: usize,
 }
 
 /// FNV-1a hash for paths
@@ -446,7 +766,8 @@ mod tests {
             mtime_nsec: 0,
             mode: 0o644,
             flags: 0,
-            _pad: [0; 3],
+            _pad: 0,
+            path_check: vdir_path_check("src/main.rs"),
         };
         vdir.upsert(entry).unwrap();
 
@@ -593,6 +914,31 @@ mod tests {
         assert_eq!(vdir.header().generation, gen_before + 2);
     }
 
+    #[test]
+    fn test_batch_publishes_one_generation() {
+        let temp = tempdir().unwrap();
+        let path = temp.path().join("test.vdir");
+
+        let mut vdir = VDir::create_or_open(&path).unwrap();
+        let gen_before = vdir.header().generation;
+
+        vdir.begin_batch();
+        for i in 0..10 {
+            vdir.upsert(VDirEntry {
+                path_hash: fnv1a_hash(&format!("file{}.txt", i)),
+                ..Default::default()
+            })
+            .unwrap();
+            assert_eq!(vdir.header().generation & 1, 1); // still writing
+        }
+        vdir.mark_dirty(fnv1a_hash("file0.txt"), true);
+        vdir.end_batch();
+
+        assert_eq!(vdir.header().generation, gen_before + 2);
+        assert_eq!(vdir.header().entry_count, 10);
+        assert!(vdir.lookup(fnv1a_hash("file9.txt")).is_some());
+    }
+
     // ==================== Persistence ====================
 
     #[test]
@@ -979,35 +1325,10 @@ mod tests {
                             continue;
                         }
 
-                        let table_capacity =
-                            unsafe { *((mmap_ptr as usize + 20) as *const u32) } as usize;
-                        let table_offset =
-                            unsafe { *((mmap_ptr as usize + 24) as *const u32) } as usize;
-
-                        if table_capacity == 0 {
-                            continue;
-                        }
-
-                        // Lookup file_0
-                        let target_hash = vrift_ipc::fnv1a_hash("file_0");
-                        let start = (target_hash as usize) % table_capacity;
-                        let mut found: Option<(u64, i64)> = None;
-
-                        for j in 0..table_capacity {
-                            let slot = (start + j) % table_capacity;
-                            let off = table_offset + slot * VDIR_ENTRY_SIZE;
-                            if off + VDIR_ENTRY_SIZE > mmap_len {
-                                break;
-                            }
-                            let e = unsafe { &*(mmap_ptr.add(off) as *const VDirEntry) };
-                            if e.path_hash == 0 {
-                                break;
-                            }
-                            if e.path_hash == target_hash {
-                                found = Some((e.size, e.mtime_sec));
-                                break;
-                            }
-                        }
+                        // Lookup file_0 (live table, then old table if migrating)
+                        let key = VDirKey::from(vrift_ipc::fnv1a_hash("file_0"));
+                        let found = unsafe { vdir_find(mmap_ptr, mmap_len, key) }
+                            .map(|e| unsafe { ((*e).size, (*e).mtime_sec) });
 
                         let g2 = gen_ptr.load(Ordering::Acquire);
                         if g1 != g2 {
@@ -1234,4 +1555,431 @@ mod tests {
         assert_eq!(stats.capacity, initial_capacity * 4);
         assert_eq!(stats.entry_count, target2);
     }
+
+    // ==================== v3 Layout: Tags + Secondary Hash ====================
+
+    #[test]
+    fn test_primary_hash_collision_kept_apart() {
+        let temp = tempdir().unwrap();
+        let path = temp.path().join("collision.vdir");
+        let mut vdir = VDir::create_or_open(&path).unwrap();
+
+        // Two paths forced onto the same 64-bit hash
+        let a = VDirKey {
+            path_hash: 0x1234_5678_9ABC_DEF0,
+            path_check: vdir_path_check("a.rs"),
+        };
+        let b = VDirKey {
+            path_check: vdir_path_check("b.rs"),
+            ..a
+        };
+        for (key, size) in [(a, 1), (b, 2)] {
+            vdir.upsert(VDirEntry {
+                path_hash: key.path_hash,
+                path_check: key.path_check,
+                size,
+                ..Default::default()
+            })
+            .unwrap();
+        }
+
+        assert_eq!(vdir.header().entry_count, 2);
+        assert_eq!(vdir.lookup(a).unwrap().size, 1);
+        assert_eq!(vdir.lookup(b).unwrap().size, 2);
+        let c = VDirKey {
+            path_check: vdir_path_check("c.rs"),
+            ..a
+        };
+        assert!(vdir.lookup(c).is_none());
+    }
+
+    #[test]
+    fn test_hash_only_upsert_keeps_path_check() {
+        let temp = tempdir().unwrap();
+        let path = temp.path().join("keep_check.vdir");
+        let mut vdir = VDir::create_or_open(&path).unwrap();
+
+        let key = VDirKey::from_path("src/lib.rs");
+        vdir.upsert(VDirEntry {
+            path_hash: key.path_hash,
+            path_check: key.path_check,
+            size: 1,
+            ..Default::default()
+        })
+        .unwrap();
+        vdir.upsert(VDirEntry {
+            path_hash: key.path_hash,
+            size: 2,
+            ..Default::default()
+        })
+        .unwrap();
+
+        let entry = vdir.lookup(key).unwrap();
+        assert_eq!(entry.size, 2);
+        assert_eq!(entry.path_check, key.path_check);
+        assert_eq!(vdir.header().entry_count, 1);
+    }
+
+    #[test]
+    fn test_old_version_reinitialized() {
+        let temp = tempdir().unwrap();
+        let path = temp.path().join("v2.vdir");
+
+        {
+            let mut vdir = VDir::create_or_open(&path).unwrap();
+            vdir.upsert(VDirEntry {
+                path_hash: fnv1a_hash("stale.txt"),
+                ..Default::default()
+            })
+            .unwrap();
+            // Pretend the file was written by a v2 vDird
+            vdir.header_mut().version = 2;
+            vdir.flush().unwrap();
+        }
+
+        let vdir = VDir::create_or_open(&path).unwrap();
+        assert_eq!(vdir.header().version, VDIR_VERSION);
+        assert_eq!(vdir.header().entry_count, 0);
+        assert!(vdir.lookup(fnv1a_hash("stale.txt")).is_none());
+    }
+
+    #[test]
+    fn test_stats_chain_in_groups() {
+        let temp = tempdir().unwrap();
+        let path = temp.path().join("stats.vdir");
+        let mut vdir = VDir::create_or_open(&path).unwrap();
+        for i in 0..1000 {
+            vdir.upsert(VDirEntry {
+                path_hash: fnv1a_hash(&format!("file_{}", i)),
+                ..Default::default()
+            })
+            .unwrap();
+        }
+        let stats = vdir.get_stats();
+        assert_eq!(stats.entry_count, 1000);
+        // 1000 entries in 4096 groups of 16: almost all land in their home group
+        assert!(stats.max_collision_chain <= 2);
+        assert!(stats.avg_collision_chain < 1.01);
+    }
+
+    // ==================== Incremental Resize ====================
+
+    fn fill_past_threshold(vdir: &mut VDir, prefix: &str) -> usize {
+        let target = (vdir.capacity as f64 * 0.75) as usize + 1;
+        for i in 0..target {
+            let key = VDirKey::from_path(&format!("{}/{}", prefix, i));
+            vdir.upsert(VDirEntry {
+                path_hash: key.path_hash,
+                path_check: key.path_check,
+                size: i as u64,
+                ..Default::default()
+            })
+            .unwrap();
+        }
+        target
+    }
+
+    #[test]
+    fn test_incremental_resize_migrates_in_chunks() {
+        let temp = tempdir().unwrap();
+        let path = temp.path().join("incremental.vdir");
+        let mut vdir = VDir::create_or_open(&path).unwrap();
+        let initial_capacity = vdir.capacity;
+
+        let count = fill_past_threshold(&mut vdir, "a");
+        assert_eq!(vdir.capacity, initial_capacity * 2);
+        assert!(
+            vdir.is_migrating(),
+            "one upsert must not drain the old table"
+        );
+        assert_eq!(
+            vdir.get_stats().migration_pending,
+            initial_capacity - MIGRATE_CHUNK
+        );
+
+        // Everything is visible mid-migration (old or live table)
+        for i in 0..count {
+            let key = VDirKey::from_path(&format!("a/{}", i));
+            assert_eq!(vdir.lookup(key).unwrap().size, i as u64);
+        }
+
+        // Update an entry that still lives only in the old table
+        let late = VDirKey::from_path(&format!("a/{}", count - 2));
+        vdir.upsert(VDirEntry {
+            path_hash: late.path_hash,
+            path_check: late.path_check,
+            size: 4242,
+            ..Default::default()
+        })
+        .unwrap();
+
+        vdir.finish_migration();
+        assert!(!vdir.is_migrating());
+        assert_eq!(vdir.get_stats().migration_pending, 0);
+        assert_eq!(vdir.header().entry_count as usize, count);
+        assert_eq!(vdir.lookup(late).unwrap().size, 4242);
+        for i in 0..count - 2 {
+            let key = VDirKey::from_path(&format!("a/{}", i));
+            assert_eq!(vdir.lookup(key).unwrap().size, i as u64);
+        }
+        // Old region is retired, not reused: file only grew
+        assert_eq!(
+            vdir.header().file_size as usize,
+            vdir.live().end(),
+            "live table is the last region"
+        );
+    }
+
+    #[test]
+    fn test_migration_resumes_after_reopen() {
+        let temp = tempdir().unwrap();
+        let path = temp.path().join("resume.vdir");
+        let count = {
+            let mut vdir = VDir::create_or_open(&path).unwrap();
+            let count = fill_past_threshold(&mut vdir, "r");
+            assert!(vdir.is_migrating());
+            vdir.flush().unwrap();
+            count
+        };
+
+        let mut vdir = VDir::create_or_open(&path).unwrap();
+        assert!(vdir.is_migrating());
+        assert_eq!(vdir.capacity, VDIR_DEFAULT_CAPACITY * 2);
+        vdir.finish_migration();
+        for i in 0..count {
+            assert!(vdir
+                .lookup(VDirKey::from_path(&format!("r/{}", i)))
+                .is_some());
+        }
+    }
+
+    /// Readers mapping VDIR_MAP_RESERVE (as the inception layer does) must
+    /// find every existing entry on every consistent read across a resize.
+    #[test]
+    fn test_reserved_mapping_reader_never_misses_during_resize() {
+        use std::os::unix::io::AsRawFd;
+        use std::sync::atomic::{AtomicBool, AtomicU64};
+
+        let temp = tempdir().unwrap();
+        let path = temp.path().join("reserve.vdir");
+        let mut vdir = VDir::create_or_open(&path).unwrap();
+        let seeded = 64;
+        for i in 0..seeded {
+            let key = VDirKey::from_path(&format!("seed/{}", i));
+            vdir.upsert(VDirEntry {
+                path_hash: key.path_hash,
+                path_check: key.path_check,
+                size: i,
+                ..Default::default()
+            })
+            .unwrap();
+        }
+
+        let file = std::fs::File::open(&path).unwrap();
+        let base = unsafe {
+            libc::mmap(
+                std::ptr::null_mut(),
+                VDIR_MAP_RESERVE,
+                libc::PROT_READ,
+                libc::MAP_SHARED,
+                file.as_raw_fd(),
+                0,
+            )
+        };
+        assert_ne!(base, libc::MAP_FAILED);
+        let base_addr = base as usize;
+
+        let done = Arc::new(AtomicBool::new(false));
+        let misses = Arc::new(AtomicU64::new(0));
+        let reads = Arc::new(AtomicU64::new(0));
+        let readers: Vec<_> = (0..2)
+            .map(|_| {
+                let (done, misses, reads) = (done.clone(), misses.clone(), reads.clone());
+                thread::spawn(move || {
+                    let base = base_addr as *const u8;
+                    let gen = unsafe { &*((base_addr + 8) as *const AtomicU64) };
+                    let mut i = 0u64;
+                    while !done.load(Ordering::Relaxed) {
+                        let g1 = gen.load(Ordering::Acquire);
+                        if g1 & 1 != 0 {
+                            core::hint::spin_loop();
+                            continue;
+                        }
+                        let key = VDirKey::from_path(&format!("seed/{}", i % seeded));
+                        let found = unsafe { vdir_find(base, VDIR_MAP_RESERVE, key) }.is_some();
+                        if gen.load(Ordering::Acquire) != g1 {
+                            continue;
+                        }
+                        reads.fetch_add(1, Ordering::Relaxed);
+                        if !found {
+                            misses.fetch_add(1, Ordering::Relaxed);
+                        }
+                        i += 1;
+                    }
+                })
+            })
+            .collect();
+
+        // Two doublings, each drained by ordinary upserts
+        let target = (VDIR_DEFAULT_CAPACITY * 2) as f64 * 0.75;
+        for i in 0..target as usize + 1 {
+            vdir.upsert(VDirEntry {
+                path_hash: fnv1a_hash(&format!("bulk/{}", i)),
+                ..Default::default()
+            })
+            .unwrap();
+        }
+        assert_eq!(vdir.capacity, VDIR_DEFAULT_CAPACITY * 4);
+
+        done.store(true, Ordering::Relaxed);
+        for r in readers {
+            r.join().unwrap();
+        }
+        unsafe { libc::munmap(base, VDIR_MAP_RESERVE) };
+
+        assert!(reads.load(Ordering::Relaxed) > 0);
+        assert_eq!(misses.load(Ordering::Relaxed), 0, "reader missed an entry");
+    }
+
+    fn dir_image(revision: u64, paths: &[&str]) -> Vec<u8> {
+        let mut builder = crate::dir_index::DirIndexBuilder::new();
+        for path in paths {
+            builder.add(path, false);
+        }
+        builder.build(revision).unwrap()
+    }
+
+    fn published_revision(vdir: &VDir) -> Option<u64> {
+        unsafe { VDirDirs::open(vdir.mmap.as_ptr(), vdir.mmap.len()) }.map(|d| d.revision)
+    }
+
+    #[test]
+    fn test_dir_index_publish_double_buffers() {
+        let temp = tempdir().unwrap();
+        let mut vdir = VDir::create_or_open(&temp.path().join("dirs.vdir")).unwrap();
+        let key = VDirKey::from_path("/src/a.rs");
+        vdir.upsert(VDirEntry {
+            path_hash: key.path_hash,
+            path_check: key.path_check,
+            size: 9,
+            ..Default::default()
+        })
+        .unwrap();
+        assert_eq!(published_revision(&vdir), None);
+
+        vdir.publish_dir_index(&dir_image(1, &["/src/a.rs"]), vdir.dir_changes())
+            .unwrap();
+        let first = vdir.header().dirs_offset;
+        assert!(first as usize >= vdir_file_size(VDIR_DEFAULT_CAPACITY));
+        assert_eq!(published_revision(&vdir), Some(1));
+
+        // No spare yet: appended; the first region becomes the spare
+        vdir.publish_dir_index(
+            &dir_image(2, &["/src/a.rs", "/src/b.rs"]),
+            vdir.dir_changes(),
+        )
+        .unwrap();
+        let second = vdir.header().dirs_offset;
+        assert!(second > first);
+        assert_eq!(published_revision(&vdir), Some(2));
+
+        // Third publish reuses the first region instead of growing the file
+        let size = vdir.header().file_size;
+        vdir.publish_dir_index(&dir_image(3, &["/src/b.rs"]), vdir.dir_changes())
+            .unwrap();
+        assert_eq!(vdir.header().dirs_offset, first);
+        assert_eq!(vdir.header().file_size, size);
+        assert_eq!(vdir.dir_index_revision(), Some(3));
+
+        let dirs = unsafe { VDirDirs::open(vdir.mmap.as_ptr(), vdir.mmap.len()) }.unwrap();
+        let list = unsafe { dirs.find(VDirKey::from_path("/src")) }.unwrap();
+        assert_eq!(
+            unsafe { list.get(0) }.map(|(name, _)| name.to_vec()),
+            Some(b"b.rs".to_vec())
+        );
+
+        // Tables are untouched; a later resize appends past the index
+        assert_eq!(vdir.lookup(key).unwrap().size, 9);
+        vdir.resize(VDIR_DEFAULT_CAPACITY * 2).unwrap();
+        assert!(vdir.header().tags_offset as u64 >= size);
+        assert_eq!(vdir.dir_index_revision(), Some(3));
+        assert_eq!(vdir.lookup(key).unwrap().size, 9);
+    }
+
+    #[test]
+    fn test_dir_index_stale_mark_and_reopen() {
+        let temp = tempdir().unwrap();
+        let path = temp.path().join("dirs.vdir");
+        let mut vdir = VDir::create_or_open(&path).unwrap();
+        assert!(!vdir.mark_dir_index_stale()); // Nothing published
+
+        vdir.publish_dir_index(&dir_image(4, &["/a"]), vdir.dir_changes())
+            .unwrap();
+        let gen = vdir.header().generation;
+        assert!(vdir.mark_dir_index_stale());
+        assert_eq!(vdir.header().generation, gen + 2);
+        assert_eq!(vdir.dir_index_revision(), None);
+        assert_eq!(published_revision(&vdir), None);
+        assert!(!vdir.mark_dir_index_stale());
+
+        vdir.publish_dir_index(&dir_image(5, &["/a"]), vdir.dir_changes())
+            .unwrap();
+        drop(vdir);
+
+        // A new vDird cannot vouch for an index built by the previous one
+        let vdir = VDir::create_or_open(&path).unwrap();
+        assert_eq!(vdir.dir_index_revision(), None);
+    }
+
+    #[test]
+    fn test_namespace_mutations_mark_index_stale_in_their_transaction() {
+        let temp = tempdir().unwrap();
+        let mut vdir = VDir::create_or_open(&temp.path().join("dirs.vdir")).unwrap();
+        let entry = |path: &str| {
+            let key = VDirKey::from_path(path);
+            VDirEntry {
+                path_hash: key.path_hash,
+                path_check: key.path_check,
+                size: 1,
+                ..Default::default()
+            }
+        };
+        vdir.upsert(entry("/a")).unwrap();
+        vdir.publish_dir_index(&dir_image(1, &["/a"]), vdir.dir_changes())
+            .unwrap();
+
+        // Content change: same listing
+        vdir.upsert(entry("/a")).unwrap();
+        assert_eq!(vdir.dir_index_revision(), Some(1));
+
+        // New path: stale in the same generation bump as the insert
+        let gen = vdir.header().generation;
+        vdir.upsert(entry("/b")).unwrap();
+        assert_eq!(vdir.header().generation, gen + 2);
+        assert_eq!(vdir.dir_index_revision(), None);
+        assert_eq!(vdir.dir_changes(), 2);
+
+        // Group commit: one transaction for the batch and the mark
+        vdir.publish_dir_index(&dir_image(2, &["/a", "/b"]), vdir.dir_changes())
+            .unwrap();
+        let gen = vdir.header().generation;
+        vdir.begin_batch();
+        vdir.upsert(entry("/c")).unwrap();
+        assert!(vdir.mark_removed(VDirKey::from_path("/a")));
+        vdir.end_batch();
+        assert_eq!(vdir.header().generation, gen + 2);
+        assert_eq!(vdir.dir_index_revision(), None);
+
+        vdir.publish_dir_index(&dir_image(3, &["/b", "/c"]), vdir.dir_changes())
+            .unwrap();
+        assert!(vdir.mark_removed(VDirKey::from_path("/b")));
+        assert_eq!(vdir.dir_index_revision(), None);
+        assert!(!vdir.mark_removed(VDirKey::from_path("/nowhere")));
+
+        // Built before the last removal: published stale
+        let built_at = vdir.dir_changes() - 1;
+        vdir.publish_dir_index(&dir_image(4, &["/b", "/c"]), built_at)
+            .unwrap();
+        assert_eq!(vdir.dir_index_revision(), None);
+    }
 }
@@ -92,28 +92,45 @@ impl FsWatch {
     }
 
     /// Convert notify event to IngestEvent
+    ///
+    /// Renames are paired into a removal of the old path and a creation of
+    /// the new one, whether the backend reports both sides in one event or
+    /// as separate From/To halves.
     fn to_ingest_event(&self, event: Event) -> Vec<IngestEvent> {
+        use notify::event::{ModifyKind, RenameMode};
         use notify::EventKind;
 
         let mut events = Vec::new();
 
+        if let EventKind::Modify(ModifyKind::Name(mode)) = event.kind {
+            let last = event.paths.len().saturating_sub(1);
+            for (i, path) in event.paths.into_iter().enumerate() {
+                if self.should_ignore(&path) {
+                    continue;
+                }
+                let removed = match mode {
+                    RenameMode::Both => i < last,
+                    RenameMode::From => true,
+                    RenameMode::To => false,
+                    // Side unknown (e.g. FSEvents): ask the filesystem
+                    _ => std::fs::symlink_metadata(&path).is_err(),
+                };
+                events.push(if removed {
+                    IngestEvent::Removed { path }
+                } else {
+                    created_event(path)
+                });
+            }
+            return events;
+        }
+
         for path in event.paths {
             if self.should_ignore(&path) {
                 continue;
             }
 
             let ingest_event = match event.kind {
-                EventKind::Create(_) => {
-                    if path.is_dir() {
-                        IngestEvent::DirCreated { path }
-                    } else if path.is_symlink() {
-                        // Read symlink target
-                        let target = std::fs::read_link(&path).unwrap_or_default();
-                        IngestEvent::SymlinkCreated { path, target }
-                    } else {
-                        IngestEvent::FileChanged { path }
-                    }
-                }
+                EventKind::Create(_) => created_event(path),
                 EventKind::Modify(_) => IngestEvent::FileChanged { path },
                 EventKind::Remove(_) => IngestEvent::Removed { path },
                 _ => continue,
@@ -145,7 +162,21 @@ impl FsWatch {
     }
 }
 
-/// Spawn async watcher task that sends events to a channel
+/// Event for a path that appeared (created or renamed into place)
+fn created_event(path: PathBuf) -> IngestEvent {
+    if path.is_dir() {
+        IngestEvent::DirCreated { path }
+    } else if path.is_symlink() {
+        // Read symlink target
+        let target = std::fs::read_link(&path).unwrap_or_default();
+        IngestEvent::SymlinkCreated { path, target }
+    } else {
+        IngestEvent::FileChanged { path }
+    }
+}
+
+/// Spawn async watcher task that sends events to a channel.
+/// Duplicates are left to the ingest queue's coalescer.
 pub fn spawn_watch_task(
     root: PathBuf,
     tx: tokio_mpsc::Sender<IngestEvent>,
@@ -7,13 +7,21 @@ Comprehensive benchmarks for VRift ingest, measuring:
 - Space savings from content-addressable storage
 - Re-ingest speed (incremental performance)
 - Cross-project dedup (monorepo scenarios)
+- VFS syscall latency (stat/open/readdir/mmap through the Inception Layer)
+- Ingest matrix (backend/tier × threads × page cache × synthetic dataset shape)
 
 Usage:
     python3 scripts/benchmark_suite.py             # Full benchmark
     python3 scripts/benchmark_suite.py --quick     # Quick mode (small/medium only)
     python3 scripts/benchmark_suite.py --report    # Generate markdown report only
+    python3 scripts/benchmark_suite.py --vfs-bench # Run tests/bench/run_vfs_bench.sh
+    python3 scripts/benchmark_suite.py --vfs-results target/bench/vfs_bench.jsonl
+    python3 scripts/benchmark_suite.py --ingest-bench  # Run tests/bench/run_ingest_bench.sh
+    python3 scripts/benchmark_suite.py --ingest-results target/bench/ingest_bench.jsonl \
+        --ingest-baseline baseline.jsonl               # Fail on >BENCH_REGRESSION_PCT% slowdowns
 """
 
+import json
 import os
 import shutil
 import subprocess
@@ -33,6 +41,12 @@ PROJECT_ROOT = SCRIPT_DIR.parent
 VRIFT_BINARY = PROJECT_ROOT / "target" / "release" / "vrift"
 BENCHMARKS_DIR = PROJECT_ROOT / "examples" / "benchmarks"
 REPORT_DIR = PROJECT_ROOT / "docs"
+VFS_BENCH_SCRIPT = PROJECT_ROOT / "tests" / "bench" / "run_vfs_bench.sh"
+VFS_BENCH_OUTPUT = PROJECT_ROOT / "target" / "bench" / "vfs_bench.jsonl"
+VFS_SECTION_TITLE = "## VFS Syscall Latency"
+INGEST_BENCH_SCRIPT = PROJECT_ROOT / "tests" / "bench" / "run_ingest_bench.sh"
+INGEST_BENCH_OUTPUT = PROJECT_ROOT / "target" / "bench" / "ingest_bench.jsonl"
+INGEST_SECTION_TITLE = "## Ingest Matrix"
 
 DATASETS = {
     "xsmall": {"package": "xsmall_package.json", "tier": "quick"},
@@ -81,6 +95,54 @@ class BenchmarkSuite:
         return next((r for r in self.results if r.name == name), None)
 
 
+@dataclass
+class VfsBenchResult:
+    """One (label, op) row emitted by tests/bench/vfs_bench.c --json."""
+
+    label: str
+    op: str
+    threads: int
+    working_set: int
+    miss_pct: int
+    ops: int
+    errors: int
+    ops_per_sec: float
+    p50_ns: int
+    p99_ns: int
+    p999_ns: int
+    max_ns: int
+
+
+@dataclass
+class IngestBenchResult:
+    """One run emitted by the vrift-cas ingest_bench example."""
+
+    label: str
+    engine: str
+    threads: int
+    cache: str
+    files: int
+    bytes: int
+    ingested: int
+    errors: int
+    blobs: int
+    secs: float
+    files_per_sec: float
+    mb_per_sec: float
+    # Traced runs only (BENCH_TRACE); net of the shape's "walk" baseline
+    syscalls: dict[str, int] = field(default_factory=dict)
+    syscalls_total: int = 0
+    perf: dict[str, float] = field(default_factory=dict)
+
+    @property
+    def key(self) -> tuple[str, str, int, str]:
+        return (self.label, self.engine, self.threads, self.cache)
+
+    @property
+    def syscalls_per_file(self) -> float:
+        return self.syscalls_total / self.files if self.files > 0 else 0
+
+
 # ============================================================================
 # Utilities
 # ============================================================================
@@ -265,11 +327,213 @@ def run_dataset_benchmark(name: str, config: dict[str, str], work_dir: Path) ->
     return suite
 
 
+def load_vfs_results(path: Path) -> list[VfsBenchResult]:
+    """Load JSON Lines written by the VFS syscall harness."""
+    results = []
+    for line in path.read_text().splitlines():
+        line = line.strip()
+        if not line.startswith("{"):
+            continue
+        row = json.loads(line)
+        if row.get("bench") != "vfs":
+            continue
+        results.append(
+            VfsBenchResult(
+                label=row["label"],
+                op=row["op"],
+                threads=row["threads"],
+                working_set=row["working_set"],
+                miss_pct=row["miss_pct"],
+                ops=row["ops"],
+                errors=row["errors"],
+                ops_per_sec=row["ops_per_sec"],
+                p50_ns=row["p50_ns"],
+                p99_ns=row["p99_ns"],
+                p999_ns=row["p999_ns"],
+                max_ns=row["max_ns"],
+            )
+        )
+    return results
+
+
+def run_vfs_benchmark(output: Path) -> list[VfsBenchResult]:
+    """Run the VFS syscall harness (baseline + shim) and load its results."""
+    print("═══ VFS SYSCALLS ═══")
+    code, _, stderr = run_cmd(["bash", str(VFS_BENCH_SCRIPT), str(output)], cwd=PROJECT_ROOT, timeout=1800)
+    if code != 0:
+        print(f"  VFS benchmark failed: {stderr[-300:]}")
+        return []
+    return load_vfs_results(output)
+
+
+def load_ingest_results(path: Path) -> list[IngestBenchResult]:
+    """Load ingest_bench JSON Lines; syscall counts become net of the walk baseline."""
+    rows = []
+    for line in path.read_text().splitlines():
+        line = line.strip()
+        if line.startswith("{"):
+            row = json.loads(line)
+            if row.get("bench") == "ingest":
+                rows.append(row)
+
+    walks = {r["label"]: r for r in rows if r["engine"] == "walk"}
+    results = []
+    for row in rows:
+        if row["engine"] == "walk":
+            continue
+        walk = walks.get(row["label"], {})
+        syscalls = {
+            name: count - walk.get("syscalls", {}).get(name, 0)
+            for name, count in row.get("syscalls", {}).items()
+        }
+        perf = {
+            name: value - walk.get("perf", {}).get(name, 0)
+            for name, value in row.get("perf", {}).items()
+        }
+        sys_enter = perf.get("raw_syscalls:sys_enter", 0)
+        results.append(
+            IngestBenchResult(
+                label=row["label"],
+                engine=row["engine"],
+                threads=row["threads"],
+                cache=row["cache"],
+                files=row["files"],
+                bytes=row["bytes"],
+                ingested=row["ingested"],
+                errors=row["errors"],
+                blobs=row["blobs"],
+                secs=row["secs"],
+                files_per_sec=row["files_per_sec"],
+                mb_per_sec=row["mb_per_sec"],
+                syscalls={k: v for k, v in syscalls.items() if v > 0},
+                syscalls_total=sum(v for v in syscalls.values() if v > 0) or int(max(sys_enter, 0)),
+                perf=perf,
+            )
+        )
+    return results
+
+
+def run_ingest_benchmark(output: Path) -> list[IngestBenchResult]:
+    """Run the ingest matrix (tests/bench/run_ingest_bench.sh) and load its results."""
+    print("═══ INGEST MATRIX ═══")
+    # Progress goes to stderr; let it through, the matrix takes a while
+    result = subprocess.run(["bash", str(INGEST_BENCH_SCRIPT), str(output)], cwd=PROJECT_ROOT)
+    if result.returncode != 0:
+        print(f"  Ingest benchmark failed (exit {result.returncode})")
+        return []
+    return load_ingest_results(output)
+
+
+def median_by_key(results: list[IngestBenchResult]) -> dict[tuple, float]:
+    """Median files/s per (shape, engine, threads, cache) across BENCH_REPEAT runs."""
+    groups: dict[tuple, list[float]] = {}
+    for r in results:
+        groups.setdefault(r.key, []).append(r.files_per_sec)
+    return {key: sorted(v)[len(v) // 2] for key, v in groups.items()}
+
+
+def compare_ingest(
+    results: list[IngestBenchResult], baseline: list[IngestBenchResult], threshold_pct: float
+) -> list[str]:
+    """Configurations whose median files/s dropped more than threshold_pct below baseline."""
+    current = median_by_key(results)
+    regressions = []
+    for key, before in sorted(median_by_key(baseline).items()):
+        after = current.get(key)
+        if after is None or before <= 0:
+            continue
+        change = 100 * (after - before) / before
+        if change < -threshold_pct:
+            label, engine, threads, cache = key
+            regressions.append(
+                f"{label} {engine} t={threads} {cache}: {before:,.0f} -> {after:,.0f} files/s ({change:+.1f}%)"
+            )
+    return regressions
+
+
 # ============================================================================
 # Report Generation
 # ============================================================================
 
 
+def format_ns(ns: int) -> str:
+    return f"{ns / 1000:.1f}µs" if ns >= 10_000 else f"{ns:,}ns"
+
+
+def generate_vfs_section(results: list[VfsBenchResult]) -> list[str]:
+    """Markdown section comparing shim latency against the no-shim baseline."""
+    if not results:
+        return []
+    first = results[0]
+    miss_pct = max(r.miss_pct for r in results)
+    lines = [
+        VFS_SECTION_TITLE,
+        "",
+        f"`tests/bench/run_vfs_bench.sh`: {first.threads} threads, {first.working_set:,} files, "
+        f"{miss_pct}% misses on stat/lstat/fstatat/open.",
+        "",
+        "| Op | Mode | ops/s | p50 | p99 | p99.9 | Errors |",
+        "|----|------|-------|-----|-----|-------|--------|",
+    ]
+    ops = list(dict.fromkeys(r.op for r in results))
+    for op in ops:
+        for r in (r for r in results if r.op == op):
+            lines.append(
+                f"| {r.op} | {r.label} | {r.ops_per_sec:,.0f} | {format_ns(r.p50_ns)} | "
+                f"{format_ns(r.p99_ns)} | {format_ns(r.p999_ns)} | {r.errors:,} |"
+            )
+    return lines
+
+
+def generate_ingest_section(results: list[IngestBenchResult]) -> list[str]:
+    """Markdown section: every run, grouped by dataset shape, fastest first."""
+    if not results:
+        return []
+    lines = [
+        INGEST_SECTION_TITLE,
+        "",
+        "`tests/bench/run_ingest_bench.sh`: fresh copy of each synthetic tree per run, "
+        "fresh CAS, ingest time only (listing excluded except for `pipeline`).",
+        "",
+    ]
+    traced = any(r.syscalls_total for r in results)
+    for label in dict.fromkeys(r.label for r in results):
+        shape = [r for r in results if r.label == label]
+        first = shape[0]
+        dedup = 1 - first.blobs / first.files if first.files and first.blobs else 0
+        lines.extend(
+            [
+                f"### {label}: {first.files:,} files, {format_bytes(first.bytes)}, {dedup * 100:.0f}% dedup",
+                "",
+                "| Engine | Threads | Cache | files/s | MB/s | Errors |" + (" Syscalls/file |" if traced else ""),
+                "|--------|---------|-------|---------|------|--------|" + ("---------------|" if traced else ""),
+            ]
+        )
+        for r in sorted(shape, key=lambda r: -r.files_per_sec):
+            row = (
+                f"| {r.engine} | {r.threads} | {r.cache} | {r.files_per_sec:,.0f} | "
+                f"{r.mb_per_sec:,.1f} | {r.errors:,} |"
+            )
+            if traced:
+                row += f" {r.syscalls_per_file:.1f} |"
+            lines.append(row)
+        lines.append("")
+    return lines[:-1]
+
+
+def update_report_section(report_path: Path, section: list[str]) -> None:
+    """Replace (or append) one `## ` section of an existing report in place."""
+    title = section[0]
+    lines = report_path.read_text().splitlines() if report_path.exists() else []
+    start = next((i for i, line in enumerate(lines) if line.strip() == title), None)
+    if start is None:
+        lines.extend([""] + section)
+    else:
+        end = next((i for i in range(start + 1, len(lines)) if lines[i].startswith("## ")), len(lines))
+        lines[start:end] = section + [""]
+    report_path.write_text("\n".join(lines).rstrip("\n") + "\n")
+
+
 def generate_report(suites: dict[str, BenchmarkSuite]) -> str:
     """Generate markdown performance report."""
     lines = [
@@ -339,7 +603,69 @@ def generate_report(suites: dict[str, BenchmarkSuite]) -> str:
 # ============================================================================
 
 
+def vfs_main() -> None:
+    """--vfs-bench / --vfs-results: only touch the VFS section of the report."""
+    if "--vfs-results" in sys.argv:
+        idx = sys.argv.index("--vfs-results")
+        results_path = Path(sys.argv[idx + 1]) if idx + 1 < len(sys.argv) else VFS_BENCH_OUTPUT
+        results = load_vfs_results(results_path)
+    else:
+        results = run_vfs_benchmark(VFS_BENCH_OUTPUT)
+
+    section = generate_vfs_section(results)
+    if not section:
+        print("No VFS benchmark results")
+        sys.exit(1)
+
+    report_path = REPORT_DIR / "BENCHMARK.md"
+    update_report_section(report_path, section)
+    print(f"Report updated: {report_path}")
+    print()
+    print("\n".join(section))
+
+
+def ingest_main() -> None:
+    """--ingest-bench / --ingest-results: only touch the ingest matrix section."""
+    if "--ingest-results" in sys.argv:
+        idx = sys.argv.index("--ingest-results")
+        results_path = Path(sys.argv[idx + 1]) if idx + 1 < len(sys.argv) else INGEST_BENCH_OUTPUT
+        results = load_ingest_results(results_path)
+    else:
+        results = run_ingest_benchmark(INGEST_BENCH_OUTPUT)
+
+    section = generate_ingest_section(results)
+    if not section:
+        print("No ingest benchmark results")
+        sys.exit(1)
+
+    report_path = REPORT_DIR / "BENCHMARK.md"
+    update_report_section(report_path, section)
+    print(f"Report updated: {report_path}")
+    print()
+    print("\n".join(section))
+
+    if "--ingest-baseline" in sys.argv:
+        idx = sys.argv.index("--ingest-baseline")
+        baseline = load_ingest_results(Path(sys.argv[idx + 1]))
+        threshold = float(os.environ.get("BENCH_REGRESSION_PCT", "10"))
+        regressions = compare_ingest(results, baseline, threshold)
+        print()
+        if regressions:
+            print(f"Regressions (>{threshold:.0f}% slower than baseline):")
+            for line in regressions:
+                print(f"  {line}")
+            sys.exit(1)
+        print(f"No regressions beyond {threshold:.0f}% against baseline")
+
+
 def main() -> None:
+    if "--vfs-bench" in sys.argv or "--vfs-results" in sys.argv:
+        vfs_main()
+        return
+    if "--ingest-bench" in sys.argv or "--ingest-results" in sys.argv:
+        ingest_main()
+        return
+
     quick_mode = "--quick" in sys.argv
     # report_only = "--report" in sys.argv - unused
 
@@ -0,0 +1,157 @@
+#!/bin/bash
+# run_ingest_bench.sh - Ingest throughput matrix: engine × threads × cache × shape
+#
+# Builds the vrift-cas ingest_bench example, generates one synthetic tree per
+# dataset shape, then ingests a fresh copy of it for every engine, thread
+# count and page-cache state. Results are JSON Lines, one object per run,
+# consumed by scripts/benchmark_suite.py --ingest-results.
+#
+# Shapes are "name:files:size_median:size_sigma:max_size:dedup_pct:depth:fanout"
+# separated by ';' (sizes log-normal around the median, in bytes).
+#
+# BENCH_TRACE=strace|perf repeats each run (fresh copy, cache untouched)
+# under `strace -f -c` / `perf stat` and attaches the counts; one "walk"
+# run per shape records the cost of listing the tree, to subtract.
+#
+# Usage: run_ingest_bench.sh [OUTPUT_JSONL]
+# Tunables (env): BENCH_DIR BENCH_SHAPES BENCH_ENGINES BENCH_THREADS
+#                 BENCH_CACHE BENCH_REPEAT BENCH_TRACE BENCH_PERF_EVENTS
+set -e
+
+PROJECT_ROOT="$(cd "$(dirname "$0")/../.." && pwd)"
+OUTPUT="${1:-${PROJECT_ROOT}/target/bench/ingest_bench.jsonl}"
+BENCH_BIN="${PROJECT_ROOT}/target/release/examples/ingest_bench"
+
+if [ "$(uname -s)" == "Darwin" ]; then
+    DEFAULT_ENGINES="rayon,gcd,tier1,tier2,phantom,pipeline"
+    FEATURES=()
+else
+    DEFAULT_ENGINES="rayon,uring,tier1,tier2,phantom,pipeline"
+    FEATURES=(--features io_uring)
+fi
+
+# Trees and CAS share one filesystem (hard links); point BENCH_DIR at the
+# NVMe or network mount under test.
+BENCH_DIR="${BENCH_DIR:-/tmp/ingest_bench_$$}"
+SHAPES="${BENCH_SHAPES:-node_modules:20000:2048:1.5:4194304:25:4:6;mixed:5000:32768:2.0:67108864:10:3:8;large:200:2097152:1.0:268435456:5:1:4}"
+ENGINES="${BENCH_ENGINES:-$DEFAULT_ENGINES}"
+THREADS="${BENCH_THREADS:-1,2,4,8}"
+CACHES="${BENCH_CACHE:-warm,cold}"
+REPEAT="${BENCH_REPEAT:-1}"
+TRACE="${BENCH_TRACE:-}"
+PERF_EVENTS="${BENCH_PERF_EVENTS:-task-clock,context-switches,cpu-migrations,page-faults,raw_syscalls:sys_enter}"
+
+cleanup() {
+    chflags -R nouchg "$BENCH_DIR" 2>/dev/null || true
+    rm -rf "$BENCH_DIR" 2>/dev/null || true
+}
+trap cleanup EXIT
+
+if [[ ",$CACHES," == *",cold,"* ]] && [ "$(id -u)" -ne 0 ]; then
+    echo "⚠️  Not root: cold-cache runs need drop_caches/purge, skipping them" >&2
+    CACHES="$(echo ",$CACHES," | sed 's/,cold,/,/g; s/^,//; s/,$//')"
+fi
+if [ -n "$TRACE" ] && ! command -v "$TRACE" >/dev/null; then
+    echo "❌ BENCH_TRACE=$TRACE but $TRACE is not installed" >&2
+    exit 1
+fi
+
+mkdir -p "$BENCH_DIR" "$(dirname "$OUTPUT")"
+: >"$OUTPUT"
+
+echo "[1] Building harness..." >&2
+(cd "$PROJECT_ROOT" && cargo build --release -q -p vrift-cas --example ingest_bench "${FEATURES[@]}")
+
+# strace -c table -> "syscalls":{...},"syscalls_total":N
+strace_counts() {
+    awk '
+        $NF == "total" || $1 ~ /^(%|-)/ || NF < 5 { next }
+        { calls[$NF] = $4; total += $4 }
+        END {
+            printf "\"syscalls\":{"
+            sep = ""
+            for (s in calls) { printf "%s\"%s\":%d", sep, s, calls[s]; sep = "," }
+            printf "},\"syscalls_total\":%d", total
+        }' "$1"
+}
+
+# perf stat -x, output -> "perf":{...}
+perf_counts() {
+    awk -F, '
+        /^#/ || NF < 3 || $1 ~ /^</ { next }
+        { gsub(/:[uk]+$/, "", $3); counts[$3] = $1 }
+        END {
+            printf "\"perf\":{"
+            sep = ""
+            for (e in counts) { printf "%s\"%s\":%s", sep, e, counts[e]; sep = "," }
+            printf "}"
+        }' "$1"
+}
+
+# traced ARGS... -> counts JSON fragment for one ingest_bench run
+traced() {
+    local out="$BENCH_DIR/trace.out"
+    if [ "$TRACE" == "strace" ]; then
+        strace -f -c -o "$out" "$BENCH_BIN" "$@" >/dev/null
+        strace_counts "$out"
+    else
+        perf stat -x, -e "$PERF_EVENTS" -o "$out" "$BENCH_BIN" "$@" >/dev/null
+        perf_counts "$out"
+    fi
+}
+
+fresh_copy() {
+    chflags -R nouchg "$BENCH_DIR/run" 2>/dev/null || true
+    rm -rf "$BENCH_DIR/run"
+    mkdir -p "$BENCH_DIR/run"
+    cp -a "$1" "$BENCH_DIR/run/tree"
+}
+
+IFS=';' read -ra SHAPE_LIST <<<"$SHAPES"
+IFS=',' read -ra ENGINE_LIST <<<"$ENGINES"
+IFS=',' read -ra THREAD_LIST <<<"$THREADS"
+IFS=',' read -ra CACHE_LIST <<<"$CACHES"
+
+step=2
+for spec in "${SHAPE_LIST[@]}"; do
+    IFS=':' read -r name files median sigma max_size dedup depth fanout <<<"$spec"
+    pristine="$BENCH_DIR/$name"
+
+    echo "[$step] Generating $name ($files files)..." >&2
+    "$BENCH_BIN" --setup -r "$pristine" -n "$files" --size-median "$median" \
+        --size-sigma "$sigma" --max-size "$max_size" --dedup "$dedup" \
+        --depth "$depth" --fanout "$fanout"
+    step=$((step + 1))
+
+    if [ -n "$TRACE" ]; then
+        fresh_copy "$pristine"
+        line="$("$BENCH_BIN" -r "$BENCH_DIR/run/tree" -c "$BENCH_DIR/run/cas" -e walk -l "$name")"
+        counts="$(traced -r "$BENCH_DIR/run/tree" -c "$BENCH_DIR/run/cas" -e walk -l "$name")"
+        echo "${line%\}},$counts}" >>"$OUTPUT"
+    fi
+
+    for engine in "${ENGINE_LIST[@]}"; do
+        for threads in "${THREAD_LIST[@]}"; do
+            for cache in "${CACHE_LIST[@]}"; do
+                for _ in $(seq "$REPEAT"); do
+                    args=(-c "$BENCH_DIR/run/cas" -e "$engine" -t "$threads" -l "$name")
+                    fresh_copy "$pristine"
+                    if ! line="$("$BENCH_BIN" -r "$BENCH_DIR/run/tree" "${args[@]}" --cache "$cache")"; then
+                        echo "   skip $name/$engine (failed or not in this build)" >&2
+                        continue 4
+                    fi
+                    if [ -n "$TRACE" ]; then
+                        fresh_copy "$pristine"
+                        counts="$(traced -r "$BENCH_DIR/run/tree" "${args[@]}" --cache none)"
+                        line="${line%\}},$counts}"
+                    fi
+                    echo "$line" >>"$OUTPUT"
+                    echo "   $name $engine t=$threads $cache: $(echo "$line" | sed 's/.*"files_per_sec":\([0-9.]*\).*/\1/') files/s" >&2
+                done
+            done
+        done
+    done
+    rm -rf "$pristine"
+done
+
+echo "✅ Results: $OUTPUT" >&2
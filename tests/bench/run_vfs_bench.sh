@@ -0,0 +1,93 @@
+#!/bin/bash
+# run_vfs_bench.sh - Multi-threaded stat/open/readdir/mmap latency benchmark
+#
+# Builds tests/bench/vfs_bench.c, creates and ingests a working set, starts
+# vriftd, then runs the harness twice: "baseline" (no shim, real filesystem)
+# and "shim" (Inception Layer injected). Results are JSON Lines, one object
+# per (label, op), consumed by scripts/benchmark_suite.py --vfs-results.
+#
+# Usage: run_vfs_bench.sh [OUTPUT_JSONL]
+# Tunables (env): BENCH_THREADS BENCH_ITERS BENCH_FILES BENCH_MISS_PCT BENCH_OPS
+set -e
+
+PROJECT_ROOT="$(cd "$(dirname "$0")/../.." && pwd)"
+VRIFT_CLI="${PROJECT_ROOT}/target/release/vrift"
+VRIFTD_BIN="${PROJECT_ROOT}/target/release/vriftd"
+OUTPUT="${1:-${PROJECT_ROOT}/target/bench/vfs_bench.jsonl}"
+
+THREADS="${BENCH_THREADS:-8}"
+ITERS="${BENCH_ITERS:-100000}"
+FILES="${BENCH_FILES:-4096}"
+MISS_PCT="${BENCH_MISS_PCT:-30}"
+OPS="${BENCH_OPS:-stat,lstat,fstatat,fstat,open,readdir,mmap,passthrough}"
+
+if [ "$(uname -s)" == "Darwin" ]; then
+    SHIM_LIB="${PROJECT_ROOT}/target/release/libvrift_inception_layer.dylib"
+    PRELOAD_VAR="DYLD_INSERT_LIBRARIES"
+else
+    SHIM_LIB="${PROJECT_ROOT}/target/release/libvrift_inception_layer.so"
+    PRELOAD_VAR="LD_PRELOAD"
+fi
+
+for bin in "$VRIFT_CLI" "$VRIFTD_BIN" "$SHIM_LIB"; do
+    if [ ! -f "$bin" ]; then
+        echo "❌ Missing $bin (run: cargo build --release)" >&2
+        exit 1
+    fi
+done
+
+TEST_DIR="/tmp/vfs_bench_$$"
+WORK_DIR="$TEST_DIR/project"
+BENCH_BIN="$TEST_DIR/vfs_bench"
+export VR_THE_SOURCE="$TEST_DIR/.cas"
+export VRIFT_SOCKET_PATH="$TEST_DIR/vrift.sock"
+DAEMON_PID=""
+
+cleanup() {
+    [ -n "$DAEMON_PID" ] && kill "$DAEMON_PID" 2>/dev/null || true
+    rm -f "$VRIFT_SOCKET_PATH"
+    chflags -R nouchg "$TEST_DIR" 2>/dev/null || true
+    rm -rf "$TEST_DIR" 2>/dev/null || true
+}
+trap cleanup EXIT
+
+mkdir -p "$VR_THE_SOURCE" "$(dirname "$OUTPUT")"
+
+echo "[1] Building harness..." >&2
+cc -O2 -pthread -o "$BENCH_BIN" "$PROJECT_ROOT/tests/bench/vfs_bench.c"
+
+echo "[2] Creating working set ($FILES files)..." >&2
+"$BENCH_BIN" --setup -r "$WORK_DIR" -w "$FILES"
+
+echo "[3] Ingesting..." >&2
+"$VRIFT_CLI" --the-source-root "$VR_THE_SOURCE" init "$WORK_DIR" >/dev/null 2>&1 || true
+"$VRIFT_CLI" --the-source-root "$VR_THE_SOURCE" ingest "$WORK_DIR" \
+    --output "$WORK_DIR/.vrift/manifest.lmdb" >/dev/null 2>&1
+
+echo "[4] Starting daemon..." >&2
+VRIFT_LOG=warn "$VRIFTD_BIN" start </dev/null >"$TEST_DIR/vriftd.log" 2>&1 &
+DAEMON_PID=$!
+
+waited=0
+while [ ! -S "$VRIFT_SOCKET_PATH" ] && [ $waited -lt 20 ]; do
+    sleep 0.5
+    waited=$((waited + 1))
+done
+if [ ! -S "$VRIFT_SOCKET_PATH" ]; then
+    echo "❌ Daemon failed to start" >&2
+    cat "$TEST_DIR/vriftd.log" >&2
+    exit 1
+fi
+
+BENCH_ARGS=(-r "$WORK_DIR" -w "$FILES" -t "$THREADS" -n "$ITERS" -m "$MISS_PCT" -o "$OPS" --json)
+
+echo "[5] Running baseline (no shim)..." >&2
+"$BENCH_BIN" "${BENCH_ARGS[@]}" -l baseline >"$OUTPUT"
+
+echo "[6] Running with shim..." >&2
+env "$PRELOAD_VAR=$SHIM_LIB" DYLD_FORCE_FLAT_NAMESPACE=1 \
+    VRIFT_MANIFEST="$WORK_DIR/.vrift/manifest.lmdb" \
+    VRIFT_PROJECT_ROOT="$WORK_DIR" VRIFT_VFS_PREFIX="$WORK_DIR" \
+    "$BENCH_BIN" "${BENCH_ARGS[@]}" -l shim >>"$OUTPUT"
+
+echo "✅ Results: $OUTPUT" >&2
@@ -0,0 +1,502 @@
+/*
+ * vfs_bench.c - Multi-threaded syscall latency benchmark for the VFS paths
+ *
+ * Exercises the paths the Inception Layer actually serves: VDir stat hits,
+ * manifest misses (filter / probe cache / IPC), open+close, CoW opens,
+ * readdir and mmap. Each thread records every call into a log-linear
+ * latency histogram; histograms are merged per operation and reported as
+ * ops/s plus p50/p99/p99.9.
+ *
+ * Working set layout (created by --setup, then ingested):
+ *     <root>/d000/f00000.dat ... <root>/dNNN/fNNNNN.dat   (64 files per dir)
+ * Misses probe <root>/dNNN/missingNNNNN.h: same directories, never created.
+ *
+ * Usage:
+ *     vfs_bench --setup -r <root> -w 4096
+ *     vfs_bench -r <root> -w 4096 -t 8 -n 200000 -m 30 -o stat,open,readdir --json
+ *
+ * --json prints one JSON object per operation (JSON Lines), the format
+ * scripts/benchmark_suite.py ingests. fstat latency covers the fstat call
+ * only, but its ops/s includes the surrounding untimed open/close.
+ * "passthrough" is the old tests/poc/benchmark_mt_stat.c measurement.
+ */
+
+#include <dirent.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+
+#define FILES_PER_DIR 64
+#define MAX_THREADS 256
+#define PATH_LEN 1024
+
+/* Histogram: 16 linear sub-buckets per power of two (~6% resolution) */
+#define SUB_BITS 4
+#define SUB_BUCKETS (1 << SUB_BITS)
+#define HIST_BUCKETS (64 * SUB_BUCKETS)
+
+enum op {
+    OP_STAT,
+    OP_LSTAT,
+    OP_FSTATAT,
+    OP_FSTAT,
+    OP_OPEN,
+    OP_OPEN_RW,
+    OP_READDIR,
+    OP_MMAP,
+    OP_PASSTHROUGH,
+    OP_COUNT
+};
+
+static const char *OP_NAMES[OP_COUNT] = {
+    "stat", "lstat", "fstatat", "fstat", "open", "open_rw", "readdir", "mmap", "passthrough",
+};
+
+/* open_rw triggers CoW into .vrift/staging: opt-in only */
+static const char *DEFAULT_OPS = "stat,lstat,fstatat,fstat,open,readdir,mmap,passthrough";
+
+struct config {
+    const char *root;
+    const char *label;
+    int threads;
+    long iterations;
+    int working_set;
+    int miss_pct;
+    int json;
+    int setup;
+    int enabled[OP_COUNT];
+};
+
+struct histogram {
+    uint64_t counts[HIST_BUCKETS];
+    uint64_t total;
+    uint64_t max_ns;
+    uint64_t sum_ns;
+    uint64_t errors;
+};
+
+struct worker {
+    pthread_t thread;
+    int id;
+    enum op op;
+    uint64_t rng;
+    struct histogram hist;
+};
+
+static struct config cfg;
+static int *dir_fds;
+static int passthrough_fd = -1;
+static pthread_barrier_t start_barrier;
+
+static inline uint64_t now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+static inline uint64_t next_rand(uint64_t *state) {
+    /* xorshift64*: cheap, per-thread, no locks */
+    uint64_t x = *state;
+    x ^= x >> 12;
+    x ^= x << 25;
+    x ^= x >> 27;
+    *state = x;
+    return x * 0x2545F4914F6CDD1DULL;
+}
+
+static inline int bucket_of(uint64_t ns) {
+    if (ns < SUB_BUCKETS) {
+        return (int)ns;
+    }
+    int msb = 63 - __builtin_clzll(ns);
+    int shift = msb - SUB_BITS;
+    return (shift + 1) * SUB_BUCKETS + (int)((ns >> shift) & (SUB_BUCKETS - 1));
+}
+
+static inline uint64_t bucket_upper(int bucket) {
+    if (bucket < SUB_BUCKETS) {
+        return (uint64_t)bucket;
+    }
+    int shift = bucket / SUB_BUCKETS - 1;
+    uint64_t sub = (uint64_t)(bucket % SUB_BUCKETS);
+    return (((uint64_t)SUB_BUCKETS + sub + 1) << shift) - 1;
+}
+
+static inline void record(struct histogram *h, uint64_t ns) {
+    h->counts[bucket_of(ns)]++;
+    h->total++;
+    h->sum_ns += ns;
+    if (ns > h->max_ns) {
+        h->max_ns = ns;
+    }
+}
+
+static uint64_t percentile(const struct histogram *h, double p) {
+    uint64_t target = (uint64_t)(p * (double)h->total);
+    if (target >= h->total) {
+        target = h->total - 1;
+    }
+    uint64_t seen = 0;
+    for (int i = 0; i < HIST_BUCKETS; i++) {
+        seen += h->counts[i];
+        if (seen > target) {
+            uint64_t upper = bucket_upper(i);
+            return upper < h->max_ns ? upper : h->max_ns;
+        }
+    }
+    return h->max_ns;
+}
+
+static void file_path(char *out, int index, int miss) {
+    int dir = index / FILES_PER_DIR;
+    if (miss) {
+        snprintf(out, PATH_LEN, "%s/d%03d/missing%05d.h", cfg.root, dir, index);
+    } else {
+        snprintf(out, PATH_LEN, "%s/d%03d/f%05d.dat", cfg.root, dir, index);
+    }
+}
+
+static int dir_count(void) {
+    return (cfg.working_set + FILES_PER_DIR - 1) / FILES_PER_DIR;
+}
+
+/* One timed call. Returns 0 on the expected outcome (misses expect ENOENT). */
+static int run_one(struct worker *w, int index, int miss) {
+    char path[PATH_LEN];
+    struct stat sb;
+    int rc = 0;
+    int fd;
+
+    switch (w->op) {
+    case OP_STAT:
+        file_path(path, index, miss);
+        rc = stat(path, &sb);
+        break;
+    case OP_LSTAT:
+        file_path(path, index, miss);
+        rc = lstat(path, &sb);
+        break;
+    case OP_FSTATAT: {
+        char name[64];
+        if (miss) {
+            snprintf(name, sizeof(name), "missing%05d.h", index);
+        } else {
+            snprintf(name, sizeof(name), "f%05d.dat", index);
+        }
+        rc = fstatat(dir_fds[index / FILES_PER_DIR], name, &sb, 0);
+        break;
+    }
+    case OP_FSTAT:
+        /* Measured on an fd opened outside the timed region */
+        file_path(path, index, 0);
+        fd = open(path, O_RDONLY);
+        if (fd < 0) {
+            return -1;
+        }
+        {
+            uint64_t t0 = now_ns();
+            rc = fstat(fd, &sb);
+            record(&w->hist, now_ns() - t0);
+        }
+        close(fd);
+        return rc;
+    case OP_OPEN:
+        file_path(path, index, miss);
+        fd = open(path, O_RDONLY);
+        rc = fd < 0 ? -1 : close(fd);
+        break;
+    case OP_OPEN_RW:
+        file_path(path, index, 0);
+        fd = open(path, O_RDWR);
+        rc = fd < 0 ? -1 : close(fd);
+        break;
+    case OP_READDIR: {
+        file_path(path, index, 0);
+        *strrchr(path, '/') = '\0';
+        DIR *d = opendir(path);
+        if (d == NULL) {
+            return -1;
+        }
+        int entries = 0;
+        while (readdir(d) != NULL) {
+            entries++;
+        }
+        closedir(d);
+        rc = entries > 0 ? 0 : -1;
+        break;
+    }
+    case OP_MMAP:
+        file_path(path, index, 0);
+        fd = open(path, O_RDONLY);
+        if (fd < 0) {
+            return -1;
+        }
+        if (fstat(fd, &sb) == 0 && sb.st_size > 0) {
+            void *p = mmap(NULL, (size_t)sb.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (p == MAP_FAILED) {
+                rc = -1;
+            } else {
+                volatile char c = *(volatile char *)p;
+                (void)c;
+                munmap(p, (size_t)sb.st_size);
+            }
+        }
+        close(fd);
+        break;
+    case OP_PASSTHROUGH:
+        /* Interposition overhead only: fstat on a non-VFS fd */
+        rc = fstat(passthrough_fd, &sb);
+        break;
+    default:
+        return -1;
+    }
+
+    if (miss) {
+        return (rc != 0 && errno == ENOENT) ? 0 : -1;
+    }
+    return rc;
+}
+
+static int op_has_misses(enum op op) {
+    return op == OP_STAT || op == OP_LSTAT || op == OP_FSTATAT || op == OP_OPEN;
+}
+
+static void *worker_main(void *arg) {
+    struct worker *w = arg;
+    pthread_barrier_wait(&start_barrier);
+
+    for (long i = 0; i < cfg.iterations; i++) {
+        uint64_t r = next_rand(&w->rng);
+        int index = (int)((r >> 8) % (uint64_t)cfg.working_set);
+        int miss = op_has_misses(w->op) && (int)(r % 100) < cfg.miss_pct;
+
+        if (w->op == OP_FSTAT) {
+            if (run_one(w, index, 0) != 0) {
+                w->hist.errors++;
+            }
+            continue;
+        }
+        uint64_t t0 = now_ns();
+        int rc = run_one(w, index, miss);
+        record(&w->hist, now_ns() - t0);
+        if (rc != 0) {
+            w->hist.errors++;
+        }
+    }
+    return NULL;
+}
+
+static void report(enum op op, const struct histogram *h, double wall_s) {
+    double ops_per_sec = wall_s > 0 ? (double)h->total / wall_s : 0;
+    double mean = h->total ? (double)h->sum_ns / (double)h->total : 0;
+    int miss_pct = op_has_misses(op) ? cfg.miss_pct : 0;
+    uint64_t p50 = percentile(h, 0.50);
+    uint64_t p99 = percentile(h, 0.99);
+    uint64_t p999 = percentile(h, 0.999);
+
+    if (cfg.json) {
+        printf("{\"bench\":\"vfs\",\"label\":\"%s\",\"op\":\"%s\",\"threads\":%d,"
+               "\"working_set\":%d,\"miss_pct\":%d,\"ops\":%llu,\"errors\":%llu,"
+               "\"ops_per_sec\":%.0f,\"mean_ns\":%.0f,\"p50_ns\":%llu,\"p99_ns\":%llu,"
+               "\"p999_ns\":%llu,\"max_ns\":%llu}\n",
+               cfg.label, OP_NAMES[op], cfg.threads, cfg.working_set, miss_pct,
+               (unsigned long long)h->total, (unsigned long long)h->errors, ops_per_sec, mean,
+               (unsigned long long)p50, (unsigned long long)p99, (unsigned long long)p999,
+               (unsigned long long)h->max_ns);
+    } else {
+        printf("%-12s %12.0f %10.0f %10llu %10llu %10llu %10llu %8llu\n", OP_NAMES[op],
+               ops_per_sec, mean, (unsigned long long)p50, (unsigned long long)p99,
+               (unsigned long long)p999, (unsigned long long)h->max_ns,
+               (unsigned long long)h->errors);
+    }
+    fflush(stdout);
+}
+
+static int run_op(enum op op) {
+    struct worker *workers = calloc((size_t)cfg.threads, sizeof(struct worker));
+    if (workers == NULL) {
+        perror("calloc");
+        return 1;
+    }
+    pthread_barrier_init(&start_barrier, NULL, (unsigned)cfg.threads + 1);
+    for (int t = 0; t < cfg.threads; t++) {
+        workers[t].id = t;
+        workers[t].op = op;
+        workers[t].rng = 0x9E3779B97F4A7C15ULL * (uint64_t)(t + 1);
+        if (pthread_create(&workers[t].thread, NULL, worker_main, &workers[t]) != 0) {
+            perror("pthread_create");
+            exit(1);
+        }
+    }
+
+    pthread_barrier_wait(&start_barrier);
+    uint64_t start = now_ns();
+    struct histogram *merged = calloc(1, sizeof(struct histogram));
+    for (int t = 0; t < cfg.threads; t++) {
+        pthread_join(workers[t].thread, NULL);
+    }
+    double wall_s = (double)(now_ns() - start) / 1e9;
+
+    for (int t = 0; t < cfg.threads; t++) {
+        const struct histogram *h = &workers[t].hist;
+        for (int i = 0; i < HIST_BUCKETS; i++) {
+            merged->counts[i] += h->counts[i];
+        }
+        merged->total += h->total;
+        merged->sum_ns += h->sum_ns;
+        merged->errors += h->errors;
+        if (h->max_ns > merged->max_ns) {
+            merged->max_ns = h->max_ns;
+        }
+    }
+    if (merged->total > 0) {
+        report(op, merged, wall_s);
+    }
+
+    pthread_barrier_destroy(&start_barrier);
+    free(merged);
+    free(workers);
+    return 0;
+}
+
+static int setup_working_set(void) {
+    char path[PATH_LEN];
+    char data[256];
+    memset(data, 'v', sizeof(data));
+
+    if (mkdir(cfg.root, 0755) != 0 && errno != EEXIST) {
+        perror(cfg.root);
+        return 1;
+    }
+    for (int d = 0; d < dir_count(); d++) {
+        snprintf(path, sizeof(path), "%s/d%03d", cfg.root, d);
+        if (mkdir(path, 0755) != 0 && errno != EEXIST) {
+            perror(path);
+            return 1;
+        }
+    }
+    for (int i = 0; i < cfg.working_set; i++) {
+        file_path(path, i, 0);
+        int fd = open(path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        if (fd < 0) {
+            perror(path);
+            return 1;
+        }
+        /* Distinct content per file so CAS dedup does not collapse the set */
+        int n = snprintf(data, sizeof(data), "vfs_bench file %d\n", i);
+        if (write(fd, data, (size_t)n) != n) {
+            perror("write");
+        }
+        close(fd);
+    }
+    fprintf(stderr, "created %d files in %d directories under %s\n", cfg.working_set,
+            dir_count(), cfg.root);
+    return 0;
+}
+
+static int parse_ops(const char *list) {
+    char buf[256];
+    snprintf(buf, sizeof(buf), "%s", list);
+    memset(cfg.enabled, 0, sizeof(cfg.enabled));
+    for (char *tok = strtok(buf, ","); tok != NULL; tok = strtok(NULL, ",")) {
+        int found = 0;
+        for (int op = 0; op < OP_COUNT; op++) {
+            if (strcmp(tok, OP_NAMES[op]) == 0) {
+                cfg.enabled[op] = 1;
+                found = 1;
+            }
+        }
+        if (!found) {
+            fprintf(stderr, "unknown op '%s'\n", tok);
+            return 1;
+        }
+    }
+    return 0;
+}
+
+static void usage(const char *prog) {
+    fprintf(stderr,
+            "usage: %s -r ROOT [--setup] [-w FILES] [-t THREADS] [-n ITERATIONS]\n"
+            "          [-m MISS_PCT] [-o OPS] [-l LABEL] [--json]\n"
+            "  OPS: comma list of stat,lstat,fstatat,fstat,open,open_rw,readdir,mmap,passthrough\n"
+            "       (default: %s)\n",
+            prog, DEFAULT_OPS);
+}
+
+int main(int argc, char **argv) {
+    const char *ops = DEFAULT_OPS;
+    cfg.threads = 8;
+    cfg.iterations = 100000;
+    cfg.working_set = 4096;
+    cfg.miss_pct = 0;
+    cfg.label = "default";
+
+    for (int i = 1; i < argc; i++) {
+        const char *a = argv[i];
+        const char *v = i + 1 < argc ? argv[i + 1] : NULL;
+        if (strcmp(a, "--setup") == 0) {
+            cfg.setup = 1;
+        } else if (strcmp(a, "--json") == 0) {
+            cfg.json = 1;
+        } else if (v != NULL && strcmp(a, "-r") == 0) {
+            cfg.root = v, i++;
+        } else if (v != NULL && strcmp(a, "-w") == 0) {
+            cfg.working_set = atoi(v), i++;
+        } else if (v != NULL && strcmp(a, "-t") == 0) {
+            cfg.threads = atoi(v), i++;
+        } else if (v != NULL && strcmp(a, "-n") == 0) {
+            cfg.iterations = atol(v), i++;
+        } else if (v != NULL && strcmp(a, "-m") == 0) {
+            cfg.miss_pct = atoi(v), i++;
+        } else if (v != NULL && strcmp(a, "-o") == 0) {
+            ops = v, i++;
+        } else if (v != NULL && strcmp(a, "-l") == 0) {
+            cfg.label = v, i++;
+        } else {
+            usage(argv[0]);
+            return 2;
+        }
+    }
+    if (cfg.root == NULL || cfg.working_set <= 0 || cfg.threads <= 0 ||
+        cfg.threads > MAX_THREADS || cfg.iterations <= 0 || cfg.miss_pct < 0 ||
+        cfg.miss_pct > 100 || parse_ops(ops) != 0) {
+        usage(argv[0]);
+        return 2;
+    }
+    if (cfg.setup) {
+        return setup_working_set();
+    }
+
+    dir_fds = calloc((size_t)dir_count(), sizeof(int));
+    for (int d = 0; d < dir_count(); d++) {
+        char path[PATH_LEN];
+        snprintf(path, sizeof(path), "%s/d%03d", cfg.root, d);
+        dir_fds[d] = open(path, O_RDONLY | O_DIRECTORY);
+        if (dir_fds[d] < 0 && cfg.enabled[OP_FSTATAT]) {
+            perror(path);
+            return 1;
+        }
+    }
+    passthrough_fd = open("/dev/null", O_RDONLY);
+
+    if (!cfg.json) {
+        printf("# %s: %d threads x %ld iterations, working set %d, miss %d%%\n", cfg.label,
+               cfg.threads, cfg.iterations, cfg.working_set, cfg.miss_pct);
+        printf("%-12s %12s %10s %10s %10s %10s %10s %8s\n", "op", "ops/s", "mean_ns",
+               "p50_ns", "p99_ns", "p999_ns", "max_ns", "errors");
+    }
+    for (int op = 0; op < OP_COUNT; op++) {
+        if (cfg.enabled[op] && run_op((enum op)op) != 0) {
+            return 1;
+        }
+    }
+    return 0;
+}